@@ -0,0 +1,300 @@
+/* 
+ *  File: affinity.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "affinity.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include <unistd.h>
+
+namespace {
+
+constexpr int HOST_LEN = 64;
+constexpr int MAX_CPUS = 1024;
+constexpr int MAX_NUMA = 64;
+
+/**
+ * One rank's binding, gathered to rank 0 as raw bytes
+ */
+struct RankInfo {
+    char host[HOST_LEN];
+    int local_rank, local_size;
+    int device, ndevices, device_numa;
+    // NUMA domain of the rank's cores, or -2 if they span several
+    int cpu_numa;
+    int nthreads;
+    unsigned char cpus[MAX_CPUS / 8];
+};
+
+// Recorded by Select() for the report
+int selected_device = -1;
+bool bound_cores = false;
+
+int EnvInt(const std::vector<const char*>& names, const int& def)
+{
+    for (auto name : names) {
+        const char* val = std::getenv(name);
+        if (val != nullptr && val[0] != '\0') return std::atoi(val);
+    }
+    return def;
+}
+
+/**
+ * Parse a Linux CPU list, e.g. "0-7,16-23"
+ */
+std::set<int> ParseCPUList(const std::string& list)
+{
+    std::set<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const size_t dash = range.find('-');
+        const int lo = std::atoi(range.substr(0, dash).c_str());
+        const int hi = (dash == std::string::npos) ? lo : std::atoi(range.substr(dash + 1).c_str());
+        for (int c = lo; c <= hi; c++) cpus.insert(c);
+    }
+    return cpus;
+}
+
+/**
+ * Print a CPU set compactly as a list of ranges
+ */
+std::string CPUList(const unsigned char* mask)
+{
+    std::ostringstream s;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        if (!(mask[c / 8] & (1 << (c % 8)))) continue;
+        int end = c;
+        while (end + 1 < MAX_CPUS && (mask[(end + 1) / 8] & (1 << ((end + 1) % 8)))) end++;
+        if (s.tellp() > 0) s << ",";
+        s << c;
+        if (end > c) s << "-" << end;
+        c = end;
+    }
+    return s.str();
+}
+
+int ReadInt(const std::string& fname, const int& def)
+{
+    std::ifstream f(fname);
+    int val;
+    return (f >> val) ? val : def;
+}
+
+/**
+ * NUMA domain of the device in use, from its PCI address.  -1 if unknown
+ */
+int DeviceNUMA(const int& device)
+{
+    char bus_id[32] = {0};
+#if defined(KOKKOS_ENABLE_CUDA)
+    if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != cudaSuccess) return -1;
+#elif defined(KOKKOS_ENABLE_HIP)
+    if (hipDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != hipSuccess) return -1;
+#else
+    return -1;
+#endif
+    // sysfs uses lowercase hex, with a 4-digit PCI domain
+    std::string id(bus_id);
+    for (auto& ch : id) ch = std::tolower(ch);
+    if (id.size() > 12) id = id.substr(id.size() - 12);
+    return ReadInt("/sys/bus/pci/devices/" + id + "/numa_node", -1);
+}
+
+} // namespace
+
+void Affinity::Select()
+{
+    const int local_rank = EnvInt({"OMPI_COMM_WORLD_LOCAL_RANK", "PALS_LOCAL_RANKID", "PMI_LOCAL_RANK",
+                                   "MV2_COMM_WORLD_LOCAL_RANK", "SLURM_LOCALID"}, 0);
+    const int local_size = EnvInt({"OMPI_COMM_WORLD_LOCAL_SIZE", "PALS_LOCAL_SIZE", "PMI_LOCAL_SIZE",
+                                   "MV2_COMM_WORLD_LOCAL_SIZE", "SLURM_NTASKS_PER_NODE"}, 1);
+
+    // Explicit device map.  Kokkos refuses a device ID alongside a mapping rule, so drop the rule
+    const char* gpu_map = std::getenv("KHARMA_GPU_MAP");
+    if (gpu_map != nullptr && gpu_map[0] != '\0') {
+        std::vector<int> devices;
+        std::stringstream ss(gpu_map);
+        std::string dev;
+        while (std::getline(ss, dev, ',')) devices.push_back(std::atoi(dev.c_str()));
+        selected_device = devices[local_rank % devices.size()];
+        setenv("KOKKOS_DEVICE_ID", std::to_string(selected_device).c_str(), 1);
+        unsetenv("KOKKOS_MAP_DEVICE_ID_BY");
+    }
+
+#ifdef __linux__
+    if (EnvInt({"KHARMA_BIND_CORES"}, 0) && local_size > 1) {
+        cpu_set_t allowed, mine;
+        CPU_ZERO(&mine);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            std::vector<int> cpus;
+            for (int c = 0; c < CPU_SETSIZE; c++) if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+            const int share = cpus.size() / local_size;
+            if (share > 0) {
+                for (int c = local_rank * share; c < (local_rank + 1) * share; c++) CPU_SET(cpus[c], &mine);
+                bound_cores = (sched_setaffinity(0, sizeof(mine), &mine) == 0);
+                // Don't start more host threads than we have cores, unless asked to.
+                // The OpenMP runtime has already read its environment, so tell Kokkos instead
+                if (bound_cores && std::getenv("OMP_NUM_THREADS") == nullptr)
+                    setenv("KOKKOS_NUM_THREADS", std::to_string(share).c_str(), 0);
+            }
+        }
+    }
+#endif
+}
+
+void Affinity::Report(int verbose)
+{
+    RankInfo info;
+    std::memset(&info, 0, sizeof(info));
+    gethostname(info.host, HOST_LEN - 1);
+
+    info.local_rank = 0;
+    info.local_size = 1;
+#ifdef MPI_PARALLEL
+    MPI_Comm node_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm));
+    PARTHENON_MPI_CHECK(MPI_Comm_rank(node_comm, &info.local_rank));
+    PARTHENON_MPI_CHECK(MPI_Comm_size(node_comm, &info.local_size));
+    PARTHENON_MPI_CHECK(MPI_Comm_free(&node_comm));
+#endif
+
+    info.device = -1;
+    info.ndevices = 0;
+#if defined(KOKKOS_ENABLE_CUDA)
+    cudaGetDevice(&info.device);
+    cudaGetDeviceCount(&info.ndevices);
+#elif defined(KOKKOS_ENABLE_HIP)
+    hipGetDevice(&info.device);
+    hipGetDeviceCount(&info.ndevices);
+#endif
+    info.device_numa = (info.device >= 0) ? DeviceNUMA(info.device) : -1;
+    info.nthreads = Kokkos::DefaultHostExecutionSpace().concurrency();
+
+    info.cpu_numa = -1;
+#ifdef __linux__
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int c = 0; c < std::min(MAX_CPUS, CPU_SETSIZE); c++)
+            if (CPU_ISSET(c, &mask)) info.cpus[c / 8] |= (1 << (c % 8));
+        for (int node = 0; node < MAX_NUMA; node++) {
+            std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!f) continue;
+            std::string list;
+            std::getline(f, list);
+            for (int c : ParseCPUList(list)) {
+                if (c < CPU_SETSIZE && CPU_ISSET(c, &mask)) {
+                    info.cpu_numa = (info.cpu_numa == -1 || info.cpu_numa == node) ? node : -2;
+                    break;
+                }
+            }
+        }
+    }
+#endif
+
+    int nranks = 1;
+    std::vector<RankInfo> all(1, info);
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nranks));
+    all.resize(MPIRank0() ? nranks : 0);
+    PARTHENON_MPI_CHECK(MPI_Gather(&info, sizeof(RankInfo), MPI_BYTE, all.data(), sizeof(RankInfo), MPI_BYTE,
+                                   0, MPI_COMM_WORLD));
+#endif
+    if (!MPIRank0()) return;
+
+    std::vector<std::string> warnings;
+    for (int r = 0; r < nranks; r++) {
+        const RankInfo& a = all[r];
+        if (a.device_numa >= 0 && a.cpu_numa >= 0 && a.device_numa != a.cpu_numa)
+            warnings.push_back("rank " + std::to_string(r) + " runs on NUMA domain " + std::to_string(a.cpu_numa) +
+                               " but its device is attached to domain " + std::to_string(a.device_numa));
+        if (a.cpu_numa == -2 && a.local_size > 1)
+            warnings.push_back("rank " + std::to_string(r) + "'s cores span several NUMA domains");
+        // Host builds: each block's fields are zero-filled by every thread, but later read mostly
+        // by the threads handling that block, so a rank's memory should sit in one domain
+        if (a.cpu_numa == -2 && a.local_size == 1 && a.device < 0 && a.nthreads > 1)
+            warnings.push_back("rank " + std::to_string(r) + " runs threads across several NUMA domains. " +
+                               "Run one rank per domain, e.g. with KHARMA_BIND_CORES=1");
+
+        std::set<int> node_devices;
+        int node_ranks = 0;
+        for (int s = 0; s < nranks; s++) {
+            const RankInfo& b = all[s];
+            if (std::strncmp(a.host, b.host, HOST_LEN) != 0) continue;
+            node_ranks++;
+            if (b.device >= 0) node_devices.insert(b.device);
+            if (s > r) {
+                bool overlap = false;
+                for (int i = 0; i < MAX_CPUS / 8; i++) overlap |= (a.cpus[i] & b.cpus[i]);
+                if (overlap)
+                    warnings.push_back("ranks " + std::to_string(r) + " and " + std::to_string(s) + " on " +
+                                       a.host + " share cores");
+            }
+        }
+        // Only report once per node, from its first rank
+        if (a.local_rank == 0 && a.device >= 0 && (int) node_devices.size() < std::min(node_ranks, a.ndevices))
+            warnings.push_back(std::to_string(node_ranks) + " ranks on " + a.host + " use only " +
+                               std::to_string(node_devices.size()) + " of its " + std::to_string(a.ndevices) +
+                               " devices");
+    }
+
+    if (verbose > 0 || !warnings.empty()) {
+        std::cout << "Affinity" << (selected_device >= 0 ? " (KHARMA_GPU_MAP)" : "")
+                  << (bound_cores ? " (KHARMA_BIND_CORES)" : "") << ":" << std::endl;
+        printf("%6s %-24s %6s %7s %9s %10s %8s  %s\n", "rank", "host", "local", "device", "dev_numa",
+               "core_numa", "threads", "cores");
+        for (int r = 0; r < nranks; r++) {
+            const RankInfo& a = all[r];
+            printf("%6d %-24s %6d %7d %9d %10s %8d  %s\n", r, a.host, a.local_rank, a.device, a.device_numa,
+                   (a.cpu_numa == -2) ? "multiple" : std::to_string(a.cpu_numa).c_str(), a.nthreads,
+                   CPUList(a.cpus).c_str());
+        }
+        for (auto& warning : warnings)
+            std::cout << "WARNING: bad binding: " << warning << std::endl;
+        std::cout << std::endl;
+    }
+}
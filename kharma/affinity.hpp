@@ -0,0 +1,69 @@
+/* 
+ *  File: affinity.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Device and core affinity, set at startup instead of through per-machine wrapper scripts.
+ *
+ * Before Kokkos and MPI are initialized, Select() finds this process's node-local rank from the
+ * launcher's environment (Open MPI, MPICH/PALS, Slurm, MVAPICH), and:
+ * 1. With KHARMA_GPU_MAP set to a comma-separated list of device numbers (e.g. "3,2,1,0" on
+ *    Polaris, where the closest device to each socket is numbered in reverse), assigns local
+ *    rank n device KHARMA_GPU_MAP[n % len].  Otherwise Kokkos maps devices by local rank as usual.
+ * 2. With KHARMA_BIND_CORES=1, restricts the process to an even, contiguous share of the cores it
+ *    was allowed by the launcher, so that ranks launched without a binding don't overlap.  OpenMP
+ *    host threads, and any MPI progress thread started afterward, inherit this set.
+ *
+ * After initialization, Report() gathers every rank's host, local rank, device and core set, and
+ * warns when ranks on a node share a device while others sit idle, when ranks' core sets overlap,
+ * or when a device is attached to a different NUMA domain than its rank's cores.  On host builds
+ * it also warns when one rank's threads span NUMA domains: fields are zero-filled on allocation by
+ * all of a rank's threads, so only a rank confined to one domain keeps all its memory local.  The full table
+ * is printed with verbose > 0, or whenever there is a warning.
+ */
+namespace Affinity {
+
+/**
+ * Choose this rank's device and cores.  Call before ParthenonInitEnv.
+ */
+void Select();
+
+/**
+ * Print the binding of every rank, and warn about bad ones.  Call after Kokkos & MPI are initialized.
+ */
+void Report(int verbose);
+
+}
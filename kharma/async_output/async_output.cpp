@@ -0,0 +1,325 @@
+/* 
+ *  File: async_output.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "async_output.hpp"
+
+#include "domain.hpp"
+#include "hdf5_utils.h"
+#include "kharma_package.hpp"
+#include "output_staging.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace {
+// The thread writing the most recent snapshot.  It reads from the staging buffer of the snapshot's
+// precision, which is reused between snapshots, so it must be joined before the buffer is touched
+std::thread writer;
+
+/**
+ * Write one rank's snapshot, from the background thread.  Takes copies of everything but the data.
+ * No Flag() calls here, as the region timers are not thread-safe
+ */
+template<typename T>
+void WriteSnapshot(const std::string fname, const double t, const int ncycle, const int stride,
+                   const std::vector<std::string> comp_names, const int nblocks, const int n1, const int n2, const int n3,
+                   const std::vector<int> gids, const std::vector<int> levels, const std::vector<double> x1,
+                   const std::vector<double> x2, const std::vector<double> x3, const T *data)
+{
+    const int ncomp = comp_names.size();
+    hdf5_create(fname.c_str());
+    hdf5_write_single_val(&t, "t", H5T_IEEE_F64LE);
+    hdf5_write_single_val(&ncycle, "ncycle", H5T_STD_I32LE);
+    hdf5_write_single_val(&n1, "n1", H5T_STD_I32LE);
+    hdf5_write_single_val(&n2, "n2", H5T_STD_I32LE);
+    hdf5_write_single_val(&n3, "n3", H5T_STD_I32LE);
+    hdf5_write_single_val(&stride, "stride", H5T_STD_I32LE);
+
+    // Names of each component, fixed-length for simple reading
+    const int name_len = 64;
+    std::vector<char> names(ncomp * name_len, '\0');
+    for (int c = 0; c < ncomp; c++) strncpy(&names[c * name_len], comp_names[c].c_str(), name_len - 1);
+    hdf5_write_str_list(names.data(), "fields", name_len, ncomp);
+
+    // Which block is which, and native coordinates of the zone centers written
+    hsize_t fdims_b[1] = {(hsize_t) nblocks}, fstart1[1] = {0};
+    hdf5_write_array(gids.data(), "gid", 1, fdims_b, fstart1, fdims_b, fdims_b, fstart1, H5T_STD_I32LE);
+    hdf5_write_array(levels.data(), "level", 1, fdims_b, fstart1, fdims_b, fdims_b, fstart1, H5T_STD_I32LE);
+    hsize_t fstart2[2] = {0, 0};
+    hsize_t fdims_x1[2] = {(hsize_t) nblocks, (hsize_t) n1};
+    hsize_t fdims_x2[2] = {(hsize_t) nblocks, (hsize_t) n2};
+    hsize_t fdims_x3[2] = {(hsize_t) nblocks, (hsize_t) n3};
+    hdf5_write_array(x1.data(), "X1", 2, fdims_x1, fstart2, fdims_x1, fdims_x1, fstart2, H5T_IEEE_F64LE);
+    hdf5_write_array(x2.data(), "X2", 2, fdims_x2, fstart2, fdims_x2, fdims_x2, fstart2, H5T_IEEE_F64LE);
+    hdf5_write_array(x3.data(), "X3", 2, fdims_x3, fstart2, fdims_x3, fdims_x3, fstart2, H5T_IEEE_F64LE);
+
+    // The data, in [block][component][k][j][i] order
+    hsize_t fdims[5] = {(hsize_t) nblocks, (hsize_t) ncomp, (hsize_t) n3, (hsize_t) n2, (hsize_t) n1};
+    hsize_t fstart[5] = {0, 0, 0, 0, 0};
+    hdf5_write_array(data, "data", 5, fdims, fstart, fdims, fdims, fstart,
+                     (sizeof(T) == 4) ? H5T_IEEE_F32LE : H5T_IEEE_F64LE);
+    hdf5_close();
+}
+
+/**
+ * Move a snapshot written to node-local storage to its final directory, from the background thread.
+ * Copied under a temporary name & renamed, so readers never see partial files.
+ * On failure the local copy is kept, so a snapshot is never lost to a full or missing directory.
+ */
+void DrainSnapshot(const std::filesystem::path local, const std::filesystem::path dest)
+{
+    const std::filesystem::path tmp = dest.string() + ".tmp";
+    try {
+        std::filesystem::copy_file(local, tmp, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::rename(tmp, dest);
+        std::filesystem::remove(local);
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Could not move snapshot " << local << " to " << dest << ": " << e.what() << std::endl;
+    }
+}
+
+/**
+ * Write a snapshot, then drain it from node-local storage if it was written there
+ */
+template<typename T>
+void WriteAndDrain(const std::string local_fname, const std::string fname, const double t, const int ncycle,
+                   const int stride, const std::vector<std::string> comp_names, const int nblocks,
+                   const int n1, const int n2, const int n3, const std::vector<int> gids, const std::vector<int> levels,
+                   const std::vector<double> x1, const std::vector<double> x2, const std::vector<double> x3, const T *data)
+{
+    WriteSnapshot<T>(local_fname, t, ncycle, stride, comp_names, nblocks, n1, n2, n3, gids, levels, x1, x2, x3, data);
+    if (local_fname != fname) DrainSnapshot(local_fname, fname);
+}
+
+/**
+ * Gather every stride'th interior zone of the listed blocks into a device buffer of type T,
+ * copy it to the host buffer of that type, and start the writer thread on it.
+ * The thread writes to local_fname, then moves the file to fname if they differ
+ */
+template<typename T>
+void StageAndWrite(MeshData<Real> *md, const std::vector<std::string>& fields, const std::vector<int>& blocks,
+                   const int stride, const std::string& local_fname, const std::string& fname,
+                   const double t, const int ncycle)
+{
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    // Zones written per block in each direction
+    const int n1 = (b.ie - b.is) / stride + 1;
+    const int n2 = (b.je - b.js) / stride + 1;
+    const int n3 = (b.ke - b.ks) / stride + 1;
+    const int nblocks = blocks.size();
+
+    // Components of each field, in order
+    std::vector<std::string> comp_names;
+    std::vector<int> offsets;
+    for (auto &field : fields) {
+        const int nc = md->GetBlockData(0)->Get(field).GetDim(4);
+        offsets.push_back(comp_names.size());
+        for (int c = 0; c < nc; c++) comp_names.push_back((nc > 1) ? field + "_" + std::to_string(c) : field);
+    }
+    const int ncomp = comp_names.size();
+
+    ParArray1D<int> block_list("async_output_blocks", m::max(nblocks, 1));
+    auto block_list_h = Kokkos::create_mirror_view(block_list);
+    for (int bl = 0; bl < nblocks; bl++) block_list_h(bl) = blocks[bl];
+    Kokkos::deep_copy(block_list, block_list_h);
+
+    // Gather on the device, converting to the output precision on the way
+    const size_t size = (size_t) nblocks * ncomp * n3 * n2 * n1;
+    const auto staging = OutputStaging::DeviceBuffer<T>("async_output", size);
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    for (int f = 0; f < fields.size(); f++) {
+        const auto V = md->PackVariables(std::vector<std::string>{fields[f]});
+        const int off = offsets[f];
+        const int nc = V.GetDim(4);
+        if (nblocks == 0) break;
+        pmb0->par_for("async_output_stage", 0, nblocks-1, 0, n3-1, 0, n2-1, 0, n1-1,
+            KOKKOS_LAMBDA (const int &bl, const int &ko, const int &jo, const int &io) {
+                const int bm = block_list(bl);
+                const int k = b.ks + ko * stride, j = b.js + jo * stride, i = b.is + io * stride;
+                for (int v = 0; v < nc; v++) {
+                    const size_t idx = ((((size_t) bl * ncomp + off + v) * n3 + ko) * n2 + jo) * n1 + io;
+                    staging(idx) = static_cast<T>(V(bm, v, k, j, i));
+                }
+            }
+        );
+    }
+
+    // Copy to the host, if we must.  This is the only part the step loop waits on
+    const auto host = OutputStaging::ToHost<T>("async_output", size);
+
+    // Block metadata
+    std::vector<int> gids(nblocks), levels(nblocks);
+    std::vector<double> x1(nblocks * n1), x2(nblocks * n2), x3(nblocks * n3);
+    for (int bl = 0; bl < nblocks; bl++) {
+        auto pmb = md->GetBlockData(blocks[bl])->GetBlockPointer();
+        gids[bl] = pmb->gid;
+        levels[bl] = pmb->loc.level();
+        const auto& G = pmb->coords;
+        for (int io = 0; io < n1; io++) x1[bl * n1 + io] = G.Xc<1>(b.is + io * stride);
+        for (int jo = 0; jo < n2; jo++) x2[bl * n2 + jo] = G.Xc<2>(b.js + jo * stride);
+        for (int ko = 0; ko < n3; ko++) x3[bl * n3 + ko] = G.Xc<3>(b.ks + ko * stride);
+    }
+
+    writer = std::thread(WriteAndDrain<T>, local_fname, fname, t, ncycle, stride, comp_names, nblocks, n1, n2, n3,
+                         gids, levels, x1, x2, x3, host.data());
+}
+
+}
+
+std::shared_ptr<KHARMAPackage> AsyncOutput::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("AsyncOutput");
+    Params &params = pkg->AllParams();
+
+    // Which fields to snapshot.  Any field Parthenon knows about, including output-only derived fields
+    auto fields = pin->GetOrAddVector<std::string>("async_output", "variables",
+                        std::vector<std::string>{"prims.rho", "prims.u", "prims.uvec", "prims.B"});
+    params.Add("fields", fields);
+    // Whether to run everyone's BlockUserWorkBeforeOutput before each snapshot, to fill derived fields
+    params.Add("fill_derived", pin->GetOrAddBoolean("async_output", "fill_derived", true));
+
+    // Reduced snapshots, e.g. for imaging: precision in bits (32 or 64), writing only every
+    // stride'th zone in each direction, and only blocks with some zone in r_min <= r <= r_max.
+    // Cropping is by block, so a few zones outside the range are written.
+    const int precision = pin->GetOrAddInteger("async_output", "precision", 64);
+    if (precision != 32 && precision != 64)
+        throw std::invalid_argument("Asynchronous output precision must be 32 or 64!");
+    params.Add("precision", precision);
+    const int stride = pin->GetOrAddInteger("async_output", "stride", 1);
+    if (stride < 1) throw std::invalid_argument("Asynchronous output stride must be >= 1!");
+    params.Add("stride", stride);
+    params.Add("r_min", (GReal) pin->GetOrAddReal("async_output", "r_min", 0.));
+    params.Add("r_max", (GReal) pin->GetOrAddReal("async_output", "r_max", std::numeric_limits<Real>::max()));
+
+    // Directory for snapshots, and optionally a node-local directory (e.g. an NVMe burst buffer) to write
+    // them to first.  Local files are moved to dir by the writer thread, after writing.
+    params.Add("dir", pin->GetOrAddString("async_output", "dir", "."));
+    params.Add("local_dir", pin->GetOrAddString("async_output", "local_dir", ""));
+
+    // Cadence in simulation time.  The next snapshot is due at the next multiple of dt
+    const Real dt = pin->GetReal("async_output", "dt");
+    if (dt <= 0.) throw std::invalid_argument("Asynchronous output requires async_output/dt > 0!");
+    params.Add("dt", dt);
+    const Real tstart = pin->GetOrAddReal("parthenon/time", "start_time", 0.);
+    params.Add("next_time", (Real) (m::floor(tstart / dt) + 1) * dt, true);
+    params.Add("next_num", (int) m::floor(tstart / dt) + 1, true);
+
+    pkg->PostStepWork = AsyncOutput::Snapshot;
+    pkg->BlockUserWorkBeforeOutput = AsyncOutput::BlockUserWorkBeforeOutput;
+    pkg->PostExecute = AsyncOutput::PostExecute;
+
+    return pkg;
+}
+
+void AsyncOutput::Wait()
+{
+    if (writer.joinable()) {
+        Flag("AsyncOutputWait");
+        writer.join();
+        EndFlag();
+    }
+}
+
+void AsyncOutput::BlockUserWorkBeforeOutput(MeshBlock *pmb, ParameterInput *pin)
+{
+    Wait();
+}
+
+void AsyncOutput::PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    Wait();
+    // Release the staging buffers before Kokkos is finalized
+    OutputStaging::Release();
+}
+
+void AsyncOutput::Snapshot(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    auto& params = pmesh->packages.Get("AsyncOutput")->AllParams();
+    // Parthenon advances tm.time only after PostStepWork, so this is the time after the step
+    const Real t = tm.time + tm.dt;
+    Real *next_time = params.GetMutable<Real>("next_time");
+    if (t < *next_time) return;
+    Flag("AsyncOutputSnapshot");
+
+    const Real dt = params.Get<Real>("dt");
+    while (*next_time <= t) *next_time += dt;
+    int *next_num = params.GetMutable<int>("next_num");
+    const int num = (*next_num)++;
+
+    // Any last snapshot must be finished before we reuse its buffer
+    Wait();
+
+    if (params.Get<bool>("fill_derived")) {
+        for (auto &pmb : pmesh->block_list) Packages::UserWorkBeforeOutput(pmb.get(), pin);
+    }
+
+    auto md = pmesh->mesh_data.Get().get();
+    const auto& fields = params.Get<std::vector<std::string>>("fields");
+    const int stride = params.Get<int>("stride");
+    const GReal r_min = params.Get<GReal>("r_min"), r_max = params.Get<GReal>("r_max");
+
+    // Blocks with any written zone in the radial range
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    std::vector<int> blocks;
+    for (int bl = 0; bl < md->NumBlocks(); bl++) {
+        const auto& G = md->GetBlockData(bl)->GetBlockPointer()->coords;
+        bool in_range = false;
+        for (int k = b.ks; k <= b.ke && !in_range; k += stride)
+            for (int j = b.js; j <= b.je && !in_range; j += stride)
+                for (int i = b.is; i <= b.ie && !in_range; i += stride) {
+                    const GReal r = G.r(k, j, i);
+                    in_range = (r >= r_min && r <= r_max);
+                }
+        if (in_range) blocks.push_back(bl);
+    }
+
+    const std::string problem_id = pmesh->packages.Get("Globals")->Param<std::string>("problem");
+    char nbuf[32];
+    snprintf(nbuf, 32, "%05d.r%06d", num, MPIRank());
+    const std::string basename = problem_id + ".snap." + nbuf + ".h5";
+    const std::string& local_dir = params.Get<std::string>("local_dir");
+    const std::string fname = (std::filesystem::path(params.Get<std::string>("dir")) / basename).string();
+    const std::string local_fname = (local_dir != "") ? (std::filesystem::path(local_dir) / basename).string() : fname;
+    if (MPIRank0()) std::cout << "Writing snapshot at t=" << t << " to " << problem_id << ".snap." << num << ".*" << std::endl;
+
+    if (params.Get<int>("precision") == 32) {
+        StageAndWrite<float>(md, fields, blocks, stride, local_fname, fname, t, tm.ncycle + 1);
+    } else {
+        StageAndWrite<double>(md, fields, blocks, stride, local_fname, fname, t, tm.ncycle + 1);
+    }
+
+    EndFlag();
+}
@@ -0,0 +1,86 @@
+/* 
+ *  File: async_output.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Asynchronous snapshots of a list of fields, written without stalling the step loop.
+ *
+ * Every <async_output>dt in simulation time, derived fields are filled as they would be for an output,
+ * then the listed fields are gathered on the device into one staging buffer per rank, copied to
+ * (pinned, on GPUs) host memory, and written to <problem_id>.snap.NNNNN.rRRRRR.h5 by a background
+ * thread while the simulation continues.  Each rank writes its own blocks' interior zones, in
+ * (block, variable, k, j, i) order, along with the native coordinates of each block's zones.
+ *
+ * For dense-cadence imaging dumps, snapshots can be reduced: written in float32 (<async_output>precision = 32),
+ * subsampled to every stride'th zone in each direction (stride), and cropped to the blocks with
+ * zones in a radial range (r_min, r_max).  Conversion & subsampling happen on the device, before the copy.
+ *
+ * On machines with node-local storage, snapshots can be written there first (<async_output>local_dir),
+ * and are then moved to <async_output>dir by the same background thread.
+ *
+ * Parthenon's own dumps & restarts are still written synchronously.  HDF5 is not assumed to be thread-safe,
+ * so anything using HDF5 from the main thread must call AsyncOutput::Wait() first.  This package does so
+ * before every Parthenon output, and the averages package before writing.
+ */
+namespace AsyncOutput {
+
+/**
+ * Initialize the package, with which fields to snapshot and how often
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Stage a snapshot & start writing it, if one is due.  Registered as PostStepWork
+ */
+void Snapshot(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+/**
+ * Wait for any snapshot being written to finish.  Does nothing if there is none
+ */
+void Wait();
+
+/**
+ * Wait on the writer before Parthenon's outputs, which also use HDF5
+ */
+void BlockUserWorkBeforeOutput(MeshBlock *pmb, ParameterInput *pin);
+
+/**
+ * Finish writing any last snapshot before exiting
+ */
+void PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+}
@@ -0,0 +1,271 @@
+/* 
+ *  File: averages.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "averages.hpp"
+
+#include "async_output.hpp"
+#include "domain.hpp"
+#include "hdf5_utils.h"
+#include "reductions.hpp"
+
+using Reductions::Var;
+
+namespace {
+
+static const std::map<std::string, Var> average_var_names = {
+    {"rho", Var::rho}, {"u", Var::u}, {"Pg", Var::gas_pressure}, {"bsq", Var::bsq},
+    {"beta", Var::beta}, {"sigma", Var::sigma}, {"theta_e", Var::theta_e},
+    {"mdot", Var::mdot}, {"edot", Var::edot}, {"ldot", Var::ldot}
+};
+
+// Evaluate any averageable variable by its runtime index, so all of them share one kernel
+// (REDUCE_FUNCTION_ARGS are spelled out, as reductions.hpp undefines them)
+KOKKOS_INLINE_FUNCTION Real average_var(const Var& var, const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                        const VariableFluxPack<Real>& U, const VarMap& m_u,
+                                        const VariablePack<Real>& cmax, const VariablePack<Real>& cmin,
+                                        const EMHD::EMHD_parameters& emhd_params, const Real& gam, const Real& game,
+                                        const int& k, const int& j, const int& i)
+{
+    switch (var) {
+    case Var::rho: return Reductions::reduction_var<Var::rho>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::u: return Reductions::reduction_var<Var::u>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::gas_pressure: return Reductions::reduction_var<Var::gas_pressure>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::bsq: return Reductions::reduction_var<Var::bsq>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::beta: return Reductions::reduction_var<Var::beta>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::sigma: return Reductions::reduction_var<Var::sigma>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::theta_e: return Reductions::reduction_var<Var::theta_e>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::mdot: return Reductions::reduction_var<Var::mdot>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::edot: return Reductions::reduction_var<Var::edot>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::ldot: return Reductions::reduction_var<Var::ldot>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    default: return 0.;
+    }
+}
+
+}
+
+std::shared_ptr<KHARMAPackage> Averages::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("Averages");
+    Params &params = pkg->AllParams();
+
+    // Sums are kept on the global grid, which we can only index simply without refinement
+    if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") != "none")
+        throw std::invalid_argument("In-situ averages require a mesh without refinement!");
+
+    // Which variables to average.  Fluxes mdot/edot/ldot are as in the history file, i.e. include gdet
+    auto var_names = pin->GetOrAddVector<std::string>("averages", "variables",
+                                                      std::vector<std::string>{"rho", "u", "bsq", "beta", "edot"});
+    const int nvar = var_names.size();
+    ParArray1D<int> var_list("average_vars", nvar);
+    auto var_list_h = Kokkos::create_mirror_view(var_list);
+    for (int v = 0; v < nvar; v++) {
+        if (!average_var_names.count(var_names[v]))
+            throw std::invalid_argument("Unknown variable to average: "+var_names[v]);
+        if (var_names[v] == "theta_e" && !packages->AllPackages().count("Electrons"))
+            throw std::invalid_argument("Averaging theta_e requires electrons!");
+        if ((var_names[v] == "bsq" || var_names[v] == "beta" || var_names[v] == "sigma") &&
+            !(packages->AllPackages().count("B_FluxCT") || packages->AllPackages().count("B_CT") ||
+              packages->AllPackages().count("B_CD")))
+            throw std::invalid_argument("Averaging "+var_names[v]+" requires a magnetic field!");
+        var_list_h(v) = static_cast<int>(average_var_names.at(var_names[v]));
+    }
+    Kokkos::deep_copy(var_list, var_list_h);
+    params.Add("var_names", var_names);
+    params.Add("var_list", var_list);
+
+    // Length of each averaging window in simulation time, and when to start the first
+    params.Add("dt", pin->GetReal("averages", "dt"));
+    params.Add("tstart", pin->GetOrAddReal("averages", "tstart", 0.));
+    // Start of the current window, or <0 when nothing has been accumulated yet
+    params.Add("t_window", (Real) -1., true);
+
+    // Global grid, and running sums over it.  The last slice holds the total weight
+    const int n1 = pin->GetInteger("parthenon/mesh", "nx1");
+    const int n2 = pin->GetInteger("parthenon/mesh", "nx2");
+    params.Add("n1", n1);
+    params.Add("n2", n2);
+    params.Add("x1min", (GReal) pin->GetReal("parthenon/mesh", "x1min"));
+    params.Add("x1max", (GReal) pin->GetReal("parthenon/mesh", "x1max"));
+    params.Add("x2min", (GReal) pin->GetReal("parthenon/mesh", "x2min"));
+    params.Add("x2max", (GReal) pin->GetReal("parthenon/mesh", "x2max"));
+    params.Add("sums", ParArray3D<Real>("average_sums", nvar + 1, n2, n1));
+    params.Add("block_offsets", std::map<int, BlockOffsets>(), true);
+
+    pkg->PostStepDiagnosticsMesh = Averages::AccumulateAndWrite;
+
+    return pkg;
+}
+
+TaskStatus Averages::AccumulateAndWrite(const SimTime& tm, MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto& params = pmesh->packages.Get("Averages")->AllParams();
+    const Real dt_avg = params.Get<Real>("dt");
+    const Real tstart = params.Get<Real>("tstart");
+    // Parthenon advances tm.time only after the diagnostics, so this step covers [tm.time, tm.time + tm.dt]
+    const Real t_end = tm.time + tm.dt;
+    if (t_end <= tstart) return TaskStatus::complete;
+
+    Real *t_window = params.GetMutable<Real>("t_window");
+    if (*t_window < 0.) *t_window = tm.time;
+    Accumulate(md, tm.dt);
+
+    if (t_end >= *t_window + dt_avg) {
+        Write(pmesh, t_end);
+        *t_window = -1.;
+    }
+
+    return TaskStatus::complete;
+}
+
+void Averages::Accumulate(MeshData<Real> *md, const Real& dt)
+{
+    Flag("AccumulateAverages");
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const auto& params = pmesh->packages.Get("Averages")->AllParams();
+    const auto sums = params.Get<ParArray3D<Real>>("sums");
+    const auto var_list = params.Get<ParArray1D<int>>("var_list");
+    const int nvar = var_list.extent_int(0);
+
+    const Real gam = pmesh->packages.Get("GRMHD")->Param<Real>("gamma");
+    const Real game = Reductions::ElectronGamma(pmesh);
+    const auto& emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const auto& U = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const auto& cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+    const auto& cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+
+    // Global index of each block's first zone
+    auto *cache = GetPartitionParam<BlockOffsets>(md, "Averages", "block_offsets");
+    auto locs = PartitionLocations(md);
+    if (cache->offsets.extent_int(0) < md->NumBlocks() || cache->locs != locs) {
+        if (cache->offsets.extent_int(0) < md->NumBlocks())
+            cache->offsets = ParArray2D<int>("average_block_offsets", md->NumBlocks(), 2);
+        auto offsets_h = Kokkos::create_mirror_view(cache->offsets);
+        const int nb1 = bi.ie - bi.is + 1, nb2 = bi.je - bi.js + 1;
+        for (int b = 0; b < md->NumBlocks(); b++) {
+            offsets_h(b, 0) = locs[b].lx1() * nb1;
+            offsets_h(b, 1) = locs[b].lx2() * nb2;
+        }
+        Kokkos::deep_copy(cache->offsets, offsets_h);
+        cache->locs = locs;
+    }
+    const auto offsets = cache->offsets;
+
+    // Each zone adds to its (X1,X2) column, so updates from the zones along X3 collide
+    pmb0->par_for("accumulate_averages", block.s, block.e, bi.ks, bi.ke, bi.js, bi.je, bi.is, bi.ie,
+        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            const auto& G = U.GetCoords(b);
+            const int ig = offsets(b, 0) + i - bi.is;
+            const int jg = offsets(b, 1) + j - bi.js;
+            const Real w = G.Dxc<3>(k) * dt;
+            for (int v = 0; v < nvar; v++)
+                Kokkos::atomic_add(&sums(v, jg, ig), w * average_var(static_cast<Var>(var_list(v)), G, P(b), m_p, U(b), m_u, cmax(b), cmin(b),
+                                                               emhd_params, gam, game, k, j, i));
+            Kokkos::atomic_add(&sums(nvar, jg, ig), w);
+        }
+    );
+    EndFlag();
+}
+
+void Averages::Write(Mesh *pmesh, const Real& t_end)
+{
+    Flag("WriteAverages");
+    const auto& params = pmesh->packages.Get("Averages")->AllParams();
+    const auto sums = params.Get<ParArray3D<Real>>("sums");
+    const auto& var_names = params.Get<std::vector<std::string>>("var_names");
+    const int nvar = var_names.size();
+    const int n1 = params.Get<int>("n1"), n2 = params.Get<int>("n2");
+    const Real t_window = params.Get<Real>("t_window");
+
+    // Sum over ranks, then reset
+    auto sums_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), sums);
+#ifdef MPI_PARALLEL
+    if (MPIRank0()) {
+        PARTHENON_MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, sums_h.data(), sums_h.size(), MPI_PARTHENON_REAL, MPI_SUM,
+                                       0, MPI_COMM_WORLD));
+    } else {
+        PARTHENON_MPI_CHECK(MPI_Reduce(sums_h.data(), nullptr, sums_h.size(), MPI_PARTHENON_REAL, MPI_SUM,
+                                       0, MPI_COMM_WORLD));
+    }
+#endif
+    Kokkos::deep_copy(sums, 0.);
+
+    if (MPIRank0()) {
+        // HDF5 may not be thread-safe, don't write alongside a snapshot
+        AsyncOutput::Wait();
+        const std::string problem_id = pmesh->packages.Get("Globals")->Param<std::string>("problem");
+        const int nfile = static_cast<int>(m::round((t_window - params.Get<Real>("tstart")) / params.Get<Real>("dt")));
+        char nbuf[16];
+        snprintf(nbuf, 16, "%05d", nfile);
+        const std::string fname = problem_id + ".avg." + nbuf + ".h5";
+
+        hdf5_create(fname.c_str());
+        const double t_start_d = t_window, t_end_d = t_end;
+        hdf5_write_single_val(&t_start_d, "t_start", H5T_IEEE_F64LE);
+        hdf5_write_single_val(&t_end_d, "t_end", H5T_IEEE_F64LE);
+        hdf5_write_single_val(&n1, "n1", H5T_STD_I32LE);
+        hdf5_write_single_val(&n2, "n2", H5T_STD_I32LE);
+
+        // Native coordinates of zone centers
+        std::vector<double> X1(n1), X2(n2);
+        const GReal dx1 = (params.Get<GReal>("x1max") - params.Get<GReal>("x1min")) / n1;
+        const GReal dx2 = (params.Get<GReal>("x2max") - params.Get<GReal>("x2min")) / n2;
+        for (int i = 0; i < n1; i++) X1[i] = params.Get<GReal>("x1min") + (i + 0.5) * dx1;
+        for (int j = 0; j < n2; j++) X2[j] = params.Get<GReal>("x2min") + (j + 0.5) * dx2;
+        hsize_t fdims1[1] = {(hsize_t) n1}, fdims2[1] = {(hsize_t) n2}, fstart1[1] = {0};
+        hdf5_write_array(X1.data(), "X1", 1, fdims1, fstart1, fdims1, fdims1, fstart1, H5T_IEEE_F64LE);
+        hdf5_write_array(X2.data(), "X2", 1, fdims2, fstart1, fdims2, fdims2, fstart1, H5T_IEEE_F64LE);
+
+        // Averages, in [X2][X1] order
+        std::vector<double> avg(n1 * n2);
+        hsize_t fdims[2] = {(hsize_t) n2, (hsize_t) n1}, fstart[2] = {0, 0};
+        for (int v = 0; v < nvar; v++) {
+            for (int j = 0; j < n2; j++)
+                for (int i = 0; i < n1; i++)
+                    avg[j*n1 + i] = (sums_h(nvar, j, i) > 0.) ? sums_h(v, j, i) / sums_h(nvar, j, i) : 0.;
+            hdf5_write_array(avg.data(), var_names[v].c_str(), 2, fdims, fstart, fdims, fdims, fstart, H5T_IEEE_F64LE);
+        }
+        hdf5_close();
+        std::cout << "Wrote averages over t=[" << t_window << ", " << t_end << "] to " << fname << std::endl;
+    }
+    EndFlag();
+}
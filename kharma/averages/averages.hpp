@@ -0,0 +1,82 @@
+/* 
+ *  File: averages.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * In-situ averages over X3 (azimuth) and time, of any of the reduction variables in Reductions::Var.
+ *
+ * Each step, every zone adds its value, weighted by dx3*dt, to a running sum over the global
+ * (X1,X2) grid kept on the device.  Every <averages>dt in simulation time, the sums are reduced
+ * to rank 0 and divided by the total weight, then written to <problem_id>.avg.NNNNN.h5 and reset.
+ * This produces the usual r-theta profiles without writing or reading full 3D dumps.
+ *
+ * Accumulated sums are not saved to restart files: a restarted run begins a new averaging window.
+ * Requires a mesh without refinement, where blocks map directly to global (X1,X2) indices.
+ */
+namespace Averages {
+
+/**
+ * Global (X1,X2) index of the first interior zone of each block in a partition, rebuilt on regrid
+ */
+struct BlockOffsets {
+    ParArray2D<int> offsets;
+    std::vector<LogicalLocation> locs;
+};
+
+/**
+ * Initialize the averaging package, with which variables to average, and how often to write them
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Add one step's worth of each variable to the running sums, and write/reset them if due.
+ * Registered as PostStepDiagnostics, so that it is called once per step over the whole mesh
+ */
+TaskStatus AccumulateAndWrite(const SimTime& tm, MeshData<Real> *md);
+
+/**
+ * Add the current state of md to the running sums, with weight dt
+ */
+void Accumulate(MeshData<Real> *md, const Real& dt);
+
+/**
+ * Reduce the running sums over ranks, write the averages from rank 0 and reset them
+ */
+void Write(Mesh *pmesh, const Real& t_end);
+
+}
@@ -44,9 +44,8 @@ using namespace parthenon;
 
 // It at least needs:
 // 1. Special-casing in magnetic field initialization
-// 2. Implementation of below function to update maximum 'ctop' each step
-// 3. Ripping out a bunch of experiments toward GR support which didn't work
-// 4. Proper GR support instead
+// 2. Ripping out a bunch of experiments toward GR support which didn't work
+// 3. Proper GR support instead
 
 namespace B_CD
 {
@@ -61,10 +60,8 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     Real damping = pin->GetOrAddReal("b_field", "damping", 0.1);
     params.Add("damping", damping);
 
-    // Accumulator for maximum ctop within an MPI process
-    // That is, this value does NOT generally reflect the actual maximum
-    params.Add("ctop_max", 0.0, true);
-    // Maximum between MPI processes, updated after each step; that is, always a maximum.
+    // Speed at which to propagate psi, updated after each step from the global timestep.
+    // See UpdateCtopMax
     params.Add("ctop_max_last", 0.0, true);
 
     std::vector<int> s_vector({NVEC});
@@ -283,17 +280,24 @@ void FillOutput(MeshBlock *pmb, ParameterInput *pin)
 
 void UpdateCtopMax(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
 {
-    // TODO use new Reductions stuff for this
-    // Reduce and record the maximum sound speed on the grid, to propagate
-    // phi at that speed next step.
+    // Record the fastest speed psi can be propagated next step.
+    // Rather than reducing ctop separately, we use the timestep: it's already reduced over all
+    // ranks, and dt = cfl / max(sum_d ctop_d / dx_d), so the speed which fills the same CFL
+    // budget on the finest level is cfl / (dt * sum_d 1 / dx_d).  This is the usual choice
+    // of Dedner et al. (2002), and is a bound on the largest ctop.
     // Just needs to run after every step, so we use the KHARMA callback at that point.
-    // auto& params = pmesh->packages.Get("B_CD")->AllParams();
-    // static AllReduce<Real> ctop_max_last_r;
-    // ctop_max_last_r.val = params.Get<Real>("ctop_max");
-    // ctop_max_last_r.StartReduce(MPI_MAX);
-    // while (ctop_max_last_r.CheckReduce() == TaskStatus::incomplete);
-    // params.Update<Real>("ctop_max_last", ctop_max_last_r.val);
-    // params.Update<Real>("ctop_max", 0.0); // Reset for next max calculation
+    if (tm.dt <= 0.) return;
+    auto& params = pmesh->packages.Get("B_CD")->AllParams();
+    const double cfl = pmesh->packages.Get("GRMHD")->Param<double>("cfl");
+    // Zones on the finest level are smaller than those in the root grid by this factor
+    const Real refine_factor = 1 << pmesh->current_level;
+    Real inv_dx_sum = 0.;
+    for (int d = 1; d <= pmesh->ndim; ++d) {
+        const auto dir = (CoordinateDirection) d;
+        const Real dx_root = (pmesh->mesh_size.xmax(dir) - pmesh->mesh_size.xmin(dir)) / pmesh->mesh_size.nx(dir);
+        inv_dx_sum += refine_factor / dx_root;
+    }
+    params.Update<Real>("ctop_max_last", cfl / (tm.dt * inv_dx_sum));
 }
 
 } // namespace B_CD
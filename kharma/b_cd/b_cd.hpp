@@ -86,7 +86,7 @@ Real MaxDivB(MeshData<Real> *md);
 
 /**
  * Find the maximum wavespeed across the whole grid, to use in propagating
- * the phi field.
+ * the phi field.  Derived from the global timestep, so this adds no reduction.
  */
 void UpdateCtopMax(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
 
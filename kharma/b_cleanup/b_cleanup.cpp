@@ -77,7 +77,7 @@ std::shared_ptr<KHARMAPackage> B_Cleanup::Initialize(ParameterInput *pin, std::s
     // Parthenon's BiCGStab solver stops on abs || rel, so this disables rel
     Real rel_tolerance = pin->GetOrAddReal("b_cleanup", "rel_tolerance", 1e-20);
     params.Add("rel_tolerance", rel_tolerance);
-    Real abs_tolerance = pin->GetOrAddReal("b_cleanup", "abs_tolerance", 1e-9);
+    Real abs_tolerance = pin->GetOrAddReal("b_cleanup", "abs_tolerance", PrecisionTolerance(1e-9));
     params.Add("abs_tolerance", abs_tolerance);
     int max_iterations = pin->GetOrAddInteger("b_cleanup", "max_iterations", 1e8);
     params.Add("max_iterations", max_iterations);
@@ -92,6 +92,22 @@ std::shared_ptr<KHARMAPackage> B_Cleanup::Initialize(ParameterInput *pin, std::s
     bool use_normalized_divb = pin->GetOrAddBoolean("b_cleanup", "use_normalized_divb", false);
     params.Add("use_normalized_divb", use_normalized_divb);
 
+    // Preconditioning: "none", or "multigrid" for a geometric multigrid V-cycle within each block,
+    // see MGPrecondition.  Either way, convergence is checked on the true residual
+    std::string preconditioner = pin->GetOrAddString("b_cleanup", "preconditioner", "none");
+    if (preconditioner != "none" && preconditioner != "multigrid")
+        throw std::invalid_argument("Unknown B field cleanup preconditioner: "+preconditioner);
+    const bool use_mg = (preconditioner == "multigrid");
+    // Levels include the finest.  Coarsening also stops once a direction can't be halved
+    int mg_levels = pin->GetOrAddInteger("b_cleanup", "mg_levels", 8);
+    params.Add("mg_levels", mg_levels);
+    // Weighted Jacobi sweeps before & after each coarse correction, and on the coarsest level
+    int mg_sweeps = pin->GetOrAddInteger("b_cleanup", "mg_sweeps", 2);
+    params.Add("mg_sweeps", mg_sweeps);
+    int mg_coarse_sweeps = pin->GetOrAddInteger("b_cleanup", "mg_coarse_sweeps", 16);
+    params.Add("mg_coarse_sweeps", mg_coarse_sweeps);
+    params.Add("mg_hierarchy", std::vector<MGLevel>(), true);
+
     // Initialize the solver
     // Translate parameters
     params.Add("bicgstab_max_iterations", max_iterations);
@@ -99,6 +115,7 @@ std::shared_ptr<KHARMAPackage> B_Cleanup::Initialize(ParameterInput *pin, std::s
     params.Add("bicgstab_abort_on_fail", fail_without_convergence);
     params.Add("bicgstab_warn_on_fail", warn_without_convergence);
     params.Add("bicgstab_print_checks", true);
+    params.Add("bicgstab_precondition", use_mg);
 
     // Sparse matrix.  Never built, we leave it blank
     pkg->AddParam<std::string>("spm_name", "");
@@ -117,6 +134,9 @@ std::shared_ptr<KHARMAPackage> B_Cleanup::Initialize(ParameterInput *pin, std::s
     } else {
         solver.user_MatVec = B_Cleanup::CornerLaplacian;
     }
+    if (use_mg) {
+        solver.user_Precondition = B_Cleanup::MGPrecondition;
+    }
 
     params.Add("solver", solver);
 
@@ -344,6 +364,70 @@ TaskStatus B_Cleanup::ApplyPFace(MeshData<Real> *msolve, MeshData<Real> *md)
     return TaskStatus::complete;
 }
 
+namespace {
+
+// Per-block bits marking the special cases in the Laplacians:
+// 1 & 2: polar (user) inner & outer X2 boundaries in spherical coordinates
+// 4 & 8: outflow (user) inner & outer X1 boundaries
+ParArray1D<int> BoundaryBits(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const bool spherical = pmb0->coords.coords.is_spherical();
+    const auto &bparams = pmb0->packages.Get("Boundaries")->AllParams();
+    const bool inner_outflow = bparams.Get<std::string>("inner_x1") == "outflow";
+    const bool outer_outflow = bparams.Get<std::string>("outer_x1") == "outflow";
+
+    ParArray1D<int> bits("B_Cleanup.boundary_bits", md->NumBlocks());
+    auto bits_h = Kokkos::create_mirror_view(bits);
+    for (int b = 0; b < md->NumBlocks(); b++) {
+        auto pmb = md->GetBlockData(b)->GetBlockPointer();
+        bits_h(b) = ((spherical && pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user) ? 1 : 0)
+                  | ((spherical && pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user) ? 2 : 0)
+                  | ((inner_outflow && pmb->boundary_flag[BoundaryFace::inner_x1] == BoundaryFlag::user) ? 4 : 0)
+                  | ((outer_outflow && pmb->boundary_flag[BoundaryFace::outer_x1] == BoundaryFlag::user) ? 8 : 0);
+    }
+    Kokkos::deep_copy(bits, bits_h);
+    return bits;
+}
+
+/**
+ * Gradient of corner-centered p at the center of zone k,j,i, as B_FluxCT::center_grad.
+ * Zones just beyond a polar boundary reflect the first physical zone, with B2 inverted.
+ */
+KOKKOS_FORCEINLINE_FUNCTION void reflected_center_grad(const GRCoordinates& G, const VariablePack<Real>& P,
+                                                      const int& k, const int& j, const int& i, const bool& do_3D,
+                                                      const IndexRange& jb, const int& bits,
+                                                      Real& B1, Real& B2, Real& B3)
+{
+    if ((bits & 1) && j == jb.s - 1) {
+        B_FluxCT::center_grad(G, P, k, jb.s, i, do_3D, B1, B2, B3);
+        B2 = -B2;
+    } else if ((bits & 2) && j == jb.e + 1) {
+        B_FluxCT::center_grad(G, P, k, jb.e, i, do_3D, B1, B2, B3);
+        B2 = -B2;
+    } else {
+        B_FluxCT::center_grad(G, P, k, j, i, do_3D, B1, B2, B3);
+    }
+}
+
+/**
+ * Gradient of cell-centered p on face k,j,i in DIR, as B_CT::face_grad.
+ * Zero outside the faces bf where it can be computed, and on polar faces.
+ */
+template<CoordinateDirection DIR>
+KOKKOS_FORCEINLINE_FUNCTION Real masked_face_grad(const GRCoordinates& G, const VariablePack<Real>& P,
+                                                 const int& k, const int& j, const int& i,
+                                                 const IndexRange3& bf, const IndexRange& jbf, const int& bits)
+{
+    if (KDomain::outside(k, j, i, bf)) return 0.;
+    if constexpr (DIR == X2DIR) {
+        if (((bits & 1) && j == jbf.s) || ((bits & 2) && j == jbf.e)) return 0.;
+    }
+    return B_CT::face_grad<DIR>(G, P, k, j, i);
+}
+
+} // namespace
+
 TaskStatus B_Cleanup::CornerLaplacian(MeshData<Real>* md, const std::string& p_var, MeshData<Real>* md_again, const std::string& lap_var)
 {
     auto pkg = md->GetMeshPointer()->packages.Get("B_Cleanup");
@@ -357,66 +441,35 @@ TaskStatus B_Cleanup::CornerLaplacian(MeshData<Real>* md, const std::string& p_v
 
     auto P = md->PackVariables(std::vector<std::string>{p_var});
     auto lap = md->PackVariables(std::vector<std::string>{lap_var});
-    auto dB = md->PackVariables(std::vector<std::string>{"dB"}); // Temp
+    const auto bits = BoundaryBits(md);
 
     const int ndim = P.GetNdim();
+    const bool do_3D = ndim > 2;
 
-    // P is defined on cell corners.  We need enough to take
-    // grad -> center, then div -> corner, so one extra in each direction
-    const IndexRange ib_l = IndexRange{ib.s-1, ib.e+1};
-    const IndexRange jb_l = (ndim > 1) ? IndexRange{jb.s-1, jb.e+1} : jb;
-    const IndexRange kb_l = (ndim > 2) ? IndexRange{kb.s-1, kb.e+1} : kb;
     // The div computes corner i,j,k, so needs to be [0,N+1] to cover all physical corners
     const IndexRange ib_r = IndexRange{ib.s, ib.e+1};
     const IndexRange jb_r = (ndim > 1) ? IndexRange{jb.s, jb.e+1} : jb;
     const IndexRange kb_r = (ndim > 2) ? IndexRange{kb.s, kb.e+1} : kb;
 
-    // dB = grad(p), defined at cell centers
-    pmb0->par_for("gradient_P", 0, P.GetDim(5) - 1, kb_l.s, kb_l.e, jb_l.s, jb_l.e, ib_l.s, ib_l.e,
-        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-            const auto& G = P.GetCoords(b);
-            double b1, b2, b3;
-            B_FluxCT::center_grad(G, P(b), k, j, i, ndim > 2, b1, b2, b3);
-            dB(b, V1, k, j, i) = b1;
-            dB(b, V2, k, j, i) = b2;
-            dB(b, V3, k, j, i) = b3;
-        }
-    );
-
-    // Replace ghost zone calculations with strict boundary conditions
-    // Only necessary in j for poles so far, but maybe this should be the condition for outflow too?
-    if (pmb0->coords.coords.is_spherical()) {
-        for (int i=0; i < md->GetMeshPointer()->GetNumMeshBlocksThisRank(); i++) {
-            auto rc = md->GetBlockData(i);
-            auto pmb = rc->GetBlockPointer();
-            auto dB_block = rc->PackVariables(std::vector<std::string>{"dB"});
-            if (pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user) {
-                pmb->par_for("dB_boundary", kb_l.s, kb_l.e, ib_l.s, ib_l.e,
-                    KOKKOS_LAMBDA (const int &k, const int &i) {
-                        dB_block(V1, k, jb.s-1, i) = dB_block(V1, k, jb.s, i);
-                        dB_block(V2, k, jb.s-1, i) = -dB_block(V2, k, jb.s, i);
-                        dB_block(V3, k, jb.s-1, i) = dB_block(V3, k, jb.s, i);
-                    }
-                );
-            }
-            if (pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user) {
-                pmb->par_for("dB_boundary", kb_l.s, kb_l.e, ib_l.s, ib_l.e,
-                    KOKKOS_LAMBDA (const int &k, const int &i) {
-                        dB_block(V1, k, jb.e+1, i) = dB_block(V1, k, jb.e, i);
-                        dB_block(V2, k, jb.e+1, i) = -dB_block(V2, k, jb.e, i);
-                        dB_block(V3, k, jb.e+1, i) = dB_block(V3, k, jb.e, i);
-                    }
-                );
-            }
-        }
-    }
-
-    // lap = div(dB), defined at cell corners
-    pmb0->par_for("laplacian_dB", 0, lap.GetDim(5) - 1, kb_r.s, kb_r.e, jb_r.s, jb_r.e, ib_r.s, ib_r.e,
+    // lap = div(grad(p)), defined at cell corners.  Rather than storing grad(p) at every center,
+    // each corner takes the gradients at its 4 (8) neighboring centers directly.
+    // Matches B_FluxCT::corner_div of B_FluxCT::center_grad, with reflection over the poles
+    pmb0->par_for("laplacian_P", 0, lap.GetDim(5) - 1, kb_r.s, kb_r.e, jb_r.s, jb_r.e, ib_r.s, ib_r.e,
         KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
             const auto& G = lap.GetCoords(b);
-            // This is the inverse diagonal element of a fictional a_ij Laplacian operator
-            lap(b, 0, k, j, i) = B_FluxCT::corner_div(G, dB(b), k, j, i, ndim > 2);
+            const Real norm = (do_3D) ? 0.25 : 0.5;
+            Real term1 = 0., term2 = 0., term3 = 0.;
+            for (int dk = 0; dk <= do_3D; dk++)
+                for (int dj = 0; dj <= 1; dj++)
+                    for (int di = 0; di <= 1; di++) {
+                        Real B1, B2, B3;
+                        reflected_center_grad(G, P(b), k - dk, j - dj, i - di, do_3D, jb, bits(b), B1, B2, B3);
+                        term1 += (di == 0) ? B1 : -B1;
+                        term2 += (dj == 0) ? B2 : -B2;
+                        term3 += (dk == 0) ? B3 : -B3;
+                    }
+            if (!do_3D) term3 = 0.;
+            lap(b, 0, k, j, i) = norm*term1/G.Dxc<1>(i) + norm*term2/G.Dxc<2>(j) + norm*term3/G.Dxc<3>(k);
             if (use_normalized) {
                 lap(b, 0, k, j, i) /= G.gdet(Loci::corner, j, i);
             }
@@ -435,108 +488,48 @@ TaskStatus B_Cleanup::CenterLaplacian(MeshData<Real>* md, const std::string& p_v
 
     auto P = md->PackVariables(std::vector<std::string>{p_var});
     auto lap = md->PackVariables(std::vector<std::string>{lap_var});
-    auto dB = md->PackVariables(std::vector<std::string>{"dB"}); // Temp
+    const auto bits = BoundaryBits(md);
 
     const int ndim = P.GetNdim();
     const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
 
-    // dB = grad(p), interpolating to faces
+    // Faces where grad(p) can be taken, interpolating to faces
     // Do I know why these have to be ::entire?  No.  Does it work?  Yes.
-    // TODO separate gradient functions since we're calculating directions separately anyway
     const IndexRange3 b1 = KDomain::GetRange(md, IndexDomain::entire, F1, 1, -1, false);
-    pmb0->par_for("gradient_P", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
-        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-            const auto& G = P.GetCoords(b);
-            dB(b, F1, 0, k, j, i) = B_CT::face_grad<X1DIR>(G, P(b), k, j, i);
-        }
-    );
     const IndexRange3 b2 = KDomain::GetRange(md, IndexDomain::entire, F2, 1, -1, false);
-    pmb0->par_for("gradient_P", block.s, block.e, b2.ks, b2.ke, b2.js, b2.je, b2.is, b2.ie,
-        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-            const auto& G = P.GetCoords(b);
-            dB(b, F2, 0, k, j, i) = B_CT::face_grad<X2DIR>(G, P(b), k, j, i);
-        }
-    );
-    if (ndim > 2) {
-        const IndexRange3 b3 = KDomain::GetRange(md, IndexDomain::entire, F3, 1, -1, false);
-        pmb0->par_for("gradient_P", block.s, block.e, b3.ks, b3.ke, b3.js, b3.je, b3.is, b3.ie,
-            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-                const auto& G = P.GetCoords(b);
-                dB(b, F3, 0, k, j, i) = B_CT::face_grad<X3DIR>(G, P(b), k, j, i);
-            }
-        );
-    }
-
-    // Make sure B on poles is zero
-    if (pmb0->coords.coords.is_spherical()) {
-        for (int i=0; i < md->GetMeshPointer()->GetNumMeshBlocksThisRank(); i++) {
-            auto rc = md->GetBlockData(i);
-            auto pmb = rc->GetBlockPointer();
-            auto dB_block = rc->PackVariables(std::vector<std::string>{"dB"});
-            const IndexRange3 bi2 = KDomain::GetRange(md, IndexDomain::interior, F2);
-            if (pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user) {
-                pmb->par_for("dB_boundary", b2.ks, b2.ke, bi2.js, bi2.js, b2.is, b2.ie,
-                    KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
-                        dB_block(F2, 0, k, j, i) = 0.;
-                    }
-                );
-            }
-            if (pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user) {
-                pmb->par_for("dB_boundary", b2.ks, b2.ke, bi2.je, bi2.je, b2.is, b2.ie,
-                    KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
-                        dB_block(F2, 0, k, j, i) = 0.;
-                    }
-                );
-            }
-        }
-    }
+    const IndexRange3 b3 = KDomain::GetRange(md, IndexDomain::entire, F3, 1, -1, false);
+    // Polar faces, where B must stay zero
+    const IndexRange3 bi2 = KDomain::GetRange(md, IndexDomain::interior, F2);
+    const IndexRange jbf = IndexRange{bi2.js, bi2.je};
+    // Our outflow conditions guarantee divergence-free last zones, so we shouldn't clean for them
+    const IndexRange3 bic = KDomain::GetRange(md, IndexDomain::interior);
 
-    // lap = div(dB), interpolating back to cell centers
+    // lap = div(grad(p)) in one pass, taking each face gradient as it's needed, interpolating back to cell centers
     const IndexRange3 bc = KDomain::GetRange(md, IndexDomain::entire, CC, false);
-    pmb0->par_for("laplacian_dB", block.s, block.e, bc.ks, bc.ke, bc.js, bc.je, bc.is, bc.ie,
+    pmb0->par_for("laplacian_P", block.s, block.e, bc.ks, bc.ke, bc.js, bc.je, bc.is, bc.ie,
         KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
             const auto& G = lap.GetCoords(b);
+            // Make sure divB on outflows is 0
+            if (((bits(b) & 4) && i <= bic.is) || ((bits(b) & 8) && i >= bic.ie)) {
+                lap(b, 0, k, j, i) = 0.;
+                return;
+            }
             // This is the inverse diagonal element of a fictional a_ij Laplacian operator
-            lap(b, 0, k, j, i) = B_CT::face_div(G, dB(b), ndim, k, j, i);
+            Real du = (masked_face_grad<X1DIR>(G, P(b), k, j, i + 1, b1, jbf, bits(b))
+                       - masked_face_grad<X1DIR>(G, P(b), k, j, i, b1, jbf, bits(b))) / G.Dxc<1>(k, j, i);
+            if (ndim > 1)
+                du += (masked_face_grad<X2DIR>(G, P(b), k, j + 1, i, b2, jbf, bits(b))
+                       - masked_face_grad<X2DIR>(G, P(b), k, j, i, b2, jbf, bits(b))) / G.Dxc<2>(k, j, i);
+            if (ndim > 2)
+                du += (masked_face_grad<X3DIR>(G, P(b), k + 1, j, i, b3, jbf, bits(b))
+                       - masked_face_grad<X3DIR>(G, P(b), k, j, i, b3, jbf, bits(b))) / G.Dxc<3>(k, j, i);
+            lap(b, 0, k, j, i) = du;
             if (use_normalized) {
                 lap(b, 0, k, j, i) /= G.gdet(Loci::corner, j, i);
             }
         }
     );
 
-    // Make sure divB on outflows is 0
-    // Our outflow conditions guarantee divergence-free last zones, so we shouldn't clean for them
-    if (pmb0->packages.Get("Boundaries")->Param<std::string>("inner_x1") == "outflow") {
-        for (int i=0; i < md->GetMeshPointer()->GetNumMeshBlocksThisRank(); i++) {
-            auto rc = md->GetBlockData(i);
-            auto pmb = rc->GetBlockPointer();
-            auto lap_block = rc->PackVariables(std::vector<std::string>{lap_var});
-            const IndexRange3 bic = KDomain::GetRange(md, IndexDomain::interior);
-            if (pmb->boundary_flag[BoundaryFace::inner_x1] == BoundaryFlag::user) {
-                pmb->par_for("lap_boundary", bc.ks, bc.ke, bc.js, bc.je, bc.is, bic.is,
-                    KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
-                        lap_block(0, k, j, i) = 0.;
-                    }
-                );
-            }
-        }
-    }
-    if (pmb0->packages.Get("Boundaries")->Param<std::string>("outer_x1") == "outflow") {
-        for (int i=0; i < md->GetMeshPointer()->GetNumMeshBlocksThisRank(); i++) {
-            auto rc = md->GetBlockData(i);
-            auto pmb = rc->GetBlockPointer();
-            auto lap_block = rc->PackVariables(std::vector<std::string>{lap_var});
-            const IndexRange3 bic = KDomain::GetRange(md, IndexDomain::interior);
-            if (pmb->boundary_flag[BoundaryFace::outer_x1] == BoundaryFlag::user) {
-                pmb->par_for("lap_boundary", bc.ks, bc.ke, bc.js, bc.je, bic.ie, bc.ie,
-                    KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
-                        lap_block(0, k, j, i) = 0.;
-                    }
-                );
-            }
-        }
-    }
-
     return TaskStatus::complete;
 }
 
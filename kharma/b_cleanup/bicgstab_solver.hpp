@@ -25,6 +25,7 @@
 #include "tasks/task_id.hpp"
 #include "tasks/task_list.hpp"
 
+#include "reductions_types.hpp"
 #include "solver_utils.hpp"
 
 namespace parthenon {
@@ -47,11 +48,16 @@ class BiCGStabSolver : BiCGStabCounter {
         sp_accessor(sp), max_iters(pkg->Param<int>("bicgstab_max_iterations")),
         check_interval(pkg->Param<int>("bicgstab_check_interval")),
         fail_flag(pkg->Param<bool>("bicgstab_abort_on_fail")),
-        warn_flag(pkg->Param<bool>("bicgstab_warn_on_fail")), aux_vars(aux_vars) {
+        warn_flag(pkg->Param<bool>("bicgstab_warn_on_fail")),
+        precondition(pkg->Param<bool>("bicgstab_precondition")), aux_vars(aux_vars) {
     Init(pkg, user_flags);
   }
   std::vector<std::string> SolverState() const {
     std::vector<std::string> vars{spm_name, rhs_name, res, res0, vk, pk, tk, temp};
+    if (precondition) {
+      vars.push_back(phat);
+      vars.push_back(shat);
+    }
     vars.insert(vars.end(), aux_vars.begin(), aux_vars.end());
     return vars;
   }
@@ -76,11 +82,15 @@ class BiCGStabSolver : BiCGStabCounter {
   using FMatVec = std::function<TaskStatus(MeshData<Real> *, const std::string &,
                                            MeshData<Real> *, const std::string &)>;
   using FScale = std::function<TaskStatus(MeshData<Real> *, const std::string &)>;
+  // Right preconditioner: approximately solve A out_vec = in_vec, see "bicgstab_precondition"
+  using FPrecon = std::function<TaskStatus(MeshData<Real> *, const std::string &,
+                                           const std::string &)>;
   FMatVec user_MatVec;
   FMatVec user_pre_fluxcor;
   FMatVec user_precomm_MatVec;
   FScale user_precomm_scale;
   FScale user_postcomm_scale;
+  FPrecon user_Precondition;
 
   std::vector<std::string> aux_vars;
 
@@ -118,6 +128,14 @@ class BiCGStabSolver : BiCGStabCounter {
     pkg->AddField(res, meta);
     pkg->AddField(temp, meta);
 
+    // Preconditioned search directions.  These are the MatVec inputs, so they need ghosts
+    phat = "phat" + bicg_id;
+    shat = "shat" + bicg_id;
+    if (precondition) {
+      pkg->AddField(phat, meta);
+      pkg->AddField(shat, meta);
+    }
+
     global_num_bicgstab_solvers++;
   }
 
@@ -133,11 +151,10 @@ class BiCGStabSolver : BiCGStabCounter {
     // initialize some shared state
     bicgstab_cntr = 0;
     global_res0.val = 0.0;
-    global_res.val = 0.0;
-    rhoi.val = 0.0;
+    res_dots.val.assign(2, 0.0);
+    rhoi = 0.0;
     r0_dot_vk.val = 0.0;
-    t_dot_s.val = 0.0;
-    t_dot_t.val = 0.0;
+    omega_dots.val.assign(2, 0.0);
 
     auto MatVec = [this](auto &task_list, const TaskID &init_depend,
                          std::shared_ptr<MeshData<Real>> &spmd,
@@ -214,23 +231,18 @@ class BiCGStabSolver : BiCGStabCounter {
         tl.AddTask(start_global_res0, &AllReduce<Real>::CheckReduce, &global_res0);
     tr.AddRegionalDependencies(reg.ID(), i, finish_global_res0);
 
-    // 1. \hat{r}_0 \cdot r_{i-1}
-    auto get_rhoi = solver.AddTask(init_bicgstab, &Solver_t::DotProduct<MD_t>, this,
-                                   md.get(), res0, res, &rhoi.val);
-    tr.AddRegionalDependencies(reg.ID(), i, get_rhoi);
-    auto start_global_rhoi =
-        (i == 0 ? solver.AddTask(get_rhoi, &AllReduce<Real>::StartReduce, &rhoi, MPI_SUM)
-                : get_rhoi);
-    auto finish_global_rhoi =
-        solver.AddTask(start_global_rhoi, &AllReduce<Real>::CheckReduce, &rhoi);
+    // 1. \hat{r}_0 \cdot r_{i-1} [Not a separate reduction: r_0 = \hat{r}_0 at first, after
+    //    which it is reduced alongside the residual norm in step 11]
 
     // 2. \beta = (rho_i/rho_{i-1}) (\alpha / \omega_{i-1})
     // 3. p_i = r_{i-1} + \beta (p_{i-1} - \omega_{i-1} v_{i-1})
     auto update_pk =
-        solver.AddTask(finish_global_rhoi, &Solver_t::Compute_pk<MD_t>, this, md.get());
+        solver.AddTask(finish_global_res0, &Solver_t::Compute_pk<MD_t>, this, md.get());
 
-    // 4. v = A p
-    auto get_v = MatVec(solver, update_pk, md, pk, vk);
+    // 4. v = A p [With preconditioning, \hat{p} = M^{-1} p and v = A \hat{p}]
+    auto get_v = (precondition) ?
+        MatVec(solver, solver.AddTask(update_pk, user_Precondition, md.get(), pk, phat), md, phat, vk) :
+        MatVec(solver, update_pk, md, pk, vk);
 
     // 5. alpha = rho_i / (\hat{r}_0 \cdot v_i) [Actually just calculate \hat{r}_0 \cdot
     // v_i]
@@ -251,38 +263,35 @@ class BiCGStabSolver : BiCGStabCounter {
     auto get_s = solver.AddTask(finish_global_r0dotv, &Solver_t::Update_h_and_s<MD_t>,
                                 this, md.get(), mout.get());
 
-    // 9. t = A s
-    auto get_t = MatVec(solver, get_s, md, res, tk);
+    // 9. t = A s [With preconditioning, \hat{s} = M^{-1} s and t = A \hat{s}]
+    auto get_t = (precondition) ?
+        MatVec(solver, solver.AddTask(get_s, user_Precondition, md.get(), res, shat), md, shat, tk) :
+        MatVec(solver, get_s, md, res, tk);
 
-    // 10. omega = (t \cdot s) / (t \cdot t)
+    // 10. omega = (t \cdot s) / (t \cdot t) [Both products in one pass & one reduction]
     auto get_tdots = solver.AddTask(get_t, &Solver_t::OmegaDotProd<MD_t>, this, md.get(),
-                                    &t_dot_s.val, &t_dot_t.val);
+                                    &omega_dots.val);
     tr.AddRegionalDependencies(reg.ID(), i, get_tdots);
     auto start_global_tdots =
         (i == 0
-             ? solver.AddTask(get_tdots, &AllReduce<Real>::StartReduce, &t_dot_s, MPI_SUM)
-             : get_tdots);
-    auto finish_global_tdots =
-        solver.AddTask(start_global_tdots, &AllReduce<Real>::CheckReduce, &t_dot_s);
-    auto start_global_tdott =
-        (i == 0
-             ? solver.AddTask(get_tdots, &AllReduce<Real>::StartReduce, &t_dot_t, MPI_SUM)
+             ? solver.AddTask(get_tdots, &AllReduce<std::vector<Real>>::StartReduce,
+                              &omega_dots, MPI_SUM)
              : get_tdots);
-    auto finish_global_tdott =
-        solver.AddTask(start_global_tdott, &AllReduce<Real>::CheckReduce, &t_dot_t);
+    auto finish_global_tdots = solver.AddTask(
+        start_global_tdots, &AllReduce<std::vector<Real>>::CheckReduce, &omega_dots);
     // omega is actually updated in this next task
 
-    // 11. update x and residual
-    auto update_x = solver.AddTask(finish_global_tdots | finish_global_tdott,
-                                   &Solver_t::Update_x_res<MD_t>, this, md.get(),
-                                   mout.get(), &global_res.val);
+    // 11. update x and residual, computing |r_i|^2 and \hat{r}_0 \cdot r_i (rho_{i+1})
+    //     in the same pass for one reduction
+    auto update_x = solver.AddTask(finish_global_tdots, &Solver_t::Update_x_res<MD_t>,
+                                   this, md.get(), mout.get(), &res_dots.val);
     tr.AddRegionalDependencies(reg.ID(), i, update_x);
     auto start_global_res =
-        (i == 0 ? solver.AddTask(update_x, &AllReduce<Real>::StartReduce, &global_res,
-                                 MPI_SUM)
+        (i == 0 ? solver.AddTask(update_x, &AllReduce<std::vector<Real>>::StartReduce,
+                                 &res_dots, MPI_SUM)
                 : update_x);
-    auto finish_global_res =
-        solver.AddTask(start_global_res, &AllReduce<Real>::CheckReduce, &global_res);
+    auto finish_global_res = solver.AddTask(
+        start_global_res, &AllReduce<std::vector<Real>>::CheckReduce, &res_dots);
 
     // 12. check for convergence
     auto check = solver.SetCompletionTask(finish_global_res, &Solver_t::CheckConvergence,
@@ -409,16 +418,18 @@ class BiCGStabSolver : BiCGStabCounter {
     const int ires0 = imap[res0].first;
     const int ivk = imap[vk].first;
 
-    const Real beta = (rhoi.val / rhoi_old) * (alpha_old / omega_old);
+    // On the first iteration r = \hat{r}_0, so rho is the initial residual (not yet square-rooted)
+    if (bicgstab_cntr == 0) rhoi = global_res0.val;
+    const Real beta = (rhoi / rhoi_old) * (alpha_old / omega_old);
     bool reset = false;
-    // if (std::abs(rhoi.val) < 1.e-8) {
+    // if (std::abs(rhoi) < 1.e-8) {
     //   // Reset
-    //   printf("Resetting (r_{i-1}, r_0) = %e res = %e \n", rhoi.val, res_old);
-    //   rhoi.val = res_old; // this should be the norm of the old residual, which we are
+    //   printf("Resetting (r_{i-1}, r_0) = %e res = %e \n", rhoi, res_old);
+    //   rhoi = res_old; // this should be the norm of the old residual, which we are
     //   resetting to reset = true;
     // }
     // printf("Compute_pk: rho_i = %e rho_{i-1} = %e alpha_old = %e omega_old = %e beta =
-    // %e\n", rhoi.val, rhoi_old, alpha_old, omega_old, beta); rhoi_old = rhoi.val;
+    // %e\n", rhoi, rhoi_old, alpha_old, omega_old, beta); rhoi_old = rhoi;
     const Real w_o = omega_old;
     par_for(
         DEFAULT_LOOP_PATTERN, "compute pk", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s,
@@ -475,15 +486,17 @@ class BiCGStabSolver : BiCGStabCounter {
     const auto jb = IndexRange{jbi.s, jbi.e + (ndim > 1)};
     const auto kb = IndexRange{kbi.s, kbi.e + (ndim > 2)};
 
+    // The solution moves along the preconditioned direction, if any
+    const std::string &p_dir = (precondition) ? phat : pk;
     PackIndexMap imap;
-    auto &v = u->PackVariables(std::vector<std::string>({res, pk, vk}), imap);
+    auto &v = u->PackVariables(std::vector<std::string>({res, p_dir, vk}), imap);
     auto &dv = du->PackVariables(std::vector<std::string>({sol_name}));
     const int ires = imap[res].first;
-    const int ipk = imap[pk].first;
+    const int ipk = imap[p_dir].first;
     const int ivk = imap[vk].first;
 
-    Real alpha = rhoi.val / r0_dot_vk.val;
-    // printf("alpha = %e rho = %e (v, r_0) = %e\n", alpha, rhoi.val, r0_dot_vk.val);
+    Real alpha = rhoi / r0_dot_vk.val;
+    // printf("alpha = %e rho = %e (v, r_0) = %e\n", alpha, rhoi, r0_dot_vk.val);
     if (std::abs(r0_dot_vk.val) < 1.e-200) alpha = 0.0;
     par_for(
         DEFAULT_LOOP_PATTERN, "Update_h", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s, kb.e,
@@ -507,8 +520,8 @@ class BiCGStabSolver : BiCGStabCounter {
 
     auto &v = u->PackVariables(std::vector<std::string>({pk}));
     auto &dv = du->PackVariables(std::vector<std::string>({sol_name}));
-    Real alpha = rhoi.val / r0_dot_vk.val;
-    // printf("Update_h: r0_dot_vk = %e rhoi = %e alpha = %e\n", r0_dot_vk.val, rhoi.val,
+    Real alpha = rhoi / r0_dot_vk.val;
+    // printf("Update_h: r0_dot_vk = %e rhoi = %e alpha = %e\n", r0_dot_vk.val, rhoi,
     // alpha);
     par_for(
         DEFAULT_LOOP_PATTERN, "Update_h", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s, kb.e,
@@ -533,8 +546,8 @@ class BiCGStabSolver : BiCGStabCounter {
     auto &v = u->PackVariables(std::vector<std::string>({res, vk}), imap);
     const int ires = imap[res].first;
     const int ivk = imap[vk].first;
-    Real alpha = rhoi.val / r0_dot_vk.val;
-    // printf("Update_s: r0_dot_vk = %e rhoi = %e alpha = %e\n", r0_dot_vk.val, rhoi.val,
+    Real alpha = rhoi / r0_dot_vk.val;
+    // printf("Update_s: r0_dot_vk = %e rhoi = %e alpha = %e\n", r0_dot_vk.val, rhoi,
     // alpha);
     par_for(
         DEFAULT_LOOP_PATTERN, "Update_s", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s, kb.e,
@@ -546,7 +559,7 @@ class BiCGStabSolver : BiCGStabCounter {
   }
 
   template <typename T>
-  TaskStatus OmegaDotProd(T *u, Real *t_dot_s, Real *t_dot_t) {
+  TaskStatus OmegaDotProd(T *u, std::vector<Real> *dots) {
     const auto &ibi = u->GetBoundsI(IndexDomain::interior);
     const auto &jbi = u->GetBoundsJ(IndexDomain::interior);
     const auto &kbi = u->GetBoundsK(IndexDomain::interior);
@@ -557,33 +570,24 @@ class BiCGStabSolver : BiCGStabCounter {
 
     auto &v = u->PackVariables(std::vector<std::string>({tk, res}));
 
-    // TODO(JCD): these should probably be merged
-    Real ts_sum(0);
+    // t \cdot s and t \cdot t together
+    Reductions::array_type<Real, 2> sums;
     par_reduce(
         loop_pattern_mdrange_tag, "tk dot sk", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s,
         kb.e, jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lsum) {
-          lsum += v(b, 0, k, j, i) * v(b, 1, k, j, i);
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                      Reductions::array_type<Real, 2> &lsum) {
+          lsum.my_array[0] += v(b, 0, k, j, i) * v(b, 1, k, j, i);
+          lsum.my_array[1] += v(b, 0, k, j, i) * v(b, 0, k, j, i);
         },
-        Kokkos::Sum<Real>(ts_sum));
-    *t_dot_s += ts_sum;
-
-    Real tt_sum(0);
-    par_reduce(
-        loop_pattern_mdrange_tag, "tk dot sk", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s,
-        kb.e, jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lsum) {
-          lsum += v(b, 0, k, j, i) * v(b, 0, k, j, i);
-        },
-        Kokkos::Sum<Real>(tt_sum));
-    *t_dot_t += tt_sum;
-    // printf("OmegaDotProd: t_dot_s = %e (%e) t_dot_t = %e (%e)\n", *t_dot_s, ts_sum,
-    // *t_dot_t, tt_sum);
+        Reductions::ArraySum<Real, HostExecSpace, 2>(sums));
+    (*dots)[0] += sums.my_array[0];
+    (*dots)[1] += sums.my_array[1];
     return TaskStatus::complete;
   }
 
   template <typename T>
-  TaskStatus Update_x_res(T *u, T *du, Real *gres) {
+  TaskStatus Update_x_res(T *u, T *du, std::vector<Real> *dots) {
     const auto &ibi = u->GetBoundsI(IndexDomain::interior);
     const auto &jbi = u->GetBoundsJ(IndexDomain::interior);
     const auto &kbi = u->GetBoundsK(IndexDomain::interior);
@@ -593,42 +597,50 @@ class BiCGStabSolver : BiCGStabCounter {
     const auto kb = IndexRange{kbi.s, kbi.e + (ndim > 2)};
 
     PackIndexMap imap;
-    auto &v = u->PackVariables(std::vector<std::string>({res, tk}), imap);
+    std::vector<std::string> vars({res, tk, res0});
+    if (precondition) vars.push_back(shat);
+    auto &v = u->PackVariables(vars, imap);
     const int ires = imap[res].first;
     const int itk = imap[tk].first;
+    const int ires0 = imap[res0].first;
+    // The solution moves along the preconditioned direction, if any
+    const int is = (precondition) ? imap[shat].first : ires;
     auto &dv = du->PackVariables(std::vector<std::string>({sol_name}));
-    Real omega = t_dot_s.val / t_dot_t.val;
-    if (std::abs(t_dot_t.val) < 1.e-200) omega = 0.0;
-    Real err(0);
+    Real omega = omega_dots.val[0] / omega_dots.val[1];
+    if (std::abs(omega_dots.val[1]) < 1.e-200) omega = 0.0;
+    // |r|^2 for convergence, and \hat{r}_0 \cdot r for the next iteration's rho
+    Reductions::array_type<Real, 2> sums;
     par_reduce(
         loop_pattern_mdrange_tag, "Update_x", DevExecSpace(), 0, v.GetDim(5) - 1, kb.s,
         kb.e, jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lerr) {
-          dv(b, 0, k, j, i) += omega * v(b, ires, k, j, i);
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                      Reductions::array_type<Real, 2> &lsum) {
+          dv(b, 0, k, j, i) += omega * v(b, is, k, j, i);
           v(b, ires, k, j, i) -= omega * v(b, itk, k, j, i);
-          lerr += v(b, ires, k, j, i) * v(b, ires, k, j, i);
+          lsum.my_array[0] += v(b, ires, k, j, i) * v(b, ires, k, j, i);
+          lsum.my_array[1] += v(b, ires0, k, j, i) * v(b, ires, k, j, i);
         },
-        Kokkos::Sum<Real>(err));
-    *gres += err;
+        Reductions::ArraySum<Real, HostExecSpace, 2>(sums));
+    (*dots)[0] += sums.my_array[0];
+    (*dots)[1] += sums.my_array[1];
     return TaskStatus::complete;
   }
 
   TaskStatus CheckConvergence(const int &i, bool report) {
     if (i != 0) return TaskStatus::complete;
     bicgstab_cntr++;
-    global_res.val = std::sqrt(global_res.val);
+    const Real global_res = std::sqrt(res_dots.val[0]);
     if (bicgstab_cntr == 1) global_res0.val = std::sqrt(global_res0.val);
 
-    // printf("rhoi: %e r0_dot_vk: %e t_dot_t: %e\n", rhoi.val, r0_dot_vk.val,
-    // t_dot_s.val);
     //  Update global scalars
-    rhoi_old = rhoi.val;
-    alpha_old = rhoi.val / r0_dot_vk.val;
-    omega_old = t_dot_s.val / t_dot_t.val;
-    res_old = global_res.val;
+    rhoi_old = rhoi;
+    alpha_old = rhoi / r0_dot_vk.val;
+    omega_old = omega_dots.val[0] / omega_dots.val[1];
+    res_old = global_res;
+    rhoi = res_dots.val[1];
 
-    bool converged = std::abs(global_res.val / global_res0.val) < rel_error_tol
-                    || std::abs(global_res.val) < abs_error_tol;
+    bool converged = std::abs(global_res / global_res0.val) < rel_error_tol
+                    || std::abs(global_res) < abs_error_tol;
 
     bool stop = bicgstab_cntr == max_iters;
     if (std::abs(alpha_old) < 1.e-8 && std::abs(omega_old) < 1.e-8) stop = true;
@@ -636,19 +648,17 @@ class BiCGStabSolver : BiCGStabCounter {
       if (Globals::my_rank == 0) {
         std::cout << " its= " << bicgstab_cntr << " rho= " << rhoi_old
                   << " alpha= " << alpha_old << " omega= " << omega_old
-                  << " relative-res: " << global_res.val / global_res0.val
-                  << " absolute-res: " << global_res.val
+                  << " relative-res: " << global_res / global_res0.val
+                  << " absolute-res: " << global_res
                   << " absolute-res0: " << global_res0.val << " relerr-tol: " << rel_error_tol
                   << " abserr-tol: " << abs_error_tol
                   << std::endl;
       }
     }
 
-    global_res.val = 0.0;
-    rhoi.val = 0.0;
+    res_dots.val.assign(2, 0.0);
     r0_dot_vk.val = 0.0;
-    t_dot_s.val = 0.0;
-    t_dot_t.val = 0.0;
+    omega_dots.val.assign(2, 0.0);
 
     return converged || stop ? TaskStatus::complete : TaskStatus::iterate;
   }
@@ -657,17 +667,17 @@ class BiCGStabSolver : BiCGStabCounter {
   Real rel_error_tol, abs_error_tol;
   SparseMatrixAccessor sp_accessor;
   int max_iters, check_interval, bicgstab_cntr;
-  bool fail_flag, warn_flag;
-  std::string spm_name, sol_name, rhs_name, res, res0, vk, pk, tk, temp, solver_name;
+  bool fail_flag, warn_flag, precondition;
+  std::string spm_name, sol_name, rhs_name, res, res0, vk, pk, tk, temp, phat, shat, solver_name;
 
-  Real rhoi_old, alpha_old, omega_old, res_old;
+  Real rhoi, rhoi_old, alpha_old, omega_old, res_old;
 
   AllReduce<Real> global_res0;
-  AllReduce<Real> global_res;
-  AllReduce<Real> rhoi;
+  // Fused: |r|^2 & \hat{r}_0 \cdot r
+  AllReduce<std::vector<Real>> res_dots;
   AllReduce<Real> r0_dot_vk;
-  AllReduce<Real> t_dot_s;
-  AllReduce<Real> t_dot_t;
+  // Fused: t \cdot s & t \cdot t
+  AllReduce<std::vector<Real>> omega_dots;
 };
 
 } // namespace solvers
@@ -0,0 +1,226 @@
+/* 
+ *  File: multigrid.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2026, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "b_cleanup.hpp"
+
+#include "domain.hpp"
+
+/**
+ * Block-local geometric multigrid for preconditioning the divergence solve.  Both the corner & center
+ * Laplacians are built from plain differences in native coordinates, so each block's operator is close
+ * to the constant-coefficient 7-point Laplacian, which is what we re-discretize on each level.
+ */
+
+namespace {
+
+// Value at a level's point, with zero (Dirichlet) values outside the block
+KOKKOS_FORCEINLINE_FUNCTION Real at(const ParArray4D<Real> &u, const int &b, const int &k, const int &j, const int &i,
+                                   const int &n3, const int &n2, const int &n1)
+{
+    return (k < 0 || k >= n3 || j < 0 || j >= n2 || i < 0 || i >= n1) ? 0. : u(b, k, j, i);
+}
+
+KOKKOS_FORCEINLINE_FUNCTION Real lap7(const ParArray4D<Real> &u, const int &b, const int &k, const int &j, const int &i,
+                                     const int &n3, const int &n2, const int &n1,
+                                     const Real &ih1, const Real &ih2, const Real &ih3)
+{
+    const Real c = 2. * u(b, k, j, i);
+    return ih1 * (at(u, b, k, j, i + 1, n3, n2, n1) - c + at(u, b, k, j, i - 1, n3, n2, n1))
+         + ih2 * (at(u, b, k, j + 1, i, n3, n2, n1) - c + at(u, b, k, j - 1, i, n3, n2, n1))
+         + ih3 * (at(u, b, k + 1, j, i, n3, n2, n1) - c + at(u, b, k - 1, j, i, n3, n2, n1));
+}
+
+// Inverse squared spacings of level l, zero in directions with one point
+KOKKOS_FORCEINLINE_FUNCTION void inv_spacings(const GRCoordinates &G, const int &l, const int &n3, const int &n2, const int &n1,
+                                              Real &ih1, Real &ih2, Real &ih3)
+{
+    const Real s = 1 << l;
+    ih1 = (n1 > 1) ? 1. / m::pow(G.Dxc<1>(0) * s, 2) : 0.;
+    ih2 = (n2 > 1) ? 1. / m::pow(G.Dxc<2>(0) * s, 2) : 0.;
+    ih3 = (n3 > 1) ? 1. / m::pow(G.Dxc<3>(0) * s, 2) : 0.;
+}
+
+/**
+ * Build the hierarchy for the solver's range, unless the existing one matches
+ */
+std::vector<B_Cleanup::MGLevel> &GetHierarchy(MeshData<Real> *md, const int nb, const int n3, const int n2, const int n1)
+{
+    auto &params = md->GetMeshPointer()->packages.Get("B_Cleanup")->AllParams();
+    auto &levels = *params.GetMutable<std::vector<B_Cleanup::MGLevel>>("mg_hierarchy");
+    if (levels.size() > 0 && levels[0].u.extent_int(0) == nb &&
+        levels[0].n3 == n3 && levels[0].n2 == n2 && levels[0].n1 == n1) return levels;
+
+    levels.clear();
+    const int max_levels = params.Get<int>("mg_levels");
+    int n[3] = {n1, n2, n3};
+    while (true) {
+        levels.push_back(B_Cleanup::MGLevel{ParArray4D<Real>("B_Cleanup.mg_u", nb, n[2], n[1], n[0]),
+                                            ParArray4D<Real>("B_Cleanup.mg_f", nb, n[2], n[1], n[0]),
+                                            ParArray4D<Real>("B_Cleanup.mg_tmp", nb, n[2], n[1], n[0]),
+                                            n[0], n[1], n[2]});
+        if (static_cast<int>(levels.size()) >= max_levels) break;
+        // Halve while every direction in use has an odd number of points, leaving at least 3
+        bool coarsen = true;
+        for (int d = 0; d < 3; d++)
+            if (n[d] > 1 && (n[d] < 5 || n[d] % 2 == 0)) coarsen = false;
+        if (!coarsen) break;
+        for (int d = 0; d < 3; d++)
+            if (n[d] > 1) n[d] = (n[d] + 1) / 2;
+    }
+    return levels;
+}
+
+} // namespace
+
+TaskStatus B_Cleanup::MGPrecondition(MeshData<Real>* md, const std::string& in_var, const std::string& out_var)
+{
+    Flag("MGPrecondition");
+    auto pkg = md->GetMeshPointer()->packages.Get("B_Cleanup");
+    const auto use_normalized = pkg->Param<bool>("use_normalized_divb");
+    const int sweeps = pkg->Param<int>("mg_sweeps");
+    const int coarse_sweeps = pkg->Param<int>("mg_coarse_sweeps");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    auto in = md->PackVariables(std::vector<std::string>{in_var});
+    auto out = md->PackVariables(std::vector<std::string>{out_var});
+    const int ndim = in.GetNdim();
+    const int nb = in.GetDim(5);
+
+    // Same range the solver operates on: every physical corner
+    const IndexRange ib = md->GetBoundsI(IndexDomain::interior);
+    const IndexRange jb = md->GetBoundsJ(IndexDomain::interior);
+    const IndexRange kb = md->GetBoundsK(IndexDomain::interior);
+    const int is = ib.s, js = jb.s, ks = kb.s;
+    auto &levels = GetHierarchy(md, nb, kb.e - kb.s + 1 + (ndim > 2), jb.e - jb.s + 1 + (ndim > 1), ib.e - ib.s + 1 + (ndim > 0));
+    const int nlevels = levels.size();
+
+    // Weighted Jacobi, leaving the result in L.u
+    auto smooth = [&](const int l, const int nsweeps) {
+        const int n1 = levels[l].n1, n2 = levels[l].n2, n3 = levels[l].n3;
+        for (int s = 0; s < nsweeps; s++) {
+            const auto u = levels[l].u, f = levels[l].f, u_new = levels[l].tmp;
+            pmb0->par_for("mg_smooth", 0, nb - 1, 0, n3 - 1, 0, n2 - 1, 0, n1 - 1,
+                KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                    const auto& G = in.GetCoords(b);
+                    Real ih1, ih2, ih3;
+                    inv_spacings(G, l, n3, n2, n1, ih1, ih2, ih3);
+                    const Real diag = -2. * (ih1 + ih2 + ih3);
+                    u_new(b, k, j, i) = u(b, k, j, i) + (2./3.) * (f(b, k, j, i) - lap7(u, b, k, j, i, n3, n2, n1, ih1, ih2, ih3)) / diag;
+                }
+            );
+            std::swap(levels[l].u, levels[l].tmp);
+        }
+    };
+
+    // Finest level: approximately solve A u = in.  The normalized operator is L/gdet, so solve L u = gdet in
+    {
+        const auto u = levels[0].u, f = levels[0].f;
+        const int n1 = levels[0].n1, n2 = levels[0].n2, n3 = levels[0].n3;
+        pmb0->par_for("mg_load", 0, nb - 1, 0, n3 - 1, 0, n2 - 1, 0, n1 - 1,
+            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                const auto& G = in.GetCoords(b);
+                const Real norm = (use_normalized) ? G.gdet(Loci::corner, j + js, i + is) : 1.;
+                f(b, k, j, i) = norm * in(b, 0, k + ks, j + js, i + is);
+                u(b, k, j, i) = 0.;
+            }
+        );
+    }
+
+    // Down: smooth, then restrict the residual by full weighting as the next coarser right-hand side
+    for (int l = 0; l < nlevels - 1; l++) {
+        smooth(l, sweeps);
+        const auto u = levels[l].u, f = levels[l].f, r = levels[l].tmp;
+        const int n1 = levels[l].n1, n2 = levels[l].n2, n3 = levels[l].n3;
+        pmb0->par_for("mg_residual", 0, nb - 1, 0, n3 - 1, 0, n2 - 1, 0, n1 - 1,
+            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                const auto& G = in.GetCoords(b);
+                Real ih1, ih2, ih3;
+                inv_spacings(G, l, n3, n2, n1, ih1, ih2, ih3);
+                r(b, k, j, i) = f(b, k, j, i) - lap7(u, b, k, j, i, n3, n2, n1, ih1, ih2, ih3);
+            }
+        );
+        const auto uc = levels[l+1].u, fc = levels[l+1].f;
+        const int nc1 = levels[l+1].n1, nc2 = levels[l+1].n2, nc3 = levels[l+1].n3;
+        pmb0->par_for("mg_restrict", 0, nb - 1, 0, nc3 - 1, 0, nc2 - 1, 0, nc1 - 1,
+            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                Real sum = 0.;
+                for (int dk = -(n3 > 1); dk <= (n3 > 1); dk++)
+                    for (int dj = -(n2 > 1); dj <= (n2 > 1); dj++)
+                        for (int di = -(n1 > 1); di <= (n1 > 1); di++) {
+                            const Real w = ((n3 > 1) ? (dk == 0 ? 0.5 : 0.25) : 1.) *
+                                           ((n2 > 1) ? (dj == 0 ? 0.5 : 0.25) : 1.) *
+                                           ((n1 > 1) ? (di == 0 ? 0.5 : 0.25) : 1.);
+                            sum += w * at(r, b, 2*k + dk, 2*j + dj, 2*i + di, n3, n2, n1);
+                        }
+                fc(b, k, j, i) = sum;
+                uc(b, k, j, i) = 0.;
+            }
+        );
+    }
+
+    smooth(nlevels - 1, coarse_sweeps);
+
+    // Up: add the linearly-interpolated coarse correction, then smooth
+    for (int l = nlevels - 2; l >= 0; l--) {
+        const auto u = levels[l].u, uc = levels[l+1].u;
+        const int n1 = levels[l].n1, n2 = levels[l].n2, n3 = levels[l].n3;
+        pmb0->par_for("mg_prolongate", 0, nb - 1, 0, n3 - 1, 0, n2 - 1, 0, n1 - 1,
+            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                // Even points lie on a coarse point, odd points between two
+                Real sum = 0.;
+                for (int ak = 0; ak <= k % 2; ak++)
+                    for (int aj = 0; aj <= j % 2; aj++)
+                        for (int ai = 0; ai <= i % 2; ai++) {
+                            const Real w = ((k % 2) ? 0.5 : 1.) * ((j % 2) ? 0.5 : 1.) * ((i % 2) ? 0.5 : 1.);
+                            sum += w * uc(b, k/2 + ak, j/2 + aj, i/2 + ai);
+                        }
+                u(b, k, j, i) += sum;
+            }
+        );
+        smooth(l, sweeps);
+    }
+
+    {
+        const auto u = levels[0].u;
+        const int n1 = levels[0].n1, n2 = levels[0].n2, n3 = levels[0].n3;
+        pmb0->par_for("mg_store", 0, nb - 1, 0, n3 - 1, 0, n2 - 1, 0, n1 - 1,
+            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+                out(b, 0, k + ks, j + js, i + is) = u(b, k, j, i);
+            }
+        );
+    }
+
+    EndFlag();
+    return TaskStatus::complete;
+}
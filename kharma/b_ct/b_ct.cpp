@@ -33,6 +33,7 @@
  */
 #include "b_ct.hpp"
 
+#include "boundaries.hpp"
 #include "decs.hpp"
 #include "domain.hpp"
 #include "grmhd.hpp"
@@ -47,6 +48,199 @@ using parthenon::refinement_ops::ProlongateSharedMinMod;
 using parthenon::refinement_ops::RestrictAverage;
 using parthenon::refinement_ops::ProlongateInternalAverage;
 
+namespace {
+/**
+ * Weight of the left-hand state when upwinding across a face, following the HLL form:
+ * the left state is carried by the right-going signal speed and vice versa.
+ * cmin is stored positive for leftward waves, as in the Riemann solvers.
+ */
+KOKKOS_INLINE_FUNCTION Real hll_weight(const Real& cmax, const Real& cmin)
+{
+    const Real ctot = cmax + cmin;
+    return (ctot > 0.) ? cmax / ctot : 0.5;
+}
+
+enum class CTScheme {bs99, gs05_0, gs05_c, gs05_hll};
+
+/**
+ * Everything needed to calculate the EMF on any edge from the face fluxes,
+ * so the same code can fill B_CT.emf or be used directly in the face update
+ */
+struct EMFPacks {
+    MeshBlockPack<VariableFluxPack<Real>> B_U, rho;
+    MeshBlockPack<VariablePack<Real>> emfc, cmax, cmin;
+    CTScheme scheme;
+    int ndim;
+};
+
+/**
+ * Pack the fluxes used by the chosen scheme, and calculate the zone-center EMFs if it needs them
+ */
+EMFPacks PrepareEMF(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const std::string scheme = pmesh->packages.Get("B_CT")->Param<std::string>("ct_scheme");
+
+    EMFPacks d;
+    d.ndim = pmesh->ndim;
+    d.scheme = (scheme == "gs05_0") ? CTScheme::gs05_0 :
+               (scheme == "gs05_c" || scheme == "sg07") ? CTScheme::gs05_c :
+               (scheme == "gs05_hll") ? CTScheme::gs05_hll : CTScheme::bs99;
+    d.B_U = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.B"});
+    if (d.scheme == CTScheme::gs05_c)
+        d.rho = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.rho"});
+    if (d.scheme == CTScheme::gs05_hll) {
+        d.cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+        d.cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+    }
+
+    if (d.scheme != CTScheme::bs99) {
+        // Additional terms for Stone & Gardiner '09
+        // Caclulate the EMF at zone centers with primitive B, U1-3
+        PackIndexMap prims_map;
+        auto& P = md->PackVariables(std::vector<std::string>{"prims.uvec", "prims.B"}, prims_map);
+        const VarMap m_p(prims_map, false);
+        d.emfc = md->PackVariables(std::vector<std::string>{"B_CT.cemf"});
+        const auto& emfc = d.emfc;
+        const IndexRange block = IndexRange{0, emfc.GetDim(5)-1};
+        // Need this over whole domain to have halo around EMF caclulation
+        const IndexRange3 be = KDomain::GetRange(md, IndexDomain::entire);
+        pmb0->par_for("B_CT_emfc", block.s, block.e, be.ks, be.ke, be.js, be.je, be.is, be.ie,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+                const auto& G = P.GetCoords(bl);
+                Real gdet = G.gdet(Loci::center, j, i);
+
+                // Get the 4vecs
+                FourVectors D;
+                GRMHD::calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, D);
+
+                // Calculate cell-center EMF w/v x B
+                emfc(bl, V1, k, j, i) = (D.bcon[2]*D.ucon[3] - D.bcon[3]*D.ucon[2]) * gdet;
+                emfc(bl, V2, k, j, i) = (D.bcon[3]*D.ucon[1] - D.bcon[1]*D.ucon[3]) * gdet;
+                emfc(bl, V3, k, j, i) = (D.bcon[1]*D.ucon[2] - D.bcon[2]*D.ucon[1]) * gdet;
+            }
+        );
+    }
+    return d;
+}
+
+/**
+ * Weight of the left-hand candidate when integrating the EMF to a corner, across face (dir, k, j, i).
+ * Following AthenaK for gs05_c, including clever use of the mass flux for the sign of the contact mode.
+ */
+KOKKOS_INLINE_FUNCTION Real upwind_weight(const EMFPacks& d, const int& bl, const int& dir,
+                                          const int& k, const int& j, const int& i)
+{
+    if (d.scheme == CTScheme::gs05_hll)
+        return hll_weight(d.cmax(bl, dir-1, k, j, i), d.cmin(bl, dir-1, k, j, i));
+    return (d.rho(bl).flux(dir, 0, k, j, i) >= 0.0) ? 1. : 0.;
+}
+KOKKOS_INLINE_FUNCTION Real upwind(const Real& w, const Real& left, const Real& right)
+{
+    // Pick exactly one side when switching on the contact, so as not to mix in a bad value
+    return (w == 1.) ? left : ((w == 0.) ? right : w * left + (1. - w) * right);
+}
+
+/**
+ * EMFs at the edges of zone (k, j, i), for 2D+. The base is the average of the B field
+ * fluxes, which is the entirety of B&S '99, plus the correction for the chosen scheme.
+ * We use this form rather than multiply by edge length here, since the default
+ * restriction op averages values
+ */
+KOKKOS_INLINE_FUNCTION Real corner_emf_E1(const EMFPacks& d, const int& bl, const int& k, const int& j, const int& i)
+{
+    const auto& B_U = d.B_U;
+    const auto& emfc = d.emfc;
+    if (d.ndim < 3) return -B_U(bl).flux(X2DIR, V3, k, j, i);
+    const Real emf = 0.25*(-B_U(bl).flux(X2DIR, V3, k - 1, j, i) - B_U(bl).flux(X2DIR, V3, k, j, i)
+                          + B_U(bl).flux(X3DIR, V2, k, j - 1, i) + B_U(bl).flux(X3DIR, V2, k, j, i));
+    if (d.scheme == CTScheme::bs99) {
+        return emf;
+    } else if (d.scheme == CTScheme::gs05_0) {
+        // Just subtract centered emf from twice the face version
+        // More stable for planar flows even without anything fancy
+        return 2 * emf - 0.25*(emfc(bl, V1, k, j, i)      + emfc(bl, V1, k, j - 1, i)
+                             + emfc(bl, V1, k, j - 1, i)  + emfc(bl, V1, k - 1, j - 1, i));
+    }
+    // Integrate EMF to the corner using GS07 i.e. GS05 E^c upwinding
+    const Real e1_l3 = upwind(upwind_weight(d, bl, X2DIR, k-1, j, i),
+                              B_U(bl).flux(X3DIR, V2, k, j-1, i) - emfc(bl, V1, k-1, j-1, i),
+                              B_U(bl).flux(X3DIR, V2, k, j  , i) - emfc(bl, V1, k-1, j  , i));
+    const Real e1_r3 = upwind(upwind_weight(d, bl, X2DIR, k  , j, i),
+                              B_U(bl).flux(X3DIR, V2, k, j-1, i) - emfc(bl, V1, k  , j-1, i),
+                              B_U(bl).flux(X3DIR, V2, k, j  , i) - emfc(bl, V1, k  , j  , i));
+    const Real e1_l2 = upwind(upwind_weight(d, bl, X3DIR, k, j-1, i),
+                              -B_U(bl).flux(X2DIR, V3, k-1, j, i) - emfc(bl, V1, k-1, j-1, i),
+                              -B_U(bl).flux(X2DIR, V3, k  , j, i) - emfc(bl, V1, k  , j-1, i));
+    const Real e1_r2 = upwind(upwind_weight(d, bl, X3DIR, k, j  , i),
+                              -B_U(bl).flux(X2DIR, V3, k-1, j, i) - emfc(bl, V1, k-1, j  , i),
+                              -B_U(bl).flux(X2DIR, V3, k  , j, i) - emfc(bl, V1, k  , j  , i));
+    return emf + 0.25*(e1_l3 + e1_r3 + e1_l2 + e1_r2);
+}
+KOKKOS_INLINE_FUNCTION Real corner_emf_E2(const EMFPacks& d, const int& bl, const int& k, const int& j, const int& i)
+{
+    const auto& B_U = d.B_U;
+    const auto& emfc = d.emfc;
+    if (d.ndim < 3) return B_U(bl).flux(X1DIR, V3, k, j, i);
+    const Real emf = 0.25*(-B_U(bl).flux(X3DIR, V1, k, j, i - 1) - B_U(bl).flux(X3DIR, V1, k, j, i)
+                          + B_U(bl).flux(X1DIR, V3, k - 1, j, i) + B_U(bl).flux(X1DIR, V3, k, j, i));
+    if (d.scheme == CTScheme::bs99) {
+        return emf;
+    } else if (d.scheme == CTScheme::gs05_0) {
+        return 2 * emf - 0.25*(emfc(bl, V2, k, j, i)      + emfc(bl, V2, k, j, i - 1)
+                             + emfc(bl, V2, k - 1, j, i)  + emfc(bl, V2, k - 1, j, i - 1));
+    }
+    const Real e2_l3 = upwind(upwind_weight(d, bl, X1DIR, k-1, j, i),
+                              -B_U(bl).flux(X3DIR, V1, k, j, i-1) - emfc(bl, V2, k-1, j, i-1),
+                              -B_U(bl).flux(X3DIR, V1, k, j, i  ) - emfc(bl, V2, k-1, j, i  ));
+    const Real e2_r3 = upwind(upwind_weight(d, bl, X1DIR, k  , j, i),
+                              -B_U(bl).flux(X3DIR, V1, k, j, i-1) - emfc(bl, V2, k  , j, i-1),
+                              -B_U(bl).flux(X3DIR, V1, k, j, i  ) - emfc(bl, V2, k  , j, i  ));
+    const Real e2_l1 = upwind(upwind_weight(d, bl, X3DIR, k, j, i-1),
+                              B_U(bl).flux(X1DIR, V3, k-1, j, i) - emfc(bl, V2, k-1, j, i-1),
+                              B_U(bl).flux(X1DIR, V3, k  , j, i) - emfc(bl, V2, k  , j, i-1));
+    const Real e2_r1 = upwind(upwind_weight(d, bl, X3DIR, k, j, i  ),
+                              B_U(bl).flux(X1DIR, V3, k-1, j, i) - emfc(bl, V2, k-1, j, i  ),
+                              B_U(bl).flux(X1DIR, V3, k  , j, i) - emfc(bl, V2, k  , j, i  ));
+    return emf + 0.25*(e2_l3 + e2_r3 + e2_l1 + e2_r1);
+}
+KOKKOS_INLINE_FUNCTION Real corner_emf_E3(const EMFPacks& d, const int& bl, const int& k, const int& j, const int& i)
+{
+    const auto& B_U = d.B_U;
+    const auto& emfc = d.emfc;
+    const Real emf = 0.25*(-B_U(bl).flux(X1DIR, V2, k, j - 1, i) - B_U(bl).flux(X1DIR, V2, k, j, i)
+                          + B_U(bl).flux(X2DIR, V1, k, j, i - 1) + B_U(bl).flux(X2DIR, V1, k, j, i));
+    if (d.scheme == CTScheme::bs99) {
+        return emf;
+    } else if (d.scheme == CTScheme::gs05_0) {
+        return 2 * emf - 0.25*(emfc(bl, V3, k, j, i)     + emfc(bl, V3, k, j, i - 1)
+                             + emfc(bl, V3, k, j - 1, i) + emfc(bl, V3, k, j - 1, i - 1));
+    }
+    const Real e3_l2 = upwind(upwind_weight(d, bl, X1DIR, k, j-1, i),
+                              B_U(bl).flux(X2DIR, V1, k, j, i-1) - emfc(bl, V3, k, j-1, i-1),
+                              B_U(bl).flux(X2DIR, V1, k, j, i  ) - emfc(bl, V3, k, j-1, i  ));
+    const Real e3_r2 = upwind(upwind_weight(d, bl, X1DIR, k, j  , i),
+                              B_U(bl).flux(X2DIR, V1, k, j, i-1) - emfc(bl, V3, k, j  , i-1),
+                              B_U(bl).flux(X2DIR, V1, k, j, i  ) - emfc(bl, V3, k, j  , i  ));
+    const Real e3_l1 = upwind(upwind_weight(d, bl, X2DIR, k, j, i-1),
+                              -B_U(bl).flux(X1DIR, V2, k, j-1, i) - emfc(bl, V3, k, j-1, i-1),
+                              -B_U(bl).flux(X1DIR, V2, k, j  , i) - emfc(bl, V3, k, j  , i-1));
+    const Real e3_r1 = upwind(upwind_weight(d, bl, X2DIR, k, j, i  ),
+                              -B_U(bl).flux(X1DIR, V2, k, j-1, i) - emfc(bl, V3, k, j-1, i  ),
+                              -B_U(bl).flux(X1DIR, V2, k, j  , i) - emfc(bl, V3, k, j  , i  ));
+    return emf + 0.25*(e3_l2 + e3_r2 + e3_l1 + e3_r1);
+}
+/**
+ * Keep the largest divB seen by AddSource since the last diagnostic check
+ */
+void RecordDivB(Params& params, const Real& divb)
+{
+    Real *divb_update_max = params.GetMutable<Real>("divb_update_max");
+    *divb_update_max = m::max(*divb_update_max, divb);
+}
+} // namespace
+
 std::shared_ptr<KHARMAPackage> B_CT::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
 {
     auto pkg = std::make_shared<KHARMAPackage>("B_CT");
@@ -60,11 +254,27 @@ std::shared_ptr<KHARMAPackage> B_CT::Initialize(ParameterInput *pin, std::shared
     params.Add("kill_on_large_divb", kill_on_large_divb);
     Real kill_on_divb_over = pin->GetOrAddReal("b_field", "kill_on_divb_over", 1.e-3);
     params.Add("kill_on_divb_over", kill_on_divb_over);
+    // Take the per-step divB check from the face update in AddSource, rather than a separate pass.
+    // This reports divB of the state entering each stage, so it lags the final state by one stage
+    bool divb_from_update = pin->GetOrAddBoolean("b_field", "divb_from_update", false);
+    params.Add("divb_from_update", divb_from_update);
+    params.Add("divb_update_max", (Real) 0., true);
 
+    // gs05_hll upwinds like gs05_c, but weights the two sides by the face signal speeds
     // TODO gs05_alpha, LDZ04 UCT1, LDZ07 UCT2?
-    std::vector<std::string> ct_scheme_options = {"bs99", "gs05_0", "gs05_c", "sg07"};
+    std::vector<std::string> ct_scheme_options = {"bs99", "gs05_0", "gs05_c", "sg07", "gs05_hll"};
     std::string ct_scheme = pin->GetOrAddString("b_field", "ct_scheme", "gs05_c", ct_scheme_options);
     params.Add("ct_scheme", ct_scheme);
+    // On single-level meshes, calculate EMFs inside the face update rather than storing & syncing them.
+    // See B_CT::UseFusedUpdate for the exact conditions
+    bool fused_update = pin->GetOrAddBoolean("b_field", "fused_update", true);
+    params.Add("fused_update", fused_update);
+    // Re-average the face field to zone centers before calculating fluxes.  Every driver already leaves
+    // prims.B current over the entire domain (UtoP after each update, BoundaryUtoP after each sync), and
+    // the fluxes take face-normal B from the faces directly (see <flux>consistent_face_b), so this is
+    // only a safety net
+    bool center_before_flux = pin->GetOrAddBoolean("b_field", "center_before_flux", false);
+    params.Add("center_before_flux", center_before_flux);
 
     // Use the default Parthenon prolongation operator, rather than the divergence-preserving one
     // This relies entirely on the EMF communication for preserving the divergence
@@ -118,7 +328,7 @@ std::shared_ptr<KHARMAPackage> B_CT::Initialize(ParameterInput *pin, std::shared
     pkg->AddSource = B_CT::AddSource;
 
     // Also ensure that prims get filled, both during step and on boundaries
-    //pkg->MeshUtoP = B_CT::MeshUtoP;
+    pkg->MeshUtoP = B_CT::MeshUtoP;
     pkg->BlockUtoP = B_CT::BlockUtoP;
     pkg->BoundaryUtoP = B_CT::BlockUtoP;
 
@@ -139,9 +349,8 @@ std::shared_ptr<KHARMAPackage> B_CT::Initialize(ParameterInput *pin, std::shared
     hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::max, B_CT::MaxDivB, "MaxDivB"));
     // Event horizon magnetization.  Might be the same or different for different representations?
     if (pin->GetBoolean("coordinates", "domain_intersects_eh")) {
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::phi>, "Phi_0"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::phi>, "Phi_EH"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::phi>, "Phi_5M"));
+        Reductions::AddBatchedHistory<Reductions::Var::phi>(hst_vars, "phi_shells", Reductions::BatchRegion::shells,
+                                                            {"Phi_0", "Phi_EH", "Phi_5M"});
     }
     // add callbacks for HST output to the Params struct, identified by the `hist_param_key`
     pkg->AddParam<>(parthenon::hist_param_key, hst_vars);
@@ -151,9 +360,69 @@ std::shared_ptr<KHARMAPackage> B_CT::Initialize(ParameterInput *pin, std::shared
 
 TaskStatus B_CT::MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse)
 {
-    // TODO later
-    for (int i=0; i < md->NumBlocks(); i++)
-        B_CT::BlockUtoP(md->GetBlockData(i).get(), domain, coarse);
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const int ndim = pmb0->pmy_mesh->ndim;
+    auto B_Uf = md->PackVariables(std::vector<std::string>{"cons.fB"});
+    auto B_U = md->PackVariables(std::vector<std::string>{"cons.B"});
+    auto B_P = md->PackVariables(std::vector<std::string>{"prims.B"});
+    // Return if we're not syncing U & P at all (e.g. edges)
+    if (B_Uf.GetDim(4) == 0) return TaskStatus::complete;
+
+    const IndexRange block = IndexRange{0, B_Uf.GetDim(5)-1};
+    const IndexRange3 bc = KDomain::GetRange(md, domain, coarse);
+
+    // As BlockUtoP, over all blocks in one kernel
+    pmb0->par_for("UtoP_B_center_Mesh", block.s, block.e, bc.ks, bc.ke, bc.js, bc.je, bc.is, bc.ie,
+        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            const auto& G = B_U.GetCoords(b);
+            B_P(b, V1, k, j, i) = (B_Uf(b, F1, 0, k, j, i) / G.gdet(Loci::face1, j, i)
+                                 + B_Uf(b, F1, 0, k, j, i + 1) / G.gdet(Loci::face1, j, i + 1)) / 2;
+            B_P(b, V2, k, j, i) = (ndim > 1) ? (B_Uf(b, F2, 0, k, j, i) / G.gdet(Loci::face2, j, i)
+                                              + B_Uf(b, F2, 0, k, j + 1, i) / G.gdet(Loci::face2, j + 1, i)) / 2
+                                              : B_Uf(b, F2, 0, k, j, i) / G.gdet(Loci::face2, j, i);
+            B_P(b, V3, k, j, i) = (ndim > 2) ? (B_Uf(b, F3, 0, k, j, i) / G.gdet(Loci::face3, j, i)
+                                              + B_Uf(b, F3, 0, k + 1, j, i) / G.gdet(Loci::face3, j, i)) / 2
+                                              : B_Uf(b, F3, 0, k, j, i) / G.gdet(Loci::face3, j, i);
+            for (int v = 0; v < NVEC; v++)
+                B_U(b, v, k, j, i) = B_P(b, v, k, j, i) * G.gdet(Loci::center, j, i);
+        }
+    );
+
+    return TaskStatus::complete;
+}
+
+TaskStatus B_CT::MeshBoundaryUtoP(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const int ndim = pmb0->pmy_mesh->ndim;
+    auto B_Uf = md->PackVariables(std::vector<std::string>{"cons.fB"});
+    auto B_U = md->PackVariables(std::vector<std::string>{"cons.B"});
+    auto B_P = md->PackVariables(std::vector<std::string>{"prims.B"});
+    // Return if we're not syncing U & P at all (e.g. edges)
+    if (B_Uf.GetDim(4) == 0) return TaskStatus::complete;
+
+    const auto slabs = KBoundaries::GetSyncedSlabs(md);
+    if (slabs.nzones == 0) return TaskStatus::complete;
+
+    // As BlockUtoP: average the primitive vals to zone centers, then recover conserved B
+    pmb0->par_for("UtoP_B_center_Boundary", 0, slabs.nzones - 1,
+        KOKKOS_LAMBDA (const int& n) {
+            int b, k, j, i;
+            slabs.zone(n, b, k, j, i);
+            const auto& G = B_U.GetCoords(b);
+            B_P(b, V1, k, j, i) = (B_Uf(b, F1, 0, k, j, i) / G.gdet(Loci::face1, j, i)
+                                 + B_Uf(b, F1, 0, k, j, i + 1) / G.gdet(Loci::face1, j, i + 1)) / 2;
+            B_P(b, V2, k, j, i) = (ndim > 1) ? (B_Uf(b, F2, 0, k, j, i) / G.gdet(Loci::face2, j, i)
+                                              + B_Uf(b, F2, 0, k, j + 1, i) / G.gdet(Loci::face2, j + 1, i)) / 2
+                                              : B_Uf(b, F2, 0, k, j, i) / G.gdet(Loci::face2, j, i);
+            B_P(b, V3, k, j, i) = (ndim > 2) ? (B_Uf(b, F3, 0, k, j, i) / G.gdet(Loci::face3, j, i)
+                                              + B_Uf(b, F3, 0, k + 1, j, i) / G.gdet(Loci::face3, j, i)) / 2
+                                              : B_Uf(b, F3, 0, k, j, i) / G.gdet(Loci::face3, j, i);
+            for (int v = 0; v < NVEC; v++)
+                B_U(b, v, k, j, i) = B_P(b, v, k, j, i) * G.gdet(Loci::center, j, i);
+        }
+    );
+
     return TaskStatus::complete;
 }
 
@@ -170,7 +439,7 @@ TaskStatus B_CT::BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coa
 
     const IndexRange3 bc = KDomain::GetRange(rc, domain, coarse);
 
-    // Average the primitive vals to zone centers
+    // Average the primitive vals to zone centers, then recover conserved B there
     pmb->par_for("UtoP_B_center", bc.ks, bc.ke, bc.js, bc.je, bc.is, bc.ie,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
             B_P(V1, k, j, i) = (B_Uf(F1, 0, k, j, i) / G.gdet(Loci::face1, j, i)
@@ -181,12 +450,8 @@ TaskStatus B_CT::BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coa
             B_P(V3, k, j, i) = (ndim > 2) ? (B_Uf(F3, 0, k, j, i) / G.gdet(Loci::face3, j, i)
                                            + B_Uf(F3, 0, k + 1, j, i) / G.gdet(Loci::face3, j, i)) / 2
                                            : B_Uf(F3, 0, k, j, i) / G.gdet(Loci::face3, j, i);
-        }
-    );
-    // Recover conserved B at centers
-    pmb->par_for("UtoP_B_centerPtoU", 0, NVEC-1, bc.ks, bc.ke, bc.js, bc.je, bc.is, bc.ie,
-        KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
-            B_U(v, k, j, i) = B_P(v, k, j, i) * G.gdet(Loci::center, j, i);
+            for (int v = 0; v < NVEC; v++)
+                B_U(v, k, j, i) = B_P(v, k, j, i) * G.gdet(Loci::center, j, i);
         }
     );
 
@@ -270,168 +535,122 @@ TaskStatus B_CT::CalculateEMF(MeshData<Real> *md)
     auto& emf_pack = md->PackVariables(std::vector<std::string>{"B_CT.emf"});
 
     // Figure out indices
-    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior, 0, 0);
     const IndexRange3 b1 = KDomain::GetRange(md, IndexDomain::interior, 0, 1);
     const IndexRange block = IndexRange{0, emf_pack.GetDim(5)-1};
 
     auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
 
-    // Calculate circulation by averaging fluxes
-    // This is the base of most other schemes, which make corrections
-    // It is the entirety of B&S '99
-    auto& B_U = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.B"});
-    pmb0->par_for("B_CT_emf_BS", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
-        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
-            // The basic EMF per length along edges is the B field flux
-            // We use this form rather than multiply by edge length here,
-            // since the default restriction op averages values
-            const auto& G = B_U.GetCoords(bl);
-            if (ndim > 2) {
-                emf_pack(bl, E1, 0, k, j, i) =
-                    0.25*(-B_U(bl).flux(X2DIR, V3, k - 1, j, i) - B_U(bl).flux(X2DIR, V3, k, j, i)
-                         + B_U(bl).flux(X3DIR, V2, k, j - 1, i) + B_U(bl).flux(X3DIR, V2, k, j, i));
-                emf_pack(bl, E2, 0, k, j, i) =
-                    0.25*(-B_U(bl).flux(X3DIR, V1, k, j, i - 1) - B_U(bl).flux(X3DIR, V1, k, j, i)
-                         + B_U(bl).flux(X1DIR, V3, k - 1, j, i) + B_U(bl).flux(X1DIR, V3, k, j, i));
-                emf_pack(bl, E3, 0, k, j, i) =
-                    0.25*(-B_U(bl).flux(X1DIR, V2, k, j - 1, i) - B_U(bl).flux(X1DIR, V2, k, j, i)
-                        + B_U(bl).flux(X2DIR, V1, k, j, i - 1)  + B_U(bl).flux(X2DIR, V1, k, j, i));
-            } else if (ndim > 1) {
-                emf_pack(bl, E1, 0, k, j, i) = -B_U(bl).flux(X2DIR, V3, k, j, i);
-                emf_pack(bl, E2, 0, k, j, i) =  B_U(bl).flux(X1DIR, V3, k, j, i);
-                emf_pack(bl, E3, 0, k, j, i) =
-                    0.25*(-B_U(bl).flux(X1DIR, V2, k, j - 1, i) - B_U(bl).flux(X1DIR, V2, k, j, i)
-                         + B_U(bl).flux(X2DIR, V1, k, j, i - 1) + B_U(bl).flux(X2DIR, V1, k, j, i));
-            } else {
+    // All corrections require/are only necessary for 2D+
+    if (ndim < 2) {
+        auto& B_U = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.B"});
+        pmb0->par_for("B_CT_emf_BS", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
                 emf_pack(bl, E1, 0, k, j, i) = 0;
                 emf_pack(bl, E2, 0, k, j, i) =  B_U(bl).flux(X1DIR, V3, k, j, i);
                 emf_pack(bl, E3, 0, k, j, i) = -B_U(bl).flux(X1DIR, V2, k, j, i);
             }
-        }
-    );
-    // All corrections require/are only necessary for 2D+
-    if (ndim < 2) return TaskStatus::complete;
-
-    std::string scheme = pmesh->packages.Get("B_CT")->Param<std::string>("ct_scheme");
-    if (scheme != "bs99") {
-        // Additional terms for Stone & Gardiner '09
-        // Caclulate the EMF at zone centers with primitive B, U1-3
-        PackIndexMap prims_map;
-        auto& P = md->PackVariables(std::vector<std::string>{"prims.uvec", "prims.B"}, prims_map);
-        const VarMap m_p(prims_map, false);
-        auto& emfc = md->PackVariables(std::vector<std::string>{"B_CT.cemf"});
-        // Need this over whole domain to have halo around EMF caclulation
-        const IndexRange3 be = KDomain::GetRange(md, IndexDomain::entire);
-        pmb0->par_for("B_CT_emfc", block.s, block.e, be.ks, be.ke, be.js, be.je, be.is, be.ie,
-            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
-                const auto& G = P.GetCoords(bl);
-                Real gdet = G.gdet(Loci::center, j, i);
-
-                // Get the 4vecs
-                FourVectors D;
-                GRMHD::calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, D);
-
-                // Calculate cell-center EMF w/v x B
-                emfc(bl, V1, k, j, i) = (D.bcon[2]*D.ucon[3] - D.bcon[3]*D.ucon[2]) * gdet;
-                emfc(bl, V2, k, j, i) = (D.bcon[3]*D.ucon[1] - D.bcon[1]*D.ucon[3]) * gdet;
-                emfc(bl, V3, k, j, i) = (D.bcon[1]*D.ucon[2] - D.bcon[2]*D.ucon[1]) * gdet;
-            }
         );
+        return TaskStatus::complete;
+    }
 
-        if (scheme == "gs05_0") {
-            pmb0->par_for("B_CT_emf_GS05_0", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
-                KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
-                    const auto& G = emfc.GetCoords(bl);
-                    // Just subtract centered emf from twice the face version
-                    // More stable for planar flows even without anything fancy
-                    if (ndim > 2) {
-                        emf_pack(bl, E1, 0, k, j, i) = 2 * emf_pack(bl, E1, 0, k, j, i)
-                            - 0.25*(emfc(bl, V1, k, j, i)      + emfc(bl, V1, k, j - 1, i)
-                                  + emfc(bl, V1, k, j - 1, i)  + emfc(bl, V1, k - 1, j - 1, i));
-                        emf_pack(bl, E2, 0, k, j, i) = 2 * emf_pack(bl, E2, 0, k, j, i)
-                            - 0.25*(emfc(bl, V2, k, j, i)      + emfc(bl, V2, k, j, i - 1)
-                                  + emfc(bl, V2, k - 1, j, i)  + emfc(bl, V2, k - 1, j, i - 1));
-                    }
-                    emf_pack(bl, E3, 0, k, j, i) = 2 * emf_pack(bl, E3, 0, k, j, i)
-                        - 0.25*(emfc(bl, V3, k, j, i)     + emfc(bl, V3, k, j, i - 1)
-                              + emfc(bl, V3, k, j - 1, i) + emfc(bl, V3, k, j - 1, i - 1));
-                }
-            );
-        } else if (scheme == "gs05_c" || scheme == "sg07") {
-            auto& rho = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.rho"});
-            pmb0->par_for("B_CT_emf_GS05_c", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
-                KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
-                    // Following adapted closely from AthenaK, including clever use of the mass flux for the
-                    // sign of the contact mode.
-                    if (ndim > 2) {
-                        // Integrate EMF to the corner using GS07 i.e. GS05 E^c upwinding
-                        Real e1_l3 = (rho(bl).flux(X2DIR, 0, k-1, j, i) >= 0.0) ?
-                                    B_U(bl).flux(X3DIR, V2, k, j-1, i) - emfc(bl, V1, k-1, j-1, i) :
-                                    B_U(bl).flux(X3DIR, V2, k, j  , i) - emfc(bl, V1, k-1, j  , i);
-                        Real e1_r3 = (rho(bl).flux(X2DIR, 0, k  , j, i  ) >= 0.0) ?
-                                    B_U(bl).flux(X3DIR, V2, k, j-1, i) - emfc(bl, V1, k  , j-1, i) :
-                                    B_U(bl).flux(X3DIR, V2, k, j  , i) - emfc(bl, V1, k  , j  , i);
-                        Real e1_l2 = (rho(bl).flux(X3DIR, 0, k, j-1, i) >= 0.0) ?
-                                    -B_U(bl).flux(X2DIR, V3, k-1, j, i) - emfc(bl, V1, k-1, j-1, i) :
-                                    -B_U(bl).flux(X2DIR, V3, k  , j, i) - emfc(bl, V1, k  , j-1, i);
-                        Real e1_r2 = (rho(bl).flux(X3DIR, 0, k, j  , i) >= 0.0) ?
-                                    -B_U(bl).flux(X2DIR, V3, k-1, j, i) - emfc(bl, V1, k-1, j  , i) :
-                                    -B_U(bl).flux(X2DIR, V3, k  , j, i) - emfc(bl, V1, k  , j  , i);
-                        emf_pack(bl, E1, 0, k, j, i) += 0.25*(e1_l3 + e1_r3 + e1_l2 + e1_r2);
-
-                        Real e2_l3 = (rho(bl).flux(X1DIR, 0, k-1, j, i) >= 0.0) ?
-                                    -B_U(bl).flux(X3DIR, V1, k, j, i-1) - emfc(bl, V2, k-1, j, i-1) :
-                                    -B_U(bl).flux(X3DIR, V1, k, j, i  ) - emfc(bl, V2, k-1, j, i  );
-                        Real e2_r3 = (rho(bl).flux(X1DIR, 0, k  , j, i) >= 0.0) ?
-                                    -B_U(bl).flux(X3DIR, V1, k, j, i-1) - emfc(bl, V2, k  , j, i-1) :
-                                    -B_U(bl).flux(X3DIR, V1, k, j, i  ) - emfc(bl, V2, k  , j, i  );
-                        Real e2_l1 = (rho(bl).flux(X3DIR, 0, k, j, i-1) >= 0.0) ?
-                                    B_U(bl).flux(X1DIR, V3, k-1, j, i) - emfc(bl, V2, k-1, j, i-1) :
-                                    B_U(bl).flux(X1DIR, V3, k  , j, i) - emfc(bl, V2, k  , j, i-1);
-                        Real e2_r1 = (rho(bl).flux(X3DIR, 0, k, j, i  ) >= 0.0) ?
-                                    B_U(bl).flux(X1DIR, V3, k-1, j, i) - emfc(bl, V2, k-1, j, i  ) :
-                                    B_U(bl).flux(X1DIR, V3, k  , j, i) - emfc(bl, V2, k  , j, i  );
-                        emf_pack(bl, E2, 0, k, j, i) += 0.25*(e2_l3 + e2_r3 + e2_l1 + e2_r1);
-                    }
-
-                    Real e3_l2 = (rho(bl).flux(X1DIR, 0, k, j-1, i) >= 0.0) ?
-                                B_U(bl).flux(X2DIR, V1, k, j, i-1) - emfc(bl, V3, k, j-1, i-1) :
-                                B_U(bl).flux(X2DIR, V1, k, j, i  ) - emfc(bl, V3, k, j-1, i  );
-                    Real e3_r2 = (rho(bl).flux(X1DIR, 0, k, j  , i) >= 0.0) ?
-                                B_U(bl).flux(X2DIR, V1, k, j, i-1) - emfc(bl, V3, k, j  , i-1) :
-                                B_U(bl).flux(X2DIR, V1, k, j, i  ) - emfc(bl, V3, k, j  , i  );
-                    Real e3_l1 = (rho(bl).flux(X2DIR, 0, k, j, i-1) >= 0.0) ?
-                                -B_U(bl).flux(X1DIR, V2, k, j-1, i) - emfc(bl, V3, k, j-1, i-1) :
-                                -B_U(bl).flux(X1DIR, V2, k, j  , i) - emfc(bl, V3, k, j  , i-1);
-                    Real e3_r1 = (rho(bl).flux(X2DIR, 0, k, j, i  ) >= 0.0) ?
-                                -B_U(bl).flux(X1DIR, V2, k, j-1, i) - emfc(bl, V3, k, j-1, i  ) :
-                                -B_U(bl).flux(X1DIR, V2, k, j  , i) - emfc(bl, V3, k, j  , i  );
-                    emf_pack(bl, E3, 0, k, j, i) += 0.25*(e3_l2 + e3_r2 + e3_l1 + e3_r1);
-                }
-            );
+    // Calculate circulation by averaging fluxes, plus any correction for the scheme
+    const EMFPacks d = PrepareEMF(md);
+    pmb0->par_for("B_CT_emf", block.s, block.e, b1.ks, b1.ke, b1.js, b1.je, b1.is, b1.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            emf_pack(bl, E1, 0, k, j, i) = corner_emf_E1(d, bl, k, j, i);
+            emf_pack(bl, E2, 0, k, j, i) = corner_emf_E2(d, bl, k, j, i);
+            emf_pack(bl, E3, 0, k, j, i) = corner_emf_E3(d, bl, k, j, i);
         }
-    }
+    );
 
     return TaskStatus::complete;
 }
 
+bool B_CT::UseFusedUpdate(Mesh *pmesh)
+{
+    if (!pmesh->packages.Get("B_CT")->Param<bool>("fused_update") || pmesh->multilevel || pmesh->ndim < 2)
+        return false;
+    // Any EMF boundary fixes happen during the EMF sync, so we can't skip it
+    const KBoundaries::BoundaryConfigs &config = KBoundaries::GetBoundaryConfigs(pmesh->packages);
+    for (int i = 0; i < BOUNDARY_NFACES; i++) {
+        if (config[i].zero_EMF || config[i].average_EMF) return false;
+    }
+    return true;
+}
+
 TaskStatus B_CT::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain)
 {
     auto pmesh = md->GetMeshPointer();
     const int ndim = pmesh->ndim;
 
-    // EMF temporary
-    auto& emf_pack = md->PackVariables(std::vector<std::string>{"B_CT.emf"});
-
-    // Figure out indices
-    const IndexRange block = IndexRange{0, emf_pack.GetDim(5)-1};
-
     auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
 
     // This is what we're replacing
     auto& dB_Uf_dt = mdudt->PackVariables(std::vector<std::string>{"cons.fB"});
-    // Circulation -> change in flux at face
+    const IndexRange block = IndexRange{0, dB_Uf_dt.GetDim(5)-1};
     const IndexRange3 bf1 = KDomain::GetRange(md, domain, F1);
+    const IndexRange3 bf2 = KDomain::GetRange(md, domain, F2);
+    const IndexRange3 bf3 = KDomain::GetRange(md, domain, F3);
+
+    // Optionally record the divergence of the incoming field while we're here
+    auto& params = pmesh->packages.Get("B_CT")->AllParams();
+    const bool record_divb = params.Get<bool>("divb_from_update");
+    auto& B_Uf = md->PackVariables(std::vector<std::string>{"cons.fB"});
+    const IndexRange3 bc = KDomain::GetRange(md, IndexDomain::interior);
+    Real divb_max = 0.;
+    Kokkos::Max<Real> max_reducer(divb_max);
+
+    if (UseFusedUpdate(pmesh)) {
+        // Compute the EMFs right here rather than reading B_CT.emf, which is left untouched.
+        // Every block computes the same values on the edges it shares with its neighbors,
+        // so there's nothing to sync in between.
+        // Edges at (k, j, i) are shared between faces, those at +1 are recomputed by the next zone.
+        const EMFPacks d = PrepareEMF(md);
+        const IndexRange kb = IndexRange{m::min(bf1.ks, m::min(bf2.ks, bf3.ks)), m::max(bf1.ke, m::max(bf2.ke, bf3.ke))};
+        const IndexRange jb = IndexRange{m::min(bf1.js, m::min(bf2.js, bf3.js)), m::max(bf1.je, m::max(bf2.je, bf3.je))};
+        const IndexRange ib = IndexRange{m::min(bf1.is, m::min(bf2.is, bf3.is)), m::max(bf1.ie, m::max(bf2.ie, bf3.ie))};
+        pmb0->par_reduce("B_CT_emf_circ", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, Real &local_result) {
+                const auto& G = dB_Uf_dt.GetCoords(bl);
+                if (record_divb && KDomain::inside(k, j, i, bc)) {
+                    const Real local_divb = m::abs(face_div(G, B_Uf(bl), ndim, k, j, i));
+                    if (local_divb > local_result) local_result = local_divb;
+                }
+                const Real e1 = corner_emf_E1(d, bl, k, j, i);
+                const Real e2 = corner_emf_E2(d, bl, k, j, i);
+                const Real e3 = corner_emf_E3(d, bl, k, j, i);
+                if (KDomain::inside(k, j, i, bf1)) {
+                    Real dB = (-G.Volume<E3>(k, j + 1, i) * corner_emf_E3(d, bl, k, j + 1, i)
+                               + G.Volume<E3>(k, j, i)    * e3);
+                    if (ndim > 2)
+                        dB += (G.Volume<E2>(k + 1, j, i) * corner_emf_E2(d, bl, k + 1, j, i)
+                               - G.Volume<E2>(k, j, i)   * e2);
+                    dB_Uf_dt(bl, F1, 0, k, j, i) = dB / G.Volume<F1>(k, j, i);
+                }
+                if (KDomain::inside(k, j, i, bf2)) {
+                    Real dB = (G.Volume<E3>(k, j, i + 1) * corner_emf_E3(d, bl, k, j, i + 1)
+                               - G.Volume<E3>(k, j, i)   * e3);
+                    if (ndim > 2)
+                        dB += (-G.Volume<E1>(k + 1, j, i) * corner_emf_E1(d, bl, k + 1, j, i)
+                               + G.Volume<E1>(k, j, i)    * e1);
+                    dB_Uf_dt(bl, F2, 0, k, j, i) = dB / G.Volume<F2>(k, j, i);
+                }
+                if (KDomain::inside(k, j, i, bf3)) {
+                    dB_Uf_dt(bl, F3, 0, k, j, i) = (- G.Volume<E2>(k, j, i + 1) * corner_emf_E2(d, bl, k, j, i + 1)
+                                                    + G.Volume<E2>(k, j, i)     * e2
+                                                    + G.Volume<E1>(k, j + 1, i) * corner_emf_E1(d, bl, k, j + 1, i)
+                                                    - G.Volume<E1>(k, j, i)     * e1) / G.Volume<F3>(k, j, i);
+                }
+            }
+        , max_reducer);
+        if (record_divb) RecordDivB(params, divb_max);
+        return TaskStatus::complete;
+    }
+
+    // EMF temporary
+    auto& emf_pack = md->PackVariables(std::vector<std::string>{"B_CT.emf"});
+
+    // Circulation -> change in flux at face
     pmb0->par_for("B_CT_Circ_1", block.s, block.e, bf1.ks, bf1.ke, bf1.js, bf1.je, bf1.is, bf1.ie,
         KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
             const auto& G = dB_Uf_dt.GetCoords(bl);
@@ -443,7 +662,6 @@ TaskStatus B_CT::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomai
             dB_Uf_dt(bl, F1, 0, k, j, i) /= G.Volume<F1>(k, j, i);
         }
     );
-    const IndexRange3 bf2 = KDomain::GetRange(md, domain, F2);
     pmb0->par_for("B_CT_Circ_2", block.s, block.e, bf2.ks, bf2.ke, bf2.js, bf2.je, bf2.is, bf2.ie,
         KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
             const auto& G = dB_Uf_dt.GetCoords(bl);
@@ -455,16 +673,21 @@ TaskStatus B_CT::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomai
             dB_Uf_dt(bl, F2, 0, k, j, i) /= G.Volume<F2>(k, j, i);
         }
     );
-    const IndexRange3 bf3 = KDomain::GetRange(md, domain, F3);
-    pmb0->par_for("B_CT_Circ_3", block.s, block.e, bf3.ks, bf3.ke, bf3.js, bf3.je, bf3.is, bf3.ie,
-        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+    // The F3 range covers all interior zones in any dimension, so we record divB here
+    pmb0->par_reduce("B_CT_Circ_3", block.s, block.e, bf3.ks, bf3.ke, bf3.js, bf3.je, bf3.is, bf3.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, Real &local_result) {
             const auto& G = dB_Uf_dt.GetCoords(bl);
+            if (record_divb && KDomain::inside(k, j, i, bc)) {
+                const Real local_divb = m::abs(face_div(G, B_Uf(bl), ndim, k, j, i));
+                if (local_divb > local_result) local_result = local_divb;
+            }
             dB_Uf_dt(bl, F3, 0, k, j, i) = (- G.Volume<E2>(k, j, i + 1) * emf_pack(bl, E2, 0, k, j, i + 1)
                                             + G.Volume<E2>(k, j, i)     * emf_pack(bl, E2, 0, k, j, i)
                                             + G.Volume<E1>(k, j + 1, i) * emf_pack(bl, E1, 0, k, j + 1, i)
                                             - G.Volume<E1>(k, j, i)     * emf_pack(bl, E1, 0, k, j, i)) / G.Volume<F3>(k, j, i);
         }
-    );
+    , max_reducer);
+    if (record_divb) RecordDivB(params, divb_max);
 
     return TaskStatus::complete;
 }
@@ -522,15 +745,15 @@ double B_CT::BlockMaxDivB(MeshBlockData<Real> *rc)
 double B_CT::GlobalMaxDivB(MeshData<Real> *md, bool all_reduce)
 {
     if (all_reduce) {
-        Reductions::StartToAll<Real>(md, 2, MaxDivB(md), MPI_MAX);
-        return Reductions::CheckOnAll<Real>(md, 2);
+        Reductions::StartToAll<Real>(md, Reductions::Channel::divb, MaxDivB(md), MPI_MAX);
+        return Reductions::CheckOnAll<Real>(md, Reductions::Channel::divb);
     } else {
-        Reductions::Start<Real>(md, 2, MaxDivB(md), MPI_MAX);
-        return Reductions::Check<Real>(md, 2);
+        Reductions::Start<Real>(md, Reductions::Channel::divb, MaxDivB(md), MPI_MAX);
+        return Reductions::Check<Real>(md, Reductions::Channel::divb);
     }
 }
 
-TaskStatus B_CT::PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb)
+TaskStatus B_CT::PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb, bool from_update)
 {
     auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
 
@@ -539,7 +762,16 @@ TaskStatus B_CT::PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb)
     const bool print = pmb0->packages.Get("Globals")->Param<int>("verbose") >= 1;
     if (print || kill_on_large_divb) {
         // Calculate the maximum from/on all nodes
-        const double divb_max = B_CT::GlobalMaxDivB(md);
+        double divb_max;
+        if (from_update) {
+            // Just reduce what AddSource found during the step, and start over
+            Real *divb_update_max = pmb0->packages.Get("B_CT")->AllParams().GetMutable<Real>("divb_update_max");
+            Reductions::Start<Real>(md, Reductions::Channel::divb, *divb_update_max, MPI_MAX);
+            divb_max = Reductions::Check<Real>(md, Reductions::Channel::divb);
+            *divb_update_max = 0.;
+        } else {
+            divb_max = B_CT::GlobalMaxDivB(md);
+        }
         // Print on rank zero
         if (MPIRank0() && print) {
             printf("Max DivB: %g\n", divb_max); // someday I'll learn stream options
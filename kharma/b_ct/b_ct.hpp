@@ -61,6 +61,11 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
  */
 TaskStatus BlockUtoP(MeshBlockData<Real> *mbd, IndexDomain domain, bool coarse=false);
 TaskStatus MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse=false);
+/**
+ * UtoP over just the ghost zones filled by communication, on all blocks in one kernel.
+ * Used after syncing only the conserved field.
+ */
+TaskStatus MeshBoundaryUtoP(MeshData<Real> *md);
 
 /**
  * Interpolate primitive B to faces, then multiply by gdet
@@ -75,6 +80,13 @@ TaskStatus DangerousPtoU(MeshData<Real> *md, IndexDomain domain, bool coarse=fal
  */
 TaskStatus CalculateEMF(MeshData<Real> *md);
 
+/**
+ * Whether AddSource should calculate the EMFs itself, skipping CalculateEMF & the EMF sync.
+ * Only true on single-level meshes without EMF boundary fixes, where each block already computes
+ * the same EMFs as its neighbors on shared edges.
+ */
+bool UseFusedUpdate(Mesh *pmesh);
+
 /**
  * Calculate the change in magnetic field on faces for this step,
  * from the EMFs at edges.
@@ -98,8 +110,9 @@ double GlobalMaxDivB(MeshData<Real> *md, bool all_reduce=false);
 /**
  * Diagnostics printed/computed after each step
  * Currently just max divB
+ * With from_update, uses the maximum recorded by AddSource rather than recomputing it
  */
-TaskStatus PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb=false);
+TaskStatus PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb=false, bool from_update=false);
 
 /**
  * Diagnostics function should print divB, and optionally stop execution if it's large
@@ -107,7 +120,7 @@ TaskStatus PrintGlobalMaxDivB(MeshData<Real> *md, bool kill_on_large_divb=false)
 inline TaskStatus PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
 {
     auto& params = md->GetMeshPointer()->block_list[0]->packages.Get("B_CT")->AllParams();
-    return PrintGlobalMaxDivB(md, params.Get<bool>("kill_on_large_divb"));
+    return PrintGlobalMaxDivB(md, params.Get<bool>("kill_on_large_divb"), params.Get<bool>("divb_from_update"));
 }
 
 /**
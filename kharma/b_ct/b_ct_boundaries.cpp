@@ -43,7 +43,6 @@ void B_CT::ZeroBoundaryEMF(MeshBlockData<Real> *rc, IndexDomain domain, const Va
 {
     auto pmb = rc->GetBlockPointer();
     const BoundaryFace bface = KBoundaries::BoundaryFaceOf(domain);
-    const std::string bname = KBoundaries::BoundaryName(bface);
     const int bdir = KBoundaries::BoundaryDirection(bface);
     const bool binner = KBoundaries::BoundaryIsInner(bface);
     // Select edges which lie on the domain face, zero only those
@@ -56,7 +55,7 @@ void B_CT::ZeroBoundaryEMF(MeshBlockData<Real> *rc, IndexDomain domain, const Va
         IndexRange jb = (bdir == 2) ? IndexRange{j_face, j_face} : IndexRange{b.js, b.je};
         IndexRange kb = (bdir == 3) ? IndexRange{k_face, k_face} : IndexRange{b.ks, b.ke};
         pmb->par_for(
-            "zero_EMF_" + bname, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            "zero_EMF", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
             KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
                 emfpack(el, 0, k, j, i) = 0;
             }
@@ -158,9 +158,8 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::max, B_FluxCT::MaxDivB, "MaxDivB"));
     // Event horizon magnetization.  Might be the same or different for different representations?
     if (pin->GetBoolean("coordinates", "domain_intersects_eh")) {
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::phi>, "Phi_0"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::phi>, "Phi_EH"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::phi>, "Phi_5M"));
+        Reductions::AddBatchedHistory<Reductions::Var::phi>(hst_vars, "phi_shells", Reductions::BatchRegion::shells,
+                                                            {"Phi_0", "Phi_EH", "Phi_5M"});
     }
     // add callbacks for HST output to the Params struct, identified by the `hist_param_key`
     pkg->AddParam<>(parthenon::hist_param_key, hst_vars);
@@ -192,6 +191,29 @@ TaskStatus MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse)
     );
     return TaskStatus::complete;
 }
+TaskStatus MeshBoundaryUtoP(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    const auto& B_U = md->PackVariables(std::vector<std::string>{"cons.B"});
+    const auto& B_P = md->PackVariables(std::vector<std::string>{"prims.B"});
+    const int nvec = B_U.GetDim(4);
+
+    const auto slabs = KBoundaries::GetSyncedSlabs(md);
+    if (slabs.nzones == 0) return TaskStatus::complete;
+
+    pmb0->par_for("UtoP_B_FluxCT_Boundary", 0, slabs.nzones - 1,
+        KOKKOS_LAMBDA (const int& n) {
+            int b, k, j, i;
+            slabs.zone(n, b, k, j, i);
+            const auto& G = B_U.GetCoords(b);
+            for (int mu = 0; mu < nvec; mu++)
+                B_P(b, mu, k, j, i) = B_U(b, mu, k, j, i) / G.gdet(Loci::center, j, i);
+        }
+    );
+    return TaskStatus::complete;
+}
+
 TaskStatus BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
 {
     auto pmb = rc->GetBlockPointer();
@@ -317,10 +339,14 @@ void FluxCT(MeshData<Real> *md)
     const auto& B_F = md->PackVariablesAndFluxes(std::vector<std::string>{"cons.B"});
     const auto& emf_pack = md->PackVariables(std::vector<std::string>{"emf"});
 
-    // Get sizes
-    const IndexRange ib = md->GetBoundsI(IndexDomain::interior);
-    const IndexRange jb = md->GetBoundsJ(IndexDomain::interior);
-    const IndexRange kb = md->GetBoundsK(IndexDomain::interior);
+    // Get sizes, extended by the halo of a temporally blocked stage if any (see <driver> temporal_blocking)
+    const int h = pmb0->packages.Get("Flux")->Param<int>("stage_halo");
+    const IndexRange ib0 = md->GetBoundsI(IndexDomain::interior);
+    const IndexRange jb0 = md->GetBoundsJ(IndexDomain::interior);
+    const IndexRange kb0 = md->GetBoundsK(IndexDomain::interior);
+    const IndexRange ib = IndexRange{ib0.s - h, ib0.e + h};
+    const IndexRange jb = IndexRange{jb0.s - h, jb0.e + h};
+    const IndexRange kb = (ndim > 2) ? IndexRange{kb0.s - h, kb0.e + h} : kb0;
     const IndexRange block = IndexRange{0, B_F.GetDim(5)-1};
     // One zone halo on the *right only*, except for k in 2D
     const IndexRange il = IndexRange{ib.s, ib.e + 1};
@@ -344,29 +370,28 @@ void FluxCT(MeshData<Real> *md)
     // Rewrite EMFs as fluxes, after Toth (2000)
     // Note that zeroing FX(BX) is *necessary* -- this flux gets filled by GetFlux
     // Note these each have different domains, eg il vs ib.  The former extends one index farther if appropriate
-    pmb0->par_for("flux_ct_1", block.s, block.e, kb.s, kb.e, jb.s, jb.e, il.s, il.e,
-        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-            B_F(b).flux(X1DIR, V1, k, j, i) =  0.0;
-            B_F(b).flux(X1DIR, V2, k, j, i) =  0.5 * (emf_pack(b, V3, k, j, i) + emf_pack(b, V3, k, j+1, i));
-            if (ndim > 2) B_F(b).flux(X1DIR, V3, k, j, i) = -0.5 * (emf_pack(b, V2, k, j, i) + emf_pack(b, V2, k+1, j, i));
-        }
-    );
-    pmb0->par_for("flux_ct_2", block.s, block.e, kb.s, kb.e, jl.s, jl.e, ib.s, ib.e,
+    // All three directions are rewritten in one pass over the union of the domains, so each flux is
+    // written once.  The EMFs must be complete before any flux is overwritten, so they can't share a pass
+    pmb0->par_for("flux_ct", block.s, block.e, kl.s, kl.e, jl.s, jl.e, il.s, il.e,
         KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
-            B_F(b).flux(X2DIR, V1, k, j, i) = -0.5 * (emf_pack(b, V3, k, j, i) + emf_pack(b, V3, k, j, i+1));
-            B_F(b).flux(X2DIR, V2, k, j, i) =  0.0;
-            if (ndim > 2) B_F(b).flux(X2DIR, V3, k, j, i) =  0.5 * (emf_pack(b, V1, k, j, i) + emf_pack(b, V1, k+1, j, i));
-        }
-    );
-    if (ndim > 2) {
-        pmb0->par_for("flux_ct_3", block.s, block.e, kl.s, kl.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+            const bool in_k = k <= kb.e, in_j = j <= jb.e, in_i = i <= ib.e;
+            if (in_k && in_j) {
+                B_F(b).flux(X1DIR, V1, k, j, i) =  0.0;
+                B_F(b).flux(X1DIR, V2, k, j, i) =  0.5 * (emf_pack(b, V3, k, j, i) + emf_pack(b, V3, k, j+1, i));
+                if (ndim > 2) B_F(b).flux(X1DIR, V3, k, j, i) = -0.5 * (emf_pack(b, V2, k, j, i) + emf_pack(b, V2, k+1, j, i));
+            }
+            if (in_k && in_i) {
+                B_F(b).flux(X2DIR, V1, k, j, i) = -0.5 * (emf_pack(b, V3, k, j, i) + emf_pack(b, V3, k, j, i+1));
+                B_F(b).flux(X2DIR, V2, k, j, i) =  0.0;
+                if (ndim > 2) B_F(b).flux(X2DIR, V3, k, j, i) =  0.5 * (emf_pack(b, V1, k, j, i) + emf_pack(b, V1, k+1, j, i));
+            }
+            if (ndim > 2 && in_j && in_i) {
                 B_F(b).flux(X3DIR, V1, k, j, i) =  0.5 * (emf_pack(b, V2, k, j, i) + emf_pack(b, V2, k, j, i+1));
                 B_F(b).flux(X3DIR, V2, k, j, i) = -0.5 * (emf_pack(b, V1, k, j, i) + emf_pack(b, V1, k, j+1, i));
                 B_F(b).flux(X3DIR, V3, k, j, i) =  0.0;
             }
-        );
-    }
+        }
+    );
 }
 
 void ZeroBoundaryFlux(MeshData<Real> *md, IndexDomain domain, bool coarse)
@@ -609,11 +634,11 @@ double MaxDivB(MeshData<Real> *md)
 double GlobalMaxDivB(MeshData<Real> *md, bool all_reduce)
 {
     if (all_reduce) {
-        Reductions::StartToAll<Real>(md, 2, MaxDivB(md), MPI_MAX);
-        return Reductions::CheckOnAll<Real>(md, 2);
+        Reductions::StartToAll<Real>(md, Reductions::Channel::divb, MaxDivB(md), MPI_MAX);
+        return Reductions::CheckOnAll<Real>(md, Reductions::Channel::divb);
     } else {
-        Reductions::Start<Real>(md, 2, MaxDivB(md), MPI_MAX);
-        return Reductions::Check<Real>(md, 2);
+        Reductions::Start<Real>(md, Reductions::Channel::divb, MaxDivB(md), MPI_MAX);
+        return Reductions::Check<Real>(md, Reductions::Channel::divb);
     }
 }
 
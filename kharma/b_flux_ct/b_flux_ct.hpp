@@ -66,6 +66,11 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
  */
 TaskStatus BlockUtoP(MeshBlockData<Real> *md, IndexDomain domain, bool coarse=false);
 TaskStatus MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse=false);
+/**
+ * UtoP over just the ghost zones filled by communication, on all blocks in one kernel.
+ * Used after syncing only the conserved field.
+ */
+TaskStatus MeshBoundaryUtoP(MeshData<Real> *md);
 
 /**
  * Reverse of the above.  Only used alone during initialization.
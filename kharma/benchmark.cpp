@@ -0,0 +1,222 @@
+/* 
+ *  File: benchmark.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include "b_ct.hpp"
+#include "b_flux_ct.hpp"
+#include "floors.hpp"
+#include "flux.hpp"
+#include "get_flux.hpp"
+#include "implicit.hpp"
+#include "inverter.hpp"
+#include "kharma.hpp"
+#include "kharma_driver.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <tuple>
+
+namespace {
+
+struct Result {
+    std::string name;
+    double seconds;
+    double values_per_zone;
+};
+
+/**
+ * Mean time per call of fn over reps calls after a warm-up, on the slowest rank
+ */
+template<typename Function>
+double Time(const int& reps, Function fn)
+{
+    fn();
+    Kokkos::fence();
+    const auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < reps; ++n) fn();
+    Kokkos::fence();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / reps;
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+#endif
+    return seconds;
+}
+
+template<KReconstruction::Type Recon>
+void FluxAllDirections(MeshData<Real> *md, const int ndim)
+{
+    Flux::GetFlux<Recon, X1DIR>(md);
+    if (ndim > 1) Flux::GetFlux<Recon, X2DIR>(md);
+    if (ndim > 2) Flux::GetFlux<Recon, X3DIR>(md);
+}
+
+} // namespace
+
+bool Benchmark::Run(ParameterInput *pin, Mesh *pmesh)
+{
+    if (!pin->GetOrAddBoolean("benchmark", "on", false)) return false;
+    const int reps = pin->GetOrAddInteger("benchmark", "reps", 20);
+    // Substep length for the implicit solver, which is otherwise set by the driver
+    const Real implicit_dt = pin->GetOrAddReal("benchmark", "implicit_dt", 1e-3);
+    Flag("Benchmark");
+
+    auto packages = &pmesh->packages;
+    auto& pkgs = packages->AllPackages();
+    auto *md = pmesh->mesh_data.Get().get();
+    const int nprim = PackDimension(packages, Metadata::GetUserFlag("Primitive"));
+    const int ncons = PackDimension(packages, Metadata::Conserved);
+    const int ndim = pmesh->ndim;
+    double zones = 0;
+    for (auto &pmb : pmesh->block_list) {
+        const auto& bounds = pmb->cellbounds;
+        zones += (double) bounds.ncellsi(IndexDomain::interior) * bounds.ncellsj(IndexDomain::interior)
+                 * bounds.ncellsk(IndexDomain::interior);
+    }
+
+    std::vector<Result> results;
+
+    // Fluxes, for each reconstruction with enough ghost zones.  Variants needing extra state
+    // (lower-order edges/poles, cached or adaptive WENO) are left out
+    using RType = KReconstruction::Type;
+    const std::vector<std::tuple<std::string, int, void (*)(MeshData<Real>*, const int)>> recons = {
+        {"donor_cell", 1, FluxAllDirections<RType::donor_cell>},
+        {"linear_mc", 3, FluxAllDirections<RType::linear_mc>},
+        {"linear_vl", 3, FluxAllDirections<RType::linear_vl>},
+        {"weno5", 5, FluxAllDirections<RType::weno5>},
+        {"ppm", 5, FluxAllDirections<RType::ppm>},
+        {"ppmx", 5, FluxAllDirections<RType::ppmx>},
+        {"mp5", 5, FluxAllDirections<RType::mp5>}
+    };
+    if (pkgs.count("B_CT"))
+        B_CT::MeshUtoP(md, IndexDomain::entire, false);
+    for (auto &recon : recons) {
+        if (Globals::nghost < std::get<1>(recon)/2 + 1) continue;
+        auto fn = std::get<2>(recon);
+        results.push_back({"flux_" + std::get<0>(recon), Time(reps, [&]() { fn(md, ndim); }),
+                           ndim * (5. * nprim + ncons)});
+    }
+
+    // Magnetic field transport, from the last fluxes
+    if (pkgs.count("B_CT")) {
+        results.push_back({"emf_b_ct", Time(reps, [&]() { B_CT::CalculateEMF(md); }), 3. * ndim + 6.});
+    } else if (pkgs.count("B_FluxCT")) {
+        results.push_back({"flux_ct", Time(reps, [&]() { B_FluxCT::FluxCT(md); }), 2. * ndim});
+    }
+
+    // Inversion with each solver.  Tolerances & iteration counts are those set for the configured type
+    if (pkgs.count("Inverter")) {
+        auto& pars = pkgs.at("Inverter")->AllParams();
+        auto run_inverter = [&]() { Inverter::MeshUtoP(md, IndexDomain::interior, false); };
+        if (pars.Get<bool>("two_pass")) {
+            results.push_back({"u_to_p_two_pass", Time(reps, run_inverter), ncons + nprim + 1.});
+        } else {
+            const Inverter::Type type = pars.Get<Inverter::Type>("inverter_type");
+            for (auto &inv : std::vector<std::pair<std::string, Inverter::Type>>({{"onedw", Inverter::Type::onedw},
+                                                                                 {"kastaun", Inverter::Type::kastaun},
+                                                                                 {"kastaun_lockstep", Inverter::Type::kastaun_lockstep}})) {
+                pars.Update<Inverter::Type>("inverter_type", inv.second);
+                results.push_back({"u_to_p_" + inv.first, Time(reps, run_inverter), ncons + nprim + 1.});
+            }
+            pars.Update<Inverter::Type>("inverter_type", type);
+        }
+    }
+
+    // Floors in each frame.  The mixed frames only switch between these
+    if (pkgs.count("Floors")) {
+        auto& pars = pkgs.at("Floors")->AllParams();
+        using Floors::InjectionFrame;
+        const InjectionFrame frame = pars.Get<InjectionFrame>("frame");
+        for (auto &fr : std::vector<std::pair<std::string, InjectionFrame>>({{"normal", InjectionFrame::normal},
+                                                                            {"fluid", InjectionFrame::fluid},
+                                                                            {"drift", InjectionFrame::drift}})) {
+            pars.Update<InjectionFrame>("frame", fr.second);
+            results.push_back({"floors_" + fr.first,
+                               Time(reps, [&]() { Floors::ApplyGRMHDFloors(md, IndexDomain::interior); }),
+                               2. * (nprim + ncons) + 1.});
+        }
+        pars.Update<InjectionFrame>("frame", frame);
+    }
+
+    // Implicit step from the initial state with no flux divergence, copying in the guess each time as
+    // the driver does.  Bandwidth is nominal for a single solver iteration
+    if (pkgs.count("Implicit")) {
+        const int nimplicit = PackDimension(packages, Metadata::GetUserFlag("Implicit"));
+        const bool use_linesearch = pkgs.at("Implicit")->Param<bool>("linesearch");
+        pmesh->mesh_data.Add("bench_dUdt");
+        pmesh->mesh_data.Add("bench_solver");
+        if (use_linesearch) pmesh->mesh_data.Add("bench_linesearch");
+        auto *md_flux_src = pmesh->mesh_data.Get("bench_dUdt").get();
+        auto *md_solver = pmesh->mesh_data.Get("bench_solver").get();
+        auto *md_linesearch = (use_linesearch) ? pmesh->mesh_data.Get("bench_linesearch").get() : md_solver;
+        KHARMADriver::Copy<MeshData<Real>>({Metadata::Cell}, md, md_solver);
+        results.push_back({"implicit_step", Time(reps, [&]() {
+            KHARMADriver::Copy<MeshData<Real>>({Metadata::GetUserFlag("Implicit")}, md, md_solver);
+            if (use_linesearch)
+                KHARMADriver::Copy<MeshData<Real>>({Metadata::GetUserFlag("Primitive")}, md_solver, md_linesearch);
+            Implicit::Step(md, md, md_flux_src, md_linesearch, md_solver, implicit_dt);
+        }), nimplicit * (nimplicit + 4.) + 2. * nprim});
+    }
+
+    if (MPIRank0()) {
+        std::cout << "Kernel benchmarks, " << reps << " calls each over " << zones << " zones per rank:" << std::endl;
+        std::cout << "  " << std::left << std::setw(20) << "kernel" << std::right << std::setw(12) << "ms/call"
+                  << std::setw(14) << "Mzone-upd/s" << std::setw(10) << "GB/s" << std::endl;
+        for (auto &r : results)
+            std::cout << "  " << std::left << std::setw(20) << r.name << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(12) << r.seconds * 1e3 << std::setw(14) << zones / r.seconds / 1e6
+                      << std::setw(10) << zones * r.values_per_zone * sizeof(Real) / r.seconds / 1e9 << std::endl;
+        std::cout << std::defaultfloat << std::endl;
+
+        const std::string fname = packages->Get("Globals")->Param<std::string>("problem") + ".kharma_bench.json";
+        FILE *f = fopen(fname.c_str(), "w");
+        fprintf(f, "{\n  \"kharma-benchmark\": {\n");
+        fprintf(f, "    \"version\": \"%s\",\n", packages->Get("Globals")->Param<std::string>("version").c_str());
+        fprintf(f, "    \"ranks\": %d,\n", MPINumRanks());
+        fprintf(f, "    \"zones-per-rank\": %.17g,\n", zones);
+        fprintf(f, "    \"reps\": %d,\n", reps);
+        fprintf(f, "    \"bytes-per-value\": %d,\n", (int) sizeof(Real));
+        fprintf(f, "    \"kernels\": {");
+        int n = 0;
+        for (auto &r : results)
+            fprintf(f, "%s\n      \"%s\": {\"seconds-per-call\": %.6g, \"zone-updates-per-second\": %.6g, \"gb-per-second\": %.6g}",
+                    (n++ > 0) ? "," : "", r.name.c_str(), r.seconds, zones / r.seconds,
+                    zones * r.values_per_zone * sizeof(Real) / r.seconds / 1e9);
+        fprintf(f, "\n    }\n  }\n}\n");
+        fclose(f);
+    }
+
+    EndFlag();
+    return true;
+}
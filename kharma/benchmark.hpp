@@ -0,0 +1,66 @@
+/* 
+ *  File: benchmark.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Per-kernel benchmarks, for catching performance regressions between versions.
+ *
+ * With <benchmark>on = true, KHARMA sets up the problem as usual, then instead of running the driver
+ * times each of the main kernels over the whole mesh on each rank, <benchmark>reps times after one
+ * warm-up call.  Covered are:
+ * 1. GetFlux in all directions, for each reconstruction the ghost zones allow
+ * 2. U to P inversion, for each inverter type
+ * 3. GRMHD floors, in each of the normal, fluid and drift frames
+ * 4. The implicit solver step, if the Implicit package is loaded (incl. copying in the guess)
+ * 5. EMF calculation or flux-CT, for whichever B field transport is loaded
+ *
+ * Results are printed on rank 0 and written to <problem_id>.kharma_bench.json, with the slowest
+ * rank's time per call, zone-updates/s per rank and a nominal bandwidth.  The bandwidth models
+ * match those of <driver>performance_json, see KHARMADriver::WritePerformanceJSON.
+ * Compare two such files with scripts/compare_benchmarks.py.
+ *
+ * Kernels run on the problem's initial state, so e.g. inversions converge as they would early in
+ * a run.  Use a representative problem, e.g. pars/benchmark/kernels_kharma.par
+ */
+namespace Benchmark {
+
+/**
+ * Run the benchmarks, if requested.  Call after PostInitialize.
+ * @return whether benchmarks were run, in which case the driver should not be
+ */
+bool Run(ParameterInput *pin, Mesh *pmesh);
+
+}
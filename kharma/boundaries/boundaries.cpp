@@ -59,6 +59,9 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
     auto pkg = std::make_shared<KHARMAPackage>("Boundaries");
     Params &params = pkg->AllParams();
 
+    // List of ghost zones filled by communication, for operating on all of them at once
+    params.Add("synced_slabs", std::map<int, SyncedSlabs>(), true);
+
     // OPTIONS FOR SPECIFIC BOUNDARIES
     bool spherical = pin->GetBoolean("coordinates", "spherical");
     // Global check inflow sets inner/outer X1 by default
@@ -97,11 +100,24 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
     params.Add("fix_corner_inner", fix_corner);
     params.Add("fix_corner_outer", pin->GetOrAddBoolean("boundaries", "fix_corner_outer", false));
 
+    // Excise zones well inside the event horizon, r < excise_r. The inversion, floors and implicit solve
+    // skip them entirely, so they keep their primitive state.  Disabled by default
+    const Real excise_r = pin->GetOrAddReal("boundaries", "excise_r", 0.);
+    if (excise_r > 0.) {
+        if (!spherical)
+            throw std::invalid_argument("Excision requires spherical coordinates!");
+        if (excise_r >= pin->GetReal("coordinates", "r_eh"))
+            throw std::invalid_argument("Excision radius must be inside the event horizon!");
+    }
+    params.Add("excise_r", excise_r);
+    params.Add("excised_starts", std::map<int, ExcisedStarts>(), true);
+
     // We can't use GetVariablesByFlag yet, so ask the packages
     // These flags get anything that needs a physical boundary during the run
     using FC = Metadata::FlagCollection;
     FC ghost_vars = FC({Metadata::FillGhost, Metadata::Conserved})
                 + FC({Metadata::FillGhost, Metadata::GetUserFlag("Primitive")})
+                + FC({Metadata::GetUserFlag("HaloFloat")})
                 - FC({Metadata::GetUserFlag("StartupOnly")});
     int nvar = KHARMA::PackDimension(packages.get(), ghost_vars);
     // Face-centered fields: some duplicate stuff, leaving it separate for now
@@ -109,8 +125,16 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
                 - FC({Metadata::GetUserFlag("StartupOnly")});
     int nvar_f = 3 * m::max(KHARMA::PackDimension(packages.get(), ghost_vars_f), 1);
 
+    // Transmitting conditions on several blocks in X3 cache the opposite side of the pole.
+    // They are filled for every cell & face variable synchronized in ghost zones, in pack order
+    FC transmit_vars = FC({Metadata::FillGhost, Metadata::Cell})
+                + FC({Metadata::GetUserFlag("HaloFloat")})
+                - FC({Metadata::GetUserFlag("StartupOnly")});
+    int nvar_t = m::max(KHARMA::PackDimension(packages.get(), transmit_vars), 1);
+    int nvar_t_f = 3 * m::max(KHARMA::PackDimension(packages.get(), ghost_vars_f), 1);
+
     // TODO encapsulate this
-    Metadata m_x1, m_x2, m_x3, m_x1_f, m_x2_f, m_x3_f;
+    Metadata m_x1, m_x2, m_x3, m_x1_f, m_x2_f, m_x3_f, m_x2_t, m_x2_t_f;
     {
         // We also don't know the mesh size, since it's not constructed.  We infer.
         const int ng = pin->GetInteger("parthenon/mesh", "nghost");
@@ -121,6 +145,7 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
         const int nx3 = pin->GetInteger("parthenon/meshblock", "nx3");
         const int n3 = (nx3 == 1) ? nx3 : nx3 + 2 * ng;
 
+        // Caches cover only the ghost slab of their face: ng zones deep, by the full block in the other directions.
         // These are declared *backward* from how they will be indexed
         std::vector<int> s_x1({ng, n2, n3, nvar});
         std::vector<int> s_x2({n1, ng, n3, nvar});
@@ -129,6 +154,8 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
         m_x1 = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x1);
         m_x2 = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x2);
         m_x3 = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x3);
+        // Transmitting caches are refilled before every use, so they needn't be kept in restarts
+        m_x2_t = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy}, std::vector<int>({n1, ng, n3, nvar_t}));
 
         if (nvar_f > 0) {
             // Face mesh sizes
@@ -149,10 +176,14 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
             m_x1_f = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x1_f);
             m_x2_f = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x2_f);
             m_x3_f = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy, Metadata::Restart}, s_x3_f);
+            m_x2_t_f = Metadata({Metadata::Real, Metadata::Derived, Metadata::OneCopy}, std::vector<int>({n1_f, ng_f, n3_f, nvar_t_f}));
         }
     }
 
     // Set options for each boundary
+    BoundaryConfigs config;
+    bool transmit_multiblock = false;
+    int transmit_nb3 = 1;
     for (int i = 0; i < BOUNDARY_NFACES; i++) {
         const auto bface = (BoundaryFace) i;
         const auto bdomain = BoundaryDomain(bface);
@@ -177,6 +208,10 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
         // Ensure fluxes through the zero-size face at the pole are zero
         bool excise_flux = pin->GetOrAddBoolean("boundaries", "excise_flux_" + bname, excise_polar_flux && bdir == X2DIR);
         params.Add("excise_flux_" + bname, excise_flux);
+        if (excise_flux && packages->Get("Flux")->Param<bool>("fused_flux"))
+            throw std::runtime_error("Excising polar fluxes requires the unfused flux calculation! Set <flux> fused = false");
+        if (excise_flux && packages->Get("Flux")->Param<bool>("fuse_divergence"))
+            throw std::runtime_error("Excising polar fluxes requires a separate geometric source! Set <flux> fuse_divergence = false");
 
         // Allow specifically dP to outflow in otherwise Dirichlet conditions
         // Only used for viscous_bondi problem
@@ -212,6 +247,30 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
         params.Add("cancel_U3_"+bname, cancel_U3);
         bool cancel_T3 = pin->GetOrAddBoolean("boundaries", "cancel_T3_" + bname, false);
         params.Add("cancel_T3_"+bname, cancel_T3);
+        // Each of these recomputes ctop near the pole after the fluxes, see GRMHD::UpdateAveragedCtop
+        const bool reconnect_B3 = params.hasKey("reconnect_B3_"+bname) && params.Get<bool>("reconnect_B3_"+bname);
+        if ((cancel_U3 || cancel_T3 || reconnect_B3 || excise_flux) && packages->Get("Flux")->Param<bool>("cache_timestep"))
+            throw std::runtime_error("Polar averaging/excision modifies ctop after the flux calculation! Set <flux> cache_timestep = false");
+
+        // Record everything in the typed version used during the run
+        BoundaryConfig &bconf = config.face[i];
+        const std::map<std::string, BoundaryType> types = {{"periodic", BoundaryType::periodic}, {"outflow", BoundaryType::outflow},
+                                                           {"reflecting", BoundaryType::reflecting}, {"dirichlet", BoundaryType::dirichlet},
+                                                           {"transmitting", BoundaryType::transmitting}, {"bondi", BoundaryType::bondi}};
+        if (types.count(btype)) bconf.type = types.at(btype);
+        bconf.check_inflow = check_inflow;
+        bconf.zero_flux = zero_flux;
+        bconf.excise_flux = excise_flux;
+        bconf.outflow_EMHD = outflow_EMHD;
+        bconf.cancel_U3 = cancel_U3;
+        bconf.cancel_T3 = cancel_T3;
+        if (packages->AllPackages().count("B_CT")) {
+            bconf.reflect_face_vector = params.Get<bool>("reflect_face_vector_"+bname);
+            bconf.clean_face_B = params.Get<bool>("clean_face_B_"+bname);
+            bconf.reconnect_B3 = reconnect_B3;
+            bconf.average_EMF = params.Get<bool>("average_EMF_"+bname);
+            bconf.zero_EMF = params.Get<bool>("zero_EMF_"+bname);
+        }
 
         // String manip to get the Parthenon boundary name, e.g., "ox1_bc"
         auto bname_parthenon = bname.substr(0, 1) + "x" + bname.substr(7, 8) + "_bc";
@@ -298,9 +357,26 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
                 default:
                     break;
                 }
-                if (pin->GetInteger("parthenon/mesh", "nx3") != pin->GetInteger("parthenon/meshblock", "nx3") ||
-                    pin->GetInteger("parthenon/mesh", "nx3") == 1)
-                    throw std::runtime_error("Transmitting polar boundary conditions require 3D with one block in x3!");
+                const int mesh_nx3 = pin->GetInteger("parthenon/mesh", "nx3");
+                const int block_nx3 = pin->GetInteger("parthenon/meshblock", "nx3");
+                if (mesh_nx3 == 1)
+                    throw std::runtime_error("Transmitting polar boundary conditions require 3D!");
+                if (mesh_nx3 != block_nx3) {
+                    // Several blocks in X3: each must have whole blocks opposite it, see ExchangeTransmitting
+                    if ((mesh_nx3 / 2) % block_nx3 != 0)
+                        throw std::runtime_error("Transmitting polar boundary conditions with several blocks in x3 "
+                                                 "require nx3/2 be a multiple of the meshblock nx3!");
+                    if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") != "none")
+                        throw std::runtime_error("Transmitting polar boundary conditions with several blocks in x3 do not support refinement!");
+                    transmit_multiblock = true;
+                    transmit_nb3 = mesh_nx3 / block_nx3;
+                    pkg->AddField(TransmitSlabName(bface, false), m_x2_t);
+                    pkg->AddField(TransmitSlabName(bface, false, true), m_x2_t);
+                    if (nvar_f > 0) {
+                        pkg->AddField(TransmitSlabName(bface, true), m_x2_t_f);
+                        pkg->AddField(TransmitSlabName(bface, true, true), m_x2_t_f);
+                    }
+                }
                 if (pin->GetString("coordinates", "transform") == "fmks" || pin->GetString("coordinates", "transform") == "funky")
                     throw std::runtime_error("Transmitting polar boundary conditions require coordinates symmetric about theta=0!");
                 // TODO also check for wedge simulations x3<2pi
@@ -358,6 +434,28 @@ std::shared_ptr<KHARMAPackage> KBoundaries::Initialize(ParameterInput *pin, std:
         }
     }
 
+    params.Add("config", config);
+    params.Add("transmit_multiblock", transmit_multiblock);
+    params.Add("transmit_nb3", transmit_nb3);
+    params.Add("transmit_ready", false, true);
+
+    // Apply the physical boundaries of whole MeshData objects at once, see ApplyBoundariesMesh
+    bool mesh_level = pin->GetOrAddBoolean("boundaries", "mesh_level", false);
+    if (mesh_level) {
+        if (packages->AllPackages().count("B_CT"))
+            throw std::runtime_error("Mesh-level boundaries do not yet support face-centered fields! Set <boundaries> mesh_level = false");
+        for (int i = 0; i < BOUNDARY_NFACES; i++) {
+            const auto btype = params.Get<std::string>(BoundaryName((BoundaryFace) i));
+            if (btype != "outflow" && btype != "reflecting" && btype != "periodic")
+                throw std::runtime_error("Mesh-level boundaries support only outflow, reflecting & periodic conditions, not "+btype+"!");
+            if (config[i].cancel_U3 || config[i].cancel_T3 || config[i].outflow_EMHD)
+                throw std::runtime_error("Mesh-level boundaries do not support cancel_U3, cancel_T3 or outflow_EMHD!");
+        }
+    }
+    params.Add("mesh_level", mesh_level);
+    params.Add("physical_slabs", std::map<int, PhysicalSlabs>(), true);
+    params.Add("flux_faces", std::map<int, SyncedSlabs>(), true);
+
     // Callbacks
     // Fix flux
     pkg->FixFlux = KBoundaries::FixFlux;
@@ -386,8 +484,7 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
     // std::cout << std::endl;
 
     const auto bface = BoundaryFaceOf(domain);
-    const auto bname = BoundaryName(bface);
-    const auto btype_name = params.Get<std::string>(bname);
+    const BoundaryConfig &bconf = params.Get<BoundaryConfigs>("config")[bface];
     const auto bdir = BoundaryDirection(bface);
     const bool binner = BoundaryIsInner(bface);
 
@@ -403,23 +500,23 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
     // We should do a PreBoundaries callback...
     if (pmb->packages.AllPackages().count("B_CT")) {
         auto bfpack = rc->PackVariables({Metadata::Face, Metadata::FillGhost, Metadata::GetUserFlag("B_CT")});
-        if (params.Get<bool>("reconnect_B3_" + bname) && bfpack.GetDim(4) > 0) {
-            Flag("ReconnectFaceB_"+bname);
+        if (bconf.reconnect_B3 && bfpack.GetDim(4) > 0) {
+            Flag("ReconnectFaceB");
             B_CT::ReconnectBoundaryB3(rc.get(), domain, bfpack, coarse);
             EndFlag();
         }
     }
     if (pmb->packages.AllPackages().count("GRMHD")) {
-        if (params.Get<bool>("cancel_U3_" + bname) && full_grmhd_boundary) {
+        if (bconf.cancel_U3 && full_grmhd_boundary) {
             GRMHD::CancelBoundaryU3(rc.get(), domain, coarse);
         }
-        if (params.Get<bool>("cancel_T3_" + bname) && full_grmhd_boundary) {
+        if (bconf.cancel_T3 && full_grmhd_boundary) {
             GRMHD::CancelBoundaryT3(rc.get(), domain, coarse);
         }
     }
 
     // Always call through to the registered boundary function
-    Flag("Apply "+bname+" boundary: "+btype_name);
+    Flag("ApplyBoundaryFunction");
     pkg->KBoundaries[bface](rc, coarse);
     EndFlag();
 
@@ -439,13 +536,13 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
         // so we can't assume their presence means they are alone
         auto& emfpack = rc->PackVariables(std::vector<std::string>{"B_CT.emf"});
         if (emfpack.GetDim(4) > 0) {
-            if (params.Get<bool>("zero_EMF_" + bname)) {
-                Flag("ZeroEMF_"+bname);
+            if (bconf.zero_EMF) {
+                Flag("ZeroEMF");
                 B_CT::ZeroBoundaryEMF(rc.get(), domain, emfpack, coarse);
                 EndFlag();
             }
-            if (params.Get<bool>("average_EMF_" + bname)) {
-                Flag("AverageEMF_"+bname);
+            if (bconf.average_EMF) {
+                Flag("AverageEMF");
                 B_CT::AverageBoundaryEMF(rc.get(), domain, emfpack, coarse);
                 EndFlag();
             }
@@ -455,8 +552,8 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
         // Note these are REFLECTING SPECIFIC, not suitable for the similar op w/transmitting
         // TODO move this to Parthenon.  Move out of this case if we gain non-B_CT face variables
         auto fpack = rc->PackVariables({Metadata::Face, Metadata::FillGhost, Metadata::GetUserFlag("SplitVector")});
-        if (params.Get<bool>("reflect_face_vector_" + bname) && fpack.GetDim(4) > 0) {
-            Flag("ReflectFace_"+bname);
+        if (bconf.reflect_face_vector && fpack.GetDim(4) > 0) {
+            Flag("ReflectFace");
             const TopologicalElement face = FaceOf(bdir);
             auto b = KDomain::GetBoundaryRange(rc, domain, face, coarse);
             // Zero the last physical face, otherwise invert.
@@ -464,7 +561,7 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
             auto j_f = (binner) ? b.je : b.js;
             auto k_f = (binner) ? b.ke : b.ks;
             pmb->par_for(
-                "reflect_face_vector_" + bname, 0, fpack.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                "reflect_face_vector", 0, fpack.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
                 KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
                     const int kk = (bdir == 3) ? k_f - (k - k_f) : k;
                     const int jj = (bdir == 2) ? j_f - (j - j_f) : j;
@@ -480,8 +577,8 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
         // Correct orthogonal B field component to eliminate divergence in last rank
         // and ghosts. Used for outflow conditions when field lines will exit domain
         auto bfpack = rc->PackVariables({Metadata::Face, Metadata::FillGhost, Metadata::GetUserFlag("B_CT")});
-        if (params.Get<bool>("clean_face_B_" + bname) && bfpack.GetDim(4) > 0) {
-            Flag("CleanFaceB_"+bname);
+        if (bconf.clean_face_B && bfpack.GetDim(4) > 0) {
+            Flag("CleanFaceB");
             B_CT::DestructiveBoundaryClean(rc.get(), domain, bfpack, coarse);
             EndFlag();
         }
@@ -499,16 +596,16 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
 
     // Prevent inflow of material by changing fluid speeds,
     // anywhere we've specified.
-    if (params.Get<bool>("check_inflow_" + bname)) {
-        Flag("CheckInflow_"+bname);
+    if (bconf.check_inflow) {
+        Flag("CheckInflow");
         CheckInflow(rc, domain, coarse);
         EndFlag();
     }
 
     // Allow specifically dP to outflow in otherwise Dirichlet conditions
     // Only used for viscous_bondi problem, should be moved in there somehow
-    if (params.Get<bool>("outflow_EMHD_" + bname)) {
-        Flag("OutflowEMHD_"+bname);
+    if (bconf.outflow_EMHD) {
+        Flag("OutflowEMHD");
         auto EMHDg = rc->PackVariables({Metadata::GetUserFlag("EMHDVar"), Metadata::FillGhost});
         const auto &bounds = coarse ? pmb->c_cellbounds : pmb->cellbounds;
         const auto &range = (bdir == 1) ? bounds.GetBoundsI(IndexDomain::interior)
@@ -558,6 +655,15 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
         }
     }
 
+    BoundaryLockstep(rc.get(), domain, coarse);
+
+    EndFlag();
+}
+
+void KBoundaries::BoundaryLockstep(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
+{
+    auto pmb = rc->GetBlockPointer();
+    auto& params = pmb->packages.Get("Boundaries")->AllParams();
     bool sync_prims = pmb->packages.Get("Driver")->Param<bool>("sync_prims");
     // There are two modes of operation here:
     if (sync_prims) {
@@ -567,25 +673,286 @@ void KBoundaries::ApplyBoundary(std::shared_ptr<MeshBlockData<Real>> &rc, IndexD
         // TODO there should be a set of B field wrappers that dispatch this
         auto pkgs = pmb->packages.AllPackages();
         if (pkgs.count("B_CT")) {
-            B_CT::BlockUtoP(rc.get(), domain, coarse);
+            B_CT::BlockUtoP(rc, domain, coarse);
         } else {
-            B_FluxCT::BlockUtoP(rc.get(), domain, coarse);
+            B_FluxCT::BlockUtoP(rc, domain, coarse);
         }
-        Flux::BlockPtoU(rc.get(), domain, coarse);
+        Flux::BlockPtoU(rc, domain, coarse);
     } else {
         // 2. Exchange/prolongate/restrict CONSERVED variables: (KHARMA driver)
         //    Conserved variables are marked FillGhost, plus FLUID PRIMITIVES.
         if (!params.Get<bool>("domain_bounds_on_conserved")) {
             // To apply primitive boundaries to GRMHD, we run PtoU on that ONLY,
             // and UtoP on EVERYTHING ELSE
-            Packages::BoundaryPtoUElseUtoP(rc.get(), domain, coarse);
+            Packages::BoundaryPtoUElseUtoP(rc, domain, coarse);
         } else {
             // If we want to apply boundaries to conserved vars, just run UtoP on EVERYTHING
-            Packages::BoundaryUtoP(rc.get(), domain, coarse);
+            Packages::BoundaryUtoP(rc, domain, coarse);
+        }
+    }
+}
+
+KBoundaries::SyncedSlabs KBoundaries::GetSyncedSlabs(MeshData<Real> *md, bool coarse)
+{
+    auto *slabs = GetPartitionParam<SyncedSlabs>(md, "Boundaries", "synced_slabs");
+
+    // Avoid the host->device copy (and sync) unless the blocks have changed
+    auto locs = PartitionLocations(md);
+    if (slabs->nslabs > 0 && slabs->coarse == coarse && slabs->locs == locs) return *slabs;
+
+    const int max_slabs = md->NumBlocks() * BOUNDARY_NFACES;
+    if (slabs->bounds.extent_int(0) < max_slabs) {
+        slabs->bounds  = ParArray2D<int>("synced_slab_bounds", max_slabs, 7);
+        slabs->offsets = ParArray1D<int>("synced_slab_offsets", max_slabs + 1);
+    }
+
+    // List the slabs on the host
+    auto bounds_h  = slabs->bounds.GetHostMirror();
+    auto offsets_h = slabs->offsets.GetHostMirror();
+    int s = 0, nzones = 0;
+    for (int i_block = 0; i_block < md->NumBlocks(); i_block++) {
+        auto &rc = md->GetBlockData(i_block);
+        for (int i_bnd = 0; i_bnd < BOUNDARY_NFACES; i_bnd++) {
+            if (rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::block ||
+                rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::periodic) {
+                const IndexRange3 bb = KDomain::GetRange(rc.get(), BoundaryDomain((BoundaryFace) i_bnd), coarse);
+                const int bds[7] = {i_block, bb.ks, bb.ke, bb.js, bb.je, bb.is, bb.ie};
+                for (int l = 0; l < 7; l++) bounds_h(s, l) = bds[l];
+                offsets_h(s) = nzones;
+                nzones += (bb.ke - bb.ks + 1) * (bb.je - bb.js + 1) * (bb.ie - bb.is + 1);
+                s++;
+            }
+        }
+    }
+    offsets_h(s) = nzones;
+    slabs->bounds.DeepCopy(bounds_h);
+    slabs->offsets.DeepCopy(offsets_h);
+    slabs->nslabs = s;
+    slabs->nzones = nzones;
+    slabs->locs = locs;
+    slabs->coarse = coarse;
+
+    return *slabs;
+}
+
+KBoundaries::PhysicalSlabs KBoundaries::GetPhysicalSlabs(MeshData<Real> *md)
+{
+    auto *slabs = GetPartitionParam<PhysicalSlabs>(md, "Boundaries", "physical_slabs");
+    auto locs = PartitionLocations(md);
+    if (slabs->locs == locs) return *slabs;
+
+    const int ndim = md->GetMeshPointer()->ndim;
+    for (int d = 0; d < 3; d++) {
+        SyncedSlabs &dslabs = slabs->dir[d];
+        const int max_slabs = md->NumBlocks() * 2;
+        if (dslabs.bounds.extent_int(0) < max_slabs) {
+            dslabs.bounds  = ParArray2D<int>("physical_slab_bounds", max_slabs, 8);
+            dslabs.offsets = ParArray1D<int>("physical_slab_offsets", max_slabs + 1);
+        }
+        auto bounds_h  = dslabs.bounds.GetHostMirror();
+        auto offsets_h = dslabs.offsets.GetHostMirror();
+        int s = 0, nzones = 0;
+        for (int i_block = 0; i_block < md->NumBlocks(); i_block++) {
+            auto &rc = md->GetBlockData(i_block);
+            for (int i_bnd = 2*d; i_bnd < 2*d + 2 && d < ndim; i_bnd++) {
+                if (rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::user) {
+                    const IndexRange3 bb = KDomain::GetRange(rc.get(), BoundaryDomain((BoundaryFace) i_bnd));
+                    const int bds[8] = {i_block, bb.ks, bb.ke, bb.js, bb.je, bb.is, bb.ie, i_bnd};
+                    for (int l = 0; l < 8; l++) bounds_h(s, l) = bds[l];
+                    offsets_h(s) = nzones;
+                    nzones += (bb.ke - bb.ks + 1) * (bb.je - bb.js + 1) * (bb.ie - bb.is + 1);
+                    s++;
+                }
+            }
+        }
+        offsets_h(s) = nzones;
+        dslabs.bounds.DeepCopy(bounds_h);
+        dslabs.offsets.DeepCopy(offsets_h);
+        dslabs.nslabs = s;
+        dslabs.nzones = nzones;
+    }
+    slabs->locs = locs;
+
+    return *slabs;
+}
+
+int KBoundaries::ExcisedStart(MeshBlockData<Real> *rc)
+{
+    auto pmb = rc->GetBlockPointer();
+    const Real excise_r = pmb->packages.Get("Boundaries")->Param<Real>("excise_r");
+    if (excise_r <= 0.) return 0;
+    // r depends only on X1 in spherical coordinates, so look along the first row
+    const auto& G = pmb->coords;
+    const IndexRange3 b = KDomain::GetRange(rc, IndexDomain::entire);
+    int i = b.is;
+    while (i <= b.ie && G.r(b.ks, b.js, i) < excise_r) i++;
+    return i;
+}
+
+ParArray1D<int> KBoundaries::GetExcisedStarts(MeshData<Real> *md)
+{
+    auto *cache = GetPartitionParam<ExcisedStarts>(md, "Boundaries", "excised_starts");
+    auto locs = PartitionLocations(md);
+    if (cache->starts.extent_int(0) >= md->NumBlocks() && cache->locs == locs) return cache->starts;
+
+    if (cache->starts.extent_int(0) < md->NumBlocks())
+        cache->starts = ParArray1D<int>("excised_starts", md->NumBlocks());
+    const auto starts = cache->starts;
+    auto starts_h = Kokkos::create_mirror_view(starts);
+    for (int b = 0; b < md->NumBlocks(); ++b)
+        starts_h(b) = ExcisedStart(md->GetBlockData(b).get());
+    Kokkos::deep_copy(starts, starts_h);
+    cache->locs = locs;
+    return starts;
+}
+
+KBoundaries::SyncedSlabs KBoundaries::GetFluxFaces(MeshData<Real> *md)
+{
+    auto *faces = GetPartitionParam<SyncedSlabs>(md, "Boundaries", "flux_faces");
+    auto locs = PartitionLocations(md);
+    if (faces->locs == locs) return *faces;
+
+    auto pmesh = md->GetMeshPointer();
+    const BoundaryConfigs &config = GetBoundaryConfigs(pmesh->packages);
+    const int ndim = pmesh->ndim;
+    const IndexRange3 b1 = KDomain::GetRange(md, IndexDomain::interior, -1, 1);
+
+    const int max_faces = md->NumBlocks() * BOUNDARY_NFACES;
+    if (faces->bounds.extent_int(0) < max_faces) {
+        faces->bounds  = ParArray2D<int>("flux_face_bounds", max_faces, 8);
+        faces->offsets = ParArray1D<int>("flux_face_offsets", max_faces + 1);
+    }
+    auto bounds_h  = faces->bounds.GetHostMirror();
+    auto offsets_h = faces->offsets.GetHostMirror();
+    int s = 0, nzones = 0;
+    for (int i_block = 0; i_block < md->NumBlocks(); i_block++) {
+        auto &rc = md->GetBlockData(i_block);
+        for (int i_bnd = 0; i_bnd < BOUNDARY_NFACES; i_bnd++) {
+            const BoundaryFace bface = (BoundaryFace) i_bnd;
+            const int bdir = BoundaryDirection(bface);
+            if (bdir > ndim || rc->GetBlockPointer()->boundary_flag[bface] != BoundaryFlag::user ||
+                !(config[bface].check_inflow || config[bface].zero_flux)) continue;
+            // Same faces as FixFlux: the first/last face in bdir, with a 1-zone halo for FluxCT
+            const IndexRange3 bf = KDomain::GetRange(rc.get(), IndexDomain::interior, FaceOf(bdir));
+            IndexRange3 b = b1;
+            if (bdir == 1) {
+                b.is = b.ie = (BoundaryIsInner(bface)) ? bf.is : bf.ie;
+            } else if (bdir == 2) {
+                b.js = b.je = (BoundaryIsInner(bface)) ? bf.js : bf.je;
+            } else {
+                b.ks = b.ke = (BoundaryIsInner(bface)) ? bf.ks : bf.ke;
+            }
+            const int bds[8] = {i_block, b.ks, b.ke, b.js, b.je, b.is, b.ie, i_bnd};
+            for (int l = 0; l < 8; l++) bounds_h(s, l) = bds[l];
+            offsets_h(s) = nzones;
+            nzones += (b.ke - b.ks + 1) * (b.je - b.js + 1) * (b.ie - b.is + 1);
+            s++;
+        }
+    }
+    offsets_h(s) = nzones;
+    faces->bounds.DeepCopy(bounds_h);
+    faces->offsets.DeepCopy(offsets_h);
+    faces->nslabs = s;
+    faces->nzones = nzones;
+    faces->locs = locs;
+
+    return *faces;
+}
+
+/**
+ * Fill the ghost zones of one direction's physical slabs listed in slabs, for faces with mask[face] set.
+ * Each ghost zone reads only physical zones in direction bdir, so zones are independent
+ */
+void FillPhysicalSlabs(MeshData<Real> *md, const KBoundaries::SyncedSlabs &slabs, const int bdir,
+                       const KBoundaries::BoundaryConfigs config, const bool check_inflow, const bool inner_only, const bool outer_only)
+{
+    if (slabs.nzones == 0) return;
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    using FC = Metadata::FlagCollection;
+    const auto& q = md->PackVariables(FC({Metadata::FillGhost, Metadata::Cell})
+                                      + FC({Metadata::GetUserFlag("HaloFloat")}));
+    PackIndexMap prims_map;
+    const auto& P = GRMHD::PackMHDPrims(md, prims_map);
+    const VarMap m_p(prims_map, false);
+    const int nvar = q.GetDim(4);
+    if (nvar == 0) return;
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+
+    pmb0->par_for("mesh_boundaries_X" + std::to_string(bdir), 0, slabs.nzones - 1,
+        KOKKOS_LAMBDA (const int& n) {
+            int b, k, j, i;
+            slabs.zone(n, b, k, j, i);
+            const int face = slabs.bounds(slabs.slab(n), 7);
+            const bool inner = (face % 2 == 0);
+            const KBoundaries::BoundaryType type = config[face].type;
+            if ((type != KBoundaries::BoundaryType::outflow && type != KBoundaries::BoundaryType::reflecting) ||
+                (inner_only && !inner) || (outer_only && inner)) return;
+            const bool reflect = (type == KBoundaries::BoundaryType::reflecting);
+            // Mirror across the boundary face, or copy the last physical zone
+            int kk = k, jj = j, ii = i;
+            if (bdir == X1DIR) {
+                ii = (inner) ? (reflect ? 2*bi.is - 1 - i : bi.is) : (reflect ? 2*bi.ie + 1 - i : bi.ie);
+            } else if (bdir == X2DIR) {
+                jj = (inner) ? (reflect ? 2*bi.js - 1 - j : bi.js) : (reflect ? 2*bi.je + 1 - j : bi.je);
+            } else {
+                kk = (inner) ? (reflect ? 2*bi.ks - 1 - k : bi.ks) : (reflect ? 2*bi.ke + 1 - k : bi.ke);
+            }
+            for (int l = 0; l < nvar; l++) {
+                q(b, l, k, j, i) = (reflect && q(b).VectorComponent(l) == bdir) ? -q(b, l, kk, jj, ii)
+                                                                                 : q(b, l, kk, jj, ii);
+            }
+            // Inflow checks depend only on this zone, so they can follow immediately
+            if (check_inflow && config[face].check_inflow) {
+                const auto& G = P.GetCoords(b);
+                KBoundaries::check_inflow(G, P(b), (inner) ? IndexDomain::inner_x1 : IndexDomain::outer_x1,
+                                          m_p.U1, k, j, i);
+            }
+        }
+    );
+}
+
+TaskStatus KBoundaries::ApplyBoundariesMesh(std::shared_ptr<MeshData<Real>> &md, bool coarse)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto& params = pmesh->packages.Get("Boundaries")->AllParams();
+    // Transmitting conditions spanning several blocks need the opposite side of the pole first
+    if (!coarse) ExchangeTransmitting(md.get());
+    if (coarse || !params.Get<bool>("mesh_level"))
+        return parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD(md, coarse);
+    Flag("ApplyBoundariesMesh");
+
+    const BoundaryConfigs &config = params.Get<BoundaryConfigs>("config");
+
+    // As in ApplyBoundary, inflow checks & everything after are only for syncs including the GRMHD variables
+    PackIndexMap dummy_map;
+    const bool full_grmhd_boundary = GRMHD::PackMHDPrims(md.get(), dummy_map).GetDim(4) > 0;
+
+    // Directions must be filled in order, as later ones read the corners filled by earlier ones
+    const auto slabs = GetPhysicalSlabs(md.get());
+    FillPhysicalSlabs(md.get(), slabs.dir[0], X1DIR, config, full_grmhd_boundary, false, false);
+    FillPhysicalSlabs(md.get(), slabs.dir[1], X2DIR, config, false, false, false);
+    // See ApplyBoundary: re-apply X1 after X2 to replace the reflected X1/X2 corners
+    if (full_grmhd_boundary && slabs.dir[1].nzones > 0) {
+        const bool fix_inner = params.Get<bool>("fix_corner_inner");
+        const bool fix_outer = params.Get<bool>("fix_corner_outer");
+        if (fix_inner || fix_outer)
+            FillPhysicalSlabs(md.get(), slabs.dir[0], X1DIR, config, true, fix_inner && !fix_outer, fix_outer && !fix_inner);
+    }
+    FillPhysicalSlabs(md.get(), slabs.dir[2], X3DIR, config, false, false, false);
+
+    if (full_grmhd_boundary) {
+        for (int i_block = 0; i_block < md->NumBlocks(); i_block++) {
+            auto &rc = md->GetBlockData(i_block);
+            for (int i_bnd = 0; i_bnd < 2*pmesh->ndim; i_bnd++) {
+                if (rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::user)
+                    BoundaryLockstep(rc.get(), BoundaryDomain((BoundaryFace) i_bnd), coarse);
+            }
         }
     }
 
     EndFlag();
+    return TaskStatus::complete;
 }
 
 void KBoundaries::CheckInflow(std::shared_ptr<MeshBlockData<Real>> &rc, IndexDomain domain, bool coarse)
@@ -613,7 +980,7 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
     auto pmesh = md->GetMeshPointer();
     auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
 
-    auto& params = pmb0->packages.Get("Boundaries")->AllParams();
+    const BoundaryConfigs &config = GetBoundaryConfigs(pmb0->packages);
 
     // Fluxes are defined at faces, so there is one more valid flux than
     // valid cell in the face direction.  That is, e.g. F1 is valid on
@@ -625,12 +992,37 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
     const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
     const IndexRange3 b1 = KDomain::GetRange(md, IndexDomain::interior, -1, 1);
 
+    // Inflow prevention & flux zeroing touch only the boundary faces, so do them for
+    // every face of every block in one kernel over the precomputed list of faces
+    const auto faces = GetFluxFaces(md);
+    if (faces.nzones > 0) {
+        PackIndexMap cons_map;
+        const auto &F = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::WithFluxes}, cons_map);
+        const int m_rho = cons_map["cons.rho"].first;
+        const int nvar = F.GetDim(4);
+        pmb0->par_for("fix_boundary_flux", 0, faces.nzones - 1,
+            KOKKOS_LAMBDA (const int& n) {
+                int b, k, j, i;
+                faces.zone(n, b, k, j, i);
+                const int face = faces.bounds(faces.slab(n), 7);
+                const int bdir = face / 2 + 1;
+                if (config[face].zero_flux) {
+                    for (int p = 0; p < nvar; p++) F(b).flux(bdir, p, k, j, i) = 0.;
+                } else if (m_rho >= 0) {
+                    // Only inflow-checked faces are listed otherwise
+                    F(b).flux(bdir, m_rho, k, j, i) = (face % 2 == 0) ? m::min(F(b).flux(bdir, m_rho, k, j, i), 0.)
+                                                                      : m::max(F(b).flux(bdir, m_rho, k, j, i), 0.);
+                }
+            }
+        );
+    }
+
     for (auto &pmb : pmesh->block_list) {
         auto &rc = pmb->meshblock_data.Get();
 
         for (int i = 0; i < BOUNDARY_NFACES; i++) {
             BoundaryFace bface = (BoundaryFace)i;
-            auto bname = BoundaryName(bface);
+            const BoundaryConfig &bconf = config[bface];
             const auto bdir = BoundaryDirection(bface);
             const auto binner = BoundaryIsInner(bface);
 
@@ -649,51 +1041,15 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
                 b.ks = b.ke = (binner) ? bf.ks : bf.ke;
             }
 
-            PackIndexMap cons_map;
-            auto &F = rc->PackVariablesAndFluxes({Metadata::WithFluxes}, cons_map);
-
-            // If we should check inflow on this face...
-            if (params.Get<bool>("check_inflow_" + bname)) {
-                const int m_rho = cons_map["cons.rho"].first;
-                // ...and if this face of the block corresponds to a global boundary...
-                if (pmb->boundary_flag[bface] == BoundaryFlag::user) {
-                    if (binner) {
-                        pmb->par_for(
-                            "zero_inflow_flux_" + bname, b.ks, b.ke, b.js, b.je, b.is, b.ie,
-                            KOKKOS_LAMBDA(const int &k, const int &j, const int &i) {
-                                F.flux(bdir, m_rho, k, j, i) = m::min(F.flux(bdir, m_rho, k, j, i), 0.);
-                            }
-                        );
-                    } else {
-                        pmb->par_for(
-                            "zero_inflow_flux_" + bname, b.ks, b.ke, b.js, b.je, b.is, b.ie,
-                            KOKKOS_LAMBDA(const int &k, const int &j, const int &i) {
-                                F.flux(bdir, m_rho, k, j, i) = m::max(F.flux(bdir, m_rho, k, j, i), 0.);
-                            }
-                        );
-                    }
-                }
-            }
-
-            // If we should zero flux through this face...
-            if (params.Get<bool>("zero_flux_" + bname)) {
-                // ...and if this face of the block corresponds to a global boundary...
-                if (pmb->boundary_flag[bface] == BoundaryFlag::user) {
-                    pmb->par_for(
-                        "zero_flux_" + bname, 0, F.GetDim(4) - 1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
-                        KOKKOS_LAMBDA(const int &p, const int &k, const int &j, const int &i) {
-                            F.flux(bdir, p, k, j, i) = 0.;
-                        }
-                    );
-                }
-            }
-
             // If we should replace fluxes with excised versions...
-            if (params.Get<bool>("excise_flux_" + bname)) {
+            if (bconf.excise_flux) {
                 // ...and if this face of the block corresponds to a global boundary...
                 if (pmb->boundary_flag[bface] == BoundaryFlag::user) {
                     if (bdir != 2) throw std::runtime_error("Excised polar fluxes only fully implemented in X2!");
 
+                    PackIndexMap cons_map;
+                    auto &F = rc->PackVariablesAndFluxes({Metadata::WithFluxes}, cons_map);
+
                     // Going to need the primitive vars
                     PackIndexMap prims_map;
                     std::vector<MetadataFlag> prims_flags = {Metadata::GetUserFlag("Primitive"), Metadata::Cell};
@@ -725,7 +1081,7 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
                     // Replace existing X3 fluxes in last row with true half-cell versions
                     const int dir = X3DIR;
                     pmb->par_for(
-                        "excise_flux_" + bname, b.ks, b.ke, j_cell, j_cell, b.is, b.ie,
+                        "excise_flux", b.ks, b.ke, j_cell, j_cell, b.is, b.ie,
                         KOKKOS_LAMBDA(const int &k, const int &j, const int &i) {
                             // Leftover Pl/Pr from X3DIR flux calculation!
                             const int jn = (binner) ? j+1 : j-1;
@@ -768,7 +1124,7 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
                     // Replace fluxes through the pole (would be zero) with fluxes through
                     // the middle of the cell. Should be general, remember this has 1-zone halo!
                     pmb->par_for(
-                        "excise_flux_" + bname, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                        "excise_flux", b.ks, b.ke, b.js, b.je, b.is, b.ie,
                         KOKKOS_LAMBDA(const int &k, const int &j, const int &i) {
                             // Face i,j,k borders cell with same index and 1 left with index:
                             int kk = (bdir == 3) ? k - 1 : k;
@@ -830,7 +1186,7 @@ TaskStatus KBoundaries::FixFlux(MeshData<Real> *md)
                     const int ksp = bi.ks;
                     // Run over X1 *interior* on the X2 face, for half the *interior* X3 range
                     pmb->par_for(
-                        "average_excised_flux_" + bname, 0, F.GetDim(4)-1, bi.ks, bi.ks + Nk3p2 - 1, b.js, b.je, bi.is, bi.ie,
+                        "average_excised_flux", 0, F.GetDim(4)-1, bi.ks, bi.ks + Nk3p2 - 1, b.js, b.je, bi.is, bi.ie,
                         KOKKOS_LAMBDA(const int &v, const int &k, const int &j, const int &i) {
                             const int ki = ((k - ksp + Nk3p2) % Nk3p) + ksp;
                             Real avg = 0.;
@@ -859,13 +1215,13 @@ void KBoundaries::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDoma
 {
     // Note we're ignoring "domain," we just add the "source" where it's needed next to the pole
     auto pmesh = mdudt->GetMeshPointer();
-    auto& params = pmesh->packages.Get<KHARMAPackage>("Boundaries")->AllParams();
+    const KBoundaries::BoundaryConfigs &config = KBoundaries::GetBoundaryConfigs(pmesh->packages);
     for (int i=0; i < mdudt->NumBlocks(); ++i) {
         auto &rc = mdudt->GetBlockData(i);
         auto pmb = rc->GetBlockPointer();
         for (int i = 0; i < BOUNDARY_NFACES; i++) {
             BoundaryFace bface = (BoundaryFace)i;
-            auto bname = KBoundaries::BoundaryName(bface);
+            const KBoundaries::BoundaryConfig &bconf = config[bface];
             const auto bdir = KBoundaries::BoundaryDirection(bface);
             const auto binner = KBoundaries::BoundaryIsInner(bface);
             const auto bdomain = KBoundaries::BoundaryDomain(bface);
@@ -873,7 +1229,7 @@ void KBoundaries::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDoma
             if (bdir > pmesh->ndim) continue;
 
             // If we should replace fluxes with excised versions...
-            if (params.Get<bool>("excise_flux_" + bname)) {
+            if (bconf.excise_flux) {
                 // ...and if this face of the block corresponds to a global boundary...
                 if (pmb->boundary_flag[bface] == BoundaryFlag::user) {
                     if (bdir != 2) throw std::runtime_error("Excised polar fluxes only fully implemented in X2!");
@@ -896,7 +1252,7 @@ void KBoundaries::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDoma
                     const Loci loc = (binner) ? Loci::outer_half : Loci::inner_half;
 
                     pmb->par_for(
-                        "normalize_excised_flux_" + bname, 0, dUdt.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                        "normalize_excised_flux", 0, dUdt.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
                         KOKKOS_LAMBDA(const int &v, const int &k, const int &j, const int &i) {
                             // Factor of 2 because cell is half-size in fluxdiv
                             // gdet factors move conserved vars at outer cell to the center
@@ -49,6 +49,40 @@
  */
 namespace KBoundaries {
 
+/**
+ * Kind of condition applied at a boundary face, from <boundaries> inner_x1 etc.
+ */
+enum class BoundaryType{periodic=0, outflow, reflecting, dirichlet, transmitting, bondi};
+
+/**
+ * Every option governing one boundary face, resolved from the input once in Initialize,
+ * so the step loop needs no string lookups.  Plain data: BoundaryConfigs can be captured by value in kernels.
+ * The equivalent per-face Params (e.g. "check_inflow_inner_x1") are kept for anything reading them at startup.
+ */
+struct BoundaryConfig {
+    BoundaryType type = BoundaryType::periodic;
+    bool check_inflow = false;
+    bool zero_flux = false;
+    bool excise_flux = false;
+    bool outflow_EMHD = false;
+    bool cancel_U3 = false;
+    bool cancel_T3 = false;
+    // These are only set with B_CT
+    bool reflect_face_vector = false;
+    bool clean_face_B = false;
+    bool reconnect_B3 = false;
+    bool average_EMF = false;
+    bool zero_EMF = false;
+};
+struct BoundaryConfigs {
+    BoundaryConfig face[BOUNDARY_NFACES];
+    KOKKOS_INLINE_FUNCTION const BoundaryConfig& operator[](const int& i) const { return face[i]; }
+};
+inline const BoundaryConfigs& GetBoundaryConfigs(Packages_t& packages)
+{
+    return packages.Get("Boundaries")->Param<BoundaryConfigs>("config");
+}
+
 /**
  * Choose which boundary conditions will be used based on inputs,
  * declare any fields needed to store e.g. constant boundary conditions
@@ -87,8 +121,105 @@ TaskStatus FixFlux(MeshData<Real> *rc);
  */
 void AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain);
 
+/**
+ * The ghost zones of every block in a MeshData object which are filled by communication
+ * (i.e., on block or periodic boundaries), as a list of slabs, so they can be covered by a single kernel.
+ * Slab s has bounds(s, :) = {b, ks, ke, js, je, is, ie}, and its zones are numbered from offsets(s)
+ * when counting over all slabs in order.  Kept in the package params to avoid reallocation.
+ */
+struct SyncedSlabs {
+    ParArray2D<int> bounds;
+    ParArray1D<int> offsets;
+    int nslabs = 0;
+    int nzones = 0;
+    // Blocks & grid the list was built for, so it is only rebuilt after regridding
+    std::vector<LogicalLocation> locs;
+    bool coarse = false;
+
+    /**
+     * Find the slab containing zone n of the flat list over all slabs
+     */
+    KOKKOS_INLINE_FUNCTION int slab(const int& n) const
+    {
+        // Binary search for the last slab starting at or before n
+        int lo = 0, hi = nslabs - 1;
+        while (lo < hi) {
+            const int mid = (lo + hi + 1) / 2;
+            if (offsets(mid) <= n) lo = mid; else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    /**
+     * Find the block & indices of zone n of the flat list over all slabs
+     */
+    KOKKOS_INLINE_FUNCTION void zone(const int& n, int& b, int& k, int& j, int& i) const
+    {
+        const int lo = slab(n);
+        const int m  = n - offsets(lo);
+        const int ni = bounds(lo, 6) - bounds(lo, 5) + 1;
+        const int nj = bounds(lo, 4) - bounds(lo, 3) + 1;
+        b = bounds(lo, 0);
+        i = bounds(lo, 5) + m % ni;
+        j = bounds(lo, 3) + (m / ni) % nj;
+        k = bounds(lo, 1) + m / (ni * nj);
+    }
+};
+
+/**
+ * Fill & return the list of communicated ghost zone slabs in md, see SyncedSlabs.
+ * The list is cached per partition, and only rebuilt if the partition's blocks change.
+ */
+SyncedSlabs GetSyncedSlabs(MeshData<Real> *md, bool coarse=false);
+
+/**
+ * Physical boundary ghost zones of every block in a MeshData object, as one list of slabs per direction.
+ * Each list is laid out as in SyncedSlabs, except that bounds(s, 7) holds the BoundaryFace of slab s.
+ * Cached per partition like SyncedSlabs, and rebuilt only after regridding.
+ */
+struct PhysicalSlabs {
+    SyncedSlabs dir[3];
+    std::vector<LogicalLocation> locs;
+};
+PhysicalSlabs GetPhysicalSlabs(MeshData<Real> *md);
+
+/**
+ * First X1 index of a block outside the excised region r < <boundaries> excise_r, i.e. zones with i below this
+ * are excised.  0 when excision is disabled, and past the end of the block if the whole block is excised.
+ */
+int ExcisedStart(MeshBlockData<Real> *rc);
+/**
+ * ExcisedStart of each block in md for mesh-level kernels, cached per partition like the ranges above
+ */
+struct ExcisedStarts {
+    ParArray1D<int> starts;
+    std::vector<LogicalLocation> locs;
+};
+ParArray1D<int> GetExcisedStarts(MeshData<Real> *md);
+
+/**
+ * Boundary faces of every block in md which need inflow prevention or flux zeroing in FixFlux,
+ * laid out as in PhysicalSlabs: one slab of faces (with a 1-zone halo) per block & BoundaryFace.
+ * Cached per partition, and rebuilt only after regridding.
+ */
+SyncedSlabs GetFluxFaces(MeshData<Real> *md);
+
+/**
+ * Mesh-level replacement for parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, for <boundaries> mesh_level.
+ * The outflow & reflecting conditions (and inflow checks) of all blocks are applied with one kernel per direction,
+ * X1 first as in ApplyBoundary, then the per-block package UtoP/PtoU over each physical ghost zone slab.
+ * Falls back to the per-block, per-face version for coarse buffers or when disabled.
+ */
+TaskStatus ApplyBoundariesMesh(std::shared_ptr<MeshData<Real>> &md, bool coarse);
+
 // INTERNAL FUNCTIONS
 
+/**
+ * Bring the conserved & primitive variables in a just-filled domain boundary into lockstep,
+ * by PtoU on whichever variables had boundaries applied to their primitive forms & UtoP on the rest.
+ */
+void BoundaryLockstep(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse);
+
 /**
  * Check for inflowing material on an outflow boundary, and
  * reset the velocity of such material so it is no longer inflowing.
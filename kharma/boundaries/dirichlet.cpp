@@ -47,15 +47,21 @@ void KBoundaries::DirichletImpl(MeshBlockData<Real> *rc, BoundaryFace bface, boo
     using FC = Metadata::FlagCollection;
     FC ghost_vars = FC({Metadata::FillGhost, Metadata::Conserved})
                   + FC({Metadata::FillGhost, Metadata::GetUserFlag("Primitive")})
+                  + FC({Metadata::GetUserFlag("HaloFloat")})
                   - FC({Metadata::GetUserFlag("StartupOnly")});
+    // Build the cache names once, rather than on every call
+    static const std::vector<std::string> names = {"Boundaries.inner_x1", "Boundaries.outer_x1", "Boundaries.inner_x2",
+                                                   "Boundaries.outer_x2", "Boundaries.inner_x3", "Boundaries.outer_x3"};
+    static const std::vector<std::string> names_f = {"Boundaries.f.inner_x1", "Boundaries.f.outer_x1", "Boundaries.f.inner_x2",
+                                                     "Boundaries.f.outer_x2", "Boundaries.f.inner_x3", "Boundaries.f.outer_x3"};
     auto q = rc->PackVariables(ghost_vars, coarse);
-    auto bound = rc->PackVariables(std::vector<std::string>{"Boundaries." + BoundaryName(bface)});
+    auto bound = rc->PackVariables(std::vector<std::string>{names[bface]});
     DirichletSetFromField(rc, q, bound, bface, coarse, set, false);
 
     FC ghost_vars_f = FC({Metadata::FillGhost, Metadata::Face})
                   - FC({Metadata::GetUserFlag("StartupOnly")});
     auto q_f = rc->PackVariables(ghost_vars_f, coarse);
-    auto bound_f = rc->PackVariables(std::vector<std::string>{"Boundaries.f." + BoundaryName(bface)});
+    auto bound_f = rc->PackVariables(std::vector<std::string>{names_f[bface]});
     DirichletSetFromField(rc, q_f, bound_f, bface, coarse, set, true);
 }
 
@@ -65,6 +71,30 @@ void KBoundaries::DirichletSetFromField(MeshBlockData<Real> *rc, VariablePack<Re
     // We're sometimes called without any variables to sync (e.g. syncing flags, EMFs), just return
     if (q.GetDim(4) == 0) return;
 
+    auto pmb = rc->GetBlockPointer();
+    const auto domain = BoundaryDomain(bface);
+
+    // Fast path: the cache holds exactly the cell-centered variables of this pack, in the same order
+    // and over the same slab, so the boundary is a straight copy with no remapping or checks.
+    // This is the usual case when applying boundaries every substep, e.g. in multizone runs
+    if (!do_face && q.GetDim(4) == bound.GetDim(4)) {
+        const IndexRange3 b = KDomain::GetBoundaryRange(rc, domain, CC, coarse);
+        if (set) {
+            pmb->par_for("dirichlet_boundary_set", 0, q.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
+                    bound(v, k - b.ks, j - b.js, i - b.is) = q(v, k, j, i);
+                }
+            );
+        } else {
+            pmb->par_for("dirichlet_boundary", 0, q.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
+                    q(v, k, j, i) = bound(v, k - b.ks, j - b.js, i - b.is);
+                }
+            );
+        }
+        return;
+    }
+
     // Determine elements to run over
     std::vector<TopologicalElement> el_list;
     if (do_face) {
@@ -79,19 +109,13 @@ void KBoundaries::DirichletSetFromField(MeshBlockData<Real> *rc, VariablePack<Re
         std::cerr << "Dirichlet boundary mismatch! Boundary cache: " << bound.GetDim(4) << " for pack: " << el_tot * q.GetDim(4) << std::endl;
     }
 
-    // Indices
-    auto pmb = rc->GetBlockPointer();
-    const bool binner = BoundaryIsInner(bface);
-    const int dir = BoundaryDirection(bface);
-    const auto domain = BoundaryDomain(bface);
-    const auto bname = BoundaryName(bface);
     for (auto el : el_list) {
         // This is the domain of the boundary/ghost zones
         IndexRange3 b = KDomain::GetBoundaryRange(rc, domain, el, coarse);
 
         // Flatten TopologicalElements when reading/writing to boundaries cache
         pmb->par_for(
-            "dirichlet_boundary_" + bname, 0, q.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            "dirichlet_boundary_general", 0, q.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
             KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
                 if (set) {
                     bound(el_tot*v + (static_cast<int>(el) % el_tot), k - b.ks, j - b.js, i - b.is) = q(el, v, k, j, i);
@@ -34,6 +34,7 @@
 
 #include "one_block_transmit.hpp"
 
+#include "boundaries.hpp"
 #include "domain.hpp"
 #include "types.hpp"
 
@@ -41,11 +42,51 @@
 
 using namespace parthenon;
 
+namespace {
+
+/**
+ * Fill 'slab' with the values the block *opposite* 'rc' in X3 needs in its ghost zones on 'bface'.
+ * Every block spans the same local X3 indices as its partner (the rotation by pi is a whole number of blocks),
+ * so only j is mirrored, exactly as in the one-block case.  The slab uses the layout of the Dirichlet caches.
+ */
+void FillTransmitSlab(MeshBlockData<Real> *rc, VariablePack<Real> &q, VariablePack<Real> &slab,
+                      BoundaryFace bface, bool do_face)
+{
+    if (q.GetDim(4) == 0) return;
+    auto pmb = rc->GetBlockPointer();
+    const bool binner = KBoundaries::BoundaryIsInner(bface);
+    const auto domain = KBoundaries::BoundaryDomain(bface);
+
+    std::vector<TopologicalElement> el_list;
+    if (do_face) {
+        el_list = {F1, F2, F3};
+    } else {
+        el_list = {CC};
+    }
+    const int el_tot = el_list.size();
+    for (TopologicalElement &el : el_list) {
+        const IndexRange3 b = KDomain::GetBoundaryRange(rc, domain, el, false);
+        const bool corresponding_face = (el == FaceOf(X2DIR));
+        const int reflect_offset = corresponding_face ? 0 : (binner ? 1 : -1);
+        const int jpivot = (binner) ? b.je : b.js;
+        pmb->par_for(
+            "transmitting_polar_slab", 0, q.GetDim(4)-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &v, const int &k, const int &j, const int &i) {
+                const int ji = jpivot + reflect_offset + (jpivot - j);
+                slab(el_tot*v + (static_cast<int>(el) % el_tot), k - b.ks, j - b.js, i - b.is) = q(el, v, k, ji, i);
+            }
+        );
+    }
+}
+
+} // namespace
+
 void KBoundaries::TransmitImpl(MeshBlockData<Real> *rc, BoundaryFace bface, bool coarse)
 {
     // Get all cell-centered ghosts, minus anything just used at startup
     using FC = Metadata::FlagCollection;
     FC ghost_vars = FC({Metadata::FillGhost, Metadata::Cell})
+                  + FC({Metadata::GetUserFlag("HaloFloat")})
                   - FC({Metadata::GetUserFlag("StartupOnly")});
     PackIndexMap bounds_map;
     auto q = rc->PackVariables(ghost_vars, bounds_map, coarse);
@@ -77,12 +118,26 @@ void KBoundaries::TransmitSetTE(MeshBlockData<Real> *rc, VariablePack<Real> &q,
     if (bdir != 2)
         throw std::runtime_error("Transmitting polar conditions only defined for X2!");
 
+    // With several blocks in X3, the opposite side of the pole is another block's data,
+    // which ExchangeTransmitting has left in this block's slab cache
+    const auto &params = pmb->packages.Get("Boundaries")->AllParams();
+    const bool multiblock = params.Get<bool>("transmit_multiblock");
+    VariablePack<Real> slab;
+    if (multiblock) {
+        // Before the first exchange (i.e., when Parthenon applies boundaries at initialization)
+        // there is nothing to transmit.  The first step fills these zones
+        if (!params.Get<bool>("transmit_ready")) return;
+        // The caches are not part of "sync" subsets, so take them from the base container
+        slab = pmb->meshblock_data.Get()->PackVariables(std::vector<std::string>{KBoundaries::TransmitSlabName(bface, do_face)});
+    }
+
     std::vector<TopologicalElement> el_list;
     if (do_face) {
         el_list = {F1, F2, F3};
     } else {
         el_list = {CC};
     }
+    const int el_tot = el_list.size();
     for (TopologicalElement &el : el_list) {
         // This automatically includes zones on domain faces, which we set to 0 below
         const IndexRange3 b = KDomain::GetBoundaryRange(rc, domain, el, coarse);
@@ -138,8 +193,130 @@ void KBoundaries::TransmitSetTE(MeshBlockData<Real> *rc, VariablePack<Real> &q,
                                     q(el, v).vector_component == X3DIR) ? -1. : 1.;
                 // if (i == 10 && j == 3 && k == 10)
                 //    printf("Set el %d v %d zone %d %d %d from %d %d %d invert: %f\n", (int) el, v, k, j, i, ki, ji, ii, invert);
-                q(el, v, k, j, i) = (corresponding_face && j == jpivot) ? 0. : invert * q(el, v, ki, ji, ii);
+                const Real opposite = (multiblock) ? slab(el_tot*v + (static_cast<int>(el) % el_tot), k - b.ks, j - b.js, i - b.is)
+                                                   : q(el, v, ki, ji, ii);
+                q(el, v, k, j, i) = (corresponding_face && j == jpivot) ? 0. : invert * opposite;
             }
         );
     }
 }
+
+void KBoundaries::ExchangeTransmitting(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto &params = pmesh->packages.Get("Boundaries")->AllParams();
+    if (!params.Get<bool>("transmit_multiblock")) return;
+    Flag("ExchangeTransmitting");
+
+    // Partners are looked up among this MeshData's blocks, and every rank must take part in the exchange
+    if (md->NumBlocks() != pmesh->GetNumMeshBlocksThisRank())
+        throw std::runtime_error("Transmitting polar conditions with several blocks in X3 require a single mesh partition!");
+
+    const BoundaryConfigs &config = params.Get<BoundaryConfigs>("config");
+    const int nb3 = params.Get<int>("transmit_nb3");
+
+    // Index this rank's blocks by gid
+    std::map<int, int> local_blocks;
+    for (int b = 0; b < md->NumBlocks(); b++)
+        local_blocks[md->GetBlockData(b)->GetBlockPointer()->gid] = b;
+
+    using FC = Metadata::FlagCollection;
+    const FC ghost_vars = FC({Metadata::FillGhost, Metadata::Cell})
+                        + FC({Metadata::GetUserFlag("HaloFloat")})
+                        - FC({Metadata::GetUserFlag("StartupOnly")});
+    const FC ghost_vars_f = FC({Metadata::FillGhost, Metadata::Face})
+                          - FC({Metadata::GetUserFlag("StartupOnly")});
+
+#ifdef MPI_PARALLEL
+    // Our own communicator, so tags can't collide with anything else in flight
+    static MPI_Comm comm = MPI_COMM_NULL;
+    if (comm == MPI_COMM_NULL) PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &comm));
+    struct Message {
+        Real *buf; int size; int rank; int tag;
+        bool operator==(const Message &o) const { return buf == o.buf && size == o.size && rank == o.rank && tag == o.tag; }
+    };
+    std::vector<Message> sends, recvs;
+#endif
+
+    for (const BoundaryFace bface : {BoundaryFace::inner_x2, BoundaryFace::outer_x2}) {
+        if (config[bface].type != BoundaryType::transmitting) continue;
+        for (int b = 0; b < md->NumBlocks(); b++) {
+            auto rc = md->GetBlockData(b).get();
+            auto pmb = rc->GetBlockPointer();
+            if (pmb->boundary_flag[bface] != BoundaryFlag::user) continue;
+
+            // The partner sits at the same X1 & X2 position, half way around in X3
+            const auto &loc = pmb->loc;
+            const int lx3_partner = (loc.lx3() + nb3/2) % nb3;
+            int gid_partner = -1;
+            for (int n = 0; n < pmesh->nbtotal; n++) {
+                const auto &ploc = pmesh->loclist[n];
+                if (ploc.level() == loc.level() && ploc.lx1() == loc.lx1() &&
+                    ploc.lx2() == loc.lx2() && ploc.lx3() == lx3_partner) {
+                    gid_partner = n;
+                    break;
+                }
+            }
+            if (gid_partner < 0)
+                throw std::runtime_error("Could not find the opposite block for transmitting polar conditions!");
+
+            for (const bool do_face : {false, true}) {
+                const auto &vars = (do_face) ? ghost_vars_f : ghost_vars;
+                if (local_blocks.count(gid_partner)) {
+                    // Fill our slab straight from the partner's interior
+                    auto rc_partner = md->GetBlockData(local_blocks[gid_partner]).get();
+                    auto q_partner = rc_partner->PackVariables(vars);
+                    auto slab = pmb->meshblock_data.Get()->PackVariables(std::vector<std::string>{KBoundaries::TransmitSlabName(bface, do_face)});
+                    FillTransmitSlab(rc_partner, q_partner, slab, bface, do_face);
+                } else {
+#ifdef MPI_PARALLEL
+                    // Fill the slab our partner needs from our interior, and send it in exchange for our own.
+                    // Tags identify the receiving block, face, and element type
+                    auto q = rc->PackVariables(vars);
+                    if (q.GetDim(4) == 0) continue;
+                    auto base = pmb->meshblock_data.Get();
+                    auto slab_send = base->PackVariables(std::vector<std::string>{KBoundaries::TransmitSlabName(bface, do_face, true)});
+                    FillTransmitSlab(rc, q, slab_send, bface, do_face);
+                    auto &send = base->Get(KBoundaries::TransmitSlabName(bface, do_face, true)).data;
+                    auto &recv = base->Get(KBoundaries::TransmitSlabName(bface, do_face)).data;
+                    const int tag_face = 2*(bface == BoundaryFace::outer_x2) + do_face;
+                    sends.push_back({send.data(), static_cast<int>(send.GetSize()), pmesh->ranklist[gid_partner],
+                                     4*(gid_partner % 8192) + tag_face});
+                    recvs.push_back({recv.data(), static_cast<int>(recv.GetSize()), pmesh->ranklist[gid_partner],
+                                     4*(pmb->gid % 8192) + tag_face});
+#else
+                    throw std::runtime_error("Opposite block for transmitting polar conditions is not on this rank!");
+#endif
+                }
+            }
+        }
+    }
+
+#ifdef MPI_PARALLEL
+    // The same messages recur on every call until blocks move between ranks, so they are set up
+    // once as persistent requests, and only started & waited on here
+    static std::vector<Message> last_sends, last_recvs;
+    static std::vector<MPI_Request> requests;
+    if (!(sends == last_sends && recvs == last_recvs)) {
+        for (auto &request : requests) PARTHENON_MPI_CHECK(MPI_Request_free(&request));
+        requests.resize(sends.size() + recvs.size());
+        for (int n = 0; n < recvs.size(); n++)
+            PARTHENON_MPI_CHECK(MPI_Recv_init(recvs[n].buf, recvs[n].size, MPI_PARTHENON_REAL, recvs[n].rank,
+                                              recvs[n].tag, comm, &requests[n]));
+        for (int n = 0; n < sends.size(); n++)
+            PARTHENON_MPI_CHECK(MPI_Send_init(sends[n].buf, sends[n].size, MPI_PARTHENON_REAL, sends[n].rank,
+                                              sends[n].tag, comm, &requests[recvs.size() + n]));
+        last_sends = sends;
+        last_recvs = recvs;
+    }
+    if (requests.size() > 0) {
+        // Device buffers are handed straight to MPI, so they must be filled first
+        Kokkos::fence();
+        PARTHENON_MPI_CHECK(MPI_Startall(requests.size(), requests.data()));
+        PARTHENON_MPI_CHECK(MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+    }
+#endif
+
+    *(params.GetMutable<bool>("transmit_ready")) = true;
+    EndFlag();
+}
@@ -42,6 +42,25 @@ void TransmitImpl(MeshBlockData<Real> *rc, BoundaryFace bface, bool coarse);
 void TransmitSetTE(MeshBlockData<Real> *rc, VariablePack<Real> &q, BoundaryFace bface,
                     PackIndexMap &bounds_map, bool coarse, bool do_face);
 
+/**
+ * Name of the slab cache for multi-block transmitting conditions on a face,
+ * either received from the opposite block or (if 'send') being sent to it
+ */
+inline std::string TransmitSlabName(BoundaryFace bface, bool do_face, bool send=false)
+{
+    return std::string(send ? "Boundaries.transmit_send." : "Boundaries.transmit.") + (do_face ? "f." : "") + BoundaryName(bface);
+}
+
+/**
+ * With several blocks in X3, the polar ghost zones of each block are filled from the block opposite it
+ * in X3, i.e. at the same X1/X2 location but rotated by pi in phi.  This function fills the per-face
+ * slab caches "Boundaries.transmit.*" on every block with the mirrored data from that partner block,
+ * copying directly when the partner is on this rank and exchanging one slab per block pair over MPI otherwise.
+ * It must be called on the whole mesh (a single partition) before the boundary functions are applied,
+ * which then read the cache rather than this block's interior.
+ */
+void ExchangeTransmitting(MeshData<Real> *md);
+
 template <BoundaryFace bface>
 inline void OneBlockTransmit(std::shared_ptr<MeshBlockData<Real>> &rc, bool coarse)
 {
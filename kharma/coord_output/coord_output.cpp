@@ -86,11 +86,12 @@ std::shared_ptr<KHARMAPackage> CoordinateOutput::Initialize(ParameterInput *pin,
     //pkg->AddField("coords.lapse_embed", m0);
     //pkg->AddField("coords.conn_embed", m3);
 
+    // Blocks with current geometry, by gid
+    params.Add("filled_blocks", std::map<int, FilledBlock>(), true);
+
     // Register our output.  This will be called before *any* output,
-    // but we will only fill the fields before the first.
-    // This is all that's needed unless:
-    // 1. Someone wants geometry in an AMR sim with remeshing
-    // 2. Parthenon decides to include a way to delete fields, which we would want to do here
+    // but we will only fill each block's fields once, or again after it is remeshed
+    // TODO if Parthenon includes a way to delete fields, we could do so after the first output
     pkg->BlockUserWorkBeforeOutput = CoordinateOutput::BlockUserWorkBeforeOutput;
 
     return pkg;
@@ -98,9 +99,12 @@ std::shared_ptr<KHARMAPackage> CoordinateOutput::Initialize(ParameterInput *pin,
 
 TaskStatus CoordinateOutput::BlockUserWorkBeforeOutput(MeshBlock *pmb, ParameterInput *pin)
 {
-    auto& globals = pmb->packages.Get("Globals")->AllParams();
-    if (!globals.Get<bool>("in_loop")) {
-        auto rc = pmb->meshblock_data.Get();
+    auto rc = pmb->meshblock_data.Get();
+    auto *filled = pmb->packages.Get("CoordinateOutput")->AllParams().GetMutable<std::map<int, FilledBlock>>("filled_blocks");
+    const Real *data = rc->Get("coords.gdet").data.data();
+    const bool current = filled->count(pmb->gid) && (*filled)[pmb->gid].loc == pmb->loc && (*filled)[pmb->gid].data == data;
+    if (!current) {
+        (*filled)[pmb->gid] = FilledBlock{pmb->loc, data};
 
         PackIndexMap geom_map;
         auto Geom = rc->PackVariables({Metadata::GetUserFlag("CoordinateOutput")}, geom_map);
@@ -37,15 +37,30 @@
 
 #include <parthenon/parthenon.hpp>
 
+#include <map>
+
 namespace CoordinateOutput {
 
+/**
+ * Record of the geometry filled into a block: its location, and the array we filled.
+ * Geometry never changes on a block, so it only needs refilling if the block is new or has
+ * moved (after a regrid or load balancing), which also means new arrays.
+ */
+struct FilledBlock {
+    LogicalLocation loc;
+    const Real *data;
+};
+
 /**
  * Initialize the wind package with several options from the input deck
  */
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
 /**
- * Fill the geometry output variables with quantities from the GRCoordinates object over a block
+ * Fill the geometry output variables with quantities from the GRCoordinates object over a block,
+ * if they haven't already been filled since the block was created.
+ * To avoid writing the geometry to every dump, list the coords.* fields in a separate output block
+ * with a long dt, which then acts as a grid file for all the dumps.
  */
 TaskStatus BlockUserWorkBeforeOutput(MeshBlock *pmb, ParameterInput *pin);
 
@@ -46,9 +46,17 @@
 // Because who needs those?
 // TODO(BSP) try to switch to std:: unless using SYCL
 #include <mpark/variant.hpp>
+
 //#include <variant>
 //namespace mpark = std;
 
+// Optionally, a single base system & transform known at compile time, see visit_base below
+#ifndef FIXED_COORDINATES
+#define FIXED_COORDINATES 0
+#endif
+#define KHARMA_STRINGIFY_(x) #x
+#define KHARMA_STRINGIFY(x) KHARMA_STRINGIFY_(x)
+
 /**
  * Coordinates in HARM are logically Cartesian -- that is, in some coordinate system, here dubbed "native"
  * coordinates, each cell is a rectangular prism of exactly the same shape as all the others.
@@ -82,6 +90,28 @@ class CoordinateEmbedding {
         SomeBaseCoords base;
         SomeTransform transform;
 
+        // Call a function on the base system or transform object.
+        // Builds with a fixed coordinate system (KHARMA_FIXED_COORDINATES in CMake) skip the
+        // variant dispatch, so geometry evaluated on device inlines straight through
+        template<typename Function>
+        KOKKOS_FORCEINLINE_FUNCTION decltype(auto) visit_base(const Function& f) const
+        {
+#if FIXED_COORDINATES
+            return f(*mpark::get_if<FIXED_BASE_COORDS>(&base));
+#else
+            return mpark::visit(f, base);
+#endif
+        }
+        template<typename Function>
+        KOKKOS_FORCEINLINE_FUNCTION decltype(auto) visit_transform(const Function& f) const
+        {
+#if FIXED_COORDINATES
+            return f(*mpark::get_if<FIXED_TRANSFORM>(&transform));
+#else
+            return mpark::visit(f, transform);
+#endif
+        }
+
         // Common code for constructors
 #pragma hd_warning_disable
         KOKKOS_FUNCTION void EmplaceSystems(const SomeBaseCoords& base_in, const SomeTransform& transform_in) {
@@ -199,6 +229,11 @@ class CoordinateEmbedding {
             } else {
                 throw std::invalid_argument("Unsupported coordinate transform!");
             }
+#if FIXED_COORDINATES
+            if (!mpark::holds_alternative<FIXED_BASE_COORDS>(base) || !mpark::holds_alternative<FIXED_TRANSFORM>(transform))
+                throw std::invalid_argument("This KHARMA was compiled for " KHARMA_STRINGIFY(FIXED_BASE_COORDS) " + "
+                                            KHARMA_STRINGIFY(FIXED_TRANSFORM) " coordinates only!");
+#endif
         }
 #pragma hd_warning_disable
         KOKKOS_FUNCTION CoordinateEmbedding(SomeBaseCoords& base_in, SomeTransform& transform_in): base(base_in), transform(transform_in) {}
@@ -219,15 +254,15 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION std::string variant_names() const
         {
             std::string basename(
-                mpark::visit( [&](const auto& self) {
+                visit_base( [&](const auto& self) {
                     return self.name;
-                }, base)
+                })
             );
 
             std::string transformname(
-                mpark::visit( [&](const auto& self) {
+                visit_transform( [&](const auto& self) {
                     return self.name;
-                }, transform)
+                })
             );
 
             return basename + " " + transformname;
@@ -236,9 +271,9 @@ class CoordinateEmbedding {
         // Properties (host or device)
         KOKKOS_INLINE_FUNCTION bool is_spherical() const
         {
-            return mpark::visit( [&](const auto& self) {
+            return visit_base( [&](const auto& self) {
                 return self.spherical;
-            }, base);
+            });
         }
         KOKKOS_INLINE_FUNCTION bool is_transformed() const
         {
@@ -258,21 +293,21 @@ class CoordinateEmbedding {
         }
         KOKKOS_INLINE_FUNCTION GReal get_a() const
         {
-            return mpark::visit( [&](const auto& self) {
+            return visit_base( [&](const auto& self) {
                 return self.a;
-            }, base);
+            });
         }
         GReal startx(int dir) const
         {
-            return mpark::visit( [&](const auto& self) {
+            return visit_transform( [&](const auto& self) {
                 return self.startx[dir - 1];
-            }, transform);
+            });
         }
         GReal stopx(int dir) const
         {
-            return mpark::visit( [&](const auto& self) {
+            return visit_transform( [&](const auto& self) {
                 return self.stopx[dir - 1];
-            }, transform);
+            });
         }
 
         KOKKOS_INLINE_FUNCTION bool is_ks() const
@@ -287,9 +322,9 @@ class CoordinateEmbedding {
         // Note this is the one thing we need from BaseCoords
         KOKKOS_INLINE_FUNCTION void gcov_embed(const GReal Xembed[GR_DIM], Real gcov[GR_DIM][GR_DIM]) const
         {
-            mpark::visit( [&Xembed, &gcov](const auto& self) {
+            visit_base( [&Xembed, &gcov](const auto& self) {
                 self.gcov_embed(Xembed, gcov);
-            }, base);
+            });
         }
         // All the quantities we can derive from that
         KOKKOS_INLINE_FUNCTION Real gcon_from_gcov(const Real gcov[GR_DIM][GR_DIM], Real gcon[GR_DIM][GR_DIM]) const
@@ -308,31 +343,57 @@ class CoordinateEmbedding {
             GReal gcon[GR_DIM][GR_DIM];
             return gcon_embed(Xembed, gcon);
         }
+        // Derivatives of the embedding metric, dgcov[mu][nu][lam] = d_lam gcov[mu][nu].
+        // Analytic where the base system provides them, otherwise by finite differences
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], const GReal delta, Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            visit_base( [&Xembed, &delta, &dgcov](const auto& self) {
+                if constexpr (std::decay_t<decltype(self)>::analytic_derivs) {
+                    self.dgcov_embed(Xembed, dgcov);
+                } else {
+                    GReal Xh[GR_DIM], Xl[GR_DIM];
+                    Real gh[GR_DIM][GR_DIM], gl[GR_DIM][GR_DIM];
+                    for (int lam = 0; lam < GR_DIM; lam++) {
+                        DLOOP1 Xl[mu] = Xembed[mu] - delta*(mu == lam);
+                        DLOOP1 Xh[mu] = Xembed[mu] + delta*(mu == lam);
+                        self.gcov_embed(Xh, gh);
+                        self.gcov_embed(Xl, gl);
+                        DLOOP2 dgcov[mu][nu][lam] = (gh[mu][nu] - gl[mu][nu]) / (Xh[lam] - Xl[lam]);
+                    }
+                }
+            });
+        }
 
         // Now, everything we take from CoordinateTransform
         KOKKOS_INLINE_FUNCTION void coord_to_embed(const GReal Xnative[GR_DIM], GReal Xembed[GR_DIM]) const
         {
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
         }
         KOKKOS_INLINE_FUNCTION void coord_to_native(const GReal Xembed[GR_DIM], GReal Xnative[GR_DIM]) const
         {
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_native(Xembed, Xnative);
-            }, transform);
+            });
         }
         KOKKOS_INLINE_FUNCTION void dxdX(const GReal Xnative[GR_DIM], Real dxdX[GR_DIM][GR_DIM]) const
         {
-            mpark::visit( [&Xnative, &dxdX](const auto& self) {
+            visit_transform( [&Xnative, &dxdX](const auto& self) {
                 self.dxdX(Xnative, dxdX);
-            }, transform);
+            });
         }
         KOKKOS_INLINE_FUNCTION void dXdx(const GReal Xnative[GR_DIM], Real dXdx[GR_DIM][GR_DIM]) const
         {
-            mpark::visit( [&Xnative, &dXdx](const auto& self) {
+            visit_transform( [&Xnative, &dXdx](const auto& self) {
                 self.dXdx(Xnative, dXdx);
-            }, transform);
+            });
+        }
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            visit_transform( [&Xnative, &d2xdX2](const auto& self) {
+                self.d2xdX2(Xnative, d2xdX2);
+            });
         }
 
         // Coordinate convenience functions:
@@ -342,18 +403,18 @@ class CoordinateEmbedding {
         {
             const GReal Xembed[GR_DIM] = {0., r, 0., 0.};
             GReal Xnative[GR_DIM];
-            mpark::visit( [&Xembed, &Xnative](const auto& self) {
+            visit_transform( [&Xembed, &Xnative](const auto& self) {
                 self.coord_to_native(Xembed, Xnative);
-            }, transform);
+            });
             return Xnative[1];
         }
         KOKKOS_INLINE_FUNCTION GReal X1_to_embed(const GReal X1) const
         {
             const GReal Xnative[GR_DIM] = {0., X1, 0., 0.};
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             return Xembed[1];
         }
 
@@ -362,9 +423,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal r_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (is_spherical()) {
                 return Xembed[1];
             } else {
@@ -374,9 +435,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal th_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (is_spherical()) {
                 return Xembed[2];
             } else {
@@ -386,9 +447,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal phi_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (is_spherical()) {
                 return Xembed[3];
             } else {
@@ -398,9 +459,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal x_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (!is_spherical()) {
                 return Xembed[1];
             } else {
@@ -410,9 +471,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal y_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (!is_spherical()) {
                 return Xembed[2];
             } else {
@@ -422,9 +483,9 @@ class CoordinateEmbedding {
         KOKKOS_INLINE_FUNCTION GReal z_of(const GReal Xnative[GR_DIM]) const
         {
             GReal Xembed[GR_DIM];
-            mpark::visit( [&Xnative, &Xembed](const auto& self) {
+            visit_transform( [&Xnative, &Xembed](const auto& self) {
                 self.coord_to_embed(Xnative, Xembed);
-            }, transform);
+            });
             if (!is_spherical()) {
                 return Xembed[3];
             } else {
@@ -524,8 +585,6 @@ class CoordinateEmbedding {
 
         KOKKOS_INLINE_FUNCTION void conn_native(const GReal X[GR_DIM], const GReal delta, Real conn[GR_DIM][GR_DIM][GR_DIM]) const
         {
-            GReal tmp[GR_DIM][GR_DIM][GR_DIM];
-            GReal gcon[GR_DIM][GR_DIM];
             GReal Xh[GR_DIM], Xl[GR_DIM];
             GReal gh[GR_DIM][GR_DIM];
             GReal gl[GR_DIM][GR_DIM];
@@ -544,6 +603,64 @@ class CoordinateEmbedding {
                 }
             }
 
+            // Need gcon for raising index
+            GReal gcon[GR_DIM][GR_DIM];
+            gcon_native(X, gcon);
+            conn_from_dgcov(gcon, conn);
+        }
+
+        /**
+         * Exact connection coefficients: differentiate the native metric
+         * gcov_native = dxdX^T gcov_embed dxdX with the chain rule, using the
+         * transform's analytic first & second derivatives.
+         * The embedding metric derivatives are analytic for most base systems, see dgcov_embed
+         */
+        KOKKOS_INLINE_FUNCTION void conn_native_exact(const GReal X[GR_DIM], const GReal delta, Real conn[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            GReal Xembed[GR_DIM];
+            coord_to_embed(X, Xembed);
+            Real J[GR_DIM][GR_DIM], H[GR_DIM][GR_DIM][GR_DIM];
+            dxdX(X, J);
+            d2xdX2(X, H);
+            Real g[GR_DIM][GR_DIM], dg[GR_DIM][GR_DIM][GR_DIM];
+            gcov_embed(Xembed, g);
+            dgcov_embed(Xembed, delta, dg);
+
+            // d_e gcov_embed, in native coordinates
+            Real dg_native[GR_DIM][GR_DIM][GR_DIM];
+            DLOOP2 for (int e = 0; e < GR_DIM; e++) {
+                dg_native[mu][nu][e] = 0.;
+                for (int f = 0; f < GR_DIM; f++) dg_native[mu][nu][e] += dg[mu][nu][f] * J[f][e];
+            }
+
+            // conn[a][b][e] = d_e gcov_native[a][b]
+            Real gcov[GR_DIM][GR_DIM];
+            for (int a = 0; a < GR_DIM; a++) {
+                for (int b = 0; b < GR_DIM; b++) {
+                    gcov[a][b] = 0.;
+                    for (int e = 0; e < GR_DIM; e++) conn[a][b][e] = 0.;
+                    DLOOP2 {
+                        gcov[a][b] += g[mu][nu] * J[mu][a] * J[nu][b];
+                        for (int e = 0; e < GR_DIM; e++) {
+                            conn[a][b][e] += g[mu][nu] * (H[mu][a][e] * J[nu][b] + J[mu][a] * H[nu][b][e])
+                                             + dg_native[mu][nu][e] * J[mu][a] * J[nu][b];
+                        }
+                    }
+                }
+            }
+
+            GReal gcon[GR_DIM][GR_DIM];
+            gcon_from_gcov(gcov, gcon);
+            conn_from_dgcov(gcon, conn);
+        }
+
+        /**
+         * Convert metric derivatives conn[lam][kap][nu] = d_nu gcov[lam][kap]
+         * to connection coefficients \Gamma^lam_{nu mu}, in place
+         */
+        KOKKOS_INLINE_FUNCTION void conn_from_dgcov(const GReal gcon[GR_DIM][GR_DIM], Real conn[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            GReal tmp[GR_DIM][GR_DIM][GR_DIM];
             // Rearrange to find \Gamma_{lam nu mu}
             for (int lam = 0; lam < GR_DIM; lam++) {
                 for (int nu = 0; nu < GR_DIM; nu++) {
@@ -555,9 +672,6 @@ class CoordinateEmbedding {
                 }
             }
 
-            // Need gcon for raising index
-            gcon_native(X, gcon);
-
             // Raise index to get \Gamma^lam_{nu mu}
             for (int lam = 0; lam < GR_DIM; lam++) {
                 for (int nu = 0; nu < GR_DIM; nu++) {
@@ -83,6 +83,12 @@ class CartMinkowskiCoords {
         {
             DLOOP2 gcov[mu][nu] = (mu == nu) - 2*(mu == 0 && nu == 0);
         }
+        // Derivatives of the metric, dgcov[mu][nu][lam] = d_lam gcov[mu][nu]
+        static constexpr bool analytic_derivs = true;
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 dgcov[mu][nu][lam] = 0.;
+        }
 };
 
 /**
@@ -105,6 +111,18 @@ class SphMinkowskiCoords {
             gcov[2][2] = r*r;
             gcov[3][3] = sth*sth*r*r;
         }
+        static constexpr bool analytic_derivs = true;
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            const GReal r = m::max(Xembed[1], SMALL);
+            const GReal th = excise(excise(Xembed[2], 0.0, SMALL), M_PI, SMALL);
+            const GReal sth = m::sin(th), cth = m::cos(th);
+
+            DLOOP3 dgcov[mu][nu][lam] = 0.;
+            dgcov[2][2][1] = 2.*r;
+            dgcov[3][3][1] = 2.*sth*sth*r;
+            dgcov[3][3][2] = 2.*sth*cth*r*r;
+        }
 };
 
 /**
@@ -149,6 +167,39 @@ class SphKSCoords {
             gcov[3][2] = 0.;
             gcov[3][3] = sin2*(rho2 + a*a*sin2*(1. + 2.*r/rho2));
         }
+        static constexpr bool analytic_derivs = true;
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            const GReal r = Xembed[1];
+            const GReal th = excise(excise(Xembed[2], 0.0, SMALL), M_PI, SMALL);
+
+            const GReal cth = m::cos(th);
+            const GReal sth = m::sin(th);
+            const GReal sin2 = sth*sth;
+            const GReal dsin2 = 2.*sth*cth;
+            const GReal rho2 = r*r + a*a*cth*cth;
+            // Most components are functions of q = 2r/rho2
+            const GReal q = 2.*r/rho2;
+            const GReal dqdr = (2.*rho2 - 4.*r*r)/(rho2*rho2);
+            const GReal dqdth = 4.*a*a*r*cth*sth/(rho2*rho2);
+            const GReal P = rho2 + a*a*sin2*(1. + q);
+
+            DLOOP3 dgcov[mu][nu][lam] = 0.;
+            dgcov[0][0][1] = dqdr;
+            dgcov[0][0][2] = dqdth;
+            dgcov[0][1][1] = dgcov[1][0][1] = dqdr;
+            dgcov[0][1][2] = dgcov[1][0][2] = dqdth;
+            dgcov[0][3][1] = dgcov[3][0][1] = -a*sin2*dqdr;
+            dgcov[0][3][2] = dgcov[3][0][2] = -a*(dsin2*q + sin2*dqdth);
+            dgcov[1][1][1] = dqdr;
+            dgcov[1][1][2] = dqdth;
+            dgcov[1][3][1] = dgcov[3][1][1] = -a*sin2*dqdr;
+            dgcov[1][3][2] = dgcov[3][1][2] = -a*(dsin2*(1. + q) + sin2*dqdth);
+            dgcov[2][2][1] = 2.*r;
+            dgcov[2][2][2] = -2.*a*a*cth*sth;
+            dgcov[3][3][1] = sin2*(2.*r + a*a*sin2*dqdr);
+            dgcov[3][3][2] = dsin2*P + sin2*(-2.*a*a*cth*sth + a*a*(dsin2*(1. + q) + sin2*dqdth));
+        }
 
         // For converting from BL
         KOKKOS_INLINE_FUNCTION void vec_from_bl(const GReal Xembed[GR_DIM], const Real vcon_bl[GR_DIM], Real vcon[GR_DIM]) const
@@ -187,6 +238,7 @@ class SphKSExtG {
         // BH Spin is a property of KS
         const GReal a;
         static constexpr bool spherical = true;
+        static constexpr bool analytic_derivs = true;
 
         static constexpr GReal A = 4.24621057e-9; //1.46797639e-8;
         static constexpr GReal B = 1.35721335; //1.29411117;
@@ -225,6 +277,16 @@ class SphKSExtG {
             gcov[3][2] = 0.;
             gcov[3][3] = sin2*(rho2 + a*a*sin2*(1. + 2.*r/rho2));
         }
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            // KS, plus the derivative of the potential in the t,r components
+            SphKSCoords(a).dgcov_embed(Xembed, dgcov);
+            const GReal dPhi_g = A * m::pow(Xembed[1], B-2.);
+            dgcov[0][0][1] -= 2. * dPhi_g;
+            dgcov[0][1][1] -= 2. * dPhi_g;
+            dgcov[1][0][1] -= 2. * dPhi_g;
+            dgcov[1][1][1] -= 2. * dPhi_g;
+        }
 
         // For converting from BL
         // TODO will we ever need a from_ks?
@@ -262,6 +324,42 @@ class SphKSExtG {
         }
 };
 
+/**
+ * Derivatives of the BL metric (optionally with an external potential),
+ * shared by SphBLCoords and SphBLExtG below.
+ * D is the denominator of gcov[1][1] and dD its r-derivative, dPhi_g the r-derivative of the potential
+ */
+KOKKOS_INLINE_FUNCTION void bl_dgcov(const GReal a, const GReal Xembed[GR_DIM], const GReal D, const GReal dD,
+                                     const GReal dPhi_g, Real dgcov[GR_DIM][GR_DIM][GR_DIM])
+{
+    const GReal r = Xembed[1];
+    const GReal th = excise(excise(Xembed[2], 0.0, SMALL), M_PI, SMALL);
+    const GReal cth = m::cos(th), sth = m::sin(th);
+
+    const GReal sin2 = sth*sth;
+    const GReal dsin2 = 2.*sth*cth;
+    const GReal a2 = a*a;
+    const GReal mmu = 1. + a2*cth*cth/(r*r);
+    const GReal dmmudr = -2.*a2*cth*cth/(r*r*r);
+    const GReal dmmudth = -2.*a2*cth*sth/(r*r);
+    // w = r*mmu appears in several denominators
+    const GReal w = r*mmu;
+    const GReal dwdr = 1. - a2*cth*cth/(r*r);
+    const GReal dwdth = -2.*a2*cth*sth/r;
+
+    DLOOP3 dgcov[mu][nu][lam] = 0.;
+    dgcov[0][0][1] = -2.*dwdr/(w*w) - 2.*dPhi_g;
+    dgcov[0][0][2] = -2.*dwdth/(w*w);
+    dgcov[0][3][1] = dgcov[3][0][1] = 2.*a*sin2*dwdr/(w*w);
+    dgcov[0][3][2] = dgcov[3][0][2] = -2.*a*(dsin2/w - sin2*dwdth/(w*w));
+    dgcov[1][1][1] = (dmmudr*D - mmu*dD)/(D*D);
+    dgcov[1][1][2] = dmmudth/D;
+    dgcov[2][2][1] = 2.*r;
+    dgcov[2][2][2] = -2.*a2*cth*sth;
+    dgcov[3][3][1] = sin2*(2.*r - 2.*a2*sin2*dwdr/(w*w));
+    dgcov[3][3][2] = dsin2*(r*r + a2 + 2.*a2*sin2/w) + sin2*2.*a2*(dsin2/w - sin2*dwdth/(w*w));
+}
+
 /**
  * Boyer-Lindquist coordinates as an embedding system
  */
@@ -271,6 +369,7 @@ class SphBLCoords {
         // BH Spin is a property of BL
         const GReal a;
         static constexpr bool spherical = true;
+        static constexpr bool analytic_derivs = true;
 
         KOKKOS_FUNCTION SphBLCoords(GReal spin): a(spin) {}
 
@@ -294,6 +393,11 @@ class SphBLCoords {
             gcov[3][0]  = -2.*a*sin2/(r*mmu);
             gcov[3][3]   = sin2*(r2 + a2 + 2.*a2*sin2/(r*mmu));
         }
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            const GReal r = Xembed[1];
+            bl_dgcov(a, Xembed, 1. - 2./r + a*a/(r*r), 2./(r*r) - 2.*a*a/(r*r*r), 0., dgcov);
+        }
 
         // TODO(BSP) vec to/from ks, put guaranteed ks/bl fns into embedding
 
@@ -308,6 +412,7 @@ class SphBLExtG {
         // BH Spin is a property of BL
         const GReal a;
         static constexpr bool spherical = true;
+        static constexpr bool analytic_derivs = true;
 
         static constexpr GReal A = 4.24621057e-9; //1.46797639e-8;
         static constexpr GReal B = 1.35721335; //1.29411117;
@@ -335,6 +440,13 @@ class SphBLExtG {
             gcov[3][0]  = -2.*a*sin2/(r*mmu);
             gcov[3][3]   = sin2*(r2 + a2 + 2.*a2*sin2/(r*mmu));
         }
+        KOKKOS_INLINE_FUNCTION void dgcov_embed(const GReal Xembed[GR_DIM], Real dgcov[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            const GReal r = Xembed[1];
+            const GReal Phi_g = (A / (B-1.)) * (m::pow(r, B-1.) - m::pow(2, B-1.));
+            const GReal dPhi_g = A * m::pow(r, B-2.);
+            bl_dgcov(a, Xembed, 1. - 2./r + 2.*Phi_g, 2./(r*r) + 2.*dPhi_g, dPhi_g, dgcov);
+        }
 };
 
 /**
@@ -343,6 +455,7 @@ class SphBLExtG {
  * Each class must define enough functions to apply the transform to coordinates and vectors,
  * both forward and in reverse.
  * That comes out to 4 functions: coord_to_embed, coord_to_native, dXdx, dxdX
+ * Each also defines d2xdX2, used with dxdX to compute connection coefficients exactly
  */
 
 /**
@@ -372,6 +485,11 @@ class NullTransform {
         {
             DLOOP2 dXdx[mu][nu] = (mu == nu);
         }
+        // Second derivatives d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal X[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+        }
 };
 // This only exists separately to define startx & stopx. Could fall back on base coords for these?
 class SphNullTransform {
@@ -398,6 +516,11 @@ class SphNullTransform {
         {
             DLOOP2 dXdx[mu][nu] = (mu == nu);
         }
+        // Second derivatives d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal X[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+        }
 };
 
 /**
@@ -451,6 +574,14 @@ class ExponentialTransform {
             dXdx[2][2] = 1.;
             dXdx[3][3] = 1.;
         }
+        /**
+         * Second derivatives of the transformation, d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+         */
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+            d2xdX2[1][1][1] = m::exp(Xnative[1]);
+        }
 };
 
 /**
@@ -517,6 +648,19 @@ class SuperExponentialTransform {
             dXdx[2][2] = 1.;
             dXdx[3][3] = 1.;
         }
+        /**
+         * Second derivatives of the transformation, d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+         */
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+            const GReal super_dist = Xnative[1] - xn1br;
+            // r = exp(f), so r'' = exp(f) (f'^2 + f'')
+            const GReal df = 1 + (super_dist > 0) * cpow2 * npow2 * m::pow(super_dist, npow2-1);
+            const GReal d2f = (super_dist > 0) * cpow2 * npow2 * (npow2-1) * m::pow(super_dist, npow2-2);
+            d2xdX2[1][1][1] = m::exp(Xnative[1] + (super_dist > 0) * cpow2 * m::pow(super_dist, npow2))
+                                * (df*df + d2f);
+        }
 };
 
 /**
@@ -577,6 +721,15 @@ class ModifyTransform {
             dXdx[2][2] = 1 / (M_PI - (hslope - 1.)*M_PI*m::cos(2.*M_PI*Xnative[2]));
             dXdx[3][3] = 1.;
         }
+        /**
+         * Second derivatives of the transformation, d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+         */
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+            d2xdX2[1][1][1] = m::exp(Xnative[1]);
+            d2xdX2[2][2][2] = -2.*M_PI*M_PI*(1. - hslope)*m::sin(2.*M_PI*Xnative[2]);
+        }
 };
 
 /**
@@ -664,6 +817,28 @@ class FunkyTransform {
             dxdX(Xnative, dxdX_tmp);
             invert(&dxdX_tmp[0][0],&dXdx[0][0]);
         }
+        /**
+         * Second derivatives of the transformation, d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+         * With th = thG + E*(thJ - thG) and E = exp(mks_smooth*(startx1 - X1))
+         */
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+            d2xdX2[1][1][1] = m::exp(Xnative[1]);
+
+            const GReal E = m::exp(mks_smooth * (startx1 - Xnative[1]));
+            const GReal y = 2*Xnative[2] - 1.;
+            const GReal thG = M_PI*Xnative[2] + ((1. - hslope)/2.)*m::sin(2.*M_PI*Xnative[2]);
+            const GReal dthG = M_PI + (1. - hslope)*M_PI*m::cos(2.*M_PI*Xnative[2]);
+            const GReal d2thG = -2.*M_PI*M_PI*(1. - hslope)*m::sin(2.*M_PI*Xnative[2]);
+            const GReal thJ = poly_norm * y * (1. + m::pow(y/poly_xt,poly_alpha) / (poly_alpha + 1.)) + 0.5 * M_PI;
+            const GReal dthJ = 2.*poly_norm * (1. + m::pow(y/poly_xt, poly_alpha));
+            const GReal d2thJ = 4.*poly_norm * poly_alpha * m::pow(y/poly_xt, poly_alpha - 1.) / poly_xt;
+
+            d2xdX2[2][1][1] = mks_smooth*mks_smooth * E * (thJ - thG);
+            d2xdX2[2][1][2] = d2xdX2[2][2][1] = -mks_smooth * E * (dthJ - dthG);
+            d2xdX2[2][2][2] = d2thG + E * (d2thJ - d2thG);
+        }
 };
 
 /**
@@ -738,6 +913,18 @@ class WidepoleTransform {
             dxdX(Xnative, dxdX_tmp);
             invert(&dxdX_tmp[0][0],&dXdx[0][0]);
         }
+        /**
+         * Second derivatives of the transformation, d2xdX2[mu][nu][lam] = d^2 x^mu / dX^nu dX^lam
+         */
+        KOKKOS_INLINE_FUNCTION void d2xdX2(const GReal Xnative[GR_DIM], Real d2xdX2[GR_DIM][GR_DIM][GR_DIM]) const
+        {
+            DLOOP3 d2xdX2[mu][nu][lam] = 0.;
+            d2xdX2[1][1][1] = exp(Xnative[1]);
+            const GReal ym = (Xnative[2] - 1.) / smoothness, yp = Xnative[2] / smoothness;
+            const GReal sech2m = 1. / m::pow(cosh(ym), 2.), sech2p = 1. / m::pow(cosh(yp), 2.);
+            d2xdX2[2][2][2] = -M_PI * (1. - lin_frac) / (smoothness * smoothness)
+                                * (sech2m * tanh(ym) + sech2p * tanh(yp));
+        }
 };
 
 // Bundle coordinates and transforms into umbrella variant types
@@ -42,12 +42,16 @@
 // types, which are not available when importing this file's header
 #include "types.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <tuple>
+
 using Kokkos::MDRangePolicy;
 using Kokkos::Rank;
 
-// Stepsize for numerical derivatives of the metric
-#define DELTA 1.e-8
-
 #if FAST_CARTESIAN
 /**
  * Fast Cartesian GRCoordinates objects just use the underlying UniformCartesian object for everything
@@ -57,6 +61,108 @@ GRCoordinates::GRCoordinates(const GRCoordinates &src, int coarsen): UniformCart
 #else
 // Internal function for initializing cache
 void init_GRCoordinates(GRCoordinates& G);
+// Internal function choosing whether to cache or compute each quantity
+void set_geometry_policy(GRCoordinates& G, ParameterInput *pin);
+// Internal function tabulating the dynamical time, see GRCoordinates::tdyn
+void init_tdyn(GRCoordinates& G);
+
+/**
+ * Fractional offsets of the points averaged to get geometry in a zone or on a face
+ */
+#define MAX_AVERAGE_POINTS 9
+struct GeomStencil {
+    int n;
+    GReal offset[MAX_AVERAGE_POINTS];
+};
+
+/**
+ * Geometry caches only depend on a block's footprint in X1,X2, so blocks which differ only
+ * in X3 (e.g., the phi-blocks of a 3D torus) can share them.
+ * Caches are keyed on the footprint (which encodes level & block offsets), and shared as
+ * Kokkos Views, which are reference-counted: entries no longer used by any block are dropped
+ * whenever a new cache is built, on AMR/SMR remeshing.
+ * With <coordinates> geometry_pool_size > 0, up to that many unused entries are instead kept, so
+ * that blocks re-refined to a previous footprint find their geometry ready, and new caches recycle
+ * the device allocations of unused entries of the same extent.
+ */
+using GeomCacheKey = std::tuple<int, int, GReal, GReal, GReal, GReal, int, bool, bool>;
+struct GeomCacheEntry {
+    GeomTensor2 gcon, gcov;
+    GeomScalar gdet;
+    GeomTensor3 conn, gdet_conn;
+};
+static std::map<GeomCacheKey, GeomCacheEntry> shared_geometry;
+static bool share_geometry = true;
+static int geometry_pool_size = 0;
+
+/**
+ * Optionally, caches are also kept on disk in <coordinates> geometry_cache_dir, and read back on restart.
+ * Files are named by a hash of a string describing the block footprint and the coordinate system.
+ * The full string is stored in each file, and checked before its contents are used
+ */
+static std::string geometry_cache_dir = "";
+static const char geometry_cache_magic[] = "KHARMA_GEOM_2";
+
+std::string geometry_cache_id(const GRCoordinates& G, const GeomCacheKey& key)
+{
+    std::ostringstream id;
+    id.precision(17);
+    id << G.coords.variant_names() << " " << std::get<0>(key) << " " << std::get<1>(key) << " "
+       << std::get<2>(key) << " " << std::get<3>(key) << " " << std::get<4>(key) << " " << std::get<5>(key) << " "
+       << std::get<6>(key) << " " << std::get<7>(key) << " " << std::get<8>(key) << " " << sizeof(Real);
+    // Fingerprint the coordinate parameters (spin, hslope, etc.) by the metric at a couple of points
+    const GReal Xprobe[2][GR_DIM] = {{0., std::get<2>(key), std::get<3>(key), 0.},
+                                     {0., std::get<2>(key) + 0.37*std::get<4>(key), std::get<3>(key) + 0.61*std::get<5>(key), 0.}};
+    for (int p = 0; p < 2; p++) {
+        Real gcov[GR_DIM][GR_DIM];
+        G.coords.gcov_native(Xprobe[p], gcov);
+        DLOOP2 id << " " << gcov[mu][nu];
+    }
+    return id.str();
+}
+std::string geometry_cache_path(const std::string& id)
+{
+    std::ostringstream path;
+    path << geometry_cache_dir << "/geometry_" << std::hex << std::hash<std::string>{}(id) << ".bin";
+    return path.str();
+}
+bool load_geometry_cache(const std::string& id, std::vector<GeomTensor2*> arrs)
+{
+    std::ifstream f(geometry_cache_path(id), std::ios::binary);
+    if (!f) return false;
+    std::string magic, id_file;
+    std::getline(f, magic, '\0');
+    std::getline(f, id_file, '\0');
+    if (magic != geometry_cache_magic || id_file != id) return false;
+    for (auto arr : arrs) {
+        auto host = arr->GetHostMirror();
+        f.read(reinterpret_cast<char*>(host.data()), host.GetSize() * sizeof(Real));
+        if (!f) return false;
+        arr->DeepCopy(host);
+    }
+    return true;
+}
+void save_geometry_cache(const std::string& id, std::vector<GeomTensor2*> arrs)
+{
+    // Write to a rank-specific temporary & rename, so that readers never see partial files
+    const std::string path = geometry_cache_path(id);
+    const std::string tmp_path = path + ".tmp" + std::to_string(Globals::my_rank);
+    {
+        std::ofstream f(tmp_path, std::ios::binary);
+        if (!f) return;
+        f.write(geometry_cache_magic, sizeof(geometry_cache_magic));
+        f.write(id.c_str(), id.size() + 1);
+        for (auto arr : arrs) {
+            auto host = arr->GetHostMirrorAndCopy();
+            f.write(reinterpret_cast<const char*>(host.data()), host.GetSize() * sizeof(Real));
+        }
+        if (!f) {
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    std::rename(tmp_path.c_str(), path.c_str());
+}
 
 /**
  * Construct a GRCoordinates object with a transformation according to preferences set in the package
@@ -71,18 +177,134 @@ GRCoordinates::GRCoordinates(const RegionSize &rs, ParameterInput *pin): Uniform
     //cout << "Initialized coordinates with nghost " << Globals::nghost << std::endl;
 
     connection_average_points = pin->GetOrAddInteger("coordinates", "connection_average_points", 1);
+    if (connection_average_points < 1 || connection_average_points > MAX_AVERAGE_POINTS)
+        throw std::invalid_argument("connection_average_points must be between 1 and "+std::to_string(MAX_AVERAGE_POINTS)+"!");
     correct_connections = pin->GetOrAddBoolean("coordinates", "correct_connections", false);
+    exact_connections = pin->GetOrAddBoolean("coordinates", "exact_connections", false);
+    share_geometry = pin->GetOrAddBoolean("coordinates", "share_geometry", true);
+    geometry_pool_size = pin->GetOrAddInteger("coordinates", "geometry_pool_size", 0);
+    if (geometry_pool_size > 0 && !share_geometry)
+        throw std::invalid_argument("Pooling geometry caches requires <coordinates> share_geometry!");
+    geometry_cache_dir = pin->GetOrAddString("coordinates", "geometry_cache_dir", "");
+    flat_cartesian = mpark::holds_alternative<CartMinkowskiCoords>(coords.base) &&
+                     mpark::holds_alternative<NullTransform>(coords.transform);
 
     init_GRCoordinates(*this);
+    set_geometry_policy(*this, pin);
+
+    // The torus EMHD closure needs r^(3/2) in every call, from several kernels per step
+    cache_tdyn = !flat_cartesian && pin->GetOrAddBoolean("emhd", "on", false) &&
+                 pin->GetOrAddString("emhd", "closure_type", "torus") == "torus";
+    if (cache_tdyn) init_tdyn(*this);
 }
 
 GRCoordinates::GRCoordinates(const GRCoordinates &src, int coarsen): UniformCartesian(src, coarsen),
     coords(src.coords), n1(src.n1/coarsen), n2(src.n2/coarsen), n3(src.n3/coarsen),
     connection_average_points(src.connection_average_points),
-    correct_connections(src.correct_connections)
+    correct_connections(src.correct_connections), exact_connections(src.exact_connections)
 {
     //std::cerr << "Calling coarsen constructor" << std::endl;
+    flat_cartesian = src.flat_cartesian;
     init_GRCoordinates(*this);
+    compute_gcov = src.compute_gcov;
+    compute_gcon = src.compute_gcon;
+    compute_gdet = src.compute_gdet;
+    compute_conn = src.compute_conn;
+    cache_tdyn = src.cache_tdyn;
+    if (cache_tdyn) init_tdyn(*this);
+}
+
+void init_tdyn(GRCoordinates& G)
+{
+    // Evaluate with the cache disabled, then point the accessor at the table
+    G.cache_tdyn = false;
+    GeomScalar tdyn_local("tdyn", G.n2, G.n1);
+    Kokkos::parallel_for("init_tdyn", MDRangePolicy<Rank<2>>({0,0}, {G.n2, G.n1}),
+        KOKKOS_LAMBDA (const int& j, const int& i) {
+            tdyn_local(j, i) = G.tdyn(j, i);
+        }
+    );
+    G.tdyn_direct = tdyn_local;
+    G.cache_tdyn = true;
+}
+
+/**
+ * Run a kernel summing geometry over a block's zones a few times, and return the elapsed time
+ */
+template<typename Function>
+double time_geometry_kernel(const int n2, const int n1, const Function& f)
+{
+    Real sum = 0.;
+    // Warm up, then time
+    Kokkos::parallel_reduce("geom_bench_warmup", MDRangePolicy<Rank<2>>({0,0}, {n2, n1}), f, sum);
+    Kokkos::fence();
+    Kokkos::Timer timer;
+    for (int n = 0; n < 10; ++n)
+        Kokkos::parallel_reduce("geom_bench", MDRangePolicy<Rank<2>>({0,0}, {n2, n1}), f, sum);
+    Kokkos::fence();
+    return timer.seconds();
+}
+
+/**
+ * Choose whether each geometry quantity is loaded from cache or recomputed from the embedding,
+ * according to <coordinates> geometry_{gcov,gcon,gdet,conn}.
+ * For "auto", both versions are timed on the first block constructed, and the choice is
+ * kept for all blocks thereafter, so that every block on a rank behaves the same
+ */
+void set_geometry_policy(GRCoordinates& G, ParameterInput *pin)
+{
+    const std::vector<std::string> policy_vals = {"cache", "compute", "auto"};
+    const std::string gcov_s = pin->GetOrAddString("coordinates", "geometry_gcov", "cache", policy_vals);
+    const std::string gcon_s = pin->GetOrAddString("coordinates", "geometry_gcon", "cache", policy_vals);
+    const std::string gdet_s = pin->GetOrAddString("coordinates", "geometry_gdet", "cache", policy_vals);
+    const std::string conn_s = pin->GetOrAddString("coordinates", "geometry_conn", "cache", policy_vals);
+    if (G.flat_cartesian) return;
+    if (gcov_s == "cache" && gcon_s == "cache" && gdet_s == "cache" && conn_s == "cache") return;
+
+    // Cached values are averaged or corrected in these cases, and cannot be reproduced pointwise
+    if (G.connection_average_points > 1)
+        throw std::invalid_argument("Computing geometry on the fly is incompatible with connection_average_points > 1!");
+    if (G.correct_connections && conn_s != "cache")
+        throw std::invalid_argument("Computing connections on the fly is incompatible with correct_connections!");
+
+    static bool benchmarked = false;
+    static bool fast_gcov, fast_gcon, fast_gdet, fast_conn;
+    if (!benchmarked && (gcov_s == "auto" || gcon_s == "auto" || gdet_s == "auto" || conn_s == "auto")) {
+        GRCoordinates Gc = G, Gf = G;
+        Gc.compute_gcov = Gc.compute_gcon = Gc.compute_gdet = Gc.compute_conn = false;
+        Gf.compute_gcov = Gf.compute_gcon = Gf.compute_gdet = Gf.compute_conn = true;
+        const int n1 = G.n1, n2 = G.n2;
+        // Faster to compute, i.e., (time cached) > (time computed)
+        fast_gcov = time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP2 sum += Gc.gcov(Loci::center, j, i, mu, nu); })
+                  > time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP2 sum += Gf.gcov(Loci::center, j, i, mu, nu); });
+        fast_gcon = time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP2 sum += Gc.gcon(Loci::center, j, i, mu, nu); })
+                  > time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP2 sum += Gf.gcon(Loci::center, j, i, mu, nu); });
+        fast_gdet = time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        sum += Gc.gdet(Loci::center, j, i); })
+                  > time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        sum += Gf.gdet(Loci::center, j, i); });
+        fast_conn = time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP3 sum += Gc.conn(j, i, mu, nu, lam); })
+                  > time_geometry_kernel(n2, n1, KOKKOS_LAMBDA (const int& j, const int& i, Real& sum) {
+                        DLOOP3 sum += Gf.conn(j, i, mu, nu, lam); });
+        benchmarked = true;
+        if (MPIRank0()) {
+            std::cout << "Geometry computed on the fly (auto):"
+                      << ((gcov_s == "auto" && fast_gcov) ? " gcov" : "")
+                      << ((gcon_s == "auto" && fast_gcon) ? " gcon" : "")
+                      << ((gdet_s == "auto" && fast_gdet) ? " gdet" : "")
+                      << ((conn_s == "auto" && fast_conn) ? " conn" : "") << std::endl;
+        }
+    }
+
+    G.compute_gcov = (gcov_s == "compute") || (gcov_s == "auto" && fast_gcov);
+    G.compute_gcon = (gcon_s == "compute") || (gcon_s == "auto" && fast_gcon);
+    G.compute_gdet = (gdet_s == "compute") || (gdet_s == "auto" && fast_gdet);
+    G.compute_conn = (conn_s == "compute") || (conn_s == "auto" && fast_conn);
 }
 
 /**
@@ -94,19 +316,71 @@ GRCoordinates::GRCoordinates(const GRCoordinates &src, int coarsen): UniformCart
  * fun issues with C++ Lambda capture, which Kokkos brings to the fore
  */
 void init_GRCoordinates(GRCoordinates& G) {
+    // Flat space needs no caches at all
+    if (G.flat_cartesian) return;
+
     const int n1 = G.n1;
     const int n2 = G.n2;
     //const int n3 = G.n3;
     const bool correct_connections = G.correct_connections;
     const int connection_average_points = G.connection_average_points;
 
+    // Reuse the caches of any block with the same X1,X2 footprint
+    const GeomCacheKey key = {n1, n2, G.Xf<1>(0), G.Xf<2>(0), G.Dxc<1>(0), G.Dxc<2>(0),
+                              connection_average_points, correct_connections, G.exact_connections};
+    bool recycled = false;
+    if (share_geometry) {
+        static bool hooked = false;
+        if (!hooked) {
+            // Host-side copies of Views must be freed before Kokkos is
+            Kokkos::push_finalize_hook([]() { shared_geometry.clear(); });
+            hooked = true;
+        }
+        auto it = shared_geometry.find(key);
+        if (it != shared_geometry.end()) {
+            G.gcon_direct = it->second.gcon;
+            G.gcov_direct = it->second.gcov;
+            G.gdet_direct = it->second.gdet;
+            G.conn_direct = it->second.conn;
+            G.gdet_conn_direct = it->second.gdet_conn;
+            return;
+        }
+        // Drop caches held only by this map, past any we're keeping pooled.
+        // Take one of matching extent to reuse its memory, if we can
+        int n_pooled = 0;
+        for (auto it = shared_geometry.begin(); it != shared_geometry.end();) {
+            if (it->second.gcon.use_count() == 1) {
+                if (!recycled && std::get<0>(it->first) == n1 && std::get<1>(it->first) == n2) {
+                    G.gcon_direct = it->second.gcon;
+                    G.gcov_direct = it->second.gcov;
+                    G.gdet_direct = it->second.gdet;
+                    G.conn_direct = it->second.conn;
+                    G.gdet_conn_direct = it->second.gdet_conn;
+                    recycled = true;
+                    it = shared_geometry.erase(it);
+                } else if (n_pooled < geometry_pool_size) {
+                    ++n_pooled;
+                    ++it;
+                } else {
+                    it = shared_geometry.erase(it);
+                }
+            } else {
+                ++it;
+            }
+        }
+    }
+
     //cerr << "Creating GRCoordinate cache size " << n1 << " " << n2 << std::endl;
     // Cache geometry.  May be faster than re-computing. May not be.
-    G.gcon_direct = GeomTensor2("gcon", NLOC, n2+1, n1+1, GR_DIM, GR_DIM);
-    G.gcov_direct = GeomTensor2("gcov", NLOC, n2+1, n1+1, GR_DIM, GR_DIM);
-    G.gdet_direct = GeomScalar("gdet", NLOC, n2+1, n1+1);
-    G.conn_direct = GeomTensor3("conn", n2, n1, GR_DIM, GR_DIM, GR_DIM);
-    G.gdet_conn_direct = GeomTensor3("conn", n2, n1, GR_DIM, GR_DIM, GR_DIM);
+    // Only the unique components of symmetric index pairs are stored, see sym_index.
+    // Accordingly, loops below only fill mu <= nu (or nu <= lam for the connection)
+    if (!recycled) {
+        G.gcon_direct = GeomTensor2("gcon", n2+1, NLOC, n1+1, GR_SYM);
+        G.gcov_direct = GeomTensor2("gcov", n2+1, NLOC, n1+1, GR_SYM);
+        G.gdet_direct = GeomScalar("gdet", n2+1, NLOC, n1+1);
+        G.conn_direct = GeomTensor3("conn", n2, n1, GR_DIM, GR_SYM);
+        G.gdet_conn_direct = GeomTensor3("conn", n2, n1, GR_DIM, GR_SYM);
+    }
 
     // Member variables have an implicit this->
     // C++ Lambdas (and therefore Kokkos Lambdas) capture pointers to objects, not full objects
@@ -117,74 +391,115 @@ void init_GRCoordinates(GRCoordinates& G) {
     auto conn_local = G.conn_direct;
     auto gdet_conn_local = G.gdet_conn_direct;
 
+    // Read the finished caches from disk if possible
+    std::string cache_id;
+    std::vector<GeomTensor2*> cache_arrs = {&G.gcon_direct, &G.gcov_direct, &G.gdet_direct,
+                                            &G.conn_direct, &G.gdet_conn_direct};
+    if (geometry_cache_dir != "") {
+        cache_id = geometry_cache_id(G, key);
+        if (load_geometry_cache(cache_id, cache_arrs)) {
+            if (share_geometry)
+                shared_geometry[key] = {gcon_local, gcov_local, gdet_local, conn_local, gdet_conn_local};
+            return;
+        }
+    }
+
+    // Sample offsets within a zone, as a fraction of its width, for averaging.
+    // These are the same for every zone & block, so build them once and capture the table by value
+    GeomStencil stencil;
+    stencil.n = connection_average_points;
+    for (int k = 0; k < stencil.n; k++)
+        stencil.offset[k] = ((GReal) (k - connection_average_points / 2)) / connection_average_points;
+
     Kokkos::parallel_for("init_geom", MDRangePolicy<Rank<2>>({0,0}, {n2+1, n1+1}),
         KOKKOS_LAMBDA (const int& j, const int& i) {
             // Iterate through locations. This could be done in fancy ways, but
             // this highlights what's actually going on.
             for (int iloc =0; iloc < NLOC; iloc++) {
                 Loci loc = (Loci) iloc;
-                // radius of points to sample, floor(npoints/2)
-                const int radius = connection_average_points / 2;
-                const int diameter = connection_average_points;
-                const int square = connection_average_points*connection_average_points;
-                if (loc == Loci::center || loc == Loci::face3) {
+                const Real square = stencil.n*stencil.n;
+                if (loc == Loci::face3) {
+                    // Geometry is independent of X3, so this is identical to the center, filled below
+                    continue;
+                } else if (loc == Loci::center) {
                     // This prevents overstepping conn's bounds by halting in the last zone
                     if (i >= n1 || j >= n2) continue;
                     // Get a square of points evenly across each cell,
                     // over both nontrivial geometry directions 1,2
                     // Note this never hits/passes the pole
-                    for (int k = -radius; k <= radius; k++) {
-                        for (int l = -radius; l <= radius; l++) {
+                    GReal X0[GR_DIM], Xn1[GR_DIM], Xn2[GR_DIM];
+                    G.coord(0, j, i, loc, X0);
+                    G.coord(0, j, i+1, loc, Xn1);
+                    G.coord(0, j+1, i, loc, Xn2);
+                    GReal gdet_sum = 0., gcov_sum[GR_SYM] = {0}, gcon_sum[GR_SYM] = {0};
+                    Real conn_sum[GR_DIM][GR_SYM] = {{0}}, gdet_conn_sum[GR_DIM][GR_SYM] = {{0}};
+                    for (int k = 0; k < stencil.n; k++) {
+                        for (int l = 0; l < stencil.n; l++) {
                             GReal X[GR_DIM];
-                            G.coord(0, j, i, loc, X);
-                            GReal Xn1[GR_DIM], Xn2[GR_DIM];
-                            G.coord(0, j, i+1, loc, Xn1);
-                            G.coord(0, j+1, i, loc, Xn2);
-                            X[1] += (Xn1[1] - X[1])/connection_average_points * k;
-                            X[2] += (Xn2[2] - X[2])/connection_average_points * l;
+                            DLOOP1 X[mu] = X0[mu];
+                            X[1] += (Xn1[1] - X0[1]) * stencil.offset[k];
+                            X[2] += (Xn2[2] - X0[2]) * stencil.offset[l];
                             // Get geometry at points
                             GReal gcov_loc[GR_DIM][GR_DIM], gcon_loc[GR_DIM][GR_DIM];
                             G.coords.gcov_native(X, gcov_loc);
                             const GReal gdet = G.coords.gcon_from_gcov(gcov_loc, gcon_loc);
                             // Add to running averages
-                            gdet_local(loc, j, i) += gdet / square;
-                            DLOOP2 {
-                                gcov_local(loc, j, i, mu, nu) += gcov_loc[mu][nu] / square;
-                                gcon_local(loc, j, i, mu, nu) += gcon_loc[mu][nu] / square;
+                            gdet_sum += gdet;
+                            DLOOP1 for (int nu = mu; nu < GR_DIM; ++nu) {
+                                gcov_sum[sym_index(mu, nu)] += gcov_loc[mu][nu];
+                                gcon_sum[sym_index(mu, nu)] += gcon_loc[mu][nu];
                             }
-                            if (loc == Loci::center) {
-                                // In the center, get the connection and gdet*connection
-                                Real conn_loc[GR_DIM][GR_DIM][GR_DIM];
-                                G.coords.conn_native(X, DELTA, conn_loc);
-                                DLOOP3 {
-                                    conn_local(j, i, mu, nu, lam) += conn_loc[mu][nu][lam] / square;
-                                    gdet_conn_local(j, i, mu, nu, lam) += gdet*conn_loc[mu][nu][lam] / square;
-                                }
+                            // In the center, get the connection and gdet*connection
+                            Real conn_loc[GR_DIM][GR_DIM][GR_DIM];
+                            G.conn_native(X, conn_loc);
+                            DLOOP2 for (int lam = nu; lam < GR_DIM; ++lam) {
+                                conn_sum[mu][sym_index(nu, lam)] += conn_loc[mu][nu][lam];
+                                gdet_conn_sum[mu][sym_index(nu, lam)] += gdet*conn_loc[mu][nu][lam];
                             }
                         }
                     }
+                    // Write each value once, to the center and face3
+                    const Loci same_locs[2] = {Loci::center, Loci::face3};
+                    for (const Loci l : same_locs) {
+                        gdet_local(j, l, i) = gdet_sum / square;
+                        for (int n = 0; n < GR_SYM; n++) {
+                            gcov_local(j, l, i, n) = gcov_sum[n] / square;
+                            gcon_local(j, l, i, n) = gcon_sum[n] / square;
+                        }
+                    }
+                    DLOOP1 for (int n = 0; n < GR_SYM; n++) {
+                        conn_local(j, i, mu, n) = conn_sum[mu][n] / square;
+                        gdet_conn_local(j, i, mu, n) = gdet_conn_sum[mu][n] / square;
+                    }
                 } else if (loc == Loci::face1 || loc == Loci::face2) {
-                    for (int k=-radius; k <= radius; k++) {
-                        // Like the above, but only average over a particular face (line for 2D geometry)
+                    // Like the above, but only average over a particular face (line for 2D geometry)
+                    GReal X0[GR_DIM], Xn1[GR_DIM];
+                    G.coord(0, j, i, loc, X0);
+                    // Step in the nontrivial direction perpendicular to the normal
+                    const int avg_dir = (loc == Loci::face1) ? X2DIR : X1DIR;
+                    // Get the direction/distance
+                    G.coord(0, j + (avg_dir == X2DIR), i + (avg_dir == X1DIR), loc, Xn1);
+                    GReal gdet_sum = 0., gcov_sum[GR_SYM] = {0}, gcon_sum[GR_SYM] = {0};
+                    for (int k = 0; k < stencil.n; k++) {
                         GReal X[GR_DIM];
-                        G.coord(0, j, i, loc, X);
-                        GReal Xn1[GR_DIM];
-                        // Step in the nontrivial direction perpendicular to the normal
-                        const int avg_dir = (loc == Loci::face1) ? X2DIR : X1DIR;
-                        // Get the direction/distance
-                        G.coord(0, j + (avg_dir == X2DIR), i + (avg_dir == X1DIR), loc, Xn1);
-                        X[avg_dir] += (Xn1[avg_dir] - X[avg_dir])/diameter * k;
+                        DLOOP1 X[mu] = X0[mu];
+                        X[avg_dir] += (Xn1[avg_dir] - X0[avg_dir]) * stencil.offset[k];
                         // Get geometry at the point
                         GReal gcov_loc[GR_DIM][GR_DIM], gcon_loc[GR_DIM][GR_DIM];
                         G.coords.gcov_native(X, gcov_loc);
                         const GReal gdet = G.coords.gcon_from_gcov(gcov_loc, gcon_loc);
                         // Add to running averages
-                        gdet_local(loc, j, i) += gdet / diameter;
-                        DLOOP2 {
-                            gcov_local(loc, j, i, mu, nu) += gcov_loc[mu][nu] / diameter;
-                            gcon_local(loc, j, i, mu, nu) += gcon_loc[mu][nu] / diameter;
+                        gdet_sum += gdet;
+                        DLOOP1 for (int nu = mu; nu < GR_DIM; ++nu) {
+                            gcov_sum[sym_index(mu, nu)] += gcov_loc[mu][nu];
+                            gcon_sum[sym_index(mu, nu)] += gcon_loc[mu][nu];
                         }
                     }
+                    gdet_local(j, loc, i) = gdet_sum / stencil.n;
+                    for (int n = 0; n < GR_SYM; n++) {
+                        gcov_local(j, loc, i, n) = gcov_sum[n] / stencil.n;
+                        gcon_local(j, loc, i, n) = gcon_sum[n] / stencil.n;
+                    }
                 } else { // corner or exotic locations, no averaging
                     // Just one point
                     GReal X[GR_DIM];
@@ -194,10 +509,10 @@ void init_GRCoordinates(GRCoordinates& G) {
                     G.coords.gcov_native(X, gcov_loc);
                     const GReal gdet = G.coords.gcon_from_gcov(gcov_loc, gcon_loc);
                     // Set geometry
-                    gdet_local(loc, j, i) = gdet;
-                    DLOOP2 {
-                        gcov_local(loc, j, i, mu, nu) = gcov_loc[mu][nu];
-                        gcon_local(loc, j, i, mu, nu) = gcon_loc[mu][nu];
+                    gdet_local(j, loc, i) = gdet;
+                    DLOOP1 for (int nu = mu; nu < GR_DIM; ++nu) {
+                        gcov_local(j, loc, i, sym_index(mu, nu)) = gcov_loc[mu][nu];
+                        gcon_local(j, loc, i, sym_index(mu, nu)) = gcon_loc[mu][nu];
                     }
                 }
             }
@@ -219,16 +534,16 @@ void init_GRCoordinates(GRCoordinates& G) {
                         GReal Xfm[GR_DIM], Xfp[GR_DIM];
                         G.coord(0, j, i, loc, Xfm);
                         G.coord(0, j + (lam == X2DIR), i + (lam == X1DIR), loc, Xfp);
-                        double gdetfm = gdet_local(loc, j, i);
-                        double gdetfp = gdet_local(loc, j + (lam == X2DIR), i + (lam == X1DIR));
+                        double gdetfm = gdet_local(j, loc, i);
+                        double gdetfp = gdet_local(j + (lam == X2DIR), loc, i + (lam == X1DIR));
                         GReal target = (gdetfp - gdetfm) / (Xfp[lam] - Xfm[lam] + SMALL);
 
                         // Then sum the coefficients and record nonzero ones for modification
                         GReal test_sum = 0;
                         GReal sum_portions, portions[GR_DIM] = {0};
                         DLOOP1 {
-                            test_sum += gdet_conn_local(j, i, mu, mu, lam);
-                            portions[mu] = m::abs(gdet_conn_local(j, i, mu, mu, lam));
+                            test_sum += gdet_conn_local(j, i, mu, sym_index(mu, lam));
+                            portions[mu] = m::abs(gdet_conn_local(j, i, mu, sym_index(mu, lam)));
                             sum_portions += portions[mu];
                         }
                         DLOOP1 portions[mu] /= sum_portions;
@@ -236,14 +551,17 @@ void init_GRCoordinates(GRCoordinates& G) {
 
                         // Add the difference among components equally
                         const GReal diff = test_sum - target;
-                        DLOOP1 gdet_conn_local(j, i, mu, mu, lam) = gdet_conn_local(j, i, mu, mu, lam) - diff*portions[mu];
-
-                        // This is separated and set equal, as there will be one self-assignment
-                        DLOOP1 gdet_conn_local(j, i, mu, lam, mu) = gdet_conn_local(j, i, mu, mu, lam);
+                        // Since the lower indices are stored symmetrically, this also sets gdet_conn(mu, lam, mu)
+                        DLOOP1 gdet_conn_local(j, i, mu, sym_index(mu, lam)) = gdet_conn_local(j, i, mu, sym_index(mu, lam)) - diff*portions[mu];
                     }
                 }
             }
         );
     }
+
+    if (geometry_cache_dir != "")
+        save_geometry_cache(cache_id, cache_arrs);
+    if (share_geometry)
+        shared_geometry[key] = {gcon_local, gcov_local, gdet_local, conn_local, gdet_conn_local};
 }
 #endif // FAST_CARTESIAN
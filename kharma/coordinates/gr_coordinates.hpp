@@ -55,6 +55,17 @@
 // Don't cache values of the metric, etc, just call into CoordinateEmbedding directly
 #define NO_CACHE 0
 
+// The metric is symmetric, as is the connection in its lower indices.
+// Caches store only the GR_SYM unique components of each, indexed by sym_index
+#define GR_SYM 10
+// Stepsize for numerical derivatives of the metric
+#define CONN_DELTA 1.e-8
+KOKKOS_FORCEINLINE_FUNCTION int sym_index(const int mu, const int nu)
+{
+    const int a = m::min(mu, nu), b = m::max(mu, nu);
+    return a*(7 - a)/2 + b;
+}
+
 /**
  * Replacement/extension coordinate class for Parthenon
  * 
@@ -82,11 +93,32 @@ public:
     // metric determinant derivatives discretized at faces
     bool correct_connections = false;
 
+    // Whether to compute connection coefficients from analytic derivatives of the
+    // coordinate transform & metric, rather than finite differences of the metric
+    bool exact_connections = false;
+
     // Caches for geometry values at zone centers/faces/etc
+    // Symmetric index pairs are packed, see sym_index.
+    // X2 index is outermost in every cache, so that on host builds the pages each thread
+    // zero-fills (and so places in its NUMA domain) are the rows it later reads
 #if !FAST_CARTESIAN && !NO_CACHE
     GeomTensor2 gcon_direct, gcov_direct;
     GeomScalar gdet_direct;
     GeomTensor3 conn_direct, gdet_conn_direct;
+
+    // Whether to compute each quantity from the CoordinateEmbedding when accessed, rather than
+    // loading it from the cache.  Set by <coordinates> geometry_{gcov,gcon,gdet,conn},
+    // which can be "cache", "compute", or "auto" to benchmark both at startup
+    bool compute_gcov = false, compute_gcon = false, compute_gdet = false, compute_conn = false;
+
+    // Flat Cartesian space (CartMinkowskiCoords + NullTransform), detected at runtime.
+    // Nothing is cached, and accessors return the constant Minkowski values, as with FAST_CARTESIAN
+    bool flat_cartesian = false;
+
+    // Keplerian dynamical time r^(3/2) at zone centers, for the torus EMHD closure.
+    // Only cached when that closure is in use, see tdyn()
+    GeomScalar tdyn_direct;
+    bool cache_tdyn = false;
 #endif
 
     // "Full" constructors which generate new geometry caches
@@ -102,7 +134,7 @@ public:
     KOKKOS_FUNCTION GRCoordinates(const GRCoordinates &src): UniformCartesian(src),
         n1(src.n1), n2(src.n2), n3(src.n3), coords(src.coords),
         connection_average_points(src.connection_average_points),
-        correct_connections(src.correct_connections)
+        correct_connections(src.correct_connections), exact_connections(src.exact_connections)
     {
         //std::cerr << "Calling copy constructor size " << src.n1 << " " << src.n2 << std::endl;
 #if !FAST_CARTESIAN && !NO_CACHE
@@ -111,6 +143,13 @@ public:
         gdet_direct = src.gdet_direct;
         conn_direct = src.conn_direct;
         gdet_conn_direct = src.gdet_conn_direct;
+        compute_gcov = src.compute_gcov;
+        compute_gcon = src.compute_gcon;
+        compute_gdet = src.compute_gdet;
+        compute_conn = src.compute_conn;
+        flat_cartesian = src.flat_cartesian;
+        tdyn_direct = src.tdyn_direct;
+        cache_tdyn = src.cache_tdyn;
 #endif
     };
 
@@ -125,12 +164,20 @@ public:
         n3 = src.n3;
         connection_average_points = src.connection_average_points;
         correct_connections = src.correct_connections;
+        exact_connections = src.exact_connections;
 #if !FAST_CARTESIAN && !NO_CACHE
         gcon_direct = src.gcon_direct;
         gcov_direct = src.gcov_direct;
         gdet_direct = src.gdet_direct;
         conn_direct = src.conn_direct;
         gdet_conn_direct = src.gdet_conn_direct;
+        compute_gcov = src.compute_gcov;
+        compute_gcon = src.compute_gcon;
+        compute_gdet = src.compute_gdet;
+        compute_conn = src.compute_conn;
+        flat_cartesian = src.flat_cartesian;
+        tdyn_direct = src.tdyn_direct;
+        cache_tdyn = src.cache_tdyn;
 #endif
         return *this;
     };
@@ -159,6 +206,9 @@ public:
     KOKKOS_INLINE_FUNCTION void conn(const int& j, const int& i, Real conn[GR_DIM][GR_DIM][GR_DIM]) const;
     KOKKOS_INLINE_FUNCTION void gdet_conn(const int& j, const int& i, Real conn[GR_DIM][GR_DIM][GR_DIM]) const;
 
+    // Connection coefficients at a point, by the method chosen with exact_connections (slow!)
+    KOKKOS_INLINE_FUNCTION void conn_native(const GReal X[GR_DIM], Real conn[GR_DIM][GR_DIM][GR_DIM]) const;
+
     // Coordinates of the GRCoordinates, i.e. "native"
     KOKKOS_INLINE_FUNCTION void coord(const int& k, const int& j, const int& i, const Loci& loc, GReal X[GR_DIM]) const;
     // Coordinates of the embedding system, usually r,th,phi[KS] or x1,x2,x3[Cartesian]
@@ -170,6 +220,8 @@ public:
     KOKKOS_INLINE_FUNCTION GReal x(const int& k, const int& j, const int& i, const Loci& loc=Loci::center) const;
     KOKKOS_INLINE_FUNCTION GReal y(const int& k, const int& j, const int& i, const Loci& loc=Loci::center) const;
     KOKKOS_INLINE_FUNCTION GReal z(const int& k, const int& j, const int& i, const Loci& loc=Loci::center) const;
+    // Keplerian dynamical time r^(3/2) at a zone center
+    KOKKOS_INLINE_FUNCTION GReal tdyn(const int& j, const int& i) const;
 
     // Transformations using the cached geometry
     KOKKOS_INLINE_FUNCTION void lower(const Real vcon[GR_DIM], Real vcov[GR_DIM],
@@ -178,6 +230,15 @@ public:
                                         const int& k, const int& j, const int& i, const Loci loc) const;
 };
 
+KOKKOS_INLINE_FUNCTION void GRCoordinates::conn_native(const GReal X[GR_DIM], Real conn[GR_DIM][GR_DIM][GR_DIM]) const
+{
+    if (exact_connections) {
+        coords.conn_native_exact(X, CONN_DELTA, conn);
+    } else {
+        coords.conn_native(X, CONN_DELTA, conn);
+    }
+}
+
 /**
  * Function to return native coordinates on the GRCoordinates
  */
@@ -288,7 +349,7 @@ KOKKOS_INLINE_FUNCTION Real GRCoordinates::conn(const int& j, const int& i, cons
 {
     GReal X[GR_DIM], conn[GR_DIM][GR_DIM][GR_DIM];
     coord(0, j, i, Loci::center, X);
-    coords.conn_native(X, conn);
+    conn_native(X, conn);
     return conn[mu][nu][lam];
 }
 
@@ -308,28 +369,129 @@ KOKKOS_INLINE_FUNCTION void GRCoordinates::conn(const int& j, const int& i, Real
 {
     GReal X[GR_DIM];
     coord(0, j, i, Loci::center, X);
-    coords.conn_native(X, conn);
+    conn_native(X, conn);
 }
 #else
+// Each quantity is either constant (flat_cartesian), loaded from the cache, or computed,
+// per the compute_* flags.  These are uniform over a kernel, so the branches cost very little
 KOKKOS_INLINE_FUNCTION Real GRCoordinates::gcon(const Loci loc, const int& j, const int& i, const int mu, const int nu) const
-{ return gcon_direct(loc, j, i, mu, nu); }
+{
+    if (flat_cartesian) return -2*(mu == 0 && nu == 0) + (mu == nu);
+    if (compute_gcon) {
+        GReal X[GR_DIM], gcon[GR_DIM][GR_DIM];
+        coord(0, j, i, loc, X);
+        coords.gcon_native(X, gcon);
+        return gcon[mu][nu];
+    }
+    return gcon_direct(j, loc, i, sym_index(mu, nu));
+}
 KOKKOS_INLINE_FUNCTION Real GRCoordinates::gcov(const Loci loc, const int& j, const int& i, const int mu, const int nu) const
-{ return gcov_direct(loc, j, i, mu, nu); }
+{
+    if (flat_cartesian) return -2*(mu == 0 && nu == 0) + (mu == nu);
+    if (compute_gcov) {
+        GReal X[GR_DIM], gcov[GR_DIM][GR_DIM];
+        coord(0, j, i, loc, X);
+        coords.gcov_native(X, gcov);
+        return gcov[mu][nu];
+    }
+    return gcov_direct(j, loc, i, sym_index(mu, nu));
+}
 KOKKOS_INLINE_FUNCTION Real GRCoordinates::gdet(const Loci loc, const int& j, const int& i) const
-{ return gdet_direct(loc, j, i); }
+{
+    if (flat_cartesian) return 1;
+    if (compute_gdet) {
+        GReal X[GR_DIM];
+        coord(0, j, i, loc, X);
+        return coords.gdet_native(X);
+    }
+    return gdet_direct(j, loc, i);
+}
 KOKKOS_INLINE_FUNCTION Real GRCoordinates::conn(const int& j, const int& i, const int mu, const int nu, const int lam) const
-{ return conn_direct(j, i, mu, nu, lam); }
+{
+    if (flat_cartesian) return 0;
+    if (compute_conn) {
+        GReal X[GR_DIM], conn[GR_DIM][GR_DIM][GR_DIM];
+        coord(0, j, i, Loci::center, X);
+        conn_native(X, conn);
+        return conn[mu][nu][lam];
+    }
+    return conn_direct(j, i, mu, sym_index(nu, lam));
+}
 KOKKOS_INLINE_FUNCTION Real GRCoordinates::gdet_conn(const int& j, const int& i, const int mu, const int nu, const int lam) const
-{ return gdet_conn_direct(j, i, mu, nu, lam); }
+{
+    if (flat_cartesian) return 0;
+    if (compute_conn) {
+        GReal X[GR_DIM], conn[GR_DIM][GR_DIM][GR_DIM];
+        coord(0, j, i, Loci::center, X);
+        conn_native(X, conn);
+        return coords.gdet_native(X) * conn[mu][nu][lam];
+    }
+    return gdet_conn_direct(j, i, mu, sym_index(nu, lam));
+}
 
+// Unpack each unique component once, into both symmetric positions
 KOKKOS_INLINE_FUNCTION void GRCoordinates::gcon(const Loci loc, const int& j, const int& i, Real gcon[GR_DIM][GR_DIM]) const
-{ DLOOP2 gcon[mu][nu] = gcon_direct(loc, j, i, mu, nu); }
+{
+    if (flat_cartesian) {
+        DLOOP2 gcon[mu][nu] = -2*(mu == 0 && nu == 0) + (mu == nu);
+        return;
+    }
+    if (compute_gcon) {
+        GReal X[GR_DIM];
+        coord(0, j, i, loc, X);
+        coords.gcon_native(X, gcon);
+        return;
+    }
+    DLOOP1 for (int nu = mu; nu < GR_DIM; ++nu)
+        gcon[mu][nu] = gcon[nu][mu] = gcon_direct(j, loc, i, sym_index(mu, nu));
+}
 KOKKOS_INLINE_FUNCTION void GRCoordinates::gcov(const Loci loc, const int& j, const int& i, Real gcov[GR_DIM][GR_DIM]) const
-{ DLOOP2 gcov[mu][nu] = gcov_direct(loc, j, i, mu, nu); }
+{
+    if (flat_cartesian) {
+        DLOOP2 gcov[mu][nu] = -2*(mu == 0 && nu == 0) + (mu == nu);
+        return;
+    }
+    if (compute_gcov) {
+        GReal X[GR_DIM];
+        coord(0, j, i, loc, X);
+        coords.gcov_native(X, gcov);
+        return;
+    }
+    DLOOP1 for (int nu = mu; nu < GR_DIM; ++nu)
+        gcov[mu][nu] = gcov[nu][mu] = gcov_direct(j, loc, i, sym_index(mu, nu));
+}
 KOKKOS_INLINE_FUNCTION void GRCoordinates::conn(const int& j, const int& i, Real conn[GR_DIM][GR_DIM][GR_DIM]) const
-{ DLOOP3 conn[mu][nu][lam] = conn_direct(j, i, mu, nu, lam); }
+{
+    if (flat_cartesian) {
+        DLOOP3 conn[mu][nu][lam] = 0;
+        return;
+    }
+    if (compute_conn) {
+        GReal X[GR_DIM];
+        coord(0, j, i, Loci::center, X);
+        conn_native(X, conn);
+        return;
+    }
+    DLOOP2 for (int lam = nu; lam < GR_DIM; ++lam)
+        conn[mu][nu][lam] = conn[mu][lam][nu] = conn_direct(j, i, mu, sym_index(nu, lam));
+}
 KOKKOS_INLINE_FUNCTION void GRCoordinates::gdet_conn(const int& j, const int& i, Real gdet_conn[GR_DIM][GR_DIM][GR_DIM]) const
-{ DLOOP3 gdet_conn[mu][nu][lam] = gdet_conn_direct(j, i, mu, nu, lam); }
+{
+    if (flat_cartesian) {
+        DLOOP3 gdet_conn[mu][nu][lam] = 0;
+        return;
+    }
+    if (compute_conn) {
+        GReal X[GR_DIM];
+        coord(0, j, i, Loci::center, X);
+        conn_native(X, gdet_conn);
+        const GReal gdet = coords.gdet_native(X);
+        DLOOP3 gdet_conn[mu][nu][lam] *= gdet;
+        return;
+    }
+    DLOOP2 for (int lam = nu; lam < GR_DIM; ++lam)
+        gdet_conn[mu][nu][lam] = gdet_conn[mu][lam][nu] = gdet_conn_direct(j, i, mu, sym_index(nu, lam));
+}
 
 #endif
 
@@ -416,3 +578,14 @@ KOKKOS_INLINE_FUNCTION GReal GRCoordinates::z(const int& k, const int& j, const
 }
 
 #endif
+
+KOKKOS_INLINE_FUNCTION GReal GRCoordinates::tdyn(const int& j, const int& i) const
+{
+#if !FAST_CARTESIAN && !NO_CACHE
+    if (cache_tdyn) return tdyn_direct(j, i);
+#endif
+    GReal Xembed[GR_DIM];
+    coord_embed(0, j, i, Loci::center, Xembed);
+    const GReal r = Xembed[1];
+    return m::sqrt(r*r*r);
+}
@@ -1,5 +1,5 @@
 /* 
- *  File: coordinate_systems.hpp
+ *  File: root_find.hpp
  *  
  *  BSD 3-Clause License
  *  
@@ -45,13 +45,17 @@
  * TODO I cannot find a remotely simple way to do this with templates or function pointers:
  *      if this is taken out of the enclosing scope we need to resolve coord_to_embed, which is haaaard
  * 
- * Takes names Xembed (filled, not modified), Xnative (filled, modifies X[2]), and calls function coord_to_embed
+ * Takes names Xembed (filled, not modified), Xnative (filled, modifies X[2]), and calls functions
+ * coord_to_embed and dxdX.
+ * Newton steps from the uniform-grid guess th/pi converge in a few iterations for all the
+ * grids we use, so zones take near-uniform time.  Steps leaving the bracket fall back to bisection.
  */
 #define ROOT_FIND \
     double th = Xembed[2];\
     double tha, thb, thc;\
 \
     double Xa[GR_DIM], Xb[GR_DIM], Xc[GR_DIM], Xtmp[GR_DIM];\
+    Real dxdX_tmp[GR_DIM][GR_DIM];\
     Xa[1] = Xnative[1];\
     Xa[3] = Xnative[3];\
 \
@@ -76,13 +80,18 @@
     } else if (m::abs(thb-th) < ROOTFIND_TOL) {\
         Xnative[2] = Xb[2]; return;\
     }\
+    Xc[2] = th / M_PI;\
+    if (!(Xc[2] > Xa[2] && Xc[2] < Xb[2])) Xc[2] = 0.5 * (Xa[2] + Xb[2]);\
     for (int i = 0; i < 1000; i++) {\
-        Xc[2] = 0.5 * (Xa[2] + Xb[2]);\
         coord_to_embed(Xc, Xtmp); thc = Xtmp[2];\
 \
         if (m::abs(thc - th) < ROOTFIND_TOL) break;\
         else if ((thc - th) * (thb - th) < 0.) Xa[2] = Xc[2];\
         else Xb[2] = Xc[2];\
+\
+        dxdX(Xc, dxdX_tmp);\
+        const double Xn = Xc[2] - (thc - th) / dxdX_tmp[2][2];\
+        Xc[2] = (Xn > m::min(Xa[2], Xb[2]) && Xn < m::max(Xa[2], Xb[2])) ? Xn : 0.5 * (Xa[2] + Xb[2]);\
     }\
     Xnative[2] = Xc[2];
 
@@ -91,6 +100,7 @@
     double ra, rb, rc;\
 \
     double Xa[GR_DIM], Xb[GR_DIM], Xc[GR_DIM], Xtmp[GR_DIM];\
+    Real dxdX_tmp[GR_DIM][GR_DIM];\
     Xa[2] = Xnative[2];\
     Xa[3] = Xnative[3];\
 \
@@ -110,12 +120,17 @@
     } else if (m::abs(rb-r) < ROOTFIND_TOL) {\
         Xnative[1] = Xb[1]; return;\
     }\
+    Xc[1] = m::log(r);\
+    if (!(Xc[1] > Xa[1] && Xc[1] < Xb[1])) Xc[1] = 0.5 * (Xa[1] + Xb[1]);\
     for (int i = 0; i < 1000; i++) {\
-        Xc[1] = 0.5 * (Xa[1] + Xb[1]);\
         coord_to_embed(Xc, Xtmp); rc = Xtmp[1];\
 \
         if (m::abs(rc - r) < ROOTFIND_TOL) break;\
         else if ((rc - r) * (rb - r) < 0.) Xa[1] = Xc[1];\
         else Xb[1] = Xc[1];\
+\
+        dxdX(Xc, dxdX_tmp);\
+        const double Xn = Xc[1] - (rc - r) / dxdX_tmp[1][1];\
+        Xc[1] = (Xn > m::min(Xa[1], Xb[1]) && Xn < m::max(Xa[1], Xb[1])) ? Xn : 0.5 * (Xa[1] + Xb[1]);\
     }\
     Xnative[1] = Xc[1];
@@ -50,6 +50,21 @@ std::shared_ptr<KHARMAPackage> Current::Initialize(ParameterInput *pin, std::sha
     pkg->AddField("Current.uvec_c", m);
     pkg->AddField("Current.B_P_c", m);
 
+    // Output blocks which include jcon, to tell whether we need to preserve the state on a given step
+    std::vector<std::string> output_blocks;
+    InputBlock *pib = pin->pfirst_block;
+    while (pib != nullptr) {
+        if (pib->block_name.find("parthenon/output") != std::string::npos &&
+            pin->DoesParameterExist(pib->block_name, "variables") &&
+            pin->GetString(pib->block_name, "variables").find("jcon") != std::string::npos) {
+            output_blocks.push_back(pib->block_name);
+        }
+        pib = pib->pnext;
+    }
+    params.Add("output_blocks", output_blocks);
+    // Start time of the step when "preserve" was last copied, set by the driver
+    params.Add("preserve_time", -1.0, true);
+
     pkg->BlockUserWorkBeforeOutput = Current::FillOutput;
 
     return pkg;
@@ -114,10 +129,34 @@ TaskStatus Current::CalculateCurrent(MeshBlockData<Real> *rc0, MeshBlockData<Rea
     return TaskStatus::complete;
 }
 
+bool Current::OutputDue(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    // Parthenon makes outputs after the step, at the incremented time and cycle.
+    // A final output is always written when hitting tlim or nlim
+    const Real t_end = tm.time + tm.dt;
+    const int ncycle_end = tm.ncycle + 1;
+    if (t_end >= tm.tlim || (tm.nlim >= 0 && ncycle_end >= tm.nlim)) return true;
+
+    // Otherwise, check each output's schedule, which Parthenon keeps in the input parameters
+    const auto& output_blocks = pmesh->packages.Get("Current")->Param<std::vector<std::string>>("output_blocks");
+    for (const auto& block : output_blocks) {
+        if (pin->DoesParameterExist(block, "dn")) {
+            const int dn = pin->GetInteger(block, "dn");
+            if (dn > 0 && ncycle_end % dn == 0) return true;
+        }
+        if (pin->DoesParameterExist(block, "dt") && pin->GetReal(block, "dt") > 0) {
+            // Be conservative if the output hasn't recorded its next time
+            if (!pin->DoesParameterExist(block, "next_time") || t_end >= pin->GetReal(block, "next_time"))
+                return true;
+        }
+    }
+    return false;
+}
+
 void Current::FillOutput(MeshBlock *pmb, ParameterInput *pin)
 {
-    // The "preserve" container will only exist after we've taken a step,
-    // catch that situation
+    // The "preserve" container will only exist after we've taken a step
+    // ending in a jcon output, catch that situation
     auto& rc1 = pmb->meshblock_data.Get();
     auto rc0 = rc1; // Avoid writing rc0's type when initializing. Still light.
     try {
@@ -130,9 +169,12 @@ void Current::FillOutput(MeshBlock *pmb, ParameterInput *pin)
         return;
     }
 
-    // Get the duration of the last timestep from the "Globals" package
-    // (see kharma.cpp)
-    Real dt_last = pmb->packages.Get("Globals")->Param<Real>("dt_last");
+    // The "preserve" container is only copied before steps ending in a jcon output,
+    // so check it actually holds the beginning of the last step
+    // Both time and dt_last are set from the last step in KHARMA::PostStepWork (see kharma.cpp)
+    auto& globals = pmb->packages.Get("Globals")->AllParams();
+    if (pmb->packages.Get("Current")->Param<double>("preserve_time") != globals.Get<double>("time")) return;
+    Real dt_last = globals.Get<double>("dt_last");
 
     Current::CalculateCurrent(rc0.get(), rc1.get(), dt_last);
 }
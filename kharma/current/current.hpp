@@ -46,6 +46,18 @@ namespace Current
  */
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
+/**
+ * Variables CalculateCurrent needs from the beginning of the step, kept in the "preserve" container
+ */
+static const std::vector<std::string> preserve_vars = {"prims.uvec", "prims.B"};
+
+/**
+ * Whether an output including jcon will be written at the end of the step starting at 'tm'.
+ * The driver only copies the "preserve" state on these steps.
+ * Outputs which can't be predicted (e.g. on a wall-time limit or signal) will not include jcon.
+ */
+bool OutputDue(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
 /**
  * Fill outputs, namely jcon.  Just calls CalculateCurrent below.
  */
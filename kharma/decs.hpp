@@ -46,6 +46,9 @@
 
 // KHARMA INCLUDES
 // Standard libs we absolutely need everywhere
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -75,9 +78,19 @@ namespace m = std;
 
 // Parthenon stole our type names
 // Lots of work will need to be done for Real != double
+// (see "single" in make.sh: fields are then stored *and* computed in float)
 using parthenon::Real;
 using GReal = double;
 
+/**
+ * Iterative solver tolerances are stated for double precision.  In single-precision builds,
+ * loosen any that would be tighter than the arithmetic can reach.  Unchanged for Real == double
+ */
+inline double PrecisionTolerance(const double& tol)
+{
+    return std::max(tol, 100. * std::numeric_limits<Real>::epsilon());
+}
+
 // A small number, compared to the grid or problem scale
 #define SMALL 1e-20
 
@@ -40,6 +40,7 @@
 #include "b_cleanup.hpp"
 #include "b_ct.hpp"
 #include "b_flux_ct.hpp"
+#include "current.hpp"
 #include "electrons.hpp"
 #include "inverter.hpp"
 #include "grmhd.hpp"
@@ -48,6 +49,7 @@
 #include "boundaries.hpp"
 #include "flux.hpp"
 #include "kharma.hpp"
+#include "reductions.hpp"
 #include "resize_restart.hpp"
 #include "implicit.hpp"
 
@@ -68,6 +70,8 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
     auto& flux_pkg   = pkgs.at("Flux")->AllParams();
     const bool use_b_cleanup = pkgs.count("B_Cleanup");
     const bool use_b_ct = pkgs.count("B_CT");
+    // Whether EMFs are calculated & sync'd separately, or in the face update (see B_CT::UseFusedUpdate)
+    const bool split_ct = use_b_ct && !B_CT::UseFusedUpdate(pmesh);
     const bool use_electrons = pkgs.count("Electrons");
     const bool use_fofc = flux_pkg.Get<bool>("use_fofc");
     const bool use_implicit = pkgs.count("Implicit");
@@ -75,6 +79,7 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
     const bool use_linesearch = (use_implicit) ? pkgs.at("Implicit")->Param<bool>("linesearch") : false;
     const bool emhd_enabled = pkgs.count("EMHD");
     const bool use_ideal_guess = (emhd_enabled) ? pkgs.at("GRMHD")->Param<bool>("ideal_guess") : false;
+    const bool overlap_implicit = use_implicit && pkgs.at("Driver")->Param<bool>("overlap_implicit");
 
     // Allocate/copy the things we need
     // TODO these can now be reduced by including the var lists/flags which actually need to be allocated
@@ -85,23 +90,23 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         pmesh->mesh_data.Add("dUdt");
         for (int i = 1; i < integrator->nstages; i++)
             pmesh->mesh_data.Add(integrator->stage_name[i]);
-        // Preserve state for time derivatives if we need to output current
-        if (use_jcon) {
-            pmesh->mesh_data.Add("preserve");
-            // Above only copies on allocate -- ensure we copy the MHD variables every step with a task
-            std::vector<MetadataFlag> vars_jcon_needs = {Metadata::GetUserFlag("MHD"), Metadata::GetUserFlag("Primitive")};
+        // Preserve state for time derivatives if we need to output current.
+        // Only the vectors jcon needs are allocated, and they're only copied on steps ending in a jcon output
+        if (use_jcon && Current::OutputDue(pmesh, pinput, tm)) {
+            pmesh->mesh_data.Add("preserve", base, Current::preserve_vars);
+            pkgs.at("Current")->AllParams().Update<double>("preserve_time", tm.time);
+            const std::vector<std::string> vars_jcon_needs = Current::preserve_vars;
             const int num_partitions = pmesh->DefaultNumPartitions();
             TaskRegion &copy_region = tc.AddRegion(num_partitions);
             for (int i = 0; i < num_partitions; i++) {
                 auto &tl = copy_region[i];
-                tl.AddTask(t_none, Copy<MeshData<Real>>, vars_jcon_needs,
+                tl.AddTask(t_none, CopyVars<MeshData<Real>>, vars_jcon_needs,
                             base.get(), pmesh->mesh_data.Get("preserve").get());
             }
         }
         // FOFC needs to determine whether the "real" U-divF will violate floors, and needs a safe place to do it.
         // We populate it later, with each *sub-step*'s initial state
         if (use_fofc) {
-            pmesh->mesh_data.Add("fofc_source");
             pmesh->mesh_data.Add("fofc_guess");
         }
         if (use_implicit) {
@@ -115,16 +120,8 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         }
     }
 
-    static std::vector<std::string> sync_vars;
-    if (sync_vars.size() == 0) {
-        // Build the universe of variables to let Parthenon see when exchanging boundaries.
-        // This is built to exclude incidental variables like B field initialization stuff, EMFs, etc.
-        // "Boundaries" packs in buffers e.g. Dirichlet boundaries
-        using FC = Metadata::FlagCollection;
-        auto sync_flags = FC({Metadata::GetUserFlag("Primitive"), Metadata::Conserved,
-                              Metadata::Face, Metadata::GetUserFlag("Boundaries")}, true);
-        sync_vars = KHARMA::GetVariableNames(&(pmesh->packages), sync_flags);
-    }
+    // Exchange only what the following tasks read in ghost zones, see StateSyncVars
+    const auto &sync_vars = StateSyncVars(pmesh->packages);
 
     // Flux region: calculate and apply fluxes to update conserved values
     const int num_partitions = pmesh->DefaultNumPartitions();
@@ -150,9 +147,19 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
 
         // Start receiving flux corrections and ghost cells
         auto t_start_recv_bound = tl.AddTask(t_none, parthenon::StartReceiveBoundBufs<parthenon::BoundaryType::any>, md_sub_step_final);
+        // Print the last step's flag counts as their reductions arrive, overlapping the exchanges below.
+        // Nothing depends on this, so it's retried until complete while other tasks proceed
+        if (stage == 1 && i == 0 && pmesh->packages.Get("Driver")->Param<bool>("async_flags"))
+            tl.AddTask(t_none, WaitTimer::PolledTask<Reductions::CheckDeferredFlagReduces>::Run, md_sub_step_init.get());
         auto t_start_recv_flux = t_start_recv_bound;
-        if (pmesh->multilevel || use_b_ct)
+        if (pmesh->multilevel || split_ct)
             t_start_recv_flux = tl.AddTask(t_none, parthenon::StartReceiveFluxCorrections, md_sub_step_init);
+        // Container of only the EMFs, to synchronize between computing them & the flux corrections
+        std::shared_ptr<MeshData<Real>> md_emf_only;
+        if (split_ct) {
+            md_emf_only = KHARMADriver::EMFSyncData(pmesh, md_sub_step_init, i);
+            tl.AddTask(t_none, parthenon::StartReceiveBoundBufs<parthenon::BoundaryType::any>, md_emf_only);
+        }
 
         // Calculate the flux of each variable through each face
         // This reconstructs the primitives (P) at faces and uses them to calculate fluxes
@@ -160,10 +167,11 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         auto t_flux_calc = KHARMADriver::AddFluxCalculations(t_start_recv_flux, tl, md_sub_step_init.get());
         auto t_fluxes = t_flux_calc;
         if (use_fofc) {
-            auto &guess_src = pmesh->mesh_data.GetOrAdd("fofc_source", i);
+            // The guess's source term is finished with before the real flux divergence is taken,
+            // so it borrows md_flux_src rather than keeping a container of its own
             auto &guess = pmesh->mesh_data.GetOrAdd("fofc_guess", i);
-            auto t_fluxes = KHARMADriver::AddFOFC(t_flux_calc, tl, md_sub_step_init.get(), md_full_step_init.get(),
-                                                  md_sub_step_init.get(), guess_src.get(), guess.get(), stage);
+            t_fluxes = KHARMADriver::AddFOFC(t_flux_calc, tl, md_sub_step_init.get(), md_full_step_init.get(),
+                                             md_sub_step_init.get(), md_flux_src.get(), guess.get(), stage);
         }
 
         // Any package modifications to the fluxes.  e.g.:
@@ -174,22 +182,20 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
 
         // If we're in AMR, correct fluxes from neighbors
         auto t_flux_bounds = t_fix_flux;
-        if (pmesh->multilevel || use_b_ct) {
+        if (pmesh->multilevel || split_ct) {
             auto t_emf = t_flux_bounds;
-            if (use_b_ct) {
-                // Pull out a container of only EMF to synchronize
-                auto &md_emf_only = pmesh->mesh_data.AddShallow("EMF", std::vector<std::string>{"B_CT.emf"}); // TODO this gets weird if we partition
+            if (split_ct) {
                 auto t_emf_local = tl.AddTask(t_flux_bounds, B_CT::CalculateEMF, md_sub_step_init.get());
-                t_emf = KHARMADriver::AddBoundarySync(t_emf_local, tl, md_emf_only);
+                t_emf = KHARMADriver::AddEMFSync(t_emf_local, tl, md_emf_only);
             }
             auto t_load_send_flux = tl.AddTask(t_emf, parthenon::LoadAndSendFluxCorrections, md_sub_step_init);
-            auto t_recv_flux = tl.AddTask(t_load_send_flux, parthenon::ReceiveFluxCorrections, md_sub_step_init);
+            auto t_recv_flux = tl.AddTask(t_load_send_flux, WaitTimer::PolledTask<parthenon::ReceiveFluxCorrections>::Run, md_sub_step_init);
             t_flux_bounds = tl.AddTask(t_recv_flux, parthenon::SetFluxCorrections, md_sub_step_init);
         }
 
         // Apply the fluxes to calculate a change in cell-centered values "md_flux_src"
-        auto t_flux_div = tl.AddTask(t_flux_bounds, FluxDivergence, md_sub_step_init.get(), md_flux_src.get(),
-                                     std::vector<MetadataFlag>{Metadata::Independent, Metadata::Cell, Metadata::WithFluxes}, 0);
+        // Optionally, the bulk of each block is done while the corrections above are in flight
+        auto t_flux_div = KHARMADriver::AddFluxDivergence(t_fix_flux, t_flux_bounds, tl, md_sub_step_init.get(), md_flux_src.get());
 
         // Add any source terms: geometric \Gamma * T, wind, damping, etc etc
         auto t_sources = tl.AddTask(t_flux_div, Packages::AddSource, md_sub_step_init.get(), md_flux_src.get(), IndexDomain::interior);
@@ -251,8 +257,11 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
             // Time-step implicit variables by root-finding the residual.
             // This calculates the primitive values after the substep for all "isImplicit" variables --
             // no need for separately adding the flux divergence or calling UtoP
+            // If overlapping, this solves just the rind, and the bulk is solved below
+            const auto first_region = (overlap_implicit) ? Implicit::SolveRegion::rind : Implicit::SolveRegion::all;
             auto t_implicit_step = tl.AddTask(t_copy_linesearch, Implicit::Step, md_full_step_init.get(), md_sub_step_init.get(),
-                                         md_flux_src.get(), md_linesearch.get(), md_solver.get(), integrator->beta[stage-1] * integrator->dt);
+                                         md_flux_src.get(), md_linesearch.get(), md_solver.get(), integrator->beta[stage-1] * integrator->dt,
+                                         first_region);
 
             // Copy the entire solver state (everything defined on the grid, incl. our new Face variables) into the final state md_sub_step_final
             // If we're entirely explicit, we just declare these equal
@@ -269,6 +278,18 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         auto t_floors = tl.AddTask(t_implicit, Packages::MeshApplyFloors, md_sub_step_final.get(), IndexDomain::interior);
 
         KHARMADriver::AddBoundarySync(t_floors, tl, md_sync);
+
+        if (overlap_implicit) {
+            // The rind is final, and its exchange is underway.  Solve the bulk of each block meanwhile,
+            // then copy it in and apply floors again.  This re-floors the rind too, which should change
+            // it by roundoff at most.  Nothing here touches the ghost zones, so it needn't wait on the sync.
+            std::shared_ptr<MeshData<Real>> &md_linesearch = (use_linesearch) ? pmesh->mesh_data.GetOrAdd("linesearch", i) : md_solver;
+            auto t_bulk_step = tl.AddTask(t_floors, Implicit::Step, md_full_step_init.get(), md_sub_step_init.get(),
+                                         md_flux_src.get(), md_linesearch.get(), md_solver.get(), integrator->beta[stage-1] * integrator->dt,
+                                         Implicit::SolveRegion::bulk);
+            auto t_bulk_c = tl.AddTask(t_bulk_step, Implicit::CopyBulk, md_solver.get(), md_sub_step_final.get());
+            tl.AddTask(t_bulk_c, Packages::MeshApplyFloors, md_sub_step_final.get(), IndexDomain::interior);
+        }
     }
 
     // Fix Region: prims/cons sync, floors, fixes, boundary conditions which need primitives
@@ -295,7 +316,7 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         }
 
         // Re-apply boundary conditions to reflect fixes
-        auto t_set_bc = tl.AddTask(t_fix_solve, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md_sync, false);
+        auto t_set_bc = tl.AddTask(t_fix_solve, KBoundaries::ApplyBoundariesMesh, md_sync, false);
 
         // Any package- (likely, problem-) specific source terms which must be applied to primitive variables
         // Apply these only after the final step so they're operator-split
@@ -313,7 +334,10 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         // Make sure *all* conserved vars are synchronized at step end
         auto t_ptou = tl.AddTask(t_heat_electrons, Flux::MeshPtoU, md_sub_step_final.get(), IndexDomain::entire, false);
 
+        // Primitives are final for this substep, so optionally cache their FourVectors for the next
         auto t_step_done = t_ptou;
+        if (pmesh->packages.Get("GRMHD")->Param<bool>("cache_fourvectors"))
+            t_step_done = tl.AddTask(t_ptou, GRMHD::CacheFourVectors, md_sub_step_final.get());
 
         // Estimate next time step based on ctop
         if (stage == integrator->nstages) {
@@ -328,6 +352,9 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
         }
     }
 
+    // Optionally start reducing the next timestep now, so it can overlap the rest of the step
+    if (stage == integrator->nstages) AddTimestepReductionRegion(tc);
+
     // B Field cleanup: this is a separate solve so it's split out
     // It's also really slow when enabled so we don't care too much about limiting regions, etc.
     if (use_b_cleanup && (stage == integrator->nstages) && B_Cleanup::CleanupThisStep(pmesh, tm.ncycle)) {
@@ -345,11 +372,7 @@ TaskCollection KHARMADriver::MakeImExTaskCollection(BlockList_t &blocks, int sta
     // modified on each rank.
     const auto &two_sync = pkgs.at("Driver")->Param<bool>("two_sync");
     if (two_sync) {
-        for (int i = 0; i < num_partitions; i++) {
-            auto &md_sub_step_final = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage], i);
-            auto &md_sync = pmesh->mesh_data.AddShallow("sync"+integrator->stage_name[stage]+std::to_string(i), md_sub_step_final, sync_vars);
-            KHARMADriver::AddFullSyncRegion(tc, md_sync);
-        }
+        KHARMADriver::AddFullSyncRegion(tc, integrator->stage_name[stage], sync_vars);
     }
 
     return tc;
@@ -36,9 +36,35 @@
 
 #include "b_ct.hpp"
 #include "boundaries.hpp"
+#include "electrons.hpp"
 #include "flux.hpp"
 #include "get_flux.hpp"
 #include "inverter.hpp"
+#include "ismr.hpp"
+#include "kharma.hpp"
+#include "reductions.hpp"
+
+namespace {
+
+/**
+ * parthenon::AddBoundaryExchangeTasks, spelled out when timing MPI waits so the receive can be wrapped
+ */
+TaskID AddExchangeTasks(const TaskID t_start, TaskList &tl, std::shared_ptr<MeshData<Real>> &md, bool multilevel)
+{
+    if (!WaitTimer::enabled) return parthenon::AddBoundaryExchangeTasks(t_start, tl, md, multilevel);
+    using parthenon::BoundaryType;
+    tl.AddTask(t_start, parthenon::SendBoundBufs<BoundaryType::any>, md);
+    auto t_recv = tl.AddTask(t_start, WaitTimer::PolledTask<parthenon::ReceiveBoundBufs<BoundaryType::any>>::Run, md);
+    auto t_set = tl.AddTask(t_recv, parthenon::SetBounds<BoundaryType::any>, md);
+    auto t_prolong = t_set;
+    if (multilevel) {
+        auto t_cbound = tl.AddTask(t_set, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md, true);
+        t_prolong = tl.AddTask(t_cbound, parthenon::ProlongateBounds<BoundaryType::any>, md);
+    }
+    return tl.AddTask(t_prolong, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md, false);
+}
+
+} // namespace
 
 std::shared_ptr<KHARMAPackage> KHARMADriver::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
 {
@@ -71,17 +97,155 @@ std::shared_ptr<KHARMAPackage> KHARMADriver::Initialize(ParameterInput *pin, std
     params.Add("type", driver_type);
     params.Add("name", driver_type_s);
 
+    // Optionally replace parthenon/time/integrator with a 2-register low-storage SSP scheme, see SetLowStorageIntegrator.
+    // "ssprk3" is the Shu-Osher SSPRK(3,3), which needs one less copy of the mesh than Parthenon's "rk3".
+    // "ssprk104" is Ketcheson's SSPRK(10,4): 4th order with an SSP coefficient of 6, so it can be
+    // run at cfl up to ~6x that of rk2, for 10 stages.  Both update the intermediate stages in place.
+    std::vector<std::string> valid_low_storage = {"none", "ssprk3", "ssprk104"};
+    std::string low_storage = pin->GetOrAddString("driver", "low_storage", "none", valid_low_storage);
+    if (low_storage != "none") {
+        if (driver_type != DriverType::kharma)
+            throw std::invalid_argument("Low-storage integrators are only supported with the KHARMA driver!");
+        // Heating needs the state at the start of each substep, which these overwrite
+        if (pin->GetOrAddBoolean("electrons", "on", false))
+            throw std::invalid_argument("Low-storage integrators cannot be used with electron heating!");
+    }
+    params.Add("low_storage", low_storage);
+
+    // Print the timestep each refinement level would allow, and the fraction of zone-updates
+    // per-level subcycling could save.  Purely diagnostic: all levels still take the global step
+    bool report_level_dt = pin->GetOrAddBoolean("driver", "report_level_dt", false);
+    params.Add("report_level_dt", report_level_dt);
+
+    // Start the reduction of the next timestep as soon as it is estimated, rather than blocking on
+    // it in SetGlobalTimeStep.  Not used with AMR, since refinement changes the limits afterward
+    bool async_dt = pin->GetOrAddBoolean("driver", "async_dt", false);
+    params.Add("async_dt", async_dt);
+    params.Add("dt_reduction_started", false, true);
+    // Likewise, print the flag counts of each step once their reductions arrive during the next step,
+    // rather than waiting on them at the end of the step.  Needs a driver which schedules the check
+    bool async_flags = pin->GetOrAddBoolean("driver", "async_flags", false) && driver_type != DriverType::simple;
+    params.Add("async_flags", async_flags);
+
+    // Write <problem_id>.kharma_perf.json at the end of the run: zone-cycles, wall time, and a nominal count of the
+    // bytes each phase (flux, EMF, inversion, ...) touches per zone-update.  scripts/read_performance_json.py
+    // combines this with Kokkos' kernel timings to report seconds and effective bandwidth for each phase.
+    bool performance_json = pin->GetOrAddBoolean("driver", "performance_json", false);
+    params.Add("performance_json", performance_json);
+
+    // Recompute U at the end of each substep only for zones where the inversion failed or floors were hit,
+    // rather than over the whole mesh.  Changes results at the level of the inversion tolerance
+    bool selective_ptou = pin->GetOrAddBoolean("driver", "selective_ptou", false);
+    params.Add("selective_ptou", selective_ptou);
+
+    // Write only the conserved state to restart files, leaving out the GRMHD primitives.
+    // These are recovered by inverting when restarting, see KHARMA::PostInitialize,
+    // which requires an inverter needing no initial guess
+    bool compact_restart = pin->GetOrAddBoolean("driver", "compact_restart", false);
+    params.Add("compact_restart", compact_restart);
+
+    // Balance blocks between ranks by an estimate of their cost, rather than by count.  Kernels run over
+    // whole MeshData at once, so per-block timers mean little on GPUs: instead, the cost of a block is 1 plus
+    // the per-zone extra work it saw -- inversion fixups, floor hits and implicit solver iterations,
+    // each weighted relative to one zone's ordinary explicit update.
+    bool block_costs = pin->GetOrAddBoolean("driver", "block_costs", false);
+    params.Add("block_costs", block_costs);
+    if (block_costs) {
+        // Parthenon only balances by MeshBlock::cost_ when told it is set manually
+        pin->SetString("parthenon/loadbalancing", "balancer", "manual");
+        params.Add("cost_interval", pin->GetOrAddInteger("driver", "cost_interval", 10));
+        params.Add("cost_fixup", pin->GetOrAddReal("driver", "cost_fixup", 4.0));
+        params.Add("cost_floor", pin->GetOrAddReal("driver", "cost_floor", 1.0));
+        params.Add("cost_implicit_iter", pin->GetOrAddReal("driver", "cost_implicit_iter", 2.0));
+        pkg->PostStepWork = KHARMADriver::UpdateBlockCosts;
+    }
+
+    // On static meshes, exchange ghost zones through Parthenon's combined buffers: one message per pair
+    // of neighboring ranks, with buffers allocated once and reused until the mesh changes, rather than
+    // one message (and its setup) per block boundary.
+    // KHARMA's own exchanges (e.g. multi-block transmitting poles) use persistent requests regardless.
+    const bool static_mesh = pin->GetOrAddString("parthenon/mesh", "refinement", "none") == "none";
+    bool combined_comms = pin->GetOrAddBoolean("driver", "combined_comms", false);
+    if (combined_comms && !static_mesh)
+        throw std::invalid_argument("Combined communication buffers are only supported on static meshes!");
+    if (combined_comms)
+        pin->SetBoolean("parthenon/mesh", "do_combined_comms", true);
+    params.Add("combined_comms", combined_comms);
+
+    // Fuse the simple driver's steps as far as dependencies allow, for ideal GRMHD with Flux-CT only.
+    // Meant as a reference for the attainable throughput, best combined with <flux> fused_directions
+    bool simple_fused = pin->GetOrAddBoolean("driver", "simple_fused", false);
+    if (simple_fused && driver_type != DriverType::simple)
+        throw std::invalid_argument("The fused driver variant requires <driver> type = simple!");
+    params.Add("simple_fused", simple_fused);
+
+    // Temporal blocking of the fused simple driver, for flat-space Cartesian problems on uniform meshes.
+    // Ghost zones are exchanged only once per step: earlier stages are also computed over a halo of ghost
+    // zones, which shrinks by the width of one stage's stencil at each stage, so that the final stage has
+    // the same inputs (and results) as if every stage had been synchronized.
+    // Requires extra ghost zones, e.g. <driver> nghost = 5 for RK2 with linear reconstructions, or 8 with WENO5.
+    // This trades each intermediate boundary exchange for extra work in the halo, so it is a gain mostly when
+    // the exchanges themselves are expensive, i.e. for many small blocks, or many ranks
+    bool temporal_blocking = pin->GetOrAddBoolean("driver", "temporal_blocking", false);
+    if (temporal_blocking) {
+        if (!simple_fused)
+            throw std::invalid_argument("Temporal blocking requires <driver> simple_fused = true!");
+        if (!static_mesh)
+            throw std::invalid_argument("Temporal blocking is only supported on meshes without refinement!");
+        // Only the fused flux kernels compute fluxes in a halo
+        pin->GetOrAddBoolean("flux", "fused", true);
+    }
+    params.Add("temporal_blocking", temporal_blocking);
+
+    // Cache-blocked execution for CPU backends.  Each mesh partition is a single block, so that the flux
+    // region (fluxes, divergence, sources, update) and then the fix region (UtoP, floors, fixups, PtoU)
+    // run through one block after another, each while it is still in cache, rather than every stage
+    // streaming the whole rank's blocks from memory.  The stages are fused where compatible.
+    // Blocks are the tiles, with their ghost zones as the halos: make them small, e.g. 16^3-32^3
+    bool cache_blocked = pin->GetOrAddBoolean("driver", "cache_blocked", false);
+    if (cache_blocked) {
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP) || defined(KOKKOS_ENABLE_SYCL)
+        throw std::invalid_argument("Cache-blocked execution is only for CPU builds!");
+#endif
+        pin->SetInteger("parthenon/mesh", "pack_size", 1);
+        const bool fused_ok = !pin->GetOrAddBoolean("fofc", "on", false) &&
+                              !pin->GetOrAddBoolean("boundaries", "excise_polar_flux", false);
+        pin->GetOrAddBoolean("flux", "fused", fused_ok);
+        pin->GetOrAddBoolean("flux", "fuse_divergence", fused_ok);
+        pin->GetOrAddBoolean("inverter", "fuse_floors_fixup", true);
+        const int nzones_block = pin->GetOrAddInteger("parthenon/meshblock", "nx1", pin->GetInteger("parthenon/mesh", "nx1")) *
+                                 pin->GetOrAddInteger("parthenon/meshblock", "nx2", pin->GetInteger("parthenon/mesh", "nx2")) *
+                                 pin->GetOrAddInteger("parthenon/meshblock", "nx3", pin->GetInteger("parthenon/mesh", "nx3"));
+        if (nzones_block > 32*32*32 && MPIRank0())
+            std::cerr << "WARNING: cache-blocked execution with large blocks (" << nzones_block
+                      << " zones) will not stay in cache.  Try parthenon/meshblock sizes of 16-32" << std::endl;
+    }
+    params.Add("cache_blocked", cache_blocked);
+
     // Synchronize boundary variables twice. Ensures KHARMA is agnostic to the breakdown
     // of meshblocks, at the cost of twice the MPI overhead, for potentially worse strong scaling.
     // On by default, disable only after testing that, e.g., divB meets your requirements
     bool two_sync = pin->GetOrAddBoolean("driver", "two_sync", true);
     params.Add("two_sync", two_sync);
 
+    // With the ImEx driver, solve the rind of each block (the zones its neighbors need) first,
+    // and start the boundary exchange while solving the bulk.  This applies floors to the rind twice,
+    // so its ghost zones may differ by roundoff until the second sync (see two_sync).
+    bool overlap_implicit = pin->GetOrAddBoolean("driver", "overlap_implicit", false);
+    params.Add("overlap_implicit", overlap_implicit);
+    // With AMR or CT, compute the flux divergence in the bulk of each block while the EMFs and
+    // flux corrections are exchanged, leaving only the rind to wait for them
+    bool overlap_flux_exchange = pin->GetOrAddBoolean("driver", "overlap_flux_exchange", false);
+    params.Add("overlap_flux_exchange", overlap_flux_exchange);
+
     // When using the Implicit package we need to globally distinguish implicit & explicit vars
     // All independent variables should be marked one or the other,
     // so we define the flags here to avoid loading order issues
-    Metadata::AddUserFlag("Implicit");
-    Metadata::AddUserFlag("Explicit");
+    AddUserFlag("Implicit");
+    AddUserFlag("Explicit");
+    // Variables which need physical boundaries, but which cross block boundaries packed at reduced
+    // precision in a separate FillGhost field rather than by themselves (e.g. <electrons> halo_float)
+    AddUserFlag("HaloFloat");
     // Add a flag if we wish to use ideal variables explicitly evolved as guess for implicit update.
     // GRIM uses the fluid state of the previous (sub-)step.
     // The logic here is that the non-ideal variables do not significantly contribute to the
@@ -89,19 +253,24 @@ std::shared_ptr<KHARMAPackage> KHARMADriver::Initialize(ParameterInput *pin, std
     // takes us to a region in the parameter space of state variables that 
     // is close to the true solution. The corrections obtained from the implicit update would then
     // be small corrections.
-    Metadata::AddUserFlag("IdealGuess");
+    AddUserFlag("IdealGuess");
 
     // 1. One flag to mark the primitive variables specifically
     // (Parthenon has Metadata::Conserved already)
-    Metadata::AddUserFlag("Primitive");
+    AddUserFlag("Primitive");
 
     // Finally, a flag for anything used (and possibly sync'd) during startup,
     // but which should not be evolved (or more importantly, sync'd) during main stepping
-    Metadata::AddUserFlag("StartupOnly");
+    AddUserFlag("StartupOnly");
 
     // This is a flag Parthenon should have eventually, but we'll prototype in KHARMA
     // Indicate a 1-element face-centered field is split components of a vector
-    Metadata::AddUserFlag("SplitVector");
+    AddUserFlag("SplitVector");
+
+    // Passively advected scalars, whose primitive forms are just the conserved forms over the conserved
+    // density, i.e. P = U / (rho u^t gdet).  The Inverter converts these in its own kernel, see
+    // KHARMAPackage::AdvectedScalars
+    AddUserFlag("AdvectedScalar");
 
     // Synchronize primitive variables unless we're using the KHARMA driver that specifically doesn't
     // This includes for AMR w/ImEx driver
@@ -121,20 +290,69 @@ std::shared_ptr<KHARMAPackage> KHARMADriver::Initialize(ParameterInput *pin, std
     return pkg;
 }
 
-void KHARMADriver::AddFullSyncRegion(TaskCollection& tc, std::shared_ptr<MeshData<Real>> &md_sync)
+const std::vector<std::string>& KHARMADriver::StateSyncVars(Packages_t &packages)
+{
+    // The variables don't change during a run, so build the list only once
+    static std::vector<std::string> sync_vars;
+    if (sync_vars.size() == 0) {
+        // "Boundaries" packs in buffers e.g. Dirichlet boundaries
+        using FC = Metadata::FlagCollection;
+        auto sync_flags = FC({Metadata::GetUserFlag("Primitive"), Metadata::Conserved,
+                              Metadata::Face, Metadata::GetUserFlag("Boundaries")}, true);
+        sync_vars = KHARMA::GetVariableNames(&packages, sync_flags);
+        // The inversion flags are only marked FillGhost when FixUtoP reads them across block boundaries
+        auto ghost_vars = KHARMA::GetVariableNames(&packages, FC({Metadata::FillGhost, Metadata::Cell}));
+        if (std::count(ghost_vars.begin(), ghost_vars.end(), "pflag"))
+            sync_vars.push_back("pflag");
+        // Entropies exchanged at single precision travel in their own packed field, see Electrons::PackHalo
+        if (std::count(ghost_vars.begin(), ghost_vars.end(), "Electrons.halo"))
+            sync_vars.push_back("Electrons.halo");
+    }
+    return sync_vars;
+}
+
+void KHARMADriver::AddFullSyncRegion(TaskCollection& tc, const std::string& stage_name,
+                                     const std::vector<std::string>& sync_vars)
 {
     const TaskID t_none(0);
 
     // MPI boundary exchange, done over MeshData objects/partitions at once
     // Parthenon includes physical bounds
+    // Each partition gets its own list, which syncs only that partition's blocks
     const int num_partitions = pmesh->DefaultNumPartitions(); // Usually 1
     TaskRegion &bound_sync = tc.AddRegion(num_partitions);
     for (int i = 0; i < num_partitions; i++) {
         auto &tl = bound_sync[i];
-        AddBoundarySync(t_none, tl, md_sync);
+        auto &md_partition = pmesh->mesh_data.GetOrAdd(stage_name, i);
+        if (sync_vars.size() > 0) {
+            auto &md_sync = pmesh->mesh_data.AddShallow("sync"+stage_name+std::to_string(i), md_partition, sync_vars);
+            AddBoundarySync(t_none, tl, md_sync);
+        } else {
+            AddBoundarySync(t_none, tl, md_partition);
+        }
     }
 }
 
+void KHARMADriver::AddTimestepReductionRegion(TaskCollection& tc)
+{
+    if (!pmesh->packages.Get("Driver")->Param<bool>("async_dt") || pmesh->adaptive) return;
+    const TaskID t_none(0);
+    TaskRegion &dt_region = tc.AddRegion(1);
+    auto &md = pmesh->mesh_data.Get();
+    dt_region[0].AddTask(t_none, StartTimestepReduction, md.get());
+}
+
+TaskStatus KHARMADriver::StartTimestepReduction(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    Real dt_local = std::numeric_limits<Real>::max();
+    for (auto const &pmb : pmesh->block_list)
+        dt_local = std::min(dt_local, pmb->NewDt());
+    Reductions::StartToAll<Real>(md, Reductions::Channel::dt, dt_local, MPI_MIN);
+    *(pmesh->packages.Get("Driver")->AllParams().GetMutable<bool>("dt_reduction_started")) = true;
+    return TaskStatus::complete;
+}
+
 TaskID KHARMADriver::AddBoundarySync(const TaskID t_start, TaskList &tl, std::shared_ptr<MeshData<Real>> &mc1)
 {
     Flag("AddBoundarySync");
@@ -145,43 +363,56 @@ TaskID KHARMADriver::AddBoundarySync(const TaskID t_start, TaskList &tl, std::sh
     auto &params = pmesh->packages.Get("Driver")->AllParams();
     bool multilevel = pmesh->multilevel;
 
+    // Electron entropies can be exchanged packed at single precision.  Both tasks are no-ops
+    // for syncs not including the packed field
+    const bool halo_float = pmesh->packages.AllPackages().count("Electrons") &&
+                            pmesh->packages.Get("Electrons")->Param<bool>("halo_float");
+    if (halo_float) {
+        t_start_sync = tl.AddTask(t_start_sync, Electrons::PackHalo, mc1.get());
+    }
+
     // The Parthenon exchange tasks include applying physical boundary conditions now.
     // We generally do not take advantage of this yet, but good to know when reasoning about initialization.
     Flag("ParthenonAddSync");
-    auto t_sync_done = parthenon::AddBoundaryExchangeTasks(t_start_sync, tl, mc1, multilevel);
-    auto t_bounds = t_sync_done;
+    auto t_sync_done = AddExchangeTasks(t_start_sync, tl, mc1, multilevel);
     EndFlag();
+    if (halo_float) {
+        t_sync_done = tl.AddTask(t_sync_done, Electrons::UnpackHalo, mc1.get());
+    }
+    auto t_bounds = t_sync_done;
 
     // We always just sync'd the "conserved" magnetic field
     // Translate back to "primitive" (& cell-centered) field if that's what we'll be using
+    // This covers the ghost zones of all blocks in a single kernel
     if (params.Get<bool>("sync_prims")) {
         auto pkgs = pmesh->packages.AllPackages();
-        TaskID t_all_utop[mc1->NumBlocks() * BOUNDARY_NFACES];
-        TaskID t_utop_final(0);
-        int i_task = 0;
-        for (int i_block = 0; i_block < mc1->NumBlocks(); i_block++) {
-            auto &rc = mc1->GetBlockData(i_block);
-            for (int i_bnd = 0; i_bnd < BOUNDARY_NFACES; i_bnd++) {
-                if (rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::block ||
-                    rc->GetBlockPointer()->boundary_flag[i_bnd] == BoundaryFlag::periodic) {
-                    const auto bdomain = KBoundaries::BoundaryDomain((BoundaryFace) i_bnd);
-                    if (pkgs.count("B_FluxCT")) {
-                        t_all_utop[i_task] = tl.AddTask(t_sync_done, B_FluxCT::BlockUtoP, rc.get(), bdomain, false);
-                    } else if (pkgs.count("B_CT")) {
-                        t_all_utop[i_task] = tl.AddTask(t_sync_done, B_CT::BlockUtoP, rc.get(), bdomain, false);
-                    }
-                    t_utop_final = t_utop_final | t_all_utop[i_task];
-                    i_task++;
-                }
-            }
+        if (pkgs.count("B_FluxCT")) {
+            t_bounds = tl.AddTask(t_sync_done, B_FluxCT::MeshBoundaryUtoP, mc1.get());
+        } else if (pkgs.count("B_CT")) {
+            t_bounds = tl.AddTask(t_sync_done, B_CT::MeshBoundaryUtoP, mc1.get());
         }
-        t_bounds = t_utop_final;
     }
 
     EndFlag();
     return t_bounds;
 }
 
+std::shared_ptr<MeshData<Real>> KHARMADriver::EMFSyncData(Mesh *pmesh, std::shared_ptr<MeshData<Real>> &md, int i)
+{
+    // One per partition: a single mesh-wide container would be exchanged by every partition's task list.
+    // The EMFs are OneCopy, so this is the same data whichever stage md is
+    return pmesh->mesh_data.AddShallow("EMF_" + std::to_string(i), md, std::vector<std::string>{"B_CT.emf"});
+}
+
+TaskID KHARMADriver::AddEMFSync(const TaskID t_start, TaskList &tl, std::shared_ptr<MeshData<Real>> &md_emf)
+{
+    Flag("AddEMFSync");
+    // The B field UtoP & electron halo unpacking in AddBoundarySync have nothing to do for EMFs
+    auto t_sync_done = AddExchangeTasks(t_start, tl, md_emf, md_emf->GetMeshPointer()->multilevel);
+    EndFlag();
+    return t_sync_done;
+}
+
 TaskStatus KHARMADriver::SyncAllBounds(std::shared_ptr<MeshData<Real>> &md)
 {
     Flag("SyncAllBounds");
@@ -207,9 +438,9 @@ TaskID KHARMADriver::AddFluxCalculations(TaskID& t_start, TaskList& tl, MeshData
     auto& pkgs = pmb0->packages.AllPackages();
     const KReconstruction::Type& recon = pkgs.at("Flux")->Param<KReconstruction::Type>("recon");
 
-    // Pre-calculate B field cell-center values
+    // Optionally re-calculate B field cell-center values, see <b_field>center_before_flux
     auto t_start_fluxes = t_start;
-    if (md->GetMeshPointer()->packages.AllPackages().count("B_CT"))
+    if (pkgs.count("B_CT") && pkgs.at("B_CT")->Param<bool>("center_before_flux"))
         t_start_fluxes = tl.AddTask(t_start, B_CT::MeshUtoP, md, IndexDomain::entire, false);
 
     // Calculate fluxes in each direction using given reconstruction
@@ -254,6 +485,16 @@ TaskID KHARMADriver::AddFluxCalculations(TaskID& t_start, TaskList& tl, MeshData
         t_calculate_flux2 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5, X2DIR>, md);
         t_calculate_flux3 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5, X3DIR>, md);
         break;
+    case RType::weno5_cached:
+        t_calculate_flux1 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_cached, X1DIR>, md);
+        t_calculate_flux2 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_cached, X2DIR>, md);
+        t_calculate_flux3 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_cached, X3DIR>, md);
+        break;
+    case RType::weno5_adaptive:
+        t_calculate_flux1 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_adaptive, X1DIR>, md);
+        t_calculate_flux2 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_adaptive, X2DIR>, md);
+        t_calculate_flux3 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_adaptive, X3DIR>, md);
+        break;
     case RType::weno5_linear:
         t_calculate_flux1 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_linear, X1DIR>, md);
         t_calculate_flux2 = tl.AddTask(t_start_fluxes, Flux::GetFlux<RType::weno5_linear, X2DIR>, md);
@@ -279,14 +520,33 @@ TaskID KHARMADriver::AddFluxCalculations(TaskID& t_start, TaskList& tl, MeshData
                   << "donor_cell, linear_mc, weno5" << std::endl;
         throw std::invalid_argument("Unsupported reconstruction algorithm!");
     }
-    auto t_calc_fluxes = t_calculate_flux1 | t_calculate_flux2 | t_calculate_flux3;
+    // With extra_checks, NaN/zero ctop are counted inside the flux kernels, see Flux::PostStepDiagnostics
+    return t_calculate_flux1 | t_calculate_flux2 | t_calculate_flux3;
+}
 
-    auto t_ctop = t_calc_fluxes;
-    if (md->GetMeshPointer()->packages.Get("Globals")->Param<int>("extra_checks") > 0) {
-        auto t_ctop = tl.AddTask(t_calc_fluxes, Flux::CheckCtop, md);
+TaskID KHARMADriver::AddFluxDivergence(TaskID& t_fluxes, TaskID& t_flux_bounds, TaskList& tl,
+                                       MeshData<Real> *md_sub_step_init, MeshData<Real> *md_flux_src)
+{
+    const std::vector<MetadataFlag> flags = {Metadata::Independent, Metadata::Cell, Metadata::WithFluxes};
+    const bool use_b_ct = pmesh->packages.AllPackages().count("B_CT");
+    const bool overlap = pmesh->packages.Get("Driver")->Param<bool>("overlap_flux_exchange");
+    // Optionally add the geometric source in the same pass, in which case Packages::AddSource skips it
+    const bool fuse_sources = pmesh->packages.Get("Flux")->Param<bool>("fuse_divergence");
+    if (overlap && (pmesh->multilevel || use_b_ct)) {
+        // Zones with no face on the block boundary don't see the corrections, so can start right away
+        if (fuse_sources) {
+            auto t_bulk = tl.AddTask(t_fluxes, Flux::FluxDivergenceSources, md_sub_step_init, md_flux_src, DivergenceRegion::bulk);
+            auto t_rind = tl.AddTask(t_flux_bounds, Flux::FluxDivergenceSources, md_sub_step_init, md_flux_src, DivergenceRegion::rind);
+            return t_bulk | t_rind;
+        }
+        auto t_bulk = tl.AddTask(t_fluxes, FluxDivergence, md_sub_step_init, md_flux_src, flags, 0, DivergenceRegion::bulk);
+        auto t_rind = tl.AddTask(t_flux_bounds, FluxDivergence, md_sub_step_init, md_flux_src, flags, 0, DivergenceRegion::rind);
+        return t_bulk | t_rind;
+    } else if (fuse_sources) {
+        return tl.AddTask(t_flux_bounds, Flux::FluxDivergenceSources, md_sub_step_init, md_flux_src, DivergenceRegion::all);
+    } else {
+        return tl.AddTask(t_flux_bounds, FluxDivergence, md_sub_step_init, md_flux_src, flags, 0, DivergenceRegion::all);
     }
-
-    return t_ctop;
 }
 
 TaskID KHARMADriver::AddFOFC(TaskID& t_start, TaskList& tl, MeshData<Real> *md,
@@ -310,7 +570,7 @@ TaskID KHARMADriver::AddFOFC(TaskID& t_start, TaskList& tl, MeshData<Real> *md,
     // also would need to deal with B_CT::AddSource == flux update, which we don't want/need
     auto t_guess_sources = t_guess_divergence;
     if (pmb0->packages.Get("Flux")->Param<bool>("fofc_use_source_term")) {
-        auto t_guess_sources = tl.AddTask(t_guess_divergence, Flux::AddGeoSourceTask, md, guess_src, IndexDomain::entire);
+        t_guess_sources = tl.AddTask(t_guess_divergence, Flux::AddGeoSourceTask, md, guess_src, IndexDomain::entire);
     }
     // Update the guess state with the guess source term, and our existing state
     // Note this includes updating cell-centered B with the fluxes -- we don't care if this version has div
@@ -372,11 +632,15 @@ TaskID KHARMADriver::AddStateUpdate(TaskID& t_start, TaskList& tl, MeshData<Real
                                 1.0, integrator->beta[stage-1] * integrator->dt,
                                 md_update);
     }
+    // Merge zones near the poles, before anything reads the updated state
+    auto pmb0  = md_full_step_init->GetBlockData(0)->GetBlockPointer();
+    auto& pkgs = pmb0->packages.AllPackages();
+    if (pkgs.count("ISMR")) {
+        t_update = tl.AddTask(t_update | t_update_c, ISMR::DerefinePoles, md_update);
+    }
 
     // We'll be running UtoP after this, which needs a guess in order to converge, so we copy in md_sub_step_init
     auto t_copy_prims = t_update;
-    auto pmb0  = md_full_step_init->GetBlockData(0)->GetBlockPointer();
-    auto& pkgs = pmb0->packages.AllPackages();
     if (!pkgs.at("GRMHD")->Param<bool>("implicit")) {
         t_copy_prims = tl.AddTask(t_start, Copy<MeshData<Real>>,
                                     std::vector<MetadataFlag>({Metadata::GetUserFlag("HD"), Metadata::GetUserFlag("Primitive")}),
@@ -443,8 +707,31 @@ void KHARMADriver::SetGlobalTimeStep()
     tm.dt *= 2.0;
   }
   Real big = std::numeric_limits<Real>::max();
+  // If the reduction was started at the end of the step, only wait on it here.
+  // Each block's limit was already included; just reset them
+  bool *dt_reduction_started = pmesh->packages.Get("Driver")->AllParams().GetMutable<bool>("dt_reduction_started");
+  if (*dt_reduction_started) {
+    *dt_reduction_started = false;
+    auto &md = pmesh->mesh_data.Get();
+    tm.dt = std::min(tm.dt, Reductions::CheckOnAll<Real>(md.get(), Reductions::Channel::dt));
+    for (auto const &pmb : pmesh->block_list)
+      pmb->SetAllowedDt(big);
+    if (tm.time < tm.tlim &&
+        (tm.tlim - tm.time) < tm.dt) // timestep would take us past desired endpoint
+      tm.dt = tm.tlim - tm.time;
+    return;
+  }
+  const bool report_level_dt = pmesh->multilevel && pmesh->packages.Get("Driver")->Param<bool>("report_level_dt");
+  const int nlevels = pmesh->current_level + 1;
+  std::vector<Real> level_dt(nlevels, big);
+  std::vector<int> level_blocks(nlevels, 0);
   for (auto const &pmb : pmesh->block_list) {
     tm.dt = std::min(tm.dt, pmb->NewDt());
+    if (report_level_dt) {
+      const int level = pmb->loc.level();
+      level_dt[level] = std::min(level_dt[level], pmb->NewDt());
+      level_blocks[level]++;
+    }
     pmb->SetAllowedDt(big);
   }
 
@@ -452,15 +739,180 @@ void KHARMADriver::SetGlobalTimeStep()
 #ifdef MPI_PARALLEL
   PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &tm.dt, 1, MPI_PARTHENON_REAL, MPI_MIN,
                                     MPI_COMM_WORLD));
+  if (report_level_dt) {
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, level_dt.data(), nlevels, MPI_PARTHENON_REAL, MPI_MIN,
+                                      MPI_COMM_WORLD));
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, level_blocks.data(), nlevels, MPI_INT, MPI_SUM,
+                                      MPI_COMM_WORLD));
+  }
 #endif
 
+  if (report_level_dt && MPIRank0()) {
+    // Subcycling would step each level at its own limit, rounded down to a power-of-2 multiple of the finest step
+    Real dt_finest = big;
+    for (int l = 0; l < nlevels; l++) if (level_blocks[l] > 0) dt_finest = std::min(dt_finest, level_dt[l]);
+    Real updates_global = 0., updates_subcycled = 0.;
+    for (int l = 0; l < nlevels; l++) {
+      if (level_blocks[l] == 0) continue;
+      const Real ratio = std::pow(2., std::floor(std::log2(level_dt[l] / dt_finest)));
+      updates_global += level_blocks[l];
+      updates_subcycled += level_blocks[l] / ratio;
+      printf("Level %d: %d blocks, dt limit %g (%gx global)\n", l, level_blocks[l], level_dt[l], ratio);
+    }
+    printf("Per-level subcycling would need %.1f%% of the current block updates\n",
+           100. * updates_subcycled / updates_global);
+  }
+
   if (tm.time < tm.tlim &&
       (tm.tlim - tm.time) < tm.dt) // timestep would take us past desired endpoint
     tm.dt = tm.tlim - tm.time;
 }
 
+KHARMADriver::KHARMADriver(ParameterInput *pin, ApplicationInput *app_in, Mesh *pm) : MultiStageDriver(pin, app_in, pm)
+{
+    const std::string &low_storage = pm->packages.Get("Driver")->Param<std::string>("low_storage");
+    if (low_storage != "none") SetLowStorageIntegrator(low_storage);
+}
+
+void KHARMADriver::UpdateBlockCosts(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    auto& pkgs = pmesh->packages.AllPackages();
+    const auto& params = pkgs.at("Driver")->AllParams();
+    if (tm.ncycle % params.Get<int>("cost_interval") != 0) return;
+    // pflag is present whenever we invert or floor anything
+    if (!pkgs.count("Inverter") && !pkgs.count("Floors")) return;
+    Flag("UpdateBlockCosts");
+
+    const bool use_floors = pkgs.count("Floors");
+    const bool use_implicit = pkgs.count("Implicit");
+    const Real w_fixup = params.Get<Real>("cost_fixup");
+    const Real w_floor = use_floors ? params.Get<Real>("cost_floor") : 0.;
+    const Real w_iter = use_implicit ? params.Get<Real>("cost_implicit_iter") : 0.;
+
+    const int num_partitions = pmesh->DefaultNumPartitions();
+    for (int i = 0; i < num_partitions; i++) {
+        auto &md = pmesh->mesh_data.GetOrAdd("base", i);
+        auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+        // Stand in pflag for any fields we don't have: their weights are zero
+        const auto& pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+        const auto& fflag = md->PackVariables(std::vector<std::string>{use_floors ? "fflag" : "pflag"});
+        const auto& iters = md->PackVariables(std::vector<std::string>{use_implicit ? "solve_iters" : "pflag"});
+
+        const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+        const IndexRange block = IndexRange{0, pflag.GetDim(5) - 1};
+        ParArray1D<Real> extra("block_extra_cost", md->NumBlocks());
+        pmb0->par_for("block_costs", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int& bl, const int& k, const int& j, const int& i) {
+                Real w = w_iter * iters(bl, 0, k, j, i);
+                if (static_cast<int>(pflag(bl, 0, k, j, i)) > 0) w += w_fixup;
+                if (static_cast<int>(fflag(bl, 0, k, j, i)) != 0) w += w_floor;
+                // Most zones contribute nothing, so contention is low
+                if (w > 0.) Kokkos::atomic_add(&extra(bl), w);
+            }
+        );
+        const auto extra_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), extra);
+        const Real ncells = (b.ke - b.ks + 1) * (b.je - b.js + 1) * (b.ie - b.is + 1);
+        for (int bl = 0; bl < md->NumBlocks(); ++bl)
+            md->GetBlockData(bl)->GetBlockPointer()->cost_ = 1. + extra_h(bl) / ncells;
+    }
+    EndFlag();
+}
+
+void KHARMADriver::SetLowStorageIntegrator(const std::string& scheme)
+{
+    if (scheme == "ssprk3") {
+        // Shu & Osher 1988
+        integrator->nstages = 3;
+        integrator->gam0 = {0.0, 0.25, 2./3};
+        integrator->gam1 = {1.0, 0.75, 1./3};
+        integrator->beta = {1.0, 0.25, 2./3};
+    } else if (scheme == "ssprk104") {
+        // Ketcheson 2008, SSPRK(10,4) in its 2-register form.  Stage 5 also mixes in the step start,
+        // and the (floored, fixed) result of stage 5 is folded into base before stage 6
+        integrator->nstages = 10;
+        integrator->gam0 = {1., 1., 1., 1., 2./5, 1., 1., 1., 1., 3./5};
+        integrator->gam1 = {0., 0., 0., 0., 3./5, 0., 0., 0., 0., 1.};
+        integrator->beta = {1./6, 1./6, 1./6, 1./6, 1./15, 1./6, 1./6, 1./6, 1./6, 1./10};
+        aux_stage = 6;
+        aux_w0 = -1./2;
+        aux_w1 = 9./10;
+    } else {
+        throw std::invalid_argument("Unknown low-storage integrator: "+scheme);
+    }
+    // Stage 0 and the final stage are "base", all others share one register
+    integrator->stage_name = std::vector<std::string>(integrator->nstages + 1, "1");
+    integrator->stage_name[0] = "base";
+    integrator->stage_name[integrator->nstages] = "base";
+}
+
 void KHARMADriver::PostExecute(DriverStatus status)
 {
     Packages::PostExecute(pmesh, pinput, tm);
+    // Print the final step's flags, rather than leaving their reductions in flight
+    auto &md = pmesh->mesh_data.Get();
+    while (Reductions::CheckDeferredFlagReduces(md.get()) == TaskStatus::incomplete);
+    if (pmesh->packages.Get("Driver")->Param<bool>("performance_json"))
+        WritePerformanceJSON();
     EvolutionDriver::PostExecute(status);
 }
+
+void KHARMADriver::WritePerformanceJSON()
+{
+    Flag("WritePerformanceJSON");
+    auto packages = &pmesh->packages;
+    double zone_cycles = packages->Get("Globals")->Param<double>("zone_cycles");
+    int nranks = 1;
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nranks));
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &zone_cycles, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD));
+#endif
+    const double wall_time = timer_main.seconds();
+
+    if (MPIRank0()) {
+        // Nominal values read or written per zone-update in each phase.  These ignore stencils, caches
+        // and ghost zones (except for the exchange), so the bandwidths computed from them are lower bounds
+        const int nprim = PackDimension(packages, Metadata::GetUserFlag("Primitive"));
+        const int ncons = PackDimension(packages, Metadata::Conserved);
+        const int nimplicit = PackDimension(packages, Metadata::GetUserFlag("Implicit"));
+        const int nelec = packages->AllPackages().count("Electrons") ? PackDimension(packages, Metadata::GetUserFlag("Elec")) : 0;
+        const int ndim = pmesh->ndim;
+        const bool b_ct = packages->AllPackages().count("B_CT");
+        // Ghost zones exchanged per interior zone, packed on one side and unpacked on the other
+        const auto& bounds = pmesh->block_list[0]->cellbounds;
+        const double n_int = bounds.ncellsi(IndexDomain::interior) * bounds.ncellsj(IndexDomain::interior)
+                             * bounds.ncellsk(IndexDomain::interior);
+        const double n_all = bounds.ncellsi(IndexDomain::entire) * bounds.ncellsj(IndexDomain::entire)
+                             * bounds.ncellsk(IndexDomain::entire);
+        const double ghost_frac = (n_all - n_int) / n_int;
+        const std::map<std::string, double> values_per_zone = {
+            // Reconstruction reads P & writes Pl/Pr, the Riemann solver reads them & writes F, per direction
+            {"flux", ndim * (5. * nprim + ncons)},
+            // Faces of B, the EMFs and their averages
+            {"emf", b_ct ? 3. * ndim + 6. : 2. * ndim},
+            {"inversion", ncons + nprim + 1.},
+            {"floors", 2. * (nprim + ncons) + 1.},
+            // Per solver iteration: Jacobian, residual & state
+            {"implicit", nimplicit * (nimplicit + 4.) + 2. * nprim},
+            {"electrons", 2. * nelec + 2. * nprim},
+            {"boundaries", 2. * ghost_frac * (nprim + ncons)},
+            {"reductions", (double) nprim}
+        };
+
+        const std::string fname = packages->Get("Globals")->Param<std::string>("problem") + ".kharma_perf.json";
+        FILE *f = fopen(fname.c_str(), "w");
+        fprintf(f, "{\n  \"kharma-performance\": {\n");
+        fprintf(f, "    \"version\": \"%s\",\n", packages->Get("Globals")->Param<std::string>("version").c_str());
+        fprintf(f, "    \"ranks\": %d,\n", nranks);
+        fprintf(f, "    \"wall-time\": %.6g,\n", wall_time);
+        fprintf(f, "    \"zone-cycles\": %.17g,\n", zone_cycles);
+        fprintf(f, "    \"zone-cycles-per-second\": %.6g,\n", zone_cycles / wall_time);
+        fprintf(f, "    \"bytes-per-value\": %d,\n", (int) sizeof(Real));
+        fprintf(f, "    \"values-per-zone\": {");
+        int n = 0;
+        for (auto& phase : values_per_zone)
+            fprintf(f, "%s\n      \"%s\": %.6g", (n++ > 0) ? "," : "", phase.first.c_str(), phase.second);
+        fprintf(f, "\n    }\n  }\n}\n");
+        fclose(f);
+    }
+    EndFlag();
+}
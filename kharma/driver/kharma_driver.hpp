@@ -43,6 +43,9 @@ using namespace parthenon;
 
 // See Initialize()
 enum class DriverType{kharma, imex, simple};
+// Zones of each block covered by FluxDivergence: all, only those with no face on the block boundary,
+// or only those with one (which depend on flux corrections from neighbors)
+enum class DivergenceRegion{all=0, bulk, rind};
 
 /**
  * This is the "Driver" class for KHARMA.
@@ -57,7 +60,7 @@ enum class DriverType{kharma, imex, simple};
  */
 class KHARMADriver : public MultiStageDriver {
     public:
-        KHARMADriver(ParameterInput *pin, ApplicationInput *app_in, Mesh *pm) : MultiStageDriver(pin, app_in, pm) {}
+        KHARMADriver(ParameterInput *pin, ApplicationInput *app_in, Mesh *pm);
 
         static std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
@@ -70,6 +73,21 @@ class KHARMADriver : public MultiStageDriver {
         // And the PostExecute, so we can add a package callback here
         void PostExecute(DriverStatus status) override;
 
+        /**
+         * Write zone-cycles, wall time and nominal bytes per zone of each phase, see <driver>performance_json
+         */
+        void WritePerformanceJSON();
+
+        /**
+         * Replace the Parthenon integrator's stages with a 2-register low-storage scheme (see <driver> low_storage).
+         * Every intermediate stage reads and writes the same register, so only "base" and one other are allocated.
+         * Stage s computes stage_name[s] = gam0*stage_name[s-1] + gam1*base + beta*dt*dU/dt, after which
+         * stage aux_stage additionally sets base = aux_w0*base + aux_w1*stage_name[s-1] before its update.
+         */
+        void SetLowStorageIntegrator(const std::string& scheme);
+        int aux_stage = -1;
+        Real aux_w0 = 1., aux_w1 = 0.;
+
         /**
          * Make a TaskCollection according to which step type was chosen (kharma, imex, simple).
          * This represents all tasks to be done in this sub-step (i.e., one TaskList per
@@ -112,6 +130,14 @@ class KHARMADriver : public MultiStageDriver {
         TaskID AddFOFC(TaskID& t_start, TaskList& tl, MeshData<Real> *md,
                              MeshData<Real> *md_full_step_init, MeshData<Real> *md_sub_step_init,
                              MeshData<Real> *guess_src, MeshData<Real> *guess, int stage);
+
+        /**
+         * Add the flux divergence of md_sub_step_init into md_flux_src.  If the fluxes are corrected by
+         * communication (AMR or CT) and overlap_flux_exchange is set, the bulk of each block is computed
+         * as soon as t_fluxes is done, and only the rind waits on the corrections at t_flux_bounds.
+         */
+        TaskID AddFluxDivergence(TaskID& t_fluxes, TaskID& t_flux_bounds, TaskList& tl,
+                                 MeshData<Real> *md_sub_step_init, MeshData<Real> *md_flux_src);
         /**
          * This function updates a state md_update with the results of an explicit source term calculation
          * placed in md_flux_src.  It includes initialization/RK factors and so requires full- and sub-step
@@ -131,10 +157,36 @@ class KHARMADriver : public MultiStageDriver {
                                 bool update_face, int stage);
 
         /**
-         * Add a synchronization retion to an existing TaskCollection tc.
+         * Names of the variables the boundary sync after each state update must exchange, i.e. those the
+         * following tasks read in ghost zones: primitive & conserved state, face fields, boundary buffers,
+         * and the inversion flags when fixups average over neighbors.
+         * Anything else marked FillGhost (EMFs, FOFC flags, solver & cleanup scratch) is exchanged only by
+         * the sync of its own phase, e.g. the EMF sync for B_CT or the flag sync in AddFOFC.
+         */
+        static const std::vector<std::string>& StateSyncVars(Packages_t &packages);
+
+        /**
+         * Add a synchronization region to an existing TaskCollection tc, with one list per partition
+         * of the mesh state 'stage_name'.  If sync_vars is non-empty, only those variables are exchanged.
          * Since the region is self-contained, does not return a TaskID
          */
-        void AddFullSyncRegion(TaskCollection& tc, std::shared_ptr<MeshData<Real>> &md);
+        void AddFullSyncRegion(TaskCollection& tc, const std::string& stage_name,
+                               const std::vector<std::string>& sync_vars = {});
+
+        /**
+         * If <driver> async_dt is set, add a region starting the non-blocking MPI reduction of the
+         * next timestep, once every partition has run EstimateTimestep.  Anything added to tc afterward
+         * (e.g. the second sync), and the post-step work, runs before SetGlobalTimeStep waits on it.
+         */
+        void AddTimestepReductionRegion(TaskCollection& tc);
+        static TaskStatus StartTimestepReduction(MeshData<Real> *md);
+
+        /**
+         * With <driver> block_costs, set each block's cost for Parthenon's load balancer from the
+         * fixups, floor hits and implicit solver iterations in its zones over the last step.
+         * Registered as the Driver package's PostStepWork.
+         */
+        static void UpdateBlockCosts(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
 
         /**
          * Add just the synchronization step to a task list tl, dependent upon taskID t_start, syncing mesh mc1
@@ -144,6 +196,18 @@ class KHARMADriver : public MultiStageDriver {
          */
         static TaskID AddBoundarySync(const TaskID t_start, TaskList &tl, std::shared_ptr<MeshData<Real>> &md);
 
+        /**
+         * Container holding only the B_CT EMFs of partition i, for exchanging them alone between
+         * CalculateEMF and the flux corrections.  Its receives can be posted at the start of the step.
+         */
+        static std::shared_ptr<MeshData<Real>> EMFSyncData(Mesh *pmesh, std::shared_ptr<MeshData<Real>> &md, int i);
+
+        /**
+         * Add the EMF exchange to tl: Parthenon's exchange & physical boundaries (which average or zero
+         * boundary EMFs), without the state-specific work around AddBoundarySync
+         */
+        static TaskID AddEMFSync(const TaskID t_start, TaskList &tl, std::shared_ptr<MeshData<Real>> &md_emf);
+
         /**
          * Single call to sync all boundary conditions (MPI/internal and domain/physical boundaries)
          * Used anytime boundary sync is needed outside the usual loop of steps.
@@ -162,6 +226,15 @@ class KHARMADriver : public MultiStageDriver {
         {
             return Update::WeightedSumData<std::vector<MetadataFlag>, T>(flags, source, source, 1., 0., dest);
         }
+        /**
+         * Copy variables in the list 'names' from 'source' to 'dest'.
+         * Named differently from Copy so either can be passed to AddTask
+         */
+        template<typename T>
+        static TaskStatus CopyVars(std::vector<std::string> names, T* source, T* dest)
+        {
+            return Update::WeightedSumData<std::vector<std::string>, T>(names, source, source, 1., 0., dest);
+        }
 
         template<typename MDType>
         static TaskStatus WeightedSumDataFace(const std::vector<MDType> &flags, MeshData<Real> *in1, MeshData<Real> *in2, const Real w1, const Real w2,
@@ -203,22 +276,29 @@ class KHARMADriver : public MultiStageDriver {
 
         /**
          * Replace Parthenon's `FluxDivergence` with a more adaptable version: pack on a customizable set
-         * of flags, optionally include a halo around physical zones (useful for predicting bad zones in FOFC)
+         * of flags, optionally include a halo around physical zones (useful for predicting bad zones in FOFC),
+         * or cover only part of each block (see DivergenceRegion)
          */
         static TaskStatus FluxDivergence(MeshData<Real> *in_obj, MeshData<Real> *dudt_obj,
                                   std::vector<MetadataFlag> flags = {Metadata::WithFluxes, Metadata::Cell},
-                                  int halo=0)
+                                  int halo=0, DivergenceRegion region=DivergenceRegion::all)
         {
             const auto &vin = in_obj->PackVariablesAndFluxes(flags);
             auto dudt = dudt_obj->PackVariables(flags);
 
-            const IndexRange3 b = KDomain::GetRange(in_obj, IndexDomain::interior, -halo, halo);
+            // The bulk is the interior less one zone on each side, i.e. no face on the block boundary
+            const IndexRange3 bulk = KDomain::GetRange(in_obj, IndexDomain::interior, 1, -1);
+            const IndexRange3 b = (region == DivergenceRegion::bulk) ? bulk
+                                    : KDomain::GetRange(in_obj, IndexDomain::interior, -halo, halo);
+            const bool rind_only = (region == DivergenceRegion::rind);
 
             const int ndim = vin.GetNdim();
             parthenon::par_for(
                 DEFAULT_LOOP_PATTERN, "FluxDivergenceMesh", DevExecSpace(), 0, vin.GetDim(5) - 1, 0,
                 vin.GetDim(4) - 1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
                 KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+                    if (rind_only && i >= bulk.is && i <= bulk.ie && j >= bulk.js && j <= bulk.je &&
+                        k >= bulk.ks && k <= bulk.ke) return;
                     if (dudt.IsAllocated(m, l) && vin.IsAllocated(m, l)) {
                         const auto &coords = vin.GetCoords(m);
                         const auto &v = vin(m);
@@ -38,6 +38,7 @@
 #include "b_flux_ct.hpp"
 #include "b_cd.hpp"
 #include "b_cleanup.hpp"
+#include "current.hpp"
 #include "b_ct.hpp"
 #include "electrons.hpp"
 #include "grmhd.hpp"
@@ -48,6 +49,7 @@
 #include "flux.hpp"
 #include "kharma.hpp"
 #include "implicit.hpp"
+#include "reductions.hpp"
 #include "resize_restart.hpp"
 
 #include <parthenon/parthenon.hpp>
@@ -90,9 +92,16 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
     auto& flux_pkg   = pkgs.at("Flux")->AllParams();
     const bool use_b_cleanup = pkgs.count("B_Cleanup");
     const bool use_b_ct = pkgs.count("B_CT");
+    // Whether EMFs are calculated & sync'd separately, or in the face update (see B_CT::UseFusedUpdate)
+    const bool split_ct = use_b_ct && !B_CT::UseFusedUpdate(pmesh);
     const bool use_electrons = pkgs.count("Electrons");
     const bool use_fofc = flux_pkg.Get<bool>("use_fofc");
     const bool use_jcon = pkgs.count("Current");
+    const bool fuse_floors_fixup = pkgs.at("Inverter")->Param<bool>("fuse_floors_fixup");
+    const bool selective_ptou = pkgs.at("Driver")->Param<bool>("selective_ptou");
+    bool has_prim_source = false;
+    for (auto kpackage : pmesh->packages.AllPackagesOfType<KHARMAPackage>())
+        if (kpackage.second->BlockApplyPrimSource != nullptr) has_prim_source = true;
 
     // Allocate/copy the things we need
     // TODO these can now be reduced by including the var lists/flags which actually need to be allocated
@@ -102,40 +111,52 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
         // Fluxes
         pmesh->mesh_data.Add("dUdt");
         for (int i = 1; i < integrator->nstages; i++)
-            pmesh->mesh_data.Add(integrator->stage_name[i]);
-        // Preserve state for time derivatives if we need to output current
-        if (use_jcon) {
-            pmesh->mesh_data.Add("preserve");
-            // Above only copies on allocate -- ensure we copy the MHD variables every step with a task
-            std::vector<MetadataFlag> vars_jcon_needs = {Metadata::GetUserFlag("MHD"), Metadata::GetUserFlag("Primitive")};
+            if (integrator->stage_name[i] != integrator->stage_name[i-1]) // low-storage stages share registers
+                pmesh->mesh_data.Add(integrator->stage_name[i]);
+        // Preserve state for time derivatives if we need to output current.
+        // Only the vectors jcon needs are allocated, and they're only copied on steps ending in a jcon output
+        if (use_jcon && Current::OutputDue(pmesh, pinput, tm)) {
+            pmesh->mesh_data.Add("preserve", base, Current::preserve_vars);
+            pkgs.at("Current")->AllParams().Update<double>("preserve_time", tm.time);
+            const std::vector<std::string> vars_jcon_needs = Current::preserve_vars;
             const int num_partitions = pmesh->DefaultNumPartitions();
             TaskRegion &copy_region = tc.AddRegion(num_partitions);
             for (int i = 0; i < num_partitions; i++) {
                 auto &tl = copy_region[i];
-                tl.AddTask(t_none, Copy<MeshData<Real>>, vars_jcon_needs,
+                tl.AddTask(t_none, CopyVars<MeshData<Real>>, vars_jcon_needs,
                             base.get(), pmesh->mesh_data.Get("preserve").get());
             }
         }
         // FOFC needs to determine whether the "real" U-divF will violate floors, and needs a safe place to do it.
         // We populate it later, with each *sub-step*'s initial state
         if (use_fofc) {
-            pmesh->mesh_data.Add("fofc_source");
             pmesh->mesh_data.Add("fofc_guess");
         }
     }
 
+    // Low-storage integrators may fold the last stage into the step start, see SetLowStorageIntegrator
+    if (stage == aux_stage) {
+        const int num_partitions = pmesh->DefaultNumPartitions();
+        TaskRegion &aux_region = tc.AddRegion(num_partitions);
+        for (int i = 0; i < num_partitions; i++) {
+            auto &tl = aux_region[i];
+            auto &md_full_step_init = pmesh->mesh_data.GetOrAdd("base", i);
+            auto &md_sub_step_init  = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage - 1], i);
+            tl.AddTask(t_none, Update::WeightedSumData<std::vector<MetadataFlag>, MeshData<Real>>,
+                       std::vector<MetadataFlag>{Metadata::Independent, Metadata::Cell},
+                       md_full_step_init.get(), md_sub_step_init.get(), aux_w0, aux_w1, md_full_step_init.get());
+            if (use_b_ct) {
+                tl.AddTask(t_none, WeightedSumDataFace<MetadataFlag>,
+                           std::vector<MetadataFlag>{Metadata::Independent, Metadata::Face},
+                           md_full_step_init.get(), md_sub_step_init.get(), aux_w0, aux_w1, md_full_step_init.get());
+            }
+        }
+    }
+
     Flag("MakeTaskCollection::fluxes");
 
-    static std::vector<std::string> sync_vars;
-    if (sync_vars.size() == 0) {
-        // Build the universe of variables to let Parthenon see when exchanging boundaries.
-        // This is built to exclude incidental variables like B field initialization stuff, EMFs, etc.
-        // "Boundaries" packs in buffers e.g. Dirichlet boundaries
-        using FC = Metadata::FlagCollection;
-        auto sync_flags = FC({Metadata::GetUserFlag("Primitive"), Metadata::Conserved,
-                              Metadata::Face, Metadata::GetUserFlag("Boundaries")}, true);
-        sync_vars = KHARMA::GetVariableNames(&(pmesh->packages), sync_flags);
-    }
+    // Exchange only what the following tasks read in ghost zones, see StateSyncVars
+    const auto &sync_vars = StateSyncVars(pmesh->packages);
 
     // Flux region: calculate and apply fluxes to update conserved values
     const int num_partitions = pmesh->DefaultNumPartitions();
@@ -156,9 +177,19 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
 
         // Start receiving flux corrections and ghost cells
         auto t_start_recv_bound = tl.AddTask(t_none, parthenon::StartReceiveBoundBufs<parthenon::BoundaryType::any>, md_sync);
+        // Print the last step's flag counts as their reductions arrive, overlapping the exchanges below.
+        // Nothing depends on this, so it's retried until complete while other tasks proceed
+        if (stage == 1 && i == 0 && pmesh->packages.Get("Driver")->Param<bool>("async_flags"))
+            tl.AddTask(t_none, WaitTimer::PolledTask<Reductions::CheckDeferredFlagReduces>::Run, md_sub_step_init.get());
         auto t_start_recv_flux = t_start_recv_bound;
-        if (pmesh->multilevel || use_b_ct)
+        if (pmesh->multilevel || split_ct)
             t_start_recv_flux = tl.AddTask(t_none, parthenon::StartReceiveFluxCorrections, md_sub_step_init);
+        // Container of only the EMFs, to synchronize between computing them & the flux corrections
+        std::shared_ptr<MeshData<Real>> md_emf_only;
+        if (split_ct) {
+            md_emf_only = KHARMADriver::EMFSyncData(pmesh, md_sub_step_init, i);
+            tl.AddTask(t_none, parthenon::StartReceiveBoundBufs<parthenon::BoundaryType::any>, md_emf_only);
+        }
 
         // Calculate the flux of each variable through each face
         // This reconstructs the primitives (P) at faces and uses them to calculate fluxes
@@ -166,10 +197,11 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
         auto t_flux_calc = KHARMADriver::AddFluxCalculations(t_start_recv_flux, tl, md_sub_step_init.get());
         auto t_fluxes = t_flux_calc;
         if (use_fofc) {
-            auto &guess_src = pmesh->mesh_data.GetOrAdd("fofc_source", i);
+            // The guess's source term is finished with before the real flux divergence is taken,
+            // so it borrows md_flux_src rather than keeping a container of its own
             auto &guess = pmesh->mesh_data.GetOrAdd("fofc_guess", i);
-            auto t_fluxes = KHARMADriver::AddFOFC(t_flux_calc, tl, md_sub_step_init.get(), md_full_step_init.get(),
-                                                  md_sub_step_init.get(), guess_src.get(), guess.get(), stage);
+            t_fluxes = KHARMADriver::AddFOFC(t_flux_calc, tl, md_sub_step_init.get(), md_full_step_init.get(),
+                                             md_sub_step_init.get(), md_flux_src.get(), guess.get(), stage);
         }
 
         // Any package modifications to the fluxes.  e.g.:
@@ -180,22 +212,20 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
 
         // If we're in AMR, correct fluxes from neighbors
         auto t_flux_bounds = t_fix_flux;
-        if (pmesh->multilevel || use_b_ct) {
+        if (pmesh->multilevel || split_ct) {
             auto t_emf = t_flux_bounds;
-            if (use_b_ct) {
-                // Pull out a container of only EMF to synchronize
-                auto &md_emf_only = pmesh->mesh_data.AddShallow("EMF", std::vector<std::string>{"B_CT.emf"}); // TODO this gets weird if we partition
+            if (split_ct) {
                 auto t_emf_local = tl.AddTask(t_flux_bounds, B_CT::CalculateEMF, md_sub_step_init.get());
-                t_emf = KHARMADriver::AddBoundarySync(t_emf_local, tl, md_emf_only);
+                t_emf = KHARMADriver::AddEMFSync(t_emf_local, tl, md_emf_only);
             }
             auto t_load_send_flux = tl.AddTask(t_emf, parthenon::LoadAndSendFluxCorrections, md_sub_step_init);
-            auto t_recv_flux = tl.AddTask(t_load_send_flux, parthenon::ReceiveFluxCorrections, md_sub_step_init);
+            auto t_recv_flux = tl.AddTask(t_load_send_flux, WaitTimer::PolledTask<parthenon::ReceiveFluxCorrections>::Run, md_sub_step_init);
             t_flux_bounds = tl.AddTask(t_recv_flux, parthenon::SetFluxCorrections, md_sub_step_init);
         }
 
         // Apply the fluxes to calculate a change in cell-centered values "md_flux_src"
-        auto t_flux_div = tl.AddTask(t_flux_bounds, FluxDivergence, md_sub_step_init.get(), md_flux_src.get(),
-                                     std::vector<MetadataFlag>{Metadata::Independent, Metadata::Cell, Metadata::WithFluxes}, 0);
+        // Optionally, the bulk of each block is done while the corrections above are in flight
+        auto t_flux_div = KHARMADriver::AddFluxDivergence(t_fix_flux, t_flux_bounds, tl, md_sub_step_init.get(), md_flux_src.get());
 
         // Add any source terms: geometric \Gamma * T, wind, damping, etc etc
         // Also where CT sets the change in face fields
@@ -230,23 +260,29 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
         // This relies on the primitives being calculated identically in MPI boundaries, vs their corresponding
         // physical zones in the adjacent mesh block.  To ensure this, we seed the solver with the same values
         // in each case, by synchronizing them along with the conserved values above.
-        auto t_utop = tl.AddTask(t_none, Packages::MeshUtoP, md_sub_step_final.get(), IndexDomain::entire, false);
-        // As soon as we have primitive variables, apply floors
-        auto t_floors = tl.AddTask(t_utop, Packages::MeshApplyFloors, md_sub_step_final.get(), IndexDomain::entire);
-
-        // Then, fix any inversions which failed. Fixups average the adjacent zones, so we want to work from
-        // post-floor data. Floors are re-applied after fixups.
-        auto t_fix_p = tl.AddTask(t_floors, Inverter::MeshFixUtoP, md_sub_step_final.get());
+        // Optionally, all of the below as one stage: see Inverter::MeshUtoPFloorsFixup
+        TaskID t_fix_p;
+        if (fuse_floors_fixup) {
+            t_fix_p = tl.AddTask(t_none, Inverter::MeshUtoPFloorsFixup, md_sub_step_final.get());
+        } else {
+            auto t_utop = tl.AddTask(t_none, Packages::MeshUtoP, md_sub_step_final.get(), IndexDomain::entire, false);
+            // As soon as we have primitive variables, apply floors
+            auto t_floors = tl.AddTask(t_utop, Packages::MeshApplyFloors, md_sub_step_final.get(), IndexDomain::entire);
+
+            // Then, fix any inversions which failed. Fixups average the adjacent zones, so we want to work from
+            // post-floor data. Floors are re-applied after fixups.
+            t_fix_p = tl.AddTask(t_floors, Inverter::MeshFixUtoP, md_sub_step_final.get());
+        }
 
         // Domain (non-internal) boundary conditions:
-        // This is a parthenon call, but in spherical coordinates it will call the KHARMA functions in
-        // boundaries.cpp, which apply physical boundary conditions based on the primitive variables of GRHD,
+        // This is a parthenon call (unless <boundaries> mesh_level is set), but in spherical coordinates it will
+        // call the KHARMA functions in boundaries.cpp, which apply physical boundary conditions based on the primitive variables of GRHD,
         // and based on the conserved forms for everything else.  Note that because this is called *after*
         // UtoP (since it needs bulk fluid primitives to apply GRMHD boundaries), this function
         // must call UtoP *again* (for everything except the GRHD variables) to fill P in the ghost zones.
         // This is why KHARMA packages need to implement their UtoP functions in the form
         // UtoP(rc, domain, coarse): so that they can be run over just the boundary domains here.
-        auto t_set_bc = tl.AddTask(t_fix_p, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md_sync, false);
+        auto t_set_bc = tl.AddTask(t_fix_p, KBoundaries::ApplyBoundariesMesh, md_sync, false);
 
         // Add primitive-variable source terms:
         // In order to calculate dissipation, we must know the entropy at the beginning and end of the substep,
@@ -270,9 +306,19 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
         }
 
         // Make sure *all* conserved vars are synchronized at step end
-        auto t_ptou = tl.AddTask(t_heat_electrons, Flux::MeshPtoU, md_sub_step_final.get(), IndexDomain::entire, false);
+        // Floors, fixups and boundaries keep U in lockstep where they touch P, so optionally just catch flagged zones.
+        // Primitive source terms may modify any zone, so always take the full pass after them
+        TaskID t_ptou;
+        if (selective_ptou && !(stage == integrator->nstages && has_prim_source)) {
+            t_ptou = tl.AddTask(t_heat_electrons, Flux::MeshPtoUFlagged, md_sub_step_final.get(), IndexDomain::entire);
+        } else {
+            t_ptou = tl.AddTask(t_heat_electrons, Flux::MeshPtoU, md_sub_step_final.get(), IndexDomain::entire, false);
+        }
 
+        // Primitives are final for this substep, so optionally cache their FourVectors for the next
         auto t_step_done = t_ptou;
+        if (pmesh->packages.Get("GRMHD")->Param<bool>("cache_fourvectors"))
+            t_step_done = tl.AddTask(t_ptou, GRMHD::CacheFourVectors, md_sub_step_final.get());
 
         // Estimate next time step based on ctop
         if (stage == integrator->nstages) {
@@ -290,6 +336,9 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
     EndFlag();
     Flag("MakeTaskCollection::extras");
 
+    // Optionally start reducing the next timestep now, so it can overlap the rest of the step
+    if (stage == integrator->nstages) AddTimestepReductionRegion(tc);
+
     // B Field cleanup: this is a separate solve so it's split out
     // It's also really slow when enabled so we don't care too much about limiting regions, etc.
     if (use_b_cleanup && (stage == integrator->nstages) && B_Cleanup::CleanupThisStep(pmesh, tm.ncycle)) {
@@ -299,18 +348,13 @@ TaskCollection KHARMADriver::MakeDefaultTaskCollection(BlockList_t &blocks, int
         tl.AddTask(t_none, B_Cleanup::CleanupDivergence, md_sub_step_final);
     }
 
-    // TODO TODO make faster for large num_partitions, also this should be shared whole between drivers
     // Second boundary sync:
     // ensure that primitive variables in ghost zones are *exactly*
     // identical to their physical counterparts, now that they have been
     // modified on each rank.
     const auto &two_sync = pkgs.at("Driver")->Param<bool>("two_sync");
     if (two_sync) {
-        for (int i = 0; i < num_partitions; i++) {
-            auto &md_sub_step_final = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage], i);
-            auto &md_sync = pmesh->mesh_data.AddShallow("sync"+integrator->stage_name[stage]+std::to_string(i), md_sub_step_final, sync_vars);
-            KHARMADriver::AddFullSyncRegion(tc, md_sync);
-        }
+        KHARMADriver::AddFullSyncRegion(tc, integrator->stage_name[stage], sync_vars);
     }
 
     EndFlag();
@@ -33,9 +33,70 @@
  */
 #include "kharma_driver.hpp"
 
+#include "boundaries.hpp"
 #include "inverter.hpp"
+#include "ismr.hpp"
 #include "flux.hpp"
 
+/**
+ * Flux divergence, geometric source & RK update, all in one pass over the mesh:
+ * md_update = gam0 * md_sub_step_init + gam1 * md_full_step_init + beta_dt * (-divF + S),
+ * optionally copying the primitives of md_sub_step_init into md_update as a guess for UtoP.
+ * Updates the interior and "halo" zones beyond it, for which fluxes must be available.
+ * Only valid when Flux::AddGeoSource is the only source term.
+ */
+TaskStatus FusedStateUpdate(MeshData<Real> *md_full_step_init, MeshData<Real> *md_sub_step_init, MeshData<Real> *md_update,
+                            const Real gam0, const Real gam1, const Real beta_dt, const bool copy_prims, const int halo)
+{
+    Flag("FusedStateUpdate");
+    auto pmb0 = md_sub_step_init->GetBlockData(0)->GetBlockPointer();
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+    const EMHD::EMHD_parameters emhd_params = EMHD::GetEMHDParameters(pmb0->packages);
+    // All connection coefficients are zero in Cartesian Minkowski space
+    const bool add_geo = !pmb0->coords.coords.is_cart_minkowski();
+
+    const std::vector<MetadataFlag> cons_flags = {Metadata::Independent, Metadata::Cell, Metadata::WithFluxes};
+    const std::vector<MetadataFlag> prim_flags = {Metadata::GetUserFlag("Primitive")};
+    PackIndexMap cons_map, prims_map;
+    const auto &U_in   = md_sub_step_init->PackVariablesAndFluxes(cons_flags, cons_map);
+    const auto &U_base = md_full_step_init->PackVariables(cons_flags);
+    auto &U_out        = md_update->PackVariables(cons_flags);
+    const auto &P_in   = md_sub_step_init->PackVariables(prim_flags, prims_map);
+    auto &P_out        = md_update->PackVariables(prim_flags);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const Flux::ConnPattern conn = (add_geo) ? Flux::GetConnPattern(md_sub_step_init) : Flux::ConnPattern();
+    const int nvar  = U_in.GetDim(4);
+    const int nprim = P_in.GetDim(4);
+    const int ndim  = U_in.GetNdim();
+
+    const IndexRange3 b = KDomain::GetRange(md_sub_step_init, IndexDomain::interior, -halo, halo);
+    const IndexRange block = IndexRange{0, U_in.GetDim(5) - 1};
+    pmb0->par_for("fused_state_update", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int& bl, const int& k, const int& j, const int& i) {
+            const auto& G = U_in.GetCoords(bl);
+            // Geometric source, as in Flux::AddGeoSource
+            Real new_du[GR_DIM] = {0};
+            if (add_geo) {
+                FourVectors D;
+                GRMHD::calc_4vecs(G, P_in(bl), m_p, k, j, i, Loci::center, D);
+                Flux::geo_source(G, P_in(bl), m_p, D, emhd_params, gam, conn, k, j, i, new_du);
+            }
+
+            for (int l = 0; l < nvar; ++l) {
+                Real dudt = Update::FluxDivHelper(l, k, j, i, ndim, G, U_in(bl));
+                if (l == m_u.UU) dudt += new_du[0];
+                else if (l >= m_u.U1 && l < m_u.U1 + NVEC) dudt += new_du[1 + l - m_u.U1];
+                U_out(bl, l, k, j, i) = gam0 * U_in(bl, l, k, j, i) + gam1 * U_base(bl, l, k, j, i) + beta_dt * dudt;
+            }
+            if (copy_prims)
+                for (int p = 0; p < nprim; ++p)
+                    P_out(bl, p, k, j, i) = P_in(bl, p, k, j, i);
+        }
+    );
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int stage)
 {
     // This is probably incompatible with everything
@@ -49,6 +110,37 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
     // Which packages we've loaded affects which tasks we'll add to the list
     auto& pkgs         = blocks[0]->packages.AllPackages();
     auto& flux_pkg   = pkgs.at("Flux")->AllParams();
+    const bool fused = pkgs.at("Driver")->Param<bool>("simple_fused");
+    if (fused && stage == 1) {
+        // Everything beyond ideal GRMHD and Flux-CT either adds a source or needs its own pass
+        auto kpackages = pmesh->packages.AllPackagesOfType<KHARMAPackage>();
+        for (auto kpackage : kpackages) {
+            if (kpackage.second->AddSource != nullptr && kpackage.first != "Flux")
+                throw std::runtime_error("Fused simple driver does not support the source term of package "+kpackage.first);
+        }
+        if (!pkgs.count("B_FluxCT") || pkgs.count("Electrons") || pkgs.count("EMHD"))
+            throw std::runtime_error("Fused simple driver supports only ideal GRMHD with B_FluxCT!");
+    }
+
+    // With temporal blocking, ghost zones are exchanged only after the final stage.  Each earlier
+    // stage is also computed over a halo of ghost zones, wide enough to cover the stencil of every
+    // later stage: the reconstruction, one zone for the flux-CT EMFs, and one for UtoP fixups
+    const bool temporal_blocking = pkgs.at("Driver")->Param<bool>("temporal_blocking");
+    const int stage_width = flux_pkg.Get<int>("recon_stencil")/2 + 2;
+    const int halo = (temporal_blocking) ? (integrator->nstages - stage) * stage_width : 0;
+    const bool sync_stage = !temporal_blocking || stage == integrator->nstages;
+    if (temporal_blocking && stage == 1) {
+        if (!blocks[0]->coords.coords.is_cart_minkowski())
+            throw std::runtime_error("Temporal blocking supports only Cartesian Minkowski coordinates!");
+        if (!flux_pkg.Get<bool>("fused_flux"))
+            throw std::runtime_error("Temporal blocking requires <flux> fused = true!");
+        const int nghost_needed = halo + flux_pkg.Get<int>("recon_stencil")/2 + 1;
+        if (Globals::nghost < nghost_needed)
+            throw std::runtime_error("Temporal blocking with this integrator & reconstruction needs <driver> nghost >= "
+                                     + std::to_string(nghost_needed));
+    }
+    // Read by the fused flux & flux-CT kernels when they run below
+    pmesh->packages.Get("Flux")->UpdateParam<int>("stage_halo", halo);
 
     // Allocate the fluid states ("containers") we need for each block
     for (auto& pmb : blocks) {
@@ -77,6 +169,9 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
         auto &md_sub_step_init  = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage - 1], i);
         auto &md_sub_step_final = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage], i);
         auto &md_flux_src       = pmesh->mesh_data.GetOrAdd("dUdt", i);
+        // Exchange only what the following tasks read in ghost zones, see StateSyncVars
+        auto &md_sync = pmesh->mesh_data.AddShallow("sync"+integrator->stage_name[stage]+std::to_string(i), md_sub_step_final,
+                                                    StateSyncVars(pmesh->packages));
 
         // Calculate the flux of each variable through each face
         // This reconstructs the primitives (P) at faces and uses them to calculate fluxes
@@ -89,9 +184,19 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
         // etc 
         auto t_fix_flux = tl.AddTask(t_fluxes, Packages::FixFlux, md_sub_step_init.get());
 
+        if (fused) {
+            // Divergence, sources, and update in one pass, then straight to the boundary sync.
+            // The inversion, floors & fixups follow, fused, over the entire domain
+            auto t_update = tl.AddTask(t_fix_flux, FusedStateUpdate, md_full_step_init.get(), md_sub_step_init.get(),
+                                       md_sub_step_final.get(), integrator->gam0[stage-1], integrator->gam1[stage-1],
+                                       integrator->beta[stage-1] * integrator->dt, integrator->nstages > 1, halo);
+            if (sync_stage)
+                KHARMADriver::AddBoundarySync(t_update, tl, md_sync);
+            continue;
+        }
+
         // Apply the fluxes to calculate a change in cell-centered values "md_flux_src"
-        auto t_flux_div = tl.AddTask(t_fix_flux, FluxDivergence, md_sub_step_init.get(), md_flux_src.get(),
-                                    std::vector<MetadataFlag>{Metadata::Independent, Metadata::Cell, Metadata::WithFluxes}, 0);
+        auto t_flux_div = AddFluxDivergence(t_fix_flux, t_fix_flux, tl, md_sub_step_init.get(), md_flux_src.get());
 
         // Add any source terms: geometric \Gamma * T, wind, damping, etc etc
         auto t_sources = tl.AddTask(t_flux_div, Packages::AddSource, md_sub_step_init.get(), md_flux_src.get(), IndexDomain::interior);
@@ -110,6 +215,10 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
                                     1.0, integrator->beta[stage-1] * integrator->dt,
                                     md_sub_step_final.get());
 
+        // Merge zones near the poles, see ISMR
+        if (pmesh->packages.AllPackages().count("ISMR"))
+            t_update = tl.AddTask(t_avg_data | t_update, ISMR::DerefinePoles, md_sub_step_final.get());
+
         // UtoP needs a guess in order to converge, so we copy in md_sub_step_init
         auto t_copy_prims = t_update;
         if (integrator->nstages > 1) {
@@ -125,7 +234,7 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
         auto t_floors = tl.AddTask(t_UtoP, Packages::MeshApplyFloors, md_sub_step_final.get(), IndexDomain::interior);
 
         // Boundary sync: neighbors must be available for FixUtoP below
-        KHARMADriver::AddBoundarySync(t_floors, tl, md_sub_step_final);
+        KHARMADriver::AddBoundarySync(t_floors, tl, md_sync);
     }
 
     // Fix Region: prims/cons sync, floors, fixes, boundary conditions which need primitives
@@ -138,9 +247,10 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
         // Syncing bounds before calling this, and then running it over the whole domain, will make
         // behavior for different mesh breakdowns much more similar (identical?), since bad zones in
         // relevant ghost zone ranks will get to use all the same neighbors as if they were in the bulk
-        auto t_fix_p = tl.AddTask(t_none, Inverter::MeshFixUtoP, md_sub_step_final.get());
+        auto t_fix_p = (fused) ? tl.AddTask(t_none, Inverter::MeshUtoPFloorsFixup, md_sub_step_final.get())
+                               : tl.AddTask(t_none, Inverter::MeshFixUtoP, md_sub_step_final.get());
 
-        auto t_set_bc = tl.AddTask(t_fix_p, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md_sub_step_final, false);
+        auto t_set_bc = tl.AddTask(t_fix_p, KBoundaries::ApplyBoundariesMesh, md_sub_step_final, false);
 
         // Make sure *all* conserved vars are synchronized at step end
         auto t_ptou = tl.AddTask(t_set_bc, Flux::MeshPtoU, md_sub_step_final.get(), IndexDomain::entire, false);
@@ -154,14 +264,16 @@ TaskCollection KHARMADriver::MakeSimpleTaskCollection(BlockList_t &blocks, int s
         }
     }
 
+    // Optionally start reducing the next timestep now, so it can overlap the rest of the step
+    if (stage == integrator->nstages) AddTimestepReductionRegion(tc);
+
     // Second boundary sync:
     // ensure that primitive variables in ghost zones are *exactly*
     // identical to their physical counterparts, now that they have been
     // modified on each rank.
     const auto &two_sync = pkgs.at("Driver")->Param<bool>("two_sync");
-    if (two_sync) {
-        auto &md_sub_step_final = pmesh->mesh_data.GetOrAdd(integrator->stage_name[stage], 0);
-        KHARMADriver::AddFullSyncRegion(tc, md_sub_step_final);
+    if (two_sync && sync_stage) {
+        KHARMADriver::AddFullSyncRegion(tc, integrator->stage_name[stage], StateSyncVars(pmesh->packages));
     }
 
     return tc;
@@ -35,15 +35,19 @@
 
 #include "decs.hpp"
 #include "domain.hpp"
+#include "floors.hpp"
 #include "kharma_driver.hpp"
 #include "flux.hpp"
 #include "grmhd.hpp"
+#include "inverter.hpp"
 #include "kharma.hpp"
 #include "gaussian.hpp"
+#include "reductions_types.hpp"
 
 #include <parthenon/parthenon.hpp>
 #include <utils/string_utils.hpp>
 
+#include <limits>
 #include <string>
 
 using namespace parthenon;
@@ -55,6 +59,132 @@ using namespace parthenon;
 namespace Electrons
 {
 
+/**
+ * Heating fraction fits which can be tabulated, see BuildHeatingTables.
+ * These are used directly by heat_electrons_zone unless tabulate_heating is set.
+ */
+KOKKOS_INLINE_FUNCTION Real fel_kawazura(const Real& beta, const Real& Trat)
+{
+    // Equation (2) in http://www.pnas.org/lookup/doi/10.1073/pnas.1812491116
+    const Real QiQe = 35. / (1. + m::pow(beta/15., -1.4) * m::exp(-0.1 / Trat));
+    return 1./(1. + QiQe);
+}
+KOKKOS_INLINE_FUNCTION Real fel_werner(const Real& sigma)
+{
+    // Equation (3) in http://academic.oup.com/mnras/article/473/4/4840/4265350
+    return 0.25 * (1 + m::sqrt((sigma/5.) / (2 + (sigma/5.))));
+}
+KOKKOS_INLINE_FUNCTION Real fel_rowan(const Real& beta, const Real& sigma)
+{
+    // Equation (34) in https://iopscience.iop.org/article/10.3847/1538-4357/aa9380
+    const Real betamax = 0.25 / sigma;
+    return 0.5 * m::exp(-m::pow(1 - beta/betamax, 3.3) / (1 + 1.2*m::pow(sigma, 0.7)));
+}
+
+/**
+ * Linear & bilinear interpolation in a table tab on the given axes.
+ * Templated on the View so the startup check can read the host copy.
+ */
+template<typename V>
+KOKKOS_INLINE_FUNCTION Real interp_table(const V& tab, const TableAxis& ax, const Real& x)
+{
+    int i; Real w;
+    ax.locate(x, i, w);
+    return (1. - w) * tab(i) + w * tab(i+1);
+}
+template<typename V>
+KOKKOS_INLINE_FUNCTION Real interp_table(const V& tab, const TableAxis& ax, const TableAxis& ay,
+                                         const Real& x, const Real& y)
+{
+    int i, j; Real wx, wy;
+    ax.locate(x, i, wx);
+    ay.locate(y, j, wy);
+    return (1. - wy) * ((1. - wx) * tab(j, i) + wx * tab(j, i+1)) +
+                 wy  * ((1. - wx) * tab(j+1, i) + wx * tab(j+1, i+1));
+}
+
+/**
+ * Tabulate the Kawazura heating fraction in (log10 beta, log10 Tp/Te), Rowan's in (beta/betamax, log10 sigma),
+ * and Werner's in log10 sigma, and check each against its fit at the midpoints of the table cells,
+ * where bilinear interpolation is least accurate.
+ * Howes' fit is discontinuous at Tp/Te == 1, and Sharma's is a single square root, so both stay analytic.
+ */
+void BuildHeatingTables(ParameterInput *pin, HeatingParams& hp, int verbose)
+{
+    auto make_axis = [](Real min, Real max, int n) {
+        if (n < 2 || max <= min)
+            throw std::invalid_argument("Electron heating tables need at least 2 points over a nonempty range!");
+        return TableAxis{min, (max - min) / (n - 1), n};
+    };
+    hp.ax_log_beta = make_axis(pin->GetOrAddReal("electrons", "table_log_beta_min", -3.),
+                               pin->GetOrAddReal("electrons", "table_log_beta_max", 6.),
+                               pin->GetOrAddInteger("electrons", "table_n_beta", 256));
+    // Tp/Te is limited to [tp_over_te_min, tp_over_te_max] anyway when limit_kel is set.
+    // The fit is steepest in Tp/Te for Tp/Te << 1, needing the finer axis
+    hp.ax_log_trat = make_axis(log10(hp.tptemin), log10(hp.tptemax),
+                               pin->GetOrAddInteger("electrons", "table_n_trat", 1024));
+    hp.ax_log_sigma = make_axis(pin->GetOrAddReal("electrons", "table_log_sigma_min", -6.),
+                                pin->GetOrAddReal("electrons", "table_log_sigma_max", 3.),
+                                pin->GetOrAddInteger("electrons", "table_n_sigma", 256));
+    // Rowan's fit is only defined for beta <= betamax.  The table clamps larger beta to beta == betamax,
+    // i.e. fel = 1/2, where the fit itself would return NaN
+    hp.ax_beta_ratio = make_axis(0., 1., pin->GetOrAddInteger("electrons", "table_n_beta_ratio", 128));
+    const Real tolerance = pin->GetOrAddReal("electrons", "table_tolerance", 1.e-3);
+
+    const TableAxis &ab = hp.ax_log_beta, &at = hp.ax_log_trat, &as = hp.ax_log_sigma, &ar = hp.ax_beta_ratio;
+    hp.tab_kawazura = ParArray2D<Real>("tab_kawazura", at.n, ab.n);
+    hp.tab_rowan = ParArray2D<Real>("tab_rowan", as.n, ar.n);
+    hp.tab_werner = ParArray1D<Real>("tab_werner", as.n);
+    auto kawazura_h = Kokkos::create_mirror_view(hp.tab_kawazura);
+    auto rowan_h = Kokkos::create_mirror_view(hp.tab_rowan);
+    auto werner_h = Kokkos::create_mirror_view(hp.tab_werner);
+    // Fits as functions of the table variables
+    auto kawazura = [](Real lbeta, Real ltrat) { return fel_kawazura(pow(10., lbeta), pow(10., ltrat)); };
+    auto rowan = [](Real ratio, Real lsigma) {
+        const Real sigma = pow(10., lsigma);
+        return fel_rowan(ratio * 0.25 / sigma, sigma);
+    };
+    auto werner = [](Real lsigma) { return fel_werner(pow(10., lsigma)); };
+
+    for (int j = 0; j < at.n; ++j)
+        for (int i = 0; i < ab.n; ++i)
+            kawazura_h(j, i) = kawazura(ab.min + i * ab.delta, at.min + j * at.delta);
+    for (int j = 0; j < as.n; ++j) {
+        for (int i = 0; i < ar.n; ++i)
+            rowan_h(j, i) = rowan(ar.min + i * ar.delta, as.min + j * as.delta);
+        werner_h(j) = werner(as.min + j * as.delta);
+    }
+    Kokkos::deep_copy(hp.tab_kawazura, kawazura_h);
+    Kokkos::deep_copy(hp.tab_rowan, rowan_h);
+    Kokkos::deep_copy(hp.tab_werner, werner_h);
+
+    // Maximum absolute error in fel at the cell midpoints
+    Real err_kawazura = 0., err_rowan = 0., err_werner = 0.;
+    for (int j = 0; j < at.n - 1; ++j) {
+        for (int i = 0; i < ab.n - 1; ++i) {
+            const Real x = ab.min + (i + 0.5) * ab.delta, y = at.min + (j + 0.5) * at.delta;
+            err_kawazura = m::max(err_kawazura, m::abs(interp_table(kawazura_h, ab, at, x, y) - kawazura(x, y)));
+        }
+    }
+    for (int j = 0; j < as.n - 1; ++j) {
+        const Real y = as.min + (j + 0.5) * as.delta;
+        for (int i = 0; i < ar.n - 1; ++i) {
+            const Real x = ar.min + (i + 0.5) * ar.delta;
+            err_rowan = m::max(err_rowan, m::abs(interp_table(rowan_h, ar, as, x, y) - rowan(x, y)));
+        }
+        err_werner = m::max(err_werner, m::abs(interp_table(werner_h, as, y) - werner(y)));
+    }
+
+    if (verbose > 0 && MPIRank0()) {
+        printf("Tabulated electron heating, maximum error in fel: Kawazura %g, Rowan %g, Werner %g\n",
+               err_kawazura, err_rowan, err_werner);
+    }
+    if (err_kawazura > tolerance || err_rowan > tolerance || err_werner > tolerance) {
+        throw std::runtime_error("Electron heating tables are less accurate than table_tolerance! "
+                                 "Increase the table sizes or narrow their ranges.");
+    }
+}
+
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
 {
     auto pkg = std::make_shared<KHARMAPackage>("Electrons");
@@ -108,6 +238,42 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     bool do_sharma = pin->GetOrAddBoolean("electrons", "sharma", false);
     params.Add("do_sharma", do_sharma);
 
+    // Resolve the heating parameters once, for device-side use
+    HeatingParams heating_params;
+    heating_params.gam = packages->Get("GRMHD")->Param<Real>("gamma");
+    heating_params.gamp = gamma_p;
+    heating_params.game = gamma_e;
+    heating_params.fel_const = fel_const;
+    heating_params.tptemin = tp_over_te_min;
+    heating_params.tptemax = tp_over_te_max;
+    heating_params.suppress_highb_heat = suppress_highb_heat;
+    heating_params.enforce_positive_diss = enforce_positive_dissipation;
+    heating_params.limit_kel = limit_kel;
+    // The Floors ceiling on total entropy is also applied while heating, see heat_electrons_zone
+    if (pin->GetOrAddBoolean("floors", "on", true)) {
+        const Floors::Prescription floors = Floors::MakePrescription(pin);
+        const Floors::Prescription floors_inner = Floors::MakePrescriptionInner(pin, floors,
+                                                    pin->DoesBlockExist("floors_inner") ? "floors_inner" : "floors");
+        heating_params.ktot_max = floors.ktot_max;
+        heating_params.ktot_max_inner = floors_inner.ktot_max;
+        heating_params.radius_dependent_floors = floors.radius_dependent_floors;
+        heating_params.floors_switch_r = floors.floors_switch_r;
+    } else {
+        heating_params.ktot_max = heating_params.ktot_max_inner = std::numeric_limits<Real>::max();
+        heating_params.radius_dependent_floors = false;
+        heating_params.floors_switch_r = 0.;
+    }
+    // Optionally look up the heavier heating fits in tables rather than evaluating them in every zone
+    heating_params.tabulate = pin->GetOrAddBoolean("electrons", "tabulate_heating", false);
+    if (heating_params.tabulate)
+        BuildHeatingTables(pin, heating_params, packages->Get("Globals")->Param<int>("verbose"));
+    params.Add("heating_params", heating_params);
+    // Which heating kernel to run, see Models in electrons.hpp
+    const int heating_models = (do_constant ? Models::CONSTANT : 0) | (do_howes ? Models::HOWES : 0) |
+                               (do_kawazura ? Models::KAWAZURA : 0) | (do_werner ? Models::WERNER : 0) |
+                               (do_rowan ? Models::ROWAN : 0) | (do_sharma ? Models::SHARMA : 0);
+    params.Add("heating_models", heating_models);
+
     // Parse various mass and density units to set the different cooling rates
     // TODO actually respect them of course
     std::vector<Real> masses = pin->GetOrAddVector<Real>("electrons", "masses", std::vector<Real>{});
@@ -125,27 +291,62 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     bool implicit_e = (driver_type == DriverType::imex && pin->GetOrAddBoolean("electrons", "implicit", false));
     params.Add("implicit", implicit_e);
 
-    Metadata::AddUserFlag("Elec");
+    AddUserFlag("Elec");
     MetadataFlag areWeImplicit = (implicit_e) ? Metadata::GetUserFlag("Implicit")
                                               : Metadata::GetUserFlag("Explicit");
-    std::vector<MetadataFlag> flags_elec = {Metadata::Cell, areWeImplicit, Metadata::GetUserFlag("Elec")};
+    // All electron variables are entropies advected with the fluid, see BlockUtoP
+    std::vector<MetadataFlag> flags_elec = {Metadata::Cell, areWeImplicit, Metadata::GetUserFlag("Elec"),
+                                            Metadata::GetUserFlag("AdvectedScalar")};
 
     auto flags_prim = driver.Get<std::vector<MetadataFlag>>("prim_flags");
     flags_prim.insert(flags_prim.end(), flags_elec.begin(), flags_elec.end());
     auto flags_cons = driver.Get<std::vector<MetadataFlag>>("cons_flags");
     flags_cons.insert(flags_cons.end(), flags_elec.begin(), flags_elec.end());
 
+    // Optionally exchange the entropies at single precision, packed into "Electrons.halo", see PackHalo.
+    // Prolongation & restriction can't operate on packed values, so this requires a single-level mesh
+    bool halo_float = pin->GetOrAddBoolean("electrons", "halo_float", false);
+    if (halo_float) {
+        if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") != "none")
+            throw std::invalid_argument("Electron halo packing requires a mesh without refinement!");
+        // The entropies themselves are then left out of the exchange, but still get physical boundaries
+        for (auto flags : {&flags_prim, &flags_cons})
+            std::replace(flags->begin(), flags->end(), Metadata::FillGhost, Metadata::GetUserFlag("HaloFloat"));
+    }
+    params.Add("halo_float", halo_float);
+
     // Total entropy, used to track changes
     int nKs = 1;
     pkg->AddField("cons.Ktot", flags_cons);
     pkg->AddField("prims.Ktot", flags_prim);
 
     if ("driven_turbulence" == packages->Get("Globals")->Param<std::string>("problem")) {
-        std::vector<int> s_vector({2});
+        const bool is_3d = pin->GetOrAddInteger("parthenon/mesh", "nx3", 1) > 1;
+        std::vector<int> s_vector({is_3d ? 3 : 2});
         Metadata m_vector = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, s_vector);
         Metadata m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
         pkg->AddField("grf_normalized", m_vector);
         pkg->AddField("alfven_speed", m);
+
+        // Generate the driving field on the device unless asked for the host FFTW path.
+        // Device generation is reproducible for a given seed, see gaussian.hpp
+        bool device_grf = pin->GetOrAddBoolean("driven_turbulence", "device_grf", true);
+        params.Add("device_grf", device_grf);
+        int grf_seed = pin->GetOrAddInteger("driven_turbulence", "grf_seed", 31337);
+        params.Add("grf_seed", grf_seed);
+        // Cached twiddle factors per transform length
+        std::map<int, ParArray2D<Real>> grf_twiddles;
+        params.Add("grf_twiddles", grf_twiddles, true);
+
+        // The block-by-block forcing above is 2D, and each block transforms a field of its own size.
+        // Instead, 3D or multi-block runs can synthesize one global field, see SynthesizeGRF,
+        // normalized over the whole mesh after each step
+        bool distributed_grf = pin->GetOrAddBoolean("driven_turbulence", "distributed", is_3d);
+        params.Add("distributed_grf", distributed_grf);
+        int grf_n_max = pin->GetOrAddInteger("driven_turbulence", "n_max", 8);
+        params.Add("grf_n_max", grf_n_max);
+        if (distributed_grf)
+            pkg->PostStepWork = Electrons::ApplyDistributedForcing;
     }
 
     // Individual models
@@ -187,21 +388,91 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     // TODO if nKs == 1 then rename Kel_Whatever -> Kel?
     // TODO record nKs and find a nice way to loop/vector the device-side layout?
 
-    // Problem-specific fields
-    if (packages->Get("Globals")->Param<std::string>("problem") == "driven_turbulence") {
-        std::vector<int> s_vector({2});
-        Metadata m_vector = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, s_vector);
-        Metadata m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
-        pkg->AddField("grf_normalized", m_vector);
-        pkg->AddField("alfven_speed", m);
+    if (halo_float) {
+        if (sizeof(Real) != 2 * sizeof(float))
+            throw std::invalid_argument("Electron halo packing requires double-precision Reals!");
+        Metadata m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy, Metadata::FillGhost},
+                              std::vector<int>({(nKs + 1) / 2}));
+        pkg->AddField("Electrons.halo", m);
     }
 
     pkg->BlockUtoP = Electrons::BlockUtoP;
     pkg->BoundaryUtoP = Electrons::BlockUtoP;
+    // BlockUtoP is exactly the advected scalar conversion, which the Inverter can do for us
+    pkg->AdvectedScalars = true;
+    // The KHARMA & ImEx drivers limit entropies as they heat electrons, every sub-step.
+    // Only the simple driver, which doesn't heat, needs the separate pass
+    if (driver_type == DriverType::simple)
+        pkg->BlockApplyFloors = Electrons::ApplyFloors;
 
     return pkg;
 }
 
+namespace {
+const std::vector<std::string> halo_name{"Electrons.halo"};
+const std::vector<MetadataFlag>& HaloFlags()
+{
+    static const std::vector<MetadataFlag> flags{Metadata::GetUserFlag("Elec"), Metadata::GetUserFlag("HaloFloat")};
+    return flags;
+}
+} // namespace
+
+TaskStatus PackHalo(MeshData<Real> *md)
+{
+    auto halo = md->PackVariables(halo_name);
+    if (halo.GetDim(4) == 0) return TaskStatus::complete;
+    Flag("Electrons::PackHalo");
+    auto K = md->PackVariables(HaloFlags());
+    const int nK = K.GetDim(4);
+
+    // Neighbors read only interior zones
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, K.GetDim(5) - 1};
+    pmb0->par_for("pack_electron_halo", block.s, block.e, 0, halo.GetDim(4) - 1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &n, const int &k, const int &j, const int &i) {
+            const float pair[2] = {static_cast<float>(K(bl, 2*n, k, j, i)),
+                                   (2*n + 1 < nK) ? static_cast<float>(K(bl, 2*n + 1, k, j, i)) : 0.f};
+            Real packed;
+            memcpy(&packed, pair, sizeof(Real));
+            halo(bl, n, k, j, i) = packed;
+        }
+    );
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
+TaskStatus UnpackHalo(MeshData<Real> *md)
+{
+    auto halo = md->PackVariables(halo_name);
+    if (halo.GetDim(4) == 0) return TaskStatus::complete;
+    Flag("Electrons::UnpackHalo");
+    auto K = md->PackVariables(HaloFlags());
+    const int nK = K.GetDim(4);
+
+    // Restore only ghost zones filled from neighbors: physical boundaries are filled by their own conditions,
+    // and the interior keeps full precision
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto ranges = Inverter::GetPhysicalRanges(md);
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, K.GetDim(5) - 1};
+    pmb0->par_for("unpack_electron_halo", block.s, block.e, 0, halo.GetDim(4) - 1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &n, const int &k, const int &j, const int &i) {
+            if (KDomain::outside(k, j, i, ranges(bl)) || !KDomain::outside(k, j, i, bi)) return;
+            float pair[2];
+            const Real packed = halo(bl, n, k, j, i);
+            memcpy(pair, &packed, sizeof(Real));
+            K(bl, 2*n, k, j, i) = pair[0];
+            if (2*n + 1 < nK) K(bl, 2*n + 1, k, j, i) = pair[1];
+        }
+    );
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 TaskStatus InitElectrons(MeshBlockData<Real> *rc, ParameterInput *pin)
 {
     Flag("InitElectrons");
@@ -287,304 +558,570 @@ void BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
     );
 }
 
+/**
+ * Limits on electron entropy corresponding to tp_over_te_min/max, given the total entropy ktot
+ * and rho_pow = rho^(gam - gam_e).
+ * Note tp_te_min -> kel_max & vice versa
+ * Note this differs a little from Ressler '15, who ensure u_e/u_g > 0.01 rather than use temperatures
+ */
+KOKKOS_INLINE_FUNCTION void kel_limits(const HeatingParams& hp, const Real& ktot, const Real& rho_pow,
+                                       Real& kel_min, Real& kel_max)
+{
+    const Real ktot_rho = ktot * rho_pow;
+    kel_max = ktot_rho / (hp.tptemin * (hp.gam - 1.) / (hp.gamp-1.) + (hp.gam-1.) / (hp.game-1.)); //0.001
+    kel_min = ktot_rho / (hp.tptemax * (hp.gam - 1.) / (hp.gamp-1.) + (hp.gam-1.) / (hp.game-1.)); //1000
+}
+
+/**
+ * Apply the electron entropy limits if enabled with limit_kel
+ */
+KOKKOS_INLINE_FUNCTION Real limit_kel(const HeatingParams& hp, const Real& kel, const Real& kel_min, const Real& kel_max)
+{
+    return hp.limit_kel ? clip(kel, kel_min, kel_max) : kel;
+}
+
+/**
+ * Ceiling on the total entropy KTOT in zone (k, j, i), from the Floors prescription
+ */
+KOKKOS_INLINE_FUNCTION Real ktot_ceiling(const GRCoordinates& G, const HeatingParams& hp,
+                                         const int& k, const int& j, const int& i)
+{
+    return (hp.radius_dependent_floors && G.coords.is_spherical() && G.r(k, j, i) < hp.floors_switch_r)
+            ? hp.ktot_max_inner : hp.ktot_max;
+}
+
+/**
+ * Whether a model is heated in a kernel compiled for the set MODELS.
+ * This is a compile-time constant except for Models::ANY.
+ */
+template<int MODELS, int MODEL>
+KOKKOS_FORCEINLINE_FUNCTION bool has_model(const int& idx)
+{
+    if constexpr (MODELS == Models::ANY) {
+        return idx >= 0;
+    } else {
+        return MODELS & MODEL;
+    }
+}
+
+/**
+ * Heat each enabled electron model in a single zone, given the old and new primitives.
+ * bsq is taken from the old state's 4-vectors, which the caller computes once for all models.
+ * All entropy limits are applied here too: the Floors ceiling on KTOT, and tp_over_te_min/max on every model.
+ * Returns FFlag::KTOT if the ceiling was hit, else 0.
+ */
+template<int MODELS>
+KOKKOS_INLINE_FUNCTION int heat_electrons_zone(const GRCoordinates& G, const HeatingParams& hp, const Real& bsq,
+                                                const VariablePack<Real>& P, const VariablePack<Real>& P_new,
+                                                const VarMap& m_p, const int& k, const int& j, const int& i)
+{
+    // Old-state quantities shared by every model
+    const Real rho = P(m_p.RHO, k, j, i);
+    const Real rho_pow = m::pow(rho, hp.gam - hp.game);
+
+    // Calculate the new total entropy in this cell considering heating
+    const Real k_energy_conserving = (hp.gam-1.) * P_new(m_p.UU, k, j, i) / m::pow(P_new(m_p.RHO, k, j, i), hp.gam);
+
+    // Dissipation is the real entropy k_energy_conserving minus any advected entropy from the previous (sub-)step P_new(KTOT)
+    Real diss_tmp = (hp.game-1.) / (hp.gam-1.) * rho_pow * (k_energy_conserving - P_new(m_p.KTOT, k, j, i));
+    //this is eq27                  ratio of heating: Qi/Qe                           advected entropy from prev step
+    // ^ denotes the solution corresponding to entropy conservation
+
+    // Under the flag "suppress_highb_heat", we set all dissipation to zero at sigma > 1.
+    diss_tmp = (hp.suppress_highb_heat && (bsq / rho > 1.)) ? 0.0 : diss_tmp;
+
+    // Default is True diss_sign == Enforce nonnegative
+    // Due to floors we can end up with diss==0 or even *slightly* <0, so we require it to be positive here
+    const Real diss = hp.enforce_positive_diss ? m::max(diss_tmp, 0.0) : diss_tmp;
+
+    // Reset the entropy to measure next (sub-)step's dissipation, respecting any ceiling
+    const Real ktot_max = ktot_ceiling(G, hp, k, j, i);
+    const int fflag = (k_energy_conserving > ktot_max) ? Floors::FFlag::KTOT : 0;
+    P_new(m_p.KTOT, k, j, i) = m::min(k_energy_conserving, ktot_max);
+
+    // We'll be applying floors inline as we heat electrons, so
+    // we cache the floors as entropy limits so they'll be cheaper to apply.
+    Real kel_min, kel_max;
+    kel_limits(hp, P(m_p.KTOT, k, j, i), rho_pow, kel_min, kel_max);
+
+    // The ion temperature is useful for a few models, cache it too.
+    // The minimum values on Tpr & Tel here ensure that for un-initialized zones,
+    // Tpr/Tel == Tel/Tpr == 1 != NaN.  This condition should not be hit after step 1
+    const Real Tpr = m::max((hp.gamp - 1.) * P(m_p.UU, k, j, i) / rho, SMALL);
+    // Proton plasma beta, as used by the Howes & Kawazura models
+    const Real beta_p = m::min(rho * Tpr / bsq * 2, 1.e20); // If somebody enables electrons in a GRHD sim
+
+    // Heat different electron passives based on different dissipation fraction models
+    // Expressions here closely adapted (read: stolen) from implementation in iharm3d
+    // courtesy of Cesar Diaz, see https://github.com/AFD-Illinois/iharm3d
+    
+    // In all of these the electron entropy stored value is the entropy conserving solution 
+                         // and then when updated it becomes the energy conserving solution
+    if (has_model<MODELS, Models::CONSTANT>(m_p.K_CONSTANT)) {
+        const Real fel = hp.fel_const;
+        P_new(m_p.K_CONSTANT, k, j, i) = limit_kel(hp, P_new(m_p.K_CONSTANT, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    if (has_model<MODELS, Models::HOWES>(m_p.K_HOWES)) {
+        const Real Tel = m::max(P(m_p.K_HOWES, k, j, i) * m::pow(rho, hp.game-1), SMALL);
+
+        const Real Trat = Tpr / Tel;
+        const Real beta = beta_p;
+
+        const Real logTrat = log10(Trat);
+        const Real mbeta = 2. - 0.2*logTrat;
+
+        const Real c2 = (Trat <= 1.) ? 1.6/Trat : 1.2/Trat;
+        const Real c3 = (Trat <= 1.) ? 18. + 5.*logTrat : 18.;
+
+        const Real beta_pow = m::pow(beta, mbeta);
+        const Real qrat = 0.92 * (c2*c2 + beta_pow)/(c3*c3 + beta_pow) * m::exp(-1./beta) * m::sqrt(MP/ME * Trat);
+        const Real fel = 1./(1. + qrat);
+        P_new(m_p.K_HOWES, k, j, i) = limit_kel(hp, P_new(m_p.K_HOWES, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    if (has_model<MODELS, Models::KAWAZURA>(m_p.K_KAWAZURA)) {
+        const Real Tel = m::max(P(m_p.K_KAWAZURA, k, j, i) * m::pow(rho, hp.game-1), SMALL);
+
+        const Real Trat = Tpr / Tel;
+        const Real beta = beta_p;
+
+        const Real fel = hp.tabulate ? interp_table(hp.tab_kawazura, hp.ax_log_beta, hp.ax_log_trat,
+                                                    log10(beta), log10(Trat))
+                                     : fel_kawazura(beta, Trat);
+        P_new(m_p.K_KAWAZURA, k, j, i) = limit_kel(hp, P_new(m_p.K_KAWAZURA, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    // TODO KAWAZURA 19/20/21 separately?
+    if (has_model<MODELS, Models::WERNER>(m_p.K_WERNER)) {
+        const Real sigma = bsq / rho;
+        const Real fel = hp.tabulate ? interp_table(hp.tab_werner, hp.ax_log_sigma, log10(sigma))
+                                     : fel_werner(sigma);
+        P_new(m_p.K_WERNER, k, j, i) = limit_kel(hp, P_new(m_p.K_WERNER, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    if (has_model<MODELS, Models::ROWAN>(m_p.K_ROWAN)) {
+        const Real pres = (hp.gamp - 1.) * P(m_p.UU, k, j, i); // Proton pressure
+        const Real pg = (hp.gam - 1) * P(m_p.UU, k, j, i);
+        const Real beta = pres / bsq * 2;
+        const Real sigma = bsq / (rho + P(m_p.UU, k, j, i) + pg);
+        const Real fel = hp.tabulate ? interp_table(hp.tab_rowan, hp.ax_beta_ratio, hp.ax_log_sigma,
+                                                    4. * beta * sigma, log10(sigma))
+                                     : fel_rowan(beta, sigma);
+        P_new(m_p.K_ROWAN, k, j, i) = limit_kel(hp, P_new(m_p.K_ROWAN, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    if (has_model<MODELS, Models::SHARMA>(m_p.K_SHARMA)) {
+        // Equation for \delta on  pg. 719 (Section 4) in https://iopscience.iop.org/article/10.1086/520800
+        const Real Tel = m::max(P(m_p.K_SHARMA, k, j, i) * m::pow(rho, hp.game-1), SMALL);
+
+        const Real Trat_inv = Tel / Tpr; // Inverse of the temperature ratio in KAWAZURA
+        const Real QeQi = 0.33 * m::sqrt(Trat_inv);
+        const Real fel = 1./(1.+1./QeQi);
+        P_new(m_p.K_SHARMA, k, j, i) = limit_kel(hp, P_new(m_p.K_SHARMA, k, j, i) + fel * diss, kel_min, kel_max);
+    }
+    // Conserved variables are updated at the end of the step
+    return fflag;
+}
+
+/**
+ * Driven turbulence problem: kick the fluid velocity with a Gaussian random field.
+ * A couple of the electron test problems add source terms to the *fluid*.
+ * We bundle them here because they're generally relevant alongside e- heating,
+ * and should be applied at the same time
+ */
+void ApplyDrivenForcing(MeshBlockData<Real> *rc_old, MeshBlockData<Real> *rc, bool generate_grf)
+{
+    PackIndexMap prims_map;
+    auto& P = rc_old->PackVariables({Metadata::GetUserFlag("Primitive")}, prims_map);
+    const VarMap m_p(prims_map, false);
+
+    auto pmb = rc->GetBlockPointer();
+
+    const IndexRange myib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+    const IndexRange myjb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+    const IndexRange mykb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
+    // Gaussian random field:
+    const auto& G = pmb->coords;
+    GridScalar rho = rc->Get("prims.rho").data;
+    GridVector uvec = rc->Get("prims.uvec").data;
+    GridVector grf_normalized = rc->Get("grf_normalized").data;
+    const Real t = pmb->packages.Get("Globals")->Param<Real>("time");
+    Real counter = pmb->packages.Get("GRMHD")->Param<Real>("counter");
+    const Real dt_kick=  pmb->packages.Get("GRMHD")->Param<Real>("dt_kick");
+    if (generate_grf && counter < t) {
+        counter += dt_kick;
+        pmb->packages.Get("GRMHD")->UpdateParam<Real>("counter", counter);
+        printf("Kick applied at time %.32f\n", t);
+
+        const Real lx1=  pmb->packages.Get("GRMHD")->Param<Real>("lx1");
+        const Real lx2=  pmb->packages.Get("GRMHD")->Param<Real>("lx2");
+        const Real edot= pmb->packages.Get("GRMHD")->Param<Real>("drive_edot");
+        GridScalar alfven_speed = rc->Get("alfven_speed").data;
+        
+        int Nx1 = pmb->cellbounds.ncellsi(IndexDomain::interior);
+        int Nx2 = pmb->cellbounds.ncellsj(IndexDomain::interior);
+        // The field lives on the device, indexed from the first interior zone
+        const int is = myib.s, js = myjb.s;
+        ParArray2D<Real> dv0("dv0", Nx1, Nx2), dv1("dv1", Nx1, Nx2);
+        if (pmb->packages.Get("Electrons")->Param<bool>("device_grf")) {
+            const uint32_t seed = pmb->packages.Get("Electrons")->Param<int>("grf_seed");
+            const uint32_t kick = static_cast<uint32_t>(counter / dt_kick);
+            CreateGRFDevice(pmb->packages.Get("Electrons").get(), Nx1, Nx2, lx1, lx2, seed, kick, dv0, dv1);
+        } else {
+            std::vector<Real> dv0_flat(Nx1*Nx2), dv1_flat(Nx1*Nx2);
+            create_grf(Nx1, Nx2, lx1, lx2, dv0_flat.data(), dv1_flat.data());
+            auto dv0_host = Kokkos::create_mirror_view(dv0);
+            auto dv1_host = Kokkos::create_mirror_view(dv1);
+            for (int i = 0; i < Nx1; i++) {
+                for (int j = 0; j < Nx2; j++) {
+                    dv0_host(i, j) = dv0_flat[i*Nx1+j];
+                    dv1_host(i, j) = dv1_flat[i*Nx1+j];
+                }
+            }
+            Kokkos::deep_copy(dv0, dv0_host);
+            Kokkos::deep_copy(dv1, dv1_host);
+        }
+
+        Real mean_velocity_num0 = 0;    Kokkos::Sum<Real> mean_velocity_num0_reducer(mean_velocity_num0);
+        Real mean_velocity_num1 = 0;    Kokkos::Sum<Real> mean_velocity_num1_reducer(mean_velocity_num1);
+        Real tot_mass = 0;              Kokkos::Sum<Real> tot_mass_reducer(tot_mass);
+        pmb->par_reduce("forced_mhd_normal_kick_centering_mean_vel0", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += cell_mass * dv0(i-is, j-js);
+            }
+        , mean_velocity_num0_reducer);
+        pmb->par_reduce("forced_mhd_normal_kick_centering_mean_vel1", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += cell_mass * dv1(i-is, j-js);
+            }
+        , mean_velocity_num1_reducer);
+        pmb->par_reduce("forced_mhd_normal_kick_centering_tot_mass", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                local_result += (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+            }
+        , tot_mass_reducer);
+        Real mean_velocity0 = mean_velocity_num0/tot_mass;
+        Real mean_velocity1 = mean_velocity_num1/tot_mass;
+        pmb->par_for("forced_mhd_normal_kick_centering", 0, Nx1 - 1, 0, Nx2 - 1,
+            KOKKOS_LAMBDA(const int i, const int j) {
+                dv0(i, j) -= mean_velocity0;
+                dv1(i, j) -= mean_velocity1;
+            }
+        );
+
+        Real Bhalf = 0; Real A = 0; Real init_e = 0; 
+        Kokkos::Sum<Real> Bhalf_reducer(Bhalf); Kokkos::Sum<Real> A_reducer(A); Kokkos::Sum<Real> init_e_reducer(init_e);
+        pmb->par_reduce("forced_mhd_normal_kick_normalization_Bhalf", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += cell_mass * (dv0(i-is, j-js)*uvec(0, k, j, i) + dv1(i-is, j-js)*uvec(1, k, j, i));
+            }
+        , Bhalf_reducer);
+        pmb->par_reduce("forced_mhd_normal_kick_normalization_A", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += cell_mass * (pow(dv0(i-is, j-js), 2) + pow(dv1(i-is, j-js), 2));
+            }
+        , A_reducer);
+        pmb->par_reduce("forced_mhd_normal_kick_init_e", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += 0.5 * cell_mass * (pow(uvec(0, k, j, i), 2) + pow(uvec(1, k, j, i), 2));
+            }
+        , init_e_reducer);
+
+        Real norm_const = (-Bhalf + pow(pow(Bhalf,2) + A*2*dt_kick*edot, 0.5))/A;  // going from k:(0, 0), j:(4, 515), i:(4, 515) inclusive
+        pmb->par_for("forced_mhd_normal_kick_setting", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i) {
+                grf_normalized(0, k, j, i) = (dv0(i-is, j-js)*norm_const);
+                grf_normalized(1, k, j, i) = (dv1(i-is, j-js)*norm_const);
+                uvec(0, k, j, i) += grf_normalized(0, k, j, i);
+                uvec(1, k, j, i) += grf_normalized(1, k, j, i);
+                FourVectors Dtmp;
+                GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
+                Real bsq = dot(Dtmp.bcon, Dtmp.bcov);
+                alfven_speed(k,j,i) = bsq/rho(k, j, i); //saving alfven speed for analysis purposes
+            }
+        );
+
+        Real finl_e = 0;    Kokkos::Sum<Real> finl_e_reducer(finl_e);
+        pmb->par_reduce("forced_mhd_normal_kick_finl_e", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
+            KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
+                Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
+                local_result += 0.5 * cell_mass * (pow(uvec(0, k, j, i), 2) + pow(uvec(1, k, j, i), 2));
+            }
+        , finl_e_reducer);
+        printf("%.32f\n", A); printf("%.32f\n", Bhalf); printf("%.32f\n", norm_const);
+        printf("%.32f\n", (finl_e-init_e)/dt_kick);
+    }
+    // This could be only the GRMHD vars, for this problem, but speed isn't really an issue
+    Flux::BlockPtoU(rc, IndexDomain::interior);
+}
+
 TaskStatus ApplyElectronHeating(MeshBlockData<Real> *rc_old, MeshBlockData<Real> *rc, bool generate_grf)
 {
+    Flag("ApplyElectronHeating");
     // Need to distinguish different electron models
     // So far, Parthenon's maps of the same sets of variables are consistent,
     // so we only bother with one map of the primitives
     // TODO Parthenon can definitely build a pack from a map, though
-    PackIndexMap prims_map, cons_map;
+    PackIndexMap prims_map;
     auto& P = rc_old->PackVariables({Metadata::GetUserFlag("Primitive")}, prims_map);
     auto& P_new = rc->PackVariables({Metadata::GetUserFlag("Primitive")}, prims_map);
-    auto& U_new = rc->PackVariables({Metadata::Conserved}, cons_map);
-    const VarMap m_p(prims_map, false), m_u(cons_map, true);
+    const VarMap m_p(prims_map, false);
 
     auto pmb = rc->GetBlockPointer();
     const auto& G = pmb->coords;
 
-    const Real gam = pmb->packages.Get("GRMHD")->Param<Real>("gamma");
-    const Real gamp = pmb->packages.Get("Electrons")->Param<Real>("gamma_p");
-    const Real game = pmb->packages.Get("Electrons")->Param<Real>("gamma_e");
-    const Real fel_const = pmb->packages.Get("Electrons")->Param<Real>("fel_constant");
-    const bool suppress_highb_heat = pmb->packages.Get("Electrons")->Param<bool>("suppress_highb_heat");
-    // Floors
-    const Real tptemin = pmb->packages.Get("Electrons")->Param<Real>("tp_over_te_min");
-    const Real tptemax = pmb->packages.Get("Electrons")->Param<Real>("tp_over_te_max");
-    const bool enforce_positive_diss = pmb->packages.Get("Electrons")->Param<bool>("enforce_positive_dissipation");
-    const bool limit_kel = pmb->packages.Get("Electrons")->Param<bool>("limit_kel");
+    auto fflag = rc->PackVariables(std::vector<std::string>{"fflag"});
+    const bool record_fflag = fflag.GetDim(4) > 0;
+
+    const HeatingParams hp = pmb->packages.Get("Electrons")->Param<HeatingParams>("heating_params");
 
     // This function (and any primitive-variable sources) needs to be run over the entire domain,
     // because the boundary zones have already been updated and so the same calculations must be applied
     // in order to keep them consistent.
     // See kharma_step.cpp for the full picture of what gets updated when.
-    const IndexRange ib = rc->GetBoundsI(IndexDomain::entire);
-    const IndexRange jb = rc->GetBoundsJ(IndexDomain::entire);
-    const IndexRange kb = rc->GetBoundsK(IndexDomain::entire);
-    pmb->par_for("heat_electrons", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+    const IndexRange3 b = KDomain::GetRange(rc, IndexDomain::entire);
+    pmb->par_for("heat_electrons", b.ks, b.ke, b.js, b.je, b.is, b.ie,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
             FourVectors Dtmp;
             GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
-            Real bsq = dot(Dtmp.bcon, Dtmp.bcov);
-
-            // Calculate the new total entropy in this cell considering heating
-            const Real k_energy_conserving = (gam-1.) * P_new(m_p.UU, k, j, i) / m::pow(P_new(m_p.RHO, k, j, i), gam);
-
-            // Dissipation is the real entropy k_energy_conserving minus any advected entropy from the previous (sub-)step P_new(KTOT)
-            Real diss_tmp = (game-1.) / (gam-1.) * m::pow(P(m_p.RHO, k, j, i), gam - game) * (k_energy_conserving - P_new(m_p.KTOT, k, j, i));
-            //this is eq27                  ratio of heating: Qi/Qe                           advected entropy from prev step
-            // ^ denotes the solution corresponding to entropy conservation
-
-            // Under the flag "suppress_highb_heat", we set all dissipation to zero at sigma > 1.
-            diss_tmp = (suppress_highb_heat && (bsq / P(m_p.RHO, k, j, i) > 1.)) ? 0.0 : diss_tmp;
-
-            // Default is True diss_sign == Enforce nonnegative
-            // Due to floors we can end up with diss==0 or even *slightly* <0, so we require it to be positive here
-            const Real diss = enforce_positive_diss ? m::max(diss_tmp, 0.0) : diss_tmp;
-
-            // Reset the entropy to measure next (sub-)step's dissipation
-            P_new(m_p.KTOT, k, j, i) = k_energy_conserving;
-
-            // We'll be applying floors inline as we heat electrons, so
-            // we cache the floors as entropy limits so they'll be cheaper to apply.
-            // Note tp_te_min -> kel_max & vice versa
-            const Real kel_max = P(m_p.KTOT, k, j, i) * m::pow(P(m_p.RHO, k, j, i), gam - game) /
-                                    (tptemin * (gam - 1.) / (gamp-1.) + (gam-1.) / (game-1.)); //0.001
-            const Real kel_min = P(m_p.KTOT, k, j, i) * m::pow(P(m_p.RHO, k, j, i), gam - game) /
-                                    (tptemax * (gam - 1.) / (gamp-1.) + (gam-1.) / (game-1.)); //1000
-            // Note this differs a little from Ressler '15, who ensure u_e/u_g > 0.01 rather than use temperatures
-
-            // The ion temperature is useful for a few models, cache it too.
-            // The minimum values on Tpr & Tel here ensure that for un-initialized zones,
-            // Tpr/Tel == Tel/Tpr == 1 != NaN.  This condition should not be hit after step 1
-            const Real Tpr = m::max((gamp - 1.) * P(m_p.UU, k, j, i) / P(m_p.RHO, k, j, i), SMALL);
-
-            // Heat different electron passives based on different dissipation fraction models
-            // Expressions here closely adapted (read: stolen) from implementation in iharm3d
-            // courtesy of Cesar Diaz, see https://github.com/AFD-Illinois/iharm3d
-            
-            // In all of these the electron entropy stored value is the entropy conserving solution 
-                                 // and then when updated it becomes the energy conserving solution
-            if (m_p.K_CONSTANT >= 0) {
-                const Real fel = fel_const;
-                // Default is true then enforce kel limits with clamp/clip, else no restrictions on kel
-                if (limit_kel) {
-                    P_new(m_p.K_CONSTANT, k, j, i) = clip(P_new(m_p.K_CONSTANT, k, j, i) + fel * diss, kel_min, kel_max);
-                } else {
-                    P_new(m_p.K_CONSTANT, k, j, i) += fel * diss;
-                }
-            }
-            if (m_p.K_HOWES >= 0) {
-                const Real Tel = m::max(P(m_p.K_HOWES, k, j, i) * m::pow(P(m_p.RHO, k, j, i), game-1), SMALL);
+            const int fflag_l = heat_electrons_zone<Models::ANY>(G, hp, dot(Dtmp.bcon, Dtmp.bcov), P, P_new, m_p, k, j, i);
+            if (record_fflag)
+                Floors::FFlag::add_codes(fflag(0, k, j, i), fflag_l);
+        }
+    );
 
-                const Real Trat = Tpr / Tel;
-                const Real pres = P(m_p.RHO, k, j, i) * Tpr; // Proton pressure
-                const Real beta = m::min(pres / bsq * 2, 1.e20);// If somebody enables electrons in a GRHD sim
+    if (pmb->packages.Get("Globals")->Param<std::string>("problem") == "driven_turbulence" &&
+        !pmb->packages.Get("Electrons")->Param<bool>("distributed_grf"))
+        ApplyDrivenForcing(rc_old, rc, generate_grf);
 
-                const Real logTrat = log10(Trat);
-                const Real mbeta = 2. - 0.2*logTrat;
+    EndFlag();
+    return TaskStatus::complete;
+}
 
-                const Real c2 = (Trat <= 1.) ? 1.6/Trat : 1.2/Trat;
-                const Real c3 = (Trat <= 1.) ? 18. + 5.*logTrat : 18.;
+/**
+ * Launch the mesh heating kernel compiled for the model set MODELS
+ */
+template<int MODELS>
+void HeatElectrons(MeshData<Real> *md_old, MeshData<Real> *md, const HeatingParams& hp)
+{
+    // As above, the old and new packs share one map
+    PackIndexMap prims_map;
+    auto P = md_old->PackVariables(PackFlags::Primitive(), prims_map);
+    auto P_new = md->PackVariables(PackFlags::Primitive(), prims_map);
+    const VarMap m_p(prims_map, false);
+    static const std::vector<std::string> fflag_name{"fflag"};
+    auto fflag = md->PackVariables(fflag_name);
+    const bool record_fflag = fflag.GetDim(4) > 0;
+
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    // One launch over every zone of every block, ghosts included as above
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, P_new.GetDim(5) - 1};
+    pmb0->par_for("heat_electrons", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            const auto& G = P_new.GetCoords(bl);
+            FourVectors Dtmp;
+            GRMHD::calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, Dtmp);
+            const int fflag_l = heat_electrons_zone<MODELS>(G, hp, dot(Dtmp.bcon, Dtmp.bcov), P(bl), P_new(bl), m_p, k, j, i);
+            if (record_fflag)
+                Floors::FFlag::add_codes(fflag(bl, 0, k, j, i), fflag_l);
+        }
+    );
+}
 
-                const Real beta_pow = m::pow(beta, mbeta);
-                const Real qrat = 0.92 * (c2*c2 + beta_pow)/(c3*c3 + beta_pow) * m::exp(-1./beta) * m::sqrt(MP/ME * Trat);
-                const Real fel = 1./(1. + qrat);
-                P_new(m_p.K_HOWES, k, j, i) = clip(P_new(m_p.K_HOWES, k, j, i) + fel * diss, kel_min, kel_max);
-            }
-            if (m_p.K_KAWAZURA >= 0) {
-                // Equation (2) in http://www.pnas.org/lookup/doi/10.1073/pnas.1812491116
-                const Real Tel = m::max(P(m_p.K_KAWAZURA, k, j, i) * m::pow(P(m_p.RHO, k, j, i), game-1), SMALL);
+TaskStatus MeshApplyElectronHeating(MeshData<Real> *md_old, MeshData<Real> *md, bool generate_grf)
+{
+    Flag("MeshApplyElectronHeating");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const auto& pars = pmb0->packages.Get("Electrons")->AllParams();
+    const HeatingParams hp = pars.Get<HeatingParams>("heating_params");
+
+    // Common model sets get their own kernels, anything else checks the models per-zone
+    switch (pars.Get<int>("heating_models")) {
+    case Models::HOWES | Models::KAWAZURA:
+        HeatElectrons<Models::HOWES | Models::KAWAZURA>(md_old, md, hp);
+        break;
+    case Models::ALL:
+        HeatElectrons<Models::ALL>(md_old, md, hp);
+        break;
+    case Models::CONSTANT:
+        HeatElectrons<Models::CONSTANT>(md_old, md, hp);
+        break;
+    default:
+        HeatElectrons<Models::ANY>(md_old, md, hp);
+    }
 
-                const Real Trat = Tpr / Tel;
-                const Real pres = P(m_p.RHO, k, j, i) * Tpr; // Proton pressure
-                const Real beta = m::min(pres / bsq * 2, 1.e20);// If somebody enables electrons in a GRHD sim
+    // Problem forcing reduces over each block separately, so it stays per-block
+    if (pmb0->packages.Get("Globals")->Param<std::string>("problem") == "driven_turbulence" &&
+        !pars.Get<bool>("distributed_grf")) {
+        for (int i=0; i < md->NumBlocks(); ++i)
+            ApplyDrivenForcing(md_old->GetBlockData(i).get(), md->GetBlockData(i).get(), generate_grf);
+    }
 
-                const Real QiQe = 35. / (1. + m::pow(beta/15., -1.4) * m::exp(-0.1 / Trat));
-                const Real fel = 1./(1. + QiQe);
-                P_new(m_p.K_KAWAZURA, k, j, i) = clip(P_new(m_p.K_KAWAZURA, k, j, i) + fel * diss, kel_min, kel_max);
-            }
-            // TODO KAWAZURA 19/20/21 separately?
-            if (m_p.K_WERNER >= 0) {
-                // Equation (3) in http://academic.oup.com/mnras/article/473/4/4840/4265350
-                const Real sigma = bsq / P(m_p.RHO, k, j, i);
-                const Real fel = 0.25 * (1 + m::sqrt((sigma/5.) / (2 + (sigma/5.))));
-                P_new(m_p.K_WERNER, k, j, i) = clip(P_new(m_p.K_WERNER, k, j, i) + fel * diss, kel_min, kel_max);
-            }
-            if (m_p.K_ROWAN >= 0) {
-                // Equation (34) in https://iopscience.iop.org/article/10.3847/1538-4357/aa9380
-                const Real pres = (gamp - 1.) * P(m_p.UU, k, j, i); // Proton pressure
-                const Real pg = (gam - 1) * P(m_p.UU, k, j, i);
-                const Real beta = pres / bsq * 2;
-                const Real sigma = bsq / (P(m_p.RHO, k, j, i) + P(m_p.UU, k, j, i) + pg);
-                const Real betamax = 0.25 / sigma;
-                const Real fel = 0.5 * m::exp(-m::pow(1 - beta/betamax, 3.3) / (1 + 1.2*m::pow(sigma, 0.7)));
-                P_new(m_p.K_ROWAN, k, j, i) = clip(P_new(m_p.K_ROWAN, k, j, i) + fel * diss, kel_min, kel_max);
+    EndFlag();
+    return TaskStatus::complete;
+}
+
+/**
+ * Sum four mass-weighted quantities f(bl, k, j, i, cell_mass, sums) over the interior of every block on every rank
+ */
+template<typename F>
+Reductions::array_type<Real, 4> GlobalMassSum(MeshData<Real> *md, const std::string& name, const F& f)
+{
+    PackIndexMap prims_map;
+    auto P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    const VarMap m_p(prims_map, false);
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
+
+    Reductions::array_type<Real, 4> sums;
+    pmb0->par_reduce(name, block.s, block.e, bi.ks, bi.ke, bi.js, bi.je, bi.is, bi.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i,
+                       Reductions::array_type<Real, 4> &local_result) {
+            const auto& G = P.GetCoords(bl);
+            const Real cell_mass = P(bl, m_p.RHO, k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i);
+            f(bl, k, j, i, cell_mass, local_result);
+        }
+    , Reductions::ArraySum<Real, HostExecSpace, 4>(sums));
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sums.my_array, 4, MPI_PARTHENON_REAL, MPI_SUM,
+                                      MPI_COMM_WORLD));
+#endif
+    return sums;
+}
+
+void ApplyDistributedForcing(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    auto& grmhd_pars = pmesh->packages.Get("GRMHD")->AllParams();
+    const Real t = pmesh->packages.Get("Globals")->Param<Real>("time");
+    Real counter = grmhd_pars.Get<Real>("counter");
+    const Real dt_kick = grmhd_pars.Get<Real>("dt_kick");
+    if (counter >= t) return;
+    Flag("ApplyDistributedForcing");
+    counter += dt_kick;
+    grmhd_pars.Update<Real>("counter", counter);
+    if (MPIRank0()) printf("Kick applied at time %.32f\n", t);
+
+    const auto& pars = pmesh->packages.Get("Electrons")->AllParams();
+    const Real lx[3] = {grmhd_pars.Get<Real>("lx1"), grmhd_pars.Get<Real>("lx2"), grmhd_pars.Get<Real>("lx3")};
+    const Real edot = grmhd_pars.Get<Real>("drive_edot");
+    const int ncomp = (pmesh->ndim > 2) ? 3 : 2;
+
+    auto &md = pmesh->mesh_data.Get();
+    PackIndexMap prims_map;
+    auto P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    const VarMap m_p(prims_map, false);
+    auto grf_normalized = md->PackVariables(std::vector<std::string>{"grf_normalized"});
+    auto alfven_speed = md->PackVariables(std::vector<std::string>{"alfven_speed"});
+
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
+
+    // The field is defined everywhere, so ghost zones get the same kick as the zones they mirror
+    ParArray5D<Real> dv("grf_dv", P.GetDim(5), 3, b.ke + 1, b.je + 1, b.ie + 1);
+    SynthesizeGRF(md.get(), lx, pars.Get<int>("grf_n_max"), ncomp, pars.Get<int>("grf_seed"),
+                  static_cast<uint32_t>(counter / dt_kick), dv);
+
+    // Remove the mass-weighted mean velocity of the field
+    const auto means = GlobalMassSum(md.get(), "forced_mhd_distributed_mean",
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, const Real &cell_mass,
+                       Reductions::array_type<Real, 4> &local_result) {
+            for (int c = 0; c < ncomp; ++c) local_result.my_array[c] += cell_mass * dv(bl, c, k, j, i);
+            local_result.my_array[3] += cell_mass;
+        });
+    const Real tot_mass = means.my_array[3];
+    const Real mean_v[3] = {means.my_array[0] / tot_mass, means.my_array[1] / tot_mass,
+                            (ncomp > 2) ? means.my_array[2] / tot_mass : 0.};
+    pmb0->par_for("forced_mhd_distributed_centering", block.s, block.e, 0, ncomp - 1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &c, const int &k, const int &j, const int &i) {
+            dv(bl, c, k, j, i) -= (c == 0) ? mean_v[0] : ((c == 1) ? mean_v[1] : mean_v[2]);
+        }
+    );
+
+    // Normalize to inject energy at the rate edot, as in ApplyDrivenForcing
+    const auto norms = GlobalMassSum(md.get(), "forced_mhd_distributed_normalization",
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, const Real &cell_mass,
+                       Reductions::array_type<Real, 4> &local_result) {
+            for (int c = 0; c < ncomp; ++c) {
+                const Real dvc = dv(bl, c, k, j, i);
+                const Real uc = P(bl, m_p.U1 + c, k, j, i);
+                local_result.my_array[0] += cell_mass * dvc * uc;
+                local_result.my_array[1] += cell_mass * dvc * dvc;
+                local_result.my_array[2] += 0.5 * cell_mass * uc * uc;
             }
-            if (m_p.K_SHARMA >= 0) {
-                // Equation for \delta on  pg. 719 (Section 4) in https://iopscience.iop.org/article/10.1086/520800
-                const Real Tel = m::max(P(m_p.K_SHARMA, k, j, i) * m::pow(P(m_p.RHO, k, j, i), game-1), SMALL);
-
-                const Real Trat_inv = Tel / Tpr; // Inverse of the temperature ratio in KAWAZURA
-                const Real QeQi = 0.33 * m::sqrt(Trat_inv);
-                const Real fel = 1./(1.+1./QeQi);
-                P_new(m_p.K_SHARMA, k, j, i) = clip(P_new(m_p.K_SHARMA, k, j, i) + fel * diss, kel_min, kel_max);
+        });
+    const Real Bhalf = norms.my_array[0], A = norms.my_array[1], init_e = norms.my_array[2];
+    const Real norm_const = (-Bhalf + m::sqrt(Bhalf*Bhalf + A*2*dt_kick*edot))/A;
+
+    pmb0->par_for("forced_mhd_distributed_kick", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            const auto& G = P.GetCoords(bl);
+            for (int c = 0; c < ncomp; ++c) {
+                grf_normalized(bl, c, k, j, i) = dv(bl, c, k, j, i) * norm_const;
+                P(bl, m_p.U1 + c, k, j, i) += grf_normalized(bl, c, k, j, i);
             }
-            // Conserved variables are updated at the end of the step
+            FourVectors Dtmp;
+            GRMHD::calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, Dtmp);
+            alfven_speed(bl, 0, k, j, i) = dot(Dtmp.bcon, Dtmp.bcov) / P(bl, m_p.RHO, k, j, i);
         }
     );
 
-    const IndexRange myib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
-    const IndexRange myjb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
-    const IndexRange mykb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
-    // A couple of the electron test problems add source terms to the *fluid*.
-    // we bundle them here because they're generally relevant alongside e- heating,
-    // and should be applied at the same time
-    const std::string prob = pmb->packages.Get("Globals")->Param<std::string>("problem");
-    if (prob == "driven_turbulence") { // Gaussian random field:
-        const auto& G = pmb->coords;
-        GridScalar rho = rc->Get("prims.rho").data;
-        GridVector uvec = rc->Get("prims.uvec").data;
-        GridVector grf_normalized = rc->Get("grf_normalized").data;
-        const Real t = pmb->packages.Get("Globals")->Param<Real>("time");
-        Real counter = pmb->packages.Get("GRMHD")->Param<Real>("counter");
-        const Real dt_kick=  pmb->packages.Get("GRMHD")->Param<Real>("dt_kick");
-        if (generate_grf && counter < t) {
-            counter += dt_kick;
-            pmb->packages.Get("GRMHD")->UpdateParam<Real>("counter", counter);
-            printf("Kick applied at time %.32f\n", t);
-
-            const Real lx1=  pmb->packages.Get("GRMHD")->Param<Real>("lx1");
-            const Real lx2=  pmb->packages.Get("GRMHD")->Param<Real>("lx2");
-            const Real edot= pmb->packages.Get("GRMHD")->Param<Real>("drive_edot");
-            GridScalar alfven_speed = rc->Get("alfven_speed").data;
-            
-            int Nx1 = pmb->cellbounds.ncellsi(IndexDomain::interior);
-            int Nx2 = pmb->cellbounds.ncellsj(IndexDomain::interior);
-            Real *dv0 =  (Real*) malloc(sizeof(Real)*Nx1*Nx2);
-            Real *dv1 =  (Real*) malloc(sizeof(Real)*Nx1*Nx2);
-            create_grf(Nx1, Nx2, lx1, lx2, dv0, dv1);
-
-            Real mean_velocity_num0 = 0;    Kokkos::Sum<Real> mean_velocity_num0_reducer(mean_velocity_num0);
-            Real mean_velocity_num1 = 0;    Kokkos::Sum<Real> mean_velocity_num1_reducer(mean_velocity_num1);
-            Real tot_mass = 0;              Kokkos::Sum<Real> tot_mass_reducer(tot_mass);
-            pmb->par_reduce("forced_mhd_normal_kick_centering_mean_vel0", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += cell_mass * dv0[(i-4)*Nx1+(j-4)];
-                }
-            , mean_velocity_num0_reducer);
-            pmb->par_reduce("forced_mhd_normal_kick_centering_mean_vel1", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += cell_mass * dv1[(i-4)*Nx1+(j-4)];
-                }
-            , mean_velocity_num1_reducer);
-            pmb->par_reduce("forced_mhd_normal_kick_centering_tot_mass", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    local_result += (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                }
-            , tot_mass_reducer);
-            Real mean_velocity0 = mean_velocity_num0/tot_mass;
-            Real mean_velocity1 = mean_velocity_num1/tot_mass;
-            #pragma omp parallel for simd collapse(2)
-            for (size_t i = 0; i < Nx1 ; i ++) {
-                for (size_t j = 0; j < Nx2 ; j ++) {
-                    dv0[i*Nx1+j] -= mean_velocity0;
-                    dv1[i*Nx1+j] -= mean_velocity1;
-                }
-            } 
-
-            Real Bhalf = 0; Real A = 0; Real init_e = 0; 
-            Kokkos::Sum<Real> Bhalf_reducer(Bhalf); Kokkos::Sum<Real> A_reducer(A); Kokkos::Sum<Real> init_e_reducer(init_e);
-            pmb->par_reduce("forced_mhd_normal_kick_normalization_Bhalf", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += cell_mass * (dv0[(i-4)*Nx1+(j-4)]*uvec(0, k, j, i) + dv1[(i-4)*Nx1+(j-4)]*uvec(1, k, j, i));
-                }
-            , Bhalf_reducer);
-            pmb->par_reduce("forced_mhd_normal_kick_normalization_A", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += cell_mass * (pow(dv0[(i-4)*Nx1+(j-4)], 2) + pow(dv1[(i-4)*Nx1+(j-4)], 2));
-                }
-            , A_reducer);
-            pmb->par_reduce("forced_mhd_normal_kick_init_e", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += 0.5 * cell_mass * (pow(uvec(0, k, j, i), 2) + pow(uvec(1, k, j, i), 2));
-                }
-            , init_e_reducer);
-
-            Real norm_const = (-Bhalf + pow(pow(Bhalf,2) + A*2*dt_kick*edot, 0.5))/A;  // going from k:(0, 0), j:(4, 515), i:(4, 515) inclusive
-            pmb->par_for("forced_mhd_normal_kick_setting", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i) {
-                    grf_normalized(0, k, j, i) = (dv0[(i-4)*Nx1+(j-4)]*norm_const);
-                    grf_normalized(1, k, j, i) = (dv1[(i-4)*Nx1+(j-4)]*norm_const);
-                    uvec(0, k, j, i) += grf_normalized(0, k, j, i);
-                    uvec(1, k, j, i) += grf_normalized(1, k, j, i);
-                    FourVectors Dtmp;
-                    GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
-                    Real bsq = dot(Dtmp.bcon, Dtmp.bcov);
-                    alfven_speed(k,j,i) = bsq/rho(k, j, i); //saving alfven speed for analysis purposes
-                }
-            );
-
-            Real finl_e = 0;    Kokkos::Sum<Real> finl_e_reducer(finl_e);
-            pmb->par_reduce("forced_mhd_normal_kick_finl_e", mykb.s, mykb.e, myjb.s, myjb.e, myib.s, myib.e,
-                KOKKOS_LAMBDA(const int k, const int j, const int i, Real &local_result) {
-                    Real cell_mass = (rho(k, j, i) * G.Dxc<3>(k) * G.Dxc<2>(j) * G.Dxc<1>(i));
-                    local_result += 0.5 * cell_mass * (pow(uvec(0, k, j, i), 2) + pow(uvec(1, k, j, i), 2));
-                }
-            , finl_e_reducer);
-            printf("%.32f\n", A); printf("%.32f\n", Bhalf); printf("%.32f\n", norm_const);
-            printf("%.32f\n", (finl_e-init_e)/dt_kick);
-            free(dv0); free(dv1);
-        }
-        // This could be only the GRMHD vars, for this problem, but speed isn't really an issue
-        Flux::BlockPtoU(rc, IndexDomain::interior);
+    const auto finals = GlobalMassSum(md.get(), "forced_mhd_distributed_finl_e",
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, const Real &cell_mass,
+                       Reductions::array_type<Real, 4> &local_result) {
+            for (int c = 0; c < ncomp; ++c)
+                local_result.my_array[0] += 0.5 * cell_mass * m::pow(P(bl, m_p.U1 + c, k, j, i), 2);
+        });
+    if (MPIRank0()) {
+        printf("%.32f\n", A); printf("%.32f\n", Bhalf); printf("%.32f\n", norm_const);
+        printf("%.32f\n", (finals.my_array[0] - init_e)/dt_kick);
     }
+
+    // The kick covers ghost zones too, so U is consistent everywhere without another sync
+    Flux::MeshPtoU(md.get(), IndexDomain::entire);
     EndFlag();
-    return TaskStatus::complete;
 }
 
 void ApplyFloors(MeshBlockData<Real> *mbd, IndexDomain domain)
 {
-    auto pmb                 = mbd->GetBlockPointer();
-    auto packages            = pmb->packages;
+    auto pmb = mbd->GetBlockPointer();
 
-    PackIndexMap prims_map, cons_map;
+    PackIndexMap prims_map;
     auto P = mbd->PackVariables({Metadata::GetUserFlag("Primitive")}, prims_map);
     const VarMap m_p(prims_map, false);
 
-    auto fflag = mbd->PackVariables(std::vector<std::string>{"fflag"}, prims_map);
+    auto fflag = mbd->PackVariables(std::vector<std::string>{"fflag"});
+    const bool record_fflag = fflag.GetDim(4) > 0;
 
     const auto& G = pmb->coords;
 
-    const Real gam = packages.Get("GRMHD")->Param<Real>("gamma");
-    const Floors::Prescription floors       = packages.Get("Floors")->Param<Floors::Prescription>("prescription");
-    const Floors::Prescription floors_inner = packages.Get("Floors")->Param<Floors::Prescription>("prescription_inner");
+    // The same limits as applied during heating
+    const HeatingParams hp = pmb->packages.Get("Electrons")->Param<HeatingParams>("heating_params");
 
     const IndexRange3 b = KDomain::GetRange(mbd, domain);
     pmb->par_for("apply_electrons_floors", b.ks, b.ke, b.js, b.je, b.is, b.ie,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
-
             // Also apply the ceiling to the advected entropy KTOT, if we're keeping track of that
             // (either for electrons, or robust primitive inversions in future)
-            Real ktot_max;
-            if (m_p.KTOT >= 0) {
-                if (floors.radius_dependent_floors && G.coords.is_spherical()
-                    && G.r(k, j, i) < floors.floors_switch_r) {
-                    ktot_max = floors_inner.ktot_max;
-                } else {
-                    ktot_max = floors.ktot_max;
-                }
-                
-                if (P(m_p.KTOT, k, j, i) > ktot_max) {
+            const Real ktot_max = ktot_ceiling(G, hp, k, j, i);
+            if (P(m_p.KTOT, k, j, i) > ktot_max) {
+                if (record_fflag)
                     fflag(0, k, j, i) = Floors::FFlag::KTOT | (int) fflag(0, k, j, i);
-                    P(m_p.KTOT, k, j, i) = ktot_max;
-                }
+                P(m_p.KTOT, k, j, i) = ktot_max;
             }
 
+            // Limit each model's temperature ratio
+            Real kel_min, kel_max;
+            kel_limits(hp, P(m_p.KTOT, k, j, i), m::pow(P(m_p.RHO, k, j, i), hp.gam - hp.game), kel_min, kel_max);
+            const int kel_idx[6] = {m_p.K_CONSTANT, m_p.K_HOWES, m_p.K_KAWAZURA, m_p.K_WERNER, m_p.K_ROWAN, m_p.K_SHARMA};
+            for (int n = 0; n < 6; ++n)
+                if (kel_idx[n] >= 0)
+                    P(kel_idx[n], k, j, i) = limit_kel(hp, P(kel_idx[n], k, j, i), kel_min, kel_max);
+
             // TODO(BSP) restore Ressler adjustment option
             // Ressler adjusts KTOT & KEL to conserve u whenever adjusting rho
             // but does *not* recommend adjusting them when u hits floors/ceilings
@@ -57,6 +57,65 @@ using namespace parthenon;
  * first creating a package!
  */
 namespace Electrons {
+/**
+ * Regular axis of a tabulated heating fraction, over [min, min + (n-1)*delta]
+ */
+struct TableAxis {
+    Real min, delta;
+    int n;
+    /**
+     * Locate x on the axis, returning the lower grid index & the interpolation weight of the upper one.
+     * Values outside the axis are clamped to its ends.
+     */
+    KOKKOS_INLINE_FUNCTION void locate(const Real& x, int& i, Real& w) const
+    {
+        const Real xi = clip((x - min) / delta, (Real) 0., (Real) (n - 1));
+        i = m::min((int) xi, n - 2);
+        w = xi - i;
+    }
+};
+
+/**
+ * Heating parameters, resolved from the package Params once at initialization.
+ * Kernels carry this struct rather than repeating the lookups, similar reasoning to Floors::Prescription.
+ */
+class HeatingParams {
+    public:
+        // Adiabatic indices of the fluid, protons, and electrons
+        Real gam, gamp, game;
+        // Dissipation fraction for the constant model
+        Real fel_const;
+        // Limits on the temperature ratio T_p/T_e
+        Real tptemin, tptemax;
+        // Heating options
+        bool suppress_highb_heat, enforce_positive_diss, limit_kel;
+        // Ceiling on total entropy, copied from the Floors prescription
+        Real ktot_max, ktot_max_inner, floors_switch_r;
+        bool radius_dependent_floors;
+        // Optional tables of the Kawazura, Werner and Rowan heating fractions, see BuildHeatingTables
+        bool tabulate;
+        TableAxis ax_log_beta, ax_log_trat, ax_log_sigma, ax_beta_ratio;
+        ParArray2D<Real> tab_kawazura, tab_rowan;
+        ParArray1D<Real> tab_werner;
+};
+
+/**
+ * Bitmask of enabled heating models.  The set is fixed for a run, so the mesh heating kernel is compiled
+ * for a few common sets with the inactive models removed entirely.  Other sets use the kernel
+ * instantiated for ANY, which checks the VarMap indices in each zone.
+ */
+namespace Models {
+static constexpr int CONSTANT = 1;
+static constexpr int HOWES = 2;
+static constexpr int KAWAZURA = 4;
+static constexpr int WERNER = 8;
+static constexpr int ROWAN = 16;
+static constexpr int SHARMA = 32;
+static constexpr int ALL = CONSTANT | HOWES | KAWAZURA | WERNER | ROWAN | SHARMA;
+// Decide per-zone from the VarMap
+static constexpr int ANY = -1;
+}
+
 /**
  * Initialization: declare any fields this package will evolve, initialize any parameters
  * 
@@ -111,19 +170,34 @@ void BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse=false);
  * TODO this function should update fflag to reflect temperature ratio floor hits
  */
 TaskStatus ApplyElectronHeating(MeshBlockData<Real> *rc_old, MeshBlockData<Real> *rc, bool generate_grf=false);
-inline TaskStatus MeshApplyElectronHeating(MeshData<Real> *md_old, MeshData<Real> *md, bool generate_grf=false)
-{
-    Flag("MeshApplyElectronHeating");
-    for (int i=0; i < md->NumBlocks(); ++i)
-        ApplyElectronHeating(md_old->GetBlockData(i).get(), md->GetBlockData(i).get(), generate_grf);
-    EndFlag();
-    return TaskStatus::complete;
-}
+/**
+ * Mesh version of the above, heating every block in a single kernel launch.
+ * The 4-vectors of the old state are computed once per zone and shared by all enabled models.
+ */
+TaskStatus MeshApplyElectronHeating(MeshData<Real> *md_old, MeshData<Real> *md, bool generate_grf=false);
+
+/**
+ * With <electrons> halo_float, the electron entropies aren't synchronized directly.  Instead, before each
+ * boundary sync PackHalo stores them at single precision, two per Real, in the FillGhost field
+ * "Electrons.halo", and after it UnpackHalo restores them in the ghost zones received from neighbors.
+ * This halves the electrons' share of halo traffic, at the cost of float rounding in ghost zones only.
+ * Both functions do nothing for syncs which don't include the packed field.
+ */
+TaskStatus PackHalo(MeshData<Real> *md);
+TaskStatus UnpackHalo(MeshData<Real> *md);
+
+/**
+ * Drive turbulence with one Gaussian random field over the whole mesh, every dt_kick, enabled with
+ * <driven_turbulence> distributed (default for 3D meshes).  Registered as the package's PostStepWork,
+ * so it runs once per step on every rank.  The field is synthesized in place in each block (see SynthesizeGRF),
+ * and its centering & normalization are reduced over all ranks.
+ */
+void ApplyDistributedForcing(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
 
 /**
- * Apply adjustments to KTOT & e- K values based on floors.
- * Note that Kmin/max limits are applied immediately at heating,
- * *not* here.
+ * Apply the KTOT ceiling and tp_over_te_min/max limits to KTOT & e- K values, for drivers which don't heat electrons.
+ * When heating, exactly the same limits are applied inside the heating kernel instead,
+ * and this pass is not registered.
  */
 void ApplyFloors(MeshBlockData<Real> *mbd, IndexDomain domain);
 
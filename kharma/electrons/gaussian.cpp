@@ -33,11 +33,14 @@
  */
 
 #include "gaussian.hpp"
+#include "domain.hpp"
 #include "problem.hpp"
 
 #include <cmath>
 #include <random>
 
+using namespace parthenon;
+
 float normalRand()
 {
     // TODO this can definitely be Kokkosified
@@ -120,3 +123,272 @@ void create_grf(int Nx1, int Nx2, double lx1, double lx2,
     throw std::runtime_error("Attempted to use an FFT to generate a Gaussian random field, but KHARMA was compiled without FFT support!");
 }
 #endif
+
+// Device-side generation: see gaussian.hpp
+
+/**
+ * Philox-4x32-10 counter-based RNG (Salmon et al. 2011), as in Random123.
+ * Scrambles the counter ctr in place, given a key
+ */
+KOKKOS_INLINE_FUNCTION void philox4x32(uint32_t ctr[4], uint32_t key0, uint32_t key1)
+{
+    for (int r = 0; r < 10; ++r) {
+        const uint64_t p0 = (uint64_t) 0xD2511F53u * ctr[0];
+        const uint64_t p1 = (uint64_t) 0xCD9E8D57u * ctr[2];
+        const uint32_t c0 = (uint32_t) (p1 >> 32) ^ ctr[1] ^ key0;
+        const uint32_t c2 = (uint32_t) (p0 >> 32) ^ ctr[3] ^ key1;
+        ctr[0] = c0; ctr[1] = (uint32_t) p1; ctr[2] = c2; ctr[3] = (uint32_t) p0;
+        key0 += 0x9E3779B9u; key1 += 0xBB67AE85u;
+    }
+}
+
+/**
+ * Four independent normal deviates for the counter (c0, c1, c2, c3), via Box-Muller
+ */
+KOKKOS_INLINE_FUNCTION void normal4(const uint32_t& c0, const uint32_t& c1, const uint32_t& c2, const uint32_t& c3,
+                                    const uint32_t& seed, const uint32_t& kick, Real out[4])
+{
+    uint32_t ctr[4] = {c0, c1, c2, c3};
+    philox4x32(ctr, seed, kick);
+    Real uni[4];
+    for (int n = 0; n < 4; ++n) uni[n] = (ctr[n] + 0.5) / 4294967296.; // in (0,1)
+    for (int n = 0; n < 4; n += 2) {
+        const Real r = m::sqrt(-2. * m::log(uni[n]));
+        out[n] = r * m::cos(2*M_PI*uni[n+1]);
+        out[n+1] = r * m::sin(2*M_PI*uni[n+1]);
+    }
+}
+
+/**
+ * Twiddle factors exp(+2 pi i m/N), m < N/2, for backward transforms of length N.
+ * Computed once per length and cached in pkg, like an FFT plan.
+ */
+ParArray2D<Real> GetTwiddles(StateDescriptor *pkg, const int& N)
+{
+    if (N < 2 || (N & (N - 1)) != 0)
+        throw std::invalid_argument("Device GRF generation requires power-of-two block sizes! Got "+std::to_string(N));
+    auto& cache = *(pkg->AllParams().GetMutable<std::map<int, ParArray2D<Real>>>("grf_twiddles"));
+    if (!cache.count(N)) {
+        ParArray2D<Real> tw("grf_twiddles", 2, N/2);
+        parthenon::par_for(DEFAULT_LOOP_PATTERN, "grf_twiddles", DevExecSpace(), 0, N/2 - 1,
+            KOKKOS_LAMBDA (const int& m) {
+                tw(0, m) = m::cos(2*M_PI*m/N);
+                tw(1, m) = m::sin(2*M_PI*m/N);
+            }
+        );
+        cache[N] = tw;
+    }
+    return cache[N];
+}
+
+/**
+ * In-place backward FFT of each line of the complex fields a(f, re/im, i, j), along i (dir 1) or j (dir 2).
+ * One team takes each line, bit-reverses it into scratch and runs the radix-2 butterflies there.
+ */
+void BackwardFFTLines(StateDescriptor *pkg, ParArray4D<Real> a, const int& dir)
+{
+    const int nf = a.extent_int(0);
+    const int N = (dir == 1) ? a.extent_int(2) : a.extent_int(3);
+    const int nl = (dir == 1) ? a.extent_int(3) : a.extent_int(2);
+    int logN = 0;
+    while ((1 << logN) < N) ++logN;
+    const auto tw = GetTwiddles(pkg, N);
+
+    constexpr int scratch_level = 1;
+    const size_t scratch_bytes = 2 * ScratchPad1D<Real>::shmem_size(N);
+    parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "grf_fft_lines", DevExecSpace(),
+        scratch_bytes, scratch_level, 0, nf*nl - 1,
+        KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& fl) {
+            const int f = fl / nl;
+            const int l = fl % nl;
+            ScratchPad1D<Real> re(member.team_scratch(scratch_level), N);
+            ScratchPad1D<Real> im(member.team_scratch(scratch_level), N);
+            parthenon::par_for_inner(member, 0, N - 1,
+                [&](const int& n) {
+                    int r = 0;
+                    for (int b = 0; b < logN; ++b) r |= ((n >> b) & 1) << (logN - 1 - b);
+                    re(r) = (dir == 1) ? a(f, 0, n, l) : a(f, 0, l, n);
+                    im(r) = (dir == 1) ? a(f, 1, n, l) : a(f, 1, l, n);
+                }
+            );
+            member.team_barrier();
+            for (int len = 2; len <= N; len <<= 1) {
+                const int half = len / 2;
+                const int stride = N / len;
+                parthenon::par_for_inner(member, 0, N/2 - 1,
+                    [&](const int& p) {
+                        const int a0 = (p / half) * len + p % half;
+                        const int a1 = a0 + half;
+                        const Real wr = tw(0, (p % half) * stride), wi = tw(1, (p % half) * stride);
+                        const Real tr = wr * re(a1) - wi * im(a1);
+                        const Real ti = wr * im(a1) + wi * re(a1);
+                        re(a1) = re(a0) - tr; im(a1) = im(a0) - ti;
+                        re(a0) += tr;         im(a0) += ti;
+                    }
+                );
+                member.team_barrier();
+            }
+            parthenon::par_for_inner(member, 0, N - 1,
+                [&](const int& n) {
+                    if (dir == 1) {
+                        a(f, 0, n, l) = re(n); a(f, 1, n, l) = im(n);
+                    } else {
+                        a(f, 0, l, n) = re(n); a(f, 1, l, n) = im(n);
+                    }
+                }
+            );
+        }
+    );
+}
+
+void CreateGRFDevice(StateDescriptor *pkg, int Nx1, int Nx2, Real lx1, Real lx2,
+                     uint32_t seed, uint32_t kick, ParArray2D<Real> dv1, ParArray2D<Real> dv2)
+{
+    Flag("CreateGRFDevice");
+    const Real dkx1 = 2*M_PI/lx1;
+    const Real dkx2 = 2*M_PI/lx2;
+    const Real kx1max = 2*M_PI/(2*lx1/Nx1);
+    const Real kx2max = 2*M_PI/(2*lx2/Nx2);
+    const Real k_peak = 4*M_PI/lx1;
+
+    // Both velocity components, real & imaginary parts
+    ParArray4D<Real> dvk("grf_spectrum", 2, 2, Nx1, Nx2);
+    parthenon::par_for(DEFAULT_LOOP_PATTERN, "grf_spectrum", DevExecSpace(), 0, Nx1 - 1, 0, Nx2 - 1,
+        KOKKOS_LAMBDA (const int& i, const int& j) {
+            Real retx1 = i * dkx1;
+            Real retx2 = j * dkx2;
+            if (retx1 > kx1max) retx1 = retx1 - 2*kx1max;
+            if (retx2 > kx2max) retx2 = retx2 - 2*kx2max;
+            const Real curr_k_magn = m::sqrt(retx1*retx1 + retx2*retx2);
+
+            const Real pwr_spct = m::pow(curr_k_magn, 6)*m::exp(-8*curr_k_magn/k_peak);
+            if (curr_k_magn != 0) {
+                retx1 /= curr_k_magn;
+                retx2 /= curr_k_magn;
+            }
+
+            Real noise[4];
+            normal4(i, j, 0, 0, seed, kick, noise);
+            for (int n = 0; n < 4; ++n) noise[n] *= pwr_spct;
+
+            // Project out the component along k, as in create_grf
+            const Real dot_real = retx1*noise[0] + retx2*noise[2];
+            const Real dot_imag = retx1*noise[1] + retx2*noise[3];
+            dvk(0, 0, i, j) = noise[0] - dot_real*retx1;  dvk(0, 1, i, j) = noise[1] - dot_imag*retx1;
+            dvk(1, 0, i, j) = noise[2] - dot_real*retx2;  dvk(1, 1, i, j) = noise[3] - dot_imag*retx2;
+        }
+    );
+
+    // 2D transform as 1D transforms along each dimension
+    BackwardFFTLines(pkg, dvk, 2);
+    BackwardFFTLines(pkg, dvk, 1);
+
+    parthenon::par_for(DEFAULT_LOOP_PATTERN, "grf_copy_out", DevExecSpace(), 0, Nx1 - 1, 0, Nx2 - 1,
+        KOKKOS_LAMBDA (const int& i, const int& j) {
+            dv1(i, j) = dvk(0, 0, i, j);
+            dv2(i, j) = dvk(1, 0, i, j);
+        }
+    );
+    EndFlag();
+}
+
+void SynthesizeGRF(MeshData<Real> *md, const Real lx[3], const int& n_max, const int& ncomp,
+                   uint32_t seed, uint32_t kick, ParArray5D<Real> dv)
+{
+    Flag("SynthesizeGRF");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto rho = md->PackVariables(std::vector<std::string>{"prims.rho"});
+    const int nblocks = rho.GetDim(5);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const int ndim = pmb0->pmy_mesh->ndim;
+
+    // Modes -n_max..n_max along each dimension in use
+    const int M1 = 2*n_max + 1;
+    const int M2 = (ndim > 1) ? 2*n_max + 1 : 1;
+    const int M3 = (ndim > 2) ? 2*n_max + 1 : 1;
+    const int n1_0 = (M1 - 1)/2, n2_0 = (M2 - 1)/2, n3_0 = (M3 - 1)/2;
+    const Real dk1 = 2*M_PI/lx[0];
+    const Real dk2 = (M2 > 1) ? 2*M_PI/lx[1] : 0.;
+    const Real dk3 = (M3 > 1) ? 2*M_PI/lx[2] : 0.;
+    const Real k_peak = 4*M_PI/lx[0];
+
+    // Projected spectrum, as in create_grf, 2*c + (real, imag) for each component c
+    ParArray4D<Real> spec("grf_modes", 6, M1, M2, M3);
+    pmb0->par_for("grf_modes", 0, M1 - 1, 0, M2 - 1, 0, M3 - 1,
+        KOKKOS_LAMBDA (const int& m1, const int& m2, const int& m3) {
+            Real kv[3] = {(m1 - n1_0) * dk1, (m2 - n2_0) * dk2, (m3 - n3_0) * dk3};
+            const Real curr_k_magn = m::sqrt(kv[0]*kv[0] + kv[1]*kv[1] + kv[2]*kv[2]);
+            const Real pwr_spct = m::pow(curr_k_magn, 6)*m::exp(-8*curr_k_magn/k_peak);
+            if (curr_k_magn != 0)
+                for (int c = 0; c < 3; ++c) kv[c] /= curr_k_magn;
+
+            // Distinct counter words from the 2D device stream
+            Real noise[8];
+            normal4(m1, m2, m3, 1, seed, kick, noise);
+            normal4(m1, m2, m3, 2, seed, kick, noise + 4);
+            for (int n = 0; n < 6; ++n) noise[n] *= pwr_spct;
+            for (int n = 2*ncomp; n < 6; ++n) noise[n] = 0.;
+
+            Real dot_real = 0., dot_imag = 0.;
+            for (int c = 0; c < ncomp; ++c) {
+                dot_real += kv[c]*noise[2*c];
+                dot_imag += kv[c]*noise[2*c+1];
+            }
+            for (int c = 0; c < 3; ++c) {
+                spec(2*c, m1, m2, m3) = (c < ncomp) ? noise[2*c] - dot_real*kv[c] : 0.;
+                spec(2*c+1, m1, m2, m3) = (c < ncomp) ? noise[2*c+1] - dot_imag*kv[c] : 0.;
+            }
+        }
+    );
+
+    // Sum modes one dimension at a time: X1, then X2, then X3 taking the real part
+    const int ni = b.ie + 1, nj = b.je + 1, nk = b.ke + 1;
+    ParArray5D<Real> sum1("grf_sum1", nblocks, 6, M2, M3, ni);
+    pmb0->par_for("grf_sum1", 0, nblocks - 1, 0, 2, 0, M2 - 1, 0, M3 - 1, 0, ni - 1,
+        KOKKOS_LAMBDA (const int& bl, const int& c, const int& m2, const int& m3, const int& i) {
+            const auto& G = rho.GetCoords(bl);
+            GReal X[GR_DIM];
+            G.coord(b.ks, b.js, i, Loci::center, X);
+            Real re = 0., im = 0.;
+            for (int m1 = 0; m1 < M1; ++m1) {
+                const Real ph = (m1 - n1_0) * dk1 * X[1];
+                const Real cr = m::cos(ph), ci = m::sin(ph);
+                re += spec(2*c, m1, m2, m3) * cr - spec(2*c+1, m1, m2, m3) * ci;
+                im += spec(2*c, m1, m2, m3) * ci + spec(2*c+1, m1, m2, m3) * cr;
+            }
+            sum1(bl, 2*c, m2, m3, i) = re;
+            sum1(bl, 2*c+1, m2, m3, i) = im;
+        }
+    );
+    ParArray5D<Real> sum2("grf_sum2", nblocks, 6, M3, nj, ni);
+    pmb0->par_for("grf_sum2", 0, nblocks - 1, 0, 2, 0, M3 - 1, 0, nj - 1, 0, ni - 1,
+        KOKKOS_LAMBDA (const int& bl, const int& c, const int& m3, const int& j, const int& i) {
+            const auto& G = rho.GetCoords(bl);
+            GReal X[GR_DIM];
+            G.coord(b.ks, j, i, Loci::center, X);
+            Real re = 0., im = 0.;
+            for (int m2 = 0; m2 < M2; ++m2) {
+                const Real ph = (m2 - n2_0) * dk2 * X[2];
+                const Real cr = m::cos(ph), ci = m::sin(ph);
+                re += sum1(bl, 2*c, m2, m3, i) * cr - sum1(bl, 2*c+1, m2, m3, i) * ci;
+                im += sum1(bl, 2*c, m2, m3, i) * ci + sum1(bl, 2*c+1, m2, m3, i) * cr;
+            }
+            sum2(bl, 2*c, m3, j, i) = re;
+            sum2(bl, 2*c+1, m3, j, i) = im;
+        }
+    );
+    pmb0->par_for("grf_sum3", 0, nblocks - 1, 0, ncomp - 1, 0, nk - 1, 0, nj - 1, 0, ni - 1,
+        KOKKOS_LAMBDA (const int& bl, const int& c, const int& k, const int& j, const int& i) {
+            const auto& G = rho.GetCoords(bl);
+            GReal X[GR_DIM];
+            G.coord(k, j, i, Loci::center, X);
+            Real re = 0.;
+            for (int m3 = 0; m3 < M3; ++m3) {
+                const Real ph = (m3 - n3_0) * dk3 * X[3];
+                re += sum2(bl, 2*c, m3, j, i) * m::cos(ph) - sum2(bl, 2*c+1, m3, j, i) * m::sin(ph);
+            }
+            dv(bl, c, k, j, i) = re;
+        }
+    );
+    EndFlag();
+}
@@ -33,5 +33,37 @@
  */
 #pragma once
 
+#include "decs.hpp"
+
+#include <parthenon/parthenon.hpp>
+
 float normalRand();
 void create_grf(int Nx1, int Nx2, double lx1, double lx2, double * dv1, double * dv2);
+
+/**
+ * Generate the same Gaussian random velocity field as create_grf, entirely on the device.
+ *
+ * Normal deviates come from a counter-based generator (Philox-4x32-10) keyed on (seed, kick), so each
+ * mode draws its values independently and reproducibly, without any generator state.
+ * The inverse transform is a radix-2 FFT over each line of the field in team scratch, so Nx1 and Nx2
+ * must be powers of two.  Twiddle factors for each line length are computed once and cached in pkg,
+ * which must hold the mutable map "grf_twiddles".
+ *
+ * dv1 and dv2 are filled with the real part of the field, indexed (i, j) from the first interior zone.
+ */
+void CreateGRFDevice(parthenon::StateDescriptor *pkg, int Nx1, int Nx2, Real lx1, Real lx2,
+                     uint32_t seed, uint32_t kick, parthenon::ParArray2D<Real> dv1, parthenon::ParArray2D<Real> dv2);
+
+/**
+ * Synthesize a band-limited Gaussian random velocity field directly in every zone of md, ghosts included,
+ * for distributed and 3D forcing.
+ *
+ * The driving spectrum peaks at |k| ~ k_peak and falls off exponentially, so rather than transforming the
+ * whole domain, only modes |n| <= n_max along each dimension are drawn.  Every rank draws the same modes
+ * from the counter-based generator, and sums them at its own zones one dimension at a time.
+ * No global array or communication is needed, and zones shared between blocks get identical values.
+ *
+ * dv is sized (nblocks, 3, nk, nj, ni) over the entire block; only the first ncomp components are written.
+ */
+void SynthesizeGRF(parthenon::MeshData<Real> *md, const Real lx[3], const int& n_max, const int& ncomp,
+                   uint32_t seed, uint32_t kick, parthenon::ParArray5D<Real> dv);
@@ -38,6 +38,7 @@
 #include "emhd_utils.hpp"
 
 #include "decs.hpp"
+#include "domain.hpp"
 #include "grmhd.hpp"
 #include "kharma.hpp"
 
@@ -127,7 +128,7 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     // General options for primitive and conserved scalar variables in ImEx driver
     // EMHD is supported only with imex driver and implicit evolution,
     // synchronizing primitive variables
-    Metadata::AddUserFlag("EMHDVar"); // "EMHD" name now taken by Parthenon for general flag, we want this one specific
+    AddUserFlag("EMHDVar"); // "EMHD" name now taken by Parthenon for general flag, we want this one specific
     std::vector<MetadataFlag> emhd_flags = {Metadata::Cell, Metadata::GetUserFlag("Implicit"), Metadata::GetUserFlag("EMHDVar")};
 
     auto flags_prim = packages->Get("Driver")->Param<std::vector<MetadataFlag>>("prim_flags");
@@ -151,7 +152,7 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
 
     // 4vel ucov and temperature Theta are needed as temporaries, but need to be grid-sized anyway.
     // Allow keeping/saving them.
-    Metadata::AddUserFlag("EMHDTemporary");
+    AddUserFlag("EMHDTemporary");
     Metadata m_temp = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy, Metadata::GetUserFlag("EMHDTemporary")});
     pkg->AddField("Theta", m_temp);
     std::vector<int> fourv = {GR_DIM};
@@ -176,6 +177,7 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     // Add floors
     if (enable_emhd_limits) {
         pkg->BlockApplyFloors = EMHD::ApplyEMHDLimits;
+        pkg->MeshApplyFloors = EMHD::MeshApplyEMHDLimits;
     }
 
     return pkg;
@@ -245,7 +247,6 @@ void BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
                 P(m_p.DP, k, j, i) = U_E(m_u.DP, k, j, i) / (ucon0 * G.gdet(Loci::center, j, i));
         }
     );
-    Kokkos::fence();
 }
 
 void BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
@@ -280,6 +281,39 @@ void BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
     );
 }
 
+void MeshPtoU(MeshData<Real> *md, IndexDomain domain, bool coarse)
+{
+    auto pmb = md->GetBlockData(0)->GetBlockPointer();
+
+    // Get only relevant cons, but all prims as we need the Lorentz factor
+    PackIndexMap prims_map, cons_map;
+    auto U_E = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("EMHDVar"), Metadata::Conserved}, cons_map);
+    auto P   = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    const VarMap m_p(prims_map, false), m_u(cons_map, true);
+
+    const auto& G = pmb->coords;
+
+    auto bounds      = coarse ? pmb->c_cellbounds : pmb->cellbounds;
+    IndexRange ib    = bounds.GetBoundsI(domain);
+    IndexRange jb    = bounds.GetBoundsJ(domain);
+    IndexRange kb    = bounds.GetBoundsK(domain);
+    IndexRange block = IndexRange{0, U_E.GetDim(5)-1};
+
+    pmb->par_for("PtoU_EMHD", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+            const Real gamma     = GRMHD::lorentz_calc(G, P(b), m_p, k, j, i, Loci::center);
+            const Real inv_alpha = m::sqrt(-G.gcon(Loci::center, j, i, 0, 0));
+            const Real ucon0     = gamma * inv_alpha;
+
+            // Update the conserved EMHD fields
+            if (m_p.Q >= 0)
+                U_E(b, m_u.Q, k, j, i) = P(b, m_p.Q, k, j, i) * ucon0 * G.gdet(Loci::center, j, i);
+            if (m_p.DP >= 0)
+                U_E(b, m_u.DP, k, j, i) = P(b, m_p.DP, k, j, i) * ucon0 * G.gdet(Loci::center, j, i);
+        }
+    );
+}
+
 void InitEMHDVariables(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterInput *pin)
 {
     // Do we actually need anything here?
@@ -428,4 +462,32 @@ void ApplyEMHDLimits(MeshBlockData<Real> *mbd, IndexDomain domain)
     );
 }
 
+void MeshApplyEMHDLimits(MeshData<Real> *md, IndexDomain domain)
+{
+    auto pmb0                = md->GetBlockData(0)->GetBlockPointer();
+    auto packages            = pmb0->packages;
+
+    PackIndexMap prims_map, cons_map;
+    auto P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    auto U = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    auto eflag = md->PackVariables(std::vector<std::string>{"eflag"});
+
+    const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(packages);
+
+    const Real gam = packages.Get("GRMHD")->Param<Real>("gamma");
+
+    const IndexRange3 b = KDomain::GetRange(md, domain);
+    const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
+    pmb0->par_for("apply_emhd_limits_mesh", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            const auto& G = P.GetCoords(b);
+            // One set of 4-vectors serves both the limits (for bsq) and the PtoU of the result
+            FourVectors D;
+            GRMHD::calc_4vecs(G, P(b), m_p, k, j, i, Loci::center, D);
+            eflag(b, 0, k, j, i) = apply_instability_limits(G, P(b), m_p, gam, emhd_params, D, k, j, i, U(b), m_u);
+        }
+    );
+}
+
 } // namespace EMHD
@@ -109,6 +109,7 @@ void InitEMHDVariables(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterInput
 void BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse);
 void MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse=false);
 void BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse);
+void MeshPtoU(MeshData<Real> *md, IndexDomain domain, bool coarse=false);
 
 /**
  * Add EGRMHD explicit source terms: anything which can be calculated once
@@ -128,6 +129,11 @@ void InitEMHDVariables(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterInput
  * LOCKSTEP: this function respects P and returns consistent P<->U
  */
 void ApplyEMHDLimits(MeshBlockData<Real> *mbd, IndexDomain domain);
+/**
+ * Mesh-packed version of the above, applying the limits and the resulting PtoU in one kernel
+ * over all blocks, from a single evaluation of the 4-vectors per zone.
+ */
+void MeshApplyEMHDLimits(MeshData<Real> *md, IndexDomain domain);
 
 /**
  * Get the EMHD parameters needed on the device side.
@@ -204,12 +210,8 @@ KOKKOS_INLINE_FUNCTION void set_parameters(const GRCoordinates& G, const Real& r
         nu_e = emhd_params.eta / m::max(rho, SMALL);
 
     } else if (emhd_params.type == ClosureType::torus) {
-        GReal Xembed[GR_DIM];
-        G.coord_embed(0, j, i, Loci::center, Xembed);
-        const GReal r = Xembed[1];
-
-        // Compute dynamical time scale
-        const Real tau_dyn = m::sqrt(r*r*r);
+        // Dynamical time scale, tabulated in the geometry cache
+        const Real tau_dyn = G.tdyn(j, i);
         tau = tau_dyn;
 
         const Real pg    = (gam - 1.) * u;
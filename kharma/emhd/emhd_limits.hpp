@@ -58,7 +58,7 @@ namespace EMHD {
  * This shouldn't be an issue though since PtoU in analytic and will result in the same value for the ideal MHD variables.
  */
 KOKKOS_INLINE_FUNCTION int apply_instability_limits(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
-                                          const Real& gam, const EMHD::EMHD_parameters& emhd_params, 
+                                          const Real& gam, const EMHD::EMHD_parameters& emhd_params, const FourVectors& D,
                                           const int& k, const int& j, const int& i,
                                           const VariablePack<Real>& U, const VarMap& m_u, const Loci loc=Loci::center)
 {
@@ -73,8 +73,6 @@ KOKKOS_INLINE_FUNCTION int apply_instability_limits(const GRCoordinates& G, cons
     Real Theta = pg / rho;
     Real cs    = m::sqrt(gam * pg / (rho + (gam * uu)));
 
-    FourVectors D;
-    GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, D);
     Real bsq = m::max(dot(D.bcon, D.bcov), SMALL);
 
     Real tau, chi_e, nu_e;
@@ -118,9 +116,23 @@ KOKKOS_INLINE_FUNCTION int apply_instability_limits(const GRCoordinates& G, cons
 
     }
 
-    Flux::p_to_u(G, P, m_p, emhd_params, gam, k, j, i, U, m_u);
+    // The limits touch only q, dP, so the 4-vectors are still valid for PtoU
+    Flux::prim_to_flux(G, P, m_p, D, emhd_params, gam, k, j, i, 0, U, m_u, loc);
 
     return eflag;
-}    
+}
+
+/**
+ * As above, computing the 4-vectors from P
+ */
+KOKKOS_INLINE_FUNCTION int apply_instability_limits(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                          const Real& gam, const EMHD::EMHD_parameters& emhd_params, 
+                                          const int& k, const int& j, const int& i,
+                                          const VariablePack<Real>& U, const VarMap& m_u, const Loci loc=Loci::center)
+{
+    FourVectors D;
+    GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, D);
+    return apply_instability_limits(G, P, m_p, gam, emhd_params, D, k, j, i, U, m_u, loc);
+}
 
 } // EMHD
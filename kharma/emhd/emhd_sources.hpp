@@ -65,11 +65,13 @@ KOKKOS_INLINE_FUNCTION void implicit_sources(const GRCoordinates& G, const Globa
 /**
  * EMHD source terms requiring time derivatives, used to evaluate residual
  * gamma, j, i,
+ * This version takes u_mu and Theta at the old time level precomputed, as they are
+ * fixed over the implicit iterations, see Implicit::Step
  */
 template<typename Global>
 KOKKOS_INLINE_FUNCTION void time_derivative_sources(const GRCoordinates& G, const Global& P_new,
-                                                    const Global& P_old, const Global& P,
-                                                    const VarMap& m_p,
+                                                    const Real ucov_old[GR_DIM], const Real& Theta_old,
+                                                    const Global& P, const VarMap& m_p,
                                                     const Real& tau, const Real& chi_e, const Real& nu_e,
                                                     const FourVectors &D, const bool& higher_order_terms,
                                                     const Real& gam, const Real& dt, 
@@ -80,9 +82,7 @@ KOKKOS_INLINE_FUNCTION void time_derivative_sources(const GRCoordinates& G, cons
     const double mag_b = m::sqrt(bsq);
 
     // TIME DERIVATIVES
-    Real ucon[GR_DIM], ucov_new[GR_DIM], ucov_old[GR_DIM];
-    GRMHD::calc_ucon(G, P_old, m_p, k, j, i, Loci::center, ucon);
-    G.lower(ucon, ucov_old, k, j, i, Loci::center);
+    Real ucon[GR_DIM], ucov_new[GR_DIM];
     GRMHD::calc_ucon(G, P_new, m_p, k, j, i, Loci::center, ucon);
     G.lower(ucon, ucov_new, k, j, i, Loci::center);
     Real dt_ucov[GR_DIM];
@@ -93,7 +93,6 @@ KOKKOS_INLINE_FUNCTION void time_derivative_sources(const GRCoordinates& G, cons
     DLOOP1 div_ucon += G.gcon(Loci::center, j, i, 0, mu) * dt_ucov[mu];
     // dTheta/dt
     const Real Theta_new = m::max((gam-1) * P_new(m_p.UU, k, j, i) / P_new(m_p.RHO, k, j, i), SMALL);
-    const Real Theta_old = m::max((gam-1) * P_old(m_p.UU, k, j, i) / P_old(m_p.RHO, k, j, i), SMALL);
     const Real dt_Theta  = (Theta_new - Theta_old) / dt;
 
     // TEMPORAL SOURCE TERMS
@@ -127,4 +126,25 @@ KOKKOS_INLINE_FUNCTION void time_derivative_sources(const GRCoordinates& G, cons
     }
 }
 
+/**
+ * As above, computing the old-time u_mu and Theta from P_old
+ */
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void time_derivative_sources(const GRCoordinates& G, const Global& P_new,
+                                                    const Global& P_old, const Global& P,
+                                                    const VarMap& m_p,
+                                                    const Real& tau, const Real& chi_e, const Real& nu_e,
+                                                    const FourVectors &D, const bool& higher_order_terms,
+                                                    const Real& gam, const Real& dt, 
+                                                    const int & k, const int& j, const int& i,
+                                                    Real& dUq, Real& dUdP)
+{
+    Real ucon[GR_DIM], ucov_old[GR_DIM];
+    GRMHD::calc_ucon(G, P_old, m_p, k, j, i, Loci::center, ucon);
+    G.lower(ucon, ucov_old, k, j, i, Loci::center);
+    const Real Theta_old = m::max((gam-1) * P_old(m_p.UU, k, j, i) / P_old(m_p.RHO, k, j, i), SMALL);
+    time_derivative_sources(G, P_new, ucov_old, Theta_old, P, m_p, tau, chi_e, nu_e, D,
+                            higher_order_terms, gam, dt, k, j, i, dUq, dUdP);
+}
+
 } // namespace EMHD
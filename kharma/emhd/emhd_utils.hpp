@@ -52,6 +52,8 @@ namespace EMHD {
 
 // Compute gradient of four velocities and temperature
 // Called by emhd_explicit_sources
+// The zone's own values are loaded once and shared by all three slopes and the connection term,
+// so each extra direction costs only its two neighbor reads
 template<KReconstruction::Type recon>
 KOKKOS_INLINE_FUNCTION void gradient_calc(const GRCoordinates& G, const VariablePack<Real>& Temps,
                                           const int& uvec_index, const int& theta_index,
@@ -59,23 +61,33 @@ KOKKOS_INLINE_FUNCTION void gradient_calc(const GRCoordinates& G, const Variable
                                           const bool& do_3d, const bool& do_2d,
                                           Real grad_ucov[GR_DIM][GR_DIM], Real grad_Theta[GR_DIM])
 {
+    using KReconstruction::slope_limit;
+    const Real dx1 = G.Dxc<X1DIR>(i);
+    const Real dx2 = G.Dxc<X2DIR>(j);
+    const Real dx3 = G.Dxc<X3DIR>(k);
+
     // Compute gradient of ucov
+    Real ucov_c[GR_DIM];
     DLOOP1 {
+        const int p = uvec_index + mu;
+        ucov_c[mu] = Temps(p, k, j, i);
         grad_ucov[0][mu] = 0;
         // slope in direction nu of component mu
-        grad_ucov[1][mu] = slope_calc<recon, X1DIR>(G, Temps, uvec_index + mu, k, j, i);
-        grad_ucov[2][mu] = (do_2d) ? slope_calc<recon, X2DIR>(G, Temps, uvec_index + mu, k, j, i) : 0.;
-        grad_ucov[3][mu] = (do_3d) ? slope_calc<recon, X3DIR>(G, Temps, uvec_index + mu, k, j, i) : 0.;
+        grad_ucov[1][mu] = slope_limit<recon>(Temps(p, k, j, i-1), ucov_c[mu], Temps(p, k, j, i+1), dx1);
+        grad_ucov[2][mu] = (do_2d) ? slope_limit<recon>(Temps(p, k, j-1, i), ucov_c[mu], Temps(p, k, j+1, i), dx2) : 0.;
+        grad_ucov[3][mu] = (do_3d) ? slope_limit<recon>(Temps(p, k-1, j, i), ucov_c[mu], Temps(p, k+1, j, i), dx3) : 0.;
     }
     // TODO skip this if flat space?
-    DLOOP3 grad_ucov[mu][nu] -= G.conn(j, i, lam, mu, nu) * Temps(uvec_index + lam, k, j, i);
+    DLOOP3 grad_ucov[mu][nu] -= G.conn(j, i, lam, mu, nu) * ucov_c[lam];
 
     // Compute temperature gradient
     // Time derivative component is computed in time_derivative_sources
+    const int p = theta_index;
+    const Real Theta_c = Temps(p, k, j, i);
     grad_Theta[0] = 0;
-    grad_Theta[1] = slope_calc<recon, X1DIR>(G, Temps, theta_index, k, j, i);
-    grad_Theta[2] = (do_2d) ? slope_calc<recon, X2DIR>(G, Temps, theta_index, k, j, i) : 0.;
-    grad_Theta[3] = (do_3d) ? slope_calc<recon, X3DIR>(G, Temps, theta_index, k, j, i) : 0.;
+    grad_Theta[1] = slope_limit<recon>(Temps(p, k, j, i-1), Theta_c, Temps(p, k, j, i+1), dx1);
+    grad_Theta[2] = (do_2d) ? slope_limit<recon>(Temps(p, k, j-1, i), Theta_c, Temps(p, k, j+1, i), dx2) : 0.;
+    grad_Theta[3] = (do_3d) ? slope_limit<recon>(Temps(p, k-1, j, i), Theta_c, Temps(p, k+1, j, i), dx3) : 0.;
 }
 
 } // namespace EMHD
@@ -0,0 +1,192 @@
+/* 
+ *  File: estimate.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "estimate.hpp"
+
+#include "grmhd.hpp"
+#include "kharma.hpp"
+#include "kharma_driver.hpp"
+#include "memory_report.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+/**
+ * Values written per zone by an output of the given variables, or of all restart variables
+ */
+double ValuesPerZone(MeshBlock *pmb, const std::vector<std::string>& names, const bool restart)
+{
+    double nvalues = 0.;
+    for (auto &var : pmb->meshblock_data.Get()->GetVariableVector()) {
+        const auto& m = var->metadata();
+        bool written = restart && m.IsSet(Metadata::Restart);
+        if (!restart) {
+            // Names match exactly, or by prefix if they end in '.' e.g. "prims."
+            const std::string label = var->label();
+            for (auto &name : names)
+                if (label == name || (name.back() == '.' && label.rfind(name, 0) == 0)) written = true;
+        }
+        if (written) nvalues += var->NumComponents() * (m.IsSet(Metadata::Face) ? 3 : 1);
+    }
+    return nvalues;
+}
+
+std::string InGB(const double& bytes)
+{
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(2) << bytes / (1024. * 1024. * 1024.) << " GB";
+    return s.str();
+}
+
+} // namespace
+
+void Estimate::ParseArgs(int argc, char *argv[])
+{
+    static char estimate_override[] = "estimate/on=true";
+    for (int n = 1; n < argc; ++n)
+        if (std::string(argv[n]) == "--estimate") argv[n] = estimate_override;
+}
+
+bool Estimate::Run(ParameterInput *pin, Mesh *pmesh)
+{
+    if (!pin->GetOrAddBoolean("estimate", "on", false)) return false;
+    const Real zcps_per_node = pin->GetOrAddReal("estimate", "zcps_per_node", 0.);
+    const int ranks_per_node = pin->GetOrAddInteger("estimate", "ranks_per_node", 1);
+    Flag("Estimate");
+
+    auto& globals = pmesh->packages.Get("Globals")->AllParams();
+    const auto& grmhd_pars = pmesh->packages.Get("GRMHD")->AllParams();
+    auto *md = pmesh->mesh_data.Get().get();
+
+    // Signal speeds of the initial state, from one flux calculation as in the first step
+    TaskID t_none(0);
+    TaskCollection tc;
+    auto tr = tc.AddRegion(1);
+    KHARMADriver::AddFluxCalculations(t_none, tr[0], md);
+    while (!tr.Execute());
+
+    // Estimate as if in the loop, with the increase over the last step limited only by the run length
+    const double time = globals.Get<double>("time");
+    const double tlim = pin->GetReal("parthenon/time", "tlim");
+    const int nlim = pin->GetOrAddInteger("parthenon/time", "nlim", -1);
+    const double dt_last = globals.Get<double>("dt_last");
+    globals.Update<bool>("in_loop", true);
+    globals.Update<double>("dt_last", tlim);
+    double dt = (grmhd_pars.Get<bool>("use_dt_light")) ? GRMHD::EstimateRadiativeTimestep(md)
+                                                        : GRMHD::EstimateTimestep(md);
+    globals.Update<bool>("in_loop", false);
+    globals.Update<double>("dt_last", dt_last);
+
+    double rank_bytes = MemoryReport::RankBytes(pmesh);
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &dt, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD));
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &rank_bytes, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+#endif
+
+    // All blocks are the same size, so zones of the whole mesh at its current refinement
+    auto pmb0 = pmesh->block_list[0];
+    const int ng = Globals::nghost;
+    const int ndim = pmesh->ndim;
+    double block_zones = 1., block_zones_ghost = 1.;
+    for (int d = 0; d < ndim; ++d) {
+        const int nx = pmb0->block_size.nx(static_cast<CoordinateDirection>(d + 1));
+        block_zones *= nx;
+        block_zones_ghost *= nx + 2*ng;
+    }
+    const double zones = block_zones * pmesh->nbtotal;
+
+    double nsteps = std::ceil((tlim - time) / dt);
+    if (nlim >= 0 && nlim < nsteps) nsteps = nlim;
+    const double zone_cycles = zones * nsteps;
+    // Output stops at tlim either way, so the run length at the estimated timestep
+    const double t_end = std::min(tlim, time + nsteps * dt);
+
+    if (MPIRank0()) {
+        std::cout << "Estimate for " << pmesh->nbtotal << " blocks on " << MPINumRanks() << " ranks:" << std::endl;
+        std::cout << "  Zones: " << zones << std::endl;
+        std::cout << "  Initial timestep: " << dt << ", steps to t = " << t_end << ": " << nsteps << std::endl;
+        std::cout << "  Zone-cycles: " << zone_cycles << std::endl;
+        std::cout << "  Device memory per rank (max over ranks): " << InGB(rank_bytes) << std::endl;
+
+        // Parthenon writes each output at its start time & every dt thereafter
+        double output_total = 0.;
+        InputBlock *pib = pin->pfirst_block;
+        while (pib != nullptr) {
+            const std::string& block = pib->block_name;
+            pib = pib->pnext;
+            if (block.find("parthenon/output") == std::string::npos) continue;
+            const std::string type = pin->GetOrAddString(block, "file_type", "");
+            const Real out_dt = pin->GetOrAddReal(block, "dt", -1.);
+            if ((type != "hdf5" && type != "rst") || out_dt <= 0.) continue;
+
+            const bool restart = (type == "rst");
+            std::vector<std::string> names;
+            if (!restart) {
+                std::stringstream vars(pin->GetOrAddString(block, "variables", ""));
+                std::string name;
+                while (std::getline(vars, name, ',')) {
+                    name.erase(0, name.find_first_not_of(" "));
+                    name.erase(name.find_last_not_of(" ") + 1);
+                    if (!name.empty()) names.push_back(name);
+                }
+            }
+            const bool ghosts = pin->GetOrAddBoolean(block, "ghost_zones", false);
+            const int bytes = (!restart && pin->GetOrAddBoolean(block, "single_precision_output", false)) ? 4 : sizeof(Real);
+            const double dump_bytes = ValuesPerZone(pmb0.get(), names, restart) * bytes
+                                      * pmesh->nbtotal * (ghosts ? block_zones_ghost : block_zones);
+            const double ndumps = std::floor((t_end - time) / out_dt) + 1;
+            output_total += dump_bytes * ndumps;
+            std::cout << "  Output " << block.substr(std::string("parthenon/").size()) << " (" << type << "): "
+                      << ndumps << " dumps of " << InGB(dump_bytes) << ", " << InGB(dump_bytes * ndumps) << std::endl;
+        }
+        std::cout << "  Total output: " << InGB(output_total) << std::endl;
+
+        if (zcps_per_node > 0.) {
+            const double node_hours = zone_cycles / zcps_per_node / 3600.;
+            const int nodes = (MPINumRanks() + ranks_per_node - 1) / ranks_per_node;
+            std::cout << "  At " << zcps_per_node << " zone-cycles/s per node: " << node_hours << " node-hours, "
+                      << node_hours / nodes << " hours on " << nodes << " nodes" << std::endl;
+        } else {
+            std::cout << "  Set <estimate>zcps_per_node to a measured rate for projected node-hours" << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    EndFlag();
+    return true;
+}
@@ -0,0 +1,70 @@
+/* 
+ *  File: estimate.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Dry-run cost estimate for a parameter deck, for sizing a job before submitting it.
+ *
+ * With `kharma --estimate` (shorthand for <estimate>on = true), KHARMA sets up the packages, mesh and
+ * initial state as usual, then instead of running the driver calculates the fluxes once and estimates
+ * the timestep from the resulting signal speeds, as GRMHD::EstimateTimestep would in the first step
+ * (but without limiting the increase over <parthenon/time>dt).  From this it prints, on rank 0:
+ * 1. Total zones, estimated timestep & number of steps to <parthenon/time>tlim (or nlim)
+ * 2. Zone-cycles for the run
+ * 3. Device memory per rank, the maximum over ranks of the fields and geometry, see MemoryReport
+ * 4. Size of each HDF5 and restart output block's dumps, and their total over the run
+ * 5. With <estimate>zcps_per_node set to a measured rate in zone-cycles/s per node, projected
+ *    node-hours, and wall-clock hours with <estimate>ranks_per_node ranks (default 1) per node.
+ *
+ * The timestep usually changes over a run, especially as fields and disks develop, so treat the step
+ * count as a guide.  Setup should be done at the intended rank count, since memory is measured as
+ * allocated rather than modeled.
+ */
+namespace Estimate {
+
+/**
+ * Replace each "--estimate" argument with the equivalent parameter override, which Parthenon will parse.
+ * Call before ParthenonInitEnv.
+ */
+void ParseArgs(int argc, char *argv[]);
+
+/**
+ * Print the estimate, if requested.  Call after PostInitialize.
+ * @return whether an estimate was made, in which case the driver should not be run
+ */
+bool Run(ParameterInput *pin, Mesh *pmesh);
+
+}
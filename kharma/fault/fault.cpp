@@ -0,0 +1,214 @@
+/* 
+ *  File: fault.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fault.hpp"
+
+#include "async_output.hpp"
+#include "hdf5_utils.h"
+
+#include <array>
+
+namespace {
+
+using BlockLoc = std::array<long long, 4>;
+
+// Whether two blocks touch, compared at the coarser of their levels.  Ignores periodic wrapping
+bool adjacent(const BlockLoc& a, const BlockLoc& b)
+{
+    const long long level = std::min(a[0], b[0]);
+    for (int d = 1; d < 4; ++d) {
+        const long long ca = a[d] >> (a[0] - level), cb = b[d] >> (b[0] - level);
+        if (ca - cb > 1 || cb - ca > 1) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<KHARMAPackage> Fault::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("Fault");
+    Params &params = pkg->AllParams();
+
+    // Also dump the blocks around each faulty one, which hold the state it took its fluxes from
+    params.Add("dump_neighbors", pin->GetOrAddBoolean("fault", "dump_neighbors", true));
+
+    // Per-block sentinels, sized on first use, and whenever the mesh gains blocks
+    ParArray1D<int> sentinels("fault_sentinels", 0);
+    params.Add("sentinels", sentinels, true);
+
+    pkg->PostStepDiagnosticsMesh = Fault::Check;
+
+    return pkg;
+}
+
+Fault::Sentinels Fault::GetSentinels(MeshData<Real> *md)
+{
+    Sentinels s;
+    auto pmesh = md->GetMeshPointer();
+    if (!pmesh->packages.AllPackages().count("Fault")) return s;
+    s.enabled = true;
+
+    auto *flags = pmesh->packages.Get("Fault")->AllParams().GetMutable<ParArray1D<int>>("sentinels");
+    const int nblocks_rank = pmesh->block_list.size();
+    if (flags->extent_int(0) < nblocks_rank) {
+        Kokkos::resize(*flags, nblocks_rank);
+        Kokkos::deep_copy(*flags, 0);
+    }
+    s.flags = *flags;
+
+    // Blocks in a MeshData partition are contiguous in the rank's block list
+    const int nblocks = md->NumBlocks();
+    s.lid0 = md->GetBlockData(0)->GetBlockPointer()->lid;
+    if (md->GetBlockData(nblocks - 1)->GetBlockPointer()->lid != s.lid0 + nblocks - 1)
+        throw std::runtime_error("Fault sentinels require contiguous mesh partitions!");
+    return s;
+}
+
+TaskStatus Fault::Check(const SimTime& tm, MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto& params = pmesh->packages.Get("Fault")->AllParams();
+    auto *sentinels = params.GetMutable<ParArray1D<int>>("sentinels");
+
+    // One int per block to the host, and one to every rank
+    std::vector<int> flags(md->NumBlocks(), 0);
+    int any = 0;
+    if (sentinels->extent_int(0) > 0) {
+        const auto flags_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), *sentinels);
+        for (int b = 0; b < md->NumBlocks(); ++b) {
+            const int lid = md->GetBlockData(b)->GetBlockPointer()->lid;
+            if (lid < flags_h.extent_int(0)) flags[b] = flags_h(lid);
+            any |= flags[b];
+        }
+    }
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &any, 1, MPI_INT, MPI_BOR, MPI_COMM_WORLD));
+#endif
+    if (!any) return TaskStatus::complete;
+
+    // Everyone learns where the faulty blocks are, to dump their neighbors too
+    std::vector<BlockLoc> local_faulty;
+    for (int b = 0; b < md->NumBlocks(); ++b) {
+        if (!flags[b]) continue;
+        const auto& loc = md->GetBlockData(b)->GetBlockPointer()->loc;
+        local_faulty.push_back(BlockLoc{(long long) loc.level(), (long long) loc.lx1(),
+                                        (long long) loc.lx2(), (long long) loc.lx3()});
+    }
+    std::vector<BlockLoc> faulty = local_faulty;
+#ifdef MPI_PARALLEL
+    const int nranks = MPINumRanks();
+    int n_local = 4 * local_faulty.size();
+    std::vector<int> counts(nranks), displs(nranks);
+    PARTHENON_MPI_CHECK(MPI_Allgather(&n_local, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD));
+    int n_total = 0;
+    for (int r = 0; r < nranks; r++) {
+        displs[r] = n_total;
+        n_total += counts[r];
+    }
+    faulty.resize(n_total / 4);
+    PARTHENON_MPI_CHECK(MPI_Allgatherv(local_faulty.data(), n_local, MPI_LONG_LONG, faulty.data(),
+                                       counts.data(), displs.data(), MPI_LONG_LONG, MPI_COMM_WORLD));
+#endif
+
+    const bool dump_neighbors = params.Get<bool>("dump_neighbors");
+    std::vector<int> to_dump;
+    for (int b = 0; b < md->NumBlocks(); ++b) {
+        const auto& loc = md->GetBlockData(b)->GetBlockPointer()->loc;
+        const BlockLoc mine{(long long) loc.level(), (long long) loc.lx1(), (long long) loc.lx2(), (long long) loc.lx3()};
+        bool dump = flags[b];
+        for (size_t f = 0; f < faulty.size() && dump_neighbors && !dump; ++f)
+            dump = adjacent(mine, faulty[f]);
+        if (dump) to_dump.push_back(b);
+    }
+    if (!to_dump.empty()) DumpBlocks(md, to_dump, flags, tm);
+
+    for (int b = 0; b < md->NumBlocks(); ++b) {
+        if (flags[b])
+            fprintf(stderr, "Fault in block %d at step %d:%s%s\n", md->GetBlockData(b)->GetBlockPointer()->gid, tm.ncycle,
+                    (flags[b] & Sentinel::bad_ctop) ? " zero or NaN signal speed" : "",
+                    (flags[b] & Sentinel::nonfinite_cons) ? " non-finite conserved variables" : "");
+    }
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+    if (MPIRank0())
+        std::cerr << "Faults detected in " << faulty.size() << " blocks, wrote them"
+                  << (dump_neighbors ? " and their neighbors" : "") << " to fault files" << std::endl;
+    throw std::runtime_error("Fault detected!");
+}
+
+void Fault::DumpBlocks(MeshData<Real> *md, const std::vector<int>& blocks, const std::vector<int>& flags, const SimTime& tm)
+{
+    auto pmesh = md->GetMeshPointer();
+    // HDF5 may not be thread-safe, don't write alongside a snapshot
+    AsyncOutput::Wait();
+    const std::string problem_id = pmesh->packages.Get("Globals")->Param<std::string>("problem");
+    char nbuf[64];
+    snprintf(nbuf, 64, ".fault.%08d.rank%05d.h5", tm.ncycle, MPIRank());
+    const std::string fname = problem_id + nbuf;
+
+    const hsize_t real_type = (sizeof(Real) == 4) ? H5T_IEEE_F32LE : H5T_IEEE_F64LE;
+    hdf5_create(fname.c_str());
+    const double t = tm.time;
+    hdf5_write_single_val(&t, "t", H5T_IEEE_F64LE);
+    hdf5_write_single_val(&tm.ncycle, "n_step", H5T_STD_I32LE);
+    for (const int b : blocks) {
+        auto rc = md->GetBlockData(b);
+        auto pmb = rc->GetBlockPointer();
+        const std::string dir = "block_" + std::to_string(pmb->gid);
+        hdf5_make_directory(dir.c_str());
+        hdf5_set_directory(("/" + dir + "/").c_str());
+
+        int level = pmb->loc.level();
+        long long lx[3] = {(long long) pmb->loc.lx1(), (long long) pmb->loc.lx2(), (long long) pmb->loc.lx3()};
+        hsize_t ldims[1] = {3}, lstart[1] = {0};
+        hdf5_write_single_val(&level, "level", H5T_STD_I32LE);
+        hdf5_write_array(lx, "lx", 1, ldims, lstart, ldims, ldims, lstart, H5T_STD_I64LE);
+        hdf5_write_single_val(&flags[b], "sentinel", H5T_STD_I32LE);
+
+        // Every cell-centered field, with ghost zones, as (component, k, j, i)
+        for (auto &var : rc->GetVariableVector()) {
+            if (!var->metadata().IsSet(Metadata::Cell) || var->data.GetSize() == 0) continue;
+            const auto host = var->data.GetHostMirrorAndCopy();
+            hsize_t dims[4] = {(hsize_t) (var->data.GetDim(6) * var->data.GetDim(5) * var->data.GetDim(4)),
+                               (hsize_t) var->data.GetDim(3), (hsize_t) var->data.GetDim(2), (hsize_t) var->data.GetDim(1)};
+            hsize_t start[4] = {0, 0, 0, 0};
+            hdf5_write_array(host.data(), var->label().c_str(), 4, dims, start, dims, dims, start, real_type);
+        }
+        hdf5_set_directory("/");
+    }
+    hdf5_close();
+    std::cerr << "Wrote " << blocks.size() << " blocks to " << fname << std::endl;
+}
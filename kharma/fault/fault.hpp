@@ -0,0 +1,105 @@
+/* 
+ *  File: fault.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Early fault detection.  Rather than waiting for the next diagnostic sweep, the flux and inversion
+ * kernels raise a per-block sentinel as they go: a NaN or zero signal speed in the fluxes, or a non-finite
+ * conserved fluid variable entering the inversion.  After each step, the sentinels are OR'd across ranks,
+ * which costs a copy of one int per block and a one-int MPI reduction.
+ *
+ * If any block is faulty, each rank writes every cell-centered field of its faulty blocks, and of their
+ * neighbors on any rank (<fault>dump_neighbors), to <problem_id>.fault.NNNNNNNN.rankRRRRR.h5, including
+ * ghost zones, before the run stops.  Enable with <fault>on = true.
+ */
+namespace Fault {
+
+/**
+ * Bits of a block's sentinel
+ */
+enum Sentinel : int {bad_ctop=1, nonfinite_cons=2};
+
+/**
+ * The sentinels of the blocks in a MeshData partition, indexed by block as in the partition
+ */
+struct Sentinels {
+    ParArray1D<int> flags;
+    int lid0 = 0;
+    bool enabled = false;
+};
+
+/**
+ * Initialize the fault detection package
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Get the sentinels for the blocks in md.  Disabled (and free to check) unless the package is loaded
+ */
+Sentinels GetSentinels(MeshData<Real> *md);
+
+/**
+ * Raise a sentinel bit for block bl of the partition
+ */
+KOKKOS_INLINE_FUNCTION void Mark(const Sentinels& s, const int& bl, const int& bit)
+{
+    Kokkos::atomic_or(&s.flags(s.lid0 + bl), bit);
+}
+
+/**
+ * Whether any of the fluid's conserved variables in a zone is NaN or infinite
+ */
+template<typename Local>
+KOKKOS_INLINE_FUNCTION bool NonFiniteFluid(const Local& U, const VarMap& m_u, const int& k, const int& j, const int& i)
+{
+    return !(m::isfinite(U(m_u.RHO, k, j, i)) && m::isfinite(U(m_u.UU, k, j, i)) &&
+             m::isfinite(U(m_u.U1, k, j, i)) && m::isfinite(U(m_u.U2, k, j, i)) && m::isfinite(U(m_u.U3, k, j, i)));
+}
+
+/**
+ * Combine the sentinels over all ranks, and if any are raised, dump the faulty blocks and stop.
+ * Registered as PostStepDiagnosticsMesh
+ */
+TaskStatus Check(const SimTime& tm, MeshData<Real> *md);
+
+/**
+ * Write fields of the listed blocks (indices into md) to this rank's fault file
+ */
+void DumpBlocks(MeshData<Real> *md, const std::vector<int>& blocks, const std::vector<int>& flags, const SimTime& tm);
+
+} // namespace Fault
@@ -35,6 +35,7 @@
 #include "floors_functions.hpp"
 #include "floors_impl.hpp"
 
+#include "boundaries.hpp"
 #include "domain.hpp"
 #include "grmhd.hpp"
 #include "grmhd_functions.hpp"
@@ -78,7 +79,8 @@ std::shared_ptr<KHARMAPackage> Floors::Initialize(ParameterInput *pin, std::shar
     } else if (frame_s == "drift") {
         frame = InjectionFrame::drift;
     }
-    params.Add("frame", frame);
+    // Mutable only so that Benchmark::Run can time each frame
+    params.Add("frame", frame, true);
 
     // Switch points for "mixed" frames
     // TODO no-ops under new floors
@@ -101,12 +103,31 @@ std::shared_ptr<KHARMAPackage> Floors::Initialize(ParameterInput *pin, std::shar
     else
         params.Add("prescription_inner", MakePrescriptionInner(pin, MakePrescription(pin)), "floors");
 
-    // These preserve floor values between the "mark" pass and the actual floor application
-    // We need them even if floors are disabled, to apply initial values based on some prescription
-    // as a part of problem setup
+    // Floor values are determined and applied in the same kernel, so they live only in registers.
+    // Optionally, record them to mesh fields for output/debugging
+    bool record_floor_values = pin->GetOrAddBoolean("floors", "record_floor_values", false);
+    params.Add("record_floor_values", record_floor_values);
+    // Apply floors only over a compacted list of flagged zones, rather than checking every zone of the mesh
+    bool sparse = pin->GetOrAddBoolean("floors", "sparse", false);
+    params.Add("sparse", sparse);
+    if (sparse) {
+        // Grown as needed, and kept per-partition, see GetPartitionParam
+        params.Add("floor_zone_list", std::map<int, ParArray1D<int>>(), true);
+    }
+
     Metadata m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
-    pkg->AddField("Floors.rho_floor", m);
-    pkg->AddField("Floors.u_floor", m);
+    if (record_floor_values) {
+        pkg->AddField("Floors.rho_floor", m);
+        pkg->AddField("Floors.u_floor", m);
+    }
+
+    // Geometric floors tabulated per partition, see GetGeomFloorProfiles
+    params.Add("geom_floor_profiles", std::map<int, GeomFloorProfiles>(), true);
+
+    // Floor flags are counted inside the flooring kernels whenever they'll be printed,
+    // and kept per-partition until PostStepDiagnostics starts the MPI reduction
+    params.Add("fflag_values", Reductions::FlagValueList(FFlag::flag_names));
+    params.Add("fflag_counts", std::map<int, std::vector<int>>(), true);
 
     // Flag for which floor conditions were violated.  Used for diagnostics
     // TODO(BSP) Should switch these to "Integer" fields when Parthenon supports it
@@ -115,8 +136,7 @@ std::shared_ptr<KHARMAPackage> Floors::Initialize(ParameterInput *pin, std::shar
     m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy, Metadata::Overridable});
     pkg->AddField("pflag", m);
 
-    // TODO(BSP) THIS IS THE ONLY MeshApplyFloors.  Any others will NOT BE CALLED.
-    // Use BlockApplyFloors in your packages or fix Packages::MeshApplyFloors
+    // This is always applied first, before other packages' MeshApplyFloors/BlockApplyFloors
     pkg->MeshApplyFloors = Floors::ApplyGRMHDFloors;
     pkg->PostStepDiagnosticsMesh = Floors::PostStepDiagnostics;
 
@@ -201,35 +221,79 @@ TaskStatus Floors::DetermineGRMHDFloors(MeshData<Real> *md, IndexDomain domain,
 
     // Packs of prims and cons
     PackIndexMap prims_map;
-    auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    auto& P = md->PackVariables(PackFlags::Primitive(), prims_map);
     const VarMap m_p(prims_map, false);
 
-    auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
-    auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+    static const std::vector<std::string> fflag_name{"fflag"}, no_names{};
+    static const std::vector<std::string> floor_names{"Floors.rho_floor", "Floors.u_floor"};
+    auto fflag = md->PackVariables(fflag_name);
+    const bool record = pmb0->packages.Get("Floors")->Param<bool>("record_floor_values");
     PackIndexMap floors_map;
-    auto floor_vals = md->PackVariables(std::vector<std::string>{"Floors.rho_floor", "Floors.u_floor"}, floors_map);
+    auto floor_vals = md->PackVariables(record ? floor_names : no_names, floors_map);
     const int rhofi = floors_map["Floors.rho_floor"].first;
     const int ufi = floors_map["Floors.u_floor"].first;
 
     const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
 
+    const auto excised = KBoundaries::GetExcisedStarts(md);
     const IndexRange3 b = KDomain::GetRange(md, domain);
     const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
     pmb0->par_for("determine_floors", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
         KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            if (i < excised(b)) return;
             const auto& G = P.GetCoords(b);
-            fflag(b, 0, k, j, i) = static_cast<int>(fflag(b, 0, k, j, i)) |
-                                    determine_floors(G, P(b), m_p, gam, k, j, i, floors, floors_inner,
-                                                     floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i));
+            Real rhoflr_max, uflr_max;
+            Floors::FFlag::add_codes(fflag(b, 0, k, j, i),
+                                     determine_floors(G, P(b), m_p, gam, k, j, i, floors, floors_inner,
+                                                      rhoflr_max, uflr_max));
+            if (record) {
+                floor_vals(b, rhofi, k, j, i) = rhoflr_max;
+                floor_vals(b, ufi, k, j, i) = uflr_max;
+            }
         }
     );
 
-    // TODO(BSP) if we can somehow guarantee one call/rank we can start the reduction here
-    //Reductions::StartFlagReduce(md, "fflag", FFlag::flag_names, IndexDomain::interior, true, 0);
-
     return TaskStatus::complete;
 }
 
+ParArray4D<Real> Floors::GetGeomFloorProfiles(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto *cache = GetPartitionParam<GeomFloorProfiles>(md, "Floors", "geom_floor_profiles");
+    if (!pmb0->coords.coords.is_spherical()) return cache->vals;
+
+    auto locs = PartitionLocations(md);
+    if (cache->vals.extent_int(0) >= md->NumBlocks() && cache->locs == locs) return cache->vals;
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    if (cache->vals.extent_int(0) < md->NumBlocks())
+        cache->vals = ParArray4D<Real>("geom_floor_profiles", md->NumBlocks(), 3, b.je + 1, b.ie + 1);
+    const auto vals = cache->vals;
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+    const Floors::Prescription floors = pmb0->packages.Get("Floors")->Param<Floors::Prescription>("prescription");
+    const Floors::Prescription floors_inner = pmb0->packages.Get("Floors")->Param<Floors::Prescription>("prescription_inner");
+    auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
+    pmb0->par_for("geom_floor_profiles", 0, md->NumBlocks() - 1, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &j, const int &i) {
+            const auto& G = fflag.GetCoords(bl);
+            Real rhoflr_geom, uflr_geom;
+            bool use_inner;
+            geom_floors(G, gam, b.ks, j, i, floors, floors_inner, rhoflr_geom, uflr_geom, use_inner);
+            vals(bl, 0, j, i) = rhoflr_geom;
+            vals(bl, 1, j, i) = uflr_geom;
+            vals(bl, 2, j, i) = use_inner;
+        }
+    );
+    cache->locs = locs;
+    return vals;
+}
+
+void Floors::RecordFFlagCounts(MeshData<Real> *md, const Reductions::array_type<int, MAX_NFLAGS>& counts)
+{
+    // Later calls on the same partition replace earlier ones: we report the flags of the final state
+    Reductions::RecordFlagCounts(md, "Floors", "fflag_counts", counts, FFlag::flag_names.size());
+}
+
 TaskStatus Floors::ApplyGRMHDFloors(MeshData<Real> *md, IndexDomain domain)
 {
     auto pmesh = md->GetMeshPointer();
@@ -259,9 +323,12 @@ TaskStatus Floors::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
 
     // Debugging/diagnostic info about floor flags
     if (flag_verbose > 0) {
-        Reductions::StartFlagReduce(md, "fflag", FFlag::flag_names, IndexDomain::interior, true, 0);
+        // Sum the counts taken while flooring each partition, rather than sweeping the mesh again.
+        // If nothing was recorded (e.g., floors were applied only by another package), count them now
+        if (!Reductions::StartRecordedFlagReduce(md, "Floors", "fflag_counts", FFlag::flag_names.size(), Reductions::Channel::fflag))
+            Reductions::StartFlagReduce(md, "fflag", FFlag::flag_names, IndexDomain::interior, true, Reductions::Channel::fflag);
         // Debugging/diagnostic info about floor and inversion flags
-        Reductions::CheckFlagReduceAndPrintHits(md, "fflag", FFlag::flag_names, IndexDomain::interior, true, 0);
+        Reductions::FinishFlagReduce(md, "fflag", FFlag::flag_names, IndexDomain::interior, true, Reductions::Channel::fflag);
     }
 
     // Anything else (energy conservation? Added material stats?)
@@ -69,6 +69,15 @@ static constexpr int INVERTER_U_MAX = 131072;
 // Lowest flag value. Needed for combining floor and other return flags
 static constexpr int MINIMUM = GEOM_RHO;
 
+/**
+ * Add the floor codes 'codes' to a flag field entry.  Flag fields are Real, 8B per zone, and most
+ * zones hit no floors: so only read and store the flag when there's something to add.
+ */
+KOKKOS_FORCEINLINE_FUNCTION void add_codes(Real& flag, const int& codes)
+{
+    if (codes) flag = static_cast<int>(flag) | codes;
+}
+
 // Other advantage of a namespace is including full lists for iterating over
 // TODO
 // 1. prettier names?
@@ -214,6 +223,22 @@ inline Prescription MakePrescriptionInner(parthenon::ParameterInput *pin, Prescr
     return p_inner;
 }
 
+/**
+ * Geometric floor values depend only on r, i.e. only on (j,i) in spherical coordinates.
+ * Rather than evaluating r and pow() in every zone on every substep, they're tabulated per partition
+ * as (block, var, j, i), where var is rho_floor_geom, u_floor_geom, and whether floors_inner applies.
+ * Cached against the partition's blocks like KBoundaries::ExcisedStarts.
+ */
+struct GeomFloorProfiles {
+    ParArray4D<Real> vals;
+    std::vector<LogicalLocation> locs;
+};
+/**
+ * Get (or build) the table of geometric floors under the package's prescription for md.
+ * Empty in non-spherical coordinates, where determine_floors computes the (constant) floors directly
+ */
+ParArray4D<Real> GetGeomFloorProfiles(MeshData<Real> *md);
+
 /**
  * Initialization.  Set parameters.
  */
@@ -230,10 +255,10 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
 TaskStatus ApplyGRMHDFloors(MeshData<Real> *md, IndexDomain domain);
 
 /**
- * Determine just the floor values and flags for the current state, i.e.
- * 1. floor_vals fields: floor value corresponding to current conditions
- * 2. fflag, which floors were hit by the current state
- * This is what ApplyFloors uses to determine the floor values/locations
+ * Determine just the floor flags for the current state, i.e. fflag, which floors were hit.
+ * Floor values are recorded to Floors.rho_floor/u_floor only if floors/record_floor_values is set.
+ * ApplyGRMHDFloors performs the same determination inline, so this is used only when
+ * marking zones without flooring them, e.g. for FOFC
  */
 TaskStatus DetermineGRMHDFloors(MeshData<Real> *md, IndexDomain domain,
     const Floors::Prescription& floors, const Floors::Prescription& floors_inner);
@@ -248,6 +273,12 @@ TaskStatus DetermineGRMHDFloors(MeshData<Real> *md, IndexDomain domain,
  */
 TaskStatus ApplyInitialFloors(ParameterInput *pin, MeshBlockData<Real> *mbd, IndexDomain domain);
 
+/**
+ * Record fflag counts tallied while flooring md, to be reduced & printed in PostStepDiagnostics.
+ * Counts are in the layout of Reductions::CountFlags
+ */
+void RecordFFlagCounts(MeshData<Real> *md, const Reductions::array_type<int, MAX_NFLAGS>& counts);
+
 /**
  * Count up all nonzero FFlags on md.  Used for history file reductions.
  */
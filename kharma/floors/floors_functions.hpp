@@ -81,18 +81,18 @@ KOKKOS_INLINE_FUNCTION void apply_ceilings(const GRCoordinates& G, const Variabl
     }
 }
 
-KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
-                                        const Real& gam, const int& k, const int& j, const int& i, const Floors::Prescription& floors,
-                                        const Floors::Prescription& floors_inner, Real& rhoflr_max, Real& uflr_max)
+/**
+ * Geometric hard floors, not based on fluid relationships, and whether the inner prescription applies.
+ * These depend only on position: see GetGeomFloorProfiles for the tabulated version
+ */
+KOKKOS_INLINE_FUNCTION void geom_floors(const GRCoordinates& G, const Real& gam, const int& k, const int& j, const int& i,
+                                        const Floors::Prescription& floors, const Floors::Prescription& floors_inner,
+                                        Real& rhoflr_geom, Real& uflr_geom, bool& use_inner)
 {
     // Choose our floor scheme
-    const Floors::Prescription& myfloors = (floors.radius_dependent_floors
-                                            && G.r(k, j, i) < floors.floors_switch_r) ? floors_inner : floors;
+    use_inner = floors.radius_dependent_floors && G.r(k, j, i) < floors.floors_switch_r;
+    const Floors::Prescription& myfloors = use_inner ? floors_inner : floors;
 
-    // Calculate the different floor values in play:
-    // 1. Geometric hard floors, not based on fluid relationships
-    // TODO(BSP) can this be cached if it's slow?
-    Real rhoflr_geom, uflr_geom;
     if(G.coords.is_spherical()) {
         const GReal r = G.r(k, j, i);
         // r_char sets more aggressive floor close to EH but backs off
@@ -103,7 +103,16 @@ KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const Variab
         rhoflr_geom = myfloors.rho_min_const;
         uflr_geom   = myfloors.u_min_const;
     }
+}
 
+/**
+ * Determine floors given the geometric floor values, see below
+ */
+KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                        const Real& gam, const int& k, const int& j, const int& i,
+                                        const Floors::Prescription& myfloors, const Real& rhoflr_geom, const Real& uflr_geom,
+                                        Real& rhoflr_max, Real& uflr_max)
+{
     // 2. Magnetization ceilings: impose maximum magnetization sigma = bsq/rho, and inverse beta prop. to bsq/U
     FourVectors Dtmp;
     GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
@@ -159,6 +168,39 @@ KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const Variab
     return fflag;
 }
 
+/**
+ * Determine which floors are hit in a zone, and the floor values rhoflr_max, uflr_max to apply.
+ * Calculates the different floor values in play:
+ * 1. Geometric hard floors, not based on fluid relationships
+ * 2. Magnetization ceilings
+ * 3. Temperature ceiling
+ */
+KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                        const Real& gam, const int& k, const int& j, const int& i, const Floors::Prescription& floors,
+                                        const Floors::Prescription& floors_inner, Real& rhoflr_max, Real& uflr_max)
+{
+    Real rhoflr_geom, uflr_geom;
+    bool use_inner;
+    geom_floors(G, gam, k, j, i, floors, floors_inner, rhoflr_geom, uflr_geom, use_inner);
+    return determine_floors(G, P, m_p, gam, k, j, i, use_inner ? floors_inner : floors,
+                            rhoflr_geom, uflr_geom, rhoflr_max, uflr_max);
+}
+
+/**
+ * As above, looking up the geometric floors of block b from a table of GetGeomFloorProfiles,
+ * if one is available (i.e., in spherical coordinates)
+ */
+KOKKOS_INLINE_FUNCTION int determine_floors(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                        const Real& gam, const int& b, const int& k, const int& j, const int& i,
+                                        const Floors::Prescription& floors, const Floors::Prescription& floors_inner,
+                                        const ParArray4D<Real>& geom, Real& rhoflr_max, Real& uflr_max)
+{
+    if (geom.extent_int(0) == 0)
+        return determine_floors(G, P, m_p, gam, k, j, i, floors, floors_inner, rhoflr_max, uflr_max);
+    return determine_floors(G, P, m_p, gam, k, j, i, (geom(b, 2, j, i) > 0.) ? floors_inner : floors,
+                            geom(b, 0, j, i), geom(b, 1, j, i), rhoflr_max, uflr_max);
+}
+
 #define FLOOR_ONE_ARGS const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p, const Real& gam, \
                         const int& k, const int& j, const int& i, const Real& rhoflr_max, const Real& uflr_max, \
                         const VariablePack<Real>& U, const VarMap& m_u
@@ -366,4 +408,50 @@ KOKKOS_INLINE_FUNCTION int apply_geo_floors(const GRCoordinates& G, Global& P, c
     return fflag;
 }
 
+/**
+ * Apply floors in the given frame, then ceilings, to a zone which hit a floor, and recompute its
+ * conserved variables.  This is the per-zone body of ApplyFloorsInFrame, for kernels which apply
+ * floors inline (e.g. Inverter::MeshUtoPFloorsFixup)
+ * 
+ * @return pflag of any U->P solve performed by the floors, otherwise 0
+ * 
+ * LOCKSTEP: this function respects P and returns consistent P<->U
+ */
+template<InjectionFrame frame>
+KOKKOS_INLINE_FUNCTION int apply_floors_in_frame(FLOOR_ONE_ARGS, const Floors::Prescription& floors,
+                                                 const Floors::Prescription& floors_inner,
+                                                 const EMHD::EMHD_parameters& emhd_params,
+                                                 const Real& switch_r, const Real& switch_beta)
+{
+    // apply_floors can involve another U_to_P call.  Hide the pflag in bottom 5 bits and retrieve both
+    int pflag_l = 0;
+    if (frame == InjectionFrame::mixed_fluid_normal) {
+        if (G.r(k, j, i) > switch_r) {
+            pflag_l = apply_floors<InjectionFrame::fluid>(G, P, m_p, gam, k, j, i, rhoflr_max, uflr_max, U, m_u);
+        } else {
+            pflag_l = apply_floors<InjectionFrame::normal>(G, P, m_p, gam, k, j, i, rhoflr_max, uflr_max, U, m_u);
+        }
+    } else if (frame == InjectionFrame::mixed_normal_drift) {
+        FourVectors Dtmp;
+        GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
+        Real mag_switch = m::min(P(m_p.RHO, k, j, i), P(m_p.UU, k, j, i)) /
+                            dot(Dtmp.bcon, Dtmp.bcov);
+        if (mag_switch < switch_beta) {
+            pflag_l = apply_floors<InjectionFrame::drift>(G, P, m_p, gam, k, j, i, rhoflr_max, uflr_max, U, m_u);
+        } else {
+            pflag_l = apply_floors<InjectionFrame::normal>(G, P, m_p, gam, k, j, i, rhoflr_max, uflr_max, U, m_u);
+        }
+    } else {
+        pflag_l = apply_floors<frame>(G, P, m_p, gam, k, j, i, rhoflr_max, uflr_max, U, m_u);
+    }
+
+    // Apply ceilings *after* floors, to make the temperature ceiling better-behaved
+    apply_ceilings(G, P, m_p, gam, k, j, i, floors, floors_inner, U, m_u);
+
+    // P->U for any modified zones
+    Flux::p_to_u_mhd(G, P, m_p, emhd_params, gam, k, j, i, U, m_u, Loci::center);
+
+    return pflag_l;
+}
+
 } // Floors
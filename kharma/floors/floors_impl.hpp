@@ -35,6 +35,7 @@
 
 #include "floors.hpp"
 
+#include "boundaries.hpp"
 #include "domain.hpp"
 
 namespace Floors {
@@ -54,8 +55,10 @@ TaskStatus ApplyFloorsInFrame(MeshData<Real> *md, IndexDomain domain)
 
     auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
     auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+    const bool record = pmb0->packages.Get("Floors")->Param<bool>("record_floor_values");
     PackIndexMap floors_map;
-    auto floor_vals = md->PackVariables(std::vector<std::string>{"Floors.rho_floor", "Floors.u_floor"}, floors_map);
+    auto floor_vals = md->PackVariables(record ? std::vector<std::string>{"Floors.rho_floor", "Floors.u_floor"}
+                                               : std::vector<std::string>{}, floors_map);
     const int rhofi = floors_map["Floors.rho_floor"].first;
     const int ufi = floors_map["Floors.u_floor"].first;
 
@@ -69,60 +72,134 @@ TaskStatus ApplyFloorsInFrame(MeshData<Real> *md, IndexDomain domain)
     const Floors::Prescription floors = pmb0->packages.Get("Floors")->Param<Floors::Prescription>("prescription");
     const Floors::Prescription floors_inner = pmb0->packages.Get("Floors")->Param<Floors::Prescription>("prescription_inner");
 
-    // Determine floors
-    DetermineGRMHDFloors(md, domain, floors, floors_inner);
+    // Count flags in passing if we'll report them, see PostStepDiagnostics
+    const bool count_flags = pmb0->packages.Get("Globals")->Param<int>("flag_verbose") > 0;
+    const auto fflag_vals = pmb0->packages.Get("Floors")->Param<ParArray1D<int>>("fflag_values");
+    const int n_fflags = FFlag::flag_names.size();
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    Reductions::array_type<int, MAX_NFLAGS> fflag_counts;
 
+    const auto excised = KBoundaries::GetExcisedStarts(md);
+    const auto geom = GetGeomFloorProfiles(md);
     const IndexRange3 b = KDomain::GetRange(md, domain);
     const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
-    pmb0->par_for("apply_floors", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
-        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
-            if (static_cast<int>(fflag(b, 0, k, j, i))) {
-                const auto& G = P.GetCoords(b);
-                // apply_floors can involve another U_to_P call.  Hide the pflag in bottom 5 bits and retrieve both
-                int pflag_l = 0;
-                // These would be constexpr except Nvidia doesn't like lambda-capture in constexpr ifs
-                if (frame == InjectionFrame::mixed_fluid_normal) {
-                    if (G.r(k, j, i) > switch_r) {
-                        pflag_l = apply_floors<InjectionFrame::fluid>(G, P(b), m_p, gam, k, j, i,
-                                            floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i),
-                                            U(b), m_u);
-                    } else {
-                        pflag_l = apply_floors<InjectionFrame::normal>(G, P(b), m_p, gam, k, j, i,
-                                            floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i),
-                                            U(b), m_u);
-                    }
-                } else if (frame == InjectionFrame::mixed_normal_drift) {
-                    FourVectors Dtmp;
-                    GRMHD::calc_4vecs(G, P(b), m_p, k, j, i, Loci::center, Dtmp);
-                    Real mag_switch = m::min(P(b, m_p.RHO, k, j, i), P(b, m_p.UU, k, j, i)) /
-                                        dot(Dtmp.bcon, Dtmp.bcov);
-                    if (mag_switch < switch_beta) {
-                        pflag_l = apply_floors<InjectionFrame::drift>(G, P(b), m_p, gam, k, j, i,
-                                            floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i),
-                                            U(b), m_u);
-                    } else {
-                        pflag_l = apply_floors<InjectionFrame::normal>(G, P(b), m_p, gam, k, j, i,
-                                            floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i),
-                                            U(b), m_u);
+
+    if (pmb0->packages.Get("Floors")->Param<bool>("sparse")) {
+        // Mark zones, then compact the list of flagged zones and only launch the frame injection over those.
+        // In steady state few zones (mostly the jet funnel) hit floors, so this saves divergent work
+        pmb0->par_for("determine_floors_sparse", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+                if (i < excised(bl)) return;
+                const auto& G = P.GetCoords(bl);
+                Real rhoflr_max, uflr_max;
+                Floors::FFlag::add_codes(fflag(bl, 0, k, j, i),
+                                         determine_floors(G, P(bl), m_p, gam, bl, k, j, i, floors, floors_inner,
+                                                          geom, rhoflr_max, uflr_max));
+                if (record) {
+                    floor_vals(bl, rhofi, k, j, i) = rhoflr_max;
+                    floor_vals(bl, ufi, k, j, i) = uflr_max;
+                }
+            }
+        );
+
+        const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+        const int nzones = (block.e + 1) * nk * nj * ni;
+        auto *zone_list_p = GetPartitionParam<ParArray1D<int>>(md, "Floors", "floor_zone_list");
+        if (zone_list_p->extent_int(0) == 0) *zone_list_p = ParArray1D<int>("floor_zone_list", 1024);
+        int nlist = 0;
+        bool fits = false;
+        while (!fits) {
+            const auto zone_list = *zone_list_p;
+            const int capacity = zone_list.extent_int(0);
+            Kokkos::parallel_scan("floors_compact", Kokkos::RangePolicy<>(DevExecSpace(), 0, nzones),
+                KOKKOS_LAMBDA (const int &n, int &idx, const bool &final) {
+                    const int i = b.is + n % ni;
+                    const int j = b.js + (n / ni) % nj;
+                    const int k = b.ks + (n / (ni*nj)) % nk;
+                    const int bl = n / (ni*nj*nk);
+                    if (static_cast<int>(fflag(bl, 0, k, j, i))) {
+                        if (final && idx < capacity) zone_list(idx) = n;
+                        ++idx;
                     }
-                } else {
-                    pflag_l = apply_floors<frame>(G, P(b), m_p, gam, k, j, i,
-                                        floor_vals(b, rhofi, k, j, i), floor_vals(b, ufi, k, j, i),
-                                        U(b), m_u);
                 }
+            , nlist);
+            // If the list overflowed, grow it and compact again
+            fits = (nlist <= capacity);
+            if (!fits) Kokkos::resize(*zone_list_p, 2 * nlist);
+        }
+
+        // Every flagged zone is on the list, so counting over it counts all floors hit
+        const auto zone_list = *zone_list_p;
+        pmb0->par_reduce("apply_floors_sparse", 0, nlist - 1,
+            KOKKOS_LAMBDA (const int &m, Reductions::array_type<int, MAX_NFLAGS> &local_result) {
+                const int n = zone_list(m);
+                const int i = b.is + n % ni;
+                const int j = b.js + (n / ni) % nj;
+                const int k = b.ks + (n / (ni*nj)) % nk;
+                const int bl = n / (ni*nj*nk);
+                const auto& G = P.GetCoords(bl);
+                // Re-determining the floor values is cheap next to storing them mesh-wide
+                Real rhoflr_max = 0., uflr_max = 0.;
+                if (i >= excised(bl))
+                    determine_floors(G, P(bl), m_p, gam, bl, k, j, i, floors, floors_inner, geom, rhoflr_max, uflr_max);
+                const int pflag_l = apply_floors_in_frame<frame>(G, P(bl), m_p, gam, k, j, i,
+                                            rhoflr_max, uflr_max,
+                                            U(bl), m_u, floors, floors_inner, emhd_params, switch_r, switch_beta);
+                if (pflag_l) pflag(bl, 0, k, j, i) = pflag_l;
+                if (count_flags && KDomain::inside(k, j, i, bi))
+                    Reductions::TallyFlag(static_cast<int>(fflag(bl, 0, k, j, i)), fflag_vals, n_fflags, true, local_result);
+            }
+        , Reductions::ArraySum<int, HostExecSpace, MAX_NFLAGS>(fflag_counts));
+        if (count_flags) RecordFFlagCounts(md, fflag_counts);
+        return TaskStatus::complete;
+    }
 
+    // Determine and apply floors in one pass, keeping the floor values local
+    const auto floor_zone = KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            const auto& G = P.GetCoords(b);
+            // Excised zones keep whatever flags they have, but determine no new floors
+            Real rhoflr_max = 0., uflr_max = 0.;
+            int fflag_l = static_cast<int>(fflag(b, 0, k, j, i));
+            if (i >= excised(b)) {
+                const int new_codes = determine_floors(G, P(b), m_p, gam, b, k, j, i, floors, floors_inner,
+                                                       geom, rhoflr_max, uflr_max);
+                if (new_codes) {
+                    fflag_l |= new_codes;
+                    fflag(b, 0, k, j, i) = fflag_l;
+                }
+                if (record) {
+                    floor_vals(b, rhofi, k, j, i) = rhoflr_max;
+                    floor_vals(b, ufi, k, j, i) = uflr_max;
+                }
+            }
+            if (fflag_l) {
+                const int pflag_l = apply_floors_in_frame<frame>(G, P(b), m_p, gam, k, j, i,
+                                            rhoflr_max, uflr_max,
+                                            U(b), m_u, floors, floors_inner, emhd_params, switch_r, switch_beta);
                 // Record the pflag if nonzero, that is, if *either* the initial inversion or
                 // post-floor inversion failed.
                 if (pflag_l) pflag(b, 0, k, j, i) = pflag_l;
+            }
+            return fflag_l;
+        };
 
-                // Apply ceilings *after* floors, to make the temperature ceiling better-behaved
-                apply_ceilings(G, P(b), m_p, gam, k, j, i, floors, floors_inner, U(b), m_u);
-
-                // P->U for any modified zones
-                Flux::p_to_u_mhd(G, P(b), m_p, emhd_params, gam, k, j, i, U(b), m_u, Loci::center);
+    if (count_flags) {
+        pmb0->par_reduce("apply_floors_count", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i,
+                           Reductions::array_type<int, MAX_NFLAGS> &local_result) {
+                const int fflag_l = floor_zone(b, k, j, i);
+                if (KDomain::inside(k, j, i, bi))
+                    Reductions::TallyFlag(fflag_l, fflag_vals, n_fflags, true, local_result);
             }
-        }
-    );
+        , Reductions::ArraySum<int, HostExecSpace, MAX_NFLAGS>(fflag_counts));
+        RecordFFlagCounts(md, fflag_counts);
+    } else {
+        pmb0->par_for("apply_floors", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+                floor_zone(b, k, j, i);
+            }
+        );
+    }
 
     return TaskStatus::complete;
 }
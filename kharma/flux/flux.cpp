@@ -38,11 +38,18 @@
 #include "b_ct.hpp"
 #include "grmhd.hpp"
 #include "kharma.hpp"
+#include "scratch_tuner.hpp"
+#include "wind.hpp"
 
 using namespace parthenon;
 
 // GetFlux is in the header file get_flux.hpp, as it is templated on reconstruction scheme and flux direction
 
+namespace {
+// Cell-centered FourVectors, if cached, see GRMHD::CacheFourVectors
+const std::vector<std::string> names_fourvec{"GRMHD.fourvectors"};
+}
+
 int Flux::CountFOFCFlags(MeshData<Real> *md)
 {
     return Reductions::CountFlags(md, "fofcflag", std::map<int, std::string>{{1, "Flux-corrected"}}, IndexDomain::interior, true)[0];
@@ -60,9 +67,20 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
     if (pin->DoesParameterExist("driver", "flux")) {
         default_flux_s = pin->GetString("driver", "flux");
     }
-    std::vector<std::string> flux_allowed_vals = {"llf", "hlle"};
+    std::vector<std::string> flux_allowed_vals = {"llf", "hlle", "hllc"};
     std::string flux = pin->GetOrAddString("flux", "type", default_flux_s, flux_allowed_vals);
     params.Add("use_hlle", (flux == "hlle"));
+    params.Add("use_hllc", (flux == "hllc"));
+    if (flux == "hllc") {
+        // HLLC is implemented for unmagnetized fluids in flat space, see flux.hpp
+        const std::string base = pin->GetString("coordinates", "base");
+        const std::string transform = pin->GetOrAddString("coordinates", "transform", "null");
+        if (!((base == "cartesian_minkowski" || base == "minkowski") && (transform == "null" || transform == "none")))
+            throw std::invalid_argument("HLLC fluxes are only implemented in Cartesian Minkowski coordinates!");
+        if (packages->AllPackages().count("B_FluxCT") || packages->AllPackages().count("B_CT") ||
+            packages->AllPackages().count("B_CD") || packages->AllPackages().count("EMHD"))
+            throw std::invalid_argument("HLLC fluxes are only implemented for unmagnetized, ideal fluids!");
+    }
 
     // Reconstruction scheme
     // Allow from all the places it's ever been
@@ -77,10 +95,16 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
     std::string recon = pin->GetOrAddString("flux", "reconstruction", default_recon_s, recon_allowed_vals);
     bool lower_edges = pin->GetOrAddBoolean("flux", "low_order_edges", false);
     bool lower_poles = pin->GetOrAddBoolean("flux", "low_order_poles", false);
+    // Compute the shared parts of WENO5 smoothness indicators once per zone.  Identical results
+    bool weno5_cache = pin->GetOrAddBoolean("flux", "weno5_cache_indicators", false);
+    // Fall back to linear_mc for rows where all variables are smooth
+    bool adaptive_order = pin->GetOrAddBoolean("flux", "adaptive_order", false);
     if (lower_edges && lower_poles)
         throw std::runtime_error("Cannot enable lowered reconstruction on edges and poles!");
-    if ((lower_edges || lower_poles) && recon != "weno5")
+    if ((lower_edges || lower_poles || adaptive_order) && recon != "weno5")
         throw std::runtime_error("Lowered reconstructions can only be enabled with weno5!");
+    if (adaptive_order && (lower_edges || lower_poles || weno5_cache))
+        throw std::runtime_error("Adaptive reconstruction order cannot be combined with other WENO5 variants!");
 
     int stencil = 0;
     if (recon == "donor_cell") {
@@ -101,6 +125,12 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
     } else if (recon == "weno5" && lower_poles) {
         params.Add("recon", KReconstruction::Type::weno5_lower_poles);
         stencil = 5;
+    } else if (recon == "weno5" && adaptive_order) {
+        params.Add("recon", KReconstruction::Type::weno5_adaptive);
+        stencil = 5;
+    } else if (recon == "weno5" && weno5_cache) {
+        params.Add("recon", KReconstruction::Type::weno5_cached);
+        stencil = 5;
     } else if (recon == "weno5") {
         params.Add("recon", KReconstruction::Type::weno5);
         stencil = 5;
@@ -119,11 +149,18 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
         params.Add("recon", KReconstruction::Type::mp5);
         stencil = 5;
     }  // we only allow these options
+#if FLOAT_RECONSTRUCTION
+    if (recon != "weno5" && MPIRank0())
+        std::cout << "KHARMA WARNING: Single-precision reconstruction is only implemented for WENO5." << std::endl
+                  << "Reconstruction " << recon << " will use double precision." << std::endl;
+#endif
     // Warn if using less than 3 ghost zones w/WENO etc, 2 w/Linear, etc.
     // SMR/AMR independently requires an even number of zones, so we usually use 4
     if (Globals::nghost < (stencil/2 + 1)) {
         throw std::runtime_error("Not enough ghost zones for specified reconstruction!");
     }
+    // Kept to size the halos of temporally blocked stages, see MakeSimpleTaskCollection
+    params.Add("recon_stencil", stencil);
 
     // Floors package *has* been initialized if it's going to be
     // Apply floors for high-order reconstructions
@@ -148,21 +185,75 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
         params.Add("consistent_face_b", consistent_face_b);
     }
 
+    // Compute fluxes in a single kernel holding left/right states in scratch memory,
+    // rather than in the full-mesh Flux.Pl/Pr/Ul/Ur/Fl/Fr temporaries below.
+    // Saves a lot of memory, but FOFC and excised polar fluxes need the temporaries.
+    bool fused_flux = pin->GetOrAddBoolean("flux", "fused", false);
+    params.Add("fused_flux", fused_flux);
+    // Further, compute all directions in one kernel launch.  Mostly helps small blocks
+    bool fused_directions = pin->GetOrAddBoolean("flux", "fused_directions", false);
+    if (fused_directions && !fused_flux)
+        throw std::runtime_error("Computing all flux directions at once requires <flux> fused = true!");
+    params.Add("fused_directions", fused_directions);
+    // Additional zones into the ghosts over which the fused kernels compute fluxes, beyond the usual
+    // one for flux-CT.  Nonzero only for the early stages of a temporally blocked step, see <driver> temporal_blocking
+    params.Add("stage_halo", 0, true);
+    // Contract the geometric source term only over connection coefficients which aren't identically zero
+    params.Add("sparse_conn", pin->GetOrAddBoolean("flux", "sparse_conn", true));
+    // Kept per-partition, see GetConnPattern
+    params.Add("conn_pattern", std::map<int, std::pair<ConnPattern, std::vector<LogicalLocation>>>(), true);
+    // Team scratch level for each flux kernel: 0 (on-chip), 1 (device memory, the default), or "auto"
+    // to time both in the first few steps.  See ScratchTuner in scratch_tuner.hpp for the options
+    for (auto kernel : {"recon", "flux", "fused", "fused_all"})
+        params.Add(std::string("tuner_") + kernel, ScratchTuner::Make(pin, "flux", std::string("calc_flux_") + kernel), true);
+    // Reduce the per-block minimum dx/ctop while calculating fluxes, for GRMHD::EstimateTimestep.
+    // Takes the minimum in each direction separately, so the resulting step is slightly conservative
+    bool cache_timestep = pin->GetOrAddBoolean("flux", "cache_timestep", false);
+    params.Add("cache_timestep", cache_timestep);
+    if (cache_timestep) {
+        // Sized on first use, and whenever the mesh gains blocks
+        ParArray2D<Real> ndt_cache("ndt_cache", 0, 3);
+        params.Add("ndt_cache", ndt_cache, true);
+    }
+    // Per-block counts of NaN and zero ctop taken in the same pass, with extra_checks.  See TimestepCache
+    ParArray2D<int> bad_ctop("bad_ctop", 0, 2);
+    params.Add("bad_ctop", bad_ctop, true);
+
+    // Choose which compiled version of the flux calculation to use, based on the loaded packages.
+    // All packages with fluxes are loaded by now.  See PackageSet in flux_functions.hpp
+    bool specialize = pin->GetOrAddBoolean("flux", "specialize_packages", true);
+    Flux::PackageSet package_set = Flux::PackageSet::general;
+    if (specialize && !packages->AllPackages().count("EMHD") && !packages->AllPackages().count("B_CD")) {
+        package_set = (packages->AllPackages().count("Electrons")) ? Flux::PackageSet::mhd_electrons
+                                                                   : Flux::PackageSet::mhd;
+    }
+    params.Add("package_set", package_set);
+    // Whether the variable layout matches VarMap::FixedMHD, checked on first use (see FixedLayout in get_flux.hpp)
+    params.Add("fixed_varmap", -1, true);
+
+    // Run whole-domain PtoU on zone-local copies of the primitive & conserved variables (see ZoneVars in types.hpp),
+    // rather than through the packs directly.  Can help CPU builds, where each variable is a block volume apart
+    bool zone_tiles = pin->GetOrAddBoolean("flux", "zone_tiles", false);
+    params.Add("zone_tiles", zone_tiles);
+
     // We can't just use GetVariables or something since there's no mesh yet.
     // That's what this function is for.
     int nvar = KHARMA::PackDimension(packages.get(), Metadata::WithFluxes);
     std::vector<int> s_flux({nvar});
-    if (packages->Get("Globals")->Param<int>("verbose") > 2)
-        std::cout << "Allocating fluxes for " << nvar << " variables" << std::endl;
-    // TODO optionally move all these to faces? Not important yet, & faces have no output, more memory
-    std::vector<MetadataFlag> flags_flux = {Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy};
-    Metadata m = Metadata(flags_flux, s_flux);
-    pkg->AddField("Flux.Pr", m);
-    pkg->AddField("Flux.Pl", m);
-    pkg->AddField("Flux.Ur", m);
-    pkg->AddField("Flux.Ul", m);
-    pkg->AddField("Flux.Fr", m);
-    pkg->AddField("Flux.Fl", m);
+    Metadata m;
+    if (!fused_flux) {
+        if (packages->Get("Globals")->Param<int>("verbose") > 2)
+            std::cout << "Allocating fluxes for " << nvar << " variables" << std::endl;
+        // TODO optionally move all these to faces? Not important yet, & faces have no output, more memory
+        std::vector<MetadataFlag> flags_flux = {Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy};
+        m = Metadata(flags_flux, s_flux);
+        pkg->AddField("Flux.Pr", m);
+        pkg->AddField("Flux.Pl", m);
+        pkg->AddField("Flux.Ur", m);
+        pkg->AddField("Flux.Ul", m);
+        pkg->AddField("Flux.Fr", m);
+        pkg->AddField("Flux.Fl", m);
+    }
 
     std::vector<int> s_vector({NVEC});
     std::vector<MetadataFlag> flags_speed = {Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy};
@@ -182,6 +273,9 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
     params.Add("use_fofc", use_fofc);
 
     if (use_fofc) {
+        if (fused_flux)
+            throw std::runtime_error("FOFC requires the unfused flux calculation! Set <flux> fused = false");
+
         // FOFC-specific options
         bool use_glf = pin->GetOrAddBoolean("fofc", "use_glf", false);
         params.Add("fofc_use_glf", use_glf);
@@ -194,6 +288,15 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
         const GReal eh_buffer = pin->GetOrAddReal("fofc", "eh_buffer", 0.1);
         params.Add("fofc_eh_buffer", eh_buffer);
 
+        // Replace fluxes only over a compacted list of faces bordering marked zones,
+        // rather than checking every face of the mesh
+        bool fofc_sparse = pin->GetOrAddBoolean("fofc", "sparse", false);
+        params.Add("fofc_sparse", fofc_sparse);
+        if (fofc_sparse) {
+            // Grown as needed, and kept per-partition, see GetPartitionParam
+            params.Add("fofc_face_list", std::map<int, ParArray1D<int>>(), true);
+        }
+
         if (packages->AllPackages().count("B_CT")) {
             // Use consistent B for FOFC (see above)
             // It is mildly inadvisable to disable this
@@ -231,8 +334,19 @@ std::shared_ptr<KHARMAPackage> Flux::Initialize(ParameterInput *pin, std::shared
 
     }
 
-    // We register the geometric (\Gamma*T) source here
-    pkg->AddSource = Flux::AddGeoSource;
+    // We register the geometric (\Gamma*T) source here.
+    // Packages which can (e.g. Wind) have their per-zone sources evaluated in the same kernel,
+    // rather than each in a separate pass over the mesh, see AddGeoSource
+    bool fuse_sources = pin->GetOrAddBoolean("flux", "fuse_sources", true);
+    params.Add("fuse_sources", fuse_sources);
+    pkg->AddSource = [](MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain) {
+        Flux::AddGeoSource(md, mdudt, domain, true);
+    };
+    // Optionally, add it (and the fused sources) in the flux divergence kernel instead, see FluxDivergenceSources.
+    // Not compatible with excised polar fluxes, which must scale only the divergence
+    bool fuse_divergence = pin->GetOrAddBoolean("flux", "fuse_divergence", false);
+    params.Add("fuse_divergence", fuse_divergence);
+    pkg->fused_source = fuse_divergence;
 
     // And the post-step diagnostics
     pkg->PostStepDiagnosticsMesh = Flux::PostStepDiagnostics;
@@ -305,6 +419,21 @@ TaskStatus Flux::BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coa
 
     const auto& G = pmb->coords;
 
+    const int nvar_p = P.GetDim(4);
+    if (pmb->packages.Get("Flux")->Param<bool>("zone_tiles") && nvar_p <= MAX_VARS && nvar <= MAX_VARS) {
+        pmb->par_for("p_to_u_tiles", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
+                // U is loaded too, to preserve any conserved variables without a primitive
+                ZoneVars<MAX_VARS> Pz, Uz;
+                Pz.Load(P, nvar_p, k, j, i);
+                Uz.Load(U, nvar, k, j, i);
+                Flux::p_to_u(G, Pz, m_p, emhd_params, gam, j, i, Uz, m_u);
+                Uz.Store(U, nvar, k, j, i);
+            }
+        );
+        return TaskStatus::complete;
+    }
+
     pmb->par_for("p_to_u", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
             Flux::p_to_u(G, P, m_p, emhd_params, gam, k, j, i, U, m_u);
@@ -321,6 +450,44 @@ TaskStatus Flux::MeshPtoU(MeshData<Real> *md, IndexDomain domain, bool coarse)
     return TaskStatus::complete;
 }
 
+TaskStatus Flux::MeshPtoUFlagged(MeshData<Real> *md, IndexDomain domain)
+{
+    Flag("MeshPtoUFlagged");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+    const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(pmb0->packages);
+
+    // Face CT is still authoritative for the centered conserved B, everywhere
+    if (pmb0->packages.AllPackages().count("B_CT"))
+        for (int i=0; i < md->NumBlocks(); ++i)
+            B_CT::BlockUtoP(md->GetBlockData(i).get(), domain, false);
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    auto U = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    if (P.GetDim(4) == 0) {
+        EndFlag();
+        return TaskStatus::complete;
+    }
+    const auto& pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+    const auto& fflag = md->PackVariables(std::vector<std::string>{"fflag"});
+
+    const IndexRange3 b = KDomain::GetRange(md, domain);
+    const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
+    pmb0->par_for("p_to_u_flagged", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            if (static_cast<int>(pflag(bl, 0, k, j, i)) != 0 || static_cast<int>(fflag(bl, 0, k, j, i)) != 0) {
+                const auto& G = U.GetCoords(bl);
+                Flux::p_to_u(G, P(bl), m_p, emhd_params, gam, k, j, i, U(bl), m_u);
+            }
+        }
+    );
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 TaskStatus Flux::BlockPtoU_Send(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
 {
     // Pointers
@@ -392,7 +559,7 @@ TaskStatus Flux::BlockPtoU_Send(MeshBlockData<Real> *rc, IndexDomain domain, boo
     return TaskStatus::complete;
 }
 
-void Flux::AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain)
+void Flux::AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain, bool with_fused)
 {
     // Pointers
     auto pmesh = md->GetMeshPointer();
@@ -402,15 +569,26 @@ void Flux::AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain d
     const auto& pars = pkgs.Get("GRMHD")->AllParams();
     const Real gam   = pars.Get<Real>("gamma");
 
+    // Fused per-zone sources from other packages.  These are only ever added over the interior
+    auto kpackages = pmesh->packages.AllPackagesOfType<KHARMAPackage>();
+    const bool fuse_wind = with_fused && kpackages.count("Wind") && kpackages.at("Wind")->fused_source;
+    const Wind::WindParameters wind = (fuse_wind) ? Wind::GetWindParameters(pkgs) : Wind::WindParameters();
+    const auto wind_profiles = (fuse_wind) ? Wind::GetWindProfiles(mdudt).vals : ParArray3D<Real>();
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+
     // All connection coefficients are zero in Cartesian Minkowski space
     // TODO do we know this fully in init?
-    if (pmb0->coords.coords.is_cart_minkowski()) return;
+    const bool add_geo = !pmb0->coords.coords.is_cart_minkowski();
+    if (!add_geo && !fuse_wind) return;
 
     // Pack variables
     PackIndexMap prims_map, cons_map;
     auto P    = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
     auto dUdt = mdudt->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
     const VarMap m_p(prims_map, false), m_u(cons_map, true);
+    const ConnPattern conn = (add_geo) ? GetConnPattern(md) : ConnPattern();
+    const bool cached_4vecs = add_geo && GRMHD::UseCachedFourVectors(md);
+    const auto& C4 = md->PackVariables(names_fourvec);
 
     // EMHD params
     const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(pmb0->packages);
@@ -422,34 +600,122 @@ void Flux::AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain d
     pmb0->par_for("tmunu_source", block.s, block.e, bd.ks, bd.ke, bd.js, bd.je, bd.is, bd.ie,
         KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
             const auto& G = dUdt.GetCoords(b);
-            FourVectors D;
-            GRMHD::calc_4vecs(G, P(b), m_p, k, j, i, Loci::center, D);
-            // Call Flux::calc_tensor which will in turn call the right calc_tensor based on the number of primitives
-            Real Tmu[GR_DIM]    = {0};
-            Real new_du[GR_DIM] = {0};
-            for (int mu = 0; mu < GR_DIM; ++mu) {
-                Flux::calc_tensor(P(b), m_p, D, emhd_params, gam, k, j, i, mu, Tmu);
-                for (int nu = 0; nu < GR_DIM; ++nu) {
-                    // Contract mhd stress tensor with connection, and multiply by metric determinant
-                    for (int lam = 0; lam < GR_DIM; ++lam) {
-                        new_du[lam] += Tmu[nu] * G.gdet_conn(j, i, nu, lam, mu);
-                    }
-                }
+            if (add_geo) {
+                FourVectors D;
+                if (cached_4vecs) GRMHD::load_4vecs(C4(b), k, j, i, D);
+                else GRMHD::calc_4vecs(G, P(b), m_p, k, j, i, Loci::center, D);
+                // Contract the stress tensor with the (nonzero) connection, times the metric determinant
+                Real new_du[GR_DIM] = {0};
+                Flux::geo_source(G, P(b), m_p, D, emhd_params, gam, conn, k, j, i, new_du);
+
+                dUdt(b, m_u.UU, k, j, i)           += new_du[0];
+                VLOOP dUdt(b, m_u.U1 + v, k, j, i) += new_du[1 + v];
             }
 
-            dUdt(b, m_u.UU, k, j, i)           += new_du[0];
-            VLOOP dUdt(b, m_u.U1 + v, k, j, i) += new_du[1 + v];
+            const bool in_interior = (i >= bi.is && i <= bi.ie && j >= bi.js && j <= bi.je && k >= bi.ks && k <= bi.ke);
+            if (fuse_wind && in_interior) {
+                Wind::add_source(G, wind, gam, wind_profiles(b, j, i), k, j, i, m_u, dUdt(b));
+            }
         }
     );
 }
 
-TaskStatus Flux::CheckCtop(MeshData<Real> *md)
+TaskStatus Flux::FluxDivergenceSources(MeshData<Real> *md, MeshData<Real> *mdudt, DivergenceRegion region)
 {
-    Reductions::DomainReduction<Reductions::Var::nan_ctop, int>(md, UserHistoryOperation::sum, 0);
-    Reductions::DomainReduction<Reductions::Var::zero_ctop, int>(md, UserHistoryOperation::sum, 1);
+    Flag("FluxDivergenceSources");
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0  = md->GetBlockData(0)->GetBlockPointer();
+    auto pkgs = pmb0->packages;
+    const Real gam = pkgs.Get("GRMHD")->Param<Real>("gamma");
+
+    auto kpackages = pmesh->packages.AllPackagesOfType<KHARMAPackage>();
+    const bool fuse_wind = kpackages.count("Wind") && kpackages.at("Wind")->fused_source;
+    const Wind::WindParameters wind = (fuse_wind) ? Wind::GetWindParameters(pkgs) : Wind::WindParameters();
+    const auto wind_profiles = (fuse_wind) ? Wind::GetWindProfiles(mdudt).vals : ParArray3D<Real>();
+    // All connection coefficients are zero in Cartesian Minkowski space
+    const bool add_geo = !pmb0->coords.coords.is_cart_minkowski();
+
+    // Same variables as the unfused divergence in AddFluxDivergence
+    const std::vector<MetadataFlag> flags = {Metadata::Independent, Metadata::Cell, Metadata::WithFluxes};
+    PackIndexMap prims_map, cons_map;
+    const auto &U = md->PackVariablesAndFluxes(flags, cons_map);
+    auto dUdt = mdudt->PackVariables(flags);
+    const auto &P = md->PackVariables(PackFlags::Primitive(), prims_map);
+    const VarMap m_p(prims_map, false), m_u(cons_map, true);
+    const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(pmb0->packages);
+    const ConnPattern conn = (add_geo) ? GetConnPattern(md) : ConnPattern();
+    const bool cached_4vecs = add_geo && GRMHD::UseCachedFourVectors(md);
+    const auto& C4 = md->PackVariables(names_fourvec);
+    const int nvar = U.GetDim(4);
+    const int ndim = U.GetNdim();
+
+    // Regions as in KHARMADriver::FluxDivergence
+    const IndexRange3 bulk = KDomain::GetRange(md, IndexDomain::interior, 1, -1);
+    const IndexRange3 b = (region == DivergenceRegion::bulk) ? bulk : KDomain::GetRange(md, IndexDomain::interior);
+    const bool rind_only = (region == DivergenceRegion::rind);
+    const IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+
+    pmb0->par_for("flux_divergence_sources", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int& bl, const int &k, const int &j, const int &i) {
+            if (rind_only && KDomain::inside(k, j, i, bulk)) return;
+            const auto& G = U.GetCoords(bl);
+            for (int l = 0; l < nvar; ++l)
+                if (dUdt.IsAllocated(bl, l) && U.IsAllocated(bl, l))
+                    dUdt(bl, l, k, j, i) = Update::FluxDivHelper(l, k, j, i, ndim, G, U(bl));
+
+            if (add_geo) {
+                FourVectors D;
+                if (cached_4vecs) GRMHD::load_4vecs(C4(bl), k, j, i, D);
+                else GRMHD::calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, D);
+                Real new_du[GR_DIM] = {0};
+                Flux::geo_source(G, P(bl), m_p, D, emhd_params, gam, conn, k, j, i, new_du);
+                dUdt(bl, m_u.UU, k, j, i)           += new_du[0];
+                VLOOP dUdt(bl, m_u.U1 + v, k, j, i) += new_du[1 + v];
+            }
+
+            if (fuse_wind) {
+                Wind::add_source(G, wind, gam, wind_profiles(bl, j, i), k, j, i, m_u, dUdt(bl));
+            }
+        }
+    );
+    EndFlag();
     return TaskStatus::complete;
 }
 
+Flux::ConnPattern Flux::GetConnPattern(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto *cache = GetPartitionParam<std::pair<ConnPattern, std::vector<LogicalLocation>>>(md, "Flux", "conn_pattern");
+    auto locs = PartitionLocations(md);
+    if (cache->second == locs) return cache->first;
+
+    constexpr int NCONN = GR_DIM*GR_DIM*GR_DIM;
+    Reductions::array_type<int, NCONN> nonzero;
+    if (pmb0->packages.Get("Flux")->Param<bool>("sparse_conn")) {
+        // Geometry varies only in (X1, X2), so check one slice of each block
+        auto P = md->PackVariables(PackFlags::Primitive());
+        const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+        const IndexRange block = IndexRange{0, P.GetDim(5) - 1};
+        pmb0->par_reduce("conn_pattern", block.s, block.e, b.ks, b.ks, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i,
+                           Reductions::array_type<int, NCONN> &local_result) {
+                const auto& G = P.GetCoords(bl);
+                for (int n = 0; n < NCONN; ++n)
+                    if (G.gdet_conn(j, i, n % GR_DIM, (n / GR_DIM) % GR_DIM, n / (GR_DIM*GR_DIM)) != 0.)
+                        ++local_result.my_array[n];
+            }
+        , Reductions::ArraySum<int, HostExecSpace, NCONN>(nonzero));
+    } else {
+        for (int n = 0; n < NCONN; ++n) nonzero.my_array[n] = 1;
+    }
+
+    ConnPattern pattern;
+    for (int n = 0; n < NCONN; ++n)
+        if (nonzero.my_array[n] > 0) pattern.idx[pattern.n++] = n;
+    *cache = std::make_pair(pattern, locs);
+    return pattern;
+}
+
 TaskStatus Flux::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
 {
     auto pmesh = md->GetMeshPointer();
@@ -457,23 +723,41 @@ TaskStatus Flux::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
     const auto& globals = pmesh->packages.Get("Globals")->AllParams();
     const int extra_checks = globals.Get<int>("extra_checks");
     const int flag_verbose = globals.Get<int>("flag_verbose");
-    const auto& flux_pars = pmesh->packages.Get("Flux")->AllParams();
+    auto& flux_pars = pmesh->packages.Get("Flux")->AllParams();
     const bool use_fofc = flux_pars.Get<bool>("use_fofc");
 
     // Debugging/diagnostic info about FOFC hits
     if (use_fofc && flag_verbose > 0) {
         std::map<int, std::string> fofc_label = {{1, "Flux-corrected"}};
-        Reductions::StartFlagReduce(md, "fofcflag", fofc_label, IndexDomain::interior, false, 10);
+        Reductions::StartFlagReduce(md, "fofcflag", fofc_label, IndexDomain::interior, false, Reductions::Channel::fofcflag);
         // Debugging/diagnostic info about floor and inversion flags
-        Reductions::CheckFlagReduceAndPrintHits(md, "fofcflag", fofc_label, IndexDomain::interior, false, 10);
+        Reductions::FinishFlagReduce(md, "fofcflag", fofc_label, IndexDomain::interior, false, Reductions::Channel::fofcflag);
     }
 
     // Check for a soundspeed (ctop) of 0 or NaN
     // This functions as a "last resort" check to stop a
     // simulation on obviously bad data
     if (extra_checks > 0) {
-        int nnan = Reductions::Check<int>(md, 0);
-        int nzero = Reductions::Check<int>(md, 1);
+        // Sum the per-block counts taken while calculating fluxes in each stage, then zero them for the next step
+        auto *bad_ctop = flux_pars.GetMutable<ParArray2D<int>>("bad_ctop");
+        int nnan_rank = 0, nzero_rank = 0;
+        if (bad_ctop->extent_int(0) > 0) {
+            const auto bad_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), *bad_ctop);
+            for (int b = 0; b < md->NumBlocks(); ++b) {
+                auto pmb = md->GetBlockData(b)->GetBlockPointer();
+                if (pmb->lid >= bad_h.extent_int(0)) continue;
+                const int nnan_b = bad_h(pmb->lid, 0), nzero_b = bad_h(pmb->lid, 1);
+                if (flag_verbose > 0 && (nnan_b > 0 || nzero_b > 0))
+                    fprintf(stderr, "Block %d: %d zero, %d NaN ctop\n", pmb->gid, nzero_b, nnan_b);
+                nnan_rank += nnan_b;
+                nzero_rank += nzero_b;
+            }
+            Kokkos::deep_copy(*bad_ctop, 0);
+        }
+        Reductions::Start<int>(md, Reductions::Channel::nan_ctop, nnan_rank, MPI_SUM);
+        Reductions::Start<int>(md, Reductions::Channel::zero_ctop, nzero_rank, MPI_SUM);
+        int nnan = Reductions::Check<int>(md, Reductions::Channel::nan_ctop);
+        int nzero = Reductions::Check<int>(md, Reductions::Channel::zero_ctop);
 
         if (MPIRank0() && (nzero > 0 || nnan > 0)) {
             // TODO string formatting in C++ that doesn't suck
@@ -39,6 +39,7 @@
 
 #include "floors.hpp"
 #include "flux_functions.hpp"
+#include "kharma_driver.hpp"
 #include "pack.hpp"
 #include "reconstruction.hpp"
 #include "types.hpp"
@@ -47,8 +48,6 @@ namespace Flux {
 
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
-TaskStatus CheckCtop(MeshData<Real> *md);
-
 TaskStatus PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md);
 
 TaskStatus MarkFOFC(MeshData<Real> *md);
@@ -65,15 +64,62 @@ TaskStatus FOFC(MeshData<Real> *md, MeshData<Real> *guess);
  * This is defined in Flux:: rather than GRMHD:: because the stress-energy tensor may contain
  * (E)GR(R)(M)HD terms.
  */
-void AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain);
+// With 'with_fused', also adds the sources of any packages marked fused_source, in the same kernel
+void AddGeoSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain, bool with_fused=false);
 // Version returning TaskStatus, for calling alone in FOFC "update"
 // TODO(BSP) switch KHARMAPackage (and Parthenon packages?) to expect all TaskStatus
 inline TaskStatus AddGeoSourceTask(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain)
 {
-    AddGeoSource(md, mdudt, domain);
+    AddGeoSource(md, mdudt, domain, false);
     return TaskStatus::complete;
 }
 
+/**
+ * Flux divergence and the geometric source (plus any fused_source package sources, as in AddGeoSource)
+ * in one pass, replacing KHARMADriver::FluxDivergence followed by Flux's AddSource.
+ * Saves a full read-modify-write of mdudt.  Enabled with <flux>fuse_divergence, see AddFluxDivergence
+ */
+TaskStatus FluxDivergenceSources(MeshData<Real> *md, MeshData<Real> *mdudt, DivergenceRegion region);
+
+/**
+ * The (nu, lam, mu) components of G.gdet_conn(j, i, nu, lam, mu) which are nonzero anywhere in a partition,
+ * packed as nu + 4*lam + 16*mu and sorted, i.e. grouped by mu.  In Kerr-Schild-based systems many are
+ * identically zero by symmetry (more than half in MKS/FMKS), so the source term need only contract these.
+ * With <flux>sparse_conn = false, lists every component.
+ */
+struct ConnPattern {
+    int n = 0;
+    int8_t idx[GR_DIM*GR_DIM*GR_DIM];
+};
+/**
+ * Get (or build) the pattern for md.  Cached against the partition's blocks like GeomFloorProfiles
+ */
+ConnPattern GetConnPattern(MeshData<Real> *md);
+
+/**
+ * Geometric source for the energy & momentum, new_du[lam] = T^mu_nu Gamma^nu_lam_mu * gdet,
+ * summing only the components in conn.  Skipped components are exactly zero, so the
+ * result is the same as the full contraction.
+ */
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void geo_source(const GRCoordinates& G, const Global& P, const VarMap& m_p, const FourVectors& D,
+                                       const EMHD::EMHD_parameters& emhd_params, const Real& gam, const ConnPattern& conn,
+                                       const int& k, const int& j, const int& i, Real new_du[GR_DIM])
+{
+    Real Tmu[GR_DIM] = {0};
+    int n = 0;
+    for (int mu = 0; mu < GR_DIM; ++mu) {
+        // Skip rows of the stress-energy tensor with no nonzero connection coefficients
+        if (n >= conn.n || conn.idx[n] / (GR_DIM*GR_DIM) != mu) continue;
+        calc_tensor(P, m_p, D, emhd_params, gam, k, j, i, mu, Tmu);
+        for (; n < conn.n && conn.idx[n] / (GR_DIM*GR_DIM) == mu; ++n) {
+            const int nu = conn.idx[n] % GR_DIM;
+            const int lam = (conn.idx[n] / GR_DIM) % GR_DIM;
+            new_du[lam] += Tmu[nu] * G.gdet_conn(j, i, nu, lam, mu);
+        }
+    }
+}
+
 /**
  * Likewise, the conversion P->U, even for just the GRMHD variables, requires (consists of)
  * the stress-energy tensor.
@@ -88,6 +134,12 @@ TaskStatus BlockPtoUMHD(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse
 TaskStatus BlockPtoU(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse=false);
 TaskStatus MeshPtoU(MeshData<Real> *md, IndexDomain domain, bool coarse=false);
 
+/**
+ * As MeshPtoU, but only recomputing U in zones flagged in pflag or fflag (failed inversions, floors hit).
+ * Elsewhere, U is already consistent with P up to the inversion tolerance, so a full pass is redundant.
+ */
+TaskStatus MeshPtoUFlagged(MeshData<Real> *md, IndexDomain domain);
+
 /**
  * As above, except that IndexDomains of ghost cells are taken to cover
  * cells *sent* (that is, part of the domain) rather than received
@@ -120,4 +172,87 @@ KOKKOS_INLINE_FUNCTION Real hlle(const Real& fluxL, const Real& fluxR, const Rea
     return (cmax*fluxL + cmin*fluxR - cmax*cmin*(Ur - Ul)) / (cmax + cmin);
 }
 
+/**
+ * Relativistic HLLC flux for unmagnetized fluids, Mignone & Bodo 2005 (MB05).
+ * Unlike the above this needs all variables at once, to find the speed and pressure of the contact.
+ * It is written for flat space (Cartesian Minkowski coordinates), where the conserved variables are
+ * D = rho u^0, m_i = T^0_i, and the total energy E = D - U_UU, with energy flux F_E = F_D - F_UU.
+ * Variables advected with the density (electron entropies) are treated like D, and any others with HLLE.
+ * 
+ * @param pL, pR fluid pressure on each side of the face
+ * @param flux output flux for all nvar variables
+ */
+KOKKOS_INLINE_FUNCTION void hllc(const Real fluxL[MAX_VARS], const Real fluxR[MAX_VARS],
+                                 const Real& cmax, const Real& cmin,
+                                 const Real Ul[MAX_VARS], const Real Ur[MAX_VARS],
+                                 const Real& pL, const Real& pR, const VarMap& m_u,
+                                 const int& dir, const int& nvar, Real flux[MAX_VARS])
+{
+    // Outermost wave speeds.  cmin is stored positive for leftward waves
+    const Real lL = -cmin, lR = cmax;
+    const int mx = m_u.U1 + dir - 1;
+
+    // Supersonic cases
+    if (lL >= 0.) {
+        for (int p = 0; p < nvar; ++p) flux[p] = fluxL[p];
+        return;
+    } else if (lR <= 0.) {
+        for (int p = 0; p < nvar; ++p) flux[p] = fluxR[p];
+        return;
+    }
+
+    // Total energy & its flux from each side
+    const Real EL  = Ul[m_u.RHO] - Ul[m_u.UU], ER  = Ur[m_u.RHO] - Ur[m_u.UU];
+    const Real FEL = fluxL[m_u.RHO] - fluxL[m_u.UU], FER = fluxR[m_u.RHO] - fluxR[m_u.UU];
+
+    // HLL state and flux for E and m_x, MB05 9 & 11
+    const Real idl = 1. / (lR - lL);
+    const Real E_hll  = (lR*ER - lL*EL + FEL - FER) * idl;
+    const Real m_hll  = (lR*Ur[mx] - lL*Ul[mx] + fluxL[mx] - fluxR[mx]) * idl;
+    const Real FE_hll = (lR*FEL - lL*FER + lR*lL*(ER - EL)) * idl;
+    const Real Fm_hll = (lR*fluxL[mx] - lL*fluxR[mx] + lR*lL*(Ur[mx] - Ul[mx])) * idl;
+
+    // Contact speed: smaller root of FE_hll l^2 - (E_hll + Fm_hll) l + m_hll = 0, MB05 18.
+    // Written so as to be finite when FE_hll -> 0
+    const Real b = E_hll + Fm_hll;
+    const Real lstar = 2. * m_hll / (b + m::sqrt(m::max(b*b - 4.*FE_hll*m_hll, 0.)));
+    // Contact pressure, MB05 17
+    const Real pstar = -FE_hll * lstar + Fm_hll;
+
+    // Star state on the side of the contact containing the face, MB05 16
+    const bool left = (lstar >= 0.);
+    const Real& l   = (left) ? lL : lR;
+    const Real* U   = (left) ? Ul : Ur;
+    const Real* F   = (left) ? fluxL : fluxR;
+    const Real& pr  = (left) ? pL : pR;
+    const Real& E   = (left) ? EL : ER;
+    const Real v    = F[m_u.RHO] / U[m_u.RHO];
+    const Real idls = 1. / (l - lstar);
+    const Real fac  = (l - v) * idls;
+
+    // Start from HLLE for any variables not covered below
+    for (int p = 0; p < nvar; ++p)
+        flux[p] = hlle(fluxL[p], fluxR[p], cmax, cmin, Ul[p], Ur[p]);
+
+    // F* = F + l (U* - U), MB05 14
+    const Real Dstar = U[m_u.RHO] * fac;
+    const Real Estar = (E * (l - v) + pstar * lstar - pr * v) * idls;
+    flux[m_u.RHO] = F[m_u.RHO] + l * (Dstar - U[m_u.RHO]);
+    flux[m_u.UU]  = F[m_u.UU] + l * ((Dstar - Estar) - U[m_u.UU]);
+    for (int v_i = 0; v_i < NVEC; ++v_i) {
+        const int mv = m_u.U1 + v_i;
+        const Real mstar = (mv == mx) ? (U[mv] * (l - v) + pstar - pr) * idls
+                                      : U[mv] * fac;
+        flux[mv] = F[mv] + l * (mstar - U[mv]);
+    }
+    // Passive scalars, which the VarMap groups as electron variables
+    if (m_u.KTOT >= 0) {
+        const int8_t evars[7] = {m_u.KTOT, m_u.K_CONSTANT, m_u.K_HOWES, m_u.K_KAWAZURA,
+                                 m_u.K_WERNER, m_u.K_ROWAN, m_u.K_SHARMA};
+        for (int n = 0; n < 7; ++n) {
+            if (evars[n] >= 0) flux[evars[n]] = F[evars[n]] + l * (U[evars[n]] * fac - U[evars[n]]);
+        }
+    }
+}
+
 }
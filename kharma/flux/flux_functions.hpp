@@ -49,13 +49,49 @@
 namespace Flux
 {
 
+/**
+ * Combinations of loaded packages for which the flux calculation is compiled separately.
+ * The VarMap still decides which variables are present at runtime, but branches for
+ * packages outside the set can be removed by the compiler.
+ * "general" makes no assumptions and is always correct.
+ * "mhd_fixed" is "mhd" with the layout VarMap::FixedMHD, so that kernels can use compile-time
+ * indices (see kernel_map).  It is only compiled with KHARMA_FIXED_VARMAP, see Flux::FixedLayout.
+ */
+enum class PackageSet{general=0, mhd, mhd_electrons, mhd_fixed};
+
+KOKKOS_FORCEINLINE_FUNCTION constexpr bool may_have_emhd(const PackageSet ps)
+{
+    return ps == PackageSet::general;
+}
+KOKKOS_FORCEINLINE_FUNCTION constexpr bool may_have_psi(const PackageSet ps)
+{
+    return ps == PackageSet::general;
+}
+KOKKOS_FORCEINLINE_FUNCTION constexpr bool may_have_electrons(const PackageSet ps)
+{
+    return ps == PackageSet::general || ps == PackageSet::mhd_electrons;
+}
+/**
+ * The VarMap a kernel compiled for PS should use: under mhd_fixed, a constant the compiler
+ * can propagate through every inlined function, otherwise just the pack's map m.
+ */
+template<PackageSet PS>
+KOKKOS_FORCEINLINE_FUNCTION VarMap kernel_map(const VarMap& m)
+{
+    if constexpr (PS == PackageSet::mhd_fixed) {
+        return VarMap::FixedMHD();
+    } else {
+        return m;
+    }
+}
+
 // TODO Q > 0 != emhd_enabled.  Store enablement in emhd_params since we need it anyway
-template<typename Local>
+template<PackageSet PS=PackageSet::general, typename Local>
 KOKKOS_FORCEINLINE_FUNCTION void calc_tensor(const Local& P, const VarMap& m_p, const FourVectors D,
                                         const EMHD::EMHD_parameters& emhd_params, const Real& gam, const int& dir,
                                         Real T[GR_DIM])
 {
-    if ((m_p.Q >= 0 || m_p.DP >= 0) && emhd_params.feedback) {
+    if (may_have_emhd(PS) && (m_p.Q >= 0 || m_p.DP >= 0) && emhd_params.feedback) {
         // Apply higher-order terms conversion if necessary
         Real qtilde = 0., dPtilde = 0.;
         if (m_p.Q >= 0)
@@ -113,7 +149,7 @@ KOKKOS_FORCEINLINE_FUNCTION void calc_tensor(const Global& P, const VarMap& m_p,
  * b. fluxes in a direction (dir!=0)
  * Keep in mind loc should usually correspond to dir for perpendicuar fluxes
  */
-template<typename Local>
+template<PackageSet PS=PackageSet::general, typename Local>
 KOKKOS_FORCEINLINE_FUNCTION void prim_to_flux(const GRCoordinates& G, const Local& P, const VarMap& m_p, const FourVectors D,
                                          const EMHD::EMHD_parameters& emhd_params, const Real& gam, const int& j, const int& i, const int& dir,
                                          const Local& flux, const VarMap& m_u, const Loci loc=Loci::center)
@@ -124,7 +160,7 @@ KOKKOS_FORCEINLINE_FUNCTION void prim_to_flux(const GRCoordinates& G, const Loca
 
     // Stress-energy tensor
     Real T[GR_DIM];
-    calc_tensor(P, m_p, D, emhd_params, gam, dir, T);
+    calc_tensor<PS>(P, m_p, D, emhd_params, gam, dir, T);
     flux(m_u.UU) = T[0] * gdet + flux(m_u.RHO);
     flux(m_u.U1) = T[1] * gdet;
     flux(m_u.U2) = T[2] * gdet;
@@ -141,7 +177,7 @@ KOKKOS_FORCEINLINE_FUNCTION void prim_to_flux(const GRCoordinates& G, const Loca
             VLOOP flux(m_u.B1 + v) = (D.bcon[v+1] * D.ucon[dir] - D.bcon[dir] * D.ucon[v+1]) * gdet;
         }
         // Extra scalar psi for constraint damping, see B_CD
-        if (m_u.PSI >= 0) {
+        if (may_have_psi(PS) && m_u.PSI >= 0) {
             if (dir == 0) {
                 flux(m_u.PSI) = P(m_p.PSI) * gdet;
             } else {
@@ -154,13 +190,15 @@ KOKKOS_FORCEINLINE_FUNCTION void prim_to_flux(const GRCoordinates& G, const Loca
     }
 
     // EMHD Variables: advect like rho
-    if (m_u.Q >= 0)
-        flux(m_u.Q) = P(m_p.Q) * D.ucon[dir] * gdet;
-    if (m_u.DP >= 0)
-        flux(m_u.DP) = P(m_p.DP) * D.ucon[dir] * gdet;
+    if (may_have_emhd(PS)) {
+        if (m_u.Q >= 0)
+            flux(m_u.Q) = P(m_p.Q) * D.ucon[dir] * gdet;
+        if (m_u.DP >= 0)
+            flux(m_u.DP) = P(m_p.DP) * D.ucon[dir] * gdet;
+    }
 
     // Electrons: normalized by density
-    if (m_u.KTOT >= 0) {
+    if (may_have_electrons(PS) && m_u.KTOT >= 0) {
         flux(m_u.KTOT) = flux(m_u.RHO) * P(m_p.KTOT);
         if (m_u.K_CONSTANT >= 0)
             flux(m_u.K_CONSTANT) = flux(m_u.RHO) * P(m_p.K_CONSTANT);
@@ -362,10 +400,43 @@ KOKKOS_FORCEINLINE_FUNCTION void p_to_u_mhd(const GRCoordinates& G, const Global
     prim_to_flux_mhd(G, P, m_p, Dtmp, emhd_params, gam, k, j, i, 0, U, m_u, loc);
 }
 
+/**
+ * Solve for the left- and right-going signal speeds in direction dir, given the
+ * fast magnetosonic speed squared cms2 in the fluid frame.
+ *
+ * This is the usual quadratic for the speed of a wave measured by an observer with
+ * 4-velocity ucon, with covectors A=e_dir and B=e_0.  Since both are unit covectors,
+ * the contractions reduce to single components of gcon and ucon, so we read those
+ * directly rather than raising A and B with a full 4x4 contraction each.
+ */
+KOKKOS_FORCEINLINE_FUNCTION void signal_speeds(const GRCoordinates& G, const Real ucon[GR_DIM],
+                                               const int& j, const int& i, const Loci& loc, const int& dir,
+                                               const Real& cms2, Real& cmax, Real& cmin)
+{
+    const Real Asq = G.gcon(loc, j, i, dir, dir);
+    const Real Bsq = G.gcon(loc, j, i, 0, 0);
+    const Real AB  = G.gcon(loc, j, i, 0, dir);
+    const Real Au  = ucon[dir];
+    const Real Bu  = ucon[0];
+
+    const Real A = Bu*Bu - (Bsq + Bu*Bu) * cms2;
+    const Real B = 2. * (Au*Bu - (AB + Au*Bu) * cms2);
+    const Real C = Au*Au - (Asq + Au*Au) * cms2;
+
+    const Real discr = m::sqrt(m::max(B * B - 4. * A * C, 0.));
+    const Real inv_2A = 0.5 / A;
+
+    const Real vp = (B - discr) * inv_2A;
+    const Real vm = (B + discr) * inv_2A;
+
+    cmax = m::max(vp, vm);
+    cmin = m::min(vp, vm);
+}
+
 /**
  * Calculate components of magnetosonic velocity from primitive variables
  */
-template<typename Local>
+template<PackageSet PS=PackageSet::general, typename Local>
 KOKKOS_FORCEINLINE_FUNCTION void vchar(const GRCoordinates& G, const Local& P, const VarMap& m, const FourVectors& D,
                                   const Real& gam, const EMHD::EMHD_parameters& emhd_params, 
                                   const int& k, const int& j, const int& i, const Loci& loc, const int& dir,
@@ -377,7 +448,7 @@ KOKKOS_FORCEINLINE_FUNCTION void vchar(const GRCoordinates& G, const Local& P, c
     // The fluid sound speed should be at most sqrt(gam-1) for a relativistic fluid
     clip(cs2, 0., gam - 1.);
     Real cms2;
-    if (m.Q >= 0 || m.DP >= 0) {
+    if (may_have_emhd(PS) && (m.Q >= 0 || m.DP >= 0)) {
          // Get the EGRMHD parameters
         Real tau, chi_e, nu_e;
         EMHD::set_parameters(G, P, m, emhd_params, gam, j, i, tau, chi_e, nu_e);
@@ -408,34 +479,7 @@ KOKKOS_FORCEINLINE_FUNCTION void vchar(const GRCoordinates& G, const Local& P, c
     // The signal speed should be at most the speed of light
     clip(cms2, 0., 1.); // TODO would love to record this...
 
-    // Require that speed of wave measured by observer q.ucon is cms2
-    Real A, B, C;
-    {
-        Real Bcov[GR_DIM] = {1., 0., 0., 0.};
-        Real Acov[GR_DIM] = {0}; Acov[dir] = 1.;
-
-        Real Acon[GR_DIM], Bcon[GR_DIM];
-        G.raise(Acov, Acon, k, j, i, loc);
-        G.raise(Bcov, Bcon, k, j, i, loc);
-
-        const Real Asq  = dot(Acon, Acov);
-        const Real Bsq  = dot(Bcon, Bcov);
-        const Real Au   = dot(Acov, D.ucon);
-        const Real Bu   = dot(Bcov, D.ucon);
-        const Real AB   = dot(Acon, Bcov);
-
-        A = Bu*Bu - (Bsq + Bu*Bu) * cms2;
-        B = 2. * (Au*Bu - (AB + Au*Bu) * cms2);
-        C = Au*Au - (Asq + Au*Au) * cms2;
-    }
-
-    Real discr = m::sqrt(m::max(B * B - 4. * A * C, 0.));
-
-    Real vp = -(-B + discr) / (2. * A);
-    Real vm = -(-B - discr) / (2. * A);
-
-    cmax = m::max(vp, vm);
-    cmin = m::min(vp, vm);
+    signal_speeds(G, D.ucon, j, i, loc, dir, cms2, cmax, cmin);
 }
 
 // This is expressly for updating cmin/max for FOFC zones
@@ -483,34 +527,7 @@ KOKKOS_FORCEINLINE_FUNCTION void vchar_global(const GRCoordinates& G, const Glob
     // The signal speed should be at most the speed of light
     clip(cms2, 0., 1.);
 
-    // Require that speed of wave measured by observer q.ucon is cms2
-    Real A, B, C;
-    {
-        Real Bcov[GR_DIM] = {1., 0., 0., 0.};
-        Real Acov[GR_DIM] = {0}; Acov[dir] = 1.;
-
-        Real Acon[GR_DIM], Bcon[GR_DIM];
-        G.raise(Acov, Acon, k, j, i, loc);
-        G.raise(Bcov, Bcon, k, j, i, loc);
-
-        const Real Asq  = dot(Acon, Acov);
-        const Real Bsq  = dot(Bcon, Bcov);
-        const Real Au   = dot(Acov, D.ucon);
-        const Real Bu   = dot(Bcov, D.ucon);
-        const Real AB   = dot(Acon, Bcov);
-
-        A = Bu*Bu - (Bsq + Bu*Bu) * cms2;
-        B = 2. * (Au*Bu - (AB + Au*Bu) * cms2);
-        C = Au*Au - (Asq + Au*Au) * cms2;
-    }
-
-    Real discr = m::sqrt(m::max(B * B - 4. * A * C, 0.));
-
-    Real vp = -(-B + discr) / (2. * A);
-    Real vm = -(-B - discr) / (2. * A);
-
-    cmax = m::max(vp, vm);
-    cmin = m::min(vp, vm);
+    signal_speeds(G, D.ucon, j, i, loc, dir, cms2, cmax, cmin);
 }
 
 } // namespace Flux
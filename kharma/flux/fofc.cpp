@@ -154,71 +154,125 @@ TaskStatus Flux::FOFC(MeshData<Real> *md, MeshData<Real> *guess)
     // Only fix faces if they exist
     const bool face_b = (Bf.GetDim(4) > 0 && pars.Get<bool>("fofc_consistent_face_b"));
 
+    const bool sparse = pars.Get<bool>("fofc_sparse");
+
     for (int dir=1; dir <= ndim; dir++) { // TODO if(trivial_direction) etc
         const TE el = FaceOf(dir);
         const Loci loc = loc_of(dir);
         const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior, el, -1, 1);
         const IndexRange block = IndexRange{0, P_all.GetDim(5) - 1};
-        pmb0->par_for("fofc_replacement", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
-            KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
-                const auto& G = P_all.GetCoords(b);
-
-                // Face i,j,k borders cell with same index and 1 left with index:
-                int kk = (dir == 3) ? k - 1 : k;
-                int jj = (dir == 2) ? j - 1 : j;
-                int ii = (dir == 1) ? i - 1 : i;
-                // If either bordering cell is marked, and always inside the EH
-                if (static_cast<int>(fofcflag(b, 0, k, j, i)) ||
-                    static_cast<int>(fofcflag(b, 0, kk, jj, ii))) { // TODO allow customizing
-
-                    // "Reconstruct" left & right of this face: left is left cell, right is shared-index
-                    PLOOP Pl_all(b, ip, k, j, i) = P_all(b, ip, kk, jj, ii);
-                    PLOOP Pr_all(b, ip, k, j, i) = P_all(b, ip, k, j, i);
-                    // Preserve the existing field at the face
-                    if (face_b) {
-                        Pl_all(b, m_p.B1+dir-1, k, j, i) = Bf(b, el, 0, k, j, i) / G.gdet(loc, j, i);
-                        Pr_all(b, m_p.B1+dir-1, k, j, i) = Bf(b, el, 0, k, j, i) / G.gdet(loc, j, i);
-                    }
 
-                    FourVectors Dtmp;
-                    // Left
-                    GRMHD::calc_4vecs(G, Pl_all(b), m_p, k, j, i, loc, Dtmp);
-                    Flux::prim_to_flux(G, Pl_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, 0, Ul_all(b), m_u, loc);
-                    Flux::prim_to_flux(G, Pl_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, dir, Fl_all(b), m_u, loc);
-                    // Magnetosonic speeds
-                    Real cmaxL, cminL;
-                    Flux::vchar_global(G, Pl_all(b), m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxL, cminL);
-                    // Record speeds
-                    cmax(b, dir-1, k, j, i) = m::max(0., cmaxL);
-                    cmin(b, dir-1, k, j, i) = m::min(0., cminL);
-
-                    // Right
-                    GRMHD::calc_4vecs(G, Pr_all(b), m_p, k, j, i, loc, Dtmp);
-                    Flux::prim_to_flux(G, Pr_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, 0, Ur_all(b), m_u, loc);
-                    Flux::prim_to_flux(G, Pr_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, dir, Fr_all(b), m_u, loc);
-                    // Magnetosonic speeds
-                    Real cmaxR, cminR;
-                    Flux::vchar_global(G, Pr_all(b), m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxR, cminR);
-                    // Calculate cmax/min based on comparison with cached values
-                    if (!use_global) {
-                        cmax(b, dir-1, k, j, i) =  m::max(cmax(b, dir-1, k, j, i), cmaxR);
-                        cmin(b, dir-1, k, j, i) = -m::min(cmin(b, dir-1, k, j, i), cminR);
-                    } else {
-                        // This conveniently also reduces the timestep if necessary
-                        // Though, you should almost certainly set use_dt_light w/this
-                        cmax(b, dir-1, k, j, i) = 1.;
-                        cmin(b, dir-1, k, j, i) = 1.;
+        // Replace the flux through a single face
+        const auto fofc_face = KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+            const auto& G = P_all.GetCoords(b);
+
+            // Face i,j,k borders cell with same index and 1 left with index:
+            int kk = (dir == 3) ? k - 1 : k;
+            int jj = (dir == 2) ? j - 1 : j;
+            int ii = (dir == 1) ? i - 1 : i;
+
+            // "Reconstruct" left & right of this face: left is left cell, right is shared-index
+            PLOOP Pl_all(b, ip, k, j, i) = P_all(b, ip, kk, jj, ii);
+            PLOOP Pr_all(b, ip, k, j, i) = P_all(b, ip, k, j, i);
+            // Preserve the existing field at the face
+            if (face_b) {
+                Pl_all(b, m_p.B1+dir-1, k, j, i) = Bf(b, el, 0, k, j, i) / G.gdet(loc, j, i);
+                Pr_all(b, m_p.B1+dir-1, k, j, i) = Bf(b, el, 0, k, j, i) / G.gdet(loc, j, i);
+            }
+
+            FourVectors Dtmp;
+            // Left
+            GRMHD::calc_4vecs(G, Pl_all(b), m_p, k, j, i, loc, Dtmp);
+            Flux::prim_to_flux(G, Pl_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, 0, Ul_all(b), m_u, loc);
+            Flux::prim_to_flux(G, Pl_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, dir, Fl_all(b), m_u, loc);
+            // Magnetosonic speeds
+            Real cmaxL, cminL;
+            Flux::vchar_global(G, Pl_all(b), m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxL, cminL);
+            // Record speeds
+            cmax(b, dir-1, k, j, i) = m::max(0., cmaxL);
+            cmin(b, dir-1, k, j, i) = m::min(0., cminL);
+
+            // Right
+            GRMHD::calc_4vecs(G, Pr_all(b), m_p, k, j, i, loc, Dtmp);
+            Flux::prim_to_flux(G, Pr_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, 0, Ur_all(b), m_u, loc);
+            Flux::prim_to_flux(G, Pr_all(b), m_p, Dtmp, emhd_params, gam, k, j, i, dir, Fr_all(b), m_u, loc);
+            // Magnetosonic speeds
+            Real cmaxR, cminR;
+            Flux::vchar_global(G, Pr_all(b), m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxR, cminR);
+            // Calculate cmax/min based on comparison with cached values
+            if (!use_global) {
+                cmax(b, dir-1, k, j, i) =  m::max(cmax(b, dir-1, k, j, i), cmaxR);
+                cmin(b, dir-1, k, j, i) = -m::min(cmin(b, dir-1, k, j, i), cminR);
+            } else {
+                // This conveniently also reduces the timestep if necessary
+                // Though, you should almost certainly set use_dt_light w/this
+                cmax(b, dir-1, k, j, i) = 1.;
+                cmin(b, dir-1, k, j, i) = 1.;
+            }
+
+            // Use LLF flux. Note we replace fluxes of all variables (including B!)
+            // This is for a consistent scheme, i.e. all cells FOFC == using DC+LLF
+            PLOOP
+                U_all(b).flux(dir, ip, k, j, i) = llf(Fl_all(b, ip, k, j, i), Fr_all(b, ip, k, j, i),
+                                                    cmax(b, dir-1, k, j, i), cmin(b, dir-1, k, j, i),
+                                                    Ul_all(b, ip, k, j, i), Ur_all(b, ip, k, j, i));
+        };
+
+        if (sparse) {
+            // Compact the list of faces bordering marked cells, then only launch over those.
+            // Usually very few zones are marked, so this saves divergent work over the whole mesh
+            const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+            const int nfaces = (block.e + 1) * nk * nj * ni;
+            auto *face_list_p = GetPartitionParam<ParArray1D<int>>(md, "Flux", "fofc_face_list");
+            if (face_list_p->extent_int(0) == 0) *face_list_p = ParArray1D<int>("fofc_face_list", 1024);
+            int nlist = 0;
+            bool fits = false;
+            while (!fits) {
+                const auto face_list = *face_list_p;
+                const int capacity = face_list.extent_int(0);
+                Kokkos::parallel_scan("fofc_compact", Kokkos::RangePolicy<>(DevExecSpace(), 0, nfaces),
+                    KOKKOS_LAMBDA (const int &n, int &idx, const bool &final) {
+                        const int i = b.is + n % ni;
+                        const int j = b.js + (n / ni) % nj;
+                        const int k = b.ks + (n / (ni*nj)) % nk;
+                        const int bl = n / (ni*nj*nk);
+                        const int kk = (dir == 3) ? k - 1 : k;
+                        const int jj = (dir == 2) ? j - 1 : j;
+                        const int ii = (dir == 1) ? i - 1 : i;
+                        if (static_cast<int>(fofcflag(bl, 0, k, j, i)) ||
+                            static_cast<int>(fofcflag(bl, 0, kk, jj, ii))) {
+                            if (final && idx < capacity) face_list(idx) = n;
+                            ++idx;
+                        }
                     }
+                , nlist);
+                // If the list overflowed, grow it and compact again
+                fits = (nlist <= capacity);
+                if (!fits) Kokkos::resize(*face_list_p, 2 * nlist);
+            }
 
-                    // Use LLF flux. Note we replace fluxes of all variables (including B!)
-                    // This is for a consistent scheme, i.e. all cells FOFC == using DC+LLF
-                    PLOOP
-                        U_all(b).flux(dir, ip, k, j, i) = llf(Fl_all(b, ip, k, j, i), Fr_all(b, ip, k, j, i),
-                                                            cmax(b, dir-1, k, j, i), cmin(b, dir-1, k, j, i),
-                                                            Ul_all(b, ip, k, j, i), Ur_all(b, ip, k, j, i));
+            const auto face_list = *face_list_p;
+            pmb0->par_for("fofc_replacement_sparse", 0, nlist - 1,
+                KOKKOS_LAMBDA (const int &m) {
+                    const int n = face_list(m);
+                    fofc_face(n / (ni*nj*nk), b.ks + (n / (ni*nj)) % nk, b.js + (n / ni) % nj, b.is + n % ni);
                 }
-            }
-        );
+            );
+        } else {
+            pmb0->par_for("fofc_replacement", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+                KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i) {
+                    // Face i,j,k borders cell with same index and 1 left with index:
+                    int kk = (dir == 3) ? k - 1 : k;
+                    int jj = (dir == 2) ? j - 1 : j;
+                    int ii = (dir == 1) ? i - 1 : i;
+                    // If either bordering cell is marked, and always inside the EH
+                    if (static_cast<int>(fofcflag(b, 0, k, j, i)) ||
+                        static_cast<int>(fofcflag(b, 0, kk, jj, ii))) { // TODO allow customizing
+                        fofc_face(b, k, j, i);
+                    }
+                }
+            );
+        }
     }
 
     return TaskStatus::complete;
@@ -36,10 +36,484 @@
 #include "flux.hpp"
 
 #include "domain.hpp"
+#include "fault.hpp"
 #include "floors_functions.hpp"
+#include "scratch_tuner.hpp"
+
+#include <chrono>
 
 namespace Flux {
 
+// Names for the packs taken in every flux calculation, so they need not be rebuilt on each call
+static const std::vector<std::string> names_bf{"cons.fB"};
+static const std::vector<std::string> names_cmax{"Flux.cmax"}, names_cmin{"Flux.cmin"};
+static const std::vector<std::string> names_pl{"Flux.Pl"}, names_pr{"Flux.Pr"};
+static const std::vector<std::string> names_ul{"Flux.Ul"}, names_ur{"Flux.Ur"};
+static const std::vector<std::string> names_fl{"Flux.Fl"}, names_fr{"Flux.Fr"};
+
+/**
+ * Per-block cache of the minimum dx/ctop in each direction, filled as a by-product of the
+ * flux calculation so that GRMHD::EstimateTimestep need not sweep Flux.cmax/cmin again.
+ * Indexed by block local ID and direction.  Enable with <flux> cache_timestep = true.
+ *
+ * With <debug>extra_checks, the same pass also counts NaN and zero signal speeds per block,
+ * accumulated over the step's stages and checked in Flux::PostStepDiagnostics.
+ * Indexed by block local ID, then 0 for NaN, 1 for zero.
+ * Either also raises the Fault sentinel of the block, if loaded.
+ */
+struct TimestepCache {
+    ParArray2D<Real> ndt;
+    ParArray2D<int> bad_ctop;
+    Fault::Sentinels faults;
+    int lid0 = 0;
+    bool enabled = false;
+    bool check_ctop = false;
+    // Whether RecordRowTimestep has anything to do
+    bool active = false;
+};
+
+/**
+ * Get the cache for the blocks in md, growing it if the mesh has gained blocks, and reset the
+ * entries for the directions we are about to calculate
+ */
+inline TimestepCache GetTimestepCache(MeshData<Real> *md, const int& dir_s, const int& dir_e)
+{
+    TimestepCache c;
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0  = md->GetBlockData(0)->GetBlockPointer();
+    auto& pars = pmb0->packages.Get("Flux")->AllParams();
+    c.enabled = pars.Get<bool>("cache_timestep");
+    c.check_ctop = pmb0->packages.Get("Globals")->Param<int>("extra_checks") > 0;
+    c.faults = Fault::GetSentinels(md);
+    c.active = c.enabled || c.check_ctop || c.faults.enabled;
+    if (!c.enabled && !c.check_ctop) return c;
+
+    const int nblocks_rank = pmesh->block_list.size();
+    if (c.enabled) {
+        auto *ndt = pars.GetMutable<ParArray2D<Real>>("ndt_cache");
+        if (ndt->extent_int(0) < nblocks_rank) {
+            Kokkos::resize(*ndt, nblocks_rank, 3);
+            Kokkos::deep_copy(*ndt, std::numeric_limits<Real>::max());
+        }
+        c.ndt = *ndt;
+    }
+    if (c.check_ctop) {
+        // Counts are zeroed when read, so only a resize (after remeshing, before any counting) resets them here
+        auto *bad = pars.GetMutable<ParArray2D<int>>("bad_ctop");
+        if (bad->extent_int(0) < nblocks_rank) {
+            Kokkos::resize(*bad, nblocks_rank, 2);
+            Kokkos::deep_copy(*bad, 0);
+        }
+        c.bad_ctop = *bad;
+    }
+
+    // Blocks in a MeshData partition are contiguous in the rank's block list
+    const int nblocks = md->NumBlocks();
+    c.lid0 = pmb0->lid;
+    if (md->GetBlockData(nblocks - 1)->GetBlockPointer()->lid != c.lid0 + nblocks - 1)
+        throw std::runtime_error("Timestep cache requires contiguous mesh partitions!");
+
+    if (!c.enabled) return c;
+    const auto ndt_v = c.ndt;
+    const int lid0 = c.lid0;
+    pmb0->par_for("reset_ndt_cache", 0, nblocks - 1, dir_s - 1, dir_e - 1,
+        KOKKOS_LAMBDA(const int& bl, const int& d) {
+            ndt_v(lid0 + bl, d) = std::numeric_limits<Real>::max();
+        }
+    );
+    return c;
+}
+
+/**
+ * Call launch(scratch_level) at the level chosen for the kernel by the Flux param 'tuner'
+ * (see ScratchTuner), timing it while the level is still being tuned
+ */
+template<typename Function>
+inline void LaunchTuned(MeshData<Real> *md, const char *tuner, const int& nvar, const size_t& scratch_bytes,
+                        const Function& launch)
+{
+    auto& t = *(md->GetBlockData(0)->GetBlockPointer()->packages.Get("Flux")->AllParams()
+                    .GetMutable<ScratchTuner::Tuner>(tuner));
+    const IndexRange3 be = KDomain::GetRange(md, IndexDomain::entire);
+    const ScratchTuner::Key key{be.ie - be.is + 1, be.je - be.js + 1, be.ke - be.ks + 1, nvar};
+    int level;
+    if (!ScratchTuner::Level(t, key, scratch_bytes, level)) {
+        launch(level);
+        return;
+    }
+    Kokkos::fence();
+    const auto start = std::chrono::steady_clock::now();
+    launch(level);
+    Kokkos::fence();
+    ScratchTuner::Record(t, key, level, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+/**
+ * Reduce dx/ctop over the interior zones of one row, which must already have its final
+ * signal speeds, and record the minimum for the block.
+ * Like EstimateTimestep, this uses the speeds on each zone's left face.
+ * If checking, also count the row's NaN and zero ctop, once per zone and direction, and/or raise the
+ * block's fault sentinel if there are any.
+ * @param bc Interior zone (not face) range
+ */
+template <int dir, typename Coords, typename VPack>
+KOKKOS_INLINE_FUNCTION void RecordRowTimestep(parthenon::team_mbr_t& member, const Coords& G,
+                                              const VPack& cmax, const VPack& cmin,
+                                              const int& bl, const int& k, const int& j,
+                                              const IndexRange3& bc, const TimestepCache& c)
+{
+    if (!KDomain::inside(k, j, bc.is, bc)) return;
+    if (c.enabled) {
+        Real row_min;
+        parthenon::par_reduce_inner(member, bc.is, bc.ie,
+            [&](const int& i, Real& local_result) {
+                const Real dx = (dir == X1DIR) ? G.template Dxc<1>(i) :
+                               ((dir == X2DIR) ? G.template Dxc<2>(j) : G.template Dxc<3>(k));
+                const Real ndt_zone = dx / m::max(cmax(bl, dir-1, k, j, i), cmin(bl, dir-1, k, j, i));
+                if (!m::isnan(ndt_zone) && (ndt_zone < local_result)) {
+                    local_result = ndt_zone;
+                }
+            }
+        , Kokkos::Min<Real>(row_min));
+        Kokkos::single(Kokkos::PerTeam(member), [&]() {
+            Kokkos::atomic_min(&c.ndt(c.lid0 + bl, dir-1), row_min);
+        });
+    }
+    if (c.check_ctop || c.faults.enabled) {
+        int row_nan, row_zero;
+        parthenon::par_reduce_inner(member, bc.is, bc.ie,
+            [&](const int& i, int& local_result) {
+                local_result += m::isnan(m::max(cmax(bl, dir-1, k, j, i), cmin(bl, dir-1, k, j, i)));
+            }
+        , Kokkos::Sum<int>(row_nan));
+        parthenon::par_reduce_inner(member, bc.is, bc.ie,
+            [&](const int& i, int& local_result) {
+                local_result += (m::max(cmax(bl, dir-1, k, j, i), cmin(bl, dir-1, k, j, i)) <= 0.);
+            }
+        , Kokkos::Sum<int>(row_zero));
+        Kokkos::single(Kokkos::PerTeam(member), [&]() {
+            if (c.check_ctop && row_nan > 0) Kokkos::atomic_add(&c.bad_ctop(c.lid0 + bl, 0), row_nan);
+            if (c.check_ctop && row_zero > 0) Kokkos::atomic_add(&c.bad_ctop(c.lid0 + bl, 1), row_zero);
+            if (c.faults.enabled && row_nan + row_zero > 0) Fault::Mark(c.faults, bl, Fault::Sentinel::bad_ctop);
+        });
+    }
+}
+
+/**
+ * Everything the fused flux calculation needs on device, collected so that the same
+ * row function can serve one direction (GetFluxFused) or all of them (GetFluxFusedAllDirections)
+ */
+template<typename PPack, typename UPack, typename VPack>
+struct FusedFluxData {
+    PPack P_all;
+    UPack U_all;
+    VPack Bf, cmax, cmin;
+    VarMap m_p, m_u;
+    Floors::Prescription floors, floors_inner;
+    EMHD::EMHD_parameters emhd_params;
+    Real gam;
+    bool use_hlle, use_hllc, reconstruction_floors, reconstruction_fallback, replace_face_b;
+    int nvar, nprim, n1;
+    TimestepCache dt_cache;
+    IndexRange3 bc;
+    int scratch_level = 1;
+};
+
+/**
+ * Compute the final fluxes through the faces along one row (k, j) of a block in direction dir,
+ * keeping all reconstructed/intermediate values in team scratch
+ * @param b Range of faces to compute, including one extra zone on each side for flux-CT
+ * @param bi Range of faces in the interior, where the face B field may replace reconstructed values
+ */
+template <KReconstruction::Type Recon, int dir, PackageSet PS, typename Data>
+KOKKOS_INLINE_FUNCTION void FusedFluxRow(parthenon::team_mbr_t& member, const int& bl, const int& k, const int& j,
+                                         const IndexRange3& b, const IndexRange3& bi, const Data& d)
+{
+    using RType = KReconstruction::Type;
+    const int scratch_level = d.scratch_level;
+    const Loci loc = loc_of(dir);
+    // FaceOf is host-only
+    constexpr TopologicalElement face = (dir == X1DIR) ? F1 : ((dir == X2DIR) ? F2 : F3);
+    const int& nvar = d.nvar;
+    const int& n1 = d.n1;
+    const VarMap m_p = kernel_map<PS>(d.m_p);
+    const VarMap m_u = kernel_map<PS>(d.m_u);
+    const auto& G = d.U_all.GetCoords(bl);
+
+    ScratchPad2D<Real> Pl_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Pr_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Plf_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Prf_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad1D<int> fallback_tvd(member.team_scratch(scratch_level), n1);
+
+    KReconstruction::ReconstructRow<Recon, dir>(member, d.P_all(bl), k, j, b.is, b.ie, Pl_s, Pr_s);
+    member.team_barrier();
+
+    if (d.reconstruction_floors || d.reconstruction_fallback) {
+        parthenon::par_for_inner(member, b.is, b.ie,
+            [&](const int& i) {
+                auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
+                auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
+                fallback_tvd(i)  = Floors::apply_geo_floors(G, Pl, m_p, d.gam, j, i, d.floors, d.floors_inner, loc);
+                fallback_tvd(i) |= Floors::apply_geo_floors(G, Pr, m_p, d.gam, j, i, d.floors, d.floors_inner, loc);
+            }
+        );
+        member.team_barrier();
+    }
+
+    if (d.reconstruction_fallback) {
+        KReconstruction::ReconstructRow<RType::ppm, dir>(member, d.P_all(bl), k, j, b.is, b.ie, Plf_s, Prf_s);
+        member.team_barrier();
+        for (int p = 0; p < d.nprim; ++p) {
+            parthenon::par_for_inner(member, b.is, b.ie,
+                [&](const int& i) {
+                    if (fallback_tvd(i)) {
+                        Pl_s(p, i) = Plf_s(p, i);
+                        Pr_s(p, i) = Prf_s(p, i);
+                    }
+                }
+            );
+        }
+        member.team_barrier();
+    }
+
+    // Allocated after any reconstruction temporaries, so as not to overlap them
+    ScratchPad2D<Real> Ul_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Ur_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Fl_s(member.team_scratch(scratch_level), nvar, n1);
+    ScratchPad2D<Real> Fr_s(member.team_scratch(scratch_level), nvar, n1);
+
+    parthenon::par_for_inner(member, b.is, b.ie,
+        [&](const int& i) {
+            auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
+            auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
+            auto Ul = Kokkos::subview(Ul_s, Kokkos::ALL(), i);
+            auto Ur = Kokkos::subview(Ur_s, Kokkos::ALL(), i);
+            auto Fl = Kokkos::subview(Fl_s, Kokkos::ALL(), i);
+            auto Fr = Kokkos::subview(Fr_s, Kokkos::ALL(), i);
+
+            if (d.replace_face_b && KDomain::inside(k, j, i, bi)) {
+                const Real bf = d.Bf(bl, face, 0, k, j, i) / G.gdet(loc, j, i);
+                Pl(m_p.B1+dir-1) = bf;
+                Pr(m_p.B1+dir-1) = bf;
+            }
+
+            FourVectors Dtmp;
+            Real cmaxL, cminL, cmaxR, cminR;
+
+            GRMHD::calc_4vecs(G, Pl, m_p, j, i, loc, Dtmp);
+            Flux::prim_to_flux<PS>(G, Pl, m_p, Dtmp, d.emhd_params, d.gam, j, i, 0, Ul, m_u, loc);
+            Flux::prim_to_flux<PS>(G, Pl, m_p, Dtmp, d.emhd_params, d.gam, j, i, dir, Fl, m_u, loc);
+            Flux::vchar<PS>(G, Pl, m_p, Dtmp, d.gam, d.emhd_params, k, j, i, loc, dir, cmaxL, cminL);
+
+            GRMHD::calc_4vecs(G, Pr, m_p, j, i, loc, Dtmp);
+            Flux::prim_to_flux<PS>(G, Pr, m_p, Dtmp, d.emhd_params, d.gam, j, i, 0, Ur, m_u, loc);
+            Flux::prim_to_flux<PS>(G, Pr, m_p, Dtmp, d.emhd_params, d.gam, j, i, dir, Fr, m_u, loc);
+            Flux::vchar<PS>(G, Pr, m_p, Dtmp, d.gam, d.emhd_params, k, j, i, loc, dir, cmaxR, cminR);
+
+            // Same convention as GetFlux: cmin is stored as a positive number
+            d.cmax(bl, dir-1, k, j, i) =  m::max(m::max(0., cmaxL), cmaxR);
+            d.cmin(bl, dir-1, k, j, i) = -m::min(m::min(0., cminL), cminR);
+        }
+    );
+    member.team_barrier();
+
+    if (d.dt_cache.active)
+        RecordRowTimestep<dir>(member, G, d.cmax, d.cmin, bl, k, j, d.bc, d.dt_cache);
+
+    if (d.use_hllc) {
+        parthenon::par_for_inner(member, b.is, b.ie,
+            [&](const int& i) {
+                Real fl[MAX_VARS], fr[MAX_VARS], ul[MAX_VARS], ur[MAX_VARS], f[MAX_VARS];
+                for (int p = 0; p < nvar; ++p) {
+                    fl[p] = Fl_s(p, i); fr[p] = Fr_s(p, i);
+                    ul[p] = Ul_s(p, i); ur[p] = Ur_s(p, i);
+                }
+                hllc(fl, fr, d.cmax(bl, dir-1, k, j, i), d.cmin(bl, dir-1, k, j, i), ul, ur,
+                     (d.gam - 1) * Pl_s(m_p.UU, i), (d.gam - 1) * Pr_s(m_p.UU, i), m_u, dir, nvar, f);
+                for (int p = 0; p < nvar; ++p)
+                    d.U_all(bl).flux(dir, p, k, j, i) = f[p];
+            }
+        );
+        return;
+    }
+
+    for (int p=0; p < nvar; ++p) {
+        parthenon::par_for_inner(member, b.is, b.ie,
+            [&](const int& i) {
+                const Real& cmax = d.cmax(bl, dir-1, k, j, i);
+                const Real& cmin = d.cmin(bl, dir-1, k, j, i);
+                d.U_all(bl).flux(dir, p, k, j, i) = (d.use_hlle)
+                    ? hlle(Fl_s(p, i), Fr_s(p, i), cmax, cmin, Ul_s(p, i), Ur_s(p, i))
+                    : llf(Fl_s(p, i), Fr_s(p, i), cmax, cmin, Ul_s(p, i), Ur_s(p, i));
+            }
+        );
+    }
+}
+
+/**
+ * Gather the options and packs used by the fused flux calculation
+ */
+template <PackageSet PS>
+inline auto GetFusedFluxData(MeshData<Real> *md)
+{
+    auto pmb0  = md->GetBlockData(0)->GetBlockPointer();
+    auto& packages = pmb0->packages;
+    const auto& pars = packages.Get("Flux")->AllParams();
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P_all = md->PackVariables(PackFlags::PrimitiveCell(), prims_map);
+    const auto& U_all = md->PackVariablesAndFluxes(PackFlags::ConservedCell(), cons_map);
+    // (this pack is empty, and unused, without B_CT)
+    const auto& Bf    = md->PackVariables(names_bf);
+    const auto& cmax  = md->PackVariables(names_cmax);
+    const auto& cmin  = md->PackVariables(names_cmin);
+
+    FusedFluxData<std::decay_t<decltype(P_all)>, std::decay_t<decltype(U_all)>, std::decay_t<decltype(cmax)>> d;
+    d.P_all = P_all; d.U_all = U_all;
+    d.Bf = Bf; d.cmax = cmax; d.cmin = cmin;
+    d.m_p = VarMap(prims_map, false);
+    d.m_u = VarMap(cons_map, true);
+
+    d.reconstruction_floors = pars.Get<bool>("reconstruction_floors");
+    if (d.reconstruction_floors) {
+        d.floors       = packages.Get("Floors")->Param<Floors::Prescription>("prescription");
+        d.floors_inner = packages.Get("Floors")->Param<Floors::Prescription>("prescription_inner");
+    }
+    d.reconstruction_fallback = pars.Get<bool>("reconstruction_fallback");
+    d.replace_face_b = packages.AllPackages().count("B_CT") && pars.Get<bool>("consistent_face_b");
+    d.use_hlle = pars.Get<bool>("use_hlle");
+    d.use_hllc = pars.Get<bool>("use_hllc");
+    d.gam = packages.Get("GRMHD")->Param<Real>("gamma");
+    d.emhd_params = EMHD::GetEMHDParameters(packages);
+
+    d.nvar  = U_all.GetDim(4);
+    d.nprim = P_all.GetDim(4);
+    d.n1    = pmb0->cellbounds.ncellsi(IndexDomain::entire);
+    d.bc    = KDomain::GetRange(md, IndexDomain::interior);
+    return d;
+}
+
+/**
+ * Team scratch needed by FusedFluxRow: left/right prims, fallback prims,
+ * reconstruction temporaries, then left/right conserved variables and fluxes
+ */
+template <KReconstruction::Type Recon>
+inline size_t FusedFluxScratchBytes(const int& nvar, const int& n1)
+{
+    using RType = KReconstruction::Type;
+    const size_t var_size_in_bytes = parthenon::ScratchPad2D<Real>::shmem_size(nvar, n1);
+    const size_t line_size_in_bytes = parthenon::ScratchPad1D<int>::shmem_size(n1);
+    return (8 + 1*(Recon == RType::donor_cell) + 5*(Recon == RType::linear_vl) +
+                1*(Recon == RType::weno5_cached)) * var_size_in_bytes +
+           line_size_in_bytes;
+}
+
+/**
+ * @brief Fused version of GetFlux below, which keeps the reconstructed left/right states, conserved
+ * variables and fluxes in team scratch and writes only the final face fluxes and signal speeds.
+ *
+ * This avoids the six full-mesh temporaries Flux.Pl/Pr/Ul/Ur/Fl/Fr, at the cost of more scratch
+ * per team.  It cannot be used with anything that later reads those temporaries, i.e. FOFC or
+ * excised polar fluxes; this is checked in Flux::Initialize and KBoundaries::Initialize.
+ * Enable with <flux> fused = true.
+ */
+template <KReconstruction::Type Recon, int dir, PackageSet PS>
+inline TaskStatus GetFluxFused(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0  = md->GetBlockData(0)->GetBlockPointer();
+    // Exit on trivial operations
+    const int ndim = pmesh->ndim;
+    if (ndim < 3 && dir == X3DIR) return TaskStatus::complete;
+    if (ndim < 2 && dir == X2DIR) return TaskStatus::complete;
+
+    Flag("GetFluxFused_"+std::to_string(dir));
+
+    auto d = GetFusedFluxData<PS>(md);
+    d.dt_cache = GetTimestepCache(md, dir, dir);
+
+    // Get the domain size, including the extra zone on each side needed by flux-CT,
+    // and any halo for a temporally blocked step
+    const int h = pmb0->packages.Get("Flux")->Param<int>("stage_halo");
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior, FaceOf(dir), -1 - h, 1 + h);
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior, FaceOf(dir));
+    const IndexRange block = IndexRange{0, d.cmax.GetDim(5) - 1};
+
+    const size_t scratch_bytes = FusedFluxScratchBytes<Recon>(d.nvar, d.n1);
+
+    LaunchTuned(md, "tuner_fused", d.nvar, scratch_bytes, [&](const int scratch_level) {
+        d.scratch_level = scratch_level;
+        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_fused", pmb0->exec_space,
+            scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
+            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
+                FusedFluxRow<Recon, dir, PS>(member, bl, k, j, b, bi, d);
+            }
+        );
+    });
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
+/**
+ * @brief As GetFluxFused, but calculate fluxes in all directions in a single kernel launch,
+ * which saves launch overhead for small blocks.
+ * Each team still handles a single row in a single direction: the direction is folded into
+ * the block index, and rows outside the face range of a direction are skipped.
+ * Enable with <flux> fused_directions = true.
+ */
+template <KReconstruction::Type Recon, PackageSet PS>
+inline TaskStatus GetFluxFusedAllDirections(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0  = md->GetBlockData(0)->GetBlockPointer();
+    const int ndim = pmesh->ndim;
+
+    Flag("GetFluxFusedAllDirections");
+
+    auto d = GetFusedFluxData<PS>(md);
+    d.dt_cache = GetTimestepCache(md, X1DIR, ndim);
+
+    const int h = pmb0->packages.Get("Flux")->Param<int>("stage_halo");
+    const IndexRange3 b1 = KDomain::GetRange(md, IndexDomain::interior, F1, -1 - h, 1 + h);
+    const IndexRange3 b2 = KDomain::GetRange(md, IndexDomain::interior, F2, -1 - h, 1 + h);
+    const IndexRange3 b3 = KDomain::GetRange(md, IndexDomain::interior, F3, -1 - h, 1 + h);
+    const IndexRange3 bi1 = KDomain::GetRange(md, IndexDomain::interior, F1);
+    const IndexRange3 bi2 = KDomain::GetRange(md, IndexDomain::interior, F2);
+    const IndexRange3 bi3 = KDomain::GetRange(md, IndexDomain::interior, F3);
+    // Union of the row ranges in each direction
+    const IndexRange kb = IndexRange{m::min(b1.ks, m::min(b2.ks, b3.ks)), m::max(b1.ke, m::max(b2.ke, b3.ke))};
+    const IndexRange jb = IndexRange{m::min(b1.js, m::min(b2.js, b3.js)), m::max(b1.je, m::max(b2.je, b3.je))};
+    const int nblocks = d.cmax.GetDim(5);
+
+    const size_t scratch_bytes = FusedFluxScratchBytes<Recon>(d.nvar, d.n1);
+
+    LaunchTuned(md, "tuner_fused_all", d.nvar, scratch_bytes, [&](const int scratch_level) {
+        d.scratch_level = scratch_level;
+        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_fused_all", pmb0->exec_space,
+            scratch_bytes, scratch_level, 0, ndim*nblocks - 1, kb.s, kb.e, jb.s, jb.e,
+            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& dbl, const int& k, const int& j) {
+                const int bl = dbl % nblocks;
+                const int dir = dbl / nblocks + 1;
+                if (dir == X1DIR) {
+                    if (k >= b1.ks && k <= b1.ke && j >= b1.js && j <= b1.je)
+                        FusedFluxRow<Recon, X1DIR, PS>(member, bl, k, j, b1, bi1, d);
+                } else if (dir == X2DIR) {
+                    if (k >= b2.ks && k <= b2.ke && j >= b2.js && j <= b2.je)
+                        FusedFluxRow<Recon, X2DIR, PS>(member, bl, k, j, b2, bi2, d);
+                } else {
+                    if (k >= b3.ks && k <= b3.ke && j >= b3.js && j <= b3.je)
+                        FusedFluxRow<Recon, X3DIR, PS>(member, bl, k, j, b3, bi3, d);
+                }
+            }
+        );
+    });
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 /**
  * @brief Reconstruct the values of primitive variables at left and right of each zone face,
  * find the corresponding conserved variables and their fluxes through the face
@@ -57,8 +531,8 @@ namespace Flux {
  * This allows some extra optimization from knowing that dir != 0 in parcticular, and inlining
  * the particular reconstruction call we need.
  */
-template <KReconstruction::Type Recon, int dir>
-inline TaskStatus GetFlux(MeshData<Real> *md)
+template <KReconstruction::Type Recon, int dir, PackageSet PS>
+inline TaskStatus GetFluxSpecialized(MeshData<Real> *md)
 {
     // Pointers
     auto pmesh = md->GetMeshPointer();
@@ -76,6 +550,7 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
     const auto& mhd_pars   = packages.Get("GRMHD")->AllParams();
     const auto& globals    = packages.Get("Globals")->AllParams();
     const bool use_hlle    = pars.Get<bool>("use_hlle");
+    const bool use_hllc    = pars.Get<bool>("use_hllc");
 
     const bool reconstruction_floors = pars.Get<bool>("reconstruction_floors");
     Floors::Prescription floors_temp;
@@ -105,19 +580,19 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
 
     // Pack variables.  Keep ctop separate
     PackIndexMap prims_map, cons_map;
-    const auto& cmax  = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
-    const auto& cmin  = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+    const auto& cmax  = md->PackVariables(names_cmax);
+    const auto& cmin  = md->PackVariables(names_cmin);
 
-    const auto& P_all = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
-    const auto& U_all = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const auto& P_all = md->PackVariables(PackFlags::PrimitiveCell(), prims_map);
+    const auto& U_all = md->PackVariablesAndFluxes(PackFlags::ConservedCell(), cons_map);
     const VarMap m_u(cons_map, true), m_p(prims_map, false);
 
-    const auto& Pl_all = md->PackVariables(std::vector<std::string>{"Flux.Pl"});
-    const auto& Pr_all = md->PackVariables(std::vector<std::string>{"Flux.Pr"});
-    const auto& Ul_all = md->PackVariables(std::vector<std::string>{"Flux.Ul"});
-    const auto& Ur_all = md->PackVariables(std::vector<std::string>{"Flux.Ur"});
-    const auto& Fl_all = md->PackVariables(std::vector<std::string>{"Flux.Fl"});
-    const auto& Fr_all = md->PackVariables(std::vector<std::string>{"Flux.Fr"});
+    const auto& Pl_all = md->PackVariables(names_pl);
+    const auto& Pr_all = md->PackVariables(names_pr);
+    const auto& Ul_all = md->PackVariables(names_ul);
+    const auto& Ur_all = md->PackVariables(names_ur);
+    const auto& Fl_all = md->PackVariables(names_fl);
+    const auto& Fr_all = md->PackVariables(names_fr);
 
     // Get the domain size
     // We need fluxes outside the domain for flux-CT and FOFC: one extra zone update on each side
@@ -126,6 +601,9 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
     const int n1 = pmb0->cellbounds.ncellsi(IndexDomain::entire);
     const IndexRange block = IndexRange{0, cmax.GetDim(5) - 1};
     const int nvar = U_all.GetDim(4);
+    // Interior zones, for the optional timestep reduction
+    const IndexRange3 bc = KDomain::GetRange(md, IndexDomain::interior);
+    const TimestepCache dt_cache = GetTimestepCache(md, dir, dir);
 
     if (globals.Get<int>("verbose") > 2) {
         std::cout << "Calculating fluxes for " << cmax.GetDim(5) << " blocks, "
@@ -135,88 +613,90 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
     }
 
     // Allocate scratch space
-    const int scratch_level = 1; // 0 is actual scratch (tiny); 1 is HBM
     const size_t var_size_in_bytes = parthenon::ScratchPad2D<Real>::shmem_size(nvar, n1);
     const size_t line_size_in_bytes = parthenon::ScratchPad1D<int>::shmem_size(n1);
     // Allocate enough to cache prims, conserved, and fluxes, for left and right faces,
     // plus temporaries inside reconstruction (most use none, donor_cell uses one, linear_vl uses a bunch)
     using RType = KReconstruction::Type;
     const size_t recon_scratch_bytes = (4 + 1*(Recon == RType::donor_cell) +
-                                            5*(Recon == RType::linear_vl)) * var_size_in_bytes +
+                                            5*(Recon == RType::linear_vl) +
+                                            1*(Recon == RType::weno5_cached)) * var_size_in_bytes +
                                         line_size_in_bytes;
     const size_t flux_scratch_bytes = 3 * var_size_in_bytes;
 
     // This isn't a pmb0->par_for_outer because Parthenon's current overloaded definitions
     // do not accept three pairs of bounds, which we need in order to iterate over blocks
     Flag("GetFlux_"+std::to_string(dir)+"_recon");
-    parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_recon", pmb0->exec_space,
-        recon_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
-        KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
-            const auto& G = U_all.GetCoords(bl);
-            ScratchPad2D<Real> Pl_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Pr_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Plf_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Prf_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad1D<int> fallback_tvd(member.team_scratch(scratch_level), n1);
-
-            // We template on reconstruction type to avoid a big switch statement here.
-            // Instead, a version of GetFlux() is generated separately for each reconstruction/direction pair.
-            // See reconstruction.hpp for all the implementations.
-            KReconstruction::ReconstructRow<Recon, dir>(member, P_all(bl), k, j, b.is, b.ie, Pl_s, Pr_s);
-
-            // Sync all threads in the team so that scratch memory is consistent
-            member.team_barrier();
+    LaunchTuned(md, "tuner_recon", nvar, recon_scratch_bytes, [&](const int scratch_level) {
+        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_recon", pmb0->exec_space,
+            recon_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
+            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
+                const auto& G = U_all.GetCoords(bl);
+                ScratchPad2D<Real> Pl_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Pr_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Plf_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Prf_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad1D<int> fallback_tvd(member.team_scratch(scratch_level), n1);
+
+                // We template on reconstruction type to avoid a big switch statement here.
+                // Instead, a version of GetFlux() is generated separately for each reconstruction/direction pair.
+                // See reconstruction.hpp for all the implementations.
+                KReconstruction::ReconstructRow<Recon, dir>(member, P_all(bl), k, j, b.is, b.ie, Pl_s, Pr_s);
+
+                // Sync all threads in the team so that scratch memory is consistent
+                member.team_barrier();
 
-            parthenon::par_for_inner(member, b.is, b.ie,
-                [&](const int& i) {
-                    auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
-                    auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
-                    // Apply floors to the *reconstructed* primitives, because without TVD
-                    // we have no guarantee they remotely resemble the *centered* primitives
-                    // If we selected to fall back to TVD, the floors are at zero (as intended)
-                    if (reconstruction_floors || reconstruction_fallback) {
-                        fallback_tvd(i)  = Floors::apply_geo_floors(G, Pl, m_p, gam, j, i, floors, floors_inner, loc);
-                        fallback_tvd(i) |= Floors::apply_geo_floors(G, Pr, m_p, gam, j, i, floors, floors_inner, loc);
+                parthenon::par_for_inner(member, b.is, b.ie,
+                    [&](const int& i) {
+                        auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
+                        auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
+                        // Apply floors to the *reconstructed* primitives, because without TVD
+                        // we have no guarantee they remotely resemble the *centered* primitives
+                        // If we selected to fall back to TVD, the floors are at zero (as intended)
+                        if (reconstruction_floors || reconstruction_fallback) {
+                            fallback_tvd(i)  = Floors::apply_geo_floors(G, Pl, m_p, gam, j, i, floors, floors_inner, loc);
+                            fallback_tvd(i) |= Floors::apply_geo_floors(G, Pr, m_p, gam, j, i, floors, floors_inner, loc);
+                        }
+                    }
+                );
+                member.team_barrier();
+
+                if (reconstruction_fallback) {
+                    // TODO without the whole thing again? Also, option of scheme?
+                    KReconstruction::ReconstructRow<RType::ppm, dir>(member, P_all(bl), k, j, b.is, b.ie, Plf_s, Prf_s);
+                    member.team_barrier();
+                    for (int p = 0; p <= P_all.GetDim(4) - 1; ++p) {
+                        parthenon::par_for_inner(member, b.is, b.ie,
+                            [&](const int& i) {
+                                if (fallback_tvd(i)) {
+                                    Pl_s(p, i) = Plf_s(p, i);
+                                    Pr_s(p, i) = Prf_s(p, i);
+                                }
+                            }
+                        );
                     }
+                    member.team_barrier();
                 }
-            );
-            member.team_barrier();
 
-            if (reconstruction_fallback) {
-                // TODO without the whole thing again? Also, option of scheme?
-                KReconstruction::ReconstructRow<RType::ppm, dir>(member, P_all(bl), k, j, b.is, b.ie, Plf_s, Prf_s);
-                member.team_barrier();
-                for (int p = 0; p <= P_all.GetDim(4) - 1; ++p) {
+                // Copy out state (TODO(BSP) eliminate)
+                for (int p=0; p < nvar; ++p) {
                     parthenon::par_for_inner(member, b.is, b.ie,
                         [&](const int& i) {
-                            if (fallback_tvd(i)) {
-                                Pl_s(p, i) = Plf_s(p, i);
-                                Pr_s(p, i) = Prf_s(p, i);
-                            }
+                            Pl_all(bl, p, k, j, i) = Pl_s(p, i);
+                            Pr_all(bl, p, k, j, i) = Pr_s(p, i);
                         }
                     );
                 }
                 member.team_barrier();
             }
-
-            // Copy out state (TODO(BSP) eliminate)
-            for (int p=0; p < nvar; ++p) {
-                parthenon::par_for_inner(member, b.is, b.ie,
-                    [&](const int& i) {
-                        Pl_all(bl, p, k, j, i) = Pl_s(p, i);
-                        Pr_all(bl, p, k, j, i) = Pr_s(p, i);
-                    }
-                );
-            }
-            member.team_barrier();
-        }
-    );
+        );
+    });
     EndFlag();
 
     // If we have B field on faces, we "must" replace reconstructed version with that
     // Override at user option due to unreasonable effectiveness (https://github.com/AFD-Illinois/kharma/issues/79)
     if (pmb0->packages.AllPackages().count("B_CT") && packages.Get("Flux")->Param<bool>("consistent_face_b")) {
-        const auto& Bf  = md->PackVariables(std::vector<std::string>{"cons.fB"});
+        const auto& Bf  = md->PackVariables(names_bf);
         const TopologicalElement face = FaceOf(dir); // TODO probably can be constexpr, somehow
         IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior, face);
         pmb0->par_for("replace_face", block.s, block.e, bi.ks, bi.ke, bi.js, bi.je, bi.is, bi.ie,
@@ -234,122 +714,145 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
     // At least, we should refactor to template loops on vchar/stress-energy T type
 
     Flag("GetFlux_"+std::to_string(dir)+"_left");
-    parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_left", pmb0->exec_space,
-        flux_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
-        KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
-            const auto& G = U_all.GetCoords(bl);
-            ScratchPad2D<Real> Pl_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Ul_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Fl_s(member.team_scratch(scratch_level), nvar, n1);
-
-            // Copy in state (TODO(BSP) eliminate)
-            for (int p=0; p < nvar; ++p) {
-                parthenon::par_for_inner(member, b.is, b.ie,
-                    [&](const int& i) {
-                        Pl_s(p, i) = Pl_all(bl, p, k, j, i);
-                    }
-                );
-            }
-            member.team_barrier();
+    LaunchTuned(md, "tuner_flux", nvar, flux_scratch_bytes, [&](const int scratch_level) {
+        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_left", pmb0->exec_space,
+            flux_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
+            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
+                const auto& G = U_all.GetCoords(bl);
+                ScratchPad2D<Real> Pl_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Ul_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Fl_s(member.team_scratch(scratch_level), nvar, n1);
 
-            // LEFT FACES
-            parthenon::par_for_inner(member, b.is, b.ie,
-                [&](const int& i) {
-                    auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
-                    auto Ul = Kokkos::subview(Ul_s, Kokkos::ALL(), i);
-                    auto Fl = Kokkos::subview(Fl_s, Kokkos::ALL(), i);
-                    // Declare temporary vectors
-                    FourVectors Dtmp;
-
-                    // Left
-                    GRMHD::calc_4vecs(G, Pl, m_p, j, i, loc, Dtmp);
-                    Flux::prim_to_flux(G, Pl, m_p, Dtmp, emhd_params, gam, j, i, 0, Ul, m_u, loc);
-                    Flux::prim_to_flux(G, Pl, m_p, Dtmp, emhd_params, gam, j, i, dir, Fl, m_u, loc);
-
-                    // Magnetosonic speeds
-                    Real cmaxL, cminL;
-                    Flux::vchar(G, Pl, m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxL, cminL);
-
-                    // Record speeds
-                    cmax(bl, dir-1, k, j, i) = m::max(0., cmaxL);
-                    cmin(bl, dir-1, k, j, i) = m::min(0., cminL);
+                // Copy in state (TODO(BSP) eliminate)
+                for (int p=0; p < nvar; ++p) {
+                    parthenon::par_for_inner(member, b.is, b.ie,
+                        [&](const int& i) {
+                            Pl_s(p, i) = Pl_all(bl, p, k, j, i);
+                        }
+                    );
                 }
-            );
-            member.team_barrier();
+                member.team_barrier();
 
-            // Copy out state
-            for (int p=0; p < nvar; ++p) {
+                // LEFT FACES
                 parthenon::par_for_inner(member, b.is, b.ie,
                     [&](const int& i) {
-                        Ul_all(bl, p, k, j, i) = Ul_s(p, i);
-                        Fl_all(bl, p, k, j, i) = Fl_s(p, i);
+                        auto Pl = Kokkos::subview(Pl_s, Kokkos::ALL(), i);
+                        auto Ul = Kokkos::subview(Ul_s, Kokkos::ALL(), i);
+                        auto Fl = Kokkos::subview(Fl_s, Kokkos::ALL(), i);
+                        // Declare temporary vectors
+                        FourVectors Dtmp;
+
+                        // Left
+                        GRMHD::calc_4vecs(G, Pl, m_p, j, i, loc, Dtmp);
+                        Flux::prim_to_flux<PS>(G, Pl, m_p, Dtmp, emhd_params, gam, j, i, 0, Ul, m_u, loc);
+                        Flux::prim_to_flux<PS>(G, Pl, m_p, Dtmp, emhd_params, gam, j, i, dir, Fl, m_u, loc);
+
+                        // Magnetosonic speeds
+                        Real cmaxL, cminL;
+                        Flux::vchar<PS>(G, Pl, m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxL, cminL);
+
+                        // Record speeds
+                        cmax(bl, dir-1, k, j, i) = m::max(0., cmaxL);
+                        cmin(bl, dir-1, k, j, i) = m::min(0., cminL);
                     }
                 );
+                member.team_barrier();
+
+                // Copy out state
+                for (int p=0; p < nvar; ++p) {
+                    parthenon::par_for_inner(member, b.is, b.ie,
+                        [&](const int& i) {
+                            Ul_all(bl, p, k, j, i) = Ul_s(p, i);
+                            Fl_all(bl, p, k, j, i) = Fl_s(p, i);
+                        }
+                    );
+                }
             }
-        }
-    );
+        );
+    });
     EndFlag();
 
     Flag("GetFlux_"+std::to_string(dir)+"_right");
-    parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_right", pmb0->exec_space,
-        flux_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
-        KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
-            const auto& G = U_all.GetCoords(bl);
-            ScratchPad2D<Real> Pr_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Ur_s(member.team_scratch(scratch_level), nvar, n1);
-            ScratchPad2D<Real> Fr_s(member.team_scratch(scratch_level), nvar, n1);
-
-            // Copy in state (TODO(BSP) eliminate)
-            for (int p=0; p < nvar; ++p) {
-                parthenon::par_for_inner(member, b.is, b.ie,
-                    [&](const int& i) {
-                        Pr_s(p, i) = Pr_all(bl, p, k, j, i);
-                    }
-                );
-            }
-            member.team_barrier();
+    LaunchTuned(md, "tuner_flux", nvar, flux_scratch_bytes, [&](const int scratch_level) {
+        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "calc_flux_right", pmb0->exec_space,
+            flux_scratch_bytes, scratch_level, block.s, block.e, b.ks, b.ke, b.js, b.je,
+            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
+                const auto& G = U_all.GetCoords(bl);
+                ScratchPad2D<Real> Pr_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Ur_s(member.team_scratch(scratch_level), nvar, n1);
+                ScratchPad2D<Real> Fr_s(member.team_scratch(scratch_level), nvar, n1);
 
-            // RIGHT FACES, finalize signal speed
-            parthenon::par_for_inner(member, b.is, b.ie,
-                [&](const int& i) {
-                    auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
-                    auto Ur = Kokkos::subview(Ur_s, Kokkos::ALL(), i);
-                    auto Fr = Kokkos::subview(Fr_s, Kokkos::ALL(), i);
-                    // Declare temporary vectors
-                    FourVectors Dtmp;
-                    // Right
-                    GRMHD::calc_4vecs(G, Pr, m_p, j, i, loc, Dtmp);
-                    Flux::prim_to_flux(G, Pr, m_p, Dtmp, emhd_params, gam, j, i, 0, Ur, m_u, loc);
-                    Flux::prim_to_flux(G, Pr, m_p, Dtmp, emhd_params, gam, j, i, dir, Fr, m_u, loc);
-
-                    // Magnetosonic speeds
-                    Real cmaxR, cminR;
-                    Flux::vchar(G, Pr, m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxR, cminR);
-
-                    // Calculate cmax/min based on comparison with cached values
-                    cmax(bl, dir-1, k, j, i) =  m::max(cmax(bl, dir-1, k, j, i), cmaxR);
-                    cmin(bl, dir-1, k, j, i) = -m::min(cmin(bl, dir-1, k, j, i), cminR);
+                // Copy in state (TODO(BSP) eliminate)
+                for (int p=0; p < nvar; ++p) {
+                    parthenon::par_for_inner(member, b.is, b.ie,
+                        [&](const int& i) {
+                            Pr_s(p, i) = Pr_all(bl, p, k, j, i);
+                        }
+                    );
                 }
-            );
-            member.team_barrier();
+                member.team_barrier();
 
-            // Copy out state
-            for (int p=0; p < nvar; ++p) {
+                // RIGHT FACES, finalize signal speed
                 parthenon::par_for_inner(member, b.is, b.ie,
                     [&](const int& i) {
-                        Ur_all(bl, p, k, j, i) = Ur_s(p, i);
-                        Fr_all(bl, p, k, j, i) = Fr_s(p, i);
+                        auto Pr = Kokkos::subview(Pr_s, Kokkos::ALL(), i);
+                        auto Ur = Kokkos::subview(Ur_s, Kokkos::ALL(), i);
+                        auto Fr = Kokkos::subview(Fr_s, Kokkos::ALL(), i);
+                        // Declare temporary vectors
+                        FourVectors Dtmp;
+                        // Right
+                        GRMHD::calc_4vecs(G, Pr, m_p, j, i, loc, Dtmp);
+                        Flux::prim_to_flux<PS>(G, Pr, m_p, Dtmp, emhd_params, gam, j, i, 0, Ur, m_u, loc);
+                        Flux::prim_to_flux<PS>(G, Pr, m_p, Dtmp, emhd_params, gam, j, i, dir, Fr, m_u, loc);
+
+                        // Magnetosonic speeds
+                        Real cmaxR, cminR;
+                        Flux::vchar<PS>(G, Pr, m_p, Dtmp, gam, emhd_params, k, j, i, loc, dir, cmaxR, cminR);
+
+                        // Calculate cmax/min based on comparison with cached values
+                        cmax(bl, dir-1, k, j, i) =  m::max(cmax(bl, dir-1, k, j, i), cmaxR);
+                        cmin(bl, dir-1, k, j, i) = -m::min(cmin(bl, dir-1, k, j, i), cminR);
                     }
                 );
-            }
+                member.team_barrier();
 
-        }
-    );
+                // Reduce the block timestep, and count bad speeds, while the final speeds are at hand
+                if (dt_cache.active)
+                    RecordRowTimestep<dir>(member, G, cmax, cmin, bl, k, j, bc, dt_cache);
+
+                // Copy out state
+                for (int p=0; p < nvar; ++p) {
+                    parthenon::par_for_inner(member, b.is, b.ie,
+                        [&](const int& i) {
+                            Ur_all(bl, p, k, j, i) = Ur_s(p, i);
+                            Fr_all(bl, p, k, j, i) = Fr_s(p, i);
+                        }
+                    );
+                }
+
+            }
+        );
+    });
     EndFlag();
 
     // Apply what we've calculated
     Flag("GetFlux_"+std::to_string(dir)+"_riemann");
-    if (use_hlle) { // More fluxes would need a template
+    if (use_hllc) {
+        pmb0->par_for("flux_hllc", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA(const int& bl, const int& k, const int& j, const int& i) {
+                Real fl[MAX_VARS], fr[MAX_VARS], ul[MAX_VARS], ur[MAX_VARS], f[MAX_VARS];
+                for (int p = 0; p < nvar; ++p) {
+                    fl[p] = Fl_all(bl, p, k, j, i); fr[p] = Fr_all(bl, p, k, j, i);
+                    ul[p] = Ul_all(bl, p, k, j, i); ur[p] = Ur_all(bl, p, k, j, i);
+                }
+                hllc(fl, fr, cmax(bl, dir-1, k, j, i), cmin(bl, dir-1, k, j, i), ul, ur,
+                     (gam - 1) * Pl_all(bl, m_p.UU, k, j, i), (gam - 1) * Pr_all(bl, m_p.UU, k, j, i),
+                     m_u, dir, nvar, f);
+                for (int p = 0; p < nvar; ++p)
+                    U_all(bl).flux(dir, p, k, j, i) = f[p];
+            }
+        );
+    } else if (use_hlle) { // More fluxes would need a template
         pmb0->par_for("flux_hlle", block.s, block.e, 0, nvar-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
             KOKKOS_LAMBDA(const int& bl, const int& p, const int& k, const int& j, const int& i) {
                 U_all(bl).flux(dir, p, k, j, i) = hlle(Fl_all(bl, p, k, j, i), Fr_all(bl, p, k, j, i),
@@ -372,4 +875,70 @@ inline TaskStatus GetFlux(MeshData<Real> *md)
     return TaskStatus::complete;
 }
 
+/**
+ * Calculate fluxes using the version of the flux calculation compiled for the loaded packages
+ * (see PackageSet in flux_functions.hpp), chosen once in Flux::Initialize.
+ * Also chooses the fused version of the calculation, if enabled.
+ */
+/**
+ * Whether the primitive and conserved packs match VarMap::FixedMHD, i.e. whether kernels
+ * compiled for PackageSet::mhd_fixed may run on this mesh.  The variable set is fixed after
+ * initialization, so this is checked once and cached in <Flux> "fixed_varmap"
+ */
+inline bool FixedLayout(MeshData<Real> *md)
+{
+    auto& flux_pkg = md->GetBlockData(0)->GetBlockPointer()->packages.Get("Flux");
+    int& fixed = *(flux_pkg->AllParams().GetMutable<int>("fixed_varmap"));
+    if (fixed < 0) {
+        PackIndexMap prims_map, cons_map;
+        md->PackVariables(PackFlags::PrimitiveCell(), prims_map);
+        md->PackVariablesAndFluxes(PackFlags::ConservedCell(), cons_map);
+        fixed = (VarMap(prims_map, false) == VarMap::FixedMHD() && VarMap(cons_map, true) == VarMap::FixedMHD());
+        if (!fixed && MPIRank0())
+            std::cout << "Variable layout does not match the fixed MHD layout, using general flux kernels" << std::endl;
+    }
+    return fixed;
+}
+
+template <KReconstruction::Type Recon, int dir>
+inline TaskStatus GetFlux(MeshData<Real> *md)
+{
+    const auto& pars = md->GetBlockData(0)->GetBlockPointer()->packages.Get("Flux")->AllParams();
+    const bool fused = pars.Get<bool>("fused_flux");
+#if FIXED_VARMAP
+    // Fused kernels can use compile-time variable indices, if the packs match the fixed layout
+    if (fused && pars.Get<PackageSet>("package_set") == PackageSet::mhd && FixedLayout(md)) {
+        if (!pars.Get<bool>("fused_directions"))
+            return GetFluxFused<Recon, dir, PackageSet::mhd_fixed>(md);
+        else if (dir == X1DIR)
+            return GetFluxFusedAllDirections<Recon, PackageSet::mhd_fixed>(md);
+        else
+            return TaskStatus::complete;
+    }
+#endif
+    // When computing all directions at once, do so in the X1 task and leave the others empty
+    if (pars.Get<bool>("fused_directions")) {
+        if (dir != X1DIR) return TaskStatus::complete;
+        switch (pars.Get<PackageSet>("package_set")) {
+        case PackageSet::mhd:
+            return GetFluxFusedAllDirections<Recon, PackageSet::mhd>(md);
+        case PackageSet::mhd_electrons:
+            return GetFluxFusedAllDirections<Recon, PackageSet::mhd_electrons>(md);
+        default:
+            return GetFluxFusedAllDirections<Recon, PackageSet::general>(md);
+        }
+    }
+    switch (pars.Get<PackageSet>("package_set")) {
+    case PackageSet::mhd:
+        return (fused) ? GetFluxFused<Recon, dir, PackageSet::mhd>(md)
+                       : GetFluxSpecialized<Recon, dir, PackageSet::mhd>(md);
+    case PackageSet::mhd_electrons:
+        return (fused) ? GetFluxFused<Recon, dir, PackageSet::mhd_electrons>(md)
+                       : GetFluxSpecialized<Recon, dir, PackageSet::mhd_electrons>(md);
+    default:
+        return (fused) ? GetFluxFused<Recon, dir, PackageSet::general>(md)
+                       : GetFluxSpecialized<Recon, dir, PackageSet::general>(md);
+    }
+}
+
 } // Flux
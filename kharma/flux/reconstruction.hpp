@@ -45,13 +45,38 @@ namespace KReconstruction
 {
 constexpr Real EPS = 1.e-26;
 
+// Precision of the WENO5 stencil arithmetic.  Optionally single precision, for GPUs with
+// weak FP64 throughput: inputs and outputs stay Real, so fluxes etc. are unaffected.
+// EPS is squared in WENO5, so it must be larger in float to avoid underflow.
+#if FLOAT_RECONSTRUCTION
+using RReal = float;
+constexpr RReal REPS = 1.e-18;
+#else
+using RReal = Real;
+constexpr RReal REPS = EPS;
+#endif
+
+// Explicitly vectorized rows on CPUs, see ReconstructRowSIMD below.
+// GPU backends map one zone to each thread already, so this is host-only
+#if SIMD_RECONSTRUCTION && !defined(KOKKOS_ENABLE_CUDA) && !defined(KOKKOS_ENABLE_HIP) && !defined(KOKKOS_ENABLE_SYCL)
+#define KHARMA_SIMD_ROWS 1
+#else
+#define KHARMA_SIMD_ROWS 0
+#endif
+
 // Enum for all supported reconstruction types.
-enum class Type{donor_cell=0, donor_cell_c, linear_mc, linear_vl, ppm, ppmx, mp5, weno5, weno5_lower_edges, weno5_lower_poles, weno5_linear};
+enum class Type{donor_cell=0, donor_cell_c, linear_mc, linear_vl, ppm, ppmx, mp5, weno5, weno5_lower_edges, weno5_lower_poles, weno5_linear, weno5_cached, weno5_adaptive};
 
 // Component functions
 KOKKOS_FORCEINLINE_FUNCTION Real mc(const Real dm, const Real dp)
 {
+#if KHARMA_SIMD_ROWS
+    // Take the ratio unconditionally, so the choice below is a select rather than a branch
+    const Real r_raw = dm/dp;
+    const Real r = (m::abs(dp) > 0. ? r_raw : 2.0);
+#else
     const Real r = (m::abs(dp) > 0. ? dm/dp : 2.0);
+#endif
     return m::max(0.0, m::min(2.0, m::min(2*r,0.5*(1+r))));
 }
 
@@ -125,82 +150,84 @@ KOKKOS_FORCEINLINE_FUNCTION void reconstruct_right<Type::linear_mc>(RECONSTRUCT_
 // WENO5 (no linearization)
 // Adapted from implementation in iharm3d originally by Monika Moscibrodzka
 // References: Tchekhovskoy et al. 2007 (T07), Shu 2011 (S11)
-template<>
-KOKKOS_FORCEINLINE_FUNCTION void reconstruct<Type::weno5>(RECONSTRUCT_ONE_ARGS)
+// The stencil arithmetic is done in RReal, which may be single precision (see above).
+// Each smoothness indicator is split as beta = s + (1/4)*c2^2, where s = (13/12)*c1^2 (T07 A18 or S11 8).
+// The second difference c1 for one sub-stencil is the same as for neighboring zones' other sub-stencils,
+// so row versions (weno5_cached) can compute s once per zone and pass it in.
+KOKKOS_FORCEINLINE_FUNCTION RReal weno5_indicator_term(const RReal xm, const RReal x, const RReal xp)
 {
-    // Smoothness indicators, T07 A18 or S11 8
-    Real beta[3], c1, c2;
-    c1 = x1 - 2.*x2 + x3; c2 = x1 - 4.*x2 + 3.*x3;
-    beta[0] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x2 - 2.*x3 + x4; c2 = x4 - x2;
-    beta[1] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x3 - 2.*x4 + x5; c2 = x5 - 4.*x4 + 3.*x3;
-    beta[2] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-
-    // Nonlinear weights S11 9
-    Real den[3] = {EPS + beta[0], EPS + beta[1], EPS + beta[2]};
+    const RReal c1 = xm - RReal(2.)*x + xp;
+    return RReal(13./12.)*c1*c1;
+}
+KOKKOS_FORCEINLINE_FUNCTION void weno5_den(const RReal x1, const RReal x2, const RReal x3, const RReal x4, const RReal x5,
+                                           const RReal s0, const RReal s1, const RReal s2, RReal den[3])
+{
+    RReal c2;
+    c2 = x1 - RReal(4.)*x2 + RReal(3.)*x3;
+    den[0] = REPS + (s0 + RReal(1./4.)*c2*c2);
+    c2 = x4 - x2;
+    den[1] = REPS + (s1 + RReal(1./4.)*c2*c2);
+    c2 = x5 - RReal(4.)*x4 + RReal(3.)*x3;
+    den[2] = REPS + (s2 + RReal(1./4.)*c2*c2);
     den[0] *= den[0]; den[1] *= den[1]; den[2] *= den[2];
+}
+// Left and right values from nonlinear weights S11 9, and S11 1, 2, 3
+KOKKOS_FORCEINLINE_FUNCTION RReal weno5_left(const RReal x1, const RReal x2, const RReal x3, const RReal x4, const RReal x5,
+                                             const RReal den[3])
+{
+    const RReal wtl[3] = {RReal(1./16.)/den[2], RReal(5./8.)/den[1], RReal(5./16.)/den[0]};
+    const RReal Wl = wtl[0] + wtl[1] + wtl[2];
 
-    Real wtr[3] = {(1./16.)/den[0], (5./8. )/den[1], (5./16.)/den[2]};
-    Real Wr = wtr[0] + wtr[1] + wtr[2];
-
-    Real wtl[3] = {(1./16.)/den[2], (5./8. )/den[1], (5./16.)/den[0]};
-    Real Wl = wtl[0] + wtl[1] + wtl[2];
+    return (RReal(3./8.)*x5 - RReal(5./4.)*x4 + RReal(15./8.)*x3)*(wtl[0] / Wl) +
+            (RReal(-1./8.)*x4 + RReal(3./4.)*x3 + RReal(3./8.)*x2)*(wtl[1] / Wl) +
+            (RReal(3./8.)*x3 + RReal(3./4.)*x2 - RReal(1./8.)*x1)*(wtl[2] / Wl);
+}
+KOKKOS_FORCEINLINE_FUNCTION RReal weno5_right(const RReal x1, const RReal x2, const RReal x3, const RReal x4, const RReal x5,
+                                              const RReal den[3])
+{
+    const RReal wtr[3] = {RReal(1./16.)/den[0], RReal(5./8.)/den[1], RReal(5./16.)/den[2]};
+    const RReal Wr = wtr[0] + wtr[1] + wtr[2];
 
-    // S11 1, 2, 3
-    lout = ((3./8.)*x5 - (5./4.)*x4 + (15./8.)*x3)*(wtl[0] / Wl) +
-            ((-1./8.)*x4 + (3./4.)*x3 + (3./8.)*x2)*(wtl[1] / Wl) +
-            ((3./8.)*x3 + (3./4.)*x2 - (1./8.)*x1)*(wtl[2] / Wl);
-    rout = ((3./8.)*x1 - (5./4.)*x2 + (15./8.)*x3)*(wtr[0] / Wr) +
-            ((-1./8.)*x2 + (3./4.)*x3 + (3./8.)*x4)*(wtr[1] / Wr) +
-            ((3./8.)*x3 + (3./4.)*x4 - (1./8.)*x5)*(wtr[2] / Wr);
+    return (RReal(3./8.)*x1 - RReal(5./4.)*x2 + RReal(15./8.)*x3)*(wtr[0] / Wr) +
+            (RReal(-1./8.)*x2 + RReal(3./4.)*x3 + RReal(3./8.)*x4)*(wtr[1] / Wr) +
+            (RReal(3./8.)*x3 + RReal(3./4.)*x4 - RReal(1./8.)*x5)*(wtr[2] / Wr);
+}
+KOKKOS_FORCEINLINE_FUNCTION void weno5_cached(RECONSTRUCT_ONE_ARGS, const RReal s0, const RReal s1, const RReal s2)
+{
+    RReal den[3];
+    weno5_den(x1, x2, x3, x4, x5, s0, s1, s2, den);
+    lout = weno5_left(x1, x2, x3, x4, x5, den);
+    rout = weno5_right(x1, x2, x3, x4, x5, den);
+}
+KOKKOS_FORCEINLINE_FUNCTION void weno5_cached_left(RECONSTRUCT_ONE_LEFT_ARGS, const RReal s0, const RReal s1, const RReal s2)
+{
+    RReal den[3];
+    weno5_den(x1, x2, x3, x4, x5, s0, s1, s2, den);
+    lout = weno5_left(x1, x2, x3, x4, x5, den);
+}
+KOKKOS_FORCEINLINE_FUNCTION void weno5_cached_right(RECONSTRUCT_ONE_RIGHT_ARGS, const RReal s0, const RReal s1, const RReal s2)
+{
+    RReal den[3];
+    weno5_den(x1, x2, x3, x4, x5, s0, s1, s2, den);
+    rout = weno5_right(x1, x2, x3, x4, x5, den);
+}
+template<>
+KOKKOS_FORCEINLINE_FUNCTION void reconstruct<Type::weno5>(RECONSTRUCT_ONE_ARGS)
+{
+    weno5_cached(x1, x2, x3, x4, x5, lout, rout,
+                 weno5_indicator_term(x1, x2, x3), weno5_indicator_term(x2, x3, x4), weno5_indicator_term(x3, x4, x5));
 }
 template<>
 KOKKOS_FORCEINLINE_FUNCTION void reconstruct_left<Type::weno5>(RECONSTRUCT_ONE_LEFT_ARGS)
 {
-    // Smoothness indicators, T07 A18 or S11 8
-    Real beta[3], c1, c2;
-    c1 = x1 - 2.*x2 + x3; c2 = x1 - 4.*x2 + 3.*x3;
-    beta[0] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x2 - 2.*x3 + x4; c2 = x4 - x2;
-    beta[1] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x3 - 2.*x4 + x5; c2 = x5 - 4.*x4 + 3.*x3;
-    beta[2] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-
-    // Nonlinear weights S11 9
-    Real den[3] = {EPS + beta[0], EPS + beta[1], EPS + beta[2]};
-    den[0] *= den[0]; den[1] *= den[1]; den[2] *= den[2];
-
-    Real wtl[3] = {(1./16.)/den[2], (5./8. )/den[1], (5./16.)/den[0]};
-    Real Wl = wtl[0] + wtl[1] + wtl[2];
-
-    // S11 1, 2, 3
-    lout = ((3./8.)*x5 - (5./4.)*x4 + (15./8.)*x3)*(wtl[0] / Wl) +
-            ((-1./8.)*x4 + (3./4.)*x3 + (3./8.)*x2)*(wtl[1] / Wl) +
-            ((3./8.)*x3 + (3./4.)*x2 - (1./8.)*x1)*(wtl[2] / Wl);
+    weno5_cached_left(x1, x2, x3, x4, x5, lout,
+                      weno5_indicator_term(x1, x2, x3), weno5_indicator_term(x2, x3, x4), weno5_indicator_term(x3, x4, x5));
 }
 template<>
 KOKKOS_FORCEINLINE_FUNCTION void reconstruct_right<Type::weno5>(RECONSTRUCT_ONE_RIGHT_ARGS)
 {
-    // Smoothness indicators, T07 A18 or S11 8
-    Real beta[3], c1, c2;
-    c1 = x1 - 2.*x2 + x3; c2 = x1 - 4.*x2 + 3.*x3;
-    beta[0] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x2 - 2.*x3 + x4; c2 = x4 - x2;
-    beta[1] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-    c1 = x3 - 2.*x4 + x5; c2 = x5 - 4.*x4 + 3.*x3;
-    beta[2] = (13./12.)*c1*c1 + (1./4.)*c2*c2;
-
-    // Nonlinear weights S11 9
-    Real den[3] = {EPS + beta[0], EPS + beta[1], EPS + beta[2]};
-    den[0] *= den[0]; den[1] *= den[1]; den[2] *= den[2];
-
-    Real wtr[3] = {(1./16.)/den[0], (5./8. )/den[1], (5./16.)/den[2]};
-    Real Wr = wtr[0] + wtr[1] + wtr[2];
-
-    rout = ((3./8.)*x1 - (5./4.)*x2 + (15./8.)*x3)*(wtr[0] / Wr) +
-            ((-1./8.)*x2 + (3./4.)*x3 + (3./8.)*x4)*(wtr[1] / Wr) +
-            ((3./8.)*x3 + (3./4.)*x4 - (1./8.)*x5)*(wtr[2] / Wr);
+    weno5_cached_right(x1, x2, x3, x4, x5, rout,
+                       weno5_indicator_term(x1, x2, x3), weno5_indicator_term(x2, x3, x4), weno5_indicator_term(x3, x4, x5));
 }
 
 // Linearized WENO, stolen from Phoebus
@@ -507,10 +534,57 @@ KOKKOS_FORCEINLINE_FUNCTION void reconstruct<Type::ppmx>(const Real &q_im2, cons
 #define RECONSTRUCT_ROW_LEFT_ARGS RECONSTRUCT_ROW_INPUT ScratchPad2D<Real> &ql
 #define RECONSTRUCT_ROW_RIGHT_ARGS RECONSTRUCT_ROW_INPUT ScratchPad2D<Real> &qr
 
+#if KHARMA_SIMD_ROWS
+/**
+ * CPU versions of the row loops below, over raw pointers to the i-contiguous rows of each
+ * variable, so that the compiler can fill full-width SVE/AVX-512 lanes.  The scratch-pad
+ * indexing through Kokkos views otherwise defeats vectorization.  Only used when a team is
+ * a single thread, which is the case on host backends.
+ */
+template <Type recon_type>
+inline void ReconstructX1SIMD(const Real *q, Real *ql, Real *qr, const int& il, const int& iu)
+{
+#pragma omp simd
+    for (int i = il; i <= iu; ++i)
+        reconstruct<recon_type>(q[i - 2], q[i - 1], q[i], q[i + 1], q[i + 2], qr[i], ql[i + 1]);
+}
+// Rows x1..x5 are the neighbors along the reconstruction direction
+template <Type recon_type, bool right>
+inline void ReconstructPerpSIMD(const Real *x1, const Real *x2, const Real *x3, const Real *x4, const Real *x5,
+                                Real *out, const int& il, const int& iu)
+{
+#pragma omp simd
+    for (int i = il; i <= iu; ++i) {
+        if constexpr (right) {
+            reconstruct_right<recon_type>(x1[i], x2[i], x3[i], x4[i], x5[i], out[i]);
+        } else {
+            reconstruct_left<recon_type>(x1[i], x2[i], x3[i], x4[i], x5[i], out[i]);
+        }
+    }
+}
+#define RECONSTRUCT_PERP_SIMD(right, out, dk, dj) \
+    if (member.team_size() == 1) { \
+        for (int p = 0; p <= q.GetDim(4) - 1; ++p) \
+            ReconstructPerpSIMD<recon_type, right>(&q(p, k - 2*dk, j - 2*dj, 0), &q(p, k - dk, j - dj, 0), \
+                                                   &q(p, k, j, 0), &q(p, k + dk, j + dj, 0), \
+                                                   &q(p, k + 2*dk, j + 2*dj, 0), &out(p, 0), il, iu); \
+        return; \
+    }
+#else
+#define RECONSTRUCT_PERP_SIMD(right, out, dk, dj)
+#endif
+
 // TODO(BSP) I'm sure these could be shorter with more C++ magic
 template <Type recon_type>
 KOKKOS_FORCEINLINE_FUNCTION void ReconstructX1(RECONSTRUCT_ROW_ARGS)
 {
+#if KHARMA_SIMD_ROWS
+    if (member.team_size() == 1) {
+        for (int p = 0; p <= q.GetDim(4) - 1; ++p)
+            ReconstructX1SIMD<recon_type>(&q(p, k, j, 0), &ql(p, 0), &qr(p, 0), il, iu);
+        return;
+    }
+#endif
     for (int p = 0; p <= q.GetDim(4) - 1; ++p) {
         parthenon::par_for_inner(member, il, iu,
             KOKKOS_LAMBDA (const int& i) {
@@ -528,6 +602,7 @@ KOKKOS_FORCEINLINE_FUNCTION void ReconstructX1(RECONSTRUCT_ROW_ARGS)
 template <Type recon_type>
 KOKKOS_FORCEINLINE_FUNCTION void ReconstructX2l(RECONSTRUCT_ROW_LEFT_ARGS)
 {
+    RECONSTRUCT_PERP_SIMD(true, ql, 0, 1)
     for (int p = 0; p <= q.GetDim(4) - 1; ++p) {
         parthenon::par_for_inner(member, il, iu,
             KOKKOS_LAMBDA (const int& i) {
@@ -545,6 +620,7 @@ KOKKOS_FORCEINLINE_FUNCTION void ReconstructX2l(RECONSTRUCT_ROW_LEFT_ARGS)
 template <Type recon_type>
 KOKKOS_FORCEINLINE_FUNCTION void ReconstructX2r(RECONSTRUCT_ROW_RIGHT_ARGS)
 {
+    RECONSTRUCT_PERP_SIMD(false, qr, 0, 1)
     for (int p = 0; p <= q.GetDim(4) - 1; ++p) {
         parthenon::par_for_inner(member, il, iu,
             KOKKOS_LAMBDA (const int& i) {
@@ -562,6 +638,7 @@ KOKKOS_FORCEINLINE_FUNCTION void ReconstructX2r(RECONSTRUCT_ROW_RIGHT_ARGS)
 template <Type recon_type>
 KOKKOS_FORCEINLINE_FUNCTION void ReconstructX3l(RECONSTRUCT_ROW_LEFT_ARGS)
 {
+    RECONSTRUCT_PERP_SIMD(true, ql, 1, 0)
     for (int p = 0; p <= q.GetDim(4) - 1; ++p) {
         parthenon::par_for_inner(member, il, iu,
             KOKKOS_LAMBDA (const int& i) {
@@ -579,6 +656,7 @@ KOKKOS_FORCEINLINE_FUNCTION void ReconstructX3l(RECONSTRUCT_ROW_LEFT_ARGS)
 template <Type recon_type>
 KOKKOS_FORCEINLINE_FUNCTION void ReconstructX3r(RECONSTRUCT_ROW_RIGHT_ARGS)
 {
+    RECONSTRUCT_PERP_SIMD(false, qr, 1, 0)
     for (int p = 0; p <= q.GetDim(4) - 1; ++p) {
         parthenon::par_for_inner(member, il, iu,
             KOKKOS_LAMBDA (const int& i) {
@@ -770,6 +848,144 @@ KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_lower_poles, X3DIR>(
     }
 }
 
+// WENO5 adaptive:
+// Use linear_mc for whole rows where every variable is smooth, judged by a normalized second
+// difference along the reconstruction direction (as in e.g. Loehner's refinement indicator).
+// WENO5 is run only for rows containing some structure.
+constexpr Real ADAPTIVE_SMOOTHNESS_TOL = 1.e-3;
+template <int dir>
+KOKKOS_FORCEINLINE_FUNCTION bool RowIsSmooth(parthenon::team_mbr_t& member, const VariablePack<Real> &P,
+                                             const int& k, const int& j, const int& is_l, const int& ie_l)
+{
+    constexpr int di = (dir == X1DIR), dj = (dir == X2DIR), dk = (dir == X3DIR);
+    // Zones whose stencils are used: X1 rows cover zones is_l..ie_l, X2/X3 rows zones j-1 and j
+    constexpr int o = (dir == X1DIR) ? 0 : 1;
+    for (int p = 0; p <= P.GetDim(4) - 1; ++p) {
+        Real sensor;
+        parthenon::par_reduce_inner(member, is_l, ie_l,
+            [&](const int& i, Real& local_result) {
+                for (int c = -o; c <= 0; ++c) {
+                    const int kc = k + c*dk, jc = j + c*dj;
+                    const Real qm = P(p, kc - dk, jc - dj, i - di);
+                    const Real q0 = P(p, kc, jc, i);
+                    const Real qp = P(p, kc + dk, jc + dj, i + di);
+                    const Real s = m::abs(qp - 2*q0 + qm) / (m::abs(qp) + 2*m::abs(q0) + m::abs(qm) + EPS);
+                    if (s > local_result) local_result = s;
+                }
+            }
+        , Kokkos::Max<Real>(sensor));
+        if (sensor > ADAPTIVE_SMOOTHNESS_TOL) return false;
+    }
+    return true;
+}
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_adaptive, X1DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    if (RowIsSmooth<X1DIR>(member, P, k, j, is_l, ie_l)) {
+        ReconstructRow<Type::linear_mc, X1DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    } else {
+        ReconstructRow<Type::weno5, X1DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    }
+}
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_adaptive, X2DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    if (RowIsSmooth<X2DIR>(member, P, k, j, is_l, ie_l)) {
+        ReconstructRow<Type::linear_mc, X2DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    } else {
+        ReconstructRow<Type::weno5, X2DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    }
+}
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_adaptive, X3DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    if (RowIsSmooth<X3DIR>(member, P, k, j, is_l, ie_l)) {
+        ReconstructRow<Type::linear_mc, X3DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    } else {
+        ReconstructRow<Type::weno5, X3DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+    }
+}
+
+// WENO5 with cached smoothness indicators:
+// In X1, neighboring zones are handled by different threads, so the shared indicator terms are
+// computed once per zone into team scratch.  In X2/X3, the two zones reconstructed by a thread
+// (j-1 and j) share two of their three indicator terms, which are computed once in registers.
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_cached, X1DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    ScratchPad2D<Real> s(member.team_scratch(1), P.GetDim(4), P.GetDim(1));
+    for (int p = 0; p <= P.GetDim(4) - 1; ++p) {
+        parthenon::par_for_inner(member, is_l - 1, ie_l + 1,
+            KOKKOS_LAMBDA (const int& i) {
+                s(p, i) = weno5_indicator_term(P(p, k, j, i - 1), P(p, k, j, i), P(p, k, j, i + 1));
+            }
+        );
+    }
+    member.team_barrier();
+    for (int p = 0; p <= P.GetDim(4) - 1; ++p) {
+        parthenon::par_for_inner(member, is_l, ie_l,
+            KOKKOS_LAMBDA (const int& i) {
+                weno5_cached(P(p, k, j, i - 2), P(p, k, j, i - 1), P(p, k, j, i),
+                             P(p, k, j, i + 1), P(p, k, j, i + 2),
+                             qr(p, i), ql(p, i+1), s(p, i - 1), s(p, i), s(p, i + 1));
+            }
+        );
+    }
+}
+template <int dir>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructWENO5CachedPerp(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    constexpr int dj = (dir == X2DIR), dk = (dir == X3DIR);
+    for (int p = 0; p <= P.GetDim(4) - 1; ++p) {
+        parthenon::par_for_inner(member, is_l, ie_l,
+            KOKKOS_LAMBDA (const int& i) {
+                // Values along the direction, offset from zone (k, j)
+                Real x[6];
+                for (int o = -3; o <= 2; ++o) x[o + 3] = P(p, k + o*dk, j + o*dj, i);
+                // Indicator terms centered on zones j-2 .. j+1
+                const Real s_m2 = weno5_indicator_term(x[0], x[1], x[2]);
+                const Real s_m1 = weno5_indicator_term(x[1], x[2], x[3]);
+                const Real s_0  = weno5_indicator_term(x[2], x[3], x[4]);
+                const Real s_p1 = weno5_indicator_term(x[3], x[4], x[5]);
+                // Right side of zone j-1 is the left state at this face, and vice versa
+                weno5_cached_right(x[0], x[1], x[2], x[3], x[4], ql(p, i), s_m2, s_m1, s_0);
+                weno5_cached_left(x[1], x[2], x[3], x[4], x[5], qr(p, i), s_m1, s_0, s_p1);
+            }
+        );
+    }
+}
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_cached, X2DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    ReconstructWENO5CachedPerp<X2DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+}
+template <>
+KOKKOS_FORCEINLINE_FUNCTION void ReconstructRow<Type::weno5_cached, X3DIR>(parthenon::team_mbr_t& member,
+                                        const VariablePack<Real> &P,
+                                        const int& k, const int& j, const int& is_l, const int& ie_l, 
+                                        ScratchPad2D<Real> ql, ScratchPad2D<Real> qr)
+{
+    ReconstructWENO5CachedPerp<X3DIR>(member, P, k, j, is_l, ie_l, ql, qr);
+}
+
 /**
  * Versions computing just the (limited) slope, for linear reconstructions.
  * Used for gradient calculations needed to implement Extended GRMHD.
@@ -46,10 +46,14 @@
 #include "gr_coordinates.hpp"
 #include "grmhd_functions.hpp"
 #include "inverter.hpp"
+#include "ismr.hpp"
 #include "kharma.hpp"
 #include "kharma_driver.hpp"
+#include "multizone.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <sstream>
 
 /**
  * GRMHD package.  Global operations on General Relativistic Magnetohydrodynamic systems.
@@ -119,10 +123,48 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     // AMR PARAMETERS
     // Adaptive mesh refinement options
     // Only active if "refinement" and "numlevel" parameters allow
-    Real refine_tol = pin->GetOrAddReal("GRMHD", "refine_tol", 0.5);
-    params.Add("refine_tol", refine_tol);
-    Real derefine_tol = pin->GetOrAddReal("GRMHD", "derefine_tol", 0.05);
-    params.Add("derefine_tol", derefine_tol);
+    const std::string criteria_str = pin->GetOrAddString("GRMHD", "refine_criteria", "rho_spread");
+    RefinementCriteria criteria;
+    criteria.rho_spread = false;
+    criteria.refine_tol = pin->GetOrAddReal("GRMHD", "refine_tol", 0.5);
+    criteria.derefine_tol = pin->GetOrAddReal("GRMHD", "derefine_tol", 0.05);
+    criteria.lohner_filter = pin->GetOrAddReal("GRMHD", "lohner_filter", 0.01);
+    const std::vector<std::string> criterion_names = {"grad_rho", "grad_p", "current", "sigma", "lohner"};
+    const std::vector<Real> default_refine = {0.3, 0.3, 0.5, 1., 0.8};
+    const std::vector<Real> default_derefine = {0.03, 0.03, 0.1, 0.1, 0.2};
+    for (int c = 0; c < n_refine_criteria; ++c) criteria.use[c] = false;
+    std::stringstream criteria_ss(criteria_str);
+    std::string criterion;
+    while (std::getline(criteria_ss, criterion, ',')) {
+        criterion.erase(0, criterion.find_first_not_of(" "));
+        criterion.erase(criterion.find_last_not_of(" ") + 1);
+        if (criterion.empty()) continue;
+        if (criterion == "rho_spread") {
+            criteria.rho_spread = true;
+            continue;
+        }
+        const auto it = std::find(criterion_names.begin(), criterion_names.end(), criterion);
+        if (it == criterion_names.end())
+            throw std::invalid_argument("Unknown refinement criterion: "+criterion);
+        const int c = it - criterion_names.begin();
+        criteria.use[c] = true;
+        criteria.refine[c] = pin->GetOrAddReal("GRMHD", "refine_"+criterion, default_refine[c]);
+        criteria.derefine[c] = pin->GetOrAddReal("GRMHD", "derefine_"+criterion, default_derefine[c]);
+    }
+    params.Add("refinement_criteria", criteria);
+    for (int c = 0; c < n_refine_criteria; ++c)
+        if (criteria.use[c] && criteria.derefine[c] >= criteria.refine[c])
+            throw std::invalid_argument("Derefinement thresholds must be below refinement thresholds!");
+    if (criteria.rho_spread && criteria.derefine_tol >= criteria.refine_tol)
+        throw std::invalid_argument("Derefinement thresholds must be below refinement thresholds!");
+
+    RegridSchedule schedule;
+    schedule.min_block_lifetime = pin->GetOrAddInteger("GRMHD", "min_block_lifetime", 0);
+    schedule.regrid_horizon = pin->GetOrAddInteger("GRMHD", "regrid_horizon", 100);
+    schedule.regrid_cost = pin->GetOrAddReal("GRMHD", "regrid_cost", 2.);
+    schedule.regrid_cost_fixed = pin->GetOrAddReal("GRMHD", "regrid_cost_fixed", 0.5);
+    schedule.this_check = schedule.last_check = -1;
+    params.Add("regrid_schedule", schedule, true);
 
     // =================================== FIELDS ===================================
 
@@ -133,9 +175,9 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
 
     // Add flags to distinguish groups of fields.
     // Hydrodynamics (everything we directly handle in this package)
-    Metadata::AddUserFlag("HD");
+    AddUserFlag("HD");
     // Magnetohydrodynamics (all HD fields plus B field, which we'll need to make use of)
-    Metadata::AddUserFlag("MHD");
+    AddUserFlag("MHD");
     // Mark whether to evolve our variables via the explicit or implicit step inside the driver
     MetadataFlag areWeImplicit = (implicit_grmhd) ? Metadata::GetUserFlag("Implicit")
                                                   : Metadata::GetUserFlag("Explicit");
@@ -152,8 +194,10 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
         flags_cons.push_back(Metadata::GetUserFlag("IdealGuess"));
     }
 
-    // We must additionally save the primtive variables as the "seed" for the next U->P solve
-    flags_prim.push_back(Metadata::Restart);
+    // We must additionally save the primtive variables as the "seed" for the next U->P solve,
+    // unless writing compact restarts, which recover them without a seed
+    if (!driver.Get<bool>("compact_restart"))
+        flags_prim.push_back(Metadata::Restart);
 
     // We must additionally fill ghost zones of primitive variables in GRMHD, to seed the solver
     // Only necessary to add here if syncing conserved vars
@@ -184,6 +228,21 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     m = Metadata(flags_cons_vec, s_vector);
     pkg->AddField("cons.uvec", m);
 
+    // Optionally cache the cell-centered FourVectors between the end of a substep and its consumers, see
+    // CacheFourVectors.  OneCopy, so stage containers share it, & each partition is tagged with its source
+    const bool cache_fourvectors = pin->GetOrAddBoolean("GRMHD", "cache_fourvectors", false);
+    params.Add("cache_fourvectors", cache_fourvectors);
+    if (cache_fourvectors) {
+        m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy},
+                     std::vector<int>({4*GR_DIM}));
+        pkg->AddField("GRMHD.fourvectors", m);
+        params.Add("fourvector_source", std::map<int, std::pair<const MeshData<Real>*, std::vector<LogicalLocation>>>(), true);
+    }
+
+    // Per-block flags marking polar boundaries, for the ISMR-aware timestep, see EstimateTimestep.
+    // Rebuilt for each partition only when its blocks change
+    params.Add("polar_faces", std::map<int, std::pair<ParArray1D<int>, std::vector<LogicalLocation>>>(), true);
+
     // No magnetic fields here. KHARMA should operate fine in GRHD without them,
     // so they are allocated only by B field packages.
 
@@ -197,50 +256,38 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     pkg->DomainBoundaryPtoU = Flux::BlockPtoUMHD;
 
     // AMR-related
-    pkg->CheckRefinementBlock    = GRMHD::CheckRefinement;
+    pkg->CheckRefinementMesh     = GRMHD::CheckRefinement;
     pkg->EstimateTimestepMesh    = GRMHD::EstimateTimestep;
     pkg->PostStepDiagnosticsMesh = GRMHD::PostStepDiagnostics;
 
     // List (vector) of HistoryOutputVars that will all be enrolled as output variables
     parthenon::HstVar_list hst_vars = {};
     bool do_all = KHARMA::FieldIsOutput(pin, "all_reductions");
+    // Each group below is computed in a single sweep of the mesh, see Reductions::AddBatchedHistory
+    using Reductions::Var;
     // Common tracking variables
     if (do_all || KHARMA::FieldIsOutput(pin, "conserved_vars")) {
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::rhou0>, "Mass"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::mix_T00>, "Egas"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::mix_T01>, "X1_Mom"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::mix_T02>, "X2_Mom"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::mix_T03>, "Ang_Mom"));
+        Reductions::AddBatchedHistory<Var::rhou0, Var::mix_T00, Var::mix_T01, Var::mix_T02, Var::mix_T03>
+            (hst_vars, "conserved_vars", Reductions::BatchRegion::total, {"Mass", "Egas", "X1_Mom", "X2_Mom", "Ang_Mom"});
     }
     // TODO these are probably more useful at/within/without certain radii
     if (do_all || KHARMA::FieldIsOutput(pin, "luminosities")) {
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::eht_lum>, "EHT_Lum_Proxy"));
-        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::Total<Reductions::Var::jet_lum>, "Jet_Lum"));
+        Reductions::AddBatchedHistory<Var::eht_lum, Var::jet_lum>
+            (hst_vars, "luminosities", Reductions::BatchRegion::total, {"EHT_Lum_Proxy", "Jet_Lum"});
     }
     // Event horizon fluxes
     if (pin->GetBoolean("coordinates", "domain_intersects_eh")) {
         if (do_all || KHARMA::FieldIsOutput(pin, "eh_fluxes_cell")) {
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::mdot>, "Mdot"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::mdot>, "Mdot_EH"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::mdot>, "Mdot_5M"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::edot>, "Edot"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::edot>, "Edot_EH"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::edot>, "Edot_5M"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::ldot>, "Ldot"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::ldot>, "Ldot_EH"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::ldot>, "Ldot_5M"));
+            Reductions::AddBatchedHistory<Var::mdot, Var::edot, Var::ldot>
+                (hst_vars, "eh_fluxes_cell", Reductions::BatchRegion::shells,
+                 {"Mdot", "Mdot_EH", "Mdot_5M", "Edot", "Edot_EH", "Edot_5M", "Ldot", "Ldot_EH", "Ldot_5M"});
         }
 
         if (do_all || KHARMA::FieldIsOutput(pin, "eh_fluxes_flux")) {
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::mdot_flux>, "Mdot_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::mdot_flux>, "Mdot_EH_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::mdot_flux>, "Mdot_5M_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::edot_flux>, "Edot_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::edot_flux>, "Edot_EH_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::edot_flux>, "Edot_5M_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt0<Reductions::Var::ldot_flux>, "Ldot_0_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAtEH<Reductions::Var::ldot_flux>, "Ldot_EH_Flux"));
-            hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum, Reductions::SumAt5M<Reductions::Var::ldot_flux>, "Ldot_5M_Flux"));
+            Reductions::AddBatchedHistory<Var::mdot_flux, Var::edot_flux, Var::ldot_flux>
+                (hst_vars, "eh_fluxes_flux", Reductions::BatchRegion::shells,
+                 {"Mdot_Flux", "Mdot_EH_Flux", "Mdot_5M_Flux", "Edot_Flux", "Edot_EH_Flux", "Edot_5M_Flux",
+                  "Ldot_0_Flux", "Ldot_EH_Flux", "Ldot_5M_Flux"});
         }
     }
     // add callbacks for HST output to the Params struct, identified by the `hist_param_key`
@@ -249,6 +296,25 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
     return pkg;
 }
 
+ParArray1D<int> GetPolarFaces(MeshData<Real> *md)
+{
+    auto *cache = GetPartitionParam<std::pair<ParArray1D<int>, std::vector<LogicalLocation>>>(md, "GRMHD", "polar_faces");
+    auto locs = PartitionLocations(md);
+    if (cache->first.extent_int(0) >= md->NumBlocks() && cache->second == locs) return cache->first;
+
+    if (cache->first.extent_int(0) < md->NumBlocks())
+        cache->first = ParArray1D<int>("polar_faces", md->NumBlocks());
+    auto polar_h = Kokkos::create_mirror_view(cache->first);
+    for (int b = 0; b < md->NumBlocks(); ++b) {
+        auto pmb = md->GetBlockData(b)->GetBlockPointer();
+        polar_h(b) = (pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user) |
+                     ((pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user) << 1);
+    }
+    Kokkos::deep_copy(cache->first, polar_h);
+    cache->second = locs;
+    return cache->first;
+}
+
 Real EstimateTimestep(MeshData<Real> *md)
 {
     // Normally the caller would place this flag before calling us, but this is from Parthenon
@@ -300,34 +366,68 @@ Real EstimateTimestep(MeshData<Real> *md)
     // TODO version preserving location, with switch to keep this fast one
     // TODO maybe split normal, ISMR timesteps? Excised pole/recalculated ctop too?
     double min_ndt = std::numeric_limits<double>::max();
-    for (auto &pmb : pmesh->block_list) {
-        auto rc = pmb->meshblock_data.Get().get();
-        // We only need this block-wise to check boundary flags for ISMR, could special-case that
-        const bool polar_inner_x2 = pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user;
-        const bool polar_outer_x2 = pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user;
-
-        const auto& cmax  = rc->PackVariables(std::vector<std::string>{"Flux.cmax"});
-        const auto& cmin  = rc->PackVariables(std::vector<std::string>{"Flux.cmin"});
-
-        double block_min_ndt = 0.;
-        pmb->par_reduce("ndt_min", b.ks, b.ke, b.js, b.je, b.is, b.ie,
-            KOKKOS_LAMBDA (const int k, const int j, const int i,
+    const auto& flux_pars = pmesh->packages.Get("Flux")->AllParams();
+    // In multizone runs, only the annulus evolved next step limits it.  That step starts at time + dt_last,
+    // as PostStepWork records the start and length of the step just taken
+    GReal r_in = 0., r_out = std::numeric_limits<GReal>::max();
+    if (pmesh->packages.AllPackages().count("Multizone")) {
+        const auto ann = Multizone::ActiveAnnulus(pmesh->packages.Get("Multizone")->AllParams(),
+                                                  globals.Get<double>("time") + globals.Get<double>("dt_last"));
+        r_in = ann.r_in;
+        r_out = ann.r_out;
+    }
+    if (flux_pars.Get<bool>("cache_timestep")) {
+        // Use the per-direction block minima reduced in GetFlux.  Combining the minima rather than
+        // the zone values gives a slightly smaller, but still safe, step
+        const auto ndt_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),
+                                                               flux_pars.Get<ParArray2D<Real>>("ndt_cache"));
+        for (int bl = 0; bl < md->NumBlocks(); ++bl) {
+            auto pmb = md->GetBlockData(bl)->GetBlockPointer();
+            // Blocks may straddle annulus edges, so this goes by their first and last radial faces
+            if (pmb->coords.r(b.ks, b.js, b.ie + 1, Loci::face1) < r_in ||
+                pmb->coords.r(b.ks, b.js, b.is, Loci::face1) > r_out) continue;
+
+            double inv_ndt = 0.;
+            for (int d = 0; d < pmesh->ndim; ++d)
+                inv_ndt += 1. / ndt_h(pmb->lid, d);
+            const double block_min_ndt = 1. / inv_ndt;
+            if (block_min_ndt < min_ndt) min_ndt = block_min_ndt;
+        }
+    } else {
+        // One reduction over all of this partition's blocks.  Each partition reports its own minimum,
+        // which Parthenon combines with the others' (and those of other ranks) in one reduction
+        const int ismr_nlevels = pmesh->packages.AllPackages().count("ISMR") ?
+                                 pmesh->packages.Get("ISMR")->Param<int>("nlevels") : 0;
+        const auto polar = GetPolarFaces(md);
+
+        static const std::vector<std::string> cmax_name{"Flux.cmax"}, cmin_name{"Flux.cmin"};
+        const auto& cmax  = md->PackVariables(cmax_name);
+        const auto& cmin  = md->PackVariables(cmin_name);
+        const IndexRange block = IndexRange{0, cmax.GetDim(5) - 1};
+
+        auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+        pmb0->par_reduce("ndt_min", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int bl, const int k, const int j, const int i,
                         double &local_result) {
-                const auto& G = cmax.GetCoords();
+                const auto& G = cmax.GetCoords(bl);
+                // Zones merged in X3 near the poles by ISMR are limited by their merged width
                 int ismr_factor = 1;
+                if ((polar(bl) & 1) && j - b.js < ismr_nlevels)
+                    ismr_factor = ISMR::GroupSize(ismr_nlevels, j - b.js);
+                if ((polar(bl) & 2) && b.je - j < ismr_nlevels)
+                    ismr_factor = ISMR::GroupSize(ismr_nlevels, b.je - j);
                 double courant_limit = 1.0;
 
-                double ndt_zone = courant_limit / (1 / (G.Dxc<1>(i) /  m::max(cmax(V1, k, j, i), cmin(V1, k, j, i))) +
-                                    1 / (G.Dxc<2>(j) /  m::max(cmax(V2, k, j, i), cmin(V2, k, j, i))) +
-                                    1 / (G.Dxc<3>(k) * ismr_factor /  m::max(cmax(V3, k, j, i), cmin(V3, k, j, i))));
+                double ndt_zone = courant_limit / (1 / (G.Dxc<1>(i) /  m::max(cmax(bl, V1, k, j, i), cmin(bl, V1, k, j, i))) +
+                                    1 / (G.Dxc<2>(j) /  m::max(cmax(bl, V2, k, j, i), cmin(bl, V2, k, j, i))) +
+                                    1 / (G.Dxc<3>(k) * ismr_factor /  m::max(cmax(bl, V3, k, j, i), cmin(bl, V3, k, j, i))));
 
-                if (!m::isnan(ndt_zone) && (ndt_zone < local_result)) {
+                if (!m::isnan(ndt_zone) && (ndt_zone < local_result) &&
+                    G.r(k, j, i) >= r_in && G.r(k, j, i) <= r_out) {
                     local_result = ndt_zone;
                 }
             }
-        , Kokkos::Min<double>(block_min_ndt));
-        if (block_min_ndt < min_ndt) min_ndt = block_min_ndt;
-        //std::cerr << "Got block timestep: " << block_min_ndt << std::endl;
+        , Kokkos::Min<double>(min_ndt));
     }
     //std::cerr << "Got min timestep: " << min_ndt << std::endl;
 
@@ -413,34 +513,199 @@ Real EstimateRadiativeTimestep(MeshData<Real> *md)
     return ndt;
 }
 
-AmrTag CheckRefinement(MeshBlockData<Real> *rc)
+/**
+ * Relative jump between values on either side of a zone
+ */
+KOKKOS_INLINE_FUNCTION Real rel_jump(const Real& qp, const Real& qm)
 {
-    auto pmb = rc->GetBlockPointer();
-    auto v = rc->Get("prims.rho").data;
+    return m::abs(qp - qm) / (m::abs(qp) + m::abs(qm) + SMALL);
+}
+
+/**
+ * Tag for a single zone: refine if any criterion is over its refine threshold, keep if any is over
+ * its derefine threshold, otherwise derefine
+ */
+KOKKOS_INLINE_FUNCTION int zone_refine_tag(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                           const RefinementCriteria& crit, const int& ndim,
+                                           const int& k, const int& j, const int& i)
+{
+    Real val[n_refine_criteria];
+    for (int c = 0; c < n_refine_criteria; ++c) val[c] = 0.;
+
+    // Differences are taken in each direction, keeping the largest
+    for (int dir = 1; dir <= ndim; ++dir) {
+        const int di = (dir == X1DIR), dj = (dir == X2DIR), dk = (dir == X3DIR);
+        const Real rho0 = P(m_p.RHO, k, j, i);
+        const Real rhop = P(m_p.RHO, k + dk, j + dj, i + di);
+        const Real rhom = P(m_p.RHO, k - dk, j - dj, i - di);
+        if (crit.use[grad_rho])
+            val[grad_rho] = m::max(val[grad_rho], rel_jump(rhop, rhom));
+        // Pressure is proportional to u, so its relative jump is the same
+        if (crit.use[grad_p])
+            val[grad_p] = m::max(val[grad_p], rel_jump(P(m_p.UU, k + dk, j + dj, i + di),
+                                                       P(m_p.UU, k - dk, j - dj, i - di)));
+        if (crit.use[current] && m_p.B1 >= 0) {
+            VLOOP if (v + 1 != dir)
+                val[current] = m::max(val[current], rel_jump(P(m_p.B1 + v, k + dk, j + dj, i + di),
+                                                             P(m_p.B1 + v, k - dk, j - dj, i - di)));
+        }
+        if (crit.use[lohner]) {
+            const Real num = m::abs(rhop - 2.*rho0 + rhom);
+            const Real den = m::abs(rhop - rho0) + m::abs(rho0 - rhom) +
+                             crit.lohner_filter * (m::abs(rhop) + 2.*m::abs(rho0) + m::abs(rhom));
+            val[lohner] = m::max(val[lohner], num / (den + SMALL));
+        }
+    }
+    if (crit.use[sigma] && m_p.B1 >= 0) {
+        FourVectors D;
+        calc_4vecs(G, P, m_p, k, j, i, Loci::center, D);
+        val[sigma] = dot(D.bcon, D.bcov) / P(m_p.RHO, k, j, i);
+    }
 
-    IndexDomain domain = IndexDomain::interior;
-    IndexRange ib = pmb->cellbounds.GetBoundsI(domain);
-    IndexRange jb = pmb->cellbounds.GetBoundsJ(domain);
-    IndexRange kb = pmb->cellbounds.GetBoundsK(domain);
+    int tag = -1;
+    for (int c = 0; c < n_refine_criteria; ++c) {
+        if (crit.use[c]) {
+            if (val[c] > crit.refine[c]) return 1;
+            if (val[c] > crit.derefine[c]) tag = 0;
+        }
+    }
+    return tag;
+}
 
-    typename Kokkos::MinMax<Real>::value_type minmax;
-    pmb->par_reduce("check_refinement", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int k, const int j, const int i,
-                      typename Kokkos::MinMax<Real>::value_type &lminmax) {
-        lminmax.min_val =
-            v(k, j, i) < lminmax.min_val ? v(k, j, i) : lminmax.min_val;
-        lminmax.max_val =
-            v(k, j, i) > lminmax.max_val ? v(k, j, i) : lminmax.max_val;
+/**
+ * Apply the RegridSchedule to the host copy of this pack's block tags
+ */
+void ScheduleRegrid(MeshData<Real> *md, int *tags)
+{
+    auto pmesh = md->GetMeshPointer();
+    auto& params = pmesh->packages.Get("GRMHD")->AllParams();
+    auto& schedule = *(params.GetMutable<RegridSchedule>("regrid_schedule"));
+    const int ncycle = pmesh->packages.Get("Globals")->Param<int>("ncycle");
+
+    // On the first pack of a new check, forget blocks which weren't present at the last one
+    if (ncycle != schedule.this_check) {
+        schedule.last_check = schedule.this_check;
+        schedule.this_check = ncycle;
+        for (auto it = schedule.history.begin(); it != schedule.history.end();) {
+            if (it->second.second < schedule.last_check) it = schedule.history.erase(it);
+            else ++it;
         }
-    , Kokkos::MinMax<Real>(minmax));
+    }
 
-    auto pkg = pmb->packages.Get("GRMHD");
-    const auto &refine_tol   = pkg->Param<Real>("refine_tol");
-    const auto &derefine_tol = pkg->Param<Real>("derefine_tol");
+    const int nblocks = md->NumBlocks();
+    int n_refine = 0, n_derefine = 0;
+    for (int bl = 0; bl < nblocks; ++bl) {
+        const auto& loc = md->GetBlockData(bl)->GetBlockPointer()->loc;
+        const auto key = std::make_tuple(loc.level(), loc.lx1(), loc.lx2(), loc.lx3());
+        // Blocks absent at the last check are new, even if a block once occupied the same location
+        if (!schedule.history.count(key) || schedule.history[key].second < schedule.last_check)
+            schedule.history[key] = std::make_pair(ncycle, ncycle);
+        schedule.history[key].second = ncycle;
+
+        if (tags[bl] < 0 && ncycle - schedule.history[key].first < schedule.min_block_lifetime) tags[bl] = 0;
+        if (tags[bl] > 0) n_refine++;
+        if (tags[bl] < 0) n_derefine++;
+    }
 
-    if (minmax.max_val - minmax.min_val > refine_tol) return AmrTag::refine;
-    if (minmax.max_val - minmax.min_val < derefine_tol) return AmrTag::derefine;
-    return AmrTag::same;
+    // Each derefined block does 1/2^ndim of its former work, at the cost of a regrid
+    if (n_derefine > 0) {
+        const Real saved = n_derefine * (1. - 1. / (1 << pmesh->ndim)) * schedule.regrid_horizon;
+        const Real cost = n_derefine * schedule.regrid_cost + ((n_refine > 0) ? 0. : schedule.regrid_cost_fixed * nblocks);
+        if (saved <= cost) {
+            for (int bl = 0; bl < nblocks; ++bl)
+                if (tags[bl] < 0) tags[bl] = 0;
+        }
+    }
+}
+
+void CheckRefinement(MeshData<Real> *md, ParArray1D<AmrTag> &amr_tags)
+{
+    Flag("CheckRefinement");
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const RefinementCriteria crit = pmb0->packages.Get("GRMHD")->Param<RefinementCriteria>("refinement_criteria");
+    const int ndim = pmesh->ndim;
+
+    PackIndexMap prims_map;
+    auto& P = md->PackVariables(PackFlags::Primitive(), prims_map);
+    const VarMap m_p(prims_map, false);
+    const int nblocks = P.GetDim(5);
+
+    bool any_zone_criteria = false;
+    for (int c = 0; c < n_refine_criteria; ++c) any_zone_criteria = any_zone_criteria || crit.use[c];
+
+    // Each row records its tag and density range to its block.  Only allocated when checking refinement
+    ParArray1D<int> block_tag("block_refine_tag", nblocks);
+    ParArray2D<Real> block_rho("block_refine_rho", nblocks, 2);
+    Kokkos::deep_copy(block_tag, -1);
+    auto block_rho_min = Kokkos::subview(block_rho.KokkosView(), Kokkos::ALL(), 0);
+    auto block_rho_max = Kokkos::subview(block_rho.KokkosView(), Kokkos::ALL(), 1);
+    Kokkos::deep_copy(block_rho_min, std::numeric_limits<Real>::max());
+    Kokkos::deep_copy(block_rho_max, std::numeric_limits<Real>::lowest());
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, nblocks - 1};
+    parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "check_refinement", pmb0->exec_space,
+        0, 0, block.s, block.e, b.ks, b.ke, b.js, b.je,
+        KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& bl, const int& k, const int& j) {
+            const auto& G = P.GetCoords(bl);
+            if (any_zone_criteria) {
+                int row_tag;
+                parthenon::par_reduce_inner(member, b.is, b.ie,
+                    [&](const int& i, int& local_result) {
+                        const int tag = zone_refine_tag(G, P(bl), m_p, crit, ndim, k, j, i);
+                        if (tag > local_result) local_result = tag;
+                    }
+                , Kokkos::Max<int>(row_tag));
+                Kokkos::single(Kokkos::PerTeam(member), [&]() {
+                    Kokkos::atomic_max(&block_tag(bl), row_tag);
+                });
+            }
+            if (crit.rho_spread) {
+                typename Kokkos::MinMax<Real>::value_type row_minmax;
+                parthenon::par_reduce_inner(member, b.is, b.ie,
+                    [&](const int& i, typename Kokkos::MinMax<Real>::value_type& lminmax) {
+                        const Real rho = P(bl, m_p.RHO, k, j, i);
+                        lminmax.min_val = rho < lminmax.min_val ? rho : lminmax.min_val;
+                        lminmax.max_val = rho > lminmax.max_val ? rho : lminmax.max_val;
+                    }
+                , Kokkos::MinMax<Real>(row_minmax));
+                Kokkos::single(Kokkos::PerTeam(member), [&]() {
+                    Kokkos::atomic_min(&block_rho(bl, 0), row_minmax.min_val);
+                    Kokkos::atomic_max(&block_rho(bl, 1), row_minmax.max_val);
+                });
+            }
+        }
+    );
+
+    // Combine the criteria
+    pmb0->par_for("combine_refinement", block.s, block.e,
+        KOKKOS_LAMBDA (const int& bl) {
+            // Any criterion can refine a block, but all must agree to derefine it
+            int tag = any_zone_criteria ? block_tag(bl) : (crit.rho_spread ? -1 : 0);
+            if (crit.rho_spread) {
+                const Real spread = block_rho(bl, 1) - block_rho(bl, 0);
+                tag = m::max(tag, (spread > crit.refine_tol) ? 1 : ((spread < crit.derefine_tol) ? -1 : 0));
+            }
+            block_tag(bl) = tag;
+        }
+    );
+
+    // Hold back any derefinement that wouldn't pay off
+    auto block_tag_h = block_tag.GetHostMirrorAndCopy();
+    ScheduleRegrid(md, block_tag_h.data());
+    block_tag.DeepCopy(block_tag_h);
+
+    // Combine with any other package's tags
+    pmb0->par_for("record_refinement", block.s, block.e,
+        KOKKOS_LAMBDA (const int& bl) {
+            const int tag = block_tag(bl);
+            const AmrTag amr_tag = (tag > 0) ? AmrTag::refine : ((tag < 0) ? AmrTag::derefine : AmrTag::same);
+            if (amr_tag > amr_tags(bl)) amr_tags(bl) = amr_tag;
+        }
+    );
+
+    EndFlag();
 }
 
 TaskStatus PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
@@ -456,13 +721,12 @@ TaskStatus PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
     if (extra_checks >= 2) {
         // Not sure when I'd do the check to hide latency, it's a step-end sort of deal
         // Just as well it's behind extra_checks 2
-        // This may happen while ch0-1 are in flight from floors, but ch2-4 are now reusable
-        Reductions::DomainReduction<Reductions::Var::neg_rho, int>(md, UserHistoryOperation::sum, 2);
-        Reductions::DomainReduction<Reductions::Var::neg_u, int>(md, UserHistoryOperation::sum, 3);
-        Reductions::DomainReduction<Reductions::Var::neg_rhout, int>(md, UserHistoryOperation::sum, 4);
-        int nless_rho = Reductions::Check<int>(md, 2);
-        int nless_u = Reductions::Check<int>(md, 3);
-        int nless_rhout = Reductions::Check<int>(md, 4);
+        Reductions::DomainReduction<Reductions::Var::neg_rho, int>(md, UserHistoryOperation::sum, Reductions::Channel::neg_rho);
+        Reductions::DomainReduction<Reductions::Var::neg_u, int>(md, UserHistoryOperation::sum, Reductions::Channel::neg_u);
+        Reductions::DomainReduction<Reductions::Var::neg_rhout, int>(md, UserHistoryOperation::sum, Reductions::Channel::neg_rhout);
+        int nless_rho = Reductions::Check<int>(md, Reductions::Channel::neg_rho);
+        int nless_u = Reductions::Check<int>(md, Reductions::Channel::neg_u);
+        int nless_rhout = Reductions::Check<int>(md, Reductions::Channel::neg_rhout);
 
         if (MPIRank0()) {
             if (nless_rhout > 0) {
@@ -627,26 +891,20 @@ void CancelBoundaryT3(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
 void UpdateAveragedCtop(MeshData<Real> *md)
 {
     auto pmesh = md->GetMeshPointer();
-    auto& params = pmesh->packages.Get<KHARMAPackage>("Boundaries")->AllParams();
+    const KBoundaries::BoundaryConfigs &config = KBoundaries::GetBoundaryConfigs(pmesh->packages);
     for (auto &pmb : pmesh->block_list) {
         auto &rc = pmb->meshblock_data.Get();
         for (int i = 0; i < BOUNDARY_NFACES; i++) {
             BoundaryFace bface = (BoundaryFace)i;
-            auto bname = KBoundaries::BoundaryName(bface);
+            const KBoundaries::BoundaryConfig &bconf = config[bface];
             const auto bdir = KBoundaries::BoundaryDirection(bface);
             const auto binner = KBoundaries::BoundaryIsInner(bface);
             const auto bdomain = KBoundaries::BoundaryDomain(bface);
 
             if (bdir > pmesh->ndim) continue;
 
-            bool b3_is_reconnected = (pmesh->packages.AllPackages().count("B_CT")) ?
-                                      params.Get<bool>("reconnect_B3_" + bname) :
-                                      false;
-
             // If we've modified values on the pole...
-            if (params.Get<bool>("cancel_T3_" + bname) ||
-                params.Get<bool>("cancel_U3_" + bname) ||
-                b3_is_reconnected) {
+            if (bconf.cancel_T3 || bconf.cancel_U3 || bconf.reconnect_B3) {
                 // ...and if this face of the block corresponds to a global boundary...
                 if (pmb->boundary_flag[bface] == BoundaryFlag::user) {
                     PackIndexMap prims_map, cons_map;
@@ -662,7 +920,7 @@ void UpdateAveragedCtop(MeshData<Real> *md)
 
                     // If we calculated the flux assuming half-size cells,
                     // we modify ctop rather than special-case in EstimateTimestep
-                    const bool half_cells = params.Get<bool>("excise_flux_" + bname);
+                    const bool half_cells = bconf.excise_flux;
 
                     // Recompute ctop in zones affected by averaging
                     IndexRange3 b = KDomain::GetRange(rc, bdomain);
@@ -691,13 +949,57 @@ void UpdateAveragedCtop(MeshData<Real> *md)
                         }
                     );
 
-                    if (params.Get<bool>("excise_flux_" + bname)) {
-
-                    }
                 }
             }
         }
     }
 }
 
+TaskStatus CacheFourVectors(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    if (!pmb0->packages.Get("GRMHD")->Param<bool>("cache_fourvectors")) return TaskStatus::complete;
+    Flag("CacheFourVectors");
+
+    static const std::vector<std::string> names_fourvec{"GRMHD.fourvectors"};
+    PackIndexMap prims_map;
+    const auto& P = md->PackVariables(PackFlags::Primitive(), prims_map);
+    auto C = md->PackVariables(names_fourvec);
+    const VarMap m_p(prims_map, false);
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, C.GetDim(5) - 1};
+    pmb0->par_for("cache_fourvectors", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            const auto& G = C.GetCoords(bl);
+            FourVectors D;
+            calc_4vecs(G, P(bl), m_p, k, j, i, Loci::center, D);
+            store_4vecs(D, k, j, i, C(bl));
+        }
+    );
+
+    *GetPartitionParam<std::pair<const MeshData<Real>*, std::vector<LogicalLocation>>>(md, "GRMHD", "fourvector_source")
+        = std::make_pair(md, PartitionLocations(md));
+    EndFlag();
+    return TaskStatus::complete;
+}
+
+void InvalidateFourVectors(MeshData<Real> *md)
+{
+    auto& params = md->GetMeshPointer()->packages.Get("GRMHD")->AllParams();
+    if (!params.Get<bool>("cache_fourvectors")) return;
+    auto *source = GetPartitionParam<std::pair<const MeshData<Real>*, std::vector<LogicalLocation>>>(md, "GRMHD", "fourvector_source");
+    if (source->first == md) source->first = nullptr;
+}
+
+bool UseCachedFourVectors(MeshData<Real> *md)
+{
+    auto& params = md->GetMeshPointer()->packages.Get("GRMHD")->AllParams();
+    if (!params.Get<bool>("cache_fourvectors")) return false;
+    auto *source = GetPartitionParam<std::pair<const MeshData<Real>*, std::vector<LogicalLocation>>>(md, "GRMHD", "fourvector_source");
+    if (source->first != md || source->second != PartitionLocations(md))
+        CacheFourVectors(md);
+    return true;
+}
+
 } // namespace GRMHD
@@ -36,6 +36,9 @@
 #include "decs.hpp"
 #include "types.hpp"
 
+#include <map>
+#include <tuple>
+
 /**
  * This physics package implements General-Relativistic Magnetohydrodynamics
  *
@@ -44,14 +47,58 @@
  * Many device-side functions related to GRMHD are implemented in grmhd_functions.hpp
  */
 namespace GRMHD {
+
+/**
+ * Criteria for tagging blocks for refinement, listed in <GRMHD> refine_criteria.
+ * Each is a zone value normalized to roughly [0,1], compared against <GRMHD> refine_<name>
+ * and derefine_<name>: a block is refined if any zone exceeds any refine threshold,
+ * and derefined only if every zone is under every derefine threshold.
+ *
+ * grad_rho, grad_p: relative jump in density or pressure across a zone, |q+ - q-| / (|q+| + |q-|)
+ * current: the same, for each magnetic field component transverse to the direction.  ~1 across current sheets
+ * sigma: magnetization b^2/rho.  Not normalized: refine above e.g. 1 to resolve jets
+ * lohner: Lohner's second-derivative error estimator in density, per-direction, filtered by lohner_filter
+ *
+ * The original criterion rho_spread compares the spread (max-min) of density over the whole block
+ * against refine_tol and derefine_tol.
+ */
+enum RefineCriterion{grad_rho=0, grad_p, current, sigma, lohner, n_refine_criteria};
+struct RefinementCriteria {
+    bool rho_spread;
+    Real refine_tol, derefine_tol;
+    bool use[n_refine_criteria];
+    Real refine[n_refine_criteria], derefine[n_refine_criteria];
+    Real lohner_filter;
+};
+
+/**
+ * Memory kept between refinement checks, to avoid regridding when it wouldn't pay off:
+ * 1. Blocks younger than min_block_lifetime cycles are never derefined.  Together with the band between
+ *    each criterion's refine and derefine thresholds, this stops blocks flipping back and forth.
+ * 2. Derefinement goes ahead only if the work it saves over the next regrid_horizon cycles outweighs the
+ *    cost of regridding, estimated in cycles of block work: regrid_cost per block changed, plus
+ *    regrid_cost_fixed per block in the pack for load balancing & rebuilds, unless some block is being refined
+ *    anyway.  Derefinements are thus batched until enough blocks want them.
+ * Parthenon's derefine_count additionally requires repeated derefine tags before acting on them.
+ */
+struct RegridSchedule {
+    int min_block_lifetime, regrid_horizon;
+    Real regrid_cost, regrid_cost_fixed;
+    // Cycles of this check and the last, to recognize blocks which were removed and re-created
+    int this_check, last_check;
+    // Cycle each block was created and last checked, by level and logical location
+    std::map<std::tuple<int, int64_t, int64_t, int64_t>, std::pair<int, int>> history;
+};
+
 // For declaring variables, as well as the full intermediates we need (right & left fluxes etc)
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
 /**
- * Returns the minimum CFL timestep among all zones in the block,
+ * Returns the minimum CFL timestep among all zones in the partition md,
  * multiplied by a proportion "cfl" for safety.
+ * This is computed in a single reduction over the partition's blocks.
  *
- * This is just for a particular MeshBlock/package, so don't rely on it
+ * This is just for a particular partition/package, so don't rely on it
  * Parthenon will take the minimum and put it in pmy_mesh->dt
  */
 Real EstimateTimestep(MeshData<Real> *md);
@@ -60,11 +107,11 @@ Real EstimateTimestep(MeshData<Real> *md);
 Real EstimateRadiativeTimestep(MeshData<Real> *md);
 
 /**
- * Return a tag per-block indicating whether to refine it
- * 
- * Criteria are very WIP
+ * Tag each block for refinement or derefinement according to the RefinementCriteria above.
+ * All criteria are evaluated for all blocks in a single kernel launch over the pack,
+ * and each tag is combined (as its max) into amr_tags.
  */
-AmrTag CheckRefinement(MeshBlockData<Real> *rc);
+void CheckRefinement(MeshData<Real> *md, ParArray1D<AmrTag> &amr_tags);
 
 /**
  * Fill fields which are calculated only for output to file
@@ -95,4 +142,24 @@ void CancelBoundaryT3(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse);
  */
 void UpdateAveragedCtop(MeshData<Real> *md);
 
+/**
+ * Optional cache of the cell-centered FourVectors (ucon, ucov, bcon, bcov), with <GRMHD>cache_fourvectors.
+ * Costs 16 values per zone, and saves recomputing them in the geometric source term (including
+ * FOFC's guess).  Each partition's cache records which container it was computed from, and is
+ * invalidated when that container's primitives change (inversion, floors, fixups, primitive sources).
+ *
+ * CacheFourVectors computes it over the entire domain, and is run by the drivers once the
+ * primitives are final at the end of each substep.
+ */
+TaskStatus CacheFourVectors(MeshData<Real> *md);
+/**
+ * Mark the cache stale, if it was computed from md
+ */
+void InvalidateFourVectors(MeshData<Real> *md);
+/**
+ * Whether to read FourVectors for md from the cache, computing it first if it is stale.
+ * False if the cache is disabled
+ */
+bool UseCachedFourVectors(MeshData<Real> *md);
+
 }
@@ -244,6 +244,30 @@ KOKKOS_INLINE_FUNCTION void calc_4vecs(const GRCoordinates& G, const Local& P, c
         DLOOP1 D.bcon[mu] = D.bcov[mu] = 0.;
     }
 }
+/**
+ * Load or store FourVectors from/to the cell-centered cache GRMHD.fourvectors,
+ * laid out as ucon, ucov, bcon, bcov.  See GRMHD::CacheFourVectors
+ */
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void load_4vecs(const Global& C, const int& k, const int& j, const int& i, FourVectors& D)
+{
+    DLOOP1 {
+        D.ucon[mu] = C(mu, k, j, i);
+        D.ucov[mu] = C(GR_DIM + mu, k, j, i);
+        D.bcon[mu] = C(2*GR_DIM + mu, k, j, i);
+        D.bcov[mu] = C(3*GR_DIM + mu, k, j, i);
+    }
+}
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void store_4vecs(const FourVectors& D, const int& k, const int& j, const int& i, const Global& C)
+{
+    DLOOP1 {
+        C(mu, k, j, i)            = D.ucon[mu];
+        C(GR_DIM + mu, k, j, i)   = D.ucov[mu];
+        C(2*GR_DIM + mu, k, j, i) = D.bcon[mu];
+        C(3*GR_DIM + mu, k, j, i) = D.bcov[mu];
+    }
+}
 /**
  * Just the velocity 4-vector, in the first two styles of calc_4vecs.  For various corners.
  */
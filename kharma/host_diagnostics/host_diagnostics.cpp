@@ -0,0 +1,247 @@
+/* 
+ *  File: host_diagnostics.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "host_diagnostics.hpp"
+
+#include "domain.hpp"
+#include "output_staging.hpp"
+#include "reductions.hpp"
+
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+// The thread summing the most recently staged diagnostics.  It reads from the staging buffers,
+// which are reused, and writes 'sums', so it must be joined before either is touched
+std::thread summer;
+std::vector<double> sums;
+// Time & step of the diagnostics being summed, if any
+bool pending = false;
+double pending_time = 0.;
+int pending_ncycle = 0;
+// References to the host buffers the thread reads, so that releasing the staging buffers
+// (e.g. from another package's PostExecute) can't free them from under it
+using HeldSpace = std::conditional_t<OutputStaging::unified, DevMemSpace, OutputStaging::HostStagingSpace>;
+Kokkos::View<Real*, HeldSpace> held, held_phi;
+
+/**
+ * Run fn(n) for n in [0, count), on the host cores if they aren't the device
+ */
+template<typename Function>
+void ForHost(const int count, Function fn)
+{
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP) || defined(KOKKOS_ENABLE_SYCL)
+    Kokkos::parallel_for("host_diagnostics", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, count), fn);
+    Kokkos::DefaultHostExecutionSpace().fence();
+#else
+    for (int n = 0; n < count; ++n) fn(n);
+#endif
+}
+
+/**
+ * Sum the staged data, from the background thread.  'data' holds nvar variables of n1*n2*n3 zones
+ * for each of nblocks blocks, weighted by the zone volumes dV, and 'phi' the nlayer*n2*n3 values
+ * of B1 at the horizon, weighted by dA.  No Flag() calls here, as the region timers are not thread-safe
+ */
+void Sum(const Real *data, const int nblocks, const int nvar, const int n1, const int n2, const int n3,
+         const std::vector<double> dV, const Real *phi, const int nlayer, const std::vector<double> dA)
+{
+    // One partial sum per row of zones, then one serial pass over the rows
+    const int nrows = nblocks * nvar * n3 * n2;
+    std::vector<double> rows(nrows + nlayer * n3, 0.);
+    ForHost(nrows, [&](const int& r) {
+        const Real *row = data + (size_t) r * n1;
+        double s = 0.;
+        for (int i = 0; i < n1; ++i) s += row[i];
+        rows[r] = s * dV[r / (nvar * n3 * n2)];
+    });
+    ForHost(nlayer * n3, [&](const int& r) {
+        const Real *row = phi + (size_t) r * n2;
+        double s = 0.;
+        for (int j = 0; j < n2; ++j) s += m::abs(row[j]);
+        rows[nrows + r] = 0.5 * s * dA[r / n3];
+    });
+
+    std::vector<double> result(nvar + 1, 0.);
+    for (int r = 0; r < nrows; ++r) result[(r / (n3 * n2)) % nvar] += rows[r];
+    for (int r = 0; r < nlayer * n3; ++r) result[nvar] += rows[nrows + r];
+    sums = result;
+}
+
+/**
+ * Wait for the last diagnostics, reduce them over ranks and write them from rank 0
+ */
+void Finish(Mesh *pmesh)
+{
+    if (summer.joinable()) {
+        Flag("HostDiagnosticsWait");
+        summer.join();
+        EndFlag();
+    }
+    if (!pending) return;
+    pending = false;
+
+    auto& params = pmesh->packages.Get("HostDiagnostics")->AllParams();
+    std::vector<double> total(sums.size(), 0.);
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Reduce(sums.data(), total.data(), sums.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+#else
+    total = sums;
+#endif
+    if (MPIRank0()) {
+        const bool use_phi = params.Get<bool>("phi");
+        FILE *f = fopen(params.Get<std::string>("fname").c_str(), "a");
+        if (ftell(f) == 0)
+            fprintf(f, "# time ncycle Mass Egas X1_Mom X2_Mom Ang_Mom%s\n", use_phi ? " Phi_EH" : "");
+        fprintf(f, "%.17g %d", pending_time, pending_ncycle);
+        for (int v = 0; v < total.size() - (use_phi ? 0 : 1); ++v) fprintf(f, " %.17g", total[v]);
+        fprintf(f, "\n");
+        fclose(f);
+    }
+}
+
+} // namespace
+
+std::shared_ptr<KHARMAPackage> HostDiagnostics::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("HostDiagnostics");
+    Params &params = pkg->AllParams();
+
+    // Cadence in simulation time.  The next diagnostics are due at the next multiple of dt
+    const Real dt = pin->GetReal("host_diagnostics", "dt");
+    if (dt <= 0.) throw std::invalid_argument("Host diagnostics require host_diagnostics/dt > 0!");
+    params.Add("dt", dt);
+    const Real tstart = pin->GetOrAddReal("parthenon/time", "start_time", 0.);
+    params.Add("next_time", (Real) (m::floor(tstart / dt) + 1) * dt, true);
+
+    // Magnetic flux through the horizon, as Phi_EH in the history file
+    const bool use_phi = packages->AllPackages().count("B_CT") || packages->AllPackages().count("B_FluxCT")
+                         || packages->AllPackages().count("B_CD");
+    params.Add("phi", use_phi && pin->GetBoolean("coordinates", "domain_intersects_eh"));
+
+    params.Add("fname", pin->GetString("parthenon/job", "problem_id") + ".hostdiag.txt");
+
+    pkg->PostStepWork = HostDiagnostics::Stage;
+    pkg->PostExecute = HostDiagnostics::PostExecute;
+
+    return pkg;
+}
+
+void HostDiagnostics::Stage(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    auto& params = pmesh->packages.Get("HostDiagnostics")->AllParams();
+    // Parthenon advances tm.time only after PostStepWork, so this is the time after the step
+    const Real t = tm.time + tm.dt;
+    Real *next_time = params.GetMutable<Real>("next_time");
+    if (t < *next_time) return;
+    Flag("HostDiagnosticsStage");
+
+    const Real dt = params.Get<Real>("dt");
+    while (*next_time <= t) *next_time += dt;
+
+    // The last diagnostics must be finished before we reuse their buffers
+    Finish(pmesh);
+
+    auto md = pmesh->mesh_data.Get().get();
+    auto U = md->PackVariables(std::vector<std::string>{"cons.rho", "cons.u", "cons.uvec"});
+    const int nvar = U.GetDim(4);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const int n1 = b.ie - b.is + 1, n2 = b.je - b.js + 1, n3 = b.ke - b.ks + 1;
+    const int nblocks = md->NumBlocks();
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    // Gather conserved variables of the interior, in [block][variable][k][j][i] order
+    const size_t size = (size_t) nblocks * nvar * n3 * n2 * n1;
+    const auto staging = OutputStaging::DeviceBuffer<Real>("host_diagnostics", size);
+    pmb0->par_for("host_diagnostics_stage", 0, nblocks-1, 0, nvar-1, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &v, const int &k, const int &j, const int &i) {
+            staging(((((size_t) bl * nvar + v) * n3 + k - b.ks) * n2 + j - b.js) * n1 + i - b.is) = U(bl, v, k, j, i);
+        }
+    );
+
+    // B1 over the first layer of zones outside the horizon, [layer][k][j]
+    Reductions::ShellLayers layers;
+    if (params.Get<bool>("phi") &&
+        !Reductions::GetShellLayers(md, {pmb0->coords.coords.get_horizon()}, layers))
+        layers.n = 0;
+    const int nlayer = layers.n;
+    const auto staging_phi = OutputStaging::DeviceBuffer<Real>("host_diagnostics_phi", (size_t) nlayer * n3 * n2);
+    if (nlayer > 0) {
+        const auto B = md->PackVariables(std::vector<std::string>{"cons.B"});
+        const auto layer_block = layers.block;
+        const auto layer_i = layers.i;
+        pmb0->par_for("host_diagnostics_stage_phi", 0, nlayer-1, b.ks, b.ke, b.js, b.je,
+            KOKKOS_LAMBDA (const int &l, const int &k, const int &j) {
+                staging_phi(((size_t) l * n3 + k - b.ks) * n2 + j - b.js) = B(layer_block(l), V1, k, j, layer_i(l));
+            }
+        );
+    }
+
+    // Copy to the host, if we must.  This is the only part the step loop waits on
+    const auto host = OutputStaging::ToHost<Real>("host_diagnostics", size);
+    const auto host_phi = OutputStaging::ToHost<Real>("host_diagnostics_phi", (size_t) nlayer * n3 * n2);
+    held = OutputStaging::Reserve<Real, HeldSpace>("host_diagnostics", m::max(size, (size_t) 1));
+    held_phi = OutputStaging::Reserve<Real, HeldSpace>("host_diagnostics_phi", m::max((size_t) nlayer * n3 * n2, (size_t) 1));
+
+    // Zone volumes & horizon areas in native coordinates, constant over each block
+    std::vector<double> dV(nblocks), dA(nlayer);
+    for (int bl = 0; bl < nblocks; bl++) {
+        const auto& G = md->GetBlockData(bl)->GetBlockPointer()->coords;
+        dV[bl] = G.Dxc<1>(b.is) * G.Dxc<2>(b.js) * G.Dxc<3>(b.ks);
+    }
+    if (nlayer > 0) {
+        auto layer_block_h = layers.block.GetHostMirrorAndCopy();
+        for (int l = 0; l < nlayer; l++) {
+            const auto& G = md->GetBlockData(layer_block_h(l))->GetBlockPointer()->coords;
+            dA[l] = G.Dxc<2>(b.js) * G.Dxc<3>(b.ks);
+        }
+    }
+
+    pending = true;
+    pending_time = t;
+    pending_ncycle = tm.ncycle + 1;
+    summer = std::thread(Sum, host.data(), nblocks, nvar, n1, n2, n3, dV, host_phi.data(), nlayer, dA);
+
+    EndFlag();
+}
+
+void HostDiagnostics::PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    Finish(pmesh);
+    // Release the staging buffers before Kokkos is finalized
+    held = decltype(held)();
+    held_phi = decltype(held_phi)();
+    OutputStaging::Release();
+}
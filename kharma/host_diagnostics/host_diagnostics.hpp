@@ -0,0 +1,73 @@
+/* 
+ *  File: host_diagnostics.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Diagnostics computed on the host cores, in parallel with the next steps on the device.
+ *
+ * Every <host_diagnostics>dt in simulation time, after the step, the conserved variables of each local
+ * block's interior are gathered into a staging buffer and copied to (pinned) host memory.  A background
+ * thread then sums them on Kokkos' default host execution space while the device carries on stepping,
+ * giving the same quantities as the "conserved_vars" history entries, along with Phi_EH when there is a
+ * magnetic field and the domain includes the event horizon:
+ *     time ncycle Mass Egas X1_Mom X2_Mom Ang_Mom [Phi_EH]
+ * Each rank's sums are reduced just before the next diagnostics are staged, and rank 0 appends them to
+ * <problem_id>.hostdiag.txt.  These can then be removed from the history output, keeping their
+ * reductions off the device.
+ *
+ * Fields filled for Parthenon's outputs (UserWorkBeforeOutput) are still computed on the device, since the
+ * writers read them from there.  In CPU builds, where the host cores are the device, the sums run on the
+ * background thread alone.
+ */
+namespace HostDiagnostics {
+
+/**
+ * Initialize the package, with the cadence of the diagnostics
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Write any finished diagnostics, then stage & start the next if due.  Registered as PostStepWork
+ */
+void Stage(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+/**
+ * Finish & write the last diagnostics before exiting
+ */
+void PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+}
@@ -40,90 +40,128 @@
 
 #define NFVAR_MAX 10
 
+int Implicit::ListFailedZones(MeshData<Real> *md)
+{
+    auto solve_fail = md->PackVariables(std::vector<std::string>{"solve_fail"});
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+    const int nzones = solve_fail.GetDim(5) * nk * nj * ni;
+
+    // Compact the failed zones, growing the list if it overflows
+    auto *failed_list_p = GetPartitionParam<ParArray1D<int>>(md, "Implicit", "failed_list");
+    if (failed_list_p->extent_int(0) == 0) *failed_list_p = ParArray1D<int>("failed_list", 1024);
+    int nlist = 0;
+    bool fits = false;
+    while (!fits) {
+        const auto failed_list = *failed_list_p;
+        const int capacity = failed_list.extent_int(0);
+        Kokkos::parallel_scan("list_failed_solves", Kokkos::RangePolicy<>(DevExecSpace(), 0, nzones),
+            KOKKOS_LAMBDA (const int &n, int &idx, const bool &final) {
+                const int i = b.is + n % ni;
+                const int j = b.js + (n / ni) % nj;
+                const int k = b.ks + (n / (ni*nj)) % nk;
+                const int bl = n / (ni*nj*nk);
+                if (failed(solve_fail(bl, 0, k, j, i))) {
+                    if (final && idx < capacity) failed_list(idx) = n;
+                    ++idx;
+                }
+            }
+        , nlist);
+        fits = (nlist <= capacity);
+        if (!fits) Kokkos::resize(*failed_list_p, 2 * nlist);
+    }
+    return nlist;
+}
+
 // TODO(BSP) should merge this with FixUtoP by generalizing that
-TaskStatus Implicit::FixSolve(MeshBlockData<Real> *mbd) {
+TaskStatus Implicit::MeshFixSolve(MeshData<Real> *md) {
+
+    Flag("MeshFixSolve");
+    // Find the failed zones.  Usually there are none, and we're done
+    const int nlist = ListFailedZones(md);
+    if (nlist == 0) {
+        EndFlag();
+        return TaskStatus::complete;
+    }
 
-    Flag("FixSolve");
-    // Get MeshBlock pointer and obtain flag for primitives
-    auto pmb = mbd->GetBlockPointer();
+    auto pmesh = md->GetMeshPointer();
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
 
     // Get number of implicit variables
     PackIndexMap implicit_prims_map;
-    auto implicit_vars = Implicit::GetOrderedNames(mbd, Metadata::GetUserFlag("Primitive"), true);
-    auto& P            = mbd->PackVariables(implicit_vars, implicit_prims_map);
+    auto implicit_vars = Implicit::GetOrderedNames(md->GetBlockData(0).get(), Metadata::GetUserFlag("Primitive"), true);
+    auto& P            = md->PackVariables(implicit_vars, implicit_prims_map);
     const int nfvar    = P.GetDim(4);
 
+    // Since floors were applied earlier, we assume the zones obtained by averaging the neighbors also respect the floors.
+    // So we compute new conserved variables for each zone as we go
+    PackIndexMap prims_map, cons_map;
+    auto& P_all = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    auto& U_all = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+
+    auto solve_fail = md->PackVariables(std::vector<std::string>{"solve_fail"});
+
     // Since we're after sync, we run over the entire domain
-    const IndexRange3 b = KDomain::GetRange(mbd, IndexDomain::entire);
-    const auto& G = pmb->coords;
-
-    GridScalar solve_fail = mbd->Get("solve_fail").data;
-
-    const Real gam    = pmb->packages.Get("GRMHD")->Param<Real>("gamma");
-    const int flag_verbose = pmb->packages.Get("Globals")->Param<int>("flag_verbose");
-
-    pmb->par_for("fix_solver_failures", b.ks, b.ke, b.js, b.je, b.is, b.ie,
-        KOKKOS_LAMBDA (const int& k, const int& j, const int& i) {
-            // Fix only bad zones
-            // Remember "failed" here has a different implementation
-            if (failed(solve_fail(k, j, i))) {
-                //printf("Fixing zone %d %d %d!\n", i, j, k);
-                double wsum = 0., wsum_x = 0.;
-                double sum[NFVAR_MAX] = {0.}, sum_x[NFVAR_MAX] = {0.};
-                // For all neighboring cells...
-                for (int n = -1; n <= 1; n++) {
-                    for (int m = -1; m <= 1; m++) {
-                        for (int l = -1; l <= 1; l++) {
-                            int ii = i + l, jj = j + m, kk = k + n;
-                            // If we haven't overstepped array bounds...
-                            if (KDomain::inside(kk, jj, ii, b)) {
-                                // Weight by distance
-                                // TODO abs(l) == l*l always?
-                                double w = 1./(m::abs(l) + m::abs(m) + m::abs(n) + 1);
-
-                                // Count only the good cells, if we can
-                                if (!failed(solve_fail(kk, jj, ii))) {
-                                    // Weight by distance.  Note interpolated "fixed" cells stay flagged
-                                    wsum += w;
-                                    FLOOP sum[ip] += w * P(ip, kk, jj, ii);
-                                }
-                                // Just in case, keep a sum of even the bad ones
-                                wsum_x += w;
-                                FLOOP sum_x[ip] += w * P(ip, kk, jj, ii);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+    const auto failed_list = *GetPartitionParam<ParArray1D<int>>(md, "Implicit", "failed_list");
+
+    const Real gam    = pmesh->packages.Get("GRMHD")->Param<Real>("gamma");
+    const int flag_verbose = pmesh->packages.Get("Globals")->Param<int>("flag_verbose");
+    // Need emhd_params object
+    const EMHD::EMHD_parameters emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
+
+    pmb0->par_for("fix_solver_failures", 0, nlist - 1,
+        KOKKOS_LAMBDA (const int& q) {
+            const int z = failed_list(q);
+            const int i = b.is + z % ni;
+            const int j = b.js + (z / ni) % nj;
+            const int k = b.ks + (z / (ni*nj)) % nk;
+            const int bl = z / (ni*nj*nk);
+            const auto& G = P_all.GetCoords(bl);
+
+            //printf("Fixing zone %d %d %d!\n", i, j, k);
+            double wsum = 0., wsum_x = 0.;
+            double sum[NFVAR_MAX] = {0.}, sum_x[NFVAR_MAX] = {0.};
+            // For all neighboring cells...
+            for (int n = -1; n <= 1; n++) {
+                for (int m = -1; m <= 1; m++) {
+                    for (int l = -1; l <= 1; l++) {
+                        int ii = i + l, jj = j + m, kk = k + n;
+                        // If we haven't overstepped array bounds...
+                        if (KDomain::inside(kk, jj, ii, b)) {
+                            // Weight by distance
+                            // TODO abs(l) == l*l always?
+                            double w = 1./(m::abs(l) + m::abs(m) + m::abs(n) + 1);
+
+                            // Count only the good cells, if we can
+                            if (!failed(solve_fail(bl, 0, kk, jj, ii))) {
+                                // Weight by distance.  Note interpolated "fixed" cells stay flagged
+                                wsum += w;
+                                FLOOP sum[ip] += w * P(bl, ip, kk, jj, ii);
                             }
+                            // Just in case, keep a sum of even the bad ones
+                            wsum_x += w;
+                            FLOOP sum_x[ip] += w * P(bl, ip, kk, jj, ii);
                         }
                     }
                 }
+            }
 
-                if(wsum < 1.e-10) {
-                    // TODO probably should crash here.
+            if(wsum < 1.e-10) {
+                // TODO probably should crash here.
 #ifndef KOKKOS_ENABLE_SYCL
-                    if (flag_verbose >= 3) // && KDomain::inside(k, j, i, kb_b, jb_b, ib_b)) // If an interior zone...
-                        printf("No neighbors were available at %d %d %d!\n", i, j, k);
+                if (flag_verbose >= 3) // && KDomain::inside(k, j, i, kb_b, jb_b, ib_b)) // If an interior zone...
+                    printf("No neighbors were available at %d %d %d!\n", i, j, k);
 #endif
-                    FLOOP P(ip, k, j, i) = sum_x[ip]/wsum_x;
-                } else {
-                    FLOOP P(ip, k, j, i) = sum[ip]/wsum;
-                }
+                FLOOP P(bl, ip, k, j, i) = sum_x[ip]/wsum_x;
+            } else {
+                FLOOP P(bl, ip, k, j, i) = sum[ip]/wsum;
             }
-        }
-    );
-
-    // Since floors were applied earlier, we assume the zones obtained by averaging the neighbors also respect the floors.
-    // Compute new conserved variables
-    // TODO encapsulate version from FixUtoP & try calling whole thing here?
-    PackIndexMap prims_map, cons_map;
-    auto& P_all = mbd->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
-    auto& U_all = mbd->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
-    const VarMap m_u(cons_map, true), m_p(prims_map, false);
-
-    // Need emhd_params object
-    const EMHD::EMHD_parameters emhd_params = EMHD::GetEMHDParameters(pmb->packages);
 
-    pmb->par_for("fix_solver_failures_PtoU", b.ks, b.ke, b.js, b.je, b.is, b.ie,
-        KOKKOS_LAMBDA (const int& k, const int& j, const int& i) {
-            if (failed(solve_fail(k, j, i)))
-                Flux::p_to_u(G, P_all, m_p, emhd_params, gam, k, j, i, U_all, m_u);
+            Flux::p_to_u(G, P_all(bl), m_p, emhd_params, gam, k, j, i, U_all(bl), m_u);
         }
     );
 
@@ -33,7 +33,10 @@
  */
 
 #include "implicit.hpp"
+#include "implicit_jacobian.hpp"
 
+#include "boundaries.hpp"
+#include "domain.hpp"
 #include "grmhd.hpp"
 #include "grmhd_functions.hpp"
 #include "kharma.hpp"
@@ -49,7 +52,9 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
 { throw std::runtime_error("KHARMA was compiled without implicit stepping support!"); }
 // We still need a stub for Step() in order to compile, but it will never be called
 TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_sub_step_init, MeshData<Real> *md_flux_src,
-                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt) {}
+                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt,
+                Implicit::SolveRegion region) {}
+TaskStatus Implicit::CopyBulk(MeshData<Real> *md_solver, MeshData<Real> *md_final) { return TaskStatus::complete; }
 
 #else
 
@@ -61,6 +66,15 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
 #include <KokkosBatched_Trsv_Decl.hpp>
 #include <KokkosBatched_ApplyPivot_Decl.hpp>
 
+namespace {
+// Names for the packs taken in every solve, so they need not be rebuilt on each call
+const std::vector<std::string> names_solve_norm{"solve_norm"}, names_solve_fail{"solve_fail"};
+const std::vector<std::string> names_solve_iters{"solve_iters"}, names_solve_tol{"solve_tol"};
+const std::vector<std::string> names_jacobian{"Implicit.jacobian"}, names_delta_prim{"Implicit.delta_prim"};
+const std::vector<std::string> names_residual{"Implicit.residual"}, names_dU_implicit{"Implicit.dU_implicit"};
+const std::vector<std::string> names_closure{"Implicit.closure"};
+} // namespace
+
 std::vector<std::string> Implicit::GetOrderedNames(MeshBlockData<Real> *rc, const MetadataFlag& flag, bool only_implicit)
 {
     auto pmb0 = rc->GetBlockPointer();
@@ -96,10 +110,21 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
     pin->SetString("parthenon/time", "integrator", "vl2");
 
     // Implicit solver parameters
-    Real jacobian_delta = pin->GetOrAddReal("implicit", "jacobian_delta", 4.e-8);
+    // Finite-difference steps need to stay above ~sqrt(epsilon), notably in single precision
+    Real jacobian_delta = pin->GetOrAddReal("implicit", "jacobian_delta",
+                                            std::max(4.e-8, std::sqrt((double) std::numeric_limits<Real>::epsilon())));
     params.Add("jacobian_delta", jacobian_delta);
-    Real rootfind_tol = pin->GetOrAddReal("implicit", "rootfind_tol", 1.e-12);
+    // Differentiate the residual exactly with dual numbers, rather than by finite differences.
+    // Only available for systems of the GRMHD & EMHD variables, otherwise finite differences are used
+    bool analytic_jacobian = pin->GetOrAddBoolean("implicit", "analytic_jacobian", false);
+    params.Add("analytic_jacobian", analytic_jacobian);
+    Real rootfind_tol = pin->GetOrAddReal("implicit", "rootfind_tol", PrecisionTolerance(1.e-12));
     params.Add("rootfind_tol", rootfind_tol);
+    // If nonzero, each zone has converged when its residual is below adaptive_tol times the size of its
+    // explicit update (the flux divergence & sources), or rootfind_tol, whichever is larger.
+    // There's little point solving much more accurately than the explicit part of the step.
+    Real adaptive_tol = pin->GetOrAddReal("implicit", "adaptive_tol", 0.0);
+    params.Add("adaptive_tol", adaptive_tol);
     int min_nonlinear_iter = pin->GetOrAddInteger("implicit", "min_nonlinear_iter", 1);
     params.Add("min_nonlinear_iter", min_nonlinear_iter);
     int max_nonlinear_iter = pin->GetOrAddInteger("implicit", "max_nonlinear_iter", 3);
@@ -108,6 +133,28 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
     // The alternative LU decomposition does not, and should mostly be used for debugging.
     bool use_qr = pin->GetOrAddBoolean("implicit", "use_qr", true);
     params.Add("use_qr", use_qr);
+    // Solve common system sizes (5, 7 or 8 implicit variables) with a fixed-size, register-resident
+    // LU decomposition, one zone per thread, instead of the scratch-based solvers above
+    bool batched_solve = pin->GetOrAddBoolean("implicit", "batched_solve", false);
+    params.Add("batched_solve", batched_solve);
+    // Alternatively, never form the Jacobian: solve each Newton step by GMRES, with Jacobian-vector
+    // products from finite differences of the residual.  Cheaper than the dense solves for large systems.
+    bool jacobian_free = pin->GetOrAddBoolean("implicit", "jacobian_free", false);
+    params.Add("jacobian_free", jacobian_free);
+    int krylov_max_iter = pin->GetOrAddInteger("implicit", "krylov_max_iter", MAX_VARS);
+    params.Add("krylov_max_iter", krylov_max_iter);
+    Real krylov_tol = pin->GetOrAddReal("implicit", "krylov_tol", PrecisionTolerance(1.e-8));
+    params.Add("krylov_tol", krylov_tol);
+    // After each iteration, compact the zones which have yet to converge into a list, and iterate only those.
+    // Converged zones then keep their solution, rather than iterating until every zone has converged.
+    bool compact_active = pin->GetOrAddBoolean("implicit", "compact_active", false);
+    params.Add("compact_active", compact_active);
+    // These lists and the solver workspace are kept per-partition, see GetPartitionParam
+    params.Add("active_list", std::map<int, ParArray1D<int>>(), true);
+    // Zones where the solver failed, for FixSolve
+    params.Add("failed_list", std::map<int, ParArray1D<int>>(), true);
+    // Workspace for the linear solves, sized on first use
+    params.Add("solver_workspace", std::map<int, SolverWorkspace>(), true);
 
     bool linesearch = pin->GetOrAddBoolean("implicit", "linesearch", true);
     params.Add("linesearch", linesearch);
@@ -118,6 +165,11 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
     Real linesearch_lambda = pin->GetOrAddReal("implicit", "linesearch_lambda", 1.0);
     params.Add("linesearch_lambda", linesearch_lambda);
 
+    // Print iteration counts, the fraction of zones with each status, and rough throughput after each solve.
+    // The time in each part of the solver is separately recorded by Kokkos tools, see scripts/read_performance_json.py
+    bool report_performance = pin->GetOrAddBoolean("implicit", "report_performance", false);
+    params.Add("report_performance", report_performance);
+
     // Allocate the Jacobian and step so we can split the solver kernel
     int nvars_implicit = KHARMA::PackDimension(packages.get(), Metadata::GetUserFlag("Implicit"));
     int nvars_explicit = KHARMA::PackDimension(packages.get(), Metadata::GetUserFlag("Explicit"));
@@ -133,11 +185,20 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
     // We also need to carry around the implicit sources
     m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, s_vars_all);
     pkg->AddField("Implicit.dU_implicit", m);
+    // And the EMHD closure coefficients tau, chi_e, nu_e, and the old-time terms of the
+    // time-derivative sources, which are fixed over each substep.  See ClosureIdx
+    std::vector<int> s_closure({ClosureIdx::n});
+    m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, s_closure);
+    pkg->AddField("Implicit.closure", m);
 
     // Allocate additional fields that reflect the success of the solver
     // L2 norm of the residual
     Metadata m_real = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
     pkg->AddField("solve_norm", m_real);
+    // Number of iterations each zone took in the last solve
+    pkg->AddField("solve_iters", m_real);
+    // Per-zone tolerance, with adaptive_tol
+    pkg->AddField("solve_tol", m_real);
     // Integer field that saves where the solver fails (rho + drho < 0 || u + du < 0)
     m_real = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy, Metadata::FillGhost});
     pkg->AddField("solve_fail", m_real); // TODO: Replace with m_int once Integer is supported for CellVariable
@@ -145,6 +206,9 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
     // The major call, to Step(), is done manually from the ImEx driver
     // But, we just register the diagnostics function to print out solver failures
     pkg->PostStepDiagnosticsMesh = Implicit::PostStepDiagnostics;
+    // Counts of solver flags taken at the end of each solve, per mesh partition, for diagnostics
+    params.Add("solve_fail_values", Reductions::FlagValueList(Implicit::status_names));
+    params.Add("solve_fail_counts", std::map<int, std::vector<int>>(), true);
 
     // List (vector) of HistoryOutputVars that will all be enrolled as output variables
     parthenon::HstVar_list hst_vars = {};
@@ -157,7 +221,8 @@ std::shared_ptr<KHARMAPackage> Implicit::Initialize(ParameterInput *pin, std::sh
 }
 
 TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_sub_step_init, MeshData<Real> *md_flux_src,
-                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt)
+                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt,
+                SolveRegion region)
 {
     Flag("Implicit::Step");
     // Pull out the block pointers for each sub-step, as we need the *mutable parameters*
@@ -173,7 +238,15 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     const int iter_max       = implicit_par.Get<int>("max_nonlinear_iter");
     const Real delta         = implicit_par.Get<Real>("jacobian_delta");
     const Real rootfind_tol  = implicit_par.Get<Real>("rootfind_tol");
+    const Real adaptive_tol  = implicit_par.Get<Real>("adaptive_tol");
     const bool use_qr        = implicit_par.Get<bool>("use_qr");
+    const bool batched_solve = implicit_par.Get<bool>("batched_solve");
+    const bool analytic_jacobian = implicit_par.Get<bool>("analytic_jacobian");
+    const bool compact_active = implicit_par.Get<bool>("compact_active");
+    const bool jacobian_free = implicit_par.Get<bool>("jacobian_free");
+    const int krylov_max_iter = implicit_par.Get<int>("krylov_max_iter");
+    const Real krylov_tol = implicit_par.Get<Real>("krylov_tol");
+    const bool report_performance = implicit_par.Get<bool>("report_performance");
     const auto& globals      = pmb_full_step_init->packages.Get("Globals")->AllParams();
     const int verbose        = globals.Get<int>("verbose");
     const int flag_verbose   = globals.Get<int>("flag_verbose");
@@ -206,8 +279,9 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     // just the residual & Jacobian we care about, which makes the solve faster.
     auto& mbd_full_step_init  = md_full_step_init->GetBlockData(0); // MeshBlockData object, more member functions
     
-    auto ordered_prims = GetOrderedNames(mbd_full_step_init.get(), Metadata::GetUserFlag("Primitive"));
-    auto ordered_cons  = GetOrderedNames(mbd_full_step_init.get(), Metadata::Conserved);
+    // The variables don't change during a run, so build the lists only once
+    static const auto ordered_prims = GetOrderedNames(mbd_full_step_init.get(), Metadata::GetUserFlag("Primitive"));
+    static const auto ordered_cons  = GetOrderedNames(mbd_full_step_init.get(), Metadata::Conserved);
     //std::cerr << "Ordered prims:"; for(auto prim: ordered_prims) std::cerr << " " << prim; std::cerr << std::endl;
     //std::cerr << "Ordered cons:"; for(auto con: ordered_cons) std::cerr << " " << con; std::cerr << std::endl;
 
@@ -229,7 +303,7 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     const int nblock = U_full_step_init_all.GetDim(5);
     const int nvar   = U_full_step_init_all.GetDim(4);
     // Get number of implicit variables
-    auto implicit_vars = GetOrderedNames(mbd_full_step_init.get(), Metadata::GetUserFlag("Primitive"), true);
+    static const auto implicit_vars = GetOrderedNames(mbd_full_step_init.get(), Metadata::GetUserFlag("Primitive"), true);
     //std::cerr << "Ordered implicit:"; for(auto var: implicit_vars) std::cerr << " " << var; std::cerr << std::endl;
 
     PackIndexMap implicit_prims_map;
@@ -237,13 +311,16 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     const int nfvar = P_full_step_init_implicit.GetDim(4);
 
     // Pull fields associated with the solver's performance
-    auto& solve_norm_all = md_solver->PackVariables(std::vector<std::string>{"solve_norm"});
-    auto& solve_fail_all = md_solver->PackVariables(std::vector<std::string>{"solve_fail"});
+    auto& solve_norm_all = md_solver->PackVariables(names_solve_norm);
+    auto& solve_fail_all = md_solver->PackVariables(names_solve_fail);
+    auto& solve_iters_all = md_solver->PackVariables(names_solve_iters);
+    auto& solve_tol_all = md_solver->PackVariables(names_solve_tol);
 
-    auto& jacobian_all = md_solver->PackVariables(std::vector<std::string>{"Implicit.jacobian"});
-    auto& delta_prim_all = md_solver->PackVariables(std::vector<std::string>{"Implicit.delta_prim"});
-    auto& residual_all = md_solver->PackVariables(std::vector<std::string>{"Implicit.residual"});
-    auto& dU_implicit_all = md_solver->PackVariables(std::vector<std::string>{"Implicit.dU_implicit"});
+    auto& jacobian_all = md_solver->PackVariables(names_jacobian);
+    auto& delta_prim_all = md_solver->PackVariables(names_delta_prim);
+    auto& residual_all = md_solver->PackVariables(names_residual);
+    auto& dU_implicit_all = md_solver->PackVariables(names_dU_implicit);
+    auto& closure_all = md_solver->PackVariables(names_closure);
 
     auto bounds  = pmb_sub_step_init->cellbounds;
     const int n1 = bounds.ncellsi(IndexDomain::entire);
@@ -255,10 +332,12 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     // std::cerr << "Solve size " << nfvar << " on prim size " << nvar << std::endl;
     if (nfvar == 0) return TaskStatus::complete;
 
-    // The norm of the residual.  We store this to avoid the main kernel
-    // also being a 2-stage reduction, which is complex and sucks.
-    // TODO keep this around as a field?
-    // ParArray4D<Real> norm_all("norm_all", nblock, n3, n2, n1); // EDIT
+    // Time the whole solve if we're reporting on it
+    if (report_performance) Kokkos::fence();
+    Kokkos::Timer timer;
+
+    // The norm of the residual is kept in the field solve_norm, which avoids the main kernel
+    // also being a 2-stage reduction, and leaves it around for diagnostics & output.
 
     // Get meshblock array bounds from Parthenon
     const IndexDomain domain = IndexDomain::interior;
@@ -266,15 +345,67 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
     const IndexRange jb      = bounds.GetBoundsJ(domain);
     const IndexRange kb      = bounds.GetBoundsK(domain);
     const IndexRange block   = IndexRange{0, nblock - 1};
+    // Zones outside of the requested region are left untouched
+    const IndexRange3 bulk   = BulkRange(md_solver);
+    // Excised zones are never solved, see KBoundaries::ExcisedStart
+    const auto excised       = KBoundaries::GetExcisedStarts(md_solver);
+
+    // The EMHD closure (tau, chi_e, nu_e) depends only on the sub-step's initial state.
+    // Compute it once here, rather than in every evaluation of the residual.
+    // Note all the EMHD_parameters structs above come from the same package, so they agree.
+    // The time-derivative sources' u_mu and Theta at the full step's start are likewise fixed,
+    // so they're recorded here too, and the residual never needs to read P_full_step_init.
+    if (m_p.Q >= 0 || m_p.DP >= 0) {
+        pmb_solver->par_for("implicit_closure", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+                if (!in_region(region, bulk, k, j, i) || i < excised(b)) return;
+                const auto& G = P_sub_step_init_all.GetCoords(b);
+                EMHD::set_parameters(G, P_sub_step_init_all(b), m_p, emhd_params_sub_step_init, gam, k, j, i,
+                                     closure_all(b, ClosureIdx::tau, k, j, i), closure_all(b, ClosureIdx::chi_e, k, j, i),
+                                     closure_all(b, ClosureIdx::nu_e, k, j, i));
+                Real ucon[GR_DIM], ucov[GR_DIM];
+                GRMHD::calc_ucon(G, P_full_step_init_all(b), m_p, k, j, i, Loci::center, ucon);
+                G.lower(ucon, ucov, k, j, i, Loci::center);
+                DLOOP1 closure_all(b, ClosureIdx::ucov_old + mu, k, j, i) = ucov[mu];
+                closure_all(b, ClosureIdx::theta_old, k, j, i) =
+                    m::max((gam - 1) * P_full_step_init_all(b, m_p.UU, k, j, i) / P_full_step_init_all(b, m_p.RHO, k, j, i), SMALL);
+            }
+        );
+    }
+
+    // Likewise each zone's tolerance, if it's set by the size of the explicit update
+    if (adaptive_tol > 0.) {
+        pmb_solver->par_for("implicit_tolerance", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+                if (!in_region(region, bulk, k, j, i) || i < excised(b)) return;
+                Real update_norm = 0.;
+                FLOOP update_norm += SQR(flux_src_all(b, ip, k, j, i));
+                solve_tol_all(b, 0, k, j, i) = m::max(rootfind_tol, adaptive_tol * m::sqrt(update_norm));
+            }
+        );
+    }
+
+    // Use the fixed-size solver if we have one for this system
+    const bool use_batched = batched_solve && (nfvar == 5 || nfvar == 7 || nfvar == 8);
+    // Likewise the dual-number Jacobian, only where we know every row of the residual
+    const bool use_ad_jacobian = analytic_jacobian && CanUseADJacobian(m_p, m_u, nfvar);
 
-    // Allocate scratch space
-    // Only needed for the Kokkos-kernels solve, anymore
-    // Otherwise we pull a bad hack and allocate constant temporaries
+    // Workspace for the Kokkos-kernels solve.  Rather than allocating team scratch on every launch,
+    // this is kept in the package and only re-allocated when the mesh or system size changes.
+    // Zones are indexed in rows of n1, so each team takes a contiguous slice.
     const int scratch_level = 1; // 0 is actual scratch (tiny); 1 is HBM
-    const size_t tensor_size_in_bytes = parthenon::ScratchPad3D<Real>::shmem_size(n1, nfvar, nfvar);
-    const size_t fvar_size_in_bytes   = parthenon::ScratchPad2D<Real>::shmem_size(n1, nfvar);
-    const size_t fvar_int_size_in_bytes = parthenon::ScratchPad2D<int>::shmem_size(n1, nfvar);
-    const size_t total_scratch_bytes = tensor_size_in_bytes + 4 * fvar_size_in_bytes + fvar_int_size_in_bytes;
+    const size_t total_scratch_bytes = 0;
+    auto *workspace = GetPartitionParam<SolverWorkspace>(md_solver, "Implicit", "solver_workspace");
+    if (!use_batched && !jacobian_free) workspace->Resize(nblock * n3 * n2 * n1, nfvar);
+    const auto jacobian_ws   = workspace->jacobian;
+    const auto delta_prim_ws = workspace->delta_prim;
+    const auto trans_ws      = workspace->trans;
+    const auto work_ws       = workspace->work;
+    const auto pivot_ws      = workspace->pivot;
+
+    // Zones still being iterated, when compacting
+    const int ni = ib.e - ib.s + 1, nj = jb.e - jb.s + 1, nk = kb.e - kb.s + 1;
+    int nactive = 0;
 
     // Iterate.  This loop is outside the kokkos kernel in order to print max_norm
     // There are generally a low and similar number of iterations between
@@ -283,275 +414,403 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
         // Flags per iter, since debugging here will be rampant
         Flag("ImplicitIteration_"+std::to_string(iter));
 
-#if SPLIT_IMPLICIT_SOLVE
-        pmb_solver->par_for("implicit_jacobian",
-            block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
-#else
-        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "implicit_solve", pmb_sub_step_init->exec_space,
-            total_scratch_bytes, scratch_level, block.s, block.e, kb.s, kb.e, jb.s, jb.e,
-            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& b, const int& k, const int& j) {
-                parthenon::par_for_inner(member, ib.s, ib.e,
-                    [&](const int& i) {
-#endif
-                const auto& G = U_full_step_init_all.GetCoords(b);
-
-                // Solver performance diagnostics
-                Real &solve_fail = solve_fail_all(b, 0, k, j, i);
-
-                // Perform the solve only if it hadn't failed in any of the previous iterations.
-                if (solve_fail != SolverStatusR::fail) {
-                    // Now that we know that it isn't a bad zone, reset solve_fail for this iteration
-                    solve_fail = SolverStatusR::converged;
-
-                    if (m_p.Q >= 0 || m_p.DP >= 0) {
-                        Real throwaway;
-                        Real &dUq  = (m_u.Q >= 0)  ? dU_implicit_all(b, m_u.Q, k, j, i) : throwaway;
-                        Real &dUdP = (m_u.DP >= 0) ? dU_implicit_all(b, m_u.DP, k, j, i): throwaway;
-                        Real tau, chi_e, nu_e;
-                        EMHD::set_parameters(G, P_sub_step_init_all(b), m_p, emhd_params_sub_step_init,
-                                                gam, k, j, i, tau, chi_e, nu_e);
-                        EMHD::implicit_sources(G, P_full_step_init_all(b), m_p,
-                                                gam, tau, k, j, i, dUq, dUdP);
-                    }
+        // Per-zone parts of each iteration: the Jacobian & residual, and the (line-searched) step.
+        // Shared between the sweep over every zone and the sweep over only the active zones
+        const auto zone_jacobian = KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+            if (!in_region(region, bulk, k, j, i) || i < excised(b)) return;
+            const auto& G = U_full_step_init_all.GetCoords(b);
+
+            // Solver performance diagnostics
+            Real &solve_fail = solve_fail_all(b, 0, k, j, i);
+
+            // Perform the solve only if it hadn't failed in any of the previous iterations.
+            if (solve_fail != SolverStatusR::fail) {
+                // Now that we know that it isn't a bad zone, reset solve_fail for this iteration
+                solve_fail = SolverStatusR::converged;
+
+                if (m_p.Q >= 0 || m_p.DP >= 0) {
+                    Real throwaway;
+                    Real &dUq  = (m_u.Q >= 0)  ? dU_implicit_all(b, m_u.Q, k, j, i) : throwaway;
+                    Real &dUdP = (m_u.DP >= 0) ? dU_implicit_all(b, m_u.DP, k, j, i): throwaway;
+                    EMHD::implicit_sources(G, P_full_step_init_all(b), m_p,
+                                            gam, closure_all(b, 0, k, j, i), k, j, i, dUq, dUdP);
+                }
 
-                    // Jacobian calculation
-                    // Requires calculating the residual anyway, so we grab it here
+                // Jacobian calculation
+                // Requires calculating the residual anyway, so we grab it here
+                if (jacobian_free) {
+                    calc_residual(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b), P_sub_step_init_all(b),
+                                flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
+                                nfvar, k, j, i, gam, dt, residual_all(b));
+                } else if (use_ad_jacobian && nfvar <= 5) {
+                    calc_jacobian_ad<5>(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b), P_sub_step_init_all(b),
+                                flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
+                                nfvar, k, j, i, gam, dt, jacobian_all(b), residual_all(b));
+                } else if (use_ad_jacobian && nfvar <= 7) {
+                    calc_jacobian_ad<7>(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b), P_sub_step_init_all(b),
+                                flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
+                                nfvar, k, j, i, gam, dt, jacobian_all(b), residual_all(b));
+                } else if (use_ad_jacobian) {
+                    calc_jacobian_ad<10>(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b), P_sub_step_init_all(b),
+                                flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
+                                nfvar, k, j, i, gam, dt, jacobian_all(b), residual_all(b));
+                } else {
                     calc_jacobian(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b), P_sub_step_init_all(b), 
-                                flux_src_all(b), dU_implicit_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
+                                flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u, emhd_params_solver, emhd_params_sub_step_init,
                                 nvar, nfvar, k, j, i, delta, gam, dt,
                                 jacobian_all(b), residual_all(b));
                 }
-#if SPLIT_IMPLICIT_SOLVE
-            } // End lambda
-        ); // End par_for
+            }
+        };
+        // Matrix-free solve, using jacobian as space for the perturbed residuals, and linesearch for the perturbed state
+        const auto zone_gmres = KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+            if (!in_region(region, bulk, k, j, i) || i < excised(b) || solve_fail_all(b, 0, k, j, i) == SolverStatusR::fail) return;
+            const auto& G = U_full_step_init_all.GetCoords(b);
+            gmres_solve(G, P_solver_all(b), P_linesearch_all(b), P_full_step_init_all(b), U_full_step_init_all(b),
+                        P_sub_step_init_all(b), flux_src_all(b), dU_implicit_all(b), closure_all(b), m_p, m_u,
+                        emhd_params_solver, emhd_params_sub_step_init, nvar, nfvar, k, j, i, delta, gam, dt,
+                        krylov_max_iter, krylov_tol, residual_all(b), jacobian_all(b), delta_prim_all(b));
+        };
+        const auto zone_update = KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+            const auto& G = U_full_step_init_all.GetCoords(b);
+
+            // Solver performance diagnostics
+            Real &solve_norm = solve_norm_all(b, 0, k, j, i);
+            Real &solve_fail = solve_fail_all(b, 0, k, j, i);
+            Real &solve_iters = solve_iters_all(b, 0, k, j, i);
+
+            if (!in_region(region, bulk, k, j, i) || i < excised(b)) return;
+            if (iter == 1) solve_iters = 0;
+            if (solve_fail == SolverStatusR::fail) return;
+            solve_iters = iter;
+
+            // Copy `solver` prims to `linesearch`. This doesn't matter for the first step of the solver
+            // since we do a copy in imex_driver just before, but it is required for the subsequent
+            // iterations of the solver.
+            if (iter > 1)
+               PLOOP P_linesearch_all(b, ip, k, j, i) = P_solver_all(b, ip, k, j, i);
+
+            // Check for positive definite values of density and internal energy.
+            // Ignore zone if manual backtracking is not sufficient.
+            // The primitives will be averaged over good neighbors.
+            Real lambda = linesearch_lambda;
+            if ((P_solver_all(b, m_p.RHO, k, j, i) + lambda*delta_prim_all(b, m_p.RHO, k, j, i) < 0.) ||
+                (P_solver_all(b, m_p.UU, k, j, i) + lambda*delta_prim_all(b, m_p.UU, k, j, i) < 0.)) {
+                solve_fail = SolverStatusR::backtrack;
+                lambda       = 0.1;
+            }
+            if ((P_solver_all(b, m_p.RHO, k, j, i) + lambda*delta_prim_all(b, m_p.RHO, k, j, i) < 0.) ||
+                (P_solver_all(b, m_p.UU, k, j, i) + lambda*delta_prim_all(b, m_p.UU, k, j, i) < 0.)) {
+                solve_fail = SolverStatusR::fail;
+                // Set all fluid primitives to value at beginning of substep.
+                // We average over neighboring good zones later.
+                FLOOP P_solver_all(b, ip, k, j, i) = P_sub_step_init_all(b, ip, k, j, i);
+                return;
+            }
 
-        parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "implicit_solve", pmb_sub_step_init->exec_space,
-            total_scratch_bytes, scratch_level, block.s, block.e, kb.s, kb.e, jb.s, jb.e,
-            KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& b, const int& k, const int& j) {
-#else
-                }); // End par_for_inner
-                member.team_barrier();
-#endif
-                const auto& G = U_full_step_init_all.GetCoords(b);
-                // Scratchpads for implicit vars
-                ScratchPad3D<Real> jacobian_s(member.team_scratch(scratch_level), n1, nfvar, nfvar);
-                ScratchPad2D<Real> delta_prim_s(member.team_scratch(scratch_level), n1, nfvar);
-                ScratchPad2D<Real> trans_s(member.team_scratch(scratch_level), n1, nfvar);
-                ScratchPad2D<Real> work_s(member.team_scratch(scratch_level), n1, 2*nfvar);
-                ScratchPad2D<int> pivot_s(member.team_scratch(scratch_level), n1, nfvar);
-
-                // Copy in to scratchpads
-                FLOOP {
-                    parthenon::par_for_inner(member, 0, n1-1,
-                        [&](const int& i) {
-                            delta_prim_s(i, ip) = -residual_all(b)(ip, k, j, i);
-                        }
-                    );
-                }
-                FLOOP2 {
-                    parthenon::par_for_inner(member, 0, n1-1,
-                        [&](const int& i) {
-                            jacobian_s(i, ip, jp) = jacobian_all(b)(ip*nfvar+jp, k, j, i);
-                        }
-                    );
-                }
-                member.team_barrier();
+            // Assuming we did not fail...
+            // Linesearch
+            if (linesearch) {
+                solve_norm        = 0.;
+                FLOOP solve_norm += SQR(residual_all(b, ip, k, j, i));
+                solve_norm        = m::sqrt(solve_norm);
 
-                // TODO(BSP) even still worth keeping non-QR version?  Much less stable
-                if (use_qr) {
-                    parthenon::par_for_inner(member, ib.s, ib.e,
-                        [&](const int& i) {
-                            // Solver variables
-                            auto jacobian   = Kokkos::subview(jacobian_s, i, Kokkos::ALL(), Kokkos::ALL());
-                            auto delta_prim = Kokkos::subview(delta_prim_s, i, Kokkos::ALL());
-                            auto pivot      = Kokkos::subview(pivot_s, i, Kokkos::ALL());
-                            auto trans      = Kokkos::subview(trans_s, i, Kokkos::ALL());
-                            auto work       = Kokkos::subview(work_s, i, Kokkos::ALL());
-
-                            if (solve_fail_all(b, 0, k, j, i) != SolverStatusR::fail) {
-                                // Linear solve by QR decomposition
-                                KokkosBatched::SerialQR<KokkosBatched::Algo::QR::Unblocked>::invoke(jacobian, trans, pivot, work);
-                                KokkosBatched::SerialApplyQ<KokkosBatched::Side::Left, KokkosBatched::Trans::Transpose,
-                                                            KokkosBatched::Algo::ApplyQ::Unblocked>
-                                ::invoke(jacobian, trans, delta_prim, work);
-                                KokkosBatched::SerialTrsv<KokkosBatched::Uplo::Upper, KokkosBatched::Trans::NoTranspose, 
-                                                        KokkosBatched::Diag::NonUnit, KokkosBatched::Algo::Trsv::Unblocked>
-                                ::invoke(alpha, jacobian, delta_prim);
-                                // Linear solve by QR decomposition
-                                KokkosBatched::SerialApplyPivot<KokkosBatched::Side::Left,KokkosBatched::Direct::Backward>
-                                    ::invoke(pivot, delta_prim);
-                            }
-                        }
-                    );
-                } else {
-                    parthenon::par_for_inner(member, ib.s, ib.e,
-                        [&](const int& i) {
-                            // Solver variables
-                            auto jacobian   = Kokkos::subview(jacobian_s, i, Kokkos::ALL(), Kokkos::ALL());
-                            auto delta_prim = Kokkos::subview(delta_prim_s, i, Kokkos::ALL());
-
-                            if (solve_fail_all(b, 0, k, j, i) != SolverStatusR::fail) {
-                                KokkosBatched::SerialLU<KokkosBatched::Algo::LU::Unblocked>::invoke(jacobian, tiny);
-                                KokkosBatched::SerialTrsv<KokkosBatched::Uplo::Upper, KokkosBatched::Trans::NoTranspose, 
-                                                        KokkosBatched::Diag::NonUnit, KokkosBatched::Algo::Trsv::Unblocked>
-                                ::invoke(alpha, jacobian, delta_prim);
-                            }
-                        }
-                    );
-                }
-                member.team_barrier();
+                Real f0      = 0.5 * solve_norm;
+                Real fprime0 = -2. * f0;
 
-                // Copy out delta_prim
-                FLOOP {
-                    parthenon::par_for_inner(member, ib.s, ib.e,
-                        [&](const int& i) {
-                            delta_prim_all(b)(ip, k, j, i) = delta_prim_s(i, ip);
-                        }
-                    );
-                }
-#if SPLIT_IMPLICIT_SOLVE
-            } // End lambda
-        ); // End par_for
+                for (int linesearch_iter = 0; linesearch_iter < max_linesearch_iter; linesearch_iter++) {
+                    // Take step
+                    FLOOP P_linesearch_all(b, ip, k, j, i) =
+                            P_solver_all(b, ip, k, j, i) + (lambda * delta_prim_all(b, ip, k, j, i));
 
-        pmb_solver->par_for("implicit_set_step",
-            block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
-#else
-                member.team_barrier();
-                parthenon::par_for_inner(member, ib.s, ib.e,
-                    [&](const int& i) {
-#endif
-                const auto& G = U_full_step_init_all.GetCoords(b);
-
-                // Solver performance diagnostics
-                Real &solve_norm = solve_norm_all(b, 0, k, j, i);
-                Real &solve_fail = solve_fail_all(b, 0, k, j, i);
-
-                if (solve_fail == SolverStatusR::fail) return;
-
-                // Copy `solver` prims to `linesearch`. This doesn't matter for the first step of the solver
-                // since we do a copy in imex_driver just before, but it is required for the subsequent
-                // iterations of the solver.
-                if (iter > 1)
-                   PLOOP P_linesearch_all(b, ip, k, j, i) = P_solver_all(b, ip, k, j, i);
-
-                // Check for positive definite values of density and internal energy.
-                // Ignore zone if manual backtracking is not sufficient.
-                // The primitives will be averaged over good neighbors.
-                Real lambda = linesearch_lambda;
-                if ((P_solver_all(b, m_p.RHO, k, j, i) + lambda*delta_prim_all(b, m_p.RHO, k, j, i) < 0.) ||
-                    (P_solver_all(b, m_p.UU, k, j, i) + lambda*delta_prim_all(b, m_p.UU, k, j, i) < 0.)) {
-                    solve_fail = SolverStatusR::backtrack;
-                    lambda       = 0.1;
-                }
-                if ((P_solver_all(b, m_p.RHO, k, j, i) + lambda*delta_prim_all(b, m_p.RHO, k, j, i) < 0.) ||
-                    (P_solver_all(b, m_p.UU, k, j, i) + lambda*delta_prim_all(b, m_p.UU, k, j, i) < 0.)) {
-                    solve_fail = SolverStatusR::fail;
-                    // Set all fluid primitives to value at beginning of substep.
-                    // We average over neighboring good zones later.
-                    FLOOP P_solver_all(b, ip, k, j, i) = P_sub_step_init_all(b, ip, k, j, i);
-                    return;
-                }
+                    // Compute solve_norm of the residual (loss function)
+                    calc_residual(G, P_linesearch_all(b), P_full_step_init_all(b), U_full_step_init_all(b),
+                                P_sub_step_init_all(b), flux_src_all(b), dU_implicit_all(b), closure_all(b), 
+                                m_p, m_u, emhd_params_linesearch, emhd_params_solver, nfvar,
+                                k, j, i, gam, dt, residual_all(b));
 
-                // Assuming we did not fail...
-                // Linesearch
-                if (linesearch) {
                     solve_norm        = 0.;
                     FLOOP solve_norm += SQR(residual_all(b, ip, k, j, i));
                     solve_norm        = m::sqrt(solve_norm);
+                    Real f1             = 0.5 * solve_norm;
 
-                    Real f0      = 0.5 * solve_norm;
-                    Real fprime0 = -2. * f0;
-
-                    for (int linesearch_iter = 0; linesearch_iter < max_linesearch_iter; linesearch_iter++) {
-                        // Take step
-                        FLOOP P_linesearch_all(b, ip, k, j, i) =
-                                P_solver_all(b, ip, k, j, i) + (lambda * delta_prim_all(b, ip, k, j, i));
-
-                        // Compute solve_norm of the residual (loss function)
-                        calc_residual(G, P_linesearch_all(b), P_full_step_init_all(b), U_full_step_init_all(b),
-                                    P_sub_step_init_all(b), flux_src_all(b), dU_implicit_all(b), 
-                                    m_p, m_u, emhd_params_linesearch, emhd_params_solver, nfvar,
-                                    k, j, i, gam, dt, residual_all(b));
-
-                        solve_norm        = 0.;
-                        FLOOP solve_norm += SQR(residual_all(b, ip, k, j, i));
-                        solve_norm        = m::sqrt(solve_norm);
-                        Real f1             = 0.5 * solve_norm;
-
-                        // Compute new step length
-                        int condition   = f1 > (f0 * (1. - linesearch_eps * lambda) + SMALL);
-                        Real denom      = (f1 - f0 - (fprime0 * lambda)) * condition + (1 - condition);
-                        Real lambda_new = -fprime0 * lambda * lambda / denom * 0.5;
-                        lambda          = lambda * (1 - condition) + (condition * lambda_new);
-
-                        // Check if new solution has converged within required tolerance
-                        if (condition == 0) break;                           
-                    }
-                }
+                    // Compute new step length
+                    int condition   = f1 > (f0 * (1. - linesearch_eps * lambda) + SMALL);
+                    Real denom      = (f1 - f0 - (fprime0 * lambda)) * condition + (1 - condition);
+                    Real lambda_new = -fprime0 * lambda * lambda / denom * 0.5;
+                    lambda          = lambda * (1 - condition) + (condition * lambda_new);
 
-                // Update the guess
-                FLOOP P_solver_all(b, ip, k, j, i) += lambda * delta_prim_all(b, ip, k, j, i);
+                    // Check if new solution has converged within required tolerance
+                    if (condition == 0) break;                           
+                }
+            }
 
-                calc_residual(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b),
-                            P_sub_step_init_all(b), flux_src_all(b), dU_implicit_all(b),
-                            m_p, m_u, emhd_params_solver, emhd_params_sub_step_init, nfvar,
-                            k, j, i, gam, dt, residual_all(b));
+            // Update the guess
+            FLOOP P_solver_all(b, ip, k, j, i) += lambda * delta_prim_all(b, ip, k, j, i);
+
+            calc_residual(G, P_solver_all(b), P_full_step_init_all(b), U_full_step_init_all(b),
+                        P_sub_step_init_all(b), flux_src_all(b), dU_implicit_all(b), closure_all(b),
+                        m_p, m_u, emhd_params_solver, emhd_params_sub_step_init, nfvar,
+                        k, j, i, gam, dt, residual_all(b));
+
+            // Store for maximum/output
+            solve_norm        = 0;
+            FLOOP solve_norm += SQR(residual_all(b, ip, k, j, i));
+            solve_norm        = m::sqrt(solve_norm);
+
+            // Did we converge to required tolerance? If not, update solve_fail accordingly
+            if (m::isnan(solve_norm)) {
+                // TODO(BSP) this can probably be detected/implemented alongside the floors above
+                solve_fail = SolverStatusR::fail;
+                FLOOP P_solver_all(b, ip, k, j, i) = P_sub_step_init_all(b, ip, k, j, i);
+            } else if (solve_norm > ((adaptive_tol > 0.) ? solve_tol_all(b, 0, k, j, i) : rootfind_tol)) {
+                solve_fail = SolverStatusR::beyond_tol; // TODO was changed from +=. Valid?
+            }
+        };
+
+        if (compact_active && iter > 1) {
+            // Iterate only the zones left unconverged by the previous iteration
+            const auto active_list = *GetPartitionParam<ParArray1D<int>>(md_solver, "Implicit", "active_list");
+            pmb_solver->par_for("implicit_jacobian_active", 0, nactive - 1,
+                KOKKOS_LAMBDA(const int& m) {
+                    const int n = active_list(m);
+                    const int i = ib.s + n % ni;
+                    const int j = jb.s + (n / ni) % nj;
+                    const int k = kb.s + (n / (ni*nj)) % nk;
+                    const int b = n / (ni*nj*nk);
+                    zone_jacobian(b, k, j, i);
+                }
+            );
+            pmb_solver->par_for("implicit_solve_active", 0, nactive - 1,
+                KOKKOS_LAMBDA(const int& m) {
+                    const int n = active_list(m);
+                    const int i = ib.s + n % ni;
+                    const int j = jb.s + (n / ni) % nj;
+                    const int k = kb.s + (n / (ni*nj)) % nk;
+                    const int b = n / (ni*nj*nk);
+                    if (solve_fail_all(b, 0, k, j, i) == SolverStatusR::fail) return;
+                    // Zones are scattered, so there is no team to share scratch:
+                    // solve in registers if we can, otherwise in-place in the global arrays
+                    if (jacobian_free) {
+                        zone_gmres(b, k, j, i);
+                    } else if (use_batched && nfvar == 5) {
+                        batched_lu_solve<5>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                    } else if (use_batched && nfvar == 7) {
+                        batched_lu_solve<7>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                    } else if (use_batched) {
+                        batched_lu_solve<8>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                    } else {
+                        pivoted_lu_solve(jacobian_all(b), residual_all(b), delta_prim_all(b), nfvar, k, j, i, tiny);
+                    }
+                }
+            );
+            pmb_solver->par_for("implicit_set_step_active", 0, nactive - 1,
+                KOKKOS_LAMBDA(const int& m) {
+                    const int n = active_list(m);
+                    const int i = ib.s + n % ni;
+                    const int j = jb.s + (n / ni) % nj;
+                    const int k = kb.s + (n / (ni*nj)) % nk;
+                    const int b = n / (ni*nj*nk);
+                    zone_update(b, k, j, i);
+                }
+            );
+        } else {
+#if SPLIT_IMPLICIT_SOLVE
+            pmb_solver->par_for("implicit_jacobian",
+                block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+                KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+#else
+            parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "implicit_solve", pmb_sub_step_init->exec_space,
+                total_scratch_bytes, scratch_level, block.s, block.e, kb.s, kb.e, jb.s, jb.e,
+                KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& b, const int& k, const int& j) {
+                    parthenon::par_for_inner(member, ib.s, ib.e,
+                        [&](const int& i) {
+#endif
+                    zone_jacobian(b, k, j, i);
+#if SPLIT_IMPLICIT_SOLVE
+                } // End lambda
+            ); // End par_for
 
-                // Store for maximum/output
-                solve_norm        = 0;
-                FLOOP solve_norm += SQR(residual_all(b, ip, k, j, i));
-                solve_norm        = m::sqrt(solve_norm);
+            parthenon::par_for_outer(DEFAULT_OUTER_LOOP_PATTERN, "implicit_solve", pmb_sub_step_init->exec_space,
+                total_scratch_bytes, scratch_level, block.s, block.e, kb.s, kb.e, jb.s, jb.e,
+                KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int& b, const int& k, const int& j) {
+#else
+                    }); // End par_for_inner
+                    member.team_barrier();
+#endif
+                    if (jacobian_free) {
+                        parthenon::par_for_inner(member, ib.s, ib.e,
+                            [&](const int& i) {
+                                zone_gmres(b, k, j, i);
+                            }
+                        );
+                    } else if (use_batched) {
+                        // Each thread solves its own zone's system in registers, straight from the global arrays
+                        parthenon::par_for_inner(member, ib.s, ib.e,
+                            [&](const int& i) {
+                                if (in_region(region, bulk, k, j, i) && i >= excised(b) && solve_fail_all(b, 0, k, j, i) != SolverStatusR::fail) {
+                                    if (nfvar == 5) {
+                                        batched_lu_solve<5>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                                    } else if (nfvar == 7) {
+                                        batched_lu_solve<7>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                                    } else {
+                                        batched_lu_solve<8>(jacobian_all(b), residual_all(b), delta_prim_all(b), k, j, i, tiny);
+                                    }
+                                }
+                            }
+                        );
+                    } else {
+                        const auto& G = U_full_step_init_all.GetCoords(b);
+                        // This team's row of the workspace
+                        const auto row = Kokkos::make_pair(((b*n3 + k)*n2 + j)*n1, ((b*n3 + k)*n2 + j + 1)*n1);
+                        const auto jacobian_s   = Kokkos::subview(jacobian_ws, row, Kokkos::ALL(), Kokkos::ALL());
+                        const auto delta_prim_s = Kokkos::subview(delta_prim_ws, row, Kokkos::ALL());
+                        const auto trans_s      = Kokkos::subview(trans_ws, row, Kokkos::ALL());
+                        const auto work_s       = Kokkos::subview(work_ws, row, Kokkos::ALL());
+                        const auto pivot_s      = Kokkos::subview(pivot_ws, row, Kokkos::ALL());
+
+                        // Copy in to workspace
+                        FLOOP {
+                            parthenon::par_for_inner(member, 0, n1-1,
+                                [&](const int& i) {
+                                    delta_prim_s(i, ip) = -residual_all(b)(ip, k, j, i);
+                                }
+                            );
+                        }
+                        FLOOP2 {
+                            parthenon::par_for_inner(member, 0, n1-1,
+                                [&](const int& i) {
+                                    jacobian_s(i, ip, jp) = jacobian_all(b)(ip*nfvar+jp, k, j, i);
+                                }
+                            );
+                        }
+                        member.team_barrier();
+
+                        // TODO(BSP) even still worth keeping non-QR version?  Much less stable
+                        if (use_qr) {
+                            parthenon::par_for_inner(member, ib.s, ib.e,
+                                [&](const int& i) {
+                                    // Solver variables
+                                    auto jacobian   = Kokkos::subview(jacobian_s, i, Kokkos::ALL(), Kokkos::ALL());
+                                    auto delta_prim = Kokkos::subview(delta_prim_s, i, Kokkos::ALL());
+                                    auto pivot      = Kokkos::subview(pivot_s, i, Kokkos::ALL());
+                                    auto trans      = Kokkos::subview(trans_s, i, Kokkos::ALL());
+                                    auto work       = Kokkos::subview(work_s, i, Kokkos::ALL());
+
+                                    if (in_region(region, bulk, k, j, i) && i >= excised(b) && solve_fail_all(b, 0, k, j, i) != SolverStatusR::fail) {
+                                        // Linear solve by QR decomposition
+                                        KokkosBatched::SerialQR<KokkosBatched::Algo::QR::Unblocked>::invoke(jacobian, trans, pivot, work);
+                                        KokkosBatched::SerialApplyQ<KokkosBatched::Side::Left, KokkosBatched::Trans::Transpose,
+                                                                    KokkosBatched::Algo::ApplyQ::Unblocked>
+                                        ::invoke(jacobian, trans, delta_prim, work);
+                                        KokkosBatched::SerialTrsv<KokkosBatched::Uplo::Upper, KokkosBatched::Trans::NoTranspose, 
+                                                                KokkosBatched::Diag::NonUnit, KokkosBatched::Algo::Trsv::Unblocked>
+                                        ::invoke(alpha, jacobian, delta_prim);
+                                        // Linear solve by QR decomposition
+                                        KokkosBatched::SerialApplyPivot<KokkosBatched::Side::Left,KokkosBatched::Direct::Backward>
+                                            ::invoke(pivot, delta_prim);
+                                    }
+                                }
+                            );
+                        } else {
+                            parthenon::par_for_inner(member, ib.s, ib.e,
+                                [&](const int& i) {
+                                    // Solver variables
+                                    auto jacobian   = Kokkos::subview(jacobian_s, i, Kokkos::ALL(), Kokkos::ALL());
+                                    auto delta_prim = Kokkos::subview(delta_prim_s, i, Kokkos::ALL());
+
+                                    if (in_region(region, bulk, k, j, i) && i >= excised(b) && solve_fail_all(b, 0, k, j, i) != SolverStatusR::fail) {
+                                        KokkosBatched::SerialLU<KokkosBatched::Algo::LU::Unblocked>::invoke(jacobian, tiny);
+                                        KokkosBatched::SerialTrsv<KokkosBatched::Uplo::Upper, KokkosBatched::Trans::NoTranspose, 
+                                                                KokkosBatched::Diag::NonUnit, KokkosBatched::Algo::Trsv::Unblocked>
+                                        ::invoke(alpha, jacobian, delta_prim);
+                                    }
+                                }
+                            );
+                        }
+                        member.team_barrier();
+
+                        // Copy out delta_prim
+                        FLOOP {
+                            parthenon::par_for_inner(member, ib.s, ib.e,
+                                [&](const int& i) {
+                                    if (in_region(region, bulk, k, j, i) && i >= excised(b))
+                                        delta_prim_all(b)(ip, k, j, i) = delta_prim_s(i, ip);
+                                }
+                            );
+                        }
+                    }
+#if SPLIT_IMPLICIT_SOLVE
+                } // End lambda
+            ); // End par_for
 
-                // Did we converge to required tolerance? If not, update solve_fail accordingly
-                if (m::isnan(solve_norm)) {
-                    // TODO(BSP) this can probably be detected/implemented alongside the floors above
-                    solve_fail = SolverStatusR::fail;
-                    FLOOP P_solver_all(b, ip, k, j, i) = P_sub_step_init_all(b, ip, k, j, i);
-                } else if (solve_norm > rootfind_tol) {
-                    solve_fail = SolverStatusR::beyond_tol; // TODO was changed from +=. Valid?
-                }
+            pmb_solver->par_for("implicit_set_step",
+                block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+                KOKKOS_LAMBDA(const int& b, const int& k, const int& j, const int& i) {
+#else
+                    member.team_barrier();
+                    parthenon::par_for_inner(member, ib.s, ib.e,
+                        [&](const int& i) {
+#endif
+                    zone_update(b, k, j, i);
 #if SPLIT_IMPLICIT_SOLVE
-            } // End lambda
-        ); // End par_for
+                } // End lambda
+            ); // End par_for
 #else
-                }); // End par_for_inner
-            } // End lambda
-        ); // End par_for
+                    }); // End par_for_inner
+                } // End lambda
+            ); // End par_for
 #endif
-        // If we need to print or exit on the max norm...
-        if (iter >= iter_min || verbose >= 1) {
-            // Take the maximum L2 norm on this rank
+        }
+        if (compact_active) {
+            // List the zones which still need iterating: all of them until iter_min,
+            // then only those above tolerance.  Stop when there are none left anywhere
+            nactive = ListActiveZones(md_solver, iter >= iter_min, region);
+            Reductions::StartToAll<int>(md_solver, Reductions::Channel::solve_nactive, nactive, MPI_SUM);
+            const int nactive_all = Reductions::CheckOnAll<int>(md_solver, Reductions::Channel::solve_nactive);
+            if (verbose >= 1 && am_rank0) {
+                printf("Iteration %d active zones: %d\n", iter, nactive_all);
+            }
+            if (nactive_all == 0) {
+                EndFlag();
+                break;
+            }
+        } else if (iter >= iter_min || verbose >= 1) {
+            // If we need to print or exit on the max norm...
+            // Take the maximum L2 norm on this rank.  With per-zone tolerances, take the maximum
+            // ratio of norm to tolerance instead, so we're done when it's below 1.
             Real lmax_norm = 0.0;
             pmb_sub_step_init->par_reduce("max_norm", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
                 KOKKOS_LAMBDA (const int& b, const int& k, const int& j, const int& i, Real& local_result) {
-                    if (solve_norm_all(b, 0, k, j, i) > local_result) local_result = solve_norm_all(b, 0, k, j, i);
+                    const Real norm = (adaptive_tol > 0.) ? solve_norm_all(b, 0, k, j, i) / solve_tol_all(b, 0, k, j, i)
+                                                          : solve_norm_all(b, 0, k, j, i);
+                    if (in_region(region, bulk, k, j, i) && i >= excised(b) && norm > local_result)
+                        local_result = norm;
                 }
             , Kokkos::Max<Real>(lmax_norm));
             // Then MPI AllReduce to copy the global max to every rank
-            Reductions::StartToAll<Real>(md_solver, 4, lmax_norm, MPI_MAX);
-            Real max_norm = Reductions::CheckOnAll<Real>(md_solver, 4);
+            Reductions::StartToAll<Real>(md_solver, Reductions::Channel::solve_norm, lmax_norm, MPI_MAX);
+            Real max_norm = Reductions::CheckOnAll<Real>(md_solver, Reductions::Channel::solve_norm);
 
             if (verbose >= 1) {
                 // Count total number of solver fails
                 int lnfails = 0;
                 pmb_sub_step_init->par_reduce("count_solver_fails", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
                     KOKKOS_LAMBDA (const int& b, const int& k, const int& j, const int& i, int& local_result) {
-                        if (failed(solve_fail_all(b, 0, k, j, i))) ++local_result;
+                        if (in_region(region, bulk, k, j, i) && i >= excised(b) && failed(solve_fail_all(b, 0, k, j, i))) ++local_result;
                     }
                 , Kokkos::Sum<int>(lnfails));
                 // Then reduce to rank 0 to print the iteration by iteration
-                Reductions::Start<int>(md_solver, 5, lnfails, MPI_SUM);
-                int nfails = Reductions::Check<int>(md_solver, 5);
+                Reductions::Start<int>(md_solver, Reductions::Channel::solve_nfails, lnfails, MPI_SUM);
+                int nfails = Reductions::Check<int>(md_solver, Reductions::Channel::solve_nfails);
                 if (MPIRank0()) {
-                    printf("Iteration %d max L2 norm: %g, failed zones: %d\n", iter, max_norm, nfails);
+                    printf("Iteration %d max L2 norm%s: %g, failed zones: %d\n", iter,
+                           (adaptive_tol > 0.) ? " / tolerance" : "", max_norm, nfails);
                 }
             }
 
             // Finally, break if max_norm is less than the total tolerance we set
-            // TODO per-zone tolerance with masks?
-            if (iter >= iter_min && max_norm < rootfind_tol) {
+            if (iter >= iter_min && max_norm < ((adaptive_tol > 0.) ? 1. : rootfind_tol)) {
                 EndFlag();
                 break;
             }
@@ -559,17 +818,135 @@ TaskStatus Implicit::Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_
         EndFlag();
     }
 
-    // if (flag_verbose > 0) {
-    //     // Start the reduction as soon as we have the data
-    //     // Dangerous, so commented
-    //     Reductions::StartFlagReduce(md_solver, "solve_fail", Implicit::status_names, IndexDomain::interior, false, 2);
-    // }
+    if (report_performance) {
+        Kokkos::fence();
+        const Real solve_time = timer.seconds();
+        // Count zones, zones with each SolverStatus, and total iterations, all at once
+        Reductions::array_type<int, 6> stats_reducer;
+        pmb_solver->par_reduce("implicit_stats", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int& b, const int& k, const int& j, const int& i,
+                           Reductions::array_type<int, 6>& local_result) {
+                if (in_region(region, bulk, k, j, i) && i >= excised(b)) {
+                    ++local_result.my_array[0];
+                    ++local_result.my_array[1 + static_cast<int>(solve_fail_all(b, 0, k, j, i))];
+                    local_result.my_array[5] += static_cast<int>(solve_iters_all(b, 0, k, j, i));
+                }
+            }
+        , Reductions::ArraySum<int, HostExecSpace, 6>(stats_reducer));
+        int liters_max = 0;
+        pmb_solver->par_reduce("implicit_max_iters", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int& b, const int& k, const int& j, const int& i, int& local_result) {
+                const int iters = static_cast<int>(solve_iters_all(b, 0, k, j, i));
+                if (in_region(region, bulk, k, j, i) && i >= excised(b) && iters > local_result) local_result = iters;
+            }
+        , Kokkos::Max<int>(liters_max));
+
+        Reductions::Start<std::vector<int>>(md_solver, Reductions::Channel::solve_stats, std::vector<int>(stats_reducer.my_array, stats_reducer.my_array + 6), MPI_SUM);
+        Reductions::Start<int>(md_solver, Reductions::Channel::solve_iters, liters_max, MPI_MAX);
+        Reductions::Start<Real>(md_solver, Reductions::Channel::solve_time, solve_time, MPI_MAX);
+        const std::vector<int> stats = Reductions::Check<std::vector<int>>(md_solver, Reductions::Channel::solve_stats);
+        const int iters_max = Reductions::Check<int>(md_solver, Reductions::Channel::solve_iters);
+        const Real max_time = Reductions::Check<Real>(md_solver, Reductions::Channel::solve_time);
+
+        if (am_rank0 && stats[0] > 0) {
+            const Real nzones = stats[0];
+            printf("Implicit solve: %d zones, iterations mean %.2f max %d; converged %.1f%% beyond tol %.1f%% backtrack %.1f%% failed %.1f%%\n",
+                   stats[0], stats[5] / nzones, iters_max, 100.*stats[1]/nzones, 100.*stats[3]/nzones,
+                   100.*stats[4]/nzones, 100.*stats[2]/nzones);
+            if (jacobian_free) {
+                printf("Implicit solve: %g s\n", max_time);
+            } else {
+                // Only count the dense decomposition & substitution, so this is a lower bound
+                const Real flops = stats[5] * ((2./3.) * nfvar * nfvar * nfvar + 2. * nfvar * nfvar);
+                printf("Implicit solve: %g s, >= %g GFLOP/s in the linear solves\n", max_time, flops / max_time / 1.e9);
+            }
+        }
+    }
+
+    if (flag_verbose > 0 && region != SolveRegion::rind) {
+        // Count solver flags over the whole interior while the solver state is at hand, for PostStepDiagnostics.
+        // The rind, if solved separately, is always solved first, so this catches the final state
+        const auto& solve_fail_vals = implicit_par.Get<ParArray1D<int>>("solve_fail_values");
+        const int n_status = Implicit::status_names.size();
+        Reductions::array_type<int, MAX_NFLAGS> solve_fail_counts;
+        pmb_solver->par_reduce("implicit_flag_counts", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int& b, const int& k, const int& j, const int& i,
+                           Reductions::array_type<int, MAX_NFLAGS>& local_result) {
+                Reductions::TallyFlag(static_cast<int>(solve_fail_all(b, 0, k, j, i)), solve_fail_vals, n_status, false, local_result);
+            }
+        , Reductions::ArraySum<int, HostExecSpace, MAX_NFLAGS>(solve_fail_counts));
+        Reductions::RecordFlagCounts(md_solver, "Implicit", "solve_fail_counts", solve_fail_counts, n_status);
+    }
 
     EndFlag();
     return TaskStatus::complete;
 
 }
 
+IndexRange3 Implicit::BulkRange(MeshData<Real> *md)
+{
+    const int ng = Globals::nghost;
+    return KDomain::GetRange(md, IndexDomain::interior, ng, -ng);
+}
+
+TaskStatus Implicit::CopyBulk(MeshData<Real> *md_solver, MeshData<Real> *md_final)
+{
+    const auto &x = md_solver->PackVariables(std::vector<MetadataFlag>{Metadata::Cell});
+    const auto &y = md_final->PackVariables(std::vector<MetadataFlag>{Metadata::Cell});
+    const IndexRange3 b = BulkRange(md_solver);
+    parthenon::par_for(DEFAULT_LOOP_PATTERN, "copy_bulk", DevExecSpace(), 0, x.GetDim(5) - 1, 0, x.GetDim(4) - 1,
+        b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &v, const int &k, const int &j, const int &i) {
+            if (x.IsAllocated(bl, v) && y.IsAllocated(bl, v))
+                y(bl, v, k, j, i) = x(bl, v, k, j, i);
+        }
+    );
+    return TaskStatus::complete;
+}
+
+int Implicit::ListActiveZones(MeshData<Real> *md, bool check_norm, SolveRegion region)
+{
+    auto solve_norm = md->PackVariables(names_solve_norm);
+    auto solve_fail = md->PackVariables(names_solve_fail);
+    auto solve_tol = md->PackVariables(names_solve_tol);
+
+    auto &pars = md->GetMeshPointer()->packages.Get("Implicit")->AllParams();
+    const Real rootfind_tol = pars.Get<Real>("rootfind_tol");
+    const Real adaptive_tol = pars.Get<Real>("adaptive_tol");
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange3 bulk = BulkRange(md);
+    const auto excised = KBoundaries::GetExcisedStarts(md);
+    const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+    const int nzones = solve_fail.GetDim(5) * nk * nj * ni;
+
+    // Compact the zones, growing the list if it overflows
+    auto *active_list_p = GetPartitionParam<ParArray1D<int>>(md, "Implicit", "active_list");
+    if (active_list_p->extent_int(0) == 0) *active_list_p = ParArray1D<int>("active_list", 1024);
+    int nlist = 0;
+    bool fits = false;
+    while (!fits) {
+        const auto active_list = *active_list_p;
+        const int capacity = active_list.extent_int(0);
+        Kokkos::parallel_scan("list_active_zones", Kokkos::RangePolicy<>(DevExecSpace(), 0, nzones),
+            KOKKOS_LAMBDA (const int &n, int &idx, const bool &final) {
+                const int i = b.is + n % ni;
+                const int j = b.js + (n / ni) % nj;
+                const int k = b.ks + (n / (ni*nj)) % nk;
+                const int bl = n / (ni*nj*nk);
+                if (in_region(region, bulk, k, j, i) && i >= excised(bl) && !failed(solve_fail(bl, 0, k, j, i)) &&
+                    (!check_norm || solve_norm(bl, 0, k, j, i) >
+                                    ((adaptive_tol > 0.) ? solve_tol(bl, 0, k, j, i) : rootfind_tol))) {
+                    if (final && idx < capacity) active_list(idx) = n;
+                    ++idx;
+                }
+            }
+        , nlist);
+        fits = (nlist <= capacity);
+        if (!fits) Kokkos::resize(*active_list_p, 2 * nlist);
+    }
+    return nlist;
+}
+
 TaskStatus Implicit::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
 {
     auto pmesh = md->GetMeshPointer();
@@ -580,8 +957,10 @@ TaskStatus Implicit::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
 
     // Debugging/diagnostic info about implicit solver
     if (flag_verbose > 0) {
-        Reductions::StartFlagReduce(md, "solve_fail", Implicit::status_names, IndexDomain::interior, false, 2);
-        Reductions::CheckFlagReduceAndPrintHits(md, "solve_fail", Implicit::status_names, IndexDomain::interior, false, 2);
+        // Use counts recorded by Step if there are any, otherwise count now
+        if (!Reductions::StartRecordedFlagReduce(md, "Implicit", "solve_fail_counts", Implicit::status_names.size(), Reductions::Channel::solve_fail))
+            Reductions::StartFlagReduce(md, "solve_fail", Implicit::status_names, IndexDomain::interior, false, Reductions::Channel::solve_fail);
+        Reductions::FinishFlagReduce(md, "solve_fail", Implicit::status_names, IndexDomain::interior, false, Reductions::Channel::solve_fail);
     }
 
     return TaskStatus::complete;
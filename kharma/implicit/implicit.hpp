@@ -74,6 +74,14 @@ static const std::map<int, std::string> status_names = {
     {(int) SolverStatus::backtrack, "backtrack"}
 };
 
+// Layout of the per-zone Implicit.closure field, all of which is fixed over a substep's solve:
+// the EMHD tau, chi_e, nu_e from the sub-step's initial state, then u_mu and Theta at the
+// full step's initial state, for the time-derivative sources
+namespace ClosureIdx {
+    static constexpr int tau = 0, chi_e = 1, nu_e = 2, ucov_old = 3, theta_old = 7;
+    static constexpr int n = 8;
+}
+
 template <typename T>
 KOKKOS_INLINE_FUNCTION bool failed(T status_flag)
 {
@@ -81,6 +89,42 @@ KOKKOS_INLINE_FUNCTION bool failed(T status_flag)
     return static_cast<int>(status_flag) == static_cast<int>(SolverStatus::fail);
 }
 
+// Which zones of each block a call to Step() should solve:
+// `all`: every interior zone
+// `rind`: only the zones within nghost of a block face, i.e. those a neighbor needs for its ghost zones
+// `bulk`: only the zones inside the rind
+// Solving the rind first lets the driver start sending boundaries while the bulk is solved.
+enum class SolveRegion{all=0, rind, bulk};
+
+KOKKOS_INLINE_FUNCTION bool in_region(const SolveRegion& region, const IndexRange3& bulk,
+                                      const int& k, const int& j, const int& i)
+{
+    if (region == SolveRegion::all) return true;
+    const bool in_bulk = (i >= bulk.is) && (i <= bulk.ie) && (j >= bulk.js) && (j <= bulk.je) &&
+                         (k >= bulk.ks) && (k <= bulk.ke);
+    return in_bulk == (region == SolveRegion::bulk);
+}
+
+/**
+ * Persistent per-zone workspace for the Kokkos-kernels linear solves, indexed by flattened zone.
+ * Kept in the package params and re-allocated only when the number of zones or implicit variables changes.
+ */
+struct SolverWorkspace {
+    ParArray3D<Real> jacobian;
+    ParArray2D<Real> delta_prim, trans, work;
+    ParArray2D<int> pivot;
+
+    void Resize(const int& nzones, const int& nfvar)
+    {
+        if (jacobian.extent_int(0) == nzones && jacobian.extent_int(1) == nfvar) return;
+        jacobian   = ParArray3D<Real>("Implicit.ws_jacobian", nzones, nfvar, nfvar);
+        delta_prim = ParArray2D<Real>("Implicit.ws_delta_prim", nzones, nfvar);
+        trans      = ParArray2D<Real>("Implicit.ws_trans", nzones, nfvar);
+        work       = ParArray2D<Real>("Implicit.ws_work", nzones, 2*nfvar);
+        pivot      = ParArray2D<int>("Implicit.ws_pivot", nzones, nfvar);
+    }
+};
+
 /**
  * Initialization.  Set parameters.
  */
@@ -95,9 +139,11 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
  * @param md_solver should contain initial guess on call, contains result on return
  * @param md_linesearch should contain solver prims at start, updated in the linesearch
  * @param dt the timestep (current substep)
+ * @param region which zones to solve, see SolveRegion
  */
 TaskStatus Step(MeshData<Real> *md_full_step_init, MeshData<Real> *md_sub_step_init, MeshData<Real> *md_flux_src,
-                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt);
+                MeshData<Real> *md_linesearch, MeshData<Real> *md_solver, const Real& dt,
+                SolveRegion region=SolveRegion::all);
 
 /**
  * Get the names of all variables matching 'flag' in a deterministic order, placing implicitly-evolved variables first.
@@ -107,18 +153,37 @@ std::vector<std::string> GetOrderedNames(MeshBlockData<Real> *rc, const Metadata
 
 /**
  * @brief Fix bad zones that the implicit solver couldn't integrate. Similar to GRMHD::FixUtoP
+ * Works from a compacted list of the failed zones, so costs little when there are none.
  * 
- * @param mbd relevant fluid state
+ * @param md relevant fluid state
  * @return TaskStatus 
  */
-TaskStatus FixSolve(MeshBlockData<Real> *mbd);
-inline TaskStatus MeshFixSolve(MeshData<Real> *md) {
-    Flag("MeshFixSolve");
-    for (int i=0; i < md->NumBlocks(); ++i)
-        FixSolve(md->GetBlockData(i).get());
-    EndFlag();
-    return TaskStatus::complete;
-}
+TaskStatus MeshFixSolve(MeshData<Real> *md);
+
+/**
+ * Compact the (flattened) indices of zones where the solver failed, over the entire domain,
+ * into the "failed_list" param.  Returns the number of failed zones.
+ */
+int ListFailedZones(MeshData<Real> *md);
+
+/**
+ * Compact the (flattened) indices of zones still to be iterated into the "active_list" param,
+ * returning their number: all zones which have not failed, and if check_norm, which are also
+ * above rootfind_tol (or their own tolerance, with adaptive_tol).  Only zones in 'region' are listed.
+ */
+int ListActiveZones(MeshData<Real> *md, bool check_norm, SolveRegion region=SolveRegion::all);
+
+/**
+ * Bounds of the "bulk" of each block, that is, the interior less nghost zones at each face
+ * in every non-trivial direction.  May be empty for very small blocks.
+ */
+IndexRange3 BulkRange(MeshData<Real> *md);
+
+/**
+ * Copy all cell-centered variables in the bulk of each block from md_solver to md_final,
+ * after solving the bulk separately.  The rind and ghost zones of md_final are left alone.
+ */
+TaskStatus CopyBulk(MeshData<Real> *md_solver, MeshData<Real> *md_final);
 
 /**
  * Count up all nonzero solver flags on md.  Used for history file reductions.
@@ -135,11 +200,12 @@ TaskStatus PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md);
  * 
  * "Global" here are read-only input arrays addressed var(ip, k, j, i)
  * "Local" here is anything sliced (usually Scratch) addressable var(ip)
+ * closure holds the EMHD tau, chi_e, nu_e as computed from Ps, and the old-time terms from Pi, see ClosureIdx
  */
 template<typename Global>
 KOKKOS_INLINE_FUNCTION void calc_residual(const GRCoordinates& G, const Global& P_test,
                                           const Global& Pi, const Global& Ui, const Global& Ps,
-                                          const Global& dudt_explicit, const Global& dUi,
+                                          const Global& dudt_explicit, const Global& dUi, const Global& closure,
                                           const VarMap& m_p, const VarMap& m_u, const EMHD::EMHD_parameters& emhd_params,
                                           const EMHD::EMHD_parameters& emhd_params_s,const int& nfvar, 
                                           const int& k, const int& j, const int& i, 
@@ -162,9 +228,10 @@ KOKKOS_INLINE_FUNCTION void calc_residual(const GRCoordinates& G, const Global&
         Real &rq  = (m_u.Q >= 0) ? residual(m_u.Q, k, j, i) : throwaway;
         Real &rdP = (m_u.DP >= 0) ? residual(m_u.DP, k, j, i) : throwaway;
 
-        // Compute the EMHD parameters, which we'll re-use
-        Real tau, chi_e, nu_e;
-        EMHD::set_parameters(G, Ps, m_p, emhd_params, gam, k, j, i, tau, chi_e, nu_e);
+        // The EMHD parameters depend only on Ps, so they're computed once per substep
+        const Real tau   = closure(0, k, j, i);
+        const Real chi_e = closure(1, k, j, i);
+        const Real nu_e  = closure(2, k, j, i);
         GRMHD::calc_4vecs(G, Ps, m_p, k, j, i, Loci::center, Dtmp);
 
         // Compute new implicit source terms and time derivative source terms
@@ -174,10 +241,9 @@ KOKKOS_INLINE_FUNCTION void calc_residual(const GRCoordinates& G, const Global&
         if (m_u.Q >= 0)  rq  -= 0.5*(dUq + dUi(m_u.Q, k, j, i));
         if (m_u.DP >= 0) rdP -= 0.5*(dUdP + dUi(m_u.DP, k, j, i));
 
-        // Note we're now getting tau/chi_e/nu_e with emhd_params_s!
-        // TODO(BSP) split out time-dependent parts of the params struct
-        EMHD::set_parameters(G, Ps, m_p, emhd_params_s, gam, k, j, i, tau, chi_e, nu_e);
-        EMHD::time_derivative_sources(G, P_test, Pi, Ps, m_p,
+        Real ucov_old[GR_DIM];
+        DLOOP1 ucov_old[mu] = closure(ClosureIdx::ucov_old + mu, k, j, i);
+        EMHD::time_derivative_sources(G, P_test, ucov_old, closure(ClosureIdx::theta_old, k, j, i), Ps, m_p,
                 tau, chi_e, nu_e, Dtmp, emhd_params_s.higher_order_terms, gam,
                 dt, k, j, i, dUq, dUdP); // dU_time
         // ... - dU_time(ip)
@@ -208,7 +274,7 @@ KOKKOS_INLINE_FUNCTION void calc_residual(const GRCoordinates& G, const Global&
 template<typename Global>
 KOKKOS_INLINE_FUNCTION void calc_jacobian(const GRCoordinates& G, const Global& P_solver,
                                           const Global& P_full_step_init, const Global& U_full_step_init, const Global& P_sub_step_init,
-                                          const Global& flux_src, const Global& dU_implicit,
+                                          const Global& flux_src, const Global& dU_implicit, const Global& closure,
                                           const VarMap& m_p, const VarMap& m_u, const EMHD::EMHD_parameters& emhd_params_solver,
                                           const EMHD::EMHD_parameters& emhd_params_sub_step_init, const int& nvar, const int& nfvar,
                                           const int& k, const int& j, const int& i,
@@ -216,7 +282,7 @@ KOKKOS_INLINE_FUNCTION void calc_jacobian(const GRCoordinates& G, const Global&
                                           Global& jacobian, Global& residual)
 {
     // Calculate residual of P, cache
-    calc_residual(G, P_solver, P_full_step_init, U_full_step_init, P_sub_step_init, flux_src, dU_implicit,
+    calc_residual(G, P_solver, P_full_step_init, U_full_step_init, P_sub_step_init, flux_src, dU_implicit, closure,
                     m_p, m_u, emhd_params_solver, emhd_params_sub_step_init, nfvar, k, j, i, gam, dt, residual);
 
     // These store the *original* residual and P values,
@@ -239,7 +305,7 @@ KOKKOS_INLINE_FUNCTION void calc_jacobian(const GRCoordinates& G, const Global&
         }
 
         // Compute the residual for P_delta, OVERWRITES residual
-        calc_residual(G, P_solver, P_full_step_init, U_full_step_init, P_sub_step_init, flux_src, dU_implicit, 
+        calc_residual(G, P_solver, P_full_step_init, U_full_step_init, P_sub_step_init, flux_src, dU_implicit, closure, 
                     m_p, m_u, emhd_params_solver, emhd_params_sub_step_init, nfvar, k, j, i, gam, dt, residual);
 
         // Compute forward derivatives of each residual vs the primitive col
@@ -254,4 +320,221 @@ KOKKOS_INLINE_FUNCTION void calc_jacobian(const GRCoordinates& G, const Global&
     PLOOP residual(ip, k, j, i) = residual_save[ip];
 }
 
+/**
+ * Solve J * delta_prim = -residual in one zone without forming J, by unrestarted GMRES.
+ * Each product J*z is a forward difference of calc_residual, so the cost is one residual
+ * evaluation per Krylov iteration (at most max_krylov, and never more than nfvar).
+ *
+ * The system is right-preconditioned by the magnitude of each primitive, a diagonal scaling
+ * which costs nothing extra, and puts the variables on comparable footing.
+ * P_perturbed and residual_perturbed are overwritten, P_perturbed is left == P_solver on return.
+ */
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void gmres_solve(const GRCoordinates& G, const Global& P_solver, const Global& P_perturbed,
+                                        const Global& P_full_step_init, const Global& U_full_step_init, const Global& P_sub_step_init,
+                                        const Global& flux_src, const Global& dU_implicit, const Global& closure,
+                                        const VarMap& m_p, const VarMap& m_u, const EMHD::EMHD_parameters& emhd_params_solver,
+                                        const EMHD::EMHD_parameters& emhd_params_sub_step_init, const int& nvar, const int& nfvar,
+                                        const int& k, const int& j, const int& i,
+                                        const Real& jac_delta, const Real& gam, const double& dt,
+                                        const int& max_krylov, const Real& krylov_tol,
+                                        const Global& residual, Global& residual_perturbed, const Global& delta_prim)
+{
+    const int mmax = m::min(m::min(max_krylov, nfvar), MAX_VARS);
+    Real V[MAX_VARS+1][MAX_VARS], H[MAX_VARS+1][MAX_VARS];
+    Real g[MAX_VARS+1], cs[MAX_VARS], sn[MAX_VARS], D[MAX_VARS];
+
+    // Preconditioner, and the norm of the state for choosing the difference step
+    Real P_norm = 0.;
+    FLOOP {
+        const Real P_abs = m::abs(P_solver(ip, k, j, i));
+        D[ip] = (P_abs > jac_delta) ? P_abs : 1.;
+        P_norm += SQR(P_solver(ip, k, j, i));
+    }
+    P_norm = m::sqrt(P_norm);
+
+    // x0 = 0, so the initial Krylov vector is just -residual
+    Real beta = 0.;
+    FLOOP beta += SQR(residual(ip, k, j, i));
+    beta = m::sqrt(beta);
+    FLOOP delta_prim(ip, k, j, i) = 0.;
+    if (!(beta > 0.)) return;
+    FLOOP V[0][ip] = -residual(ip, k, j, i) / beta;
+    g[0] = beta;
+
+    int nkrylov = 0;
+    for (int kk = 0; kk < mmax; ++kk) {
+        // w = J * (D * V[kk]), by forward difference
+        Real z[MAX_VARS], z_norm = 0.;
+        FLOOP {
+            z[ip] = D[ip] * V[kk][ip];
+            z_norm += SQR(z[ip]);
+        }
+        z_norm = m::sqrt(z_norm);
+        const Real eps = jac_delta * (1. + P_norm) / (z_norm + SMALL);
+        FLOOP P_perturbed(ip, k, j, i) = P_solver(ip, k, j, i) + eps * z[ip];
+        calc_residual(G, P_perturbed, P_full_step_init, U_full_step_init, P_sub_step_init, flux_src, dU_implicit, closure,
+                        m_p, m_u, emhd_params_solver, emhd_params_sub_step_init, nfvar, k, j, i, gam, dt, residual_perturbed);
+        Real w[MAX_VARS];
+        FLOOP w[ip] = (residual_perturbed(ip, k, j, i) - residual(ip, k, j, i)) / eps;
+
+        // Modified Gram-Schmidt
+        for (int ii = 0; ii <= kk; ++ii) {
+            H[ii][kk] = 0.;
+            FLOOP H[ii][kk] += w[ip] * V[ii][ip];
+            FLOOP w[ip] -= H[ii][kk] * V[ii][ip];
+        }
+        Real w_norm = 0.;
+        FLOOP w_norm += SQR(w[ip]);
+        w_norm = m::sqrt(w_norm);
+        H[kk+1][kk] = w_norm;
+
+        // Apply the previous Givens rotations to the new column, then eliminate H[kk+1][kk]
+        for (int ii = 0; ii < kk; ++ii) {
+            const Real tmp = cs[ii] * H[ii][kk] + sn[ii] * H[ii+1][kk];
+            H[ii+1][kk] = -sn[ii] * H[ii][kk] + cs[ii] * H[ii+1][kk];
+            H[ii][kk] = tmp;
+        }
+        const Real denom = m::sqrt(SQR(H[kk][kk]) + SQR(H[kk+1][kk]));
+        cs[kk] = (denom > 0.) ? H[kk][kk] / denom : 1.;
+        sn[kk] = (denom > 0.) ? H[kk+1][kk] / denom : 0.;
+        H[kk][kk] = cs[kk] * H[kk][kk] + sn[kk] * H[kk+1][kk];
+        H[kk+1][kk] = 0.;
+        g[kk+1] = -sn[kk] * g[kk];
+        g[kk] = cs[kk] * g[kk];
+
+        nkrylov = kk + 1;
+        // Stop on convergence, or on a (lucky) breakdown
+        if (m::abs(g[kk+1]) <= krylov_tol * beta || !(w_norm > 0.)) break;
+        FLOOP V[kk+1][ip] = w[ip] / w_norm;
+    }
+    // Restore the scratch state
+    PLOOP P_perturbed(ip, k, j, i) = P_solver(ip, k, j, i);
+
+    // Back-substitute for the Krylov coefficients, and assemble delta_prim = D * V * y
+    Real y[MAX_VARS];
+    for (int r = nkrylov - 1; r >= 0; --r) {
+        y[r] = g[r];
+        for (int q = r + 1; q < nkrylov; ++q)
+            y[r] -= H[r][q] * y[q];
+        y[r] = (m::abs(H[r][r]) > SMALL) ? y[r] / H[r][r] : 0.;
+    }
+    FLOOP {
+        Real x = 0.;
+        for (int r = 0; r < nkrylov; ++r)
+            x += y[r] * V[r][ip];
+        delta_prim(ip, k, j, i) = D[ip] * x;
+    }
+}
+
+/**
+ * Solve jacobian * delta_prim = -residual in one zone, for a system of compile-time size N.
+ * With N known, the loops unroll and the whole system stays in registers, rather than scratch.
+ * LU decomposition with partial pivoting.  Row swaps are written as predicated copies
+ * over every row, so that no register array is ever indexed dynamically.
+ */
+template<int N, typename Global>
+KOKKOS_INLINE_FUNCTION void batched_lu_solve(const Global& jacobian, const Global& residual, const Global& delta_prim,
+                                             const int& k, const int& j, const int& i, const Real& tiny)
+{
+    Real A[N][N], x[N];
+    for (int ip = 0; ip < N; ++ip) {
+        x[ip] = -residual(ip, k, j, i);
+        for (int jp = 0; jp < N; ++jp)
+            A[ip][jp] = jacobian(ip*N+jp, k, j, i);
+    }
+
+    for (int c = 0; c < N; ++c) {
+        // Find the pivot row
+        int p = c;
+        Real amax = m::abs(A[c][c]);
+        for (int r = c + 1; r < N; ++r) {
+            if (m::abs(A[r][c]) > amax) {
+                amax = m::abs(A[r][c]);
+                p = r;
+            }
+        }
+        // Swap it into place
+        for (int r = c + 1; r < N; ++r) {
+            if (r == p) {
+                for (int q = 0; q < N; ++q) {
+                    const Real tmp = A[c][q];
+                    A[c][q] = A[r][q];
+                    A[r][q] = tmp;
+                }
+                const Real tmp = x[c];
+                x[c] = x[r];
+                x[r] = tmp;
+            }
+        }
+        // Guard against singular systems as SerialLU does, by bounding the pivot away from 0
+        if (m::abs(A[c][c]) < tiny) A[c][c] = (A[c][c] < 0.) ? -tiny : tiny;
+        // Eliminate below
+        for (int r = c + 1; r < N; ++r) {
+            const Real f = A[r][c] / A[c][c];
+            for (int q = c + 1; q < N; ++q)
+                A[r][q] -= f * A[c][q];
+            x[r] -= f * x[c];
+        }
+    }
+
+    // Back-substitute
+    for (int r = N - 1; r >= 0; --r) {
+        for (int q = r + 1; q < N; ++q)
+            x[r] -= A[r][q] * x[q];
+        x[r] /= A[r][r];
+    }
+
+    for (int ip = 0; ip < N; ++ip)
+        delta_prim(ip, k, j, i) = x[ip];
+}
+
+/**
+ * Solve jacobian * delta_prim = -residual in one zone, for a system of run-time size n.
+ * The same LU with partial pivoting as batched_lu_solve, but working in-place on the global arrays.
+ * Overwrites jacobian.
+ */
+template<typename Global>
+KOKKOS_INLINE_FUNCTION void pivoted_lu_solve(const Global& jacobian, const Global& residual, const Global& delta_prim,
+                                             const int& n, const int& k, const int& j, const int& i, const Real& tiny)
+{
+    for (int ip = 0; ip < n; ++ip)
+        delta_prim(ip, k, j, i) = -residual(ip, k, j, i);
+
+    for (int c = 0; c < n; ++c) {
+        int p = c;
+        Real amax = m::abs(jacobian(c*n+c, k, j, i));
+        for (int r = c + 1; r < n; ++r) {
+            if (m::abs(jacobian(r*n+c, k, j, i)) > amax) {
+                amax = m::abs(jacobian(r*n+c, k, j, i));
+                p = r;
+            }
+        }
+        if (p != c) {
+            for (int q = 0; q < n; ++q) {
+                const Real tmp = jacobian(c*n+q, k, j, i);
+                jacobian(c*n+q, k, j, i) = jacobian(p*n+q, k, j, i);
+                jacobian(p*n+q, k, j, i) = tmp;
+            }
+            const Real tmp = delta_prim(c, k, j, i);
+            delta_prim(c, k, j, i) = delta_prim(p, k, j, i);
+            delta_prim(p, k, j, i) = tmp;
+        }
+        Real &pivot = jacobian(c*n+c, k, j, i);
+        if (m::abs(pivot) < tiny) pivot = (pivot < 0.) ? -tiny : tiny;
+        for (int r = c + 1; r < n; ++r) {
+            const Real f = jacobian(r*n+c, k, j, i) / pivot;
+            for (int q = c + 1; q < n; ++q)
+                jacobian(r*n+q, k, j, i) -= f * jacobian(c*n+q, k, j, i);
+            delta_prim(r, k, j, i) -= f * delta_prim(c, k, j, i);
+        }
+    }
+
+    for (int r = n - 1; r >= 0; --r) {
+        for (int q = r + 1; q < n; ++q)
+            delta_prim(r, k, j, i) -= jacobian(r*n+q, k, j, i) * delta_prim(q, k, j, i);
+        delta_prim(r, k, j, i) /= jacobian(r*n+r, k, j, i);
+    }
+}
+
 } // namespace Implicit
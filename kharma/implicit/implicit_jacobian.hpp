@@ -0,0 +1,377 @@
+/*
+ *  File: implicit_jacobian.hpp
+ *
+ *  BSD 3-Clause License
+ *
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+#include "emhd.hpp"
+#include "grmhd_functions.hpp"
+#include "implicit.hpp"
+
+/**
+ * Exact Jacobian of the implicit residual, by forward-mode automatic differentiation.
+ *
+ * The residual in calc_residual is re-written here over dual numbers, which carry the value
+ * of each quantity alongside its derivatives w.r.t. each implicit primitive.  One evaluation
+ * then yields both the residual and every column of the Jacobian, replacing the nfvar + 1
+ * residual evaluations (and the choice of jacobian_delta) in calc_jacobian.
+ *
+ * This covers the ideal GRMHD variables plus the EMHD q/dP, i.e. any implicit system built
+ * from rho, u, uvec, B_P, q, dP.  Anything else should use the finite-difference version,
+ * see CanUseADJacobian.
+ * Any change to calc_residual or the functions it calls must be mirrored here!
+ */
+namespace Implicit
+{
+
+/**
+ * Dual number with N derivative components
+ */
+template<int N>
+struct Dual {
+    Real v;
+    Real d[N];
+
+    KOKKOS_INLINE_FUNCTION Dual() : v(0.) { for (int n = 0; n < N; ++n) d[n] = 0.; }
+    KOKKOS_INLINE_FUNCTION Dual(const Real& val) : v(val) { for (int n = 0; n < N; ++n) d[n] = 0.; }
+    // Independent variable number "seed"
+    KOKKOS_INLINE_FUNCTION Dual(const Real& val, const int& seed) : v(val)
+    {
+        for (int n = 0; n < N; ++n) d[n] = (n == seed) ? 1. : 0.;
+    }
+
+    KOKKOS_INLINE_FUNCTION Dual& operator+=(const Dual& b)
+    {
+        v += b.v;
+        for (int n = 0; n < N; ++n) d[n] += b.d[n];
+        return *this;
+    }
+    KOKKOS_INLINE_FUNCTION Dual& operator-=(const Dual& b)
+    {
+        v -= b.v;
+        for (int n = 0; n < N; ++n) d[n] -= b.d[n];
+        return *this;
+    }
+    KOKKOS_INLINE_FUNCTION Dual& operator*=(const Dual& b)
+    {
+        for (int n = 0; n < N; ++n) d[n] = d[n] * b.v + v * b.d[n];
+        v *= b.v;
+        return *this;
+    }
+    KOKKOS_INLINE_FUNCTION Dual& operator*=(const Real& b)
+    {
+        v *= b;
+        for (int n = 0; n < N; ++n) d[n] *= b;
+        return *this;
+    }
+};
+
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator-(const Dual<N>& a)
+{
+    Dual<N> c(-a.v);
+    for (int n = 0; n < N; ++n) c.d[n] = -a.d[n];
+    return c;
+}
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator+(const Dual<N>& a, const Dual<N>& b) { Dual<N> c = a; c += b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator-(const Dual<N>& a, const Dual<N>& b) { Dual<N> c = a; c -= b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator*(const Dual<N>& a, const Dual<N>& b) { Dual<N> c = a; c *= b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator/(const Dual<N>& a, const Dual<N>& b)
+{
+    Dual<N> c(a.v / b.v);
+    for (int n = 0; n < N; ++n) c.d[n] = (a.d[n] - c.v * b.d[n]) / b.v;
+    return c;
+}
+
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator+(const Dual<N>& a, const Real& b) { Dual<N> c = a; c.v += b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator+(const Real& a, const Dual<N>& b) { return b + a; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator-(const Dual<N>& a, const Real& b) { Dual<N> c = a; c.v -= b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator-(const Real& a, const Dual<N>& b) { return -b + a; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator*(const Dual<N>& a, const Real& b) { Dual<N> c = a; c *= b; return c; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator*(const Real& a, const Dual<N>& b) { return b * a; }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator/(const Dual<N>& a, const Real& b) { return a * (1. / b); }
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> operator/(const Real& a, const Dual<N>& b)
+{
+    Dual<N> c(a / b.v);
+    for (int n = 0; n < N; ++n) c.d[n] = -c.v * b.d[n] / b.v;
+    return c;
+}
+
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> ad_sqrt(const Dual<N>& a)
+{
+    Dual<N> c(m::sqrt(a.v));
+    // Take the derivative at 0 to be 0 rather than inf: this is reached only for
+    // disabled terms, e.g. conduction_alpha == 0, which should contribute nothing
+    const Real dv = (c.v > 0.) ? 0.5 / c.v : 0.;
+    for (int n = 0; n < N; ++n) c.d[n] = dv * a.d[n];
+    return c;
+}
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> ad_max(const Dual<N>& a, const Real& b)
+{
+    return (a.v > b) ? a : Dual<N>(b);
+}
+
+template<int N>
+KOKKOS_INLINE_FUNCTION Dual<N> ad_dot(const Dual<N> a[GR_DIM], const Dual<N> b[GR_DIM])
+{
+    Dual<N> c;
+    DLOOP1 c += a[mu] * b[mu];
+    return c;
+}
+template<int N>
+KOKKOS_INLINE_FUNCTION void ad_lower(const GRCoordinates& G, const Dual<N> vcon[GR_DIM], Dual<N> vcov[GR_DIM],
+                                     const int& j, const int& i)
+{
+    DLOOP1 vcov[mu] = Dual<N>();
+    DLOOP2 vcov[mu] += G.gcov(Loci::center, j, i, mu, nu) * vcon[nu];
+}
+
+/**
+ * Read primitive ip, seeding it as an independent variable if it is implicit
+ */
+template<int N, typename Global>
+KOKKOS_INLINE_FUNCTION Dual<N> ad_prim(const Global& P, const int& ip, const int& nfvar,
+                                       const int& k, const int& j, const int& i)
+{
+    return (ip < nfvar) ? Dual<N>(P(ip, k, j, i), ip) : Dual<N>(P(ip, k, j, i));
+}
+
+/**
+ * Fill one row (U - Ui)/dt - dudt_explicit of the residual, if it is an implicit one
+ */
+template<int N, typename Global>
+KOKKOS_INLINE_FUNCTION void ad_residual_row(Dual<N> res[N], const int& row, const int& nfvar, const Dual<N>& U,
+                                            const Global& Ui, const Global& dudt_explicit,
+                                            const int& k, const int& j, const int& i, const double& dt)
+{
+    if (row >= 0 && row < nfvar)
+        res[row] = (U - Ui(row, k, j, i)) / dt - dudt_explicit(row, k, j, i);
+}
+
+/**
+ * Whether the implicit variables are a set calc_jacobian_ad knows how to differentiate:
+ * only rho, u, uvec, B_P, q, dP, with matching primitive & conserved indices.
+ */
+inline bool CanUseADJacobian(const VarMap& m_p, const VarMap& m_u, const int& nfvar)
+{
+    const int p_idx[] = {m_p.RHO, m_p.UU, m_p.U1, m_p.U2, m_p.U3, m_p.B1, m_p.B2, m_p.B3, m_p.Q, m_p.DP};
+    const int u_idx[] = {m_u.RHO, m_u.UU, m_u.U1, m_u.U2, m_u.U3, m_u.B1, m_u.B2, m_u.B3, m_u.Q, m_u.DP};
+    int n_known = 0;
+    for (int n = 0; n < 10; ++n) {
+        if (p_idx[n] != u_idx[n]) return false;
+        if (p_idx[n] >= 0 && p_idx[n] < nfvar) n_known++;
+    }
+    // The fluid variables must all be implicit.  q & dP too, as only their residual is normalized.
+    for (int n = 0; n < 5; ++n)
+        if (p_idx[n] < 0 || p_idx[n] >= nfvar) return false;
+    if (m_p.Q >= nfvar || m_p.DP >= nfvar) return false;
+    return n_known == nfvar;
+}
+
+/**
+ * Evaluate the residual and the jacobian together, in one zone.  Same arguments as calc_jacobian,
+ * minus jac_delta.  N is the number of derivatives carried, and must be >= nfvar
+ */
+template<int N, typename Global>
+KOKKOS_INLINE_FUNCTION void calc_jacobian_ad(const GRCoordinates& G, const Global& P_solver,
+                                             const Global& P_full_step_init, const Global& U_full_step_init, const Global& P_sub_step_init,
+                                             const Global& flux_src, const Global& dU_implicit, const Global& closure,
+                                             const VarMap& m_p, const VarMap& m_u,
+                                             const EMHD::EMHD_parameters& emhd_params_solver,
+                                             const EMHD::EMHD_parameters& emhd_params_sub_step_init, const int& nfvar,
+                                             const int& k, const int& j, const int& i,
+                                             const Real& gam, const double& dt,
+                                             Global& jacobian, Global& residual)
+{
+    using D = Dual<N>;
+    const Real gdet = G.gdet(Loci::center, j, i);
+
+    // Trial primitives
+    const D rho = ad_prim<N>(P_solver, m_p.RHO, nfvar, k, j, i);
+    const D u   = ad_prim<N>(P_solver, m_p.UU, nfvar, k, j, i);
+    D uvec[NVEC], B_P[NVEC];
+    VLOOP uvec[v] = ad_prim<N>(P_solver, m_p.U1 + v, nfvar, k, j, i);
+    VLOOP B_P[v]  = (m_p.B1 >= 0) ? ad_prim<N>(P_solver, m_p.B1 + v, nfvar, k, j, i) : D();
+    const D qtilde  = (m_p.Q >= 0)  ? ad_prim<N>(P_solver, m_p.Q, nfvar, k, j, i) : D();
+    const D dPtilde = (m_p.DP >= 0) ? ad_prim<N>(P_solver, m_p.DP, nfvar, k, j, i) : D();
+
+    // 4-vectors, as GRMHD::calc_4vecs
+    D qsq;
+    VLOOP2 qsq += G.gcov(Loci::center, j, i, v+1, w+1) * uvec[v] * uvec[w];
+    const D gamma = ad_sqrt(1. + qsq);
+    const Real alpha = 1. / m::sqrt(-G.gcon(Loci::center, j, i, 0, 0));
+    D ucon[GR_DIM], ucov[GR_DIM], bcon[GR_DIM], bcov[GR_DIM];
+    ucon[0] = gamma / alpha;
+    VLOOP ucon[v+1] = uvec[v] - gamma * alpha * G.gcon(Loci::center, j, i, 0, v+1);
+    ad_lower(G, ucon, ucov, j, i);
+    if (m_p.B1 >= 0) {
+        VLOOP bcon[0] += B_P[v] * ucov[v+1];
+        VLOOP bcon[v+1] = (B_P[v] + bcon[0] * ucon[v+1]) / ucon[0];
+        ad_lower(G, bcon, bcov, j, i);
+    }
+
+    // First row of the stress-energy tensor, as Flux::calc_tensor
+    const D pgas = (gam - 1.) * u;
+    D T[GR_DIM];
+    if ((m_p.Q >= 0 || m_p.DP >= 0) && emhd_params_solver.feedback) {
+        const EMHD::EMHD_parameters& ep = emhd_params_solver;
+        const D Theta = pgas / rho;
+        const D cs2   = gam * pgas / (rho + gam * u);
+        D q = qtilde, dP = dPtilde;
+        if (ep.higher_order_terms) {
+            if (ep.type == EMHD::ClosureType::kappa_eta) {
+                q  *= ad_sqrt(ep.kappa * Theta * Theta / ep.tau);
+                dP *= ad_sqrt(ep.eta * Theta / ep.tau);
+            } else {
+                q  *= ad_sqrt(rho * ep.conduction_alpha * cs2 * Theta * Theta);
+                dP *= ad_sqrt(rho * ep.viscosity_alpha * cs2 * Theta);
+            }
+        }
+        const D bsq   = ad_max(ad_dot(bcon, bcov), SMALL);
+        const D b_mag = ad_sqrt(bsq);
+        const D eta   = pgas + rho + u + bsq;
+        const D ptot  = pgas + 0.5 * bsq;
+        DLOOP1 {
+            const Real delta = (mu == 0) ? 1. : 0.;
+            T[mu] = eta * ucon[0] * ucov[mu] + ptot * delta - bcon[0] * bcov[mu]
+                    + (q / b_mag) * ((ucon[0] * bcov[mu]) + (bcon[0] * ucov[mu]))
+                    - dP * ((bcon[0] * bcov[mu] / bsq) - (1./3.) * (delta + ucon[0] * ucov[mu]));
+        }
+    } else {
+        // GRMHD, or GRHD when bcon is identically 0
+        const D bsq  = ad_dot(bcon, bcov);
+        const D eta  = pgas + rho + u + bsq;
+        const D ptot = pgas + 0.5 * bsq;
+        DLOOP1 T[mu] = eta * ucon[0] * ucov[mu] + ptot * ((mu == 0) ? 1. : 0.) - bcon[0] * bcov[mu];
+    }
+
+    // (U_test - Ui)/dt - dudt_explicit, with U_test as Flux::prim_to_flux
+    D res[N];
+    const Global& Ui = U_full_step_init;
+    const D U_rho = rho * ucon[0] * gdet;
+    ad_residual_row(res, m_u.RHO, nfvar, U_rho, Ui, flux_src, k, j, i, dt);
+    ad_residual_row(res, m_u.UU, nfvar, T[0] * gdet + U_rho, Ui, flux_src, k, j, i, dt);
+    VLOOP ad_residual_row(res, m_u.U1 + v, nfvar, T[v+1] * gdet, Ui, flux_src, k, j, i, dt);
+    if (m_u.B1 >= 0)
+        VLOOP ad_residual_row(res, m_u.B1 + v, nfvar, B_P[v] * gdet, Ui, flux_src, k, j, i, dt);
+    if (m_u.Q >= 0)
+        ad_residual_row(res, m_u.Q, nfvar, qtilde * ucon[0] * gdet, Ui, flux_src, k, j, i, dt);
+    if (m_u.DP >= 0)
+        ad_residual_row(res, m_u.DP, nfvar, dPtilde * ucon[0] * gdet, Ui, flux_src, k, j, i, dt);
+
+    if (m_u.Q >= 0 || m_u.DP >= 0) {
+        const Global& Ps = P_sub_step_init;
+        D rq  = (m_u.Q >= 0)  ? res[m_u.Q]  : D();
+        D rdP = (m_u.DP >= 0) ? res[m_u.DP] : D();
+
+        // ... - 0.5*(dU_new(ip) + dUi(ip)) ..., as EMHD::implicit_sources
+        const Real tau   = closure(0, k, j, i);
+        const Real chi_e = closure(1, k, j, i);
+        const Real nu_e  = closure(2, k, j, i);
+        if (m_u.Q >= 0)  rq  -= 0.5 * (-gdet * (qtilde / tau) + dU_implicit(m_u.Q, k, j, i));
+        if (m_u.DP >= 0) rdP -= 0.5 * (-gdet * (dPtilde / tau) + dU_implicit(m_u.DP, k, j, i));
+
+        // ... - dU_time(ip), as EMHD::time_derivative_sources.
+        // Only the time derivatives depend on the trial state; coefficients use Ps
+        const bool higher_order_terms = emhd_params_sub_step_init.higher_order_terms;
+        FourVectors Ds;
+        GRMHD::calc_4vecs(G, Ps, m_p, k, j, i, Loci::center, Ds);
+        const Real bsq   = m::max(dot(Ds.bcon, Ds.bcov), SMALL);
+        const Real mag_b = m::sqrt(bsq);
+
+        D dt_ucov[GR_DIM];
+        DLOOP1 dt_ucov[mu] = (ucov[mu] - closure(ClosureIdx::ucov_old + mu, k, j, i)) / dt;
+        D div_ucon;
+        DLOOP1 div_ucon += G.gcon(Loci::center, j, i, 0, mu) * dt_ucov[mu];
+        const D Theta_new    = ad_max((gam - 1) * u / rho, SMALL);
+        const Real Theta_old = closure(ClosureIdx::theta_old, k, j, i);
+        const D dt_Theta     = (Theta_new - Theta_old) / dt;
+
+        const Real rho_s   = Ps(m_p.RHO, k, j, i);
+        const Real Theta_s = (gam - 1) * Ps(m_p.UU, k, j, i) / Ps(m_p.RHO, k, j, i);
+        if (m_u.Q >= 0) {
+            D q0 = -rho_s * chi_e * (Ds.bcon[0] / mag_b) * dt_Theta;
+            DLOOP1 q0 -= rho_s * chi_e * (Ds.bcon[mu] / mag_b) * Theta_s * Ds.ucon[0] * dt_ucov[mu];
+            if (higher_order_terms)
+                q0 *= (chi_e != 0) ? m::sqrt(tau / (chi_e * rho_s * Theta_s * Theta_s)) : 0.0;
+            rq -= gdet * (q0 / tau);
+            if (higher_order_terms)
+                rq -= gdet * (Ps(m_p.Q, k, j, i) / 2.) * div_ucon;
+        }
+        if (m_u.DP >= 0) {
+            D dP0 = -rho_s * nu_e * div_ucon;
+            DLOOP1 dP0 += 3. * rho_s * nu_e * (Ds.bcon[0] * Ds.bcon[mu] / bsq) * dt_ucov[mu];
+            if (higher_order_terms)
+                dP0 *= (nu_e != 0) ? m::sqrt(tau / (nu_e * rho_s * Theta_s)) : 0.0;
+            rdP -= gdet * (dP0 / tau);
+            if (higher_order_terms)
+                rdP -= gdet * (Ps(m_p.DP, k, j, i) / 2.) * div_ucon;
+        }
+
+        // Normalize
+        rq  *= tau;
+        rdP *= tau;
+        if (emhd_params_solver.higher_order_terms) {
+            const Real uu    = Ps(m_p.UU, k, j, i);
+            const Real Theta = (gam - 1.) * uu / rho_s;
+            rq  *= (chi_e != 0) ? m::sqrt(rho_s * chi_e * tau * Theta * Theta) / tau : 1.;
+            rdP *= (nu_e != 0)  ? m::sqrt(rho_s * nu_e * tau * Theta) / tau : 1.;
+        }
+        if (m_u.Q >= 0)  res[m_u.Q]  = rq;
+        if (m_u.DP >= 0) res[m_u.DP] = rdP;
+    }
+
+    for (int row = 0; row < nfvar; row++) {
+        residual(row, k, j, i) = res[row].v;
+        for (int col = 0; col < nfvar; col++)
+            jacobian(row*nfvar+col, k, j, i) = res[row].d[col];
+    }
+}
+
+} // namespace Implicit
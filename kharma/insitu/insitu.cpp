@@ -0,0 +1,178 @@
+/* 
+ *  File: insitu.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "insitu.hpp"
+
+#include <dlfcn.h>
+
+namespace {
+
+/**
+ * Describe the last ndim dimensions of a (contiguous, LayoutRight) ParArrayND, slowest first
+ */
+template<typename Arr>
+kharma_insitu_array MakeArray(const char *name, const Arr& arr, const int& ndim)
+{
+    kharma_insitu_array a;
+    a.name = name;
+    a.data = arr.data();
+    a.ndim = ndim;
+    a.dtype_bits = 8 * sizeof(Real);
+    int64_t stride = 1;
+    for (int d = ndim - 1; d >= 0; d--) {
+        a.shape[d] = arr.GetDim(ndim - d);
+        a.strides[d] = stride;
+        stride *= a.shape[d];
+    }
+    return a;
+}
+
+} // namespace
+
+std::shared_ptr<KHARMAPackage> InSitu::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("InSitu");
+    Params &params = pkg->AllParams();
+
+    // Call the plugin every dn steps
+    const int dn = pin->GetOrAddInteger("insitu", "dn", 1);
+    if (dn < 1) throw std::invalid_argument("In-situ analysis cadence <insitu>dn must be at least 1!");
+    params.Add("dn", dn);
+
+    const std::string library = pin->GetString("insitu", "library");
+    const std::string args = pin->GetOrAddString("insitu", "args", "");
+    Plugin plugin;
+    plugin.handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (plugin.handle == nullptr)
+        throw std::runtime_error("Could not load in-situ analysis library "+library+": "+dlerror());
+    plugin.init = reinterpret_cast<kharma_insitu_init_t>(dlsym(plugin.handle, "kharma_insitu_init"));
+    plugin.execute = reinterpret_cast<kharma_insitu_execute_t>(dlsym(plugin.handle, "kharma_insitu_execute"));
+    plugin.finalize = reinterpret_cast<kharma_insitu_finalize_t>(dlsym(plugin.handle, "kharma_insitu_finalize"));
+    if (plugin.execute == nullptr)
+        throw std::runtime_error("In-situ analysis library "+library+" does not define kharma_insitu_execute!");
+    if (plugin.init != nullptr && plugin.init(KHARMA_INSITU_VERSION, args.c_str()) != 0)
+        throw std::runtime_error("In-situ analysis library "+library+" failed to initialize!");
+    params.Add("plugin", plugin);
+
+    pkg->PostStepWork = InSitu::Execute;
+    pkg->PostExecute = InSitu::PostExecute;
+
+    return pkg;
+}
+
+void InSitu::Execute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    const auto& params = pmesh->packages.Get("InSitu")->AllParams();
+    // Parthenon advances tm.time & tm.ncycle only after PostStepWork, so these are after the step
+    const int ncycle = tm.ncycle + 1;
+    if (ncycle % params.Get<int>("dn") != 0) return;
+    Flag("InSituAnalysis");
+    const Plugin& plugin = params.Get<Plugin>("plugin");
+
+    const int nblocks = pmesh->block_list.size();
+    std::vector<std::vector<kharma_insitu_array>> arrays(nblocks);
+    std::vector<kharma_insitu_block> blocks(nblocks);
+    for (int b = 0; b < nblocks; b++) {
+        auto &pmb = pmesh->block_list[b];
+        auto &rc = pmb->meshblock_data.Get();
+
+        // Primitive variables, as [component, X3, X2, X1]
+        auto vars = rc->GetVariablesByFlag({Metadata::GetUserFlag("Primitive"), Metadata::Cell}).vars();
+        for (auto &var : vars) {
+            if (!var->IsAllocated()) continue;
+            arrays[b].push_back(MakeArray(var->label().c_str(), var->data, 4));
+        }
+
+        // Geometry caches, see GRCoordinates
+#if !FAST_CARTESIAN && !NO_CACHE
+        const auto& G = pmb->coords;
+        if (!G.flat_cartesian) {
+            arrays[b].push_back(MakeArray("gcon", G.gcon_direct, 4));
+            arrays[b].push_back(MakeArray("gcov", G.gcov_direct, 4));
+            arrays[b].push_back(MakeArray("gdet", G.gdet_direct, 3));
+            arrays[b].push_back(MakeArray("conn", G.conn_direct, 4));
+            arrays[b].push_back(MakeArray("gdet_conn", G.gdet_conn_direct, 4));
+        }
+#endif
+
+        auto &block = blocks[b];
+        block.gid = pmb->gid;
+        block.level = pmb->loc.level();
+        block.nghost = Globals::nghost;
+        for (int d = 0; d < 3; d++) {
+            const CoordinateDirection dir = static_cast<CoordinateDirection>(d + 1);
+            block.xmin[d] = pmb->block_size.xmin(dir);
+            block.xmax[d] = pmb->block_size.xmax(dir);
+        }
+        block.narrays = arrays[b].size();
+        block.arrays = arrays[b].data();
+    }
+
+    kharma_insitu_step step;
+    step.version = KHARMA_INSITU_VERSION;
+#if defined(KOKKOS_ENABLE_CUDA)
+    step.device_type = KHARMA_INSITU_CUDA;
+    cudaGetDevice(&step.device_id);
+#elif defined(KOKKOS_ENABLE_HIP)
+    step.device_type = KHARMA_INSITU_ROCM;
+    hipGetDevice(&step.device_id);
+#elif defined(KOKKOS_ENABLE_SYCL)
+    step.device_type = KHARMA_INSITU_ONEAPI;
+    step.device_id = 0;
+#else
+    step.device_type = KHARMA_INSITU_CPU;
+    step.device_id = 0;
+#endif
+    step.rank = MPIRank();
+    step.nranks = MPINumRanks();
+    step.ncycle = ncycle;
+    step.t = tm.time + tm.dt;
+    step.dt = tm.dt;
+    step.nblocks = nblocks;
+    step.blocks = blocks.data();
+
+    // The plugin may read the arrays from any stream, so they must be complete
+    Kokkos::fence();
+    if (plugin.execute(&step) != 0)
+        throw std::runtime_error("In-situ analysis failed at step "+std::to_string(ncycle)+"!");
+
+    EndFlag();
+}
+
+void InSitu::PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    const Plugin& plugin = pmesh->packages.Get("InSitu")->Param<Plugin>("plugin");
+    if (plugin.finalize != nullptr) plugin.finalize();
+    dlclose(plugin.handle);
+}
@@ -0,0 +1,81 @@
+/* 
+ *  File: insitu.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+#include "insitu_interface.h"
+
+/**
+ * In-situ analysis through a user-provided plugin library, see insitu_interface.h.
+ *
+ * <insitu>library is loaded at startup and its kharma_insitu_init is passed <insitu>args.
+ * Then every <insitu>dn steps, after the step completes, kharma_insitu_execute is passed
+ * the primitive variables (shape [component, X3, X2, X1], including ghost zones) and the geometry
+ * caches of every local block, in place in device memory: gcon & gcov [X2, loc, X1, sym],
+ * gdet [X2, loc, X1], conn & gdet_conn [X2, X1, mu, sym], with symmetric index pairs packed as
+ * in sym_index.  Geometry is omitted in flat space and in builds without caches.
+ *
+ * Imaging, integrals and the like can then run on the device alongside the simulation, without
+ * writing or re-reading dumps.
+ */
+namespace InSitu {
+
+/**
+ * Entry points of the loaded plugin
+ */
+struct Plugin {
+    void *handle = nullptr;
+    kharma_insitu_init_t init = nullptr;
+    kharma_insitu_execute_t execute = nullptr;
+    kharma_insitu_finalize_t finalize = nullptr;
+};
+
+/**
+ * Load the plugin and initialize it
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Describe this rank's blocks and call the plugin, if due.  Registered as PostStepWork
+ */
+void Execute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+/**
+ * Finalize and unload the plugin
+ */
+void PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+}
@@ -0,0 +1,107 @@
+/* 
+ *  File: insitu_interface.h
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+/**
+ * C interface for in-situ analysis plugins, loaded by the InSitu package (see insitu.hpp).
+ *
+ * A plugin is a shared library exporting kharma_insitu_execute, and optionally kharma_insitu_init
+ * and kharma_insitu_finalize.  Every call to kharma_insitu_execute describes the primitive variables
+ * and the geometry caches of every block on the calling rank, as pointers to KHARMA's own arrays:
+ * on the device for GPU builds, never copied.  Arrays follow DLPack conventions
+ * (device type codes, shape & strides in elements, dtype as float of 'bits'), so that a Python or
+ * Ascent/Catalyst adapter can wrap them directly.  The pointers are valid only during the call,
+ * and must not be written to.
+ *
+ * This header deliberately depends on nothing from KHARMA, so plugins can be built separately:
+ *   cc -shared -fPIC -I/path/to/kharma/kharma/insitu my_analysis.c -o libmy_analysis.so
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KHARMA_INSITU_VERSION 1
+
+/** Device holding the arrays, as DLPack's DLDeviceType */
+enum kharma_insitu_device { KHARMA_INSITU_CPU = 1, KHARMA_INSITU_CUDA = 2, KHARMA_INSITU_ROCM = 10,
+                            KHARMA_INSITU_ONEAPI = 14 };
+
+/** One array, e.g. a primitive variable over a block including ghost zones */
+typedef struct {
+    const char *name;
+    const void *data;
+    int ndim;
+    int64_t shape[6];
+    int64_t strides[6];
+    int dtype_bits;
+} kharma_insitu_array;
+
+/** One meshblock: its extent in native coordinates, and its arrays */
+typedef struct {
+    int gid;
+    int level;
+    int nghost;
+    double xmin[3];
+    double xmax[3];
+    int narrays;
+    const kharma_insitu_array *arrays;
+} kharma_insitu_block;
+
+/** Everything on this rank after one step */
+typedef struct {
+    int version;
+    int device_type;
+    int device_id;
+    int rank;
+    int nranks;
+    int ncycle;
+    double t;
+    double dt;
+    int nblocks;
+    const kharma_insitu_block *blocks;
+} kharma_insitu_step;
+
+/** Called once at startup with <insitu>args.  Nonzero return aborts the run */
+typedef int (*kharma_insitu_init_t)(int version, const char *args);
+/** Called every <insitu>dn steps.  Nonzero return aborts the run */
+typedef int (*kharma_insitu_execute_t)(const kharma_insitu_step *step);
+/** Called once at the end of the run */
+typedef void (*kharma_insitu_finalize_t)(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/* 
+ *  File: eos.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "eos.hpp"
+
+#include <fstream>
+
+Inverter::TabulatedEOS Inverter::MakeTabulatedEOS(ParameterInput *pin, const Real& gam)
+{
+    const std::string fname = pin->GetOrAddString("inverter", "eos_table_file", "none");
+    int n_rho, n_eps;
+    Real lrho_min, lrho_max, leps_min, leps_max;
+    std::vector<Real> log_p_vals;
+    if (fname != "none") {
+        // ASCII table: a header "n_rho n_eps log10(rho_min) log10(rho_max) log10(eps_min) log10(eps_max)",
+        // followed by n_rho*n_eps values of log10(P), varying fastest in eps
+        std::ifstream f(fname);
+        if (!f) throw std::runtime_error("Could not open EOS table "+fname);
+        f >> n_rho >> n_eps >> lrho_min >> lrho_max >> leps_min >> leps_max;
+        if (!f || n_rho < 2 || n_eps < 2 || lrho_max <= lrho_min || leps_max <= leps_min)
+            throw std::runtime_error("Invalid header in EOS table "+fname);
+        log_p_vals.resize(n_rho * n_eps);
+        for (auto &lp : log_p_vals) {
+            f >> lp;
+            lp *= M_LN10;
+        }
+        if (!f) throw std::runtime_error("EOS table "+fname+" has too few entries!");
+        lrho_min *= M_LN10; lrho_max *= M_LN10;
+        leps_min *= M_LN10; leps_max *= M_LN10;
+    } else {
+        // Tabulate the gamma-law EOS.  Bilinear interpolation in the logs is exact for it,
+        // so this reproduces the ideal inversion to roundoff
+        n_rho = pin->GetOrAddInteger("inverter", "eos_table_n_rho", 64);
+        n_eps = pin->GetOrAddInteger("inverter", "eos_table_n_eps", 64);
+        if (n_rho < 2 || n_eps < 2)
+            throw std::invalid_argument("EOS tables need at least 2 points in each dimension!");
+        lrho_min = m::log(pin->GetOrAddReal("inverter", "eos_table_rho_min", 1.e-20));
+        lrho_max = m::log(pin->GetOrAddReal("inverter", "eos_table_rho_max", 1.e3));
+        leps_min = m::log(pin->GetOrAddReal("inverter", "eos_table_eps_min", 1.e-10));
+        leps_max = m::log(pin->GetOrAddReal("inverter", "eos_table_eps_max", 1.e4));
+        for (int ir = 0; ir < n_rho; ++ir) {
+            for (int ie = 0; ie < n_eps; ++ie) {
+                const Real lrho = lrho_min + (lrho_max - lrho_min) * ir / (n_rho - 1);
+                const Real leps = leps_min + (leps_max - leps_min) * ie / (n_eps - 1);
+                log_p_vals.push_back(m::log(gam - 1.) + lrho + leps);
+            }
+        }
+    }
+
+    ParArray2D<Real> log_p("eos_log_p", n_rho, n_eps);
+    auto log_p_h = log_p.GetHostMirror();
+    for (int ir = 0; ir < n_rho; ++ir)
+        for (int ie = 0; ie < n_eps; ++ie)
+            log_p_h(ir, ie) = log_p_vals[ir * n_eps + ie];
+    log_p.DeepCopy(log_p_h);
+
+    return TabulatedEOS(log_p, lrho_min, lrho_max, leps_min, leps_max);
+}
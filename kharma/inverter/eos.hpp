@@ -0,0 +1,104 @@
+/* 
+ *  File: eos.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Equations of state P(rho, eps) for the Kastaun inverter, which handles any EOS given
+ * the pressure as a function of density & specific internal energy.
+ * Note the rest of KHARMA still assumes a gamma-law gas.
+ */
+namespace Inverter {
+
+/**
+ * Gamma-law EOS, P = (gam - 1) rho eps
+ */
+class IdealEOS {
+    public:
+        KOKKOS_FUNCTION
+        IdealEOS(const Real& gam) : gam_(gam) {}
+
+        KOKKOS_FORCEINLINE_FUNCTION
+        Real pressure(const Real& rho, const Real& eps) const
+        {
+            return (gam_ - 1.) * rho * eps;
+        }
+
+    private:
+        const Real gam_;
+};
+
+/**
+ * Tabulated EOS, holding ln(P) on a device-side grid uniformly spaced in ln(rho), ln(eps).
+ * The uniform spacing means lookups compute their cell directly, rather than searching.
+ * Interpolation is bilinear in the logs, clamped to the table edges.
+ */
+class TabulatedEOS {
+    public:
+        TabulatedEOS() = default;
+        TabulatedEOS(const ParArray2D<Real>& log_p, const Real& lrho_min, const Real& lrho_max,
+                     const Real& leps_min, const Real& leps_max)
+            : log_p_(log_p), n_rho_(log_p.extent_int(0)), n_eps_(log_p.extent_int(1)),
+              lrho_min_(lrho_min), leps_min_(leps_min),
+              dlrho_inv_((log_p.extent_int(0) - 1) / (lrho_max - lrho_min)),
+              dleps_inv_((log_p.extent_int(1) - 1) / (leps_max - leps_min)) {}
+
+        KOKKOS_FORCEINLINE_FUNCTION
+        Real pressure(const Real& rho, const Real& eps) const
+        {
+            // Fractional index in each dimension, clamped to the last cell
+            const Real xr = m::min(m::max((m::log(rho) - lrho_min_) * dlrho_inv_, 0.), (Real) (n_rho_ - 1));
+            const Real xe = m::min(m::max((m::log(eps) - leps_min_) * dleps_inv_, 0.), (Real) (n_eps_ - 1));
+            const int ir = m::min((int) xr, n_rho_ - 2);
+            const int ie = m::min((int) xe, n_eps_ - 2);
+            const Real fr = xr - ir, fe = xe - ie;
+            const Real lp = (1. - fr) * ((1. - fe) * log_p_(ir, ie)     + fe * log_p_(ir, ie + 1)) +
+                                   fr * ((1. - fe) * log_p_(ir + 1, ie) + fe * log_p_(ir + 1, ie + 1));
+            return m::exp(lp);
+        }
+
+    private:
+        ParArray2D<Real> log_p_;
+        int n_rho_ = 0, n_eps_ = 0;
+        Real lrho_min_ = 0., leps_min_ = 0., dlrho_inv_ = 0., dleps_inv_ = 0.;
+};
+
+/**
+ * Construct a TabulatedEOS from the options in <inverter>: either read from eos_table_file,
+ * or tabulated from the gamma-law EOS (mostly for testing the interpolation)
+ */
+TabulatedEOS MakeTabulatedEOS(ParameterInput *pin, const Real& gam);
+
+} // namespace Inverter
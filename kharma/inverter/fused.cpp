@@ -0,0 +1,230 @@
+/* 
+ *  File: fused.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Fused end-of-substep stage: inversion, floors and fixups with fewer sweeps over memory
+#include "inverter.hpp"
+
+#include "domain.hpp"
+#include "fault.hpp"
+#include "floors.hpp"
+#include "floors_functions.hpp"
+#include "flux_functions.hpp"
+#include "grmhd.hpp"
+#include "kharma_package.hpp"
+#include "pack.hpp"
+
+/**
+ * Invert every physical zone, then determine & apply floors over the entire domain, in one kernel.
+ * Zone-by-zone, this is exactly Inverter::MeshUtoP followed by Floors::ApplyGRMHDFloors
+ */
+template<Inverter::Type inverter, Floors::InjectionFrame frame>
+inline void MeshInvertAndFloorInFrame(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    // Floors operate on all primitive & conserved variables, so pack those for both
+    PackIndexMap prims_map, cons_map;
+    auto P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive")}, prims_map);
+    auto U = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    // Advected scalars, converted before the floors as in Packages::MeshUtoP
+    static const std::vector<MetadataFlag> scalar_cons{Metadata::GetUserFlag("AdvectedScalar"), Metadata::Conserved},
+                                           scalar_prims{Metadata::GetUserFlag("AdvectedScalar"), Metadata::GetUserFlag("Primitive")};
+    auto S_U = md->PackVariables(scalar_cons);
+    auto S_P = md->PackVariables(scalar_prims);
+    const int nscalar = S_U.GetDim(4);
+
+    auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
+    auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+    const bool record = pmb0->packages.Get("Floors")->Param<bool>("record_floor_values");
+    PackIndexMap floors_map;
+    auto floor_vals = md->PackVariables(record ? std::vector<std::string>{"Floors.rho_floor", "Floors.u_floor"}
+                                               : std::vector<std::string>{}, floors_map);
+    const int rhofi = floors_map["Floors.rho_floor"].first;
+    const int ufi = floors_map["Floors.u_floor"].first;
+
+    if (U.GetDim(4) == 0 || pflag.GetDim(4) == 0)
+        return;
+
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+
+    auto &pars = pmb0->packages.Get("Inverter")->AllParams();
+    const Real err_tol = pars.Get<Real>("err_tol");
+    const int iter_max = pars.Get<int>("iter_max");
+    const Floors::Prescription inverter_floors       = pars.Get<Floors::Prescription>("inverter_prescription");
+    const Floors::Prescription inverter_floors_inner = pars.Get<Floors::Prescription>("inverter_prescription_inner");
+    const bool record_iters = pars.Get<bool>("iteration_stats");
+    auto iters = md->PackVariables(std::vector<std::string>{"inverter_iters"});
+    const Inverter::TabulatedEOS eos_table = pars.Get<Inverter::TabulatedEOS>("eos_table");
+    const bool use_eos_table = pars.Get<bool>("use_eos_table");
+
+    const auto& floor_pars = pmb0->packages.Get("Floors")->AllParams();
+    const Floors::Prescription floors       = floor_pars.Get<Floors::Prescription>("prescription");
+    const Floors::Prescription floors_inner = floor_pars.Get<Floors::Prescription>("prescription_inner");
+    const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(pmb0->packages);
+    const Real switch_r = (frame == Floors::InjectionFrame::mixed_fluid_normal) ?
+                            floor_pars.Get<Real>("frame_switch_r") : 0;
+    const Real switch_beta = (frame == Floors::InjectionFrame::mixed_normal_drift) ?
+                            floor_pars.Get<Real>("frame_switch_beta") : 0;
+
+    const auto geom = Floors::GetGeomFloorProfiles(md);
+    auto ranges = Inverter::GetPhysicalRanges(md);
+    const Fault::Sentinels faults = Fault::GetSentinels(md);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+    pmb0->par_for("U_to_P_floors", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            const auto& G = U.GetCoords(bl);
+            for (int p = 0; p < nscalar; ++p)
+                S_P(bl, p, k, j, i) = S_U(bl, p, k, j, i) / U(bl, m_u.RHO, k, j, i);
+            // Inversions only over each block's physical zones, see MeshPerformInversion
+            if (KDomain::inside(k, j, i, ranges(bl))) {
+                const Floors::Prescription& myfloors = (inverter_floors.radius_dependent_floors
+                                                && G.coords.is_spherical()
+                                                && G.r(k, j, i) < inverter_floors.floors_switch_r) ?
+                                                inverter_floors_inner : inverter_floors;
+                if (faults.enabled && Fault::NonFiniteFluid(U(bl), m_u, k, j, i))
+                    Fault::Mark(faults, bl, Fault::Sentinel::nonfinite_cons);
+                int niter = 0;
+                int pflagl = Inverter::u_to_p<inverter>(G, U(bl), m_u, gam, k, j, i, P(bl), m_p, Loci::center,
+                                                        myfloors, iter_max, err_tol, &niter,
+                                                        use_eos_table ? &eos_table : nullptr);
+                if (record_iters) iters(bl, 0, k, j, i) = niter;
+                pflag(bl, 0, k, j, i) = pflagl % Floors::FFlag::MINIMUM;
+                fflag(bl, 0, k, j, i) = (pflagl / Floors::FFlag::MINIMUM) * Floors::FFlag::MINIMUM;
+            }
+
+            // Floors over the entire domain, see ApplyFloorsInFrame
+            Real rhoflr_max, uflr_max;
+            const int new_codes = Floors::determine_floors(G, P(bl), m_p, gam, bl, k, j, i, floors, floors_inner,
+                                                           geom, rhoflr_max, uflr_max);
+            const int fflag_l = static_cast<int>(fflag(bl, 0, k, j, i)) | new_codes;
+            if (new_codes) fflag(bl, 0, k, j, i) = fflag_l;
+            if (record) {
+                floor_vals(bl, rhofi, k, j, i) = rhoflr_max;
+                floor_vals(bl, ufi, k, j, i) = uflr_max;
+            }
+            if (fflag_l) {
+                const int pflag_l = Floors::apply_floors_in_frame<frame>(G, P(bl), m_p, gam, k, j, i,
+                                            rhoflr_max, uflr_max,
+                                            U(bl), m_u, floors, floors_inner, emhd_params, switch_r, switch_beta);
+                if (pflag_l) pflag(bl, 0, k, j, i) = pflag_l;
+            }
+        }
+    );
+}
+
+template<Inverter::Type inverter>
+inline void MeshInvertAndFloor(MeshData<Real> *md)
+{
+    using Floors::InjectionFrame;
+    const auto frame = md->GetMeshPointer()->packages.Get("Floors")->Param<InjectionFrame>("frame");
+    if (frame == InjectionFrame::normal) {
+        MeshInvertAndFloorInFrame<inverter, InjectionFrame::normal>(md);
+    } else if (frame == InjectionFrame::fluid) {
+        MeshInvertAndFloorInFrame<inverter, InjectionFrame::fluid>(md);
+    } else if (frame == InjectionFrame::mixed_fluid_normal) {
+        MeshInvertAndFloorInFrame<inverter, InjectionFrame::mixed_fluid_normal>(md);
+    } else if (frame == InjectionFrame::mixed_normal_drift) {
+        MeshInvertAndFloorInFrame<inverter, InjectionFrame::mixed_normal_drift>(md);
+    } else if (frame == InjectionFrame::drift) {
+        MeshInvertAndFloorInFrame<inverter, InjectionFrame::drift>(md);
+    } else {
+        throw std::invalid_argument("Floors for requested frame not implemented!");
+    }
+}
+
+TaskStatus Inverter::MeshUtoPFloorsFixup(MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    GRMHD::InvalidateFourVectors(md);
+    auto& pars = pmesh->packages.Get("Inverter")->AllParams();
+    auto kpackages = pmesh->packages.AllPackagesOfType<KHARMAPackage>();
+
+    // We can only fuse if the only other inversions are of the magnetic field, which the floors
+    // need but which don't depend on the fluid, or advected scalars, which the kernel handles itself,
+    // and if nothing but the Floors package applies floors.
+    // Otherwise, packages must be inverted & floored in order, so run the separate passes
+    const std::vector<std::string> b_packages = {"B_CT", "B_FluxCT", "B_CD"};
+    bool can_fuse = kpackages.count("Floors") && !pars.Get<bool>("two_pass") && !pars.Get<bool>("extrapolate_guess")
+                    && pars.Get<Type>("inverter_type") != Type::none;
+    for (auto kpackage : kpackages) {
+        const bool is_b = std::find(b_packages.begin(), b_packages.end(), kpackage.first) != b_packages.end();
+        const bool has_utop = kpackage.second->MeshUtoP != nullptr || kpackage.second->BlockUtoP != nullptr;
+        const bool has_floors = kpackage.second->BlockApplyFloors != nullptr ||
+                                (kpackage.second->MeshApplyFloors != nullptr && kpackage.first != "Floors");
+        if (has_floors ||
+            (has_utop && !is_b && kpackage.first != "Inverter" && !kpackage.second->AdvectedScalars))
+            can_fuse = false;
+    }
+    if (!can_fuse) {
+        Packages::MeshUtoP(md, IndexDomain::entire, false);
+        Packages::MeshApplyFloors(md, IndexDomain::entire);
+        return Inverter::MeshFixUtoP(md);
+    }
+
+    Flag("MeshUtoPFloorsFixup");
+    // Magnetic field primitives first, for the floors
+    for (auto& name : b_packages) {
+        if (kpackages.count(name)) {
+            KHARMAPackage *pkpackage = kpackages.at(name);
+            if (pkpackage->MeshUtoP != nullptr) {
+                pkpackage->MeshUtoP(md, IndexDomain::entire, false);
+            } else if (pkpackage->BlockUtoP != nullptr) {
+                for (int i=0; i < md->NumBlocks(); ++i)
+                    pkpackage->BlockUtoP(md->GetBlockData(i).get(), IndexDomain::entire, false);
+            }
+        }
+    }
+
+    switch(pars.Get<Type>("inverter_type")) {
+    case Type::onedw:
+        MeshInvertAndFloor<Type::onedw>(md);
+        break;
+    case Type::kastaun:
+        MeshInvertAndFloor<Type::kastaun>(md);
+        break;
+    case Type::kastaun_lockstep:
+        MeshInvertAndFloor<Type::kastaun_lockstep>(md);
+        break;
+    case Type::none:
+        break;
+    }
+
+    // Fixups need the final values of every neighbor, so they get their own (sparse) pass
+    Inverter::MeshFixUtoP(md);
+
+    EndFlag();
+    return TaskStatus::complete;
+}
@@ -41,12 +41,13 @@
 #include "decs.hpp"
 #include "types.hpp"
 
+#include "eos.hpp"
 #include "floors.hpp"
 
 namespace Inverter {
 
-// Denote inverter types. Currently just one
-enum class Type{none=0, onedw, kastaun};
+// Denote inverter types.  kastaun_lockstep is Kastaun's method with fixed trip counts, for CPUs
+enum class Type{none=0, onedw, kastaun, kastaun_lockstep};
 
 // Denote inversion failures (pflags)
 // This enum should grow to cover any inversion algorithm
@@ -95,5 +96,6 @@ KOKKOS_INLINE_FUNCTION int u_to_p(const GRCoordinates& G, const VariablePack<Rea
                                               const Real& gam, const int& k, const int& j, const int& i,
                                               const VariablePack<Real>& P, const VarMap& m_p,
                                               const Loci& loc, const Floors::Prescription& floors,
-                                              const int& max_iterations, const Real& tol);
+                                              const int& max_iterations, const Real& tol,
+                                              int *iterations=nullptr, const TabulatedEOS *eos_table=nullptr);
 } // namespace Inverter
@@ -35,9 +35,16 @@
 
 // inverter.hpp includes the template and instantiations in the correct order
 
+#include "boundaries.hpp"
 #include "domain.hpp"
+#include "fault.hpp"
 #include "reductions.hpp"
 
+// Fluid primitives rho, u, uvec, kept for extrapolated guesses
+#define NPRIM_HD 5
+// Bins of the iteration histogram. The last bin collects everything beyond
+#define N_ITER_BINS 32
+
 int Inverter::CountPFlags(MeshData<Real> *md)
 {
     return Reductions::CountFlags(md, "pflag", Inverter::status_names, IndexDomain::interior, false)[0];
@@ -50,25 +57,69 @@ std::shared_ptr<KHARMAPackage> Inverter::Initialize(ParameterInput *pin, std::sh
 
     // Inversion scheme.  Could be separate packages but they do share a lot,
     // and could share more e.g. inline floor applications
-    std::vector<std::string> allowed_inverter_names = {"none", "onedw", "kastaun"};
+    std::vector<std::string> allowed_inverter_names = {"none", "onedw", "kastaun", "kastaun_lockstep"};
     std::string inverter_name = pin->GetOrAddString("inverter", "type", "kastaun", allowed_inverter_names);
     bool use_kastaun = false;
+    // Mutable only so that Benchmark::Run can time each type
     if (inverter_name == "onedw") {
-        params.Add("inverter_type", Type::onedw);
+        params.Add("inverter_type", Type::onedw, true);
     } else if (inverter_name == "kastaun") {
-        params.Add("inverter_type", Type::kastaun);
+        params.Add("inverter_type", Type::kastaun, true);
+        use_kastaun = true;
+    } else if (inverter_name == "kastaun_lockstep") {
+        // Vectorizes on CPUs, at the cost of always taking iter_max iterations.  Slower on GPUs
+        params.Add("inverter_type", Type::kastaun_lockstep, true);
         use_kastaun = true;
     } else if (inverter_name == "none") {
-        params.Add("inverter_type", Type::none);
+        params.Add("inverter_type", Type::none, true);
     }
+    if (inverter_name == "onedw" && packages->Get("Driver")->Param<bool>("compact_restart"))
+        throw std::invalid_argument("Compact restarts require inverter type kastaun, which needs no initial guess!");
 
     // Solver options
     // Any other Noble et al. implemented for fun should use lower tol/iter count, see Noble+06
-    Real err_tol = pin->GetOrAddReal("inverter", "err_tol", (use_kastaun) ? 1e-12 : 1e-8);
+    Real err_tol = pin->GetOrAddReal("inverter", "err_tol", PrecisionTolerance((use_kastaun) ? 1e-12 : 1e-8));
     params.Add("err_tol", err_tol);
     int iter_max = pin->GetOrAddInteger("inverter", "iter_max", (use_kastaun) ? 25 : 8);
     params.Add("iter_max", iter_max);
 
+    // Two-pass inversion: a few Newton iterations of 1D_W everywhere, then Kastaun only
+    // in the zones which did not converge.  Avoids most zones waiting on a few hard ones
+    bool two_pass = pin->GetOrAddBoolean("inverter", "two_pass", false);
+    if (two_pass && !use_kastaun)
+        throw std::invalid_argument("Two-pass inversion requires inverter type kastaun!");
+    params.Add("two_pass", two_pass);
+
+    // Equation of state for the Kastaun inverter: gamma-law, or tabulated (see eos.hpp)
+    std::vector<std::string> allowed_eos_names = {"ideal", "table"};
+    const bool use_eos_table = pin->GetOrAddString("inverter", "eos", "ideal", allowed_eos_names) == "table";
+    if (use_eos_table && (!use_kastaun || two_pass))
+        throw std::invalid_argument("Tabulated EOS requires single-pass inverter type kastaun!");
+    params.Add("use_eos_table", use_eos_table);
+    const Real gam = packages->Get("GRMHD")->Param<Real>("gamma");
+    params.Add("eos_table", use_eos_table ? MakeTabulatedEOS(pin, gam) : TabulatedEOS());
+    if (two_pass) {
+        params.Add("two_pass_iter_max", pin->GetOrAddInteger("inverter", "two_pass_iter_max", 4));
+        params.Add("two_pass_err_tol", pin->GetOrAddReal("inverter", "two_pass_err_tol", err_tol));
+    }
+    // List of failed zones, for the second pass or for sparse fixups. Resized as needed
+    // Kept per-partition, see GetPartitionParam
+    params.Add("failed_list", std::map<int, ParArray1D<int>>(), true);
+
+    // Record the iterations taken in each zone, and print a histogram after each step.
+    // Useful for tuning err_tol and iter_max
+    bool iteration_stats = pin->GetOrAddBoolean("inverter", "iteration_stats", false);
+    params.Add("iteration_stats", iteration_stats);
+    // Start the 1D_W solver from a linear extrapolation of the last two substeps' primitives,
+    // rather than from the last substep's.  Kastaun's method brackets the root, ignoring any guess
+    bool extrapolate_guess = pin->GetOrAddBoolean("inverter", "extrapolate_guess", false);
+    if (extrapolate_guess && use_kastaun && !two_pass)
+        throw std::invalid_argument("Extrapolated initial guesses are only used by the onedw inverter or two-pass inversion!");
+    params.Add("extrapolate_guess", extrapolate_guess);
+
+    // Invert, apply floors and fix up as one stage at the end of each substep, see MeshUtoPFloorsFixup
+    params.Add("fuse_floors_fixup", pin->GetOrAddBoolean("inverter", "fuse_floors_fixup", false));
+
     // Floor options
     // Use a custom block for inverter floors to allow customization.  Not sure anyone *wants* that but...
     if (!pin->DoesBlockExist("inverter_floors")) {
@@ -107,8 +158,23 @@ std::shared_ptr<KHARMAPackage> Inverter::Initialize(ParameterInput *pin, std::sh
     m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy, Metadata::Overridable});
     pkg->AddField("fflag", m);
 
+    if (iteration_stats) {
+        m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
+        pkg->AddField("inverter_iters", m);
+    }
+    if (extrapolate_guess) {
+        // Fluid primitives rho, u, uvec as of the previous inversion
+        m = Metadata({Metadata::Real, Metadata::Cell, Metadata::Derived, Metadata::OneCopy},
+                     std::vector<int>({NPRIM_HD}));
+        pkg->AddField("prims_prev", m);
+    }
+
+    // Physical ranges of each block, for mesh-wide inversions.  Kept per-partition, and rebuilt only on regrid
+    params.Add("physical_ranges", std::map<int, PhysicalRanges>(), true);
+
     // We exist basically to do this
     pkg->BlockUtoP = Inverter::BlockUtoP;
+    pkg->MeshUtoP = Inverter::MeshUtoP;
     pkg->BoundaryUtoP = Inverter::BlockUtoP;
 
     pkg->PostStepDiagnosticsMesh = Inverter::PostStepDiagnostics;
@@ -152,6 +218,8 @@ inline void BlockPerformInversion(MeshBlockData<Real> *rc, IndexDomain domain, b
     const Floors::Prescription inverter_floors       = pars.Get<Floors::Prescription>("inverter_prescription");
     const Floors::Prescription inverter_floors_inner = pars.Get<Floors::Prescription>("inverter_prescription_inner");
     const bool radius_dependent_floors = inverter_floors.radius_dependent_floors;
+    const TabulatedEOS eos_table = pars.Get<TabulatedEOS>("eos_table");
+    const bool use_eos_table = pars.Get<bool>("use_eos_table");
 
     const auto& G = pmb->coords;
 
@@ -159,7 +227,9 @@ inline void BlockPerformInversion(MeshBlockData<Real> *rc, IndexDomain domain, b
     // Notice we recover variables for only the physical (interior or interior-ghost)
     // zones!  These are the only ones which are filled at our point in the step
     auto bounds = coarse ? pmb->c_cellbounds : pmb->cellbounds;
-    const IndexRange3 b = KDomain::GetPhysicalRange(rc);
+    // Excised zones are skipped entirely, see KBoundaries::ExcisedStart
+    IndexRange3 b = KDomain::GetPhysicalRange(rc);
+    b.is = m::max(b.is, KBoundaries::ExcisedStart(rc));
     pmb->par_for("U_to_P", b.ks, b.ke, b.js, b.je, b.is, b.ie,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
             const Floors::Prescription& myfloors = (inverter_floors.radius_dependent_floors
@@ -167,7 +237,8 @@ inline void BlockPerformInversion(MeshBlockData<Real> *rc, IndexDomain domain, b
                                             && G.r(k, j, i) < inverter_floors.floors_switch_r) ?
                                             inverter_floors_inner : inverter_floors;
             int pflagl = Inverter::u_to_p<inverter>(G, U, m_u, gam, k, j, i, P, m_p, Loci::center,
-                                                    myfloors, iter_max, err_tol);
+                                                    myfloors, iter_max, err_tol, nullptr,
+                                                    use_eos_table ? &eos_table : nullptr);
             pflag(0, k, j, i) = pflagl % Floors::FFlag::MINIMUM;
             int fflagl = (pflagl / Floors::FFlag::MINIMUM) * Floors::FFlag::MINIMUM;
             fflag(0, k, j, i) = fflagl;
@@ -181,6 +252,251 @@ inline void BlockPerformInversion(MeshBlockData<Real> *rc, IndexDomain domain, b
     );
 }
 
+ParArray1D<IndexRange3> Inverter::GetPhysicalRanges(MeshData<Real> *md)
+{
+    auto *cache = GetPartitionParam<PhysicalRanges>(md, "Inverter", "physical_ranges");
+    // The copy to device blocks, so only do it when the blocks have changed
+    auto locs = PartitionLocations(md);
+    if (cache->ranges.extent_int(0) >= md->NumBlocks() && cache->locs == locs) return cache->ranges;
+
+    if (cache->ranges.extent_int(0) < md->NumBlocks())
+        cache->ranges = ParArray1D<IndexRange3>("physical_ranges", md->NumBlocks());
+    const auto ranges = cache->ranges;
+    auto ranges_h = Kokkos::create_mirror_view(ranges);
+    for (int b=0; b < md->NumBlocks(); ++b) {
+        ranges_h(b) = KDomain::GetPhysicalRange(md->GetBlockData(b).get());
+        // Excised zones (or whole excised blocks) are left out of the range, see KBoundaries::ExcisedStart
+        ranges_h(b).is = m::max(ranges_h(b).is, KBoundaries::ExcisedStart(md->GetBlockData(b).get()));
+    }
+    Kokkos::deep_copy(ranges, ranges_h);
+    cache->locs = locs;
+    return ranges;
+}
+
+/**
+ * Mesh-wide version of BlockPerformInversion: one kernel over (block,k,j,i), masked
+ * to each block's physical range
+ */
+template<Inverter::Type inverter>
+inline void MeshPerformInversion(MeshData<Real> *md, IndexDomain domain, bool coarse,
+                                 const int iter_max, const Real err_tol)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    PackIndexMap prims_map, cons_map;
+    auto U = GRMHD::PackMHDCons(md, cons_map);
+    auto P = GRMHD::PackHDPrims(md, prims_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+
+    auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
+    auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+
+    if (U.GetDim(4) == 0 || pflag.GetDim(4) == 0)
+        return;
+
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+
+    auto &pars = pmb0->packages.Get("Inverter")->AllParams();
+    const Floors::Prescription inverter_floors       = pars.Get<Floors::Prescription>("inverter_prescription");
+    const Floors::Prescription inverter_floors_inner = pars.Get<Floors::Prescription>("inverter_prescription_inner");
+
+    // Advected scalars (e.g. electron entropies) over the requested domain, see ConvertsAdvectedScalars
+    static const std::vector<MetadataFlag> scalar_cons{Metadata::GetUserFlag("AdvectedScalar"), Metadata::Conserved},
+                                           scalar_prims{Metadata::GetUserFlag("AdvectedScalar"), Metadata::GetUserFlag("Primitive")};
+    auto S_U = md->PackVariables(scalar_cons);
+    auto S_P = md->PackVariables(scalar_prims);
+    const int nscalar = coarse ? 0 : S_U.GetDim(4);
+    const IndexRange3 bs = KDomain::GetRange(md, domain);
+
+    // Optional diagnostics & initial guess
+    const bool record_iters = pars.Get<bool>("iteration_stats");
+    auto iters = md->PackVariables(std::vector<std::string>{"inverter_iters"});
+    const bool extrapolate = (inverter == Inverter::Type::onedw) && pars.Get<bool>("extrapolate_guess");
+    auto P_prev = md->PackVariables(std::vector<std::string>{"prims_prev"});
+    const TabulatedEOS eos_table = pars.Get<TabulatedEOS>("eos_table");
+    const bool use_eos_table = pars.Get<bool>("use_eos_table");
+
+    // See BlockPerformInversion: each block is inverted over its physical zones,
+    // which differ based on which of its faces are domain boundaries
+    auto ranges = Inverter::GetPhysicalRanges(md);
+    const Fault::Sentinels faults = Fault::GetSentinels(md);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+    pmb0->par_for("U_to_P", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i) {
+            if (nscalar > 0 && KDomain::inside(k, j, i, bs)) {
+                const Real rho_U = U(bl, m_u.RHO, k, j, i);
+                for (int p = 0; p < nscalar; ++p)
+                    S_P(bl, p, k, j, i) = S_U(bl, p, k, j, i) / rho_U;
+            }
+            if (KDomain::outside(k, j, i, ranges(bl))) return;
+            const auto& G = U.GetCoords(bl);
+            const Floors::Prescription& myfloors = (inverter_floors.radius_dependent_floors
+                                            && G.coords.is_spherical()
+                                            && G.r(k, j, i) < inverter_floors.floors_switch_r) ?
+                                            inverter_floors_inner : inverter_floors;
+            // Extrapolate the guess from the last two substeps, if the result is physical.
+            // Zero-initialized P_prev marks zones without a previous substep
+            Real P_last[NPRIM_HD];
+            const int prim_idx[NPRIM_HD] = {m_p.RHO, m_p.UU, m_p.U1, m_p.U1+1, m_p.U1+2};
+            bool extrapolated = false;
+            if (extrapolate) {
+                for (int p=0; p < NPRIM_HD; ++p)
+                    P_last[p] = P(bl, prim_idx[p], k, j, i);
+                if (P_prev(bl, 0, k, j, i) > 0. &&
+                    2.*P_last[0] - P_prev(bl, 0, k, j, i) > 0. &&
+                    2.*P_last[1] - P_prev(bl, 1, k, j, i) > 0.) {
+                    for (int p=0; p < NPRIM_HD; ++p)
+                        P(bl, prim_idx[p], k, j, i) = 2.*P_last[p] - P_prev(bl, p, k, j, i);
+                    extrapolated = true;
+                }
+                for (int p=0; p < NPRIM_HD; ++p)
+                    P_prev(bl, p, k, j, i) = P_last[p];
+            }
+            if (faults.enabled && Fault::NonFiniteFluid(U(bl), m_u, k, j, i))
+                Fault::Mark(faults, bl, Fault::Sentinel::nonfinite_cons);
+            int niter = 0;
+            int pflagl = Inverter::u_to_p<inverter>(G, U(bl), m_u, gam, k, j, i, P(bl), m_p, Loci::center,
+                                                    myfloors, iter_max, err_tol, &niter,
+                                                    use_eos_table ? &eos_table : nullptr);
+            // Failed inversions leave P untouched: don't leave the extrapolated guess for the fixups
+            if (extrapolated && Inverter::failed(pflagl % Floors::FFlag::MINIMUM))
+                for (int p=0; p < NPRIM_HD; ++p)
+                    P(bl, prim_idx[p], k, j, i) = P_last[p];
+            if (record_iters) iters(bl, 0, k, j, i) = niter;
+            pflag(bl, 0, k, j, i) = pflagl % Floors::FFlag::MINIMUM;
+            int fflagl = (pflagl / Floors::FFlag::MINIMUM) * Floors::FFlag::MINIMUM;
+            fflag(bl, 0, k, j, i) = fflagl;
+        }
+    );
+}
+
+/**
+ * Second pass of a two-pass inversion: compact the zones which failed the first pass,
+ * and re-invert only these with Kastaun's method
+ */
+inline void MeshRetryInversion(MeshData<Real> *md, const int iter_max, const Real err_tol)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    PackIndexMap prims_map, cons_map;
+    auto U = GRMHD::PackMHDCons(md, cons_map);
+    auto P = GRMHD::PackHDPrims(md, prims_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+
+    auto fflag = md->PackVariables(std::vector<std::string>{"fflag"});
+    auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+
+    if (U.GetDim(4) == 0 || pflag.GetDim(4) == 0)
+        return;
+
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+
+    auto &pars = pmb0->packages.Get("Inverter")->AllParams();
+    const Floors::Prescription inverter_floors       = pars.Get<Floors::Prescription>("inverter_prescription");
+    const Floors::Prescription inverter_floors_inner = pars.Get<Floors::Prescription>("inverter_prescription_inner");
+
+    const bool record_iters = pars.Get<bool>("iteration_stats");
+    auto iters = md->PackVariables(std::vector<std::string>{"inverter_iters"});
+
+    const int nlist = Inverter::ListFailedZones(md);
+    if (nlist == 0) return;
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+    const auto retry_list = *GetPartitionParam<ParArray1D<int>>(md, "Inverter", "failed_list");
+    pmb0->par_for("U_to_P_retry", 0, nlist - 1,
+        KOKKOS_LAMBDA (const int &m) {
+            const int n = retry_list(m);
+            const int i = b.is + n % ni;
+            const int j = b.js + (n / ni) % nj;
+            const int k = b.ks + (n / (ni*nj)) % nk;
+            const int bl = n / (ni*nj*nk);
+            const auto& G = U.GetCoords(bl);
+            const Floors::Prescription& myfloors = (inverter_floors.radius_dependent_floors
+                                            && G.coords.is_spherical()
+                                            && G.r(k, j, i) < inverter_floors.floors_switch_r) ?
+                                            inverter_floors_inner : inverter_floors;
+            int niter = 0;
+            int pflagl = Inverter::u_to_p<Inverter::Type::kastaun>(G, U(bl), m_u, gam, k, j, i, P(bl), m_p, Loci::center,
+                                                                   myfloors, iter_max, err_tol, &niter);
+            // Count both passes
+            if (record_iters) iters(bl, 0, k, j, i) += niter;
+            pflag(bl, 0, k, j, i) = pflagl % Floors::FFlag::MINIMUM;
+            int fflagl = (pflagl / Floors::FFlag::MINIMUM) * Floors::FFlag::MINIMUM;
+            fflag(bl, 0, k, j, i) = fflagl;
+        }
+    );
+}
+
+int Inverter::ListFailedZones(MeshData<Real> *md)
+{
+    auto pflag = md->PackVariables(std::vector<std::string>{"pflag"});
+    if (pflag.GetDim(4) == 0) return 0;
+
+    auto &pars = md->GetMeshPointer()->packages.Get("Inverter")->AllParams();
+    auto ranges = Inverter::GetPhysicalRanges(md);
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    const int ni = b.ie - b.is + 1, nj = b.je - b.js + 1, nk = b.ke - b.ks + 1;
+    const int nzones = pflag.GetDim(5) * nk * nj * ni;
+
+    // Compact the failed zones, growing the list if it overflows
+    auto *failed_list_p = GetPartitionParam<ParArray1D<int>>(md, "Inverter", "failed_list");
+    if (failed_list_p->extent_int(0) == 0) *failed_list_p = ParArray1D<int>("failed_list", 1024);
+    int nlist = 0;
+    bool fits = false;
+    while (!fits) {
+        const auto failed_list = *failed_list_p;
+        const int capacity = failed_list.extent_int(0);
+        Kokkos::parallel_scan("list_failed_zones", Kokkos::RangePolicy<>(DevExecSpace(), 0, nzones),
+            KOKKOS_LAMBDA (const int &n, int &idx, const bool &final) {
+                const int i = b.is + n % ni;
+                const int j = b.js + (n / ni) % nj;
+                const int k = b.ks + (n / (ni*nj)) % nk;
+                const int bl = n / (ni*nj*nk);
+                if (KDomain::inside(k, j, i, ranges(bl)) && Inverter::failed(pflag(bl, 0, k, j, i))) {
+                    if (final && idx < capacity) failed_list(idx) = n;
+                    ++idx;
+                }
+            }
+        , nlist);
+        fits = (nlist <= capacity);
+        if (!fits) Kokkos::resize(*failed_list_p, 2 * nlist);
+    }
+    return nlist;
+}
+
+TaskStatus Inverter::MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse)
+{
+    Flag("MeshUtoP");
+    auto& pars = md->GetMeshPointer()->packages.Get("Inverter")->AllParams();
+    auto& type = pars.Get<Type>("inverter_type");
+    const int iter_max = pars.Get<int>("iter_max");
+    const Real err_tol = pars.Get<Real>("err_tol");
+    if (pars.Get<bool>("two_pass")) {
+        MeshPerformInversion<Type::onedw>(md, domain, coarse, pars.Get<int>("two_pass_iter_max"),
+                                          pars.Get<Real>("two_pass_err_tol"));
+        MeshRetryInversion(md, iter_max, err_tol);
+        EndFlag();
+        return TaskStatus::complete;
+    }
+    switch(type) {
+    case Type::onedw:
+        MeshPerformInversion<Type::onedw>(md, domain, coarse, iter_max, err_tol);
+        break;
+    case Type::kastaun:
+        MeshPerformInversion<Type::kastaun>(md, domain, coarse, iter_max, err_tol);
+        break;
+    case Type::kastaun_lockstep:
+        MeshPerformInversion<Type::kastaun_lockstep>(md, domain, coarse, iter_max, err_tol);
+        break;
+    case Type::none:
+        break;
+    }
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 void Inverter::BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse)
 {
     // This only chooses an implementation.  See BlockPerformInversion and implementations e.g. onedw.hpp
@@ -192,11 +508,14 @@ void Inverter::BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coars
     case Type::kastaun:
         BlockPerformInversion<Type::kastaun>(rc, domain, coarse);
         break;
+    case Type::kastaun_lockstep:
+        BlockPerformInversion<Type::kastaun_lockstep>(rc, domain, coarse);
+        break;
     case Type::none:
         break;
     }
     // This is dangerous since there are many blocks/packs and we need one reduction. For later.
-    //Reductions::StartFlagReduce(md, "pflag", Inverter::status_names, IndexDomain::interior, false, 1);
+    //Reductions::StartFlagReduce(md, "pflag", Inverter::status_names, IndexDomain::interior, false, Reductions::Channel::pflag);
 }
 
 TaskStatus Inverter::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
@@ -210,15 +529,57 @@ TaskStatus Inverter::PostStepDiagnostics(const SimTime& tm, MeshData<Real> *md)
     // Debugging/diagnostic info about inversion flags
     // TODO grab the total and die on too many
     if (flag_verbose >= 1) {
-        // TODO this should move into UtoP when everything goes MeshData
-        Reductions::StartFlagReduce(md, "pflag", Inverter::status_names, IndexDomain::interior, false, 1);
-        Reductions::CheckFlagReduceAndPrintHits(md, "pflag", Inverter::status_names, IndexDomain::interior, false, 1);
+        // Counting in UtoP itself would miss the re-inversions after flooring, which overwrite pflag.
+        // So, count here, along with fflag if we're the only floors, in a single sweep
+        const bool count_fflag = !pmesh->packages.AllPackages().count("Floors");
+        std::vector<Reductions::FlagField> fields = {{"pflag", Inverter::status_names, false}};
+        if (count_fflag) fields.push_back({"fflag", Floors::FFlag::flag_names, true});
+        const auto counts = Reductions::CountFlagFields(md, fields, IndexDomain::interior);
 
-        // If we're the only floors, print those too
-        if (!pmesh->packages.AllPackages().count("Floors")) {
-            Reductions::StartFlagReduce(md, "fflag", Floors::FFlag::flag_names, IndexDomain::interior, true, 0);
+        Reductions::Start<std::vector<int>>(md, Reductions::Channel::pflag, counts[0], MPI_SUM);
+        if (count_fflag)
+            Reductions::Start<std::vector<int>>(md, Reductions::Channel::fflag, counts[1], MPI_SUM);
+
+        Reductions::FinishFlagReduce(md, "pflag", Inverter::status_names, IndexDomain::interior, false, Reductions::Channel::pflag);
+        if (count_fflag) {
             // Debugging/diagnostic info about floors
-            Reductions::CheckFlagReduceAndPrintHits(md, "fflag", Floors::FFlag::flag_names, IndexDomain::interior, true, 0);
+            Reductions::FinishFlagReduce(md, "fflag", Floors::FFlag::flag_names, IndexDomain::interior, true, Reductions::Channel::fflag);
+        }
+    }
+
+    if (pmesh->packages.Get("Inverter")->Param<bool>("iteration_stats")) {
+        // Histogram of iterations taken by each interior zone
+        auto iters = md->PackVariables(std::vector<std::string>{"inverter_iters"});
+        const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+        const IndexRange block = IndexRange{0, iters.GetDim(5) - 1};
+        Reductions::array_type<int, N_ITER_BINS> iter_reducer;
+        pmb0->par_reduce("iteration_histogram", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i,
+                           Reductions::array_type<int, N_ITER_BINS> &local_result) {
+                const int n = static_cast<int>(iters(bl, 0, k, j, i));
+                ++local_result.my_array[m::min(m::max(n, 0), N_ITER_BINS - 1)];
+            }
+        , Reductions::ArraySum<int, HostExecSpace, N_ITER_BINS>(iter_reducer));
+        std::vector<int> hist(iter_reducer.my_array, iter_reducer.my_array + N_ITER_BINS);
+
+        Reductions::Start<std::vector<int>>(md, Reductions::Channel::inverter_iters, hist, MPI_SUM);
+        hist = Reductions::Check<std::vector<int>>(md, Reductions::Channel::inverter_iters);
+
+        if (MPIRank0()) {
+            long int n_zones = 0, n_total = 0;
+            int n_max = 0;
+            for (int n=0; n < N_ITER_BINS; ++n) {
+                n_zones += hist[n];
+                n_total += (long int) n * hist[n];
+                if (hist[n] > 0) n_max = n;
+            }
+            std::cout << "Inverter iterations: mean " << ((double) n_total) / std::max(n_zones, 1l)
+                      << " max " << n_max << ((n_max == N_ITER_BINS - 1) ? "+" : "") << std::endl;
+            if (flag_verbose > 1) {
+                for (int n=0; n <= n_max; ++n)
+                    if (hist[n] > 0) std::cout << n << ((n == N_ITER_BINS - 1) ? "+" : "") << ": " << hist[n] << std::endl;
+                std::cout << std::endl;
+            }
         }
     }
 
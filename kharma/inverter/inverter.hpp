@@ -65,29 +65,56 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
  * output: U and P match down to inversion errors
  */
 void BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool coarse);
-inline TaskStatus MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse) {
-    Flag("MeshUtoP");
-    for (int i=0; i < md->NumBlocks(); ++i)
-        BlockUtoP(md->GetBlockData(i).get(), domain, coarse);
-    EndFlag();
-    return TaskStatus::complete;
-}
+/**
+ * Version of the above operating over all blocks in md, in a single kernel launch
+ */
+TaskStatus MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse);
 
 /**
  * Smooth over inversion failures, usually by averaging values of the primitive variables from each neighboring zone
  * a.k.a. Diffusion?  What diffusion?  There is no diffusion here.
+ * Runs only over the zones compacted by ListFailedZones, i.e. does nothing past the compaction if none failed.
  * 
  * LOCKSTEP: this function expects and should preserve P<->U
  */
-TaskStatus FixUtoP(MeshBlockData<Real> *rc);
-inline TaskStatus MeshFixUtoP(MeshData<Real> *md) {
-    Flag("MeshFixUtoP");
-    for (int i=0; i < md->NumBlocks(); ++i)
-        FixUtoP(md->GetBlockData(i).get());
-    EndFlag();
-    return TaskStatus::complete;
+TaskStatus MeshFixUtoP(MeshData<Real> *md);
+
+/**
+ * Invert, apply floors, and fix failed inversions over md, in place of the
+ * three tasks MeshUtoP, MeshApplyFloors and MeshFixUtoP.
+ * Inversion and floors share a single kernel, and the fixups run only over the failed zones.
+ * Falls back to the separate passes whenever packages other than the B field invert or apply floors.
+ */
+TaskStatus MeshUtoPFloorsFixup(MeshData<Real> *md);
+
+/**
+ * Whether MeshUtoP (and MeshUtoPFloorsFixup) also recover any variables flagged "AdvectedScalar",
+ * as P = U / U_rho over the requested domain, using the conserved density already loaded for the inversion.
+ * This is true unless the inverter is disabled, or for the coarse buffers, which aren't inverted here.
+ */
+inline bool ConvertsAdvectedScalars(Packages_t& packages, bool coarse)
+{
+    return !coarse && packages.AllPackages().count("Inverter") &&
+           packages.Get("Inverter")->Param<Type>("inverter_type") != Type::none;
 }
 
+/**
+ * Physical range (see KDomain::GetPhysicalRange) of each block in md, on device,
+ * for mesh-wide kernels which must respect each block's range.
+ * Cached per partition, and only rebuilt when the partition's blocks change
+ */
+struct PhysicalRanges {
+    ParArray1D<IndexRange3> ranges;
+    std::vector<LogicalLocation> locs;
+};
+ParArray1D<IndexRange3> GetPhysicalRanges(MeshData<Real> *md);
+
+/**
+ * Compact the zones of md which failed inversion into the "failed_list" parameter, as indices
+ * of (block, k, j, i) flattened over the entire domain.  Returns the number listed.
+ */
+int ListFailedZones(MeshData<Real> *md);
+
 /**
  * Count up all nonzero PFlags on md.  Used for history file reductions.
  */
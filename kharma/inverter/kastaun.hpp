@@ -60,6 +60,7 @@
 // General template
 // We define a specialization based on the Inverter::Type parameter
 #include "invert_template.hpp"
+#include "eos.hpp"
 
 #include "coordinate_utils.hpp"
 #include "floors_functions.hpp"
@@ -79,16 +80,18 @@ namespace Inverter {
  * 1. Function arguments other than solution var "mu"
  * 2. Floors/ceilings and tracking of floor hits
  * Also handles translating mu->primitive variables
+ * Templated on the EOS, see eos.hpp
  */
+template<typename EOS>
 class KastaunResidual {
     public:
         KOKKOS_FUNCTION
         KastaunResidual(const Real &D, const Real &q, const Real &bsq, const Real &bsq_rpsq,
-                const Real &rsq, const Real &rbsq, const Real &v0sq, const Real &gam,
+                const Real &rsq, const Real &rbsq, const Real &v0sq, const EOS &eos,
                 const Real &rho_floor, const Real &e_floor,
                 const Real &gamma_max, const Real &e_max)
             : D_(D), q_(q), bsq_(bsq), bsq_rpsq_(bsq_rpsq),
-            rsq_(rsq), rbsq_(rbsq), v0sq_(v0sq), gam_(gam),
+            rsq_(rsq), rbsq_(rbsq), v0sq_(v0sq), eos_(eos),
             rho_floor_(rho_floor), e_floor_(e_floor),
             gamma_max_(gamma_max), e_max_(e_max) {}
 
@@ -165,7 +168,7 @@ class KastaunResidual {
             const Real What = 1.0 / iWhat;
             Real rhohat = rhohat_mu(iWhat);
             Real ehat = ehat_mu(mu, qbar, rbarsq, vhatsq, What);
-            const Real Phat = ehat * rhohat * (gam_ - 1.0);
+            const Real Phat = eos_.pressure(rhohat, ehat);
             Real hhat = rhohat * (1.0 + ehat) + Phat;
             const Real ahat = Phat / (hhat - Phat); // TODO robust this
             hhat /= rhohat;
@@ -199,24 +202,90 @@ class KastaunResidual {
         bool used_gamma_max() const { return used_gamma_max_; }
 
     private:
-        const Real D_, q_, bsq_, bsq_rpsq_, rsq_, rbsq_, v0sq_, gam_;
+        const Real D_, q_, bsq_, bsq_rpsq_, rsq_, rbsq_, v0sq_;
+        const EOS eos_;
         const Real rho_floor_, e_floor_, gamma_max_, e_max_;
         bool used_density_floor_, used_energy_floor_, used_energy_max_, used_gamma_max_;
 };
 
+/**
+ * Find the root of f in [zm, zp] by false position with the "Illinois algorithm" correction, as in AthenaK.
+ * Sets iter to the iterations taken, which is max_iterations if the solve did not converge.
+ *
+ * With LOCKSTEP, every call takes exactly max_iterations steps, and zones stop updating once converged.
+ * With no trip count or branch depending on the data, neighboring zones can be solved together in SIMD
+ * lanes (e.g. under Parthenon's SIMDFOR_LOOP layout on CPUs).  Results are identical to the scalar solve.
+ */
+template<bool LOCKSTEP, typename Function>
+KOKKOS_FORCEINLINE_FUNCTION Real illinois_solve(const Function& f, Real zm, Real zp,
+                                                const int& max_iterations, const Real& tol, int& iter)
+{
+    // Evaluate master function at bracket values
+    Real fm = f(zm);
+    Real fp = f(zp);
+    // If bracket within tolerances, don't bother doing any iterations
+    const bool within_tol = (m::abs(zm-zp) < tol) || ((m::abs(fm) + m::abs(fp)) < 2.0*tol);
+    Real z = 0.5*(zm + zp);
+
+    if constexpr (LOCKSTEP) {
+        bool done = within_tol;
+        iter = within_tol ? 0 : max_iterations;
+        for (int it = 0; it < max_iterations; ++it) {
+            const Real z_new = (zm*fp - zp*fm)/(fp-fm);
+            const Real f_new = f(z_new);
+            const bool converged = (m::abs(zm-zp) < tol) || (m::abs(f_new) < tol);
+            const bool update = !done && !converged;
+            const bool swap = f_new*fp < 0.0;
+            z = done ? z : z_new;
+            iter = (!done && converged) ? it : iter;
+            zm = (update && swap) ? zp : zm;
+            fm = update ? (swap ? fp : 0.5*fm) : fm;
+            zp = update ? z_new : zp;
+            fp = update ? f_new : fp;
+            done = done || converged;
+        }
+    } else {
+        // For simplicity on the GPU, find roots using the false position method
+        const int n_iter = within_tol ? -1 : max_iterations;
+        for (iter=0; iter<n_iter; ++iter) {
+            z = (zm*fp - zp*fm)/(fp-fm);  // linear interpolation to point f(z)=0
+            Real fz = f(z);
+            // Quit if convergence reached
+            // NOTE(@ermost): both z and f are of order unity
+            if ((m::abs(zm-zp) < tol) || (m::abs(fz) < tol)) {
+                break;
+            }
+            // assign zm-->zp if root bracketed by [z,zp]
+            if (fz*fp < 0.0) {
+                zm = zp;
+                fm = fp;
+                zp = z;
+                fp = fz;
+            } else {  // assign zp-->z if root bracketed by [zm,z]
+                fm = 0.5*fm; // 1/2 comes from "Illinois algorithm" to accelerate convergence
+                zp = z;
+                fp = fz;
+            }
+        }
+    }
+    return z;
+}
+
 /**
  * Robust inversion scheme from Kastaun et al. 2020
  * Unholy mashup of the transformation/equations from Phoebus (which are coordinate-general),
  * and the solver from AthenaK (which is easier to read and precomputes the bracket)
  * TODO keep mu between calls to speed up convergence
  * TODO better returns: be explicit about pre- and post-inversion floors, cat neg_input too
+ * LOCKSTEP selects the fixed-trip-count root finder, see illinois_solve
  */
-template <>
-KOKKOS_INLINE_FUNCTION int u_to_p<Type::kastaun>(const GRCoordinates& G, const VariablePack<Real>& U, const VarMap& m_u,
-                                              const Real& gam, const int& k, const int& j, const int& i,
-                                              const VariablePack<Real>& P, const VarMap& m_p,
-                                              const Loci& loc, const Floors::Prescription& floors,
-                                              const int& max_iterations, const Real& tol)
+template <bool LOCKSTEP=false, typename EOS>
+KOKKOS_INLINE_FUNCTION int kastaun_u_to_p(const GRCoordinates& G, const VariablePack<Real>& U, const VarMap& m_u,
+                                          const EOS& eos, const int& k, const int& j, const int& i,
+                                          const VariablePack<Real>& P, const VarMap& m_p,
+                                          const Loci& loc, const Floors::Prescription& floors,
+                                          const int& max_iterations, const Real& tol,
+                                          int *iterations)
 {
     // Shouldn't need this, KHARMA should die on NaN
     // But it's here for debugging
@@ -293,87 +362,24 @@ KOKKOS_INLINE_FUNCTION int u_to_p<Type::kastaun>(const GRCoordinates& G, const V
     const Real v0sq = std::min(zsq / (1.0 + zsq), 1.0 - 1.0 / SQR(floors.gamma_max));
 
     // residual object. Caches most arguments/floors so calls are single-argument
-    KastaunResidual res(D, q, bsq, bsq_rpsq, rsq, rbsq, v0sq, gam,
+    KastaunResidual<EOS> res(D, q, bsq, bsq_rpsq, rsq, rbsq, v0sq, eos,
                         floors.rho_min_const, floors.u_min_const / D_fl,
                         floors.gamma_max, floors.u_over_rho_max);
 
     // SOLVE
     // TODO(BSP) better or faster solver?  (Optionally) skip bracketing?
     // Need to find initial bracket. Requires separate solve
-    Real zm = 0.;
-    Real zp = 1.; // This is the lowest specific enthalpy admitted by the EOS
-
-    // Evaluate master function (eq 49) at bracket values
-    Real fm = res.aux_func(zm);
-    Real fp = res.aux_func(zp);
-
-    // For simplicity on the GPU, find roots using the false position method
-    int iterations = max_iterations;
-    // If bracket within tolerances, don't bother doing any iterations
-    if ((m::abs(zm-zp) < tol) || ((m::abs(fm) + m::abs(fp)) < 2.0*tol)) {
-        iterations = -1;
-    }
-    Real z = 0.5*(zm + zp);
-
-    int iter;
-    for (iter=0; iter<iterations; ++iter) {
-        z =  (zm*fp - zp*fm)/(fp-fm);  // linear interpolation to point f(z)=0
-        Real f = res.aux_func(z);
-        // Quit if convergence reached
-        // NOTE(@ermost): both z and f are of order unity
-        if ((m::abs(zm-zp) < tol) || (m::abs(f) < tol)) {
-            break;
-        }
-        // assign zm-->zp if root bracketed by [z,zp]
-        if (f*fp < 0.0) {
-            zm = zp;
-            fm = fp;
-            zp = z;
-            fp = f;
-        } else {  // assign zp-->z if root bracketed by [zm,z]
-            fm = 0.5*fm; // 1/2 comes from "Illinois algorithm" to accelerate convergence
-            zp = z;
-            fp = f;
-        }
-    }
-    // TODO keep track of bracket iter?
+    // Evaluate master function (eq 49) between zm=0 & zp=1 (the lowest specific enthalpy admitted by the EOS)
+    int bracket_iter, iter;
+    const Real z_bracket = illinois_solve<LOCKSTEP>([&res](const Real& mu) { return res.aux_func(mu); },
+                                                    0., 1., max_iterations, tol, bracket_iter);
 
     // Found brackets. Now find solution in bounded interval, again using the
-    // false position method
-    zm = 0.;
-    zp = z;
-
-    // Evaluate master function (eq 44) at bracket values
-    fm = res(zm);
-    fp = res(zp);
-
-    iterations = max_iterations;
-    if ((m::abs(zm-zp) < tol) || ((m::abs(fm) + m::abs(fp)) < 2.0*tol)) {
-        iterations = -1;
-    }
-    z = 0.5*(zm + zp);
-
-    for (iter=0; iter<iterations; ++iter) {
-        z = (zm*fp - zp*fm)/(fp-fm);  // linear interpolation to point f(z)=0
-        Real f = res(z);
-        // Quit if convergence reached
-        // NOTE: both z and f are of order unity
-        if ((m::abs(zm-zp) < tol) || (m::abs(f) < tol)) {
-            break;
-        }
-        // assign zm-->zp if root bracketed by [z,zp]
-        if (f*fp < 0.0) {
-            zm = zp;
-            fm = fp;
-            zp = z;
-            fp = f;
-        } else {  // assign zp-->z if root bracketed by [zm,z]
-            fm = 0.5*fm; // 1/2 comes from "Illinois algorithm" to accelerate convergence
-            zp = z;
-            fp = f;
-        }
-    }
-    // TODO keep track of max iter
+    // false position method, this time on the master function (eq 44)
+    const Real z = illinois_solve<LOCKSTEP>([&res](const Real& mu) { return res(mu); },
+                                            0., z_bracket, max_iterations, tol, iter);
+    // Report total iterations (bracketing + solve) for diagnostics, if asked
+    if (iterations) *iterations = bracket_iter + iter;
 
     // check if convergence is established within max_iterations.  If not, return
     // failure without replacing prims, for consistency w/1Dw solver.
@@ -403,4 +409,41 @@ KOKKOS_INLINE_FUNCTION int u_to_p<Type::kastaun>(const GRCoordinates& G, const V
     return fflag;
 }
 
+/**
+ * Kastaun inversion with the gamma-law EOS, or with a tabulated EOS if one is passed
+ */
+template <>
+KOKKOS_INLINE_FUNCTION int u_to_p<Type::kastaun>(const GRCoordinates& G, const VariablePack<Real>& U, const VarMap& m_u,
+                                              const Real& gam, const int& k, const int& j, const int& i,
+                                              const VariablePack<Real>& P, const VarMap& m_p,
+                                              const Loci& loc, const Floors::Prescription& floors,
+                                              const int& max_iterations, const Real& tol,
+                                              int *iterations, const TabulatedEOS *eos_table)
+{
+    if (eos_table) {
+        return kastaun_u_to_p(G, U, m_u, *eos_table, k, j, i, P, m_p, loc, floors, max_iterations, tol, iterations);
+    } else {
+        return kastaun_u_to_p(G, U, m_u, IdealEOS(gam), k, j, i, P, m_p, loc, floors, max_iterations, tol, iterations);
+    }
+}
+
+/**
+ * Kastaun inversion with every root-find taking max_iterations steps, for vectorizing on CPUs.
+ * See illinois_solve
+ */
+template <>
+KOKKOS_INLINE_FUNCTION int u_to_p<Type::kastaun_lockstep>(const GRCoordinates& G, const VariablePack<Real>& U, const VarMap& m_u,
+                                              const Real& gam, const int& k, const int& j, const int& i,
+                                              const VariablePack<Real>& P, const VarMap& m_p,
+                                              const Loci& loc, const Floors::Prescription& floors,
+                                              const int& max_iterations, const Real& tol,
+                                              int *iterations, const TabulatedEOS *eos_table)
+{
+    if (eos_table) {
+        return kastaun_u_to_p<true>(G, U, m_u, *eos_table, k, j, i, P, m_p, loc, floors, max_iterations, tol, iterations);
+    } else {
+        return kastaun_u_to_p<true>(G, U, m_u, IdealEOS(gam), k, j, i, P, m_p, loc, floors, max_iterations, tol, iterations);
+    }
+}
+
 }
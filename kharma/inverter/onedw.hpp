@@ -91,7 +91,8 @@ KOKKOS_INLINE_FUNCTION int u_to_p<Type::onedw>(const GRCoordinates& G, const Var
                                               const Real& gam, const int& k, const int& j, const int& i,
                                               const VariablePack<Real>& P, const VarMap& m_p,
                                               const Loci& loc, const Floors::Prescription& floors,
-                                              const int& max_iterations, const Real& tol)
+                                              const int& max_iterations, const Real& tol,
+                                              int *iterations, const TabulatedEOS *eos_table)
 {
     // TODO try inline floors in the old 1Dw?  Probably not relevant anymore
     // Catch negative density
@@ -200,6 +201,8 @@ KOKKOS_INLINE_FUNCTION int u_to_p<Type::onedw>(const GRCoordinates& G, const Var
 
         if (m::abs(err / Wp) < tol) break;
     }
+    // Report iteration count for diagnostics, if asked
+    if (iterations) *iterations = iter;
     // Return failure to converge
     if (iter == max_iterations) return static_cast<int>(Status::max_iter);
 
@@ -0,0 +1,185 @@
+/* 
+ *  File: ismr.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ismr.hpp"
+
+#include "domain.hpp"
+
+std::shared_ptr<KHARMAPackage> ISMR::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("ISMR");
+    Params &params = pkg->AllParams();
+
+    // Number of coarsened rows at each pole.  The first is coarsened by 2^nlevels
+    const int nlevels = pin->GetOrAddInteger("ismr", "nlevels", 1);
+    if (nlevels < 1) throw std::invalid_argument("ISMR requires ismr/nlevels >= 1!");
+    params.Add("nlevels", nlevels);
+
+    if (!pin->GetBoolean("coordinates", "spherical"))
+        throw std::invalid_argument("ISMR requires spherical coordinates!");
+    if (pin->GetInteger("parthenon/mesh", "nx3") == 1)
+        throw std::invalid_argument("ISMR requires a 3D mesh!");
+    if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") == "adaptive")
+        throw std::invalid_argument("ISMR is not supported with adaptive refinement!");
+    // Groups must not straddle blocks, and face fields need the row past the last coarsened one
+    const int mb_nx2 = pin->GetOrAddInteger("parthenon/meshblock", "nx2", pin->GetInteger("parthenon/mesh", "nx2"));
+    const int mb_nx3 = pin->GetOrAddInteger("parthenon/meshblock", "nx3", pin->GetInteger("parthenon/mesh", "nx3"));
+    if (mb_nx3 % (1 << nlevels) != 0)
+        throw std::invalid_argument("ISMR requires meshblock nx3 divisible by 2^nlevels!");
+    if (mb_nx2 < 2 * (nlevels + 1))
+        throw std::invalid_argument("ISMR requires meshblock nx2 >= 2*(nlevels + 1)!");
+    // The cached timestep takes block minima as the fluxes are computed, without the merged widths
+    if (packages->Get("Flux")->Param<bool>("cache_timestep"))
+        throw std::invalid_argument("ISMR is not supported with flux/cache_timestep!");
+    // The simple driver's fused update skips the averaging
+    if (packages->Get("Driver")->Param<bool>("simple_fused"))
+        throw std::invalid_argument("ISMR is not supported with driver/simple_fused!");
+    // Implicitly-evolved variables are updated after the averaging
+    if (packages->Get("GRMHD")->Param<bool>("implicit") || pin->GetOrAddBoolean("emhd", "on", false))
+        throw std::invalid_argument("ISMR is not supported with implicit evolution!");
+    // Averaging cell-centered fields would not preserve their (corner-centered) divergence
+    if (packages->AllPackages().count("B_FluxCT") || packages->AllPackages().count("B_CD"))
+        throw std::invalid_argument("ISMR requires magnetic fields to use face-centered CT!");
+
+    params.Add("polar_blocks", std::map<int, PolarBlocks>(), true);
+
+    return pkg;
+}
+
+ParArray2D<int> ISMR::GetPolarBlocks(MeshData<Real> *md)
+{
+    auto *cache = GetPartitionParam<PolarBlocks>(md, "ISMR", "polar_blocks");
+    auto locs = PartitionLocations(md);
+    if (cache->poles.extent_int(0) >= md->NumBlocks() && cache->locs == locs) return cache->poles;
+
+    if (cache->poles.extent_int(0) < md->NumBlocks())
+        cache->poles = ParArray2D<int>("ismr_polar_blocks", md->NumBlocks(), 2);
+    const auto poles = cache->poles;
+    auto poles_h = Kokkos::create_mirror_view(poles);
+    for (int b = 0; b < md->NumBlocks(); ++b) {
+        auto pmb = md->GetBlockData(b)->GetBlockPointer();
+        // In spherical coordinates, any domain boundary in X2 is a pole
+        poles_h(b, 0) = pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::user;
+        poles_h(b, 1) = pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::user;
+    }
+    Kokkos::deep_copy(poles, poles_h);
+    cache->locs = locs;
+    return poles;
+}
+
+TaskStatus ISMR::DerefinePoles(MeshData<Real> *md)
+{
+    Flag("DerefinePoles");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    const int nlevels = pmb0->packages.Get("ISMR")->Param<int>("nlevels");
+    const bool use_b_ct = pmb0->packages.AllPackages().count("B_CT");
+
+    auto U = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell});
+    const int nvar = U.GetDim(4);
+    const auto poles = GetPolarBlocks(md);
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+    const int n3 = b.ke - b.ks + 1;
+    // Rows are numbered from zero at each pole, with rows at both poles together: s*(nlevels+1) + p
+    // Groups are indexed up to the largest count, n3/2 in the last coarsened row
+    pmb0->par_for("ismr_average_cells", block.s, block.e, 0, 2*nlevels - 1, 0, n3/2 - 1, b.is, b.ie,
+        KOKKOS_LAMBDA (const int& bl, const int& sp, const int& grp, const int& i) {
+            const int s = sp / nlevels, p = sp % nlevels;
+            const int g = GroupSize(nlevels, p);
+            if (!poles(bl, s) || grp >= n3 / g) return;
+            const int j = (s == 0) ? b.js + p : b.je - p;
+            const int k0 = b.ks + grp * g;
+            for (int v = 0; v < nvar; v++) {
+                Real avg = 0.;
+                for (int k = k0; k < k0 + g; k++) avg += U(bl, v, k, j, i);
+                avg /= g;
+                for (int k = k0; k < k0 + g; k++) U(bl, v, k, j, i) = avg;
+            }
+        }
+    );
+
+    if (use_b_ct) {
+        auto fB = md->PackVariables(std::vector<std::string>{"cons.fB"});
+        // The X2 face on the polar side of row p is shared with row p-1, the coarser, so must be averaged
+        // over its groups.  This includes the face bounding the first uncoarsened row, p == nlevels
+        pmb0->par_for("ismr_average_faces", block.s, block.e, 0, 2*(nlevels + 1) - 1, 0, n3/2 - 1, b.is, b.ie + 1,
+            KOKKOS_LAMBDA (const int& bl, const int& sp, const int& grp, const int& i) {
+                const int s = sp / (nlevels + 1), p = sp % (nlevels + 1);
+                if (!poles(bl, s)) return;
+                const int j = (s == 0) ? b.js + p : b.je - p;
+                // X1 faces of the coarsened rows
+                const int g1 = GroupSize(nlevels, p);
+                if (p < nlevels && grp < n3 / g1) {
+                    const int k0 = b.ks + grp * g1;
+                    Real avg = 0.;
+                    for (int k = k0; k < k0 + g1; k++) avg += fB(bl, F1, 0, k, j, i);
+                    avg /= g1;
+                    for (int k = k0; k < k0 + g1; k++) fB(bl, F1, 0, k, j, i) = avg;
+                }
+                // X2 faces on the polar side of each row, including the pole itself
+                const int g2 = GroupSize(nlevels, m::max(p - 1, 0));
+                const int jf = (s == 0) ? b.js + p : b.je + 1 - p;
+                if (i <= b.ie && grp < n3 / g2) {
+                    const int k0 = b.ks + grp * g2;
+                    Real avg = 0.;
+                    for (int k = k0; k < k0 + g2; k++) avg += fB(bl, F2, 0, k, jf, i);
+                    avg /= g2;
+                    for (int k = k0; k < k0 + g2; k++) fB(bl, F2, 0, k, jf, i) = avg;
+                }
+            }
+        );
+
+        // Re-integrate X3 faces across each span of zones whose X1 and X2 faces were averaged together.
+        // The faces bounding each span are unchanged, and zero divergence in each zone gives those between
+        pmb0->par_for("ismr_integrate_b3", block.s, block.e, 0, 2*(nlevels + 1) - 1, 0, n3/2 - 1, b.is, b.ie,
+            KOKKOS_LAMBDA (const int& bl, const int& sp, const int& grp, const int& i) {
+                const int s = sp / (nlevels + 1), p = sp % (nlevels + 1);
+                const int g = GroupSize(nlevels, m::max(p - 1, 0));
+                if (!poles(bl, s) || grp >= n3 / g) return;
+                const auto& G = fB.GetCoords(bl);
+                const int j = (s == 0) ? b.js + p : b.je - p;
+                const int k0 = b.ks + grp * g;
+                for (int k = k0; k < k0 + g - 1; k++) {
+                    const Real div12 = (fB(bl, F1, 0, k, j, i + 1) - fB(bl, F1, 0, k, j, i)) / G.Dxc<1>(i)
+                                     + (fB(bl, F2, 0, k, j + 1, i) - fB(bl, F2, 0, k, j, i)) / G.Dxc<2>(j);
+                    fB(bl, F3, 0, k + 1, j, i) = fB(bl, F3, 0, k, j, i) - div12 * G.Dxc<3>(k);
+                }
+            }
+        );
+    }
+
+    EndFlag();
+    return TaskStatus::complete;
+}
@@ -0,0 +1,83 @@
+/* 
+ *  File: ismr.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Internal static mesh refinement (ISMR): coarsen zones in X3 near the poles, within each MeshBlock.
+ *
+ * Zones in the p'th row from a pole (p < nlevels) are merged in groups of 2^(nlevels-p) in X3.
+ * Every zone is still evolved, but after each update the conserved variables are averaged over each group.
+ * Since zones in a group start the substep identical, that average is exactly the update of the
+ * merged zone by the fluxes through its outer faces: fluxes between zones of a group cancel.
+ * Face-centered fields are averaged over the same groups on X1 faces and on the X2 faces bounding each
+ * coarsened row, and the X3 faces inside each group are then re-integrated so that divB is unchanged.
+ *
+ * The polar rows then limit the timestep by their merged width, see GRMHD::EstimateTimestep,
+ * which often removes the polar Courant limit from the global step of 3D spherical runs.
+ */
+namespace ISMR {
+
+/**
+ * Initialize the ISMR package, checking that the mesh can be coarsened
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Number of zones merged in X3 in the row p zones from a pole
+ */
+KOKKOS_INLINE_FUNCTION int GroupSize(const int& nlevels, const int& p)
+{
+    return (p < nlevels) ? (1 << (nlevels - p)) : 1;
+}
+
+/**
+ * Average the conserved state over each group of merged zones, on blocks touching a pole.
+ * Called after every state update, before boundary sync, see KHARMADriver::AddStateUpdate
+ */
+TaskStatus DerefinePoles(MeshData<Real> *md);
+
+/**
+ * Which pole(s) each block in md touches, as (block, 0 for X2 inner or 1 for outer).  Cached per partition
+ */
+struct PolarBlocks {
+    ParArray2D<int> poles;
+    std::vector<LogicalLocation> locs;
+};
+ParArray2D<int> GetPolarBlocks(MeshData<Real> *md);
+
+}
@@ -33,6 +33,9 @@
  */
 #include "kharma.hpp"
 
+#include <chrono>
+#include <filesystem>
+#include <future>
 #include <iostream>
 
 #include <parthenon/parthenon.hpp>
@@ -41,6 +44,8 @@
 #include "version.hpp"
 
 // Packages
+#include "async_output.hpp"
+#include "averages.hpp"
 #include "b_flux_ct.hpp"
 #include "b_cd.hpp"
 #include "b_cleanup.hpp"
@@ -50,11 +55,18 @@
 #include "kharma_driver.hpp"
 #include "electrons.hpp"
 #include "implicit.hpp"
+#include "fault.hpp"
+#include "host_diagnostics.hpp"
+#include "insitu.hpp"
 #include "inverter.hpp"
+#include "ismr.hpp"
 #include "floors.hpp"
 #include "flux.hpp"
 #include "grmhd.hpp"
+#include "multizone.hpp"
 #include "reductions.hpp"
+#include "slice_output.hpp"
+#include "tracers.hpp"
 #include "emhd.hpp"
 #include "wind.hpp"
 
@@ -73,8 +85,12 @@ std::shared_ptr<KHARMAPackage> KHARMA::InitializeGlobals(ParameterInput *pin, st
     params.Add("time", 0.0, true);
     // Last step's dt (Parthenon SimTime tm.dt), which must be preserved to output jcon
     params.Add("dt_last", 0.0, true);
+    // Current step number, for anything scheduled by cycle outside the driver
+    params.Add("ncycle", 0, true);
     // Whether we are computing initial outputs/timestep, or versions in the execution loop
     params.Add("in_loop", false, true);
+    // Interior zones updated on this rank, summed over steps, for performance summaries
+    params.Add("zone_cycles", 0.0, true);
 
     // Log levels, the other acceptable global
     // Made mutable in case we want to bump global log level on certain events
@@ -86,6 +102,17 @@ std::shared_ptr<KHARMAPackage> KHARMA::InitializeGlobals(ParameterInput *pin, st
     int extra_checks = pin->GetOrAddInteger("debug", "extra_checks", 0);
     params.Add("extra_checks", extra_checks, true);
 
+    // Wall-clock timers for each Flag() region, printed at the end and optionally every N steps
+    RegionTimer::enabled = pin->GetOrAddBoolean("debug", "region_timers", false);
+    RegionTimer::fence = pin->GetOrAddBoolean("debug", "region_timer_fence", false);
+    int region_timer_interval = pin->GetOrAddInteger("debug", "region_timer_interval", 0);
+    params.Add("region_timer_interval", region_timer_interval);
+    // Per-rank split of step time into compute, MPI wait & host overhead, printed every N steps and at the end
+    WaitTimer::enabled = pin->GetOrAddBoolean("debug", "wait_timers", false);
+    WaitTimer::fence = pin->GetOrAddBoolean("debug", "wait_timer_fence", false);
+    int wait_timer_interval = pin->GetOrAddInteger("debug", "wait_timer_interval", 100);
+    params.Add("wait_timer_interval", wait_timer_interval);
+
     // Record the problem name, just in case we need to special-case for different problems.
     // Please favor packages & options before using this, and modify problem-specific code
     // to be more general as it matures.
@@ -100,6 +127,7 @@ std::shared_ptr<KHARMAPackage> KHARMA::InitializeGlobals(ParameterInput *pin, st
     // Update the times with callbacks
     pkg->PreStepWork = KHARMA::PreStepWork;
     pkg->PostStepWork = KHARMA::PostStepWork;
+    pkg->PostExecute = KHARMA::PostExecute;
 
     return pkg;
 }
@@ -126,6 +154,14 @@ void KHARMA::PreStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
     }
     globals.Update<double>("dt_last", tm.dt);
     globals.Update<double>("time", tm.time);
+    globals.Update<int>("ncycle", tm.ncycle);
+
+    if (WaitTimer::enabled) {
+        WaitTimer::StepStart();
+        const int wait_timer_interval = globals.Get<int>("wait_timer_interval");
+        if (wait_timer_interval > 0 && tm.ncycle > 0 && tm.ncycle % wait_timer_interval == 0)
+            WaitTimer::Print();
+    }
 }
 
 void KHARMA::PostStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
@@ -139,6 +175,24 @@ void KHARMA::PostStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
     auto& globals = pmesh->packages.Get("Globals")->AllParams();
     globals.Update<double>("dt_last", tm.dt);
     globals.Update<double>("time", tm.time);
+    double zones = 0.;
+    for (auto &pmb : pmesh->block_list)
+        zones += pmb->cellbounds.ncellsi(IndexDomain::interior) * pmb->cellbounds.ncellsj(IndexDomain::interior)
+                 * pmb->cellbounds.ncellsk(IndexDomain::interior);
+    globals.Update<double>("zone_cycles", globals.Get<double>("zone_cycles") + zones);
+
+    const int region_timer_interval = globals.Get<int>("region_timer_interval");
+    if (RegionTimer::enabled && region_timer_interval > 0 && (tm.ncycle + 1) % region_timer_interval == 0)
+        RegionTimer::Print();
+}
+
+void KHARMA::PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    if (RegionTimer::enabled) RegionTimer::Print();
+    if (WaitTimer::enabled) {
+        WaitTimer::StepStart();
+        WaitTimer::Print();
+    }
 }
 
 void KHARMA::FixParameters(ParameterInput *pin, bool is_parthenon_restart)
@@ -154,6 +208,20 @@ void KHARMA::FixParameters(ParameterInput *pin, bool is_parthenon_restart)
     // If we're restarting (not via Parthenon), read the restart file to get most parameters
     std::string prob = pin->GetString("parthenon/job", "problem_id");
     if (!is_parthenon_restart) {
+        // Prefer copies of the restart files staged to node-local storage, e.g. an NVMe burst buffer.
+        // Checked per rank, so nodes without a copy read from the original path
+        if (prob == "resize_restart" || prob == "resize_restart_kharma") {
+            const std::string local_dir = pin->GetOrAddString("resize_restart", "local_dir", "");
+            if (local_dir != "") {
+                for (std::string param : {"fname", "fname_fill"}) {
+                    if (!pin->DoesParameterExist("resize_restart", param)) continue;
+                    const std::filesystem::path fname = pin->GetString("resize_restart", param);
+                    const std::filesystem::path local = std::filesystem::path(local_dir) / fname.filename();
+                    if (fname.string() != "none" && std::filesystem::exists(local))
+                        pin->SetString("resize_restart", param, local.string());
+                }
+            }
+        }
         if (prob == "resize_restart") {
             ReadIharmRestartHeader(pin->GetString("resize_restart", "fname"), pin);
         }
@@ -232,6 +300,7 @@ void KHARMA::FixParameters(ParameterInput *pin, bool is_parthenon_restart)
 
         // If the simulation domain extends inside the EH, we change some boundary options
         pin->SetBoolean("coordinates", "domain_intersects_eh", pin->GetReal("coordinates", "r_in") < tmp_coords.get_horizon());
+        pin->SetReal("coordinates", "r_eh", tmp_coords.get_horizon());
 
         // Spherical systems will also want KHARMA's spherical boundary conditions.
         // Note boundaries are now exclusively set by KBoundaries package
@@ -312,9 +381,97 @@ void KHARMA::FixParameters(ParameterInput *pin, bool is_parthenon_restart)
         }
     }
 
+    // Regions generated from physical targets are in native coordinates already
+    if (pin->DoesBlockExist("smr/target0")) {
+        GenerateStaticRefinement(pin);
+    }
+
     EndFlag();
 }
 
+void KHARMA::GenerateStaticRefinement(ParameterInput *pin)
+{
+    CoordinateEmbedding tmp_coords(pin);
+    if (!tmp_coords.is_spherical())
+        throw std::invalid_argument("Refinement targets are only supported in spherical coordinates!");
+
+    const GReal x1min = pin->GetReal("parthenon/mesh", "x1min");
+    const GReal x1max = pin->GetReal("parthenon/mesh", "x1max");
+    const GReal x2min = pin->GetReal("parthenon/mesh", "x2min");
+    const GReal x2max = pin->GetReal("parthenon/mesh", "x2max");
+    const GReal x3min = pin->GetReal("parthenon/mesh", "x3min");
+    const GReal x3max = pin->GetReal("parthenon/mesh", "x3max");
+    const GReal r_in = pin->GetReal("coordinates", "r_in");
+    const GReal r_out = pin->GetReal("coordinates", "r_out");
+
+    // Native X2 of a given theta at each radius in a range.  In e.g. FMKS the mapping depends on r,
+    // so funnels take the widest X2 range over the radii they cover.
+    auto x2_range_of = [&tmp_coords](const GReal r_min, const GReal r_max, const GReal th) {
+        const int nsamples = 64;
+        GReal x2_lo = std::numeric_limits<GReal>::max(), x2_hi = std::numeric_limits<GReal>::lowest();
+        for (int n = 0; n < nsamples; ++n) {
+            const GReal r = r_min * m::pow(r_max / r_min, ((GReal) n) / (nsamples - 1));
+            const GReal Xembed[GR_DIM] = {0., r, th, 0.};
+            GReal Xnative[GR_DIM];
+            tmp_coords.coord_to_native(Xembed, Xnative);
+            x2_lo = m::min(x2_lo, Xnative[2]);
+            x2_hi = m::max(x2_hi, Xnative[2]);
+        }
+        return std::make_pair(x2_lo, x2_hi);
+    };
+    auto add_region = [pin](const std::string& name, const GReal x1l, const GReal x1h, const GReal x2l, const GReal x2h,
+                            const GReal x3l, const GReal x3h, const int level) {
+        // Names are fixed by target, so re-generating on restart overwrites rather than duplicates them
+        const std::string block = "parthenon/static_refinement_" + name;
+        pin->SetReal(block, "x1min", x1l);
+        pin->SetReal(block, "x1max", x1h);
+        pin->SetReal(block, "x2min", x2l);
+        pin->SetReal(block, "x2max", x2h);
+        pin->SetReal(block, "x3min", x3l);
+        pin->SetReal(block, "x3max", x3h);
+        pin->SetInteger(block, "level", level);
+    };
+
+    int max_level = 0;
+    for (int t = 0; pin->DoesBlockExist("smr/target" + std::to_string(t)); ++t) {
+        const std::string target = "smr/target" + std::to_string(t);
+        const int level = pin->GetInteger(target, "level");
+        if (level < 1) throw std::invalid_argument("Refinement targets must have level >= 1!");
+        max_level = m::max(max_level, level);
+        const GReal r_min = m::max(pin->GetOrAddReal(target, "r_min", r_in), r_in);
+        const GReal r_max = m::min(pin->GetOrAddReal(target, "r_max", r_out), r_out);
+        if (r_max <= r_min) throw std::invalid_argument("Refinement target " + target + " lies outside the domain!");
+        const GReal x1l = m::max(tmp_coords.r_to_native(r_min), x1min);
+        const GReal x1h = m::min(tmp_coords.r_to_native(r_max), x1max);
+
+        if (pin->DoesParameterExist(target, "theta_j")) {
+            // The polar funnel within theta_j of each pole
+            const GReal theta_j = pin->GetReal(target, "theta_j");
+            if (theta_j <= 0. || theta_j >= M_PI / 2)
+                throw std::invalid_argument("Refinement target " + target + " needs 0 < theta_j < pi/2!");
+            const GReal x2_north = x2_range_of(r_min, r_max, theta_j).second;
+            const GReal x2_south = x2_range_of(r_min, r_max, M_PI - theta_j).first;
+            add_region("target" + std::to_string(t) + "_north", x1l, x1h, x2min, m::min(x2_north, x2max), x3min, x3max, level);
+            add_region("target" + std::to_string(t) + "_south", x1l, x1h, m::max(x2_south, x2min), x2max, x3min, x3max, level);
+        } else {
+            add_region("target" + std::to_string(t), x1l, x1h, x2min, x2max, x3min, x3max, level);
+        }
+    }
+
+    // Make sure Parthenon will actually build the levels we asked for
+    if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") == "none")
+        pin->SetString("parthenon/mesh", "refinement", "static");
+    if (pin->GetOrAddInteger("parthenon/mesh", "numlevel", 1) < max_level + 1)
+        pin->SetInteger("parthenon/mesh", "numlevel", max_level + 1);
+
+    // The starting timestep is usually chosen for the base grid: the finest zones need one 2^max_level smaller
+    // for the first step, after which GRMHD::EstimateTimestep sees the real zone sizes
+    if (pin->DoesParameterExist("parthenon/time", "dt") && !pin->GetOrAddBoolean("smr", "dt_adjusted", false)) {
+        pin->SetReal("parthenon/time", "dt", pin->GetReal("parthenon/time", "dt") / (1 << max_level));
+        pin->SetBoolean("smr", "dt_adjusted", true);
+    }
+}
+
 TaskStatus KHARMA::AddPackage(std::shared_ptr<Packages_t>& packages,
                               std::function<std::shared_ptr<KHARMAPackage>(ParameterInput*, std::shared_ptr<Packages_t>&)> package_init,
                               ParameterInput *pin)
@@ -327,6 +484,28 @@ TaskStatus KHARMA::AddPackage(std::shared_ptr<Packages_t>& packages,
     return TaskStatus::complete;
 }
 
+TaskStatus KHARMA::AddPackageConcurrent(std::shared_ptr<Packages_t>& packages,
+                                        std::function<std::shared_ptr<KHARMAPackage>(ParameterInput*, std::shared_ptr<Packages_t>&)> package_init,
+                                        ParameterInput *pin, std::shared_ptr<std::future<std::shared_ptr<KHARMAPackage>>> pending)
+{
+    if (!pending->valid()) {
+        // Packages are only ever added from this thread, so initialization reads its own copy of the list
+        auto loaded = std::make_shared<Packages_t>(*packages);
+        *pending = std::async(std::launch::async, [package_init, pin, loaded]() mutable {
+            return package_init(pin, loaded);
+        });
+        return TaskStatus::incomplete;
+    }
+    if (pending->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return TaskStatus::incomplete;
+
+    const auto pkg = pending->get();
+    packages->Add(pkg);
+    Flag("AddPackage_"+pkg->label());
+    EndFlag();
+    return TaskStatus::complete;
+}
+
 Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
 {
     Flag("ProcessPackages");
@@ -339,17 +518,29 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
     auto& tr = tc.AddRegion(1);
     auto& tl = tr[0];
     TaskID t_none(0);
+    // Packages with no dependency between them can be initialized concurrently, each on a host thread.
+    // Off by default: this requires every Initialize below to only read from the packages it depends on
+    const bool parallel_init = pin->GetOrAddBoolean("driver", "parallel_init", false);
+    auto add_package = [&](const TaskID& dep,
+                           std::function<std::shared_ptr<KHARMAPackage>(ParameterInput*, std::shared_ptr<Packages_t>&)> package_init) {
+        if (parallel_init) {
+            return tl.AddTask(dep, KHARMA::AddPackageConcurrent, packages, package_init, pin.get(),
+                              std::make_shared<std::future<std::shared_ptr<KHARMAPackage>>>());
+        } else {
+            return add_package(dep, package_init);
+        }
+    };
     // The globals package will never have dependencies
-    auto t_globals = tl.AddTask(t_none, KHARMA::AddPackage, packages, KHARMA::InitializeGlobals, pin.get());
+    auto t_globals = add_package(t_none, KHARMA::InitializeGlobals);
     // Neither will grid output, as any mesh will get GRCoordinates objects
     // FieldIsOutput actually just checks for substring match, so this matches any coords. variable
     if (FieldIsOutput(pin.get(), "coords")) {
-        auto t_coord_out = tl.AddTask(t_none, KHARMA::AddPackage, packages, CoordinateOutput::Initialize, pin.get());
+        auto t_coord_out = add_package(t_none, CoordinateOutput::Initialize);
     }
     // Driver package is the foundation
-    auto t_driver = tl.AddTask(t_none, KHARMA::AddPackage, packages, KHARMADriver::Initialize, pin.get());
+    auto t_driver = add_package(t_none, KHARMADriver::Initialize);
     // GRMHD needs globals to mark packages
-    auto t_grmhd = tl.AddTask(t_globals | t_driver, KHARMA::AddPackage, packages, GRMHD::Initialize, pin.get());
+    auto t_grmhd = add_package(t_globals | t_driver, GRMHD::Initialize);
     // Only load the inverter if GRMHD/EMHD isn't being evolved implicitly
     // Unless we want to use the explicitly-evolved ideal MHD variables as a guess for the solver
     // Or we want first-order flux corrections, which rely on a UtoP guess
@@ -358,7 +549,7 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
     auto t_inverter = t_grmhd;
     if (!pin->GetOrAddBoolean("GRMHD", "implicit", pin->GetOrAddBoolean("emhd", "on", false)) ||
         pin->GetOrAddBoolean("emhd", "ideal_guess", false) || pin->GetOrAddBoolean("fofc", "on", false)) {
-        t_inverter = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, Inverter::Initialize, pin.get());
+        t_inverter = add_package(t_grmhd, Inverter::Initialize);
     }
     // Floors package is only loaded if floors aren't disabled
     // Respect legacy version for a while
@@ -367,10 +558,10 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
         floors_on_default = !pin->GetBoolean("floors", "disable_floors");
     }
     if (pin->GetOrAddBoolean("floors", "on", floors_on_default)) {
-        auto t_floors = tl.AddTask(t_inverter, KHARMA::AddPackage, packages, Floors::Initialize, pin.get());
+        auto t_floors = add_package(t_inverter, Floors::Initialize);
     }
     // Reductions, needed by most other packages
-    auto t_reductions = tl.AddTask(t_none, KHARMA::AddPackage, packages, Reductions::Initialize, pin.get());
+    auto t_reductions = add_package(t_none, Reductions::Initialize);
 
     // B field solvers, to ensure divB ~= 0.
     // Bunch of logic here: basically we want to load <=1 solver with an encoded order of preference:
@@ -383,12 +574,12 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
     if (b_field_solver == "none" || b_field_solver == "cleanup" || b_field_solver == "b_cleanup") {
         // Don't add a B field here
     } else if (b_field_solver == "constrained_transport" || b_field_solver == "face_ct") {
-        t_b_field = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, B_CT::Initialize, pin.get());
+        t_b_field = add_package(t_grmhd, B_CT::Initialize);
     } else if (b_field_solver == "constraint_damping" || b_field_solver == "cd") {
         // Constraint damping. NON-WORKING
-        t_b_field = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, B_CD::Initialize, pin.get());
+        t_b_field = add_package(t_grmhd, B_CD::Initialize);
     } else if (b_field_solver == "flux_ct") {
-        t_b_field = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, B_FluxCT::Initialize, pin.get());
+        t_b_field = add_package(t_grmhd, B_FluxCT::Initialize);
     } else {
         throw std::invalid_argument("Invalid solver! Must be e.g., flux_ct, face_ct, cd, cleanup...");
     }
@@ -396,37 +587,44 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
     // Almost always loaded explicitly in addition to another transport, just for cleaning at simulation start
     // Enable b_cleanup package if we want it explicitly
     bool b_cleanup_package = pin->GetOrAddBoolean("b_cleanup", "on", (b_field_solver == "b_cleanup"));
-    // OR if we need it for resizing a dump
-    bool is_resize = pin->GetString("parthenon/job", "problem_id") == "resize_restart" &&
-                     !pin->GetOrAddBoolean("resize_restart", "skip_b_cleanup", false);
+    // OR if we need it for resizing a dump.
+    // A nearest-neighbor copy onto the file's own grid keeps a Flux-CT field exactly as it was
+    // written, so its divergence is preserved by construction and we can skip the solve (and its memory).
+    // Face CT always re-cleans, since the field must be interpolated from centers to faces.
+    const bool is_resize_restart = pin->GetString("parthenon/job", "problem_id") == "resize_restart";
+    const bool resize_preserves_divb = is_resize_restart && b_field_solver == "flux_ct" &&
+                                       pin->GetOrAddBoolean("resize_restart", "exact_grid", false);
+    bool is_resize = is_resize_restart && (b_field_solver == "constrained_transport" || b_field_solver == "face_ct" ||
+                     !pin->GetOrAddBoolean("resize_restart", "skip_b_cleanup", resize_preserves_divb));
     // OR if we ordered an initial cleanup pass for some other reason
     bool initial_cleanup = pin->GetOrAddBoolean("b_field", "initial_cleanup", false);
     bool use_b_cleanup = b_cleanup_package || is_resize || initial_cleanup;
     pin->SetBoolean("b_cleanup", "on", use_b_cleanup);
     auto t_b_cleanup = t_none;
     if (use_b_cleanup) {
-        t_b_cleanup = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, B_Cleanup::Initialize, pin.get());
+        // Cleanup checks which B field solver it is cleaning for
+        t_b_cleanup = add_package(t_grmhd | t_b_field, B_Cleanup::Initialize);
         if (t_b_field == t_none) t_b_field = t_b_cleanup;
     }
 
     // Optional standalone packages
     // Electrons are boring but not impossible without a B field (TODO add a test?)
     if (pin->GetOrAddBoolean("electrons", "on", false)) {
-        auto t_electrons = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, Electrons::Initialize, pin.get());
+        auto t_electrons = add_package(t_grmhd, Electrons::Initialize);
     }
     if (pin->GetBoolean("emhd", "on")) { // Set above when deciding to load inverter
-        auto t_emhd = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, EMHD::Initialize, pin.get());
+        auto t_emhd = add_package(t_grmhd, EMHD::Initialize);
     }
     if (pin->GetOrAddBoolean("wind", "on", false)) {
-        auto t_wind = tl.AddTask(t_grmhd, KHARMA::AddPackage, packages, Wind::Initialize, pin.get());
+        auto t_wind = add_package(t_grmhd, Wind::Initialize);
     }
     // Enable calculating jcon iff it is in any list of outputs (and there's even B to calculate it).
     // Since it is never required to restart, this is the only time we'd write (hence, need) it
     if (FieldIsOutput(pin.get(), "jcon") && t_b_field != t_none) {
-        auto t_current = tl.AddTask(t_b_field, KHARMA::AddPackage, packages, Current::Initialize, pin.get());
+        auto t_current = add_package(t_b_field, Current::Initialize);
     }
 
-    // Execute the whole collection (just in case we do something fancy?)
+    // Execute the whole collection, spinning over any packages still initializing on other threads
     while (!tr.Execute()); // TODO this will inf-loop on error
 
     // There are some packages which must be loaded after all physics
@@ -435,6 +633,11 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
     // Flux temporaries must be full size
     KHARMA::AddPackage(packages, Flux::Initialize, pin.get());
 
+    // Internal SMR averages every conserved variable, and checks the Flux & Driver options
+    if (pin->GetOrAddBoolean("ismr", "on", false)) {
+        KHARMA::AddPackage(packages, ISMR::Initialize, pin.get());
+    }
+
     // And any dirichlet/constant boundaries
     // TODO avoid init if Parthenon will be handling all boundaries?
     KHARMA::AddPackage(packages, KBoundaries::Initialize, pin.get());
@@ -447,6 +650,46 @@ Packages_t KHARMA::ProcessPackages(std::unique_ptr<ParameterInput> &pin)
         KHARMA::AddPackage(packages, Implicit::Initialize, pin.get());
     }
 
+    // Multizone freezing checks for every package which evolves variables outside the fluid update
+    if (pin->GetOrAddBoolean("multizone", "on", false)) {
+        KHARMA::AddPackage(packages, Multizone::Initialize, pin.get());
+    }
+
+    // In-situ averages evaluate reduction variables, so need everything above, including Flux
+    if (pin->GetOrAddBoolean("averages", "on", false)) {
+        KHARMA::AddPackage(packages, Averages::Initialize, pin.get());
+    }
+
+    // Tracers record the same variables as the reductions, so also need everything above
+    if (pin->GetOrAddBoolean("tracers", "on", false)) {
+        KHARMA::AddPackage(packages, Tracers::Initialize, pin.get());
+    }
+
+    // Fault detection is raised by the flux & inversion kernels, and checked after every step
+    if (pin->GetOrAddBoolean("fault", "on", false)) {
+        KHARMA::AddPackage(packages, Fault::Initialize, pin.get());
+    }
+
+    // Host diagnostics read only the conserved variables after each step, so can go anywhere after them
+    if (pin->GetOrAddBoolean("host_diagnostics", "on", false)) {
+        KHARMA::AddPackage(packages, HostDiagnostics::Initialize, pin.get());
+    }
+
+    // In-situ analysis is handed the primitives after each step, so can go anywhere after them
+    if (pin->GetOrAddBoolean("insitu", "on", false)) {
+        KHARMA::AddPackage(packages, InSitu::Initialize, pin.get());
+    }
+
+    // Slices are taken of already-computed fields, so can go anywhere after them
+    if (pin->GetOrAddBoolean("slice_output", "on", false)) {
+        KHARMA::AddPackage(packages, SliceOutput::Initialize, pin.get());
+    }
+
+    // Asynchronous snapshots can include derived fields, so go after anything that might fill them
+    if (pin->GetOrAddBoolean("async_output", "on", false)) {
+        KHARMA::AddPackage(packages, AsyncOutput::Initialize, pin.get());
+    }
+
 #if DEBUG
     // Carry the ParameterInput with us, for generating outputs whenever we want
     packages->Get("Globals")->AllParams().Add("pin", pin.get());
@@ -36,6 +36,8 @@
 #include "decs.hpp"
 #include "types.hpp"
 
+#include <future>
+
 /**
  * General preferences for KHARMA.  Anything semi-driver-independent, like loading packages, etc.
  */
@@ -61,6 +63,10 @@ void PreStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
  * Update variables in Globals package based on Parthenon state incl. SimTime struct
  */
 void PostStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+/**
+ * Print any run-wide summaries kept in Globals, currently the region timers
+ */
+void PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
 
 /**
  * Task to add a package.  Lets us queue up all the packages we want in a task list, *then* load them
@@ -70,6 +76,16 @@ TaskStatus AddPackage(std::shared_ptr<Packages_t>& packages,
                       std::function<std::shared_ptr<KHARMAPackage>(ParameterInput*, std::shared_ptr<Packages_t>&)> package_init,
                       ParameterInput *pin);
 
+/**
+ * As AddPackage, but runs the package's Initialize on its own host thread.
+ * The first call launches it against a snapshot of the packages loaded so far (i.e., its dependencies),
+ * returning incomplete until it finishes.  The package is then added from the calling thread,
+ * re-throwing anything thrown during initialization.
+ */
+TaskStatus AddPackageConcurrent(std::shared_ptr<Packages_t>& packages,
+                                std::function<std::shared_ptr<KHARMAPackage>(ParameterInput*, std::shared_ptr<Packages_t>&)> package_init,
+                                ParameterInput *pin, std::shared_ptr<std::future<std::shared_ptr<KHARMAPackage>>> pending);
+
 /**
  * This function messes with all Parthenon's parameters in-place before we hand them to the Mesh,
  * so that KHARMA decks can omit/infer some things parthenon needs.
@@ -78,6 +94,13 @@ TaskStatus AddPackage(std::shared_ptr<Packages_t>& packages,
  */
 void FixParameters(ParameterInput *pin, bool is_parthenon_restart);
 
+/**
+ * Generate Parthenon static refinement regions from physical targets, blocks <smr/target0>, <smr/target1>...
+ * Each refines to `level` the radii r_min to r_max, optionally only within theta_j of either pole.
+ * Called at the end of FixParameters, as it needs the final mesh bounds.
+ */
+void GenerateStaticRefinement(ParameterInput *pin);
+
 /**
  * Load any packages specified in the input parameters
  */
@@ -33,6 +33,8 @@
  */
 #include "kharma_package.hpp"
 
+#include "grmhd.hpp"
+#include "inverter.hpp"
 #include "types.hpp"
 
 // TODO clearly this needs a better concept of ordering.
@@ -90,10 +92,33 @@ TaskStatus Packages::BlockUtoP(MeshBlockData<Real> *rc, IndexDomain domain, bool
 }
 TaskStatus Packages::MeshUtoP(MeshData<Real> *md, IndexDomain domain, bool coarse)
 {
-    // TODO TODO prefer MeshUtoP implementations and fall back
+    // Prefer MeshUtoP implementations, falling back to BlockUtoP over each block.
+    // Packages are applied in the same order as BlockUtoP, each over all blocks in turn
     Flag("MeshUtoP");
-    for (int i=0; i < md->NumBlocks(); ++i)
-        BlockUtoP(md->GetBlockData(i).get(), domain, coarse);
+    GRMHD::InvalidateFourVectors(md);
+    auto kpackages = md->GetMeshPointer()->packages.AllPackagesOfType<KHARMAPackage>();
+    // Advected scalars are recovered within the Inverter's kernel, if it runs
+    const bool scalars_inverted = Inverter::ConvertsAdvectedScalars(md->GetMeshPointer()->packages, coarse);
+    auto apply = [&](const std::string& name, KHARMAPackage *pkpackage) {
+        if (scalars_inverted && pkpackage->AdvectedScalars) return;
+        if (pkpackage->MeshUtoP != nullptr) {
+            Flag("MeshUtoP_"+name);
+            pkpackage->MeshUtoP(md, domain, coarse);
+            EndFlag();
+        } else if (pkpackage->BlockUtoP != nullptr) {
+            Flag("BlockUtoP_"+name);
+            for (int i=0; i < md->NumBlocks(); ++i)
+                pkpackage->BlockUtoP(md->GetBlockData(i).get(), domain, coarse);
+            EndFlag();
+        }
+    };
+    // B_CT first, then GRMHD, then everything else, see BlockUtoP
+    if (kpackages.count("B_CT")) apply("B_CT", kpackages.at("B_CT"));
+    if (kpackages.count("Inverter")) apply("Inverter", kpackages.at("Inverter"));
+    for (auto kpackage : kpackages) {
+        if (kpackage.first != "B_CT" && kpackage.first != "Inverter")
+            apply(kpackage.first, kpackage.second);
+    }
     EndFlag();
     return TaskStatus::complete;
 }
@@ -169,12 +194,19 @@ TaskStatus Packages::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexD
         }
     }
     for (auto kpackage : kpackages) {
-        if (kpackage.second->AddSource != nullptr && kpackage.first != "Boundaries") {
+        if (kpackage.second->AddSource != nullptr && !kpackage.second->fused_source &&
+            kpackage.first != "Boundaries" && kpackage.first != "Multizone") {
             Flag("AddSource_"+kpackage.first);
             kpackage.second->AddSource(md, mdudt, domain);
             EndFlag();
         }
     }
+    // Multizone freezes the update outside the active annulus, so it must come after every other source
+    if (kpackages.count("Multizone")) {
+        Flag("AddSource_Multizone");
+        pmesh->packages.Get<KHARMAPackage>("Multizone")->AddSource(md, mdudt, domain);
+        EndFlag();
+    }
     EndFlag();
     return TaskStatus::complete;
 }
@@ -182,6 +214,7 @@ TaskStatus Packages::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexD
 TaskStatus Packages::MeshApplyPrimSource(MeshData<Real> *md)
 {
     Flag("MeshApplyPrimSource");
+    GRMHD::InvalidateFourVectors(md);
     for (int i=0; i < md->NumBlocks(); ++i) {
         auto rc = md->GetBlockData(i).get();
         auto kpackages = rc->GetBlockPointer()->packages.AllPackagesOfType<KHARMAPackage>();
@@ -198,6 +231,7 @@ TaskStatus Packages::MeshApplyPrimSource(MeshData<Real> *md)
 TaskStatus Packages::MeshApplyFloors(MeshData<Real> *md, IndexDomain domain)
 {
     Flag("MeshApplyFloors");
+    GRMHD::InvalidateFourVectors(md);
 
     // Apply the version from "Floors" package first
     auto pmesh = md->GetMeshPointer();
@@ -210,19 +244,19 @@ TaskStatus Packages::MeshApplyFloors(MeshData<Real> *md, IndexDomain domain)
             EndFlag();
         }
     }
-    // Then everything else i.e. block versions
-    // TODO(BSP) allow Mesh versions and fallback
-    for (int i=0; i < md->NumBlocks(); ++i) {
-        auto mbd = md->GetBlockData(i).get();
-        auto pmb = mbd->GetBlockPointer();
-        auto kpackages = pmb->packages.AllPackagesOfType<KHARMAPackage>();
-        for (auto kpackage : kpackages) {
-            if (kpackage.first != "Floors") {
-                if (kpackage.second->BlockApplyFloors != nullptr) {
-                    Flag("BlockApplyFloors_"+kpackage.first);
-                    kpackage.second->BlockApplyFloors(mbd, domain);
-                    EndFlag();
-                }
+    // Then everything else, preferring Mesh versions and falling back to BlockApplyFloors over each block
+    auto kpackages = pmesh->packages.AllPackagesOfType<KHARMAPackage>();
+    for (auto kpackage : kpackages) {
+        if (kpackage.first != "Floors") {
+            if (kpackage.second->MeshApplyFloors != nullptr) {
+                Flag("MeshApplyFloors_"+kpackage.first);
+                kpackage.second->MeshApplyFloors(md, domain);
+                EndFlag();
+            } else if (kpackage.second->BlockApplyFloors != nullptr) {
+                Flag("BlockApplyFloors_"+kpackage.first);
+                for (int i=0; i < md->NumBlocks(); ++i)
+                    kpackage.second->BlockApplyFloors(md->GetBlockData(i).get(), domain);
+                EndFlag();
             }
         }
     }
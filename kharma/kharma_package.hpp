@@ -68,6 +68,10 @@ class KHARMAPackage : public StateDescriptor {
         // On domain boundaries, however, we sometimes need to respect the primitive variables.
         // Currently only the GRMHD primitives (rho, u, uvec) do this
         std::function<void(MeshBlockData<Real>*, IndexDomain, bool)> DomainBoundaryPtoU = nullptr;
+        // Set if the package's only UtoP is P = U / (rho u^t gdet) on its fields flagged "AdvectedScalar".
+        // Then the Inverter converts them in the main inversion kernel (see Inverter::ConvertsAdvectedScalars),
+        // and Packages::MeshUtoP skips the package's own MeshUtoP/BlockUtoP.  BoundaryUtoP is still called.
+        bool AdvectedScalars = false;
 
         // Going the other way, however, is always handled by Flux::{Block,Mesh}PtoU.
         // All PtoU implementations are device-side (called prim_to_flux),
@@ -76,6 +80,10 @@ class KHARMAPackage : public StateDescriptor {
 
         // Source term to add to the conserved variables during each step
         std::function<void(MeshData<Real>*, MeshData<Real>*, IndexDomain)> AddSource = nullptr;
+        // Set if this package's per-zone source is instead evaluated inside the geometric source kernel
+        // (see Flux::AddGeoSource), in which case Packages::AddSource skips calling AddSource.
+        // Set for Flux itself when the geometric source is added with the divergence (Flux::FluxDivergenceSources)
+        bool fused_source = false;
 
         // Source term to apply to primitive variables, needed for some problems in order
         // to control dissipation (Hubble, turbulence).
@@ -86,6 +94,7 @@ class KHARMAPackage : public StateDescriptor {
         std::function<void(MeshData<Real>*)> FixFlux = nullptr;
 
         // Apply any floors or limiters specific to the package (that is, on the package's variables)
+        // MeshApplyFloors is preferred where both are registered
         std::function<void(MeshBlockData<Real>*, IndexDomain)> BlockApplyFloors = nullptr;
         std::function<void(MeshData<Real>*, IndexDomain)> MeshApplyFloors = nullptr;
 
@@ -35,11 +35,16 @@
 // KHARMA Headers
 #include "decs.hpp"
 
+#include "affinity.hpp"
+#include "benchmark.hpp"
 #include "boundaries.hpp"
+#include "estimate.hpp"
 #include "kharma_driver.hpp"
 #include "kharma.hpp"
+#include "memory_report.hpp"
 #include "post_initialize.hpp"
 #include "problem.hpp"
+#include "ramp.hpp"
 #include "emhd/conducting_atmosphere.hpp"
 #include "version.hpp"
 
@@ -115,6 +120,12 @@ int main(int argc, char *argv[])
     pman.app_input->boundary_conditions[parthenon::BoundaryFace::inner_x3] = KBoundaries::ApplyBoundaryTemplate<IndexDomain::inner_x3>;
     pman.app_input->boundary_conditions[parthenon::BoundaryFace::outer_x3] = KBoundaries::ApplyBoundaryTemplate<IndexDomain::outer_x3>;
 
+    // Choose this rank's device & cores, which must happen before Kokkos or MPI start
+    Affinity::Select();
+
+    // Translate command-line flags Parthenon doesn't know into parameters
+    Estimate::ParseArgs(argc, argv);
+
     // Initialize Parthenon for MPI (also Kokkos, parses command line, etc.)
     Flag("ParthenonInit");
     auto manager_status = pman.ParthenonInitEnv(argc, argv);
@@ -196,6 +207,9 @@ int main(int argc, char *argv[])
             std::cout << "Blocks on rank " << MPIRank() << ": " << pmesh->block_list.size() << "\n" << std::endl;
     }
 
+    // Print where each rank is running, and warn about ranks sharing devices or cores
+    Affinity::Report(verbose);
+
 
     // PostInitialize: Add magnetic field to the problem, initialize ghost zones.
     // Any init which may be run even when restarting, or requires all
@@ -215,29 +229,40 @@ int main(int argc, char *argv[])
     KHARMA::PostInitialize(pin, pmesh, is_restart);
     EndFlag();
 
+    // Report device memory use, and suggest block sizes, if asked
+    MemoryReport::Print(pin, pmesh);
+
     // TODO output parsed parameters *here*, now we have everything including any problem configs for B field
 
-    // Begin code block to ensure driver is cleaned up
-    {
-        if (MPIRank0()) {
-            std::string driver_name = pmesh->packages.Get("Driver")->Param<std::string>("name");
-            std::cout << "Running " << driver_name << " driver" << std::endl;
-        }
+    // Begin code block to ensure driver is cleaned up.  Estimates & benchmark runs replace the driver entirely
+    if (!Estimate::Run(pin, pmesh) && !Benchmark::Run(pin, pmesh)) {
+        // With <ramp>, each resolution is run by its own driver on its own Mesh, see ramp.hpp
+        bool next_stage = true;
+        while (next_stage) {
+            Ramp::StartStage(pin);
+            pmesh = pman.pmesh.get();
+            if (MPIRank0()) {
+                std::string driver_name = pmesh->packages.Get("Driver")->Param<std::string>("name");
+                std::cout << "Running " << driver_name << " driver" << std::endl;
+            }
 
-        // Pull out things we need to give the driver
-        auto pin = pman.pinput.get(); // All parameters in the input file or command line
+            // Pull out things we need to give the driver
+            auto pin = pman.pinput.get(); // All parameters in the input file or command line
 
-        // We now have just one driver package, with different TaskLists for different modes
-        //MPIBarrier();
-        KHARMADriver driver(pin, papp, pmesh);
+            // We now have just one driver package, with different TaskLists for different modes
+            //MPIBarrier();
+            KHARMADriver driver(pin, papp, pmesh);
 
-        // Then execute the driver. This is a Parthenon function inherited by our KHARMADriver object,
-        // which will call MakeTaskCollection, then execute the tasks on the mesh for each portion
-        // of each step until a stop criterion is reached.
-        Flag("driver.Execute");
-        //MPIBarrier();
-        auto driver_status = driver.Execute();
-        EndFlag();
+            // Then execute the driver. This is a Parthenon function inherited by our KHARMADriver object,
+            // which will call MakeTaskCollection, then execute the tasks on the mesh for each portion
+            // of each step until a stop criterion is reached.
+            Flag("driver.Execute");
+            //MPIBarrier();
+            auto driver_status = driver.Execute();
+            EndFlag();
+
+            next_stage = Ramp::NextStage(pman, driver_status, driver.tm);
+        }
     }
 
     // Parthenon cleanup includes Kokkos, MPI
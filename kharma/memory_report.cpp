@@ -0,0 +1,221 @@
+/* 
+ *  File: memory_report.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "memory_report.hpp"
+
+#include "types.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace {
+
+/**
+ * Running byte count, in which each underlying device array is only counted once
+ */
+struct Tally {
+    std::set<const void*> seen;
+    std::map<std::string, size_t> by_package, by_category;
+    size_t total = 0;
+
+    template<typename Arr>
+    size_t Add(const Arr& arr)
+    {
+        if (arr.size() == 0 || seen.count(arr.data())) return 0;
+        seen.insert(arr.data());
+        return arr.size() * sizeof(Real);
+    }
+};
+
+std::string Category(const Metadata& m)
+{
+    if (m.IsSet(Metadata::Face)) return "face";
+    if (m.IsSet(Metadata::Conserved)) return "conserved";
+    if (m.IsSet(Metadata::GetUserFlag("Primitive"))) return "primitive";
+    return "other";
+}
+
+std::string InMB(const double& bytes)
+{
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1) << bytes / (1024. * 1024.) << " MB";
+    return s.str();
+}
+
+/**
+ * Add every field in every container of every block on this rank to fields, and geometry caches to geom.
+ * @return the number of zones on this rank
+ */
+size_t CountFields(Mesh *pmesh, std::map<std::string, std::string>& package_of, Tally& fields, Tally& geom)
+{
+    size_t zones = 0;
+    for (auto &pmb : pmesh->block_list) {
+        const auto& G = pmb->coords;
+        zones += G.n1 * G.n2 * G.n3;
+        for (auto &stage : pmb->meshblock_data.Stages()) {
+            for (auto &var : stage.second->GetVariableVector()) {
+                size_t bytes = fields.Add(var->data);
+                for (int d = X1DIR; d <= X3DIR; ++d) bytes += fields.Add(var->flux[d]);
+                bytes += fields.Add(var->coarse_s);
+                if (bytes == 0) continue;
+                const std::string label = var->label();
+                fields.by_package[package_of.count(label) ? package_of[label] : "(unknown)"] += bytes;
+                fields.by_category[Category(var->metadata())] += bytes;
+                fields.total += bytes;
+            }
+        }
+#if !FAST_CARTESIAN && !NO_CACHE
+        geom.total += geom.Add(G.gcon_direct) + geom.Add(G.gcov_direct) + geom.Add(G.gdet_direct)
+                        + geom.Add(G.conn_direct) + geom.Add(G.gdet_conn_direct);
+#endif
+    }
+    return zones;
+}
+
+} // namespace
+
+void MemoryReport::Print(ParameterInput *pin, Mesh *pmesh)
+{
+    const bool report = pin->GetOrAddBoolean("debug", "memory_report", false);
+    const Real device_gb = pin->GetOrAddReal("debug", "device_memory", 0.);
+    const Real headroom = pin->GetOrAddReal("debug", "memory_headroom", 0.8);
+    if ((!report && device_gb <= 0.) || !MPIRank0() || pmesh->block_list.size() == 0) return;
+
+    // Which package declared each field
+    using FC = Metadata::FlagCollection;
+    std::map<std::string, std::string> package_of;
+    for (auto &pkg : pmesh->packages.AllPackages())
+        for (auto &name : pkg.second->GetVariableNames(FC({Metadata::Cell, Metadata::Face, Metadata::Edge}, true)))
+            package_of[name] = pkg.first;
+
+    // Every field in every container of every block on this rank
+    Tally fields, geom;
+    const size_t zones = CountFields(pmesh, package_of, fields, geom);
+
+    const int nblocks = pmesh->block_list.size();
+    std::cout << "Device memory allocated on rank 0 (" << nblocks << " blocks):" << std::endl;
+    std::cout << "  Fields: " << InMB(fields.total) << ", " << fields.total / zones << " bytes per zone" << std::endl;
+    std::cout << "  By package:" << std::endl;
+    for (auto &p : fields.by_package)
+        std::cout << "    " << std::left << std::setw(16) << p.first << InMB(p.second) << std::endl;
+    std::cout << "  By category:" << std::endl;
+    for (auto &c : fields.by_category)
+        std::cout << "    " << std::left << std::setw(16) << c.first << InMB(c.second) << std::endl;
+    std::cout << "  Geometry caches: " << InMB(geom.total) << std::endl;
+    std::cout << std::right;
+
+    if (device_gb <= 0.) {
+        std::cout << std::endl;
+        return;
+    }
+
+    // Fields scale with the block volume incl. ghosts.  Geometry is cached over (X1, X2) only, and
+    // counted as if unshared, since that's what a block on a fresh device will need
+    const int ng = Globals::nghost;
+    const int ndim = pmesh->ndim;
+    const auto& G0 = pmesh->block_list[0]->coords;
+    const double bytes_per_zone = ((double) fields.total) / zones;
+    double geom_per_face = 0.;
+#if !FAST_CARTESIAN && !NO_CACHE
+    geom_per_face = ((double) (G0.gcon_direct.size() + G0.gcov_direct.size() + G0.gdet_direct.size()
+                               + G0.conn_direct.size() + G0.gdet_conn_direct.size())) * sizeof(Real)
+                    / ((G0.n1 + 1) * (G0.n2 + 1));
+#endif
+    const double budget = device_gb * 1024. * 1024. * 1024. * headroom;
+
+    int nb[3], nx[3];
+    double base_blocks = 1.;
+    for (int d = 0; d < 3; ++d) {
+        const auto dir = static_cast<CoordinateDirection>(d + 1);
+        nb[d] = pmesh->block_list[0]->block_size.nx(dir);
+        nx[d] = pmesh->mesh_size.nx(dir);
+        base_blocks *= nx[d] / nb[d];
+    }
+    // Keep the current ratio of refined blocks to base-level blocks
+    const double refined_ratio = pmesh->nbtotal / base_blocks;
+
+    std::cout << "  Block sizes for " << device_gb << " GB devices, filling " << headroom * 100 << "%:" << std::endl;
+    std::cout << "    " << std::setw(18) << "meshblock" << std::setw(14) << "per block"
+              << std::setw(16) << "blocks/device" << std::setw(14) << "total blocks" << std::setw(10) << "devices" << std::endl;
+    int best[3] = {0, 0, 0};
+    long best_zones = 0;
+    for (int s = -3; s <= 3; ++s) {
+        int nbs[3] = {1, 1, 1};
+        bool valid = true;
+        long block_zones = 1;
+        double total_blocks = refined_ratio;
+        for (int d = 0; d < ndim; ++d) {
+            nbs[d] = (s >= 0) ? nb[d] << s : nb[d] >> -s;
+            if ((s < 0 && nb[d] % (1 << -s)) || nbs[d] < 2*ng || nx[d] % nbs[d]) valid = false;
+            block_zones *= nbs[d];
+            total_blocks *= ((double) nx[d]) / nbs[d];
+        }
+        if (!valid) continue;
+
+        const int n1 = nbs[0] + 2*ng, n2 = (ndim > 1) ? nbs[1] + 2*ng : 1, n3 = (ndim > 2) ? nbs[2] + 2*ng : 1;
+        const double block_bytes = bytes_per_zone * n1 * n2 * n3 + geom_per_face * (n1 + 1) * (n2 + 1);
+        const long fit = (long) (budget / block_bytes);
+        const long need_blocks = (long) std::ceil(total_blocks);
+        const long devices = (fit > 0) ? (need_blocks + fit - 1) / fit : -1;
+
+        std::ostringstream size;
+        size << nbs[0] << "x" << nbs[1] << "x" << nbs[2];
+        std::cout << "    " << std::setw(18) << size.str() << std::setw(14) << InMB(block_bytes)
+                  << std::setw(16) << fit << std::setw(14) << need_blocks << std::setw(10) << devices << std::endl;
+
+        // Suggest the largest block which still gives each of our ranks at least one block
+        if (devices > 0 && devices <= MPINumRanks() && need_blocks >= MPINumRanks() && block_zones > best_zones) {
+            best_zones = block_zones;
+            for (int d = 0; d < 3; ++d) best[d] = nbs[d];
+        }
+    }
+    if (best_zones > 0) {
+        std::cout << "  Largest meshblock fitting " << MPINumRanks() << " devices: "
+                  << best[0] << "x" << best[1] << "x" << best[2] << std::endl;
+    } else {
+        std::cout << "  No listed meshblock size fits this mesh on " << MPINumRanks() << " devices" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+size_t MemoryReport::RankBytes(Mesh *pmesh)
+{
+    std::map<std::string, std::string> package_of;
+    Tally fields, geom;
+    CountFields(pmesh, package_of, fields, geom);
+    return fields.total + geom.total;
+}
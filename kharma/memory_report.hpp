@@ -0,0 +1,64 @@
+/* 
+ *  File: memory_report.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Report of the device memory held by KHARMA's fields, and an advisor for fitting a run to a device.
+ *
+ * With <debug>memory_report = true, prints the bytes allocated on rank 0 at startup, by package and
+ * by field category (primitive, conserved, face, other), counting every container (e.g. the
+ * implicit solver's and the driver's stage copies) and each field's fluxes and coarse buffers.
+ * Arrays shared by several containers or blocks are counted once.  Geometry caches are listed
+ * separately.  Package arrays kept outside of fields (e.g. small lookup tables) are not counted.
+ *
+ * With <debug>device_memory set to a size in GB, additionally prints, for block sizes from 1/8 to 8x
+ * the current meshblock in each direction, how many blocks fit in that memory and how many devices
+ * the whole mesh (at its current refinement) would need.  <debug>memory_headroom sets the fraction
+ * of the device to fill, leaving space for MPI buffers, Kokkos scratch and the like (default 0.8).
+ */
+namespace MemoryReport {
+
+/**
+ * Print the report, if requested.  Call after PostInitialize, once everything has been allocated.
+ */
+void Print(ParameterInput *pin, Mesh *pmesh);
+
+/**
+ * Device memory held by the fields & geometry caches of this rank's blocks, in bytes, counted as for Print
+ */
+size_t RankBytes(Mesh *pmesh);
+
+}
@@ -0,0 +1,240 @@
+/* 
+ *  File: multizone.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "multizone.hpp"
+
+#include "domain.hpp"
+
+#include <limits>
+
+namespace {
+
+/**
+ * Whether radius r lies in any annulus zone, zone + stride, zone + 2*stride, ... evolved concurrently,
+ * or within [r_in, r_out] if annuli are evolved one at a time (stride 0)
+ */
+KOKKOS_INLINE_FUNCTION bool is_active(const GReal& r, const int& zone, const int& stride, const int& nzones,
+                                      const GReal& base, const GReal& r_in, const GReal& r_out)
+{
+    if (stride == 0) return r >= r_in && r <= r_out;
+    for (int z = zone; z < nzones; z += stride) {
+        if ((z == 0 || r >= m::pow(base, z)) && (z == nzones - 1 || r <= m::pow(base, z + 2)))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::shared_ptr<KHARMAPackage> Multizone::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("Multizone");
+    Params &params = pkg->AllParams();
+
+    // Frozen zones must keep their state exactly, so everything evolved must go through the cell-centered update
+    if (packages->AllPackages().count("B_CT") || packages->AllPackages().count("B_CD") ||
+        packages->AllPackages().count("EMHD") || packages->AllPackages().count("Electrons") ||
+        packages->AllPackages().count("Implicit"))
+        throw std::invalid_argument("Multizone runs support only ideal GRMHD, with a flux_ct or no magnetic field!");
+    if (!pin->GetBoolean("coordinates", "spherical"))
+        throw std::invalid_argument("Multizone runs require spherical coordinates!");
+
+    // Annuli: number, base of their radii, and the Bondi radius, past which runtimes stop increasing
+    const int nzones = pin->GetOrAddInteger("multizone", "nzones", 8);
+    if (nzones < 1) throw std::invalid_argument("Multizone runs require multizone/nzones >= 1!");
+    params.Add("nzones", nzones);
+    const GReal base = pin->GetOrAddReal("multizone", "base", 8.);
+    if (base <= 1.) throw std::invalid_argument("Multizone runs require multizone/base > 1!");
+    params.Add("base", base);
+    params.Add("r_b", (GReal) pin->GetOrAddReal("multizone", "r_b", 1.e5));
+    // Fraction of the free-fall-like time to evolve each annulus, e.g. 1/(2 base^(3/2)) with B fields in run.py
+    params.Add("runtime_factor", pin->GetOrAddReal("multizone", "runtime_factor", 1.));
+
+    // Pseudo-timestepping toward a steady state: each zone takes its own Courant-limited step,
+    // but no more than max_dt_factor times the global one
+    params.Add("local_timestep", pin->GetOrAddBoolean("multizone", "local_timestep", false));
+    const Real max_dt_factor = pin->GetOrAddReal("multizone", "max_dt_factor", 100.);
+    if (max_dt_factor < 1.) throw std::invalid_argument("Multizone runs require multizone/max_dt_factor >= 1!");
+    params.Add("max_dt_factor", max_dt_factor);
+
+    // Evolve every third annulus at once, rather than one at a time.  Annuli n and n+3 are separated by
+    // the frozen zones base^(n+2) < r < base^(n+3), which serve as Dirichlet boundaries to both
+    const bool concurrent = pin->GetOrAddBoolean("multizone", "concurrent", false);
+    params.Add("concurrent", concurrent);
+    params.Add("stride", (concurrent && nzones > 1) ? m::min(3, nzones) : 0);
+
+    // The annulus being evolved right now, set in PreStepWork.  Until then, evolve everything
+    params.Add("zone", -1, true);
+    params.Add("r_in", (GReal) 0., true);
+    params.Add("r_out", std::numeric_limits<GReal>::max(), true);
+    params.Add("active_stride", 0, true);
+
+    pkg->PreStepWork = Multizone::PreStepWork;
+    pkg->AddSource = Multizone::FreezeInactive;
+
+    return pkg;
+}
+
+Multizone::Annulus Multizone::ActiveAnnulus(const Params& params, const Real& t)
+{
+    const int nzones = params.Get<int>("nzones");
+    const GReal base = params.Get<GReal>("base");
+    const GReal r_b = params.Get<GReal>("r_b");
+    const Real runtime_factor = params.Get<Real>("runtime_factor");
+    const int stride = params.Get<int>("stride");
+
+    // Zone evolved in the n'th run: inward from the outermost, then back out
+    auto zone_of = [nzones](const long n) {
+        if (nzones == 1) return 0;
+        const int q = n % (2 * (nzones - 1));
+        return (q < nzones - 1) ? nzones - 1 - q : q - (nzones - 1);
+    };
+    auto runtime_of = [&](const int zone) {
+        Real runtime = runtime_factor * m::pow(m::min(m::pow(base, zone + 2), r_b), 1.5);
+        if (zone == 0 || zone == nzones - 1) runtime *= 2;
+        return runtime;
+    };
+
+    auto r_in_of = [&](const int zone) {
+        return (zone == 0) ? 0. : m::pow(base, zone);
+    };
+    auto r_out_of = [&](const int zone) {
+        return (zone == nzones - 1) ? std::numeric_limits<GReal>::max() : m::pow(base, zone + 2);
+    };
+
+    if (stride > 0) {
+        // Concurrent annuli: cycle through the phases, annuli phase, phase + stride, ... each run as
+        // long as its slowest annulus.  r_in, r_out bound all of them, for the timestep: frozen zones
+        // between them are never more restrictive than the innermost active annulus
+        auto phase_runtime = [&](const int phase) {
+            Real runtime = 0.;
+            for (int z = phase; z < nzones; z += stride) runtime = m::max(runtime, runtime_of(z));
+            return runtime;
+        };
+        long n = 0;
+        Real t_end = phase_runtime(0);
+        while (t_end <= t) t_end += phase_runtime(++n % stride);
+
+        const int phase = n % stride;
+        const int last = phase + ((nzones - 1 - phase) / stride) * stride;
+        return Annulus{phase, r_in_of(phase), r_out_of(last), t_end, stride};
+    }
+
+    // Walk the schedule up to t.  Runs are long enough that this is never many
+    long n = 0;
+    Real t_end = runtime_of(zone_of(0));
+    while (t_end <= t) t_end += runtime_of(zone_of(++n));
+
+    const int zone = zone_of(n);
+    return Annulus{zone, r_in_of(zone), r_out_of(zone), t_end, 0};
+}
+
+void Multizone::PreStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    auto& params = pmesh->packages.Get("Multizone")->AllParams();
+    const Annulus ann = ActiveAnnulus(params, tm.time);
+    if (ann.zone != params.Get<int>("zone")) {
+        params.Update<int>("zone", ann.zone);
+        params.Update<GReal>("r_in", ann.r_in);
+        params.Update<GReal>("r_out", ann.r_out);
+        params.Update<int>("active_stride", ann.stride);
+        if (MPIRank0()) {
+            const int nzones = params.Get<int>("nzones");
+            if (ann.stride > 0) {
+                std::cout << "Multizone: evolving zones";
+                for (int z = ann.zone; z < nzones; z += ann.stride) std::cout << " " << z;
+                std::cout << " concurrently";
+            } else {
+                std::cout << "Multizone: evolving zone " << ann.zone << ", r = " << ann.r_in << " to ";
+                if (ann.zone == nzones - 1) std::cout << "the outer edge";
+                else std::cout << ann.r_out;
+            }
+            std::cout << ", until t = " << ann.t_end << std::endl;
+        }
+    }
+}
+
+TaskStatus Multizone::FreezeInactive(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain)
+{
+    auto pmb0 = mdudt->GetBlockData(0)->GetBlockPointer();
+    const auto& params = pmb0->packages.Get("Multizone")->AllParams();
+    const GReal r_in = params.Get<GReal>("r_in");
+    const GReal r_out = params.Get<GReal>("r_out");
+    const int zone = params.Get<int>("zone");
+    const int stride = params.Get<int>("active_stride");
+    const int nzones = params.Get<int>("nzones");
+    const GReal base = params.Get<GReal>("base");
+
+    auto dUdt = mdudt->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell});
+    const IndexRange3 b = KDomain::GetRange(mdudt, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, dUdt.GetDim(5) - 1};
+    const int nvar = dUdt.GetDim(4);
+
+    if (!params.Get<bool>("local_timestep")) {
+        pmb0->par_for("multizone_freeze", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int& bl, const int &k, const int &j, const int &i) {
+                const auto& G = dUdt.GetCoords(bl);
+                const GReal r = G.r(k, j, i);
+                if (!is_active(r, zone, stride, nzones, base, r_in, r_out)) {
+                    for (int v = 0; v < nvar; v++) dUdt(bl, v, k, j, i) = 0.;
+                }
+            }
+        );
+    } else {
+        // Signal speeds from this stage's fluxes, as in GRMHD::EstimateTimestep
+        const auto& cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+        const auto& cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+        const double cfl = pmb0->packages.Get("GRMHD")->Param<double>("cfl");
+        const double dt = pmb0->packages.Get("Globals")->Param<double>("dt_last");
+        const Real max_dt_factor = params.Get<Real>("max_dt_factor");
+        pmb0->par_for("multizone_freeze_local_dt", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+            KOKKOS_LAMBDA (const int& bl, const int &k, const int &j, const int &i) {
+                const auto& G = dUdt.GetCoords(bl);
+                const GReal r = G.r(k, j, i);
+                Real factor = 0.;
+                if (is_active(r, zone, stride, nzones, base, r_in, r_out)) {
+                    const double inv_dt_zone = m::max(cmax(bl, V1, k, j, i), cmin(bl, V1, k, j, i)) / G.Dxc<1>(i) +
+                                               m::max(cmax(bl, V2, k, j, i), cmin(bl, V2, k, j, i)) / G.Dxc<2>(j) +
+                                               m::max(cmax(bl, V3, k, j, i), cmin(bl, V3, k, j, i)) / G.Dxc<3>(k);
+                    // The global step is the minimum of these, so factors are at least 1
+                    factor = (inv_dt_zone > 0.) ? m::min(m::max(cfl / (inv_dt_zone * dt), 1.), (double) max_dt_factor)
+                                                : max_dt_factor;
+                }
+                for (int v = 0; v < nvar; v++) dUdt(bl, v, k, j, i) *= factor;
+            }
+        );
+    }
+
+    return TaskStatus::complete;
+}
@@ -0,0 +1,105 @@
+/* 
+ *  File: multizone.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Multizone evolution within a single run, over one mesh covering all of the zones (annuli).
+ *
+ * Annulus n covers base^n < r < base^(n+2), with the innermost extending to the inner edge of the mesh and the
+ * outermost to the outer edge.  As in scripts/multizone/run.py, annuli are evolved one at a time, stepping
+ * inward from the outermost to the innermost and back out again, each for the free-fall-like time
+ * runtime_factor * min(r_out, r_b)^(3/2), doubled for the innermost and outermost annuli.
+ *
+ * Zones outside the active annulus are frozen by zeroing their conserved-variable updates, and act as
+ * the annulus' Dirichlet boundaries without any copy.  The timestep is set only from the active annulus.
+ * Switching annuli thus needs no restart, file I/O or new geometry; the frozen zones do still
+ * compute fluxes, so the mesh should not extend much beyond the zones.
+ * The schedule is a function of time alone, so it survives restarts.
+ *
+ * With <multizone>local_timestep, runs are for steady states only: each active zone advances by its own
+ * Courant-limited timestep, up to max_dt_factor times the global one, by scaling its update.  Outer zones of
+ * an annulus, limited by much slower signal speeds, then relax as fast (in steps) as the inner.  Steady states
+ * are unchanged, as the update vanishes there regardless of scaling, but the evolution toward them is not
+ * time-accurate, and not conservative.  A single zone, nzones=1, applies this to the whole mesh, e.g. for Bondi.
+ *
+ * With <multizone>concurrent, every third annulus is evolved at once, in three alternating phases each run
+ * as long as its slowest annulus.  The frozen zones between concurrent annuli bound both, so each still sees
+ * fixed Dirichlet boundaries.  With the mesh decomposed in radius, ranks holding different annuli then work
+ * at the same time, rather than idling while one annulus is evolved.  As every annulus shares the timestep of
+ * the innermost, this is best combined with local_timestep.
+ *
+ * Freezing operates on cell-centered conserved variables, so this supports the ideal GRMHD fluid with
+ * a Flux-CT or no magnetic field.  Flux-CT can develop divergence at the annulus edges, as across
+ * the Dirichlet boundaries of restarted multizone runs.
+ */
+namespace Multizone {
+
+/**
+ * An annulus being evolved, and the time until which it is.
+ * With a nonzero stride, annuli zone, zone + stride, ... are evolved together, and r_in, r_out bound them all
+ */
+struct Annulus {
+    int zone;
+    GReal r_in, r_out;
+    Real t_end;
+    int stride;
+};
+
+/**
+ * Initialize the multizone package, with the annuli and how long to evolve each
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Annulus to be evolved at time t
+ */
+Annulus ActiveAnnulus(const Params& params, const Real& t);
+
+/**
+ * Switch the active annulus if its time is up.  Registered as PreStepWork
+ */
+void PreStepWork(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+/**
+ * Zero the update of every conserved variable outside the active annulus, and scale it to each zone's
+ * local timestep inside, if enabled.
+ * Registered as AddSource, and always called after every other package's source terms
+ */
+TaskStatus FreezeInactive(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain);
+
+}
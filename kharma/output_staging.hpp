@@ -0,0 +1,126 @@
+/* 
+ *  File: output_staging.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+#include <map>
+#include <string>
+
+/**
+ * Persistent buffers for staging output data on its way off the device.
+ *
+ * Outputs gather what they write into a device buffer, then copy it to the host.  Both buffers
+ * are kept between dumps under a tag (one per output), growing only when a dump needs more
+ * space, so that dumps don't allocate.  Host buffers are pinned on GPUs, making the copy a DMA.
+ *
+ * When device memory is directly host-accessible (e.g. Kokkos built with CUDA UVM, or HIP on
+ * MI300A with unified memory), there is no host buffer: ToHost returns a view of the device
+ * buffer itself, after a fence.
+ */
+namespace OutputStaging {
+
+#if defined(KOKKOS_ENABLE_CUDA)
+using HostStagingSpace = Kokkos::CudaHostPinnedSpace;
+#elif defined(KOKKOS_ENABLE_HIP)
+using HostStagingSpace = Kokkos::HIPHostPinnedSpace;
+#else
+using HostStagingSpace = Kokkos::HostSpace;
+#endif
+
+// Whether the host can read device allocations directly
+static constexpr bool unified = Kokkos::SpaceAccessibility<Kokkos::HostSpace, DevMemSpace>::accessible;
+
+template<typename T>
+using DeviceView = Kokkos::View<T*, DevMemSpace, Kokkos::MemoryUnmanaged>;
+template<typename T>
+using HostView = Kokkos::View<T*, Kokkos::HostSpace, Kokkos::MemoryUnmanaged>;
+
+template<typename T, typename Space>
+std::map<std::string, Kokkos::View<T*, Space>>& Buffers()
+{
+    static std::map<std::string, Kokkos::View<T*, Space>> buffers;
+    return buffers;
+}
+
+template<typename T, typename Space>
+Kokkos::View<T*, Space>& Reserve(const std::string& tag, const size_t& n)
+{
+    auto& buf = Buffers<T, Space>()[tag];
+    if (buf.extent(0) < n)
+        buf = Kokkos::View<T*, Space>(Kokkos::view_alloc(Kokkos::WithoutInitializing, "staging_" + tag), n);
+    return buf;
+}
+
+/**
+ * Get a device buffer of at least n elements for the output 'tag'.  Its contents are left
+ * over from the last dump.
+ */
+template<typename T>
+DeviceView<T> DeviceBuffer(const std::string& tag, const size_t& n)
+{
+    return DeviceView<T>(Reserve<T, DevMemSpace>(tag, m::max(n, (size_t) 1)).data(), n);
+}
+
+/**
+ * Make the first n elements of the device buffer for 'tag' readable from the host.
+ * The result remains valid until the next call with the same tag.
+ */
+template<typename T>
+HostView<T> ToHost(const std::string& tag, const size_t& n)
+{
+    const auto& dev = Reserve<T, DevMemSpace>(tag, m::max(n, (size_t) 1));
+    if constexpr (unified) {
+        Kokkos::fence();
+        return HostView<T>(dev.data(), n);
+    } else {
+        const auto& host = Reserve<T, HostStagingSpace>(tag, m::max(n, (size_t) 1));
+        Kokkos::deep_copy(Kokkos::subview(host, std::make_pair((size_t) 0, n)),
+                          Kokkos::subview(dev, std::make_pair((size_t) 0, n)));
+        return HostView<T>(host.data(), n);
+    }
+}
+
+/**
+ * Free all staging buffers.  Must be called before Kokkos is finalized
+ */
+inline void Release()
+{
+    Buffers<float, DevMemSpace>().clear();
+    Buffers<double, DevMemSpace>().clear();
+    Buffers<float, HostStagingSpace>().clear();
+    Buffers<double, HostStagingSpace>().clear();
+}
+
+} // namespace OutputStaging
@@ -77,6 +77,61 @@ void AddBondiParameters(ParameterInput *pin, Packages_t &packages)
         packages.Get("GRMHD")->AddParam<Real>("ur_frac", ur_frac);
     if(! (packages.Get("GRMHD")->AllParams().hasKey("uphi")))
         packages.Get("GRMHD")->AddParam<Real>("uphi", uphi);
+
+    // Boundaries are refilled from a table of the solution, covering the domain and its ghost zones with room to spare.
+    // Points outside the table, or all points if bondi/table_n is 0, use the direct solution
+    if(! (packages.Get("GRMHD")->AllParams().hasKey("bondi_table"))) {
+        const int table_n = pin->GetOrAddInteger("bondi", "table_n", 8192);
+        BondiTable table;
+        if (table_n > 1 && pin->DoesParameterExist("coordinates", "r_in") &&
+            pin->DoesParameterExist("coordinates", "r_out")) {
+            const Real gam = packages.Get("GRMHD")->Param<Real>("gamma");
+            const GReal r_min = 0.5 * m::min(rin_bondi, pin->GetReal("coordinates", "r_in"));
+            const GReal r_max = 2. * pin->GetReal("coordinates", "r_out");
+            table = BuildBondiTable(rs, mdot, gam, r_min, r_max, table_n);
+        }
+        packages.Get("GRMHD")->AddParam<BondiTable>("bondi_table", table);
+    }
+}
+
+BondiTable BuildBondiTable(const Real rs, const Real mdot, const Real gam, const GReal r_min, const GReal r_max, const int n)
+{
+    BondiTable table;
+    GridScalar r("bondi_table_r", n), rho("bondi_table_rho", n), u("bondi_table_u", n), ur("bondi_table_ur", n);
+    auto r_host = r.GetHostMirror();
+    auto rho_host = rho.GetHostMirror();
+    auto u_host = u.GetHostMirror();
+    auto ur_host = ur.GetHostMirror();
+    const GReal dlr = m::log(r_max / r_min) / (n - 1);
+    for (int i = 0; i < n; i++) {
+        // Pin the endpoints, so lookups at the very edges don't fall just outside from roundoff
+        const GReal r_i = (i == n-1) ? r_max : r_min * m::exp(i * dlr);
+        Real rho_i, u_i, ur_i;
+        get_bondi_soln(r_i, rs, mdot, gam, rho_i, u_i, ur_i);
+        // get_T returns a negative temperature if it can't find the inflowing solution
+        if (!(rho_i > 0.) || !(u_i > 0.)) return BondiTable();
+        r_host(i) = r_i;
+        rho_host(i) = rho_i;
+        u_host(i) = u_i;
+        ur_host(i) = ur_i;
+    }
+    r.DeepCopy(r_host);
+    rho.DeepCopy(rho_host);
+    u.DeepCopy(u_host);
+    ur.DeepCopy(ur_host);
+    table.r = r;
+    table.rho = rho;
+    table.u = u;
+    table.ur = ur;
+    table.n = n;
+
+    // The r^-1 initialization matches to the solution at "infinity", which needs only computing once
+    const Real nn = 1. / (gam - 1.);
+    const Real rb = (m::abs(nn - 1.5) < 0.01) ? rs * rs * 80. / (27. * gam) : (4 * (nn + 1)) / (2 * (nn + 3) - 9) * rs;
+    Real u0, ur0;
+    get_bondi_soln(100 * rb, rs, mdot, gam, table.rho_inf, u0, ur0);
+
+    return table;
 }
 
 /**
@@ -157,6 +212,8 @@ TaskStatus SetBondiImpl(std::shared_ptr<MeshBlockData<Real>>& rc, IndexDomain do
     const bool fill_interior = pmb->packages.Get("GRMHD")->Param<Real>("fill_interior_bondi");
     const bool diffinit = pmb->packages.Get("GRMHD")->Param<Real>("diffinit_bondi");
 
+    const BondiTable table = pmb->packages.Get("GRMHD")->Param<BondiTable>("bondi_table");
+
     const EMHD::EMHD_parameters& emhd_params = EMHD::GetEMHDParameters(pmb->packages);
 
     GRCoordinates G = pmb->coords;
@@ -173,7 +230,7 @@ TaskStatus SetBondiImpl(std::shared_ptr<MeshBlockData<Real>>& rc, IndexDomain do
 
             Real rho, u;
             Real u_prim[NVEC];
-            get_prim_bondi(G, diffinit, rs, mdot, gam, ur_frac, uphi, rin_bondi, fill_interior, rho, u, u_prim, k, j, i);
+            get_prim_bondi(G, diffinit, rs, mdot, gam, ur_frac, uphi, rin_bondi, fill_interior, rho, u, u_prim, k, j, i, table);
 
             // Note that NaN guards, including these, are ignored (!) under -ffast-math flag.
             // Thus we stay away from initializing at EH where this could happen
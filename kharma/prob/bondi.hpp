@@ -42,6 +42,7 @@
 #include "coordinate_utils.hpp"
 #include "types.hpp"
 #include "hdf5_utils.h"
+#include "interpolation.hpp"
 
 #include <parthenon/parthenon.hpp>
 
@@ -144,9 +145,44 @@ KOKKOS_INLINE_FUNCTION void get_bondi_soln(const Real &r, const Real &rs, const
     ur = -C1 / (Tn * r * r);
 }
 
+/**
+ * The Bondi solution tabulated log-uniformly in radius, so that boundary zones can be refilled
+ * by interpolation rather than root-finding.  Built once by BuildBondiTable, see bondi.cpp.
+ * A default-constructed table (n == 0) is empty, and lookups fall back to get_bondi_soln.
+ */
+struct BondiTable {
+    GridScalar r, rho, u, ur;
+    int n = 0;
+    // Density at "infinity" (100 Bondi radii) used by the r^-1 ("diffinit") profile
+    Real rho_inf = 0.;
+};
+
+/**
+ * Build a BondiTable covering [r_min, r_max] with n points, on the host.
+ * Returns an empty table if the solution can't be found anywhere in the range.
+ */
+BondiTable BuildBondiTable(const Real rs, const Real mdot, const Real gam, const GReal r_min, const GReal r_max, const int n);
+
+/**
+ * Bondi solution at a radius, from the table if r is in its range, otherwise computed directly
+ */
+KOKKOS_INLINE_FUNCTION void get_bondi_soln_table(const BondiTable& table, const Real &r, const Real &rs, const Real &mdot,
+                                                 const Real &gam, Real &rho, Real &u, Real &ur)
+{
+    if (table.n > 1 && r >= table.r(0) && r <= table.r(table.n-1)) {
+        int ir; GReal del;
+        Interpolation::Xtoindex_table(r, table.r, table.n, true, ir, del);
+        rho = Interpolation::linear_table(ir, del, table.rho);
+        u = Interpolation::linear_table(ir, del, table.u);
+        ur = Interpolation::linear_table(ir, del, table.ur);
+    } else {
+        get_bondi_soln(r, rs, mdot, gam, rho, u, ur);
+    }
+}
+
 KOKKOS_INLINE_FUNCTION void get_prim_bondi(const GRCoordinates& G, const bool diffinit, const Real &rs, const Real &mdot, const Real &gam,
                                             const Real ur_frac, const Real uphi, const Real rin_bondi, const bool fill_interior, Real &rho, Real &u, Real u_prim[NVEC], 
-                                            const int& k, const int& j, const int& i)
+                                            const int& k, const int& j, const int& i, const BondiTable& table=BondiTable())
 {
     // Get primitive values initialized
     GReal Xnative[GR_DIM], Xembed[GR_DIM];
@@ -173,7 +209,7 @@ KOKKOS_INLINE_FUNCTION void get_prim_bondi(const GRCoordinates& G, const bool di
 
     Real rho_tmp, u_tmp, T_tmp, ur_tmp;
     Real n = 1. / (gam - 1.);
-    get_bondi_soln(r, rs, mdot, gam, rho_tmp, u_tmp, ur_tmp);
+    get_bondi_soln_table(table, r, rs, mdot, gam, rho_tmp, u_tmp, ur_tmp);
     T_tmp = u_tmp / (rho_tmp * n);
 
     Real rb; // Bondi radius
@@ -184,7 +220,11 @@ KOKKOS_INLINE_FUNCTION void get_prim_bondi(const GRCoordinates& G, const bool di
         // values at infinity (obtained by putting r = 100 rb)
         if (m::abs(n - 1.5) < 0.01) rb = rs * rs * 80. / (27. * gam);
         else rb = (4 * (n + 1)) / (2 * (n + 3) - 9) * rs;
-        get_bondi_soln(100 * rb, rs, mdot, gam, rho0, u0, ur0);
+        if (table.n > 1) {
+            rho0 = table.rho_inf;
+        } else {
+            get_bondi_soln(100 * rb, rs, mdot, gam, rho0, u0, ur0);
+        }
 
         // interpolation between inner and outer regimes
         rho = rho0 * (r + rb) / r;
@@ -70,6 +70,9 @@ TaskStatus InitializeDrivenTurbulence(std::shared_ptr<MeshBlockData<Real>>& rc,
         pmb->packages.Get("GRMHD")->AddParam<Real>("lx1", lx1);
     if(! (pmb->packages.Get("GRMHD")->AllParams().hasKey("lx2")))
         pmb->packages.Get("GRMHD")->AddParam<Real>("lx2", lx2);
+    const Real lx3 = x3max-x3min;
+    if(! (pmb->packages.Get("GRMHD")->AllParams().hasKey("lx3")))
+        pmb->packages.Get("GRMHD")->AddParam<Real>("lx3", lx3);
     //adding for later use in create_grf
     if(! (pmb->packages.Get("GRMHD")->AllParams().hasKey("dt_kick")))
         pmb->packages.Get("GRMHD")->AddParam<Real>("dt_kick", dt_kick);
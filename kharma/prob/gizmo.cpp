@@ -103,41 +103,55 @@ TaskStatus SetGIZMO(std::shared_ptr<MeshBlockData<Real>>& rc, IndexDomain domain
     const IndexRange kb = bounds.GetBoundsK(domain);
     
     // GIZMO shell
-    // Read the gizmo data file
-    FILE *fptr = fopen(datfn.c_str(),"r");
-    const int datlen = 100000;
-    Real *rarr = new double[datlen];
-    Real *rhoarr = new double[datlen]; 
-    Real *Tarr = new double[datlen]; 
-    Real *vrarr = new double[datlen]; 
-    Real *Mencarr = new double[datlen]; 
-    int length=0, itemp=0;
-    while (fscanf(fptr,"%lf %lf %lf %lf %lf\n", &(rarr[itemp]), &(rhoarr[itemp]), &(Tarr[itemp]), &(vrarr[itemp]), &(Mencarr[itemp])) == 5) { // assign the read value to variable, and enter it in array
-            itemp++;
-    }
-    fclose(fptr);
-    length = itemp;
-
-    GridVector r_device("r_device", length); 
-    GridVector rho_device("rho_device", length); 
-    GridVector T_device("T_device", length); 
-    GridVector vr_device("vr_device", length); 
-    auto r_host = r_device.GetHostMirror();
-    auto rho_host = rho_device.GetHostMirror();
-    auto T_host = T_device.GetHostMirror();
-    auto vr_host = vr_device.GetHostMirror();
-    for (itemp = 0; itemp < length; itemp++) {
-        r_host(itemp) = rarr[itemp];
-        rho_host(itemp) = rhoarr[itemp];
-        T_host(itemp) = Tarr[itemp];
-        vr_host(itemp) = vrarr[itemp];
+    // Read the gizmo data file once per rank, into device-side tables shared by all blocks
+    auto& grmhd_pars = pmb->packages.Get("GRMHD")->AllParams();
+    if (!grmhd_pars.hasKey("gizmo_r")) {
+        FILE *fptr = fopen(datfn.c_str(),"r");
+        if (fptr == nullptr) throw std::runtime_error("Could not open GIZMO data file "+datfn);
+        std::vector<Real> rarr, rhoarr, Tarr, vrarr;
+        double rtemp, rhotemp, Ttemp, vrtemp, Menctemp;
+        while (fscanf(fptr,"%lf %lf %lf %lf %lf\n", &rtemp, &rhotemp, &Ttemp, &vrtemp, &Menctemp) == 5) {
+            rarr.push_back(rtemp);
+            rhoarr.push_back(rhotemp);
+            Tarr.push_back(Ttemp);
+            vrarr.push_back(vrtemp);
+        }
+        fclose(fptr);
+        const int length = rarr.size();
+        if (length < 2) throw std::runtime_error("GIZMO data file "+datfn+" has fewer than 2 entries!");
+
+        GridScalar r_device("r_device", length);
+        GridScalar rho_device("rho_device", length);
+        GridScalar T_device("T_device", length);
+        GridScalar vr_device("vr_device", length);
+        auto r_host = r_device.GetHostMirror();
+        auto rho_host = rho_device.GetHostMirror();
+        auto T_host = T_device.GetHostMirror();
+        auto vr_host = vr_device.GetHostMirror();
+        for (int itemp = 0; itemp < length; itemp++) {
+            r_host(itemp) = rarr[itemp];
+            rho_host(itemp) = rhoarr[itemp];
+            T_host(itemp) = Tarr[itemp];
+            vr_host(itemp) = vrarr[itemp];
+        }
+        r_device.DeepCopy(r_host);
+        rho_device.DeepCopy(rho_host);
+        T_device.DeepCopy(T_host);
+        vr_device.DeepCopy(vr_host);
+
+        grmhd_pars.Add("gizmo_r", r_device);
+        grmhd_pars.Add("gizmo_rho", rho_device);
+        grmhd_pars.Add("gizmo_T", T_device);
+        grmhd_pars.Add("gizmo_vr", vr_device);
+        // Most profiles are sampled log-uniformly in radius, letting us skip the search
+        grmhd_pars.Add("gizmo_log_uniform", Interpolation::IsLogUniform(rarr));
     }
-    r_device.DeepCopy(r_host);
-    rho_device.DeepCopy(rho_host);
-    T_device.DeepCopy(T_host);
-    vr_device.DeepCopy(vr_host);
-        
-    Kokkos::fence();
+    const auto r_device = grmhd_pars.Get<GridScalar>("gizmo_r");
+    const auto rho_device = grmhd_pars.Get<GridScalar>("gizmo_rho");
+    const auto T_device = grmhd_pars.Get<GridScalar>("gizmo_T");
+    const auto vr_device = grmhd_pars.Get<GridScalar>("gizmo_vr");
+    const bool log_uniform = grmhd_pars.Get<bool>("gizmo_log_uniform");
+    const int length = r_device.GetDim(1);
 
     pmb->par_for("gizmo_shell", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
@@ -145,13 +159,13 @@ TaskStatus SetGIZMO(std::shared_ptr<MeshBlockData<Real>>& rc, IndexDomain domain
             GReal Xshell[GR_DIM] = {0, rin_init, 0, 0};
             int i_sh;
             GReal del_sh;
-            XtoindexGIZMO(Xshell, r_device, length, i_sh, del_sh);
+            XtoindexGIZMO(Xshell, r_device, length, log_uniform, i_sh, del_sh);
             Real vacuum_rho, vacuum_u_over_rho;
-            vacuum_rho = rho_device(i_sh)*(1.-del_sh)+rho_device(i_sh+1)*del_sh;
-            vacuum_u_over_rho = (T_device(i_sh)*(1.-del_sh)+T_device(i_sh+1)*del_sh)/(gam-1.);
+            vacuum_rho = Interpolation::linear_table(i_sh, del_sh, rho_device);
+            vacuum_u_over_rho = Interpolation::linear_table(i_sh, del_sh, T_device)/(gam-1.);
 
-            get_prim_gizmo_shell(G, cs, P, m_p, gam, rin_init, rs, vacuum_rho, vacuum_u_over_rho, 
-                r_device, rho_device, T_device, vr_device, length, k, j, i);
+            get_prim_gizmo_shell(G, cs, P, m_p, gam, rin_init, rs, vacuum_rho, vacuum_u_over_rho,
+                r_device, rho_device, T_device, vr_device, length, log_uniform, k, j, i);
         }
     );
 
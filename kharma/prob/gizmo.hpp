@@ -39,6 +39,7 @@
 #include "gr_coordinates.hpp"
 #include "flux_functions.hpp"
 #include "grmhd_functions.hpp"
+#include "interpolation.hpp"
 #include "pack.hpp"
 #include "coordinate_utils.hpp"
 #include "types.hpp"
@@ -57,30 +58,13 @@ TaskStatus InitializeGIZMO(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterIn
  */
 TaskStatus SetGIZMO(std::shared_ptr<MeshBlockData<Real>>& rc, IndexDomain domain, bool coarse=false);
 
-KOKKOS_INLINE_FUNCTION void XtoindexGIZMO(const GReal XG[GR_DIM],
-                                    const GridScalar& rarr, const int length, int& i, GReal& del)
+/**
+ * Locate a radius in the GIZMO profile, see Interpolation::Xtoindex_table
+ */
+KOKKOS_INLINE_FUNCTION void XtoindexGIZMO(const GReal XG[GR_DIM], const GridScalar& rarr, const int length,
+                                          const bool log_uniform, int& i, GReal& del)
 {
-    Real dx2, dx2_min;
-    dx2_min = m::pow(XG[1]-rarr(0),2); //100000.; //arbitrarily large number
-
-    i = 0; // initialize
-
-    for (int itemp = 0; itemp < length; itemp++) {
-        if (rarr(itemp) < XG[1]) { // only look for smaller side
-            dx2 = m::pow(XG[1] - rarr(itemp), 2);
-
-            // simplest interpolation (Hyerin 07/26/22)
-            if (dx2 < dx2_min){
-                dx2_min = dx2;
-                i = itemp;
-            }
-        }
-    }
-    
-    // interpolation (11/14/2022) TODO: write a case where indices hit the boundaries of the data file
-    del = (XG[1]-rarr(i))/(rarr(i+1)-rarr(i));
-
-    if (m::abs(dx2_min/m::pow(XG[1],2))>1.e-8) printf("XtoindexGizmo: dx2 pretty large = %g at r= %g \n",dx2_min, XG[1]);
+    Interpolation::Xtoindex_table(XG[1], rarr, length, log_uniform, i, del);
 }
 /**
  * Get the GIZMO output values at a particular zone
@@ -89,7 +73,8 @@ KOKKOS_INLINE_FUNCTION void XtoindexGIZMO(const GReal XG[GR_DIM],
 KOKKOS_INLINE_FUNCTION void get_prim_gizmo_shell(const GRCoordinates& G, const CoordinateEmbedding& coords, const VariablePack<Real>& P, const VarMap& m_p,
                                            const Real& gam,
                                            const Real rin_init, const Real rs, Real vacuum_rho, Real vacuum_u_over_rho,
-                                           const GridScalar& rarr, const GridScalar& rhoarr, const GridScalar& Tarr, const GridScalar& vrarr, const int length,
+                                           const GridScalar& rarr, const GridScalar& rhoarr, const GridScalar& Tarr, const GridScalar& vrarr,
+                                           const int length, const bool log_uniform,
                                            const int& k, const int& j, const int& i)
 {
     // Solution constants for velocity prescriptions
@@ -114,12 +99,12 @@ KOKKOS_INLINE_FUNCTION void get_prim_gizmo_shell(const GRCoordinates& G, const C
     } else {
         // linear interpolation
         int itemp; GReal del;
-        XtoindexGIZMO(Xembed, rarr, length, itemp, del);
+        XtoindexGIZMO(Xembed, rarr, length, log_uniform, itemp, del);
         if (del < 0 ) { // when r is smaller than GIZMO's range
             del = 0; // just copy over the smallest r values
         }
-        rho = rhoarr(itemp) * (1.-del) + rhoarr(itemp+1) * del;
-        u = rho * (Tarr(itemp) * (1.-del) + Tarr(itemp+1) * del) / (gam - 1.);
+        rho = Interpolation::linear_table(itemp, del, rhoarr);
+        u = rho * Interpolation::linear_table(itemp, del, Tarr) / (gam - 1.);
         ur = 0.;
     }
     Real ucon_bl[GR_DIM] = {0., ur, 0., 0.};
@@ -46,12 +46,101 @@
 #include "flux.hpp"
 #include "gr_coordinates.hpp"
 #include "grmhd.hpp"
+#include "inverter.hpp"
 #include "kharma.hpp"
 #include "kharma_driver.hpp"
 #include "reductions.hpp"
 #include "seed_B.hpp"
 #include "types.hpp"
 
+// Steps of PostInitialize which aren't already tasks
+namespace {
+
+TaskStatus FreezeDirichletTask(std::shared_ptr<MeshData<Real>> &md)
+{
+    KBoundaries::FreezeDirichlet(md);
+    return TaskStatus::complete;
+}
+
+TaskStatus InsertBlobs(Mesh *pmesh, ParameterInput *pin)
+{
+    for (auto &pmb : pmesh->block_list) {
+        auto rc = pmb->meshblock_data.Get();
+        // This inserts only in vicinity of some global r,th,phi
+        InsertBlob(rc.get(), pin);
+    }
+    return TaskStatus::complete;
+}
+
+TaskStatus RestartFixes(ParameterInput *pin, Mesh *pmesh, MeshData<Real> *md)
+{
+    auto& pkgs = pmesh->packages.AllPackages();
+    // Parthenon restores all parameters (global vars) when restarting,
+    // but KHARMA needs a few (currently one) reset instead
+    KHARMA::ResetGlobals(pin, pmesh);
+
+    // We only record the conserved magnetic field in KHARMA restarts,
+    // but we record primitive field in iharm3d restarts
+    bool iharm3d_restart = pin->GetString("parthenon/job", "problem_id") == "resize_restart";
+    if (!iharm3d_restart && pkgs.at("Driver")->Param<bool>("compact_restart")) {
+        // Compact restarts record only conserved variables: recover all primitives,
+        // and average over any failed inversions
+        Packages::MeshUtoP(md, IndexDomain::entire);
+        if (pkgs.count("Inverter"))
+            Inverter::MeshFixUtoP(md);
+    } else if (!iharm3d_restart) {
+        if (pkgs.count("B_FluxCT")) {
+            B_FluxCT::MeshUtoP(md, IndexDomain::entire);
+        } else if (pkgs.count("B_CT")) {
+            B_CT::MeshUtoP(md, IndexDomain::entire);
+        }
+        if (pkgs.count("EMHD")) {
+            EMHD::MeshUtoP(md, IndexDomain::entire);
+        }
+    } else {
+        if (pkgs.count("B_FluxCT")) {
+            B_FluxCT::MeshPtoU(md, IndexDomain::entire);
+        } else if (pkgs.count("B_CT")) {
+            // This is dangerous: we're interpolating cell-centered data
+            // to faces, even for identical grids.
+            // kharma.cpp always loads B_Cleanup to fix the result
+            B_CT::DangerousPtoU(md, IndexDomain::interior, false);
+        }
+    }
+    return TaskStatus::complete;
+}
+
+TaskStatus ReinitElectrons(MeshData<Real> *md, ParameterInput *pin)
+{
+    if (MPIRank0())
+        std::cout << "Reinitializing electron temperatures!" << std::endl;
+    Electrons::MeshInitElectrons(md, pin);
+    // We probably don't want to do this again next time we restart
+    pin->SetBoolean("electrons", "reinitialize", false);
+    return TaskStatus::complete;
+}
+
+TaskStatus PrintDivB(MeshData<Real> *md)
+{
+    auto& pkgs = md->GetMeshPointer()->packages.AllPackages();
+    if (pkgs.count("B_FluxCT")) {
+        B_FluxCT::PrintGlobalMaxDivB(md);
+    } else if (pkgs.count("B_CT")) {
+        B_CT::PrintGlobalMaxDivB(md);
+    }
+    return TaskStatus::complete;
+}
+
+TaskStatus OutputNow(Mesh *pmesh, ParameterInput *pin)
+{
+    auto tm = SimTime(0., 0., 0, 0, 0, 0, 0.);
+    auto pouts = std::make_unique<Outputs>(pmesh, pin, &tm);
+    pouts->MakeOutputs(pmesh, pin, &tm, SignalHandler::OutputSignal::now);
+    return TaskStatus::complete;
+}
+
+}
+
 void KHARMA::PostInitialize(ParameterInput *pin, Mesh *pmesh, bool is_restart)
 {
     // This call:
@@ -66,128 +155,98 @@ void KHARMA::PostInitialize(ParameterInput *pin, Mesh *pmesh, bool is_restart)
     // If you need Dirichlet boundary conditions, the domain-edge *ghost* zones should also be initialized,
     // as they will be "frozen in" during this function and applied thereafter.
 
+    // All of this is a single list of tasks, run once.  Everything which only modifies physical zones is done
+    // before a single boundary sync, which then serves divB, cleanup and the first step alike.
+    // The only other sync is before seeding B fields, which reads the fluid state in ghost zones.
+    Flag("PostInitialize");
     auto &md = pmesh->mesh_data.Get();
-
     auto& pkgs = pmesh->packages.AllPackages();
-
     auto prob_name = pin->GetString("parthenon/job", "problem_id");
+    const bool use_b_field = pin->GetString("b_field", "solver") != "none";
+
+    TaskID t_none(0);
+    TaskCollection tc;
+    auto tr = tc.AddRegion(1);
+    auto &tl = tr[0];
 
     // Magnetic field operations
-    if (pin->GetString("b_field", "solver") != "none") {
-        // If we need to seed a field based on the problem's fluid initialization...
-        if (pin->GetOrAddString("b_field", "type", "none") != "none" && !is_restart) {
-            // B field init is not stencil-1, needs boundaries sync'd.
-            // FreezeDirichlet ensures any Dirichlet conditions aren't overwritten by zeros
-            KBoundaries::FreezeDirichlet(md);
-            KHARMADriver::SyncAllBounds(md);
-
-            // Then init B field over the mesh...
-            SeedBField(md.get(), pin);
-
-            // If we're doing a torus problem or explicitly ask for it,
-            // normalize the magnetic field according to the max density
-            bool is_torus = prob_name == "torus";
-            if (pin->GetOrAddBoolean("b_field", "norm", is_torus)) {
-                NormalizeBField(md.get(), pin);
-            }
+    auto t_b_field = t_none;
+    if (use_b_field && pin->GetOrAddString("b_field", "type", "none") != "none" && !is_restart) {
+        // B field init is not stencil-1, needs boundaries sync'd.
+        // FreezeDirichlet ensures any Dirichlet conditions aren't overwritten by zeros
+        auto t_freeze = tl.AddTask(t_none, FreezeDirichletTask, md);
+        auto t_sync = KHARMADriver::AddBoundarySync(t_freeze, tl, md);
+
+        // Then init B field over the mesh...
+        t_b_field = tl.AddTask(t_sync, SeedBField, md.get(), pin);
+
+        // If we're doing a torus problem or explicitly ask for it,
+        // normalize the magnetic field according to the max density
+        bool is_torus = prob_name == "torus";
+        if (pin->GetOrAddBoolean("b_field", "norm", is_torus)) {
+            t_b_field = tl.AddTask(t_b_field, NormalizeBField, md.get(), pin);
         }
     }
 
     // Add any hotspots *after* we've seeded fields,
     // since seeding may be based on density
+    auto t_blob = t_b_field;
     if (pin->GetOrAddBoolean("blob", "add_blob", false)) {
-        for (auto &pmb : pmesh->block_list) {
-            auto rc = pmb->meshblock_data.Get();
-            // This inserts only in vicinity of some global r,th,phi
-            InsertBlob(rc.get(), pin);
-        }
+        t_blob = tl.AddTask(t_b_field, InsertBlobs, pmesh, pin);
     }
 
     // Any extra cleanup & init especially when restarting
+    auto t_restart = t_blob;
     if (is_restart) {
-        // Parthenon restores all parameters (global vars) when restarting,
-        // but KHARMA needs a few (currently one) reset instead
-        KHARMA::ResetGlobals(pin, pmesh);
-
-        // We only record the conserved magnetic field in KHARMA restarts,
-        // but we record primitive field in iharm3d restarts
-        bool iharm3d_restart = prob_name == "resize_restart";
-        if (!iharm3d_restart) {
-            if (pkgs.count("B_FluxCT")) {
-                B_FluxCT::MeshUtoP(md.get(), IndexDomain::entire);
-            } else if (pkgs.count("B_CT")) {
-                B_CT::MeshUtoP(md.get(), IndexDomain::entire);
-            }
-            if (pkgs.count("EMHD")) {
-                EMHD::MeshUtoP(md.get(), IndexDomain::entire);
-            }
-        } else {
-            if (pkgs.count("B_FluxCT")) {
-                B_FluxCT::MeshPtoU(md.get(), IndexDomain::entire);
-            } else if (pkgs.count("B_CT")) {
-                // This is dangerous: we're interpolating cell-centered data
-                // to faces, even for identical grids
-                B_CT::DangerousPtoU(md.get(), IndexDomain::interior, false);
-                // TODO always force B field cleanup if we do this
-                // (Generally we're resizing so it gets triggered anyway)
-            }
-        }
+        t_restart = tl.AddTask(t_blob, RestartFixes, pin, pmesh, md.get());
     }
 
-    if (pin->GetString("b_field", "solver") != "none") {
-        // Regardless of how we initialized, if evolving a field we should print max(divB)
-        // divB is not stencil-1, and we may or may not have initialized or read it
-        // Either way, we still need another sync, so it works out
-        KBoundaries::FreezeDirichlet(md);
-        KHARMADriver::SyncAllBounds(md);
+    // The e- initialization is called during problem initialization, but we want an option
+    // to force it -- for example, if restarting an ideal GRMHD run.
+    // It only uses the fluid state, so can come before the field is cleaned
+    auto t_electrons = t_restart;
+    if (pkgs.count("Electrons") && pin->GetOrAddBoolean("electrons", "reinitialize", false)) {
+        t_electrons = tl.AddTask(t_restart, ReinitElectrons, md.get(), pin);
+    }
 
-        if (pkgs.count("B_FluxCT")) {
-            B_FluxCT::PrintGlobalMaxDivB(md.get());
-        } else if (pkgs.count("B_CT")) {
-            B_CT::PrintGlobalMaxDivB(md.get());
-        } else if (pkgs.count("B_CD")) {
-            //B_CD::PrintGlobalMaxDivB(md.get());
-        }
+    // If PtoU was called before the B field was initialized or corrected,
+    // the total energy might be wrong.  Now that we have the field,
+    // wipe away any temporary "totals" which may have omitted it
+    auto t_ptou = tl.AddTask(t_electrons, Flux::MeshPtoU, md.get(), IndexDomain::entire, false);
+
+    // Synchronize boundary values, freezing any Dirichlet physical boundaries as they are now.
+    // This is the first sync if there is no B field
+    auto t_freeze = tl.AddTask(t_ptou, FreezeDirichletTask, md);
+    auto t_sync = KHARMADriver::AddBoundarySync(t_freeze, tl, md);
+
+    // Regardless of how we initialized, if evolving a field we should print max(divB)
+    // divB is not stencil-1, so this needs the sync above
+    auto t_divb = t_sync;
+    if (use_b_field) {
+        t_divb = tl.AddTask(t_sync, PrintDivB, md.get());
     }
 
     // Clean the B field, generally for resizing/restarting
     // We call this function any time the package is loaded:
     // if we decided to load it in kharma.cpp, we need to clean.
     if (pkgs.count("B_Cleanup")) {
-        if (pin->GetOrAddBoolean("b_cleanup", "output_before_cleanup", false)) {
-            auto tm = SimTime(0., 0., 0, 0, 0, 0, 0.);
-            auto pouts = std::make_unique<Outputs>(pmesh, pin, &tm);
-            pouts->MakeOutputs(pmesh, pin, &tm, SignalHandler::OutputSignal::now);
-        }
+        auto t_before = t_divb;
+        if (pin->GetOrAddBoolean("b_cleanup", "output_before_cleanup", false))
+            t_before = tl.AddTask(t_divb, OutputNow, pmesh, pin);
 
-        // Cleanup is applied to conserved variables
-        B_Cleanup::CleanupDivergence(md);
+        // Cleanup is applied to conserved variables, and finishes by syncing them and recovering prims.B
+        auto t_cleanup = tl.AddTask(t_before, B_Cleanup::CleanupDivergence, md);
 
-        if (pin->GetOrAddBoolean("b_cleanup", "output_after_cleanup", false)) {
-            auto tm = SimTime(0., 0., 0, 0, 0, 0, 0.);
-            auto pouts = std::make_unique<Outputs>(pmesh, pin, &tm);
-            pouts->MakeOutputs(pmesh, pin, &tm, SignalHandler::OutputSignal::now);
-        }
+        if (pin->GetOrAddBoolean("b_cleanup", "output_after_cleanup", false))
+            t_cleanup = tl.AddTask(t_cleanup, OutputNow, pmesh, pin);
 
+        // Recover the total energy with the cleaned field.  Ghost zones are already consistent,
+        // so rather than syncing again we need only record any Dirichlet boundaries as they are now
+        auto t_ptou_clean = tl.AddTask(t_cleanup, Flux::MeshPtoU, md.get(), IndexDomain::entire, false);
+        tl.AddTask(t_ptou_clean, FreezeDirichletTask, md);
     }
 
-    // The e- initialization is called during problem initialization, but we want an option
-    // to force it -- for example, if restarting an ideal GRMHD run, 
-    if (pkgs.count("Electrons") && pin->GetOrAddBoolean("electrons", "reinitialize", false)) {
-        std::cout << "Reinitializing electron temperatures!" << std::endl;
-        Electrons::MeshInitElectrons(md.get(), pin);
-        // We probably don't want to do this again next time we restart
-        pin->SetBoolean("electrons", "reinitialize", false);
-    }
+    while (!tr.Execute());
 
-    // If PtoU was called before the B field was initialized or corrected,
-    // the total energy might be wrong.  Now that we have the field,
-    // wipe away any temporary "totals" which may have omitted it
-    Flux::MeshPtoU(md.get(), IndexDomain::entire);
-
-    // Finally, synchronize boundary values.
-    // Freeze any Dirichlet physical boundaries as they are now, after cleanup/sync/etc.
-    KBoundaries::FreezeDirichlet(md);
-    // This is the first sync if there is no B field
-    KHARMADriver::SyncAllBounds(md);
+    EndFlag();
 }
@@ -36,6 +36,7 @@
 
 #include "b_flux_ct.hpp"
 #include "hdf5_utils.h"
+#include "kharma.hpp"
 #include "kharma_utils.hpp"
 #include "interpolation.hpp"
 #include "types.hpp"
@@ -43,6 +44,10 @@
 #include <sys/stat.h>
 #include <ctype.h>
 
+#include <algorithm>
+#include <climits>
+#include <memory>
+
 // TODO: The iharm3d restart format fails to record several things we must guess:
 // 1. Sometimes, even precise domain boundaries in native coordinates
 // 2. Which coordinate system was used
@@ -153,7 +158,11 @@ void ReadIharmRestartHeader(std::string fname, ParameterInput *pin)
     }
 
     // If specified, set *our* grid to exactly match the *file's* grid
-    if (pin->GetOrAddBoolean("resize_restart", "regrid_only", false)) {
+    const bool regrid_only = pin->GetOrAddBoolean("resize_restart", "regrid_only", false);
+    // Record whether the copy will be zone-for-zone exact, i.e. whether it preserves divB.
+    // This requires knowing the file's boundaries, not guessing them
+    pin->SetBoolean("resize_restart", "exact_grid", regrid_only && use_native_bounds);
+    if (regrid_only) {
         // This locks the Parthenon mesh size to be zone-for-zone the same as the iharm3d dump file...
         pin->SetInteger("parthenon/mesh", "nx1", n1file);
         pin->SetInteger("parthenon/mesh", "nx2", n2file);
@@ -230,84 +239,31 @@ void ReadIharmRestartHeader(std::string fname, ParameterInput *pin)
     }
 }
 
-TaskStatus ReadIharmRestart(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterInput *pin)
+/**
+ * Zones of an iharm3d file cached on the device for all MeshBlocks on this rank.
+ * In the "file" mesh we must deal with global file locations (no ghost zones, global index, prefixed "g")
+ * as well as local file locations (locations in this cache, prefixed "m")
+ */
+struct IharmRestartCache {
+    GridScalar p;
+    // Global file index of the cache's first zone.  Can be -1, if that row holds zones wrapped
+    // from the far side of a periodic domain, or left blank
+    int gis, gjs, gks;
+    int nmi, nmj, nmk;
+    int nblocks_done = 0;
+};
+static std::unique_ptr<IharmRestartCache> iharm_cache;
+
+/**
+ * Figure out the subset in global file space needed to fill the physical zones of a MeshBlock
+ */
+void IharmFileRange(MeshBlock *pmb, const bool regrid_only, const GReal startx[GR_DIM], const GReal dx[GR_DIM],
+                    int& gis, int& gjs, int& gks, int& gie, int& gje, int& gke)
 {
-    auto pmb = rc->GetBlockPointer();
-
-    const auto fname = pin->GetString("resize_restart", "fname"); // Require this, don't guess
-    const bool regrid_only = pin->GetOrAddBoolean("resize_restart", "regrid_only", false);
-    const bool is_spherical = pin->GetBoolean("coordinates", "spherical");
-
-    // Size/domain of the file we're reading *from*.
-    const hsize_t nfprim = pin->GetInteger("resize_restart", "nfprim");
-    const hsize_t n1tot = pin->GetInteger("resize_restart", "n1tot");
-    const hsize_t n2tot = pin->GetInteger("resize_restart", "n2tot");
-    const hsize_t n3tot = pin->GetInteger("resize_restart", "n3tot");
-    const GReal startx[GR_DIM] = {0,
-        pin->GetReal("resize_restart", "startx1"),
-        pin->GetReal("resize_restart", "startx2"),
-        pin->GetReal("resize_restart", "startx3")};
-    const GReal stopx[GR_DIM] = {0,
-        pin->GetReal("resize_restart", "stopx1"),
-        pin->GetReal("resize_restart", "stopx2"),
-        pin->GetReal("resize_restart", "stopx3")};
-    const GReal dx[GR_DIM] = {0., (stopx[1] - startx[1])/n1tot,
-                                  (stopx[2] - startx[2])/n2tot,
-                                  (stopx[3] - startx[3])/n3tot};
-
-    // Sanity checks.  Unlikely to fire but nice to have
-    if (regrid_only) {
-        // Check the mesh we're declaring matches
-        if (pin->GetInteger("parthenon/mesh", "nx1") != n1tot ||
-            pin->GetInteger("parthenon/mesh", "nx2") != n2tot ||
-            pin->GetInteger("parthenon/mesh", "nx3") != n3tot) {
-            printf("Mesh size does not match!\n");
-            printf("[%d %d %d] vs [%llu %llu %llu]",
-                pin->GetInteger("parthenon/mesh", "nx1"),
-                pin->GetInteger("parthenon/mesh", "nx2"),
-                pin->GetInteger("parthenon/mesh", "nx3"),
-                n1tot, n2tot, n3tot);
-        }
-
-        if (!close_to(pin->GetReal("parthenon/mesh", "x1min"), startx[1]) ||
-            !close_to(pin->GetReal("parthenon/mesh", "x1max"), stopx[1]) ||
-            !close_to(pin->GetReal("parthenon/mesh", "x2min"), startx[2]) ||
-            !close_to(pin->GetReal("parthenon/mesh", "x2max"), stopx[2]) ||
-            !close_to(pin->GetReal("parthenon/mesh", "x3min"), startx[3]) ||
-            !close_to(pin->GetReal("parthenon/mesh", "x3max"), stopx[3])) {
-            printf("Mesh shape does not match!\n");
-            printf("X1 %g vs %g & %g vs %g\nX2 %g vs %g & %g vs %g\nX3 %g vs %g & %g vs %g",
-                pin->GetReal("parthenon/mesh", "x1min"), startx[1],
-                pin->GetReal("parthenon/mesh", "x1max"), stopx[1],
-                pin->GetReal("parthenon/mesh", "x2min"), startx[2],
-                pin->GetReal("parthenon/mesh", "x2max"), stopx[2],
-                pin->GetReal("parthenon/mesh", "x3min"), startx[3],
-                pin->GetReal("parthenon/mesh", "x3max"), stopx[3]);
-        }
-    }
-
-    if(MPIRank0()) std::cout << "Reading mesh from file to cache..." << std::endl;
-
-    // In this section we're dealing with two different meshes: the one we're interpolating *from* (the "file" grid)
-    // and the one we're interpolating *to* -- the "meshblock."
-    // Additionally, in the "file" mesh we must deail with global file locations (no ghost zones, global index, prefixed "g")
-    // as well as local file locations (locations in a cache we read to host memory, prefixed "m")
-
-    // Size/domain of the MeshBlock we're reading *to*.
-    // Note that we only fill the block's physical zones --
-    // PostInitialize will take care of ghosts with MPI syncs and calls to the domain boundary conditions
-    IndexDomain domain = IndexDomain::interior;
-    const IndexRange ib = pmb->cellbounds.GetBoundsI(domain);
-    const IndexRange jb = pmb->cellbounds.GetBoundsJ(domain);
-    const IndexRange kb = pmb->cellbounds.GetBoundsK(domain);
+    const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+    const IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+    const IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
     const auto& G = pmb->coords;
-
-    // Total file size
-    // TODO separate nmprim to stop at 8 prims if we don't need e-
-    hsize_t fdims[] = {nfprim, n3tot, n2tot, n1tot};
-
-    // Figure out the subset in global space corresponding to our memory cache
-    int gis, gjs, gks, gie, gje, gke;
     if (regrid_only) {
         // For nearest neighbor "interpolation," we don't need any ghost zones
         // Global location of first zone of our new grid
@@ -333,11 +289,67 @@ TaskStatus ReadIharmRestart(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterI
         // Include one extra zone in each direction, for right side of linear interp
         gke += 1; gje += 1; gie += 1;
     }
+}
+
+/**
+ * Number of leading primitives to read from an iharm3d restart, by the variables of the active packages:
+ * the fluid state, then the field only if this run evolves one.
+ * Electron entropies (primitives 8 & 9) are never reused, so they are never read.
+ */
+hsize_t IharmPrimsNeeded(Packages_t *packages)
+{
+    const auto names = KHARMA::GetVariableNames(packages, {Metadata::GetUserFlag("Primitive")});
+    const bool has_B = std::find(names.begin(), names.end(), "prims.B") != names.end();
+    return has_B ? 8 : 5;
+}
+
+/**
+ * Read the file zones covering every MeshBlock on this rank into iharm_cache.
+ * Each rank calls this exactly once, and always makes the same sequence of reads (some of them
+ * empty), so with <resize_restart> parallel_read the file can be opened with MPI-IO and read collectively.
+ */
+void ReadIharmCache(MeshBlock *pmb, ParameterInput *pin, const bool regrid_only,
+                    const GReal startx[GR_DIM], const GReal dx[GR_DIM])
+{
+    const auto fname = pin->GetString("resize_restart", "fname");
+    const bool parallel_read = pin->GetOrAddBoolean("resize_restart", "parallel_read", true);
+    // Chunk cache for chunked/compressed files, large enough to hold every chunk touched by a read
+    const int chunk_cache_mb = pin->GetOrAddInteger("resize_restart", "chunk_cache_mb", 64);
+    const hsize_t nfprim = pin->GetInteger("resize_restart", "nfprim");
+    const hsize_t n1tot = pin->GetInteger("resize_restart", "n1tot");
+    const hsize_t n2tot = pin->GetInteger("resize_restart", "n2tot");
+    const hsize_t n3tot = pin->GetInteger("resize_restart", "n3tot");
+
+    // Only the primitives this run uses are read, as a hyperslab of the first nmprim
+    const hsize_t nmprim = IharmPrimsNeeded(&pmb->packages);
+
+    if(MPIRank0()) std::cout << "Reading " << nmprim << " of " << nfprim << " primitives from file to cache..." << std::endl;
+
+    // Total file size
+    hsize_t fdims[] = {nfprim, n3tot, n2tot, n1tot};
+
+    // Bounding box of the file zones needed by all blocks on this rank, and whether any of them
+    // needs zones wrapped from across a periodic boundary
+    int gis = INT_MAX, gjs = INT_MAX, gks = INT_MAX, gie = INT_MIN, gje = INT_MIN, gke = INT_MIN;
+    bool wrap_x1i = false, wrap_x1o = false, wrap_x2i = false, wrap_x2o = false, wrap_x3i = false, wrap_x3o = false;
+    for (auto &pmb_r : pmb->pmy_mesh->block_list) {
+        int bis, bjs, bks, bie, bje, bke;
+        IharmFileRange(pmb_r.get(), regrid_only, startx, dx, bis, bjs, bks, bie, bje, bke);
+        gis = m::min(gis, bis); gjs = m::min(gjs, bjs); gks = m::min(gks, bks);
+        gie = m::max(gie, bie); gje = m::max(gje, bje); gke = m::max(gke, bke);
+        const auto& bflag = pmb_r->boundary_flag;
+        wrap_x3i |= (bks < 0 && bflag[BoundaryFace::inner_x3] == BoundaryFlag::periodic);
+        wrap_x3o |= (bke > (int) n3tot-1 && bflag[BoundaryFace::outer_x3] == BoundaryFlag::periodic);
+        wrap_x2i |= (bjs < 0 && bflag[BoundaryFace::inner_x2] == BoundaryFlag::periodic);
+        wrap_x2o |= (bje > (int) n2tot-1 && bflag[BoundaryFace::outer_x2] == BoundaryFlag::periodic);
+        wrap_x1i |= (bis < 0 && bflag[BoundaryFace::inner_x1] == BoundaryFlag::periodic);
+        wrap_x1o |= (bie > (int) n1tot-1 && bflag[BoundaryFace::outer_x1] == BoundaryFlag::periodic);
+    }
 
     // Truncate the file read sizes so we don't overrun the file data
     hsize_t fstart[4] = {0, static_max(gks, 0), static_max(gjs, 0), static_max(gis, 0)};
     // Test gXe against last valid index, i.e. nXtot-1
-    hsize_t fstop[4] = {nfprim-1, static_min(gke, n3tot-1), static_min(gje, n2tot-1), static_min(gie, n1tot-1)};
+    hsize_t fstop[4] = {nmprim-1, static_min(gke, n3tot-1), static_min(gje, n2tot-1), static_min(gie, n1tot-1)};
     // We add one here to get sizes from indices
     hsize_t fcount[4] = {fstop[0] - fstart[0] + 1,
                          fstop[1] - fstart[1] + 1,
@@ -348,17 +360,26 @@ TaskStatus ReadIharmRestart(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterI
     // Total memory size is never truncated
     // This calculation produces XxYx2 arrays for 2D sims w/linear interp but that's fine
     hsize_t nmk = gke-gks+1, nmj = gje-gjs+1, nmi = gie-gis+1;
-    hsize_t mdims[4] = {nfprim, nmk, nmj, nmi};
+    hsize_t mdims[4] = {nmprim, nmk, nmj, nmi};
     // TODO these should be const but hdf5_read_array yells about it, fix that
     // TODO should yell if any of these fired for nearest-neighbor
 
-    // Allocate the array we'll need
-    hsize_t nmblock = nmk * nmj * nmi;
-    // TODO this may be float[] if we ever want to read dump files as restarts
-    double *ptmp = new double[nfprim*nmblock];
+    // Allocate the cache on the device, and read into its host mirror, which has the same layout as the file
+    // TODO this may be float if we ever want to read dump files as restarts
+    iharm_cache = std::make_unique<IharmRestartCache>();
+    iharm_cache->p = GridScalar("resize_restart_cache", nmprim, nmk, nmj, nmi);
+    iharm_cache->gis = gis; iharm_cache->gjs = gjs; iharm_cache->gks = gks;
+    iharm_cache->nmi = nmi; iharm_cache->nmj = nmj; iharm_cache->nmk = nmk;
+    auto cache_host = iharm_cache->p.GetHostMirror();
+    double *ptmp = cache_host.data();
 
     // Open the file
-    hdf5_open(fname.c_str());
+    hdf5_set_chunk_cache(((size_t) chunk_cache_mb) * 1024 * 1024);
+    if (parallel_read) {
+        hdf5_open_parallel(fname.c_str());
+    } else {
+        hdf5_open(fname.c_str());
+    }
     hdf5_set_directory("/");
 
     // Read the main array
@@ -366,128 +387,199 @@ TaskStatus ReadIharmRestart(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterI
 
     // Do some special reads from elsewhere in the file to fill periodic bounds
     // Note we do NOT fill outflow/reflecting bounds here -- instead, we treat them specially below
-    // TODO this could probably be a lot cleaner
+    // Every read is made on every rank, with zero size where it isn't needed
     hsize_t fstart_tmp[4], fcount_tmp[4], mstart_tmp[4];
-#define RESET_COUNTS DLOOP1 {fstart_tmp[mu] = fstart[mu]; fcount_tmp[mu] = fcount[mu]; mstart_tmp[mu] = mstart[mu];}
-    if (gks < 0 && pmb->boundary_flag[BoundaryFace::inner_x3] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+#define RESET_COUNTS(needed) DLOOP1 {fstart_tmp[mu] = fstart[mu]; fcount_tmp[mu] = (needed) ? fcount[mu] : 0; mstart_tmp[mu] = mstart[mu];}
+    {
+        RESET_COUNTS(wrap_x3i)
         // same X1/X2, but take only the globally LAST rank in X3
         fstart_tmp[1] = n3tot-1;
-        fcount_tmp[1] = 1;
+        if (wrap_x3i) fcount_tmp[1] = 1;
         // Read it to the FIRST rank of our array
         mstart_tmp[1] = 0;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
-    if (gke > n3tot-1 && pmb->boundary_flag[BoundaryFace::outer_x3] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+    {
+        RESET_COUNTS(wrap_x3o)
         // same X1/X2, but take only the globally FIRST rank in X3
         fstart_tmp[1] = 0;
-        fcount_tmp[1] = 1;
+        if (wrap_x3o) fcount_tmp[1] = 1;
         // Read it to the LAST rank of our array
         mstart_tmp[1] = mdims[1]-1;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
-    if (gjs < 0 && pmb->boundary_flag[BoundaryFace::inner_x2] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+    {
+        RESET_COUNTS(wrap_x2i)
         fstart_tmp[2] = n2tot-1;
-        fcount_tmp[2] = 1;
+        if (wrap_x2i) fcount_tmp[2] = 1;
         mstart_tmp[2] = 0;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
-    if (gje > n2tot-1 && pmb->boundary_flag[BoundaryFace::outer_x2] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+    {
+        RESET_COUNTS(wrap_x2o)
         fstart_tmp[2] = 0;
-        fcount_tmp[2] = 1;
+        if (wrap_x2o) fcount_tmp[2] = 1;
         mstart_tmp[2] = mdims[2]-1;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
-    if (gis < 0 && pmb->boundary_flag[BoundaryFace::inner_x1] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+    {
+        RESET_COUNTS(wrap_x1i)
         fstart_tmp[3] = n1tot-1;
-        fcount_tmp[3] = 1;
+        if (wrap_x1i) fcount_tmp[3] = 1;
         mstart_tmp[3] = 0;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
-    if (gie > n1tot-1 && pmb->boundary_flag[BoundaryFace::outer_x1] == BoundaryFlag::periodic) {
-        RESET_COUNTS
+    {
+        RESET_COUNTS(wrap_x1o)
         fstart_tmp[3] = 0;
-        fcount_tmp[3] = 1;
+        if (wrap_x1o) fcount_tmp[3] = 1;
         mstart_tmp[3] = mdims[3]-1;
         hdf5_read_array(ptmp, "p", 4, fdims, fstart_tmp, fcount_tmp, mdims, mstart_tmp, H5T_IEEE_F64LE);
     }
+#undef RESET_COUNTS
 
     hdf5_close();
 
     if (MPIRank0()) std::cout << "Read!" << std::endl;
 
+    iharm_cache->p.DeepCopy(cache_host);
+}
+
+TaskStatus ReadIharmRestart(std::shared_ptr<MeshBlockData<Real>>& rc, ParameterInput *pin)
+{
+    auto pmb = rc->GetBlockPointer();
+
+    const auto fname = pin->GetString("resize_restart", "fname"); // Require this, don't guess
+    const bool regrid_only = pin->GetOrAddBoolean("resize_restart", "regrid_only", false);
+    const bool is_spherical = pin->GetBoolean("coordinates", "spherical");
+
+    // Size/domain of the file we're reading *from*.
+    const hsize_t nfprim = pin->GetInteger("resize_restart", "nfprim");
+    const hsize_t n1tot = pin->GetInteger("resize_restart", "n1tot");
+    const hsize_t n2tot = pin->GetInteger("resize_restart", "n2tot");
+    const hsize_t n3tot = pin->GetInteger("resize_restart", "n3tot");
+    const GReal startx[GR_DIM] = {0,
+        pin->GetReal("resize_restart", "startx1"),
+        pin->GetReal("resize_restart", "startx2"),
+        pin->GetReal("resize_restart", "startx3")};
+    const GReal stopx[GR_DIM] = {0,
+        pin->GetReal("resize_restart", "stopx1"),
+        pin->GetReal("resize_restart", "stopx2"),
+        pin->GetReal("resize_restart", "stopx3")};
+    const GReal dx[GR_DIM] = {0., (stopx[1] - startx[1])/n1tot,
+                                  (stopx[2] - startx[2])/n2tot,
+                                  (stopx[3] - startx[3])/n3tot};
+
+    // Sanity checks.  Unlikely to fire but nice to have
+    if (regrid_only) {
+        // Check the mesh we're declaring matches
+        if (pin->GetInteger("parthenon/mesh", "nx1") != n1tot ||
+            pin->GetInteger("parthenon/mesh", "nx2") != n2tot ||
+            pin->GetInteger("parthenon/mesh", "nx3") != n3tot) {
+            printf("Mesh size does not match!\n");
+            printf("[%d %d %d] vs [%llu %llu %llu]",
+                pin->GetInteger("parthenon/mesh", "nx1"),
+                pin->GetInteger("parthenon/mesh", "nx2"),
+                pin->GetInteger("parthenon/mesh", "nx3"),
+                n1tot, n2tot, n3tot);
+        }
+
+        if (!close_to(pin->GetReal("parthenon/mesh", "x1min"), startx[1]) ||
+            !close_to(pin->GetReal("parthenon/mesh", "x1max"), stopx[1]) ||
+            !close_to(pin->GetReal("parthenon/mesh", "x2min"), startx[2]) ||
+            !close_to(pin->GetReal("parthenon/mesh", "x2max"), stopx[2]) ||
+            !close_to(pin->GetReal("parthenon/mesh", "x3min"), startx[3]) ||
+            !close_to(pin->GetReal("parthenon/mesh", "x3max"), stopx[3])) {
+            printf("Mesh shape does not match!\n");
+            printf("X1 %g vs %g & %g vs %g\nX2 %g vs %g & %g vs %g\nX3 %g vs %g & %g vs %g",
+                pin->GetReal("parthenon/mesh", "x1min"), startx[1],
+                pin->GetReal("parthenon/mesh", "x1max"), stopx[1],
+                pin->GetReal("parthenon/mesh", "x2min"), startx[2],
+                pin->GetReal("parthenon/mesh", "x2max"), stopx[2],
+                pin->GetReal("parthenon/mesh", "x3min"), startx[3],
+                pin->GetReal("parthenon/mesh", "x3max"), stopx[3]);
+        }
+    }
+
+    // Size/domain of the MeshBlock we're reading *to*.
+    // Note that we only fill the block's physical zones --
+    // PostInitialize will take care of ghosts with MPI syncs and calls to the domain boundary conditions
+    IndexDomain domain = IndexDomain::interior;
+    const IndexRange ib = pmb->cellbounds.GetBoundsI(domain);
+    const IndexRange jb = pmb->cellbounds.GetBoundsJ(domain);
+    const IndexRange kb = pmb->cellbounds.GetBoundsK(domain);
+    const auto& G = pmb->coords;
+
+    // The first block initialized on each rank reads the file zones for all of them
+    if (!iharm_cache) ReadIharmCache(pmb, pin, regrid_only, startx, dx);
+    const GridScalar cache = iharm_cache->p;
+
     // Get the arrays we'll be writing to
     // TODO this is probably easier AND more flexible if we pack them
     GridScalar rho = rc->Get("prims.rho").data;
     GridScalar u = rc->Get("prims.u").data;
     GridVector uvec = rc->Get("prims.uvec").data;
-    GridVector B_P = rc->Get("prims.B").data;
-    auto rho_host = rho.GetHostMirror();
-    auto u_host = u.GetHostMirror();
-    auto uvec_host = uvec.GetHostMirror();
-    auto B_host = B_P.GetHostMirror();
+    // The cache holds the field only if the run has one, see IharmPrimsNeeded
+    const bool include_B = cache.GetDim(4) > 5;
+    GridVector B_P;
+    if (include_B) B_P = rc->Get("prims.B").data;
 
-    // Interpolate on the host side & copy into the mirror Views
+    // Interpolate on the device, directly into the primitives
     // Nearest-neighbor interpolation is currently only used when grids exactly correspond -- otherwise, linear interpolation is used
     // to minimize the resulting B field divergence.
+    const int mis = iharm_cache->gis, mjs = iharm_cache->gjs, mks = iharm_cache->gks;
+    const int n1m = iharm_cache->nmi, n2m = iharm_cache->nmj, n3m = iharm_cache->nmk;
     if (regrid_only) {
-        // TODO Kokkos calls here had problems with CUDA, reintroduce/fix
-        // OpenMP here conflicts with Kokkos parallel in some cases, so we're stuck
-        for (int k=kb.s; k <= kb.e; ++k) for (int j=jb.s; j <= jb.e; ++j) for (int i=ib.s; i <= ib.e; ++i) {
-            GReal X[GR_DIM]; int gk, gj, gi;
-            G.coord(k, j, i, Loci::center, X);
-            Interpolation::Xtoijk_nearest(X, startx, dx, gi, gj, gk);
-            // TODO verify this never reads zones outside the cache
-            // Calculate indices inside our cached block
-            int mk = gk - gks, mj = gj - gjs, mi = gi - gis;
-            // Fill cells of the new block with equivalents in the cached block
-            rho_host(k, j, i) = ptmp[0*nmblock + mk*nmj*nmi + mj*nmi + mi];
-            u_host(k, j, i)   = ptmp[1*nmblock + mk*nmj*nmi + mj*nmi + mi];
-            VLOOP uvec_host(v, k, j, i) = ptmp[(2+v)*nmblock + mk*nmj*nmi + mj*nmi + mi];
-            VLOOP B_host(v, k, j, i) = ptmp[(5+v)*nmblock + mk*nmj*nmi + mj*nmi + mi];
-        }
+        pmb->par_for("resize_restart_nearest", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
+                GReal X[GR_DIM]; int gk, gj, gi;
+                G.coord(k, j, i, Loci::center, X);
+                Interpolation::Xtoijk_nearest(X, startx, dx, gi, gj, gk);
+                // TODO verify this never reads zones outside the cache
+                // Calculate indices inside our cached block
+                const int mk = gk - mks, mj = gj - mjs, mi = gi - mis;
+                // Fill cells of the new block with equivalents in the cached block
+                rho(k, j, i) = cache(0, mk, mj, mi);
+                u(k, j, i)   = cache(1, mk, mj, mi);
+                VLOOP uvec(v, k, j, i) = cache(2+v, mk, mj, mi);
+                if (include_B) VLOOP B_P(v, k, j, i) = cache(5+v, mk, mj, mi);
+            }
+        );
     } else {
         // TODO real boundary flags. Repeat on any outflow/reflecting bounds
         const bool repeat_x1i = is_spherical;
         const bool repeat_x1o = is_spherical;
         const bool repeat_x2i = is_spherical;
         const bool repeat_x2o = is_spherical;
-
-        for (int k=kb.s; k <= kb.e; ++k) for (int j=jb.s; j <= jb.e; ++j) for (int i=ib.s; i <= ib.e; ++i) {
-            GReal X[GR_DIM], del[GR_DIM]; int gk, gj, gi;
-            // Get the zone center location
-            G.coord(k, j, i, Loci::center, X);
-            // Get global indices
-            Interpolation::Xtoijk(X, startx, dx, gi, gj, gk, del);
-            // Make any corrections due to global boundaries
-            // Currently just repeats the last zone, equivalent to falling back to nearest-neighbor
-            if (repeat_x1i && gi < 0) { gi = 0; del[1] = 0; }
-            if (repeat_x1o && gi > n1tot-2) { gi = n1tot - 2; del[1] = 1; }
-            if (repeat_x2i && gj < 0) { gj = 0; del[2] = 0; }
-            if (repeat_x2o && gj > n2tot-2) { gj = n2tot - 2; del[2] = 1; }
-            // Calculate indices inside our cached block
-            int mk = gk - gks, mj = gj - gjs, mi = gi - gis;
-            // Interpolate the value at this location from the cached grid
-            rho_host(k, j, i) = Interpolation::linear(mi, mj, mk, nmi, nmj, nmk, del, &(ptmp[0*nmblock]));
-            u_host(k, j, i) = Interpolation::linear(mi, mj, mk, nmi, nmj, nmk, del, &(ptmp[1*nmblock]));
-            VLOOP uvec_host(v, k, j, i) = Interpolation::linear(mi, mj, mk, nmi, nmj, nmk, del, &(ptmp[(2+v)*nmblock]));
-            VLOOP B_host(v, k, j, i) = Interpolation::linear(mi, mj, mk, nmi, nmj, nmk, del, &(ptmp[(5+v)*nmblock]));
-        }
+        const int n1f = n1tot, n2f = n2tot;
+
+        pmb->par_for("resize_restart_linear", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
+                GReal X[GR_DIM], del[GR_DIM]; int gk, gj, gi;
+                // Get the zone center location
+                G.coord(k, j, i, Loci::center, X);
+                // Get global indices
+                Interpolation::Xtoijk(X, startx, dx, gi, gj, gk, del);
+                // Make any corrections due to global boundaries
+                // Currently just repeats the last zone, equivalent to falling back to nearest-neighbor
+                if (repeat_x1i && gi < 0) { gi = 0; del[1] = 0; }
+                if (repeat_x1o && gi > n1f-2) { gi = n1f - 2; del[1] = 1; }
+                if (repeat_x2i && gj < 0) { gj = 0; del[2] = 0; }
+                if (repeat_x2o && gj > n2f-2) { gj = n2f - 2; del[2] = 1; }
+                // Calculate indices inside our cached block
+                const int mk = gk - mks, mj = gj - mjs, mi = gi - mis;
+                // Interpolate the value at this location from the cached grid
+                rho(k, j, i) = Interpolation::linear(mi, mj, mk, n1m, n2m, n3m, del, &(cache(0, 0, 0, 0)));
+                u(k, j, i) = Interpolation::linear(mi, mj, mk, n1m, n2m, n3m, del, &(cache(1, 0, 0, 0)));
+                VLOOP uvec(v, k, j, i) = Interpolation::linear(mi, mj, mk, n1m, n2m, n3m, del, &(cache(2+v, 0, 0, 0)));
+                if (include_B) VLOOP B_P(v, k, j, i) = Interpolation::linear(mi, mj, mk, n1m, n2m, n3m, del, &(cache(5+v, 0, 0, 0)));
+            }
+        );
     }
-
-    // Deep copy to device
-    rho.DeepCopy(rho_host);
-    u.DeepCopy(u_host);
-    uvec.DeepCopy(uvec_host);
-    B_P.DeepCopy(B_host);
     Kokkos::fence();
 
-    // Delete our cache.  Only we ever used it, so we're safe here.
-    delete[] ptmp;
+    // Free the cache after the last block on this rank
+    if (++iharm_cache->nblocks_done == pmb->pmy_mesh->block_list.size()) iharm_cache.reset();
 
     return TaskStatus::complete;
 }
@@ -35,12 +35,18 @@
 #include "resize_restart_kharma.hpp"
 
 #include "boundaries.hpp"
+#include "domain.hpp"
 #include "hdf5_utils.h"
+#include "kharma.hpp"
 #include "types.hpp"
 
 #include <sys/stat.h>
 #include <ctype.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 // Reads in KHARMA restart file but at a different simulation size
 
 void ReadFillFile(int i, ParameterInput *pin) {
@@ -148,6 +154,174 @@ void ReadKharmaRestartHeader(std::string fname, ParameterInput *pin)
     // File closed here when restartReader falls out of scope
 }
 
+/**
+ * Find the distinct columns of blocks along one direction, identified by their first interior
+ * zone center.  x holds n zone centers per block.  Fills the lower edge of each column,
+ * and returns the column of each block.
+ */
+std::vector<int> RestartColumns(const std::vector<Real>& x, const int nblocks, const int n, const int ng,
+                                std::vector<GReal>& edges)
+{
+    // First & last interior zone centers of each block
+    std::vector<std::pair<GReal, GReal>> cols;
+    for (int b = 0; b < nblocks; ++b) cols.push_back({x[n*b + ng], x[n*b + n - 1 - ng]});
+    std::sort(cols.begin(), cols.end());
+    const auto same = [](const std::pair<GReal, GReal>& p, const std::pair<GReal, GReal>& q) {
+        return m::abs(p.first - q.first) <= 1.e-10 * (m::abs(p.first) + m::abs(q.first) + 1.);
+    };
+    cols.erase(std::unique(cols.begin(), cols.end(), same), cols.end());
+
+    edges.resize(cols.size());
+    edges[0] = std::numeric_limits<GReal>::lowest();
+    for (int c = 1; c < cols.size(); ++c) edges[c] = 0.5 * (cols[c-1].second + cols[c].first);
+
+    std::vector<int> col_of(nblocks);
+    for (int b = 0; b < nblocks; ++b)
+        col_of[b] = std::upper_bound(edges.begin(), edges.end(), x[n*b + ng]) - edges.begin() - 1;
+    return col_of;
+}
+
+/**
+ * Read the blocks of restart file fname which overlap the region Xmin-Xmax, and index them.
+ * Only the zone centers are read for every block of the file: variables are read block-by-block
+ * as hyperslabs, into device arrays covering just the overlapping blocks, which are then sampled
+ * on the device by get_prim_restart_kharma & get_B_restart_kharma.
+ * nghost[1..3] are the ghost zones included in the file in each direction.
+ * Throws if the file blocks do not form a regular grid, e.g. the file was refined.
+ */
+RestartIndex ReadRestartBlocks(const std::string& fname, const hsize_t length[GR_DIM], const int nghost[GR_DIM],
+                               const GReal Xmin[GR_DIM], const GReal Xmax[GR_DIM], const bool linear, const bool include_B,
+                               GridScalar& rho, GridScalar& u, GridVector& uvec, GridVector& B)
+{
+    const int nblocks = length[0];
+    const hsize_t n1 = length[1], n2 = length[2], n3 = length[3];
+
+    hdf5_open(fname.c_str());
+    hdf5_set_directory("/");
+    // Compressed restarts (see scripts/batch/compress_restarts.sh) need their filters to read back
+    if (!hdf5_filters_available("prims.rho") || (include_B && !hdf5_filters_available("cons.B")))
+        throw std::runtime_error("Cannot decompress restart file "+fname+"!");
+
+    // Zone centers of every block
+    std::vector<Real> x1_file(nblocks*n1), x2_file(nblocks*n2), x3_file(nblocks*n3);
+    hsize_t fdims_x1[] = {length[0], n1};
+    hsize_t fdims_x2[] = {length[0], n2};
+    hsize_t fdims_x3[] = {length[0], n3};
+    hsize_t fstart_x[] = {0, 0};
+    hdf5_read_array(x1_file.data(), "VolumeLocations/x", 2, fdims_x1, fstart_x, fdims_x1, fdims_x1, fstart_x, H5T_IEEE_F64LE);
+    hdf5_read_array(x2_file.data(), "VolumeLocations/y", 2, fdims_x2, fstart_x, fdims_x2, fdims_x2, fstart_x, H5T_IEEE_F64LE);
+    hdf5_read_array(x3_file.data(), "VolumeLocations/z", 2, fdims_x3, fstart_x, fdims_x3, fdims_x3, fstart_x, H5T_IEEE_F64LE);
+
+    std::vector<GReal> e1, e2, e3;
+    const auto c1 = RestartColumns(x1_file, nblocks, n1, nghost[1], e1);
+    const auto c2 = RestartColumns(x2_file, nblocks, n2, nghost[2], e2);
+    const auto c3 = RestartColumns(x3_file, nblocks, n3, nghost[3], e3);
+    if (e1.size() * e2.size() * e3.size() != nblocks)
+        throw std::runtime_error("Restart file blocks do not form a regular grid! Resizing refined files is not supported.");
+
+    // Pick out the blocks in the same columns as the region, in each direction.
+    // Lookups clamp to the outermost columns, so selecting with the same rule covers every lookup.
+    const auto column = [](const std::vector<GReal>& e, const GReal X) {
+        return (int) (std::upper_bound(e.begin(), e.end(), X) - e.begin()) - 1;
+    };
+    const int lo1 = column(e1, Xmin[1]), hi1 = column(e1, Xmax[1]);
+    const int lo2 = column(e2, Xmin[2]), hi2 = column(e2, Xmax[2]);
+    const int lo3 = column(e3, Xmin[3]), hi3 = column(e3, Xmax[3]);
+    std::vector<int> blocks;
+    for (int b = 0; b < nblocks; ++b) {
+        if (c1[b] >= lo1 && c1[b] <= hi1 && c2[b] >= lo2 && c2[b] <= hi2 && c3[b] >= lo3 && c3[b] <= hi3)
+            blocks.push_back(b);
+    }
+    const hsize_t nsel = blocks.size();
+
+    // Read the selected blocks, packed in file order, straight into host mirrors of the device arrays.
+    // Scalars have the same layout in memory as in the file, vectors are read a component at a time,
+    // from (block, v, k, j, i) in the file to (v, block, k, j, i) in memory.
+    RestartIndex idx;
+    idx.x1 = GridScalar("restart_x1", nsel, n1);
+    idx.x2 = GridScalar("restart_x2", nsel, n2);
+    idx.x3 = GridScalar("restart_x3", nsel, n3);
+    rho = GridScalar("restart_rho", nsel, n3, n2, n1);
+    u = GridScalar("restart_u", nsel, n3, n2, n1);
+    uvec = GridVector("restart_uvec", NVEC, nsel, n3, n2, n1);
+    if (include_B) B = GridVector("restart_B", NVEC, nsel, n3, n2, n1);
+    auto x1_host = idx.x1.GetHostMirror();
+    auto x2_host = idx.x2.GetHostMirror();
+    auto x3_host = idx.x3.GetHostMirror();
+    auto rho_host = rho.GetHostMirror();
+    auto u_host = u.GetHostMirror();
+    auto uvec_host = uvec.GetHostMirror();
+    auto B_host = B.GetHostMirror();
+
+    hsize_t fdims[] = {length[0], n3, n2, n1};
+    hsize_t fdims_vec[] = {length[0], NVEC, n3, n2, n1};
+    hsize_t fcount[] = {1, n3, n2, n1};
+    hsize_t fcount_vec[] = {1, 1, n3, n2, n1};
+    hsize_t mdims[] = {nsel, n3, n2, n1};
+    hsize_t mdims_vec[] = {NVEC, nsel, n3, n2, n1};
+    for (hsize_t s = 0; s < nsel; ++s) {
+        const hsize_t b = blocks[s];
+        hsize_t fstart[] = {b, 0, 0, 0};
+        hsize_t mstart[] = {s, 0, 0, 0};
+        hdf5_read_array(rho_host.data(), "prims.rho", 4, fdims, fstart, fcount, mdims, mstart, H5T_IEEE_F64LE);
+        hdf5_read_array(u_host.data(), "prims.u", 4, fdims, fstart, fcount, mdims, mstart, H5T_IEEE_F64LE);
+        for (hsize_t v = 0; v < NVEC; ++v) {
+            hsize_t fstart_vec[] = {b, v, 0, 0, 0};
+            hsize_t mstart_vec[] = {v, s, 0, 0, 0};
+            hdf5_read_array(uvec_host.data(), "prims.uvec", 5, fdims_vec, fstart_vec, fcount_vec, mdims_vec, mstart_vec, H5T_IEEE_F64LE);
+            if (include_B)
+                hdf5_read_array(B_host.data(), "cons.B", 5, fdims_vec, fstart_vec, fcount_vec, mdims_vec, mstart_vec, H5T_IEEE_F64LE);
+        }
+
+        for (int itemp = 0; itemp < n1; itemp++) x1_host(s, itemp) = x1_file[n1*b + itemp];
+        for (int jtemp = 0; jtemp < n2; jtemp++) x2_host(s, jtemp) = x2_file[n2*b + jtemp];
+        for (int ktemp = 0; ktemp < n3; ktemp++) x3_host(s, ktemp) = x3_file[n3*b + ktemp];
+    }
+    hdf5_close();
+
+    idx.x1.DeepCopy(x1_host);
+    idx.x2.DeepCopy(x2_host);
+    idx.x3.DeepCopy(x3_host);
+    rho.DeepCopy(rho_host);
+    u.DeepCopy(u_host);
+    uvec.DeepCopy(uvec_host);
+    if (include_B) B.DeepCopy(B_host);
+
+    idx.nb1 = e1.size();
+    idx.nb2 = e2.size();
+    idx.nb3 = e3.size();
+    idx.n1 = n1;
+    idx.n2 = n2;
+    idx.n3 = n3;
+    idx.linear = linear;
+
+    // Map positions in the block grid to the blocks we read. Positions outside the region stay -1
+    idx.block = ParArray3D<int>("restart_block_index", idx.nb3, idx.nb2, idx.nb1);
+    auto block_h = Kokkos::create_mirror_view(idx.block);
+    Kokkos::deep_copy(block_h, -1);
+    for (int b = 0; b < nblocks; ++b) {
+        if (block_h(c3[b], c2[b], c1[b]) == -2)
+            throw std::runtime_error("Restart file blocks overlap! Resizing refined files is not supported.");
+        block_h(c3[b], c2[b], c1[b]) = -2;
+    }
+    Kokkos::deep_copy(block_h, -1);
+    for (int s = 0; s < nsel; ++s) block_h(c3[blocks[s]], c2[blocks[s]], c1[blocks[s]]) = s;
+    Kokkos::deep_copy(idx.block, block_h);
+
+    const auto copy_edges = [](const std::vector<GReal>& e, const std::string& label) {
+        ParArray1D<GReal> edges(label, e.size());
+        auto edges_h = Kokkos::create_mirror_view(edges);
+        for (int c = 0; c < e.size(); ++c) edges_h(c) = e[c];
+        Kokkos::deep_copy(edges, edges_h);
+        return edges;
+    };
+    idx.edge1 = copy_edges(e1, "restart_edge1");
+    idx.edge2 = copy_edges(e2, "restart_edge2");
+    idx.edge3 = copy_edges(e3, "restart_edge3");
+
+    return idx;
+}
+
 TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterInput *pin)
 {
     auto pmb = rc->GetBlockPointer();
@@ -173,6 +347,13 @@ TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterI
     int verbose = pin->GetOrAddInteger("debug", "verbose", 0);
     const Real ur_frac = pin->GetOrAddReal("bondi", "ur_frac", 1.); 
     const Real uphi = pin->GetOrAddReal("bondi", "uphi", 0.); 
+    // Sample the file at the nearest zone, or interpolate trilinearly between zones
+    const std::string interpolation = pin->GetOrAddString("resize_restart", "interpolation", "nearest");
+    if (interpolation != "nearest" && interpolation != "linear")
+        throw std::invalid_argument("Unknown resize_restart interpolation "+interpolation+"! Use nearest or linear.");
+    const bool linear = (interpolation == "linear");
+    // Chunk cache for chunked/compressed files, large enough to hold every chunk touched by a read
+    const int chunk_cache_mb = pin->GetOrAddInteger("resize_restart", "chunk_cache_mb", 64);
 
     // Derived parameters
     hsize_t nBlocks = (int) (n1tot*n2tot*n3tot)/(n1mb*n2mb*n3mb);
@@ -182,7 +363,10 @@ TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterI
     int fnghost = pin->GetReal("parthenon/mesh", "restart_nghost");
     const Real fx1min_ghost = fx1min - fnghost*dx1;
     const Real fx1max_ghost = fx1max + fnghost*dx1;
-    const bool include_B = (b_field_type != "none");
+    // Read cons.B only if the active packages will take it, i.e. the Flux-CT field declared B_Save
+    const auto cell_vars = KHARMA::GetVariableNames(&pmb->packages, {Metadata::Cell});
+    const bool include_B = (b_field_type != "none") &&
+                           std::find(cell_vars.begin(), cell_vars.end(), "B_Save") != cell_vars.end();
     // A placeholder to save the B fields for SeedBField
     GridVector B_Save;
     if (include_B) B_Save = rc->Get("B_Save").data;
@@ -202,190 +386,34 @@ TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterI
                                 f_n1mb+2*fnghost,
                                 n2mb+2*fnghost,
                                 n3mb+2*fnghost*x3factor}; 
-    const int block_sz = length[0]*length[1]*length[2]*length[3];
-    const int f_block_sz = f_length[0]*f_length[1]*f_length[2]*f_length[3];
-
     if (MPIRank0() && verbose > 0) {
         std::cout << "Reading mesh size " << n1tot << "x" << n2tot << "x" << n3tot <<
                         " block size " << n1mb << "x" << n2mb << "x" << n3mb << std::endl;
         std::cout << "Reading " << length[0] << " meshblocks of total size " <<
                      length[1] << "x" <<  length[2]<< "x" << length[3] << std::endl;
     }
-    
-    
-    // read from file and stored in device Hyerin (10/18/2022)
-    GridScalar x1_f_device("x1_f_device", length[0], length[1]); 
-    GridScalar x2_f_device("x2_f_device", length[0], length[2]); 
-    GridScalar x3_f_device("x3_f_device", length[0], length[3]); 
-    GridScalar rho_f_device("rho_f_device", length[0], length[3], length[2], length[1]); 
-    GridScalar u_f_device("u_f_device", length[0], length[3], length[2], length[1]); 
-    GridVector uvec_f_device("uvec_f_device", NVEC, length[0], length[3], length[2], length[1]); 
-    GridVector B_f_device("B_f_device", NVEC, length[0], length[3], length[2], length[1]);
-    auto x1_f_host = x1_f_device.GetHostMirror();
-    auto x2_f_host = x2_f_device.GetHostMirror();
-    auto x3_f_host = x3_f_device.GetHostMirror();
-    auto rho_f_host = rho_f_device.GetHostMirror();
-    auto u_f_host = u_f_device.GetHostMirror();
-    auto uvec_f_host = uvec_f_device.GetHostMirror();
-    auto B_f_host = B_f_device.GetHostMirror();
-    // Hyerin (09/19/2022) : new attempt to read the file 
-    hdf5_open(fname.c_str());
-    hdf5_set_directory("/");
-    Real *rho_file = new double[block_sz];
-    Real *u_file = new double[block_sz];
-    Real *uvec_file = new double[NVEC*block_sz];
-    Real *B_file = new double[NVEC*block_sz];
-    Real *x1_file = new double[length[0]*length[1]];
-    Real *x2_file = new double[length[0]*length[2]];
-    Real *x3_file = new double[length[0]*length[3]];
-    //static hsize_t fdims[] = {length[0], 1, length[3], length[2], length[1],1}; //outdated
-    static hsize_t fdims[] = {length[0], length[3], length[2], length[1]};
-    //static hsize_t fdims_vec[] = {length[0], length[3], length[2], length[1],3}; //outdated
-    static hsize_t fdims_vec[] = {length[0], NVEC, length[3], length[2], length[1]};
-    static hsize_t fdims_x1[] = {length[0], length[1]};
-    static hsize_t fdims_x2[] = {length[0], length[2]};
-    static hsize_t fdims_x3[] = {length[0], length[3]};
-    hsize_t fstart[] = {0, 0, 0, 0};
-    hsize_t fstart_vec[] = {0, 0, 0, 0, 0};
-    hsize_t fstart_x[] = {0, 0};
-    hdf5_read_array(rho_file, "prims.rho", 4, fdims, fstart, fdims, fdims, fstart, H5T_IEEE_F64LE);
-    hdf5_read_array(u_file, "prims.u", 4, fdims, fstart, fdims, fdims, fstart, H5T_IEEE_F64LE);
-    hdf5_read_array(uvec_file, "prims.uvec", 5, fdims_vec, fstart_vec, fdims_vec, fdims_vec, fstart_vec, H5T_IEEE_F64LE);
-    //if (include_B) hdf5_read_array(B_file, "prims.B", 5, fdims_vec, fstart_vec, fdims_vec, fdims_vec, fstart_vec, H5T_IEEE_F64LE);
-    if (include_B) hdf5_read_array(B_file, "cons.B", 5, fdims_vec, fstart_vec, fdims_vec, fdims_vec, fstart_vec, H5T_IEEE_F64LE);
-    hdf5_read_array(x1_file, "VolumeLocations/x", 2, fdims_x1, fstart_x, fdims_x1, fdims_x1, fstart_x, H5T_IEEE_F64LE);
-    hdf5_read_array(x2_file, "VolumeLocations/y", 2, fdims_x2, fstart_x, fdims_x2, fdims_x2, fstart_x, H5T_IEEE_F64LE);
-    hdf5_read_array(x3_file, "VolumeLocations/z", 2, fdims_x3, fstart_x, fdims_x3, fdims_x3, fstart_x, H5T_IEEE_F64LE);
-    hdf5_close();
-    
-    GridScalar x1_fill_device("x1_fill_device", f_length[0], f_length[1]); 
-    GridScalar x2_fill_device("x2_fill_device", f_length[0], f_length[2]); 
-    GridScalar x3_fill_device("x3_fill_device", f_length[0], f_length[3]); 
-    GridScalar rho_fill_device("rho_fill_device", f_length[0], f_length[3], f_length[2], f_length[1]); 
-    GridScalar u_fill_device("u_fill_device", f_length[0], f_length[3], f_length[2], f_length[1]); 
-    GridVector uvec_fill_device("uvec_fill_device", NVEC, f_length[0], f_length[3], f_length[2], f_length[1]); 
-    GridVector B_fill_device("B_fill_device", NVEC, f_length[0], f_length[3], f_length[2], f_length[1]); 
-    auto x1_fill_host = x1_fill_device.GetHostMirror();
-    auto x2_fill_host = x2_fill_device.GetHostMirror();
-    auto x3_fill_host = x3_fill_device.GetHostMirror();
-    auto rho_fill_host = rho_fill_device.GetHostMirror();
-    auto u_fill_host = u_fill_device.GetHostMirror();
-    auto uvec_fill_host = uvec_fill_device.GetHostMirror();
-    auto B_fill_host = B_fill_device.GetHostMirror();
-    Real *rho_filefill = new double[f_block_sz];
-    Real *u_filefill = new double[f_block_sz];
-    Real *uvec_filefill = new double[f_block_sz*NVEC];
-    Real *B_filefill = new double[f_block_sz*NVEC];
-    Real *x1_filefill = new double[f_length[0]*f_length[1]];
-    Real *x2_filefill = new double[f_length[0]*f_length[2]];
-    Real *x3_filefill = new double[f_length[0]*f_length[3]];
-    static hsize_t fill_fdims[] = {f_length[0], f_length[3], f_length[2], f_length[1]};
-    static hsize_t fill_fdims_vec[] = {f_length[0], NVEC, f_length[3], f_length[2], f_length[1]};
-    static hsize_t fill_fdims_x1[] = {f_length[0], f_length[1]};
-    static hsize_t fill_fdims_x2[] = {f_length[0], f_length[2]};
-    static hsize_t fill_fdims_x3[] = {f_length[0], f_length[3]};
-    if (should_fill) { 
-        hdf5_open(fname_fill.c_str());
-        hdf5_set_directory("/");
-        hdf5_read_array(rho_filefill, "prims.rho", 4, fill_fdims, fstart, fill_fdims, fill_fdims, fstart, H5T_IEEE_F64LE);
-        hdf5_read_array(u_filefill, "prims.u", 4, fill_fdims, fstart, fill_fdims, fill_fdims, fstart, H5T_IEEE_F64LE);
-        hdf5_read_array(uvec_filefill, "prims.uvec", 5, fill_fdims_vec, fstart_vec, fill_fdims_vec, fill_fdims_vec, fstart_vec, H5T_IEEE_F64LE);
-        if (include_B) hdf5_read_array(B_filefill, "cons.B", 5, fill_fdims_vec, fstart_vec, fill_fdims_vec, fill_fdims_vec, fstart_vec,H5T_IEEE_F64LE);
-        hdf5_read_array(x1_filefill, "VolumeLocations/x", 2, fill_fdims_x1, fstart_x, fill_fdims_x1, fill_fdims_x1, fstart_x, H5T_IEEE_F64LE);
-        hdf5_read_array(x2_filefill, "VolumeLocations/y", 2, fill_fdims_x2, fstart_x, fill_fdims_x2, fill_fdims_x2, fstart_x, H5T_IEEE_F64LE);
-        hdf5_read_array(x3_filefill, "VolumeLocations/z", 2, fill_fdims_x3, fstart_x, fill_fdims_x3, fill_fdims_x3, fstart_x, H5T_IEEE_F64LE);
-        hdf5_close();
-    }
-
-    // save the grid coordinate values to host array
-    for (int iblocktemp = 0; iblocktemp < length[0]; iblocktemp++) {
-        for (int itemp = 0; itemp < length[1]; itemp++) {
-            x1_f_host(iblocktemp,itemp) = x1_file[length[1]*iblocktemp+itemp];
-        }
-        for (int jtemp = 0; jtemp < length[2]; jtemp++) {
-            x2_f_host(iblocktemp,jtemp) = x2_file[length[2]*iblocktemp+jtemp];
-        }
-        for (int ktemp = 0; ktemp < length[3]; ktemp++) {
-            x3_f_host(iblocktemp,ktemp) = x3_file[length[3]*iblocktemp+ktemp];
-        }
-    }
-    // re-arrange uvec such that it can be read in the VLOOP
-    int vector_file_index, scalar_file_index;
-    for (int iblocktemp = 0; iblocktemp < length[0]; iblocktemp++) {
-        for (int itemp = 0; itemp < length[1]; itemp++) {
-            for (int jtemp = 0; jtemp < length[2]; jtemp++) {
-                for (int ktemp = 0; ktemp < length[3]; ktemp++) {
-                    scalar_file_index = length[1]*(length[2]*(length[3]*iblocktemp+ktemp)+jtemp)+itemp;
-
-                    rho_f_host(iblocktemp,ktemp,jtemp,itemp) = rho_file[scalar_file_index];
-                    u_f_host(iblocktemp,ktemp,jtemp,itemp) = u_file[scalar_file_index];
-                    for (int ltemp = 0; ltemp < 3; ltemp++) {
-                        //vector_file_index = 3*(scalar_file_index)+ltemp; // outdated parthenon phdf5 saving order
-                        vector_file_index = length[1]*(length[2]*(length[3]*(NVEC*iblocktemp+ltemp)+ktemp)+jtemp)+itemp;
-                        
-                        uvec_f_host(ltemp,iblocktemp,ktemp,jtemp,itemp) = uvec_file[vector_file_index];
-                        if (include_B) B_f_host(ltemp,iblocktemp,ktemp,jtemp,itemp) = B_file[vector_file_index];
-                    }
-                }
-            }
-        }
-    }
 
-    if (should_fill) {
-        // save the grid coordinate values to host array
-        for (int iblocktemp = 0; iblocktemp < f_length[0]; iblocktemp++) {
-            for (int itemp = 0; itemp < f_length[1]; itemp++) {
-                x1_fill_host(iblocktemp,itemp) = x1_filefill[f_length[1]*iblocktemp+itemp];
-            }
-            for (int jtemp = 0; jtemp < f_length[2]; jtemp++) {
-                x2_fill_host(iblocktemp,jtemp) = x2_filefill[f_length[2]*iblocktemp+jtemp];
-            }
-            for (int ktemp = 0; ktemp < f_length[3]; ktemp++) {
-                x3_fill_host(iblocktemp,ktemp) = x3_filefill[f_length[3]*iblocktemp+ktemp];
-            }
-        }
-        // re-arrange uvec such that it can be read in the VLOOP
-        for (int iblocktemp = 0; iblocktemp < f_length[0]; iblocktemp++) {
-            for (int itemp = 0; itemp < f_length[1]; itemp++) {
-                for (int jtemp = 0; jtemp < f_length[2]; jtemp++) {
-                    for (int ktemp = 0; ktemp < f_length[3]; ktemp++) {
-                        scalar_file_index = f_length[1]*(f_length[2]*(f_length[3]*iblocktemp+ktemp)+jtemp)+itemp;
-
-                        rho_fill_host(iblocktemp,ktemp,jtemp,itemp) = rho_filefill[scalar_file_index];
-                        u_fill_host(iblocktemp,ktemp,jtemp,itemp) = u_filefill[scalar_file_index];
-                        for (int ltemp = 0; ltemp < 3; ltemp++) {
-                            vector_file_index = f_length[1]*(f_length[2]*(f_length[3]*(NVEC*iblocktemp+ltemp)+ktemp)+jtemp)+itemp;
-                            
-                            uvec_fill_host(ltemp,iblocktemp,ktemp,jtemp,itemp) = uvec_filefill[vector_file_index];
-                            if (include_B) B_fill_host(ltemp,iblocktemp,ktemp,jtemp,itemp) = B_filefill[vector_file_index];
-                        }
-                    }
-                }
-            }
-        }
-    }
+    // Read only the file blocks overlapping this MeshBlock, including its ghost zones.
+    // Native coordinates increase monotonically along each index, so the corners bound the block
+    const IndexRange3 b = KDomain::GetRange(rc, IndexDomain::entire);
+    GReal Xmin[GR_DIM], Xmax[GR_DIM];
+    G.coord(b.ks, b.js, b.is, Loci::center, Xmin);
+    G.coord(b.ke, b.je, b.ie, Loci::center, Xmax);
+
+    // Ghost zones in x3 are only present in 3D
+    const int nghost_file[GR_DIM] = {0, fnghost, fnghost, fnghost*x3factor};
+    GridScalar rho_f_device, u_f_device, rho_fill_device, u_fill_device;
+    GridVector uvec_f_device, B_f_device, uvec_fill_device, B_fill_device;
+    hdf5_set_chunk_cache(((size_t) chunk_cache_mb) * 1024 * 1024);
+    const RestartIndex idx = ReadRestartBlocks(fname, length, nghost_file, Xmin, Xmax, linear, include_B,
+                                               rho_f_device, u_f_device, uvec_f_device, B_f_device);
+    RestartIndex idx_fill;
+    if (should_fill) idx_fill = ReadRestartBlocks(fname_fill, f_length, nghost_file, Xmin, Xmax, linear, include_B,
+                                                  rho_fill_device, u_fill_device, uvec_fill_device, B_fill_device);
+    Kokkos::fence();
 
     const Real gam = pmb->packages.Get("GRMHD")->Param<Real>("gamma");
 
-    // Deep copy to device
-    x1_f_device.DeepCopy(x1_f_host);
-    x2_f_device.DeepCopy(x2_f_host);
-    x3_f_device.DeepCopy(x3_f_host);
-    rho_f_device.DeepCopy(rho_f_host);
-    u_f_device.DeepCopy(u_f_host);
-    uvec_f_device.DeepCopy(uvec_f_host);
-    if (include_B) B_f_device.DeepCopy(B_f_host);
-    if (fname_fill != "none") {
-        x1_fill_device.DeepCopy(x1_fill_host);
-        x2_fill_device.DeepCopy(x2_fill_host);
-        x3_fill_device.DeepCopy(x3_fill_host);
-        rho_fill_device.DeepCopy(rho_fill_host);
-        u_fill_device.DeepCopy(u_fill_host);
-        uvec_fill_device.DeepCopy(uvec_fill_host);
-        if (include_B) B_fill_device.DeepCopy(B_fill_host);
-    }
-    Kokkos::fence();
-
     PackIndexMap prims_map, cons_map;
     auto P = GRMHD::PackMHDPrims(rc.get(), prims_map);
     auto U = GRMHD::PackMHDCons(rc.get(), cons_map);
@@ -408,14 +436,14 @@ TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterI
     pmb->par_for("copy_restart_state_kharma", ks, ke, js, je, is, ie,
         KOKKOS_LAMBDA (const int &k, const int &j, const int &i) {
             get_prim_restart_kharma(G, P, m_p,
-                fx1min_ghost, fx1max_ghost, should_fill, is_spherical, gam, rs, mdot, ur_frac, uphi, length, f_length,
-                x1_f_device, x2_f_device, x3_f_device, rho_f_device, u_f_device, uvec_f_device,
-                x1_fill_device, x2_fill_device, x3_fill_device, rho_fill_device, u_fill_device, uvec_fill_device,
+                fx1min_ghost, fx1max_ghost, should_fill, is_spherical, gam, rs, mdot, ur_frac, uphi,
+                idx, rho_f_device, u_f_device, uvec_f_device,
+                idx_fill, rho_fill_device, u_fill_device, uvec_fill_device,
                 k, j, i);
             if (include_B) {
-                get_B_restart_kharma(G, fx1min_ghost, fx1max_ghost, should_fill, length, f_length,
-                    x1_f_device, x2_f_device, x3_f_device, B_f_device,
-                    x1_fill_device, x2_fill_device, x3_fill_device, B_fill_device, B_Save,
+                get_B_restart_kharma(G, fx1min_ghost, fx1max_ghost, should_fill,
+                    idx, B_f_device,
+                    idx_fill, B_fill_device, B_Save,
                     k, j, i);
             }
         }
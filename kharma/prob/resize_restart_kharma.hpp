@@ -22,73 +22,123 @@ void ReadKharmaRestartHeader(std::string fname, ParameterInput *pin);
  */
 TaskStatus ReadKharmaRestart(std::shared_ptr<MeshBlockData<Real>> rc, ParameterInput *pin);
 
-// Hint form resize.hpp
-// TODO: (Hyerin) should I do const for x1, x2, x3, var?
-KOKKOS_INLINE_FUNCTION void Xtoindex(const GReal XG[GR_DIM],
-                                  //Real *x1, Real *x2, Real *x3,
-                                   const GridScalar& x1, const GridScalar& x2, const GridScalar& x3,
-                                   const hsize_t length[GR_DIM], int& iblock,
-                                   int& i, int& j, int& k, GReal del[GR_DIM])
+/**
+ * Index of the blocks in a KHARMA restart file, for finding the file zones around a point.
+ * Files without refinement tile the domain with a regular nb3 x nb2 x nb1 grid of blocks,
+ * so we find a point's block column in each direction by binary search over the column edges,
+ * then its zones within the block by binary search over that block's (monotonic) coordinates.
+ * Built on the host by ReadRestartBlocks over just the blocks a MeshBlock needs, so lookups
+ * are O(log) rather than a scan over every zone of every file block.
+ */
+struct RestartIndex {
+    // Zone centers of each file block, (block, i), including any ghost zones in the file
+    GridScalar x1, x2, x3;
+    // Lower edge of each column of blocks, halfway between neighboring blocks' last & first interior zones
+    ParArray1D<GReal> edge1, edge2, edge3;
+    // File block at each (b3, b2, b1) position in the block grid
+    ParArray3D<int> block;
+    int nb1, nb2, nb3;
+    int n1, n2, n3;
+    bool linear;
+};
+
+/**
+ * Zones & weights used to sample restart data at a point: either the single nearest zone,
+ * or the eight zones around the point for trilinear interpolation.
+ */
+struct RestartStencil {
+    int b;
+    int i[2], j[2], k[2];
+    GReal w1[2], w2[2], w3[2];
+};
+
+/**
+ * Index of the last column edge <= X, or 0 if X is below all of them
+ */
+KOKKOS_INLINE_FUNCTION int restart_column(const ParArray1D<GReal>& edges, const int nb, const GReal X)
 {
-    Real dx1, dx2, dx3, dx_sum, dx1_min, dx2_min, dx3_min, dx_sum_min;
-
-    // initialize
-    iblock =0;
-    i = 0;
-    j = 0;
-    k = 0;
-    dx1_min = (XG[1]-x1(iblock,i))*(XG[1]-x1(iblock,i));
-    dx2_min = (XG[2]-x2(iblock,j))*(XG[2]-x2(iblock,j));
-    dx3_min = (XG[3]-x3(iblock,k))*(XG[3]-x3(iblock,k));
-    dx_sum_min = dx1_min + dx2_min + dx3_min;
-
-    for (int iblocktemp = 0; iblocktemp < length[0]; iblocktemp++) {
-        // independently searching for minimum for i,j,k
-        for (int itemp = 0; itemp < length[1]; itemp++) {
-            dx1 = (XG[1]-x1(iblocktemp,itemp))*(XG[1]-x1(iblocktemp,itemp));
-            if (dx1 < dx1_min) {
-                dx1_min = dx1;
-                i = itemp;
-            }
-        }
-        for (int jtemp = 0; jtemp < length[2]; jtemp++) {
-            dx2 = (XG[2]-x2(iblocktemp,jtemp))*(XG[2]-x2(iblocktemp,jtemp));
-            if (dx2 < dx2_min) {
-                dx2_min = dx2;
-                j = jtemp;
-            }
-        }
-        for (int ktemp = 0; ktemp < length[3]; ktemp++) {
-            dx3 = (XG[3]-x3(iblocktemp,ktemp))*(XG[3]-x3(iblocktemp,ktemp));
-            if (dx3 < dx3_min) {
-                dx3_min = dx3;
-                k = ktemp;
-            }
-        }
-        dx_sum = (XG[1]-x1(iblocktemp,i))*(XG[1]-x1(iblocktemp,i)) + 
-                 (XG[2]-x2(iblocktemp,j))*(XG[2]-x2(iblocktemp,j)) + 
-                 (XG[3]-x3(iblocktemp,k))*(XG[3]-x3(iblocktemp,k));
-        if (dx_sum < dx_sum_min) {
-            dx_sum_min = dx_sum;
-            iblock = iblocktemp;
-        }
+    int lo = 0, hi = nb - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        if (edges(mid) <= X) lo = mid;
+        else hi = mid - 1;
     }
+    return lo;
+}
 
-    del[1] = 0.; //(XG[1] - ((i) * dx[1] + startx[1])) / dx[1];
-    del[2] = 0.;//(XG[2] - ((j) * dx[2] + startx[2])) / dx[2];
-    del[3] = 0.;// (phi   - ((k) * dx[3] + startx[3])) / dx[3];
-    if (m::abs(dx1_min / m::pow(XG[1],2.)) > 1.e-8) printf("Xtoindex: dx2 pretty large = %g at r= %g \n", dx1_min, XG[1]);
-    if (m::abs(dx2_min) > 1.e-8) printf("Xtoindex: dx2 pretty large = %g at th = %g \n", dx2_min, XG[2]);
-    if (m::abs(dx3_min) > 1.e-8) printf("Xtoindex: dx2 pretty large = %g at phi = %g \n", dx3_min, XG[3]);
+/**
+ * Find the zones of block b bracketing X in one direction: sets l to the last zone center <= X,
+ * limited so that l+1 is still in the block, and del to X's fractional position between l and l+1.
+ * Points off either end of the block are clamped to its outermost zone.
+ */
+KOKKOS_INLINE_FUNCTION void restart_bracket(const GridScalar& x, const int b, const int n, const GReal X,
+                                            int& l, GReal& del)
+{
+    if (n < 2) {
+        l = 0;
+        del = 0.;
+        return;
+    }
+    int lo = 0, hi = n - 2;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        if (x(b, mid) <= X) lo = mid;
+        else hi = mid - 1;
+    }
+    l = lo;
+    del = m::min(m::max((X - x(b, l)) / (x(b, l + 1) - x(b, l)), 0.), 1.);
+}
+
+/**
+ * Find the file zones used to fill a zone centered at XG, and their weights
+ */
+KOKKOS_INLINE_FUNCTION void Xtoindex(const GReal XG[GR_DIM], const RestartIndex& idx, RestartStencil& s)
+{
+    const int b1 = restart_column(idx.edge1, idx.nb1, XG[1]);
+    const int b2 = restart_column(idx.edge2, idx.nb2, XG[2]);
+    const int b3 = restart_column(idx.edge3, idx.nb3, XG[3]);
+    s.b = idx.block(b3, b2, b1);
+
+    GReal del[GR_DIM];
+    restart_bracket(idx.x1, s.b, idx.n1, XG[1], s.i[0], del[1]);
+    restart_bracket(idx.x2, s.b, idx.n2, XG[2], s.j[0], del[2]);
+    restart_bracket(idx.x3, s.b, idx.n3, XG[3], s.k[0], del[3]);
+    s.i[1] = m::min(s.i[0] + 1, idx.n1 - 1);
+    s.j[1] = m::min(s.j[0] + 1, idx.n2 - 1);
+    s.k[1] = m::min(s.k[0] + 1, idx.n3 - 1);
+
+    if (!idx.linear) {
+        // Nearest neighbor: collapse onto whichever side is closer
+        for (int d = 1; d < GR_DIM; ++d) del[d] = (del[d] > 0.5) ? 1. : 0.;
+    }
+    s.w1[0] = 1. - del[1]; s.w1[1] = del[1];
+    s.w2[0] = 1. - del[2]; s.w2[1] = del[2];
+    s.w3[0] = 1. - del[3]; s.w3[1] = del[3];
+}
+
+/**
+ * Sample variable v of a file array at a stencil.  Scalars can be passed with v=0, as ParArrayND
+ * pads leading indices, i.e. var(b,k,j,i) == var(0,b,k,j,i).
+ */
+KOKKOS_INLINE_FUNCTION Real restart_sample(const GridVector& var, const int v, const RestartStencil& s)
+{
+    Real val = 0.;
+    for (int kk = 0; kk < 2; ++kk)
+        for (int jj = 0; jj < 2; ++jj)
+            for (int ii = 0; ii < 2; ++ii) {
+                const GReal w = s.w3[kk] * s.w2[jj] * s.w1[ii];
+                if (w > 0.) val += w * var(v, s.b, s.k[kk], s.j[jj], s.i[ii]);
+            }
+    return val;
 }
 
 // TOOD(BSP) these can be merged and moved back into the fn body now
 
 KOKKOS_INLINE_FUNCTION void get_prim_restart_kharma(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
                     const Real fx1min, const Real fx1max, const bool should_fill, const bool is_spherical,
-                    const Real gam, const Real rs, const Real mdot, const Real ur_frac, const Real uphi, const hsize_t length[GR_DIM], const hsize_t length_fill[GR_DIM],
-                    const GridScalar& x1, const GridScalar& x2, const GridScalar& x3, const GridScalar& rho_file, const GridScalar& u_file, const GridVector& uvec_file,
-                    const GridScalar& x1_fill, const GridScalar& x2_fill, const GridScalar& x3_fill, const GridScalar& rho_fill, const GridScalar& u_fill, const GridVector& uvec_fill,
+                    const Real gam, const Real rs, const Real mdot, const Real ur_frac, const Real uphi,
+                    const RestartIndex& idx, const GridScalar& rho_file, const GridScalar& u_file, const GridVector& uvec_file,
+                    const RestartIndex& idx_fill, const GridScalar& rho_fill, const GridScalar& u_fill, const GridVector& uvec_fill,
                     const int& k, const int& j, const int& i) 
 {
     Real rho = 0, u = 0;
@@ -96,8 +146,7 @@ KOKKOS_INLINE_FUNCTION void get_prim_restart_kharma(const GRCoordinates& G, cons
 
     GReal X[GR_DIM];
     G.coord(k, j, i, Loci::center, X);
-    GReal del[GR_DIM]; // not really needed now since I am doing nearest neighbor interpolation
-    int iblocktemp, itemp, jtemp, ktemp;
+    RestartStencil st;
 
     // Interpolate the value at this location from the global grid
     if ((!should_fill) && (X[1]<fx1min)) {// if cannot be read from restart file
@@ -112,16 +161,16 @@ KOKKOS_INLINE_FUNCTION void get_prim_restart_kharma(const GRCoordinates& G, cons
    }
     // HyerinTODO: if fname_fill exists and smaller.
     else if ((should_fill) && ((X[1]>fx1max)||(X[1]<fx1min))) { // fill with the fname_fill
-        Xtoindex(X, x1_fill, x2_fill, x3_fill, length_fill, iblocktemp, itemp, jtemp, ktemp, del);
-        rho = rho_fill(iblocktemp, ktemp, jtemp, itemp);
-        u = u_fill(iblocktemp, ktemp, jtemp, itemp);
-        VLOOP u_prim[v] = uvec_fill(v, iblocktemp, ktemp, jtemp, itemp);
+        Xtoindex(X, idx_fill, st);
+        rho = restart_sample(rho_fill, 0, st);
+        u = restart_sample(u_fill, 0, st);
+        VLOOP u_prim[v] = restart_sample(uvec_fill, v, st);
     }
     else { 
-        Xtoindex(X, x1, x2, x3, length, iblocktemp, itemp, jtemp, ktemp, del);
-        rho = rho_file(iblocktemp,ktemp,jtemp,itemp);
-        u = u_file(iblocktemp,ktemp,jtemp,itemp);
-        VLOOP u_prim[v] = uvec_file(v,iblocktemp,ktemp,jtemp,itemp);
+        Xtoindex(X, idx, st);
+        rho = restart_sample(rho_file, 0, st);
+        u = restart_sample(u_file, 0, st);
+        VLOOP u_prim[v] = restart_sample(uvec_file, v, st);
         //printf("File fill location: %g %g %g %g new index: %d %d %d from old index: (%d) %d %d %d\n",
         //       X[0], X[1], X[2], X[3], k, j, i, iblocktemp, ktemp, jtemp, itemp);
     }
@@ -138,29 +187,27 @@ KOKKOS_INLINE_FUNCTION void get_prim_restart_kharma(const GRCoordinates& G, cons
 
 KOKKOS_INLINE_FUNCTION void get_B_restart_kharma(const GRCoordinates& G, 
                     const Real fx1min, const Real fx1max, const bool should_fill,
-                    const hsize_t length[GR_DIM], const hsize_t length_fill[GR_DIM],
-                    const GridScalar& x1, const GridScalar& x2, const GridScalar& x3, const GridVector& B,
-                    const GridScalar& x1_fill, const GridScalar& x2_fill, const GridScalar& x3_fill, const GridVector& B_fill, const GridVector& B_save,
+                    const RestartIndex& idx, const GridVector& B,
+                    const RestartIndex& idx_fill, const GridVector& B_fill, const GridVector& B_save,
                     const int& k, const int& j, const int& i) 
 {
     Real B_cons[NVEC];
     
     GReal X[GR_DIM];
     G.coord(k, j, i, Loci::center, X);
-    GReal del[GR_DIM]; // not really needed now since I am doing nearest neighbor interpolation
-    int iblocktemp, itemp, jtemp, ktemp;
+    RestartStencil st;
     // Interpolate the value at this location from the global grid
     if ((!should_fill) && (X[1]<fx1min)) {// if cannot be read from restart file
         // Just use the initialization from SeedBField
         VLOOP B_cons[v] = 0.;
    }
     else if ((should_fill) && ((X[1]>fx1max)||(X[1]<fx1min))) { // fill with the fname_fill
-        Xtoindex(X, x1_fill, x2_fill, x3_fill, length_fill, iblocktemp, itemp, jtemp, ktemp, del);
-        VLOOP B_cons[v] = B_fill(v,iblocktemp,ktemp,jtemp,itemp);
+        Xtoindex(X, idx_fill, st);
+        VLOOP B_cons[v] = restart_sample(B_fill, v, st);
     }
     else { 
-        Xtoindex(X, x1, x2, x3, length, iblocktemp, itemp, jtemp, ktemp, del);
-        VLOOP B_cons[v] = B(v,iblocktemp,ktemp,jtemp,itemp);
+        Xtoindex(X, idx, st);
+        VLOOP B_cons[v] = restart_sample(B, v, st);
     }
 
     VLOOP B_save(v, k, j, i) = B_cons[v];
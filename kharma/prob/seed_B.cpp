@@ -77,9 +77,30 @@ Real MinBeta(MeshData<Real> *md)
     return Reductions::DomainReduction<Reductions::Var::beta, Real>(md, UserHistoryOperation::min);
 }
 
+/**
+ * Current beta_min, with a single MPI reduction.  For the legacy definition, the maxima of
+ * P and P_B are reduced together.  Optionally returns those maxima for printing
+ */
+Real GlobalBetaMin(MeshData<Real> *md, bool legacy, Real *bsq_max=nullptr, Real *p_max=nullptr)
+{
+    if (legacy) {
+        const std::vector<Real> maxes = MPIReduce_once(std::vector<Real>{MaxBsq(md), MaxPressure(md)}, MPI_MAX);
+        if (bsq_max != nullptr) *bsq_max = maxes[0];
+        if (p_max != nullptr) *p_max = maxes[1];
+        return maxes[1] / (0.5 * maxes[0]);
+    } else {
+        return MPIReduce_once(MinBeta(md), MPI_MIN);
+    }
+}
 
+
+/**
+ * Seed the field on one block.  A is scratch space for the vector potential, one zone larger
+ * than the block in each direction; it's allocated once by the caller and reused for every block
+ */
 template <BSeedType Seed>
-TaskStatus SeedBFieldType(MeshBlockData<Real> *rc, ParameterInput *pin, IndexDomain domain = IndexDomain::entire)
+TaskStatus SeedBFieldType(MeshBlockData<Real> *rc, ParameterInput *pin, ParArrayND<double> &A,
+                          IndexDomain domain = IndexDomain::entire)
 {
     auto pmb = rc->GetBlockPointer();
     auto pkgs = pmb->packages.AllPackages();
@@ -257,7 +278,6 @@ TaskStatus SeedBFieldType(MeshBlockData<Real> *rc, ParameterInput *pin, IndexDom
         // TODO(BSP) Make the vector potential a proper edge-centered field, sync it before B calc
         IndexRange3 be = KDomain::GetRange(rc, domain, E3);
         IndexSize3 sz = KDomain::GetBlockSize(rc);
-        ParArrayND<double> A("A", NVEC, sz.n3+1, sz.n2+1, sz.n1+1);
         pmb->par_for(
             "B_field_A", be.ks, be.ke, be.js, be.je, be.is, be.ie,
             KOKKOS_LAMBDA(const int &k, const int &j, const int &i) {
@@ -412,6 +432,11 @@ TaskStatus SeedBField(MeshData<Real> *md, ParameterInput *pin)
         std::cout << "Seeding B field with type " << b_field_type << std::endl;
     }
 
+    // Blocks are all the same size, so they can share space for the vector potential
+    // (A is fully rewritten for each block, except components which are always zero)
+    const IndexSize3 sz = KDomain::GetBlockSize(md->GetBlockData(0).get());
+    ParArrayND<double> A("A", NVEC, sz.n3+1, sz.n2+1, sz.n1+1);
+
     TaskStatus status = TaskStatus::incomplete;
     for (int i=0; i < md->NumBlocks(); i++) {
         auto *rc = md->GetBlockData(i).get();
@@ -421,37 +446,37 @@ TaskStatus SeedBField(MeshData<Real> *md, ParameterInput *pin)
         // TODO could also save it to a package...
         // TODO accumulate TaskStatus properly?
         if (b_field_type == "constant") {
-            status = SeedBFieldType<BSeedType::constant>(rc, pin);
+            status = SeedBFieldType<BSeedType::constant>(rc, pin, A);
         } else if (b_field_type == "monopole") {
-            status = SeedBFieldType<BSeedType::monopole>(rc, pin);
+            status = SeedBFieldType<BSeedType::monopole>(rc, pin, A);
         } else if (b_field_type == "monopole_cube") { // Legacy name for the correct monopole init
-            status = SeedBFieldType<BSeedType::monopole>(rc, pin);
+            status = SeedBFieldType<BSeedType::monopole>(rc, pin, A);
         } else if (b_field_type == "sane") {
-            status = SeedBFieldType<BSeedType::sane>(rc, pin);
+            status = SeedBFieldType<BSeedType::sane>(rc, pin, A);
         } else if (b_field_type == "mad") {
-            status = SeedBFieldType<BSeedType::mad>(rc, pin);
+            status = SeedBFieldType<BSeedType::mad>(rc, pin, A);
         } else if (b_field_type == "mad_quadrupole") {
-            status = SeedBFieldType<BSeedType::mad_quadrupole>(rc, pin);
+            status = SeedBFieldType<BSeedType::mad_quadrupole>(rc, pin, A);
         } else if (b_field_type == "r3s3") {
-            status = SeedBFieldType<BSeedType::r3s3>(rc, pin);
+            status = SeedBFieldType<BSeedType::r3s3>(rc, pin, A);
         } else if (b_field_type == "steep" || b_field_type == "r5s5") {
-            status = SeedBFieldType<BSeedType::r5s5>(rc, pin);
+            status = SeedBFieldType<BSeedType::r5s5>(rc, pin, A);
         } else if (b_field_type == "gaussian") {
-            status = SeedBFieldType<BSeedType::gaussian>(rc, pin);
+            status = SeedBFieldType<BSeedType::gaussian>(rc, pin, A);
         } else if (b_field_type == "bz_monopole") {
-            status = SeedBFieldType<BSeedType::bz_monopole>(rc, pin);
+            status = SeedBFieldType<BSeedType::bz_monopole>(rc, pin, A);
         } else if (b_field_type == "vertical") {
-            status = SeedBFieldType<BSeedType::vertical>(rc, pin);
+            status = SeedBFieldType<BSeedType::vertical>(rc, pin, A);
         } else if (b_field_type == "r1s2") {
-            status = SeedBFieldType<BSeedType::r1s2>(rc, pin);
+            status = SeedBFieldType<BSeedType::r1s2>(rc, pin, A);
         } else if (b_field_type == "orszag_tang") {
-            status = SeedBFieldType<BSeedType::orszag_tang>(rc, pin);
+            status = SeedBFieldType<BSeedType::orszag_tang>(rc, pin, A);
         } else if (b_field_type == "orszag_tang_a") {
-            status = SeedBFieldType<BSeedType::orszag_tang_a>(rc, pin);
+            status = SeedBFieldType<BSeedType::orszag_tang_a>(rc, pin, A);
         } else if (b_field_type == "wave") {
-            status = SeedBFieldType<BSeedType::wave>(rc, pin);
+            status = SeedBFieldType<BSeedType::wave>(rc, pin, A);
         } else if (b_field_type == "shock_tube") {
-            status = SeedBFieldType<BSeedType::shock_tube>(rc, pin);
+            status = SeedBFieldType<BSeedType::shock_tube>(rc, pin, A);
         } else {
             throw std::invalid_argument("Magnetic field seed type not supported: " + b_field_type);
         }
@@ -478,14 +503,8 @@ TaskStatus NormalizeBField(MeshData<Real> *md, ParameterInput *pin)
     Real beta_calc_legacy = pin->GetOrAddBoolean("b_field", "legacy_norm", true);
 
     // Calculate current beta_min value
-    Real bsq_max, p_max, beta_min;
-    if (beta_calc_legacy) {
-        bsq_max = MPIReduce_once(MaxBsq(md), MPI_MAX);
-        p_max = MPIReduce_once(MaxPressure(md), MPI_MAX);
-        beta_min = p_max / (0.5 * bsq_max);
-    } else {
-        beta_min = MPIReduce_once(MinBeta(md), MPI_MIN);
-    }
+    Real bsq_max, p_max;
+    const Real beta_min = GlobalBetaMin(md, beta_calc_legacy, &bsq_max, &p_max);
     Real norm = m::sqrt(beta_min/desired_beta_min);
 
     if (MPIRank0() && verbose > 0) {
@@ -509,14 +528,8 @@ TaskStatus NormalizeBField(MeshData<Real> *md, ParameterInput *pin)
 
     // Measure again to check
     if (verbose > 0) {
-        Real bsq_max, p_max, beta_min;
-        if (beta_calc_legacy) {
-            bsq_max = MPIReduce_once(MaxBsq(md), MPI_MAX);
-            p_max = MPIReduce_once(MaxPressure(md), MPI_MAX);
-            beta_min = p_max / (0.5 * bsq_max);
-        } else {
-            beta_min = MPIReduce_once(MinBeta(md), MPI_MIN);
-        }
+        Real bsq_max, p_max;
+        const Real beta_min = GlobalBetaMin(md, beta_calc_legacy, &bsq_max, &p_max);
         if (MPIRank0()) {
             if (beta_calc_legacy) {
                 std::cout << "B^2 max post-norm: " << bsq_max << std::endl;
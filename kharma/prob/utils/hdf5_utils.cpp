@@ -68,6 +68,11 @@ static char hdf5_cur_dir[STRLEN] = "/";
 // Keep the file pointer globally.  This means ONE FILE AT A TIME!
 hid_t file_id;
 
+// Whether the open file was opened with MPI-IO, & reads should be collective
+static int hdf5_file_parallel = 0;
+// Chunk cache size for reading chunked/compressed datasets. 0 uses the HDF5 default
+static size_t hdf5_chunk_cache_bytes = 0;
+
 // Create a new HDF5 file in memory and group specified by name to
 // the root of the new HDF5 file and return pointer to blob.
 // Returns NULL on failure.
@@ -164,9 +169,41 @@ int hdf5_open(const char *fname)
   return 0;
 }
 
+// Open an existing file for reading from every rank with MPI-IO, if HDF5 supports it.
+// Every rank must then open, read & close in lockstep, as all reads are collective.
+// Falls back to hdf5_open if HDF5 was built without parallel support
+int hdf5_open_parallel(const char *fname)
+{
+#ifdef H5_HAVE_PARALLEL
+  hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_mpio(plist_id, MPI_COMM_WORLD, MPI_INFO_NULL);
+  // Read metadata on one rank & broadcast it, rather than hitting the filesystem from each
+  H5Pset_all_coll_metadata_ops(plist_id, 1);
+  file_id = H5Fopen(fname, H5F_ACC_RDONLY, plist_id);
+  H5Pclose(plist_id);
+  hdf5_file_parallel = 1;
+
+  hdf5_set_directory("/");
+  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+
+  if(file_id < 0) FAIL(file_id, "hdf5_open_parallel", fname);
+  return 0;
+#else
+  return hdf5_open(fname);
+#endif
+}
+
+// Set the chunk cache used when reading chunked datasets, in bytes.
+// Reading a large hyperslab of a compressed dataset is much faster if every chunk it touches fits
+void hdf5_set_chunk_cache(size_t nbytes)
+{
+  hdf5_chunk_cache_bytes = nbytes;
+}
+
 // Close a file
 int hdf5_close()
 {
+  hdf5_file_parallel = 0;
   H5Fflush(file_id,H5F_SCOPE_GLOBAL);
   herr_t err = H5Fclose(file_id);
 
@@ -214,6 +251,38 @@ int hdf5_exists(const char *name) {
   return exists > 0;
 }
 
+// Check that every filter the named dataset was written with (e.g. zstd or blosc, which are dynamically
+// loaded plugins) is available to decode it.  Prints the first missing filter & returns 0 if any is not
+int hdf5_filters_available(const char *name) {
+  char path[STRLEN];
+  strncpy(path, hdf5_cur_dir, STRLEN);
+  strncat(path, name, STRLEN - strlen(path));
+
+  hid_t dset_id = H5Dopen(file_id, path, H5P_DEFAULT);
+  if (dset_id < 0) FAIL(dset_id, "hdf5_filters_available", path);
+  hid_t dcpl_id = H5Dget_create_plist(dset_id);
+  int available = 1;
+  const int nfilters = H5Pget_nfilters(dcpl_id);
+  for (int n = 0; n < nfilters; ++n) {
+    unsigned int flags, filter_config;
+    size_t cd_nelmts = 0;
+    char filter_name[STRLEN];
+    H5Z_filter_t filter = H5Pget_filter2(dcpl_id, n, &flags, &cd_nelmts, NULL, STRLEN, filter_name, &filter_config);
+    if (H5Zfilter_avail(filter) <= 0) {
+      fprintf(stderr, "Dataset %s requires HDF5 filter %d (%s), which is not available. "
+                      "Is HDF5_PLUGIN_PATH set?\n", path, (int) filter, filter_name);
+      available = 0;
+      break;
+    }
+  }
+  H5Pclose(dcpl_id);
+  H5Dclose(dset_id);
+
+  if(DEBUG) fprintf(stderr,"Checking filters of %s: %d\n", path, available);
+
+  return available;
+}
+
 // Return a fixed-size string type
 // H5T_VARIABLE indicates any string but isn't compatible w/parallel IO
 hid_t hdf5_make_str_type(size_t len)
@@ -404,16 +473,28 @@ int hdf5_read_array(void *data, const char *name, size_t rank,
     fprintf(stderr,"Memory start: %llu %llu %llu %llu\n\n", mstart[0], mstart[1], mstart[2], mstart[3]);
   }
 
-  hid_t dset_id = H5Dopen(file_id, path, H5P_DEFAULT);
+  // Empty reads are allowed, so that all ranks can take part in collective reads
+  int empty = 0;
+  for (size_t d = 0; d < rank; ++d) if (fcount[d] == 0) empty = 1;
+  if (empty) {
+    H5Sselect_none(filespace);
+    H5Sselect_none(memspace);
+  }
+
+  hid_t dapl_id = H5Pcreate(H5P_DATASET_ACCESS);
+  if (hdf5_chunk_cache_bytes > 0)
+    H5Pset_chunk_cache(dapl_id, H5D_CHUNK_CACHE_NSLOTS_DEFAULT, hdf5_chunk_cache_bytes, H5D_CHUNK_CACHE_W0_DEFAULT);
+  hid_t dset_id = H5Dopen(file_id, path, dapl_id);
 
   hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
-#if USE_MPI
-  H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+#ifdef H5_HAVE_PARALLEL
+  if (hdf5_file_parallel) H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
 #endif
   herr_t err = H5Dread(dset_id, hdf5_type, memspace, filespace, plist_id, data);
   if (err < 0) FAIL(err, "hdf5_read_array", path);
 
   H5Dclose(dset_id);
+  H5Pclose(dapl_id);
   H5Pclose(plist_id);
   H5Sclose(filespace);
   H5Sclose(memspace);
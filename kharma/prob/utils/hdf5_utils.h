@@ -51,6 +51,7 @@ int hdf5_close_blob(hdf5_blob blob);
 // File
 int hdf5_create(const char *fname);
 int hdf5_open(const char *fname);
+int hdf5_open_parallel(const char *fname);
 int hdf5_close();
 
 // Directory
@@ -64,9 +65,11 @@ int hdf5_write_array(const void *data, const char *name, size_t rank,
 
 // Read
 int hdf5_exists(const char *name);
+int hdf5_filters_available(const char *name);
 int hdf5_read_single_val(void *val, const char *name, hsize_t hdf5_type);
 int hdf5_read_array(void *data, const char *name, size_t rank,
                       hsize_t *fdims, hsize_t *fstart, hsize_t *fcount, hsize_t *mdims, hsize_t *mstart, hsize_t hdf5_type);
+void hdf5_set_chunk_cache(size_t nbytes);
 
 // Convenience and annotations
 hid_t hdf5_make_str_type(size_t len);
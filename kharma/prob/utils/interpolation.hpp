@@ -35,6 +35,8 @@
 
 #include "decs.hpp"
 
+#include <vector>
+
 /**
  * Routines for interpolating on a grid, using values given in a flattened array.
  * Mostly used in resize_restart.cpp, which must interpolate from old simulation
@@ -88,6 +90,71 @@ KOKKOS_INLINE_FUNCTION void Xtoijk_nearest(const GReal X[GR_DIM],
     k = (int) ((X[3] - startx[3]) / dx[3] + 1000) - 1000;
 }
 
+/**
+ * Tabulated profiles, e.g. radial profiles read from other simulations.
+ * The table abscissa xs must be monotonically increasing, and is searched device-side:
+ * directly if log-uniformly spaced (see IsLogUniform), by bisection otherwise.
+ *
+ * Returns the index i of the last entry left of x, clamped to [0, n-2],
+ * and the proportional distance del from xs(i) to xs(i+1).  del is negative if x < xs(0),
+ * and > 1 if x > xs(n-1), so callers can choose whether to clamp or extrapolate.
+ */
+template<typename V>
+KOKKOS_INLINE_FUNCTION void Xtoindex_table(const GReal x, const V& xs, const int n, const bool log_uniform,
+                                           int& i, GReal& del)
+{
+    if (log_uniform && x > 0.) {
+        // Guess from the spacing, then correct any roundoff
+        const GReal dlx = m::log(xs(n-1) / xs(0)) / (n-1);
+        i = m::min(m::max(static_cast<int>(m::floor(m::log(x / xs(0)) / dlx)), 0), n-2);
+        if (i > 0 && xs(i) > x) i--;
+        if (i < n-2 && xs(i+1) <= x) i++;
+    } else {
+        int lo = 0, hi = n-1;
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            if (xs(mid) <= x) lo = mid;
+            else hi = mid;
+        }
+        i = lo;
+    }
+    del = (x - xs(i)) / (xs(i+1) - xs(i));
+}
+
+/**
+ * Linear interpolation of a 1D table, given the output of Xtoindex_table
+ */
+template<typename V>
+KOKKOS_INLINE_FUNCTION Real linear_table(const int& i, const GReal& del, const V& ys)
+{
+    return ys(i)*(1. - del) + ys(i+1)*del;
+}
+
+/**
+ * Bilinear interpolation of a 2D table ys(j,i), given the output of Xtoindex_table along each axis
+ */
+template<typename V>
+KOKKOS_INLINE_FUNCTION Real bilinear_table(const int& i, const int& j, const GReal& del1, const GReal& del2, const V& ys)
+{
+    return (1. - del2)*(ys(j, i)*(1. - del1) + ys(j, i+1)*del1) +
+                  del2*(ys(j+1, i)*(1. - del1) + ys(j+1, i+1)*del1);
+}
+
+/**
+ * Whether a (host) table abscissa is log-uniformly spaced to within a relative tolerance,
+ * i.e. whether Xtoindex_table can skip the search
+ */
+inline bool IsLogUniform(const std::vector<Real>& xs, const Real tol=1.e-6)
+{
+    const int n = xs.size();
+    if (n < 3 || xs[0] <= 0.) return false;
+    const Real dlx = std::log(xs[n-1] / xs[0]) / (n-1);
+    for (int i = 1; i < n; i++) {
+        if (m::abs(std::log(xs[i] / xs[i-1]) - dlx) > tol * m::abs(dlx)) return false;
+    }
+    return true;
+}
+
 // For using the ipole routines in a recognizable form on a 1D array
 #define ind(i, j, k) ( (k) * n2 * n1 + (j) * n1 + (i))
 
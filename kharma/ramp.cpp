@@ -0,0 +1,156 @@
+/* 
+ *  File: ramp.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ramp.hpp"
+
+#include "kharma.hpp"
+#include "post_initialize.hpp"
+
+#include <string>
+
+namespace {
+
+/**
+ * Number of the first restart output block, whose final restart each stage starts from
+ */
+int RestartOutputNumber(ParameterInput *pin)
+{
+    const std::string prefix = "parthenon/output";
+    for (InputBlock *pib = pin->pfirst_block; pib != nullptr; pib = pib->pnext) {
+        const std::string& block = pib->block_name;
+        if (block.rfind(prefix, 0) == 0 && pin->GetOrAddString(block, "file_type", "") == "rst")
+            return std::stoi(block.substr(prefix.size()));
+    }
+    throw std::invalid_argument("Resolution ramping requires a restart output block!");
+}
+
+/**
+ * Size after stage s in direction d, from <ramp>nxd, or the current size if not given
+ */
+int StageSize(ParameterInput *pin, const int d, const int s)
+{
+    const std::string name = "nx" + std::to_string(d);
+    if (!pin->DoesParameterExist("ramp", name))
+        return pin->GetInteger("parthenon/mesh", name);
+    const auto sizes = pin->GetVector<int>("ramp", name);
+    if (sizes.size() != pin->GetVector<Real>("ramp", "times").size())
+        throw std::invalid_argument("<ramp> "+name+" must list one size per ramp time!");
+    return sizes[s];
+}
+
+} // namespace
+
+void Ramp::StartStage(ParameterInput *pin)
+{
+    if (!pin->GetOrAddBoolean("ramp", "on", false)) return;
+    const auto times = pin->GetVector<Real>("ramp", "times");
+    // Stage & final time are recorded the first time through, and restored from any Parthenon restart
+    const int stage = pin->GetOrAddInteger("ramp", "stage", 0);
+    const Real tlim = pin->GetOrAddReal("ramp", "tlim", pin->GetReal("parthenon/time", "tlim"));
+
+    if (stage == 0) {
+        if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") != "none")
+            throw std::invalid_argument("Resolution ramping requires a mesh without refinement!");
+        const std::string solver = pin->GetOrAddString("b_field", "solver", "flux_ct");
+        if (solver != "flux_ct" && solver != "none")
+            throw std::invalid_argument("Resolution ramping supports only the flux_ct or no B field solver!");
+        for (int s = 0; s < times.size(); ++s) {
+            if (s > 0 && times[s] <= times[s-1])
+                throw std::invalid_argument("<ramp> times must increase!");
+            for (int d = 1; d <= 3; ++d) StageSize(pin, d, s);
+        }
+        RestartOutputNumber(pin);
+    }
+
+    const bool last = stage >= times.size();
+    pin->SetReal("parthenon/time", "tlim", last ? tlim : m::min(times[stage], tlim));
+    if (MPIRank0()) {
+        std::cout << "Resolution ramp stage " << stage << ": " << pin->GetInteger("parthenon/mesh", "nx1") << "x"
+                  << pin->GetInteger("parthenon/mesh", "nx2") << "x" << pin->GetInteger("parthenon/mesh", "nx3")
+                  << " until t = " << pin->GetReal("parthenon/time", "tlim") << std::endl;
+    }
+}
+
+bool Ramp::NextStage(ParthenonManager &pman, const DriverStatus status, const SimTime &tm)
+{
+    auto pin = pman.pinput.get();
+    if (!pin->GetOrAddBoolean("ramp", "on", false)) return false;
+    const auto times = pin->GetVector<Real>("ramp", "times");
+    const int stage = pin->GetInteger("ramp", "stage");
+    // Stop for good if this was the last stage, or the driver stopped early e.g. for nlim or the wall clock
+    if (stage >= times.size() || status != DriverStatus::complete ||
+        tm.time < tm.tlim || tm.tlim >= pin->GetReal("ramp", "tlim"))
+        return false;
+
+    Flag("RampNextStage");
+    // The stage's final restart, as named by Parthenon
+    const std::string fname = pin->GetString("parthenon/job", "problem_id") + ".out" +
+                              std::to_string(RestartOutputNumber(pin)) + ".final.rhdf";
+
+    // Scale the meshblocks with the mesh, so the block decomposition is unchanged
+    for (int d = 1; d <= 3; ++d) {
+        const std::string name = "nx" + std::to_string(d);
+        const int nx_old = pin->GetInteger("parthenon/mesh", name);
+        const int nx_new = StageSize(pin, d, stage);
+        const int mb_old = pin->GetOrAddInteger("parthenon/meshblock", name, nx_old);
+        if ((mb_old * nx_new) % nx_old != 0)
+            throw std::invalid_argument("Ramp size "+std::to_string(nx_new)+" in "+name+
+                                        " does not give a whole number of zones per meshblock!");
+        pin->SetInteger("parthenon/mesh", name, nx_new);
+        pin->SetInteger("parthenon/meshblock", name, mb_old * nx_new / nx_old);
+    }
+    pin->SetInteger("ramp", "stage", stage + 1);
+
+    // Fill the new mesh from the restart, continuing the run rather than its recorded time limit.
+    // The old timestep is too large for the finer grid, so start again from <parthenon/time>dt
+    pin->SetString("parthenon/job", "problem_id", "resize_restart_kharma");
+    pin->SetString("resize_restart", "fname", fname);
+    pin->SetBoolean("resize_restart", "use_restart_size", false);
+    pin->SetBoolean("resize_restart", "use_tf", false);
+    pin->SetBoolean("resize_restart", "use_dt", false);
+    pin->SetString("resize_restart", "interpolation", pin->GetOrAddString("ramp", "interpolation", "linear"));
+    // Interpolated B is not divergence-free, so it is cleaned before the stage begins
+    if (pin->GetString("b_field", "solver") != "none")
+        pin->SetBoolean("b_field", "initial_cleanup", true);
+
+    // Free the old Mesh before allocating the new one, then initialize it as main() would
+    pman.pmesh.reset();
+    KHARMA::FixParameters(pin, false);
+    auto packages = pman.app_input->ProcessPackages(pman.pinput);
+    pman.pmesh = std::make_unique<Mesh>(pin, pman.app_input.get(), packages);
+    pman.pmesh->Initialize(true, pin, pman.app_input.get());
+    KHARMA::PostInitialize(pin, pman.pmesh.get(), false);
+    EndFlag();
+    return true;
+}
@@ -0,0 +1,74 @@
+/* 
+ *  File: ramp.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+/**
+ * Progressive-resolution runs: evolve at low resolution through the early transient, then re-grid
+ * to higher resolutions at set times, all within one run of KHARMA.
+ *
+ * With <ramp>on = true, <ramp>times lists the times at which to re-grid, and <ramp>nx1, nx2 & nx3 list the
+ * mesh size in each direction after each re-grid (unspecified directions keep their size).
+ * The run starts at the <parthenon/mesh> size.  Each re-grid:
+ * 1. Ends the current driver at the ramp time, writing the final restart of the first restart output block
+ * 2. Frees the Mesh, and constructs the packages and a new Mesh at the next size, with meshblocks scaled
+ *    by the same factor so that each rank keeps the same blocks
+ * 3. Fills the new Mesh from the restart with the resize_restart_kharma problem, interpolating
+ *    linearly unless <ramp>interpolation = nearest
+ * 4. Projects out the divergence introduced by interpolating B with B_Cleanup, as for any resize
+ * 5. Runs a new driver until the next ramp time, or finally <parthenon/time>tlim
+ *
+ * As with any resize_restart_kharma, only the fluid state & field are carried between stages,
+ * and outputs after the first re-grid are named for the resize_restart_kharma problem.
+ * Only a single-level mesh with the Flux-CT (or no) field is supported.
+ * The current stage is recorded in the parameters, so runs stopped partway through a stage
+ * restart (via Parthenon) into the same stage.
+ */
+namespace Ramp {
+
+/**
+ * Set <parthenon/time>tlim to end the current stage at its ramp time, if ramping.
+ * Call before constructing each driver.
+ */
+void StartStage(ParameterInput *pin);
+
+/**
+ * If the driver just run completed a stage, replace pman's Mesh with one at the next stage's resolution,
+ * filled from the stage's final restart.
+ * @return whether there is a new stage to run
+ */
+bool NextStage(ParthenonManager &pman, const DriverStatus status, const SimTime &tm);
+
+}
@@ -34,43 +34,234 @@
 
 #include "reductions.hpp"
 
+#include "domain.hpp"
+
+#include <algorithm>
+
 #include <parthenon/parthenon.hpp>
 
 // TODO none of this machinery preserves zone locations,
 // which we pretty often would like...
 
+// Non-owning, see Initialize
+static Reductions::ReductionChannels *channel_registry = nullptr;
+
+Reductions::ReductionChannels& Reductions::Channels()
+{
+    return *channel_registry;
+}
+
 std::shared_ptr<KHARMAPackage> Reductions::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
 {
     auto pkg = std::make_shared<KHARMAPackage>("Reductions");
     Params &params = pkg->AllParams();
 
-    // These pools are vectors of Reducers which operate on vectors (or scalars)
-    // They exist to allow several reductions to be in-flight at once to hide latency
-    // (even reductions over vectors, as with the different flags)
-    std::vector<Reduce<std::vector<int>>> vector_int_reduce_pool;
-    params.Add("vector_int_reduce_pool", vector_int_reduce_pool, true);
-    std::vector<Reduce<std::vector<Real>>> vector_reduce_pool;
-    params.Add("vector_reduce_pool", vector_reduce_pool, true);
-    std::vector<Reduce<int>> int_reduce_pool;
-    params.Add("int_reduce_pool", int_reduce_pool, true);
-    std::vector<Reduce<Real>> reduce_pool;
-    params.Add("reduce_pool", reduce_pool, true);
-
-    std::vector<AllReduce<std::vector<int>>> vector_int_allreduce_pool;
-    params.Add("vector_int_allreduce_pool", vector_int_allreduce_pool, true);
-    std::vector<AllReduce<std::vector<Real>>> vector_allreduce_pool;
-    params.Add("vector_allreduce_pool", vector_allreduce_pool, true);
-    std::vector<AllReduce<int>> int_allreduce_pool;
-    params.Add("int_allreduce_pool", int_allreduce_pool, true);
-    std::vector<AllReduce<Real>> allreduce_pool;
-    params.Add("allreduce_pool", allreduce_pool, true);
+    // Reducers for each channel.  Kept here so they're cleaned up with the package, before MPI is finalized,
+    // but addressed directly through Channels() to keep string lookups out of Start/Check
+    auto channels = std::make_shared<ReductionChannels>();
+    params.Add("channels", channels);
+    channel_registry = channels.get();
+
+    // Flag reductions waiting to be printed, see FinishFlagReduce
+    params.Add("deferred_flag_reduces", std::vector<DeferredFlagReduce>(), true);
+
+    // Results of batched history reductions, by batch name, kept per-partition (see GetPartitionParam)
+    params.Add("batch_results", std::map<int, std::map<std::string, std::vector<Real>>>(), true);
+
+    // Zones on each set of shell radii, kept per-partition
+    params.Add("shell_layers", std::map<int, std::map<std::vector<GReal>, ShellLayers>>(), true);
 
     // Reductions sometimes need global elements of the simulation we don't otherwise keep
     params.Add("domain_r_in", (GReal) pin->GetReal("coordinates", "r_in"));
 
+    // Histograms of zone values, reduced on the device and written to the history file, one column per bin.
+    // This gives distributions of e.g. plasma beta at the history cadence, without dumping full fields
+    auto hist_vars_list = pin->GetOrAddVector<std::string>("histograms", "variables", std::vector<std::string>{});
+    if (!hist_vars_list.empty()) {
+        const int nbins = pin->GetOrAddInteger("histograms", "nbins", 32);
+        if (nbins < 1 || nbins > MAX_HIST_BINS)
+            throw std::invalid_argument("Histograms must have between 1 and "+std::to_string(MAX_HIST_BINS)+" bins!");
+        parthenon::HstVar_list hst_vars = {};
+        for (auto &name : hist_vars_list) {
+            HistogramBins bins;
+            bins.nbins = nbins;
+            if (name == "beta") {
+                bins.min = 1e-3; bins.max = 1e5; bins.log = true;
+            } else if (name == "sigma") {
+                bins.min = 1e-4; bins.max = 1e4; bins.log = true;
+            } else if (name == "theta_e") {
+                if (!pin->GetOrAddBoolean("electrons", "on", false))
+                    throw std::invalid_argument("Histogram of theta_e requires electrons!");
+                bins.min = 1e-3; bins.max = 1e3; bins.log = true;
+            } else if (name == "inverter_iters") {
+                if (!pin->GetOrAddBoolean("inverter", "iteration_stats", false))
+                    throw std::invalid_argument("Histogram of inverter_iters requires inverter/iteration_stats!");
+                // One bin per iteration count
+                bins.min = 0.; bins.max = nbins; bins.log = false;
+            } else {
+                throw std::invalid_argument("Unknown histogram variable: "+name);
+            }
+            bins.log = pin->GetOrAddBoolean("histograms", name+"_log", bins.log);
+            bins.min = pin->GetOrAddReal("histograms", name+"_min", bins.min);
+            bins.max = pin->GetOrAddReal("histograms", name+"_max", bins.max);
+            if (bins.max <= bins.min || (bins.log && bins.min <= 0.))
+                throw std::invalid_argument("Invalid histogram range for "+name+"!");
+            for (int b = 0; b < nbins; b++) {
+                hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum,
+                    [name, bins, b](MeshData<Real> *md) { return HistogramValue(md, name, bins, b); },
+                    name+"_hist_"+std::to_string(b)));
+            }
+        }
+        pkg->AddParam<>(parthenon::hist_param_key, hst_vars);
+    }
+
+    // Statistical health checks: a sample of blocks every step, and the full mesh occasionally.
+    // Much cheaper than the full checks of extra_checks, so they can stay on in production
+    bool health_checks = pin->GetOrAddBoolean("debug", "health_checks", false);
+    params.Add("health_checks", health_checks);
+    if (health_checks) {
+        params.Add("health_sample_fraction", pin->GetOrAddReal("debug", "health_sample_fraction", 0.05));
+        params.Add("health_full_interval", pin->GetOrAddInteger("debug", "health_full_interval", 100));
+        pkg->PostStepDiagnosticsMesh = Reductions::HealthChecks;
+    }
+
     return pkg;
 }
 
+bool Reductions::GetShellLayers(MeshData<Real> *md, const std::vector<GReal>& radii, ShellLayers& layers)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    // Elsewhere, embedding x1 need not depend only on native X1
+    if (!pmb0->coords.coords.is_spherical()) return false;
+
+    auto *cache = GetPartitionParam<std::map<std::vector<GReal>, ShellLayers>>(md, "Reductions", "shell_layers");
+    auto& entry = (*cache)[radii];
+    auto locs = PartitionLocations(md);
+    if (entry.locs == locs) {
+        layers = entry;
+        return true;
+    }
+
+    Flag("GetShellLayers");
+    // Find zones as DomainReduction's test does: center outside the shell, previous center inside.
+    // r depends only on X1 here, so we check along the first row of each block,
+    // skipping blocks which don't span the shell
+    const IndexRange ib = md->GetBoundsI(IndexDomain::interior);
+    const IndexRange jb = md->GetBoundsJ(IndexDomain::interior);
+    const IndexRange kb = md->GetBoundsK(IndexDomain::interior);
+    std::vector<int> layer_b, layer_i;
+    for (int b = 0; b < md->NumBlocks(); b++) {
+        const auto& G = md->GetBlockData(b)->GetBlockPointer()->coords;
+        GReal xlo[GR_DIM], xhi[GR_DIM];
+        G.coord_embed(kb.s, jb.s, ib.s - 1, Loci::center, xlo);
+        G.coord_embed(kb.s, jb.s, ib.e, Loci::center, xhi);
+        for (const GReal& r : radii) {
+            if (!(xlo[1] < r && xhi[1] > r)) continue;
+            for (int i = ib.s; i <= ib.e; i++) {
+                GReal x[GR_DIM], xin[GR_DIM];
+                G.coord_embed(kb.s, jb.s, i, Loci::center, x);
+                G.coord_embed(kb.s, jb.s, i - 1, Loci::center, xin);
+                if (x[1] > r && xin[1] < r) {
+                    // Two shells in one zone must be counted once, as their tests are made separately
+                    bool seen = false;
+                    for (int l = 0; l < layer_b.size(); l++)
+                        seen = seen || (layer_b[l] == b && layer_i[l] == i);
+                    if (!seen) {
+                        layer_b.push_back(b);
+                        layer_i.push_back(i);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    entry.n = layer_b.size();
+    entry.block = ParArray1D<int>("shell_layer_block", std::max(entry.n, 1));
+    entry.i = ParArray1D<int>("shell_layer_i", std::max(entry.n, 1));
+    auto block_h = entry.block.GetHostMirror();
+    auto i_h = entry.i.GetHostMirror();
+    for (int l = 0; l < entry.n; l++) {
+        block_h(l) = layer_b[l];
+        i_h(l) = layer_i[l];
+    }
+    entry.block.DeepCopy(block_h);
+    entry.i.DeepCopy(i_h);
+    Kokkos::fence();
+    entry.locs = locs;
+
+    layers = entry;
+    EndFlag();
+    return true;
+}
+
+Reductions::BatchRegions Reductions::StandardShells(MeshData<Real> *md)
+{
+    const GReal radii[3] = {md->GetMeshPointer()->packages.Get("Reductions")->Param<GReal>("domain_r_in"),
+                            md->GetMeshPointer()->block_list[0]->coords.coords.get_horizon(),
+                            5.};
+    BatchRegions regions;
+    regions.n = 3;
+    regions.trivial[0] = true;
+    regions.trivial[1] = false;
+    regions.trivial[2] = false;
+    for (int s = 0; s < 3; s++) {
+        regions.startx[s][0] = regions.stopx[s][0] = radii[s];
+        regions.startx[s][1] = regions.startx[s][2] = std::numeric_limits<GReal>::min();
+        regions.stopx[s][1] = regions.stopx[s][2] = std::numeric_limits<GReal>::max();
+    }
+    return regions;
+}
+
+Reductions::BatchRegions Reductions::WholeDomain()
+{
+    BatchRegions regions;
+    regions.n = 1;
+    for (int v = 0; v < 3; v++) {
+        regions.trivial[v] = false;
+        regions.startx[0][v] = std::numeric_limits<GReal>::min();
+        regions.stopx[0][v] = std::numeric_limits<GReal>::max();
+    }
+    return regions;
+}
+
+std::vector<Real> Reductions::FieldHistogram(MeshData<Real> *md, const std::string& field_name, const HistogramBins& bins)
+{
+    Flag("FieldHistogram_"+field_name);
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto field = md->PackVariables(std::vector<std::string>{field_name});
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const IndexRange block = IndexRange{0, field.GetDim(5) - 1};
+
+    array_type<Real, MAX_HIST_BINS> hist_result;
+    pmb0->par_reduce("field_histogram", block.s, block.e, b.ks, b.ke, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &k, const int &j, const int &i, array_type<Real, MAX_HIST_BINS> &local_result) {
+            local_result.my_array[hist_bin(field(bl, 0, k, j, i), bins)] += 1.;
+        }
+    , ArraySum<Real, HostExecSpace, MAX_HIST_BINS>(hist_result));
+
+    EndFlag();
+    return std::vector<Real>(hist_result.my_array, hist_result.my_array + bins.nbins);
+}
+
+Real Reductions::HistogramValue(MeshData<Real> *md, const std::string& name, const HistogramBins& bins, int b)
+{
+    auto *results = GetPartitionParam<std::map<std::string, std::vector<Real>>>(md, "Reductions", "batch_results");
+    auto& result = (*results)["hist_"+name];
+    if (b == 0 || result.size() <= b) {
+        if (name == "beta") {
+            result = Histogram<Var::beta>(md, bins);
+        } else if (name == "sigma") {
+            result = Histogram<Var::sigma>(md, bins);
+        } else if (name == "theta_e") {
+            result = Histogram<Var::theta_e>(md, bins);
+        } else {
+            result = FieldHistogram(md, name, bins);
+        }
+    }
+    return result[b];
+}
+
 // Flag reductions: local
 int Reductions::CountFlag(MeshData<Real> *md, std::string field_name, const int& flag_val, IndexDomain domain, bool is_bitflag)
 {
@@ -97,7 +288,20 @@ int Reductions::CountFlag(MeshData<Real> *md, std::string field_name, const int&
     return n_flag;
 }
 
-#define MAX_NFLAGS 20
+ParArray1D<int> Reductions::FlagValueList(const std::map<int, std::string> &flag_values)
+{
+    // Man, moving arrays is clunky.  Oh well.
+    ParArray1D<int> flag_val_list("flag_values", MAX_NFLAGS);
+    auto flag_val_list_h = flag_val_list.GetHostMirror();
+    int f=1;
+    for (auto &flag : flag_values) {
+        flag_val_list_h[f] = flag.first;
+        f++;
+    }
+    flag_val_list.DeepCopy(flag_val_list_h);
+    Kokkos::fence();
+    return flag_val_list;
+}
 
 std::vector<int> Reductions::CountFlags(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag)
 {
@@ -114,17 +318,8 @@ std::vector<int> Reductions::CountFlags(MeshData<Real> *md, std::string field_na
     IndexRange kb = md->GetBoundsK(domain);
     IndexRange block = IndexRange{0, flag.GetDim(5) - 1};
 
-    // Man, moving arrays is clunky.  Oh well.
     const int n_of_flags = flag_values.size();
-    ParArray1D<int> flag_val_list("flag_values", MAX_NFLAGS);
-    auto flag_val_list_h = flag_val_list.GetHostMirror();
-    int f=1;
-    for (auto &flag : flag_values) {
-        flag_val_list_h[f] = flag.first;
-        f++;
-    }
-    flag_val_list.DeepCopy(flag_val_list_h);
-    Kokkos::fence();
+    const auto flag_val_list = FlagValueList(flag_values);
 
     // Count all nonzero (technically, >0) values,
     // and all values which match each flag.
@@ -134,14 +329,7 @@ std::vector<int> Reductions::CountFlags(MeshData<Real> *md, std::string field_na
     pmb0->par_reduce("count_flags", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
         KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i, 
                        Reductions::array_type<int, MAX_NFLAGS> &local_result) {
-            const int flag_int = static_cast<int>(flag(b, 0, k, j, i));
-            // First element is total count
-            if (flag_int > 0) ++local_result.my_array[0];
-            // The rest of the list is individual flags
-            for (int f=1; f <= n_of_flags; f++)
-                if ((is_bitflag && flag_int & flag_val_list(f)) ||
-                    (!is_bitflag && flag_int == flag_val_list(f)))
-                    ++local_result.my_array[f];
+            TallyFlag(static_cast<int>(flag(b, 0, k, j, i)), flag_val_list, n_of_flags, is_bitflag, local_result);
         }
     , Reductions::ArraySum<int, HostExecSpace, MAX_NFLAGS>(flag_reducer));
 
@@ -153,27 +341,213 @@ std::vector<int> Reductions::CountFlags(MeshData<Real> *md, std::string field_na
     return n_each_flag;
 }
 
+std::vector<std::vector<int>> Reductions::CountFlagFields(MeshData<Real> *md, const std::vector<FlagField> &fields, IndexDomain domain)
+{
+    Flag("CountFlagFields");
+    const int n_fields = fields.size();
+    if (n_fields > MAX_FLAG_FIELDS)
+        throw std::invalid_argument("Too many flag fields to count at once!");
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    // Pack variables, and list each field's index & flag values
+    std::vector<std::string> flag_vec;
+    for (auto &field : fields) flag_vec.push_back(field.name);
+    PackIndexMap flag_map;
+    auto& flag = md->PackVariables(flag_vec, flag_map);
+
+    ParArray2D<int> flag_val_list("flag_field_values", MAX_FLAG_FIELDS, MAX_NFLAGS);
+    auto flag_val_list_h = flag_val_list.GetHostMirror();
+    int field_idx[MAX_FLAG_FIELDS], n_of_flags[MAX_FLAG_FIELDS];
+    bool is_bitflag[MAX_FLAG_FIELDS];
+    for (int n = 0; n < MAX_FLAG_FIELDS; n++) {
+        field_idx[n] = (n < n_fields) ? flag_map[fields[n].name].first : -1;
+        n_of_flags[n] = (n < n_fields) ? fields[n].flag_values.size() : 0;
+        is_bitflag[n] = (n < n_fields) ? fields[n].is_bitflag : false;
+        int f = 1;
+        if (n < n_fields)
+            for (auto &fv : fields[n].flag_values) flag_val_list_h(n, f++) = fv.first;
+    }
+    flag_val_list.DeepCopy(flag_val_list_h);
+
+    // Get sizes
+    IndexRange ib = md->GetBoundsI(domain);
+    IndexRange jb = md->GetBoundsJ(domain);
+    IndexRange kb = md->GetBoundsK(domain);
+    IndexRange block = IndexRange{0, flag.GetDim(5) - 1};
+
+    // Each field's counts are laid out as in CountFlags, at offset MAX_NFLAGS * n
+    constexpr int NCOUNT = MAX_FLAG_FIELDS*MAX_NFLAGS;
+    Reductions::array_type<int, NCOUNT> flag_reducer;
+    pmb0->par_reduce("count_flag_fields", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i,
+                       Reductions::array_type<int, NCOUNT> &local_result) {
+            for (int n = 0; n < n_fields; n++) {
+                const int flag_int = static_cast<int>(flag(b, field_idx[n], k, j, i));
+                if (flag_int > 0) ++local_result.my_array[MAX_NFLAGS*n];
+                for (int f = 1; f <= n_of_flags[n]; f++)
+                    if ((is_bitflag[n] && flag_int & flag_val_list(n, f)) ||
+                        (!is_bitflag[n] && flag_int == flag_val_list(n, f)))
+                        ++local_result.my_array[MAX_NFLAGS*n + f];
+            }
+        }
+    , Reductions::ArraySum<int, HostExecSpace, NCOUNT>(flag_reducer));
+
+    std::vector<std::vector<int>> n_each_flag;
+    for (int n = 0; n < n_fields; n++)
+        n_each_flag.push_back(std::vector<int>(flag_reducer.my_array + MAX_NFLAGS*n,
+                                               flag_reducer.my_array + MAX_NFLAGS*n + n_of_flags[n] + 1));
+
+    EndFlag();
+    return n_each_flag;
+}
+
+void Reductions::RecordFlagCounts(MeshData<Real> *md, const std::string& package, const std::string& name,
+                                  const array_type<int, MAX_NFLAGS>& counts, int n_of_flags)
+{
+    auto *flag_counts = GetPartitionParam<std::vector<int>>(md, package, name);
+    flag_counts->assign(counts.my_array, counts.my_array + n_of_flags + 1);
+}
+
+bool Reductions::StartRecordedFlagReduce(MeshData<Real> *md, const std::string& package, const std::string& name,
+                                         int n_of_flags, Channel channel)
+{
+    auto *flag_counts = md->GetMeshPointer()->packages.Get(package)->AllParams().GetMutable<std::map<int, std::vector<int>>>(name);
+    if (flag_counts->empty()) return false;
+    std::vector<int> total(n_of_flags + 1, 0);
+    for (auto &partition : *flag_counts)
+        for (int f = 0; f < partition.second.size(); f++)
+            total[f] += partition.second[f];
+    flag_counts->clear();
+    Start<std::vector<int>>(md, channel, total, MPI_SUM);
+    return true;
+}
+
+std::vector<int> Reductions::CountUnhealthy(MeshData<Real> *md, const std::vector<int>& blocks)
+{
+    Flag("CountUnhealthy");
+    std::vector<int> counts(NHEALTH, 0);
+    const int nsample = blocks.size();
+    if (nsample == 0) {
+        EndFlag();
+        return counts;
+    }
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const auto& U = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const auto& cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+    const auto& cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+    const int nprim = P.GetDim(4);
+
+    ParArray1D<int> block_list("health_blocks", nsample);
+    auto block_list_h = Kokkos::create_mirror_view(block_list);
+    for (int m = 0; m < nsample; m++) block_list_h(m) = blocks[m];
+    Kokkos::deep_copy(block_list, block_list_h);
+
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    array_type<int, NHEALTH> health_reducer;
+    pmb0->par_reduce("count_unhealthy", 0, nsample - 1, bi.ks, bi.ke, bi.js, bi.je, bi.is, bi.ie,
+        KOKKOS_LAMBDA (const int &m, const int &k, const int &j, const int &i, array_type<int, NHEALTH> &local_result) {
+            const int b = block_list(m);
+            bool nan_c = false, zero_c = false;
+            VLOOP {
+                const Real ctop = m::max(cmax(b, v, k, j, i), cmin(b, v, k, j, i));
+                nan_c |= m::isnan(ctop);
+                zero_c |= (ctop <= 0.);
+            }
+            bool nan_p = false;
+            for (int p = 0; p < nprim; p++) nan_p |= m::isnan(P(b, p, k, j, i));
+            local_result.my_array[(int) Health::nan_ctop] += nan_c;
+            local_result.my_array[(int) Health::zero_ctop] += zero_c;
+            local_result.my_array[(int) Health::neg_rho] += (P(b, m_p.RHO, k, j, i) < 0.);
+            local_result.my_array[(int) Health::neg_u] += (P(b, m_p.UU, k, j, i) < 0.);
+            local_result.my_array[(int) Health::neg_rhout] += (U(b, m_u.RHO, k, j, i) < 0.);
+            local_result.my_array[(int) Health::nan_prim] += nan_p;
+        }
+    , ArraySum<int, HostExecSpace, NHEALTH>(health_reducer));
+
+    counts.assign(health_reducer.my_array, health_reducer.my_array + NHEALTH);
+    EndFlag();
+    return counts;
+}
+
+TaskStatus Reductions::HealthChecks(const SimTime& tm, MeshData<Real> *md)
+{
+    Flag("HealthChecks");
+    const auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
+    const Real fraction = pars.Get<Real>("health_sample_fraction");
+    const int full_interval = pars.Get<int>("health_full_interval");
+
+    // Sample blocks by a hash of their global ID & the step, so the sample is the same
+    // regardless of how blocks are distributed, yet changes every step
+    const bool full = (full_interval > 0 && tm.ncycle % full_interval == 0);
+    std::vector<int> sampled, all;
+    for (int b = 0; b < md->NumBlocks(); b++) {
+        all.push_back(b);
+        uint64_t h = static_cast<uint64_t>(md->GetBlockData(b)->GetBlockPointer()->gid) * 0x9E3779B97F4A7C15ull
+                     + static_cast<uint64_t>(tm.ncycle);
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        if (full || (h >> 11) * (1. / 9007199254740992.) < fraction) sampled.push_back(b);
+    }
+
+    StartToAll<std::vector<int>>(md, Channel::health, CountUnhealthy(md, sampled), MPI_SUM);
+    // Every rank needs the result, to agree on escalating
+    std::vector<int> counts = CheckOnAll<std::vector<int>>(md, Channel::health);
+    const bool any_bad = std::any_of(counts.begin(), counts.end(), [](int n) { return n > 0; });
+    if (any_bad && !full) {
+        // Escalate: the sample is only a hint, report on the whole mesh
+        if (MPIRank0())
+            std::cout << "Health check sample found bad zones at step " << tm.ncycle << ", checking all blocks" << std::endl;
+        StartToAll<std::vector<int>>(md, Channel::health, CountUnhealthy(md, all), MPI_SUM);
+        counts = CheckOnAll<std::vector<int>>(md, Channel::health);
+    }
+
+    if (MPIRank0()) {
+        const int nless_rho = counts[(int) Health::neg_rho], nless_u = counts[(int) Health::neg_u];
+        if (counts[(int) Health::neg_rhout] > 0)
+            std::cout << "Number of negative conserved rho: " << counts[(int) Health::neg_rhout] << std::endl;
+        if (nless_rho > 0 || nless_u > 0)
+            std::cout << "Number of negative primitive rho, u: " << nless_rho << "," << nless_u << std::endl;
+        if (counts[(int) Health::nan_prim] > 0)
+            std::cout << "Number of zones with NaN primitives: " << counts[(int) Health::nan_prim] << std::endl;
+    }
+    EndFlag();
+    if (counts[(int) Health::nan_ctop] > 0 || counts[(int) Health::zero_ctop] > 0) {
+        if (MPIRank0())
+            fprintf(stderr, "Max signal speed ctop of 0 or NaN (%d zero, %d NaN)\n",
+                    counts[(int) Health::zero_ctop], counts[(int) Health::nan_ctop]);
+        throw std::runtime_error("Bad ctop!");
+    }
+
+    return TaskStatus::complete;
+}
+
 // Flag reductions: global
-void Reductions::StartFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag, int channel)
+void Reductions::StartFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag, Channel channel)
 {
     Start<std::vector<int>>(md, channel, CountFlags(md, field_name, flag_values, domain, is_bitflag), MPI_SUM);
 }
 
 std::vector<int> Reductions::CheckFlagReduceAndPrintHits(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values,
-                                                     IndexDomain domain, bool is_bitflag, int channel)
+                                                     IndexDomain domain, bool is_bitflag, Channel channel)
 {
     Flag("CheckFlagReduce");
+    const std::vector<int> total_flag_counts = Check<std::vector<int>>(md, channel);
+    PrintFlagHits(md, field_name, flag_values, domain, total_flag_counts);
+    EndFlag();
+    return total_flag_counts;
+}
+
+void Reductions::PrintFlagHits(MeshData<Real> *md, const std::string& field_name, const std::map<int, std::string> &flag_values,
+                               IndexDomain domain, const std::vector<int> &total_flag_counts)
+{
     const auto& pmesh = md->GetMeshPointer();
     const auto& verbose = pmesh->packages.Get("Globals")->Param<int>("flag_verbose");
 
-    // Get the relevant reducer and result
-    auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
-    auto *vector_int_reduce_pool = pars.GetMutable<std::vector<Reduce<std::vector<int>>>>("vector_int_reduce_pool");
-    auto& vector_int_reduce = (*vector_int_reduce_pool)[channel];
-
-    while (vector_int_reduce.CheckReduce() == TaskStatus::incomplete);
-    const std::vector<int> &total_flag_counts = vector_int_reduce.val;
-
     // Print flags 
     if (total_flag_counts[0] > 0 && verbose > 0) {
         if (MPIRank0()) {
@@ -196,7 +570,33 @@ std::vector<int> Reductions::CheckFlagReduceAndPrintHits(MeshData<Real> *md, std
             }
         }
     }
+}
+
+void Reductions::FinishFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values,
+                                  IndexDomain domain, bool is_bitflag, Channel channel)
+{
+    auto pmesh = md->GetMeshPointer();
+    if (!pmesh->packages.Get("Driver")->Param<bool>("async_flags")) {
+        CheckFlagReduceAndPrintHits(md, field_name, flag_values, domain, is_bitflag, channel);
+        return;
+    }
+    auto *deferred = pmesh->packages.Get("Reductions")->AllParams().GetMutable<std::vector<DeferredFlagReduce>>("deferred_flag_reduces");
+    // A channel restarted before its check (e.g. by another partition) only prints its latest result
+    for (auto &d : *deferred)
+        if (d.channel == channel) return;
+    deferred->push_back(DeferredFlagReduce{field_name, flag_values, domain, channel});
+}
 
-    EndFlag();
-    return total_flag_counts;
+TaskStatus Reductions::CheckDeferredFlagReduces(MeshData<Real> *md)
+{
+    auto *deferred = md->GetMeshPointer()->packages.Get("Reductions")->AllParams().GetMutable<std::vector<DeferredFlagReduce>>("deferred_flag_reduces");
+    for (auto it = deferred->begin(); it != deferred->end();) {
+        if (Poll<std::vector<int>>(it->channel) == TaskStatus::complete) {
+            PrintFlagHits(md, it->field_name, it->flag_values, it->domain, Channels().Get<std::vector<int>>(it->channel).val);
+            it = deferred->erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return deferred->empty() ? TaskStatus::complete : TaskStatus::incomplete;
 }
@@ -41,8 +41,56 @@
 
 namespace Reductions {
 
-// Think about how to do channels as not ints
-//constexpr enum class Channel{fflag, pflag, iflag, };
+/**
+ * MPI reduction channels.  Each use of a reduction which may be in flight alongside others gets its own,
+ * so that e.g. flag counts started at the end of a step never share a reducer with the timestep.
+ * Add new channels before 'count'
+ */
+enum class Channel : int {none=-1, fflag, pflag, fofcflag, solve_fail, solve_stats, inverter_iters,
+                          nan_ctop, zero_ctop, neg_rho, neg_u, neg_rhout, divb, dt,
+                          solve_nactive, solve_norm, solve_nfails, solve_iters, solve_time, health, count};
+constexpr int NCHANNELS = static_cast<int>(Channel::count);
+
+/**
+ * Typed registry of reducers, preallocated with one of each type for every channel.
+ * Owned by the Reductions package, so that reducers are cleaned up before MPI is finalized.
+ */
+class ReductionChannels {
+    public:
+        template<typename T>
+        Reduce<T>& Get(Channel channel)
+        {
+            const int c = static_cast<int>(channel);
+            if constexpr (std::is_same<T, Real>::value) return reduce[c];
+            if constexpr (std::is_same<T, int>::value) return int_reduce[c];
+            if constexpr (std::is_same<T, std::vector<Real>>::value) return vector_reduce[c];
+            if constexpr (std::is_same<T, std::vector<int>>::value) return vector_int_reduce[c];
+        }
+        template<typename T>
+        AllReduce<T>& GetAll(Channel channel)
+        {
+            const int c = static_cast<int>(channel);
+            if constexpr (std::is_same<T, Real>::value) return allreduce[c];
+            if constexpr (std::is_same<T, int>::value) return int_allreduce[c];
+            if constexpr (std::is_same<T, std::vector<Real>>::value) return vector_allreduce[c];
+            if constexpr (std::is_same<T, std::vector<int>>::value) return vector_int_allreduce[c];
+        }
+
+    private:
+        std::array<Reduce<Real>, NCHANNELS> reduce;
+        std::array<Reduce<int>, NCHANNELS> int_reduce;
+        std::array<Reduce<std::vector<Real>>, NCHANNELS> vector_reduce;
+        std::array<Reduce<std::vector<int>>, NCHANNELS> vector_int_reduce;
+        std::array<AllReduce<Real>, NCHANNELS> allreduce;
+        std::array<AllReduce<int>, NCHANNELS> int_allreduce;
+        std::array<AllReduce<std::vector<Real>>, NCHANNELS> vector_allreduce;
+        std::array<AllReduce<std::vector<int>>, NCHANNELS> vector_int_allreduce;
+};
+
+/**
+ * The Reductions package's channel registry, without looking up the package or its params
+ */
+ReductionChannels& Channels();
 
 /**
  * These, too, are a package.
@@ -58,15 +106,15 @@ std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<P
  * Just set equal min/max, 2D slices are detected
  */
 template<Var var, typename T>
-T DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const GReal startx[3], const GReal stopx[3], int channel=-1);
+T DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const GReal startx[3], const GReal stopx[3], Channel channel=Channel::none);
 template<Var var, typename T>
-T DomainReduction(MeshData<Real> *md, UserHistoryOperation op, int channel=-1) {
+T DomainReduction(MeshData<Real> *md, UserHistoryOperation op, Channel channel=Channel::none) {
     const GReal startx[3] = {std::numeric_limits<GReal>::min(), std::numeric_limits<GReal>::min(), std::numeric_limits<GReal>::min()};
     const GReal stopx[3] = {std::numeric_limits<GReal>::max(), std::numeric_limits<GReal>::max(), std::numeric_limits<GReal>::max()};
     return DomainReduction<var, T>(md, op, startx, stopx, channel);
 }
 template<Var var, typename T>
-T ShellReduction(MeshData<Real> *md, UserHistoryOperation op, GReal r, int channel=-1) {
+T ShellReduction(MeshData<Real> *md, UserHistoryOperation op, GReal r, Channel channel=Channel::none) {
     const GReal startx[3] = {r, std::numeric_limits<GReal>::min(), std::numeric_limits<GReal>::min()};
     const GReal stopx[3] = {r, std::numeric_limits<GReal>::max(), std::numeric_limits<GReal>::max()};
     return DomainReduction<var, T>(md, op, startx, stopx, channel);
@@ -96,31 +144,178 @@ Real Total(MeshData<Real> *md)
     return Reductions::DomainReduction<var, Real>(md, UserHistoryOperation::sum);
 }
 
+/**
+ * Blocks and X1 indices of the layers of zones lying on any of a set of shells.
+ * Shell reductions launch only over these, rather than testing every zone of the mesh.
+ */
+struct ShellLayers {
+    ParArray1D<int> block, i;
+    int n = 0;
+    std::vector<LogicalLocation> locs;
+};
+/**
+ * Get (or build) the shell layers of md for the given radii, kept per-partition.
+ * Returns false in non-spherical coordinates, where shells must be found by testing every zone.
+ */
+bool GetShellLayers(MeshData<Real> *md, const std::vector<GReal>& radii, ShellLayers& layers);
+
+// Maximum number of regions (shells or domains) reduced over in one batch
+#define MAX_BATCH_REGIONS 3
+
+/**
+ * Regions for a batched reduction, each as for DomainReduction.
+ * All regions in a batch must share the same trivial (2D-slice) dimensions.
+ */
+struct BatchRegions {
+    int n;
+    bool trivial[3];
+    GReal startx[MAX_BATCH_REGIONS][3];
+    GReal stopx[MAX_BATCH_REGIONS][3];
+};
+enum class BatchRegion{shells, total};
+// The shells at r_in, the EH, and 5M, as in SumAt0/SumAtEH/SumAt5M
+BatchRegions StandardShells(MeshData<Real> *md);
+// The whole domain, as in Total
+BatchRegions WholeDomain();
+
+/**
+ * Sum each of several variables over each of several regions, in a single sweep of the mesh.
+ * Returns results ordered by variable, then region, i.e. [v*regions.n + s].
+ * Optionally starts a single vector MPI reduction of all results on 'channel'
+ */
+template<Var... vars>
+std::vector<Real> BatchedReduction(MeshData<Real> *md, const BatchRegions& regions, Channel channel=Channel::none);
+
+/**
+ * Element 'idx' of a batched reduction over the given region type.
+ * The first variable of a batch (idx 0) performs the sweep for each partition,
+ * and the rest of the batch reads the cached results, so register batches with AddBatchedHistory.
+ */
+template<Var... vars>
+Real BatchedHistoryValue(MeshData<Real> *md, const std::string& name, BatchRegion region, int idx)
+{
+    auto *results = GetPartitionParam<std::map<std::string, std::vector<Real>>>(md, "Reductions", "batch_results");
+    auto& result = (*results)[name];
+    if (idx == 0 || result.size() <= idx)
+        result = BatchedReduction<vars...>(md, (region == BatchRegion::shells) ? StandardShells(md) : WholeDomain());
+    return result[idx];
+}
+
+/**
+ * Add history outputs for each of 'vars' over each region, computed together in one sweep per history step.
+ * Labels are ordered as the results, by variable and then region.
+ */
+template<Var... vars>
+void AddBatchedHistory(parthenon::HstVar_list& hst_vars, const std::string& name, BatchRegion region,
+                       const std::vector<std::string>& labels)
+{
+    const int nregion = (region == BatchRegion::shells) ? 3 : 1;
+    if (labels.size() != sizeof...(vars) * nregion)
+        throw std::invalid_argument("Batched history "+name+" needs one label per variable and region!");
+    for (int idx = 0; idx < labels.size(); idx++) {
+        hst_vars.emplace_back(parthenon::HistoryOutputVar(UserHistoryOperation::sum,
+            [name, region, idx](MeshData<Real> *md) { return BatchedHistoryValue<vars...>(md, name, region, idx); },
+            labels[idx]));
+    }
+}
+
+/**
+ * Electron adiabatic index, for reductions of the electron temperature.
+ * Defaults to 4/3 like the Electrons package, so variables can be reduced without it
+ */
+inline Real ElectronGamma(Mesh *pmesh)
+{
+    return (pmesh->packages.AllPackages().count("Electrons")) ?
+        pmesh->packages.Get("Electrons")->Param<Real>("gamma_e") : 4./3;
+}
+
+// Maximum number of bins in a histogram
+#define MAX_HIST_BINS 64
+
+/**
+ * Bins of a histogram: nbins spanning [min, max), spaced logarithmically if 'log'.
+ * Bin b starts at min*(max/min)^(b/nbins), or min + (max-min)*b/nbins.
+ * Values outside the range (or NaN) are counted in the first or last bin.
+ */
+struct HistogramBins {
+    Real min, max;
+    int nbins;
+    bool log;
+};
+KOKKOS_INLINE_FUNCTION int hist_bin(const Real& val, const HistogramBins& bins)
+{
+    if (!(val > bins.min)) return 0;
+    const Real f = (bins.log) ? m::log(val / bins.min) / m::log(bins.max / bins.min)
+                              : (val - bins.min) / (bins.max - bins.min);
+    return (f < 1.) ? static_cast<int>(f * bins.nbins) : bins.nbins - 1;
+}
+
+/**
+ * Count the interior zones of md in each bin of a variable's values, on the device.
+ */
+template<Var var>
+std::vector<Real> Histogram(MeshData<Real> *md, const HistogramBins& bins);
+/**
+ * Count the interior zones of md in each bin of a (scalar) field's values, e.g. inverter_iters
+ */
+std::vector<Real> FieldHistogram(MeshData<Real> *md, const std::string& field_name, const HistogramBins& bins);
+
+/**
+ * Bin b of the histogram of the named variable (as listed in <histograms>variables) over md.
+ * As with batches, bin 0 computes the whole histogram for each partition and the other bins read it
+ */
+Real HistogramValue(MeshData<Real> *md, const std::string& name, const HistogramBins& bins, int b);
+
 /**
  * Start reductions with a value you have on hand
  */
 template<typename T>
-void Start(MeshData<Real> *md, int channel, T val, MPI_Op op);
+void Start(MeshData<Real> *md, Channel channel, T val, MPI_Op op);
 template<typename T>
-void StartToAll(MeshData<Real> *md, int channel, T val, MPI_Op op);
+void StartToAll(MeshData<Real> *md, Channel channel, T val, MPI_Op op);
 
 /**
- * Check the results of reductions that have been started.
- * Remember channels are COUNTED SEPARATELY between the 4 lists:
- * Real/default, int, vector<Real> and vector<int> (i.e. Flags)
+ * Check the results of reductions that have been started on a channel.
+ * The channel and type must match those the reduction was started with.
  */
 template<typename T>
-T Check(MeshData<Real> *md, int channel);
+T Check(MeshData<Real> *md, Channel channel);
 template<typename T>
-T CheckOnAll(MeshData<Real> *md, int channel);
+T CheckOnAll(MeshData<Real> *md, Channel channel);
 
 /**
- * Check the results of reductions that have been started.
- * Remember channels are COUNTED SEPARATELY between the 4 lists:
- * Real/default, int, vector<Real> and vector<int> (i.e. Flags)
+ * Non-blocking versions of the above, to be polled from a task: return incomplete until the
+ * reduction has finished, so that other tasks proceed meanwhile.  Read the result with Check/CheckOnAll
  */
 template<typename T>
-T Check(MeshData<Real> *md, int channel);
+TaskStatus Poll(Channel channel);
+template<typename T>
+TaskStatus PollOnAll(Channel channel);
+
+// Maximum number of distinct flag values counted at once, including the total in element 0
+#define MAX_NFLAGS 20
+
+/**
+ * Device-side list of the values in a flag map, starting at index 1 to match the layout of counts below
+ */
+ParArray1D<int> FlagValueList(const std::map<int, std::string> &flag_values);
+
+/**
+ * Add one zone's flag to running counts: element 0 counts all nonzero (>0) flags,
+ * and each later element counts zones matching the corresponding entry of flag_val_list.
+ * This lets kernels which already set a flag count it in passing, rather than sweeping again.
+ */
+KOKKOS_INLINE_FUNCTION void TallyFlag(const int& flag_int, const ParArray1D<int>& flag_val_list, const int& n_of_flags,
+                                      const bool& is_bitflag, array_type<int, MAX_NFLAGS>& local_result)
+{
+    // First element is total count
+    if (flag_int > 0) ++local_result.my_array[0];
+    // The rest of the list is individual flags
+    for (int f=1; f <= n_of_flags; f++)
+        if ((is_bitflag && flag_int & flag_val_list(f)) ||
+            (!is_bitflag && flag_int == flag_val_list(f)))
+            ++local_result.my_array[f];
+}
 
 /**
  * Count instances of a particular flag value in the named field.
@@ -136,16 +331,98 @@ int CountFlag(MeshData<Real> *md, std::string field_name, const int& flag_val, I
  */
 std::vector<int> CountFlags(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag);
 
+/**
+ * Health checks: zones with a NaN or zero signal speed, negative rho/u/conserved rho, or NaN primitives.
+ * These are fused in one kernel, over either the full mesh or a sample of blocks, see HealthChecks
+ */
+enum class Health : int {nan_ctop=0, zero_ctop, neg_rho, neg_u, neg_rhout, nan_prim, count};
+constexpr int NHEALTH = static_cast<int>(Health::count);
+
+/**
+ * Count zones failing each health check, over only the listed blocks (indices into md)
+ */
+std::vector<int> CountUnhealthy(MeshData<Real> *md, const std::vector<int>& blocks);
+
+/**
+ * Run the health checks each step (see <debug>health_checks).  Each step checks a random fraction
+ * of blocks, and every health_full_interval steps checks the whole mesh.  If a sample finds anything,
+ * the whole mesh is checked immediately, and results are reported as by the full checks with extra_checks.
+ * Zero or NaN ctop stops the simulation.
+ */
+TaskStatus HealthChecks(const SimTime& tm, MeshData<Real> *md);
+
+/**
+ * A flag field and its values, for counting several fields in one sweep
+ */
+struct FlagField {
+    std::string name;
+    std::map<int, std::string> flag_values;
+    bool is_bitflag;
+};
+// Maximum number of flag fields counted in one sweep
+#define MAX_FLAG_FIELDS 4
+
+/**
+ * Count instances of all flags in each of several fields, in a single sweep of the mesh.
+ * Returns counts for each field in the layout of CountFlags
+ */
+std::vector<std::vector<int>> CountFlagFields(MeshData<Real> *md, const std::vector<FlagField> &fields, IndexDomain domain);
+
+/**
+ * Record flag counts tallied in passing by another kernel (with TallyFlag) for md's partition,
+ * under 'name', a mutable std::map<int, std::vector<int>> param of 'package'.
+ * Later calls on the same partition replace earlier ones, so the counts reflect the final state.
+ */
+void RecordFlagCounts(MeshData<Real> *md, const std::string& package, const std::string& name,
+                      const array_type<int, MAX_NFLAGS>& counts, int n_of_flags);
+/**
+ * Sum any counts recorded with RecordFlagCounts over partitions, clear them,
+ * and send the total over MPI reducer 'channel'.  Returns false if nothing was recorded,
+ * in which case the flags must be counted with StartFlagReduce
+ */
+bool StartRecordedFlagReduce(MeshData<Real> *md, const std::string& package, const std::string& name,
+                             int n_of_flags, Channel channel);
+
 /**
  * Determine number of local flags hit with CountFlags, and send the value over MPI reducer 'channel'
  */
-void StartFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag, int channel);
+void StartFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values, IndexDomain domain, bool is_bitflag, Channel channel);
 
 /**
  * Check a flag's MPI reduction and print any flags hit
  */
 std::vector<int> CheckFlagReduceAndPrintHits(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values,
-                                             IndexDomain domain, bool is_bitflag, int channel);
+                                             IndexDomain domain, bool is_bitflag, Channel channel);
+
+/**
+ * Print the flags hit, given their total counts
+ */
+void PrintFlagHits(MeshData<Real> *md, const std::string& field_name, const std::map<int, std::string> &flag_values,
+                   IndexDomain domain, const std::vector<int> &total_flag_counts);
+
+/**
+ * A flag reduction which has been started, but whose result will only be printed once it arrives
+ */
+struct DeferredFlagReduce {
+    std::string field_name;
+    std::map<int, std::string> flag_values;
+    IndexDomain domain;
+    Channel channel;
+};
+
+/**
+ * Finish a flag reduction started with StartFlagReduce, printing any flags hit.
+ * With <driver>async_flags, rather than waiting on the result here, leave it to CheckDeferredFlagReduces,
+ * which the driver runs as a task alongside the next step's boundary communication.
+ */
+void FinishFlagReduce(MeshData<Real> *md, std::string field_name, const std::map<int, std::string> &flag_values,
+                      IndexDomain domain, bool is_bitflag, Channel channel);
+
+/**
+ * Print any deferred flag reductions which have completed.
+ * Returns incomplete until all of them have, so the task is retried while other work proceeds.
+ */
+TaskStatus CheckDeferredFlagReduces(MeshData<Real> *md);
 
 } // namespace Reductions
 
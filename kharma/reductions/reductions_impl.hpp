@@ -40,84 +40,67 @@
 // Satisfy IDE parsers who aren't wise to our schemes
 #include "reductions.hpp"
 
-template<typename T, bool all_reduce>
-inline std::string GetPoolName()
+namespace Reductions {
+/**
+ * Spin until a reducer's MPI reduction (if any) has finished, recording the time as MPI wait
+ */
+template<typename Reducer>
+inline void WaitFor(Reducer& reducer)
 {
-    if constexpr (all_reduce) {
-        if constexpr (std::is_same<T, Real>::value)
-            return "allreduce_pool";
-        if constexpr (std::is_same<T, int>::value)
-            return "int_allreduce_pool";
-        if constexpr (std::is_same<T, std::vector<Real>>::value)
-            return "vector_allreduce_pool";
-        if constexpr (std::is_same<T, std::vector<int>>::value)
-            return "vector_int_allreduce_pool";
-    } else {
-        if constexpr (std::is_same<T, Real>::value)
-            return "reduce_pool";
-        if constexpr (std::is_same<T, int>::value)
-            return "int_reduce_pool";
-        if constexpr (std::is_same<T, std::vector<Real>>::value)
-            return "vector_reduce_pool";
-        if constexpr (std::is_same<T, std::vector<int>>::value)
-            return "vector_int_reduce_pool";
-    }
+    if (reducer.CheckReduce() == TaskStatus::complete) return;
+    if (WaitTimer::enabled) WaitTimer::BeginWait();
+    while (reducer.CheckReduce() == TaskStatus::incomplete);
+    if (WaitTimer::enabled) WaitTimer::EndWait();
+}
 }
 
 // MPI reduction starts
 template<typename T>
-void Reductions::Start(MeshData<Real> *md, int channel, T val, MPI_Op op)
+void Reductions::Start(MeshData<Real> *md, Channel channel, T val, MPI_Op op)
 {
-    // Get the relevant reducer
-    const std::string pool_name = GetPoolName<T, false>();
-    auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
-    auto *reduce_pool = pars.GetMutable<std::vector<Reduce<T>>>(pool_name);
-    while (reduce_pool->size() <= channel) reduce_pool->push_back(Reduce<T>());
-    auto& reduce = (*reduce_pool)[channel];
-    // Fill with flags
+    auto& reduce = Channels().Get<T>(channel);
+    // Never restart a reducer which is still in flight
+    WaitFor(reduce);
     reduce.val = val;
     reduce.StartReduce(0, op);
 }
 template<typename T>
-void Reductions::StartToAll(MeshData<Real> *md, int channel, T val, MPI_Op op)
+void Reductions::StartToAll(MeshData<Real> *md, Channel channel, T val, MPI_Op op)
 {
-    // Get the relevant reducer
-    const std::string pool_name = GetPoolName<T, true>();
-    auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
-    auto *allreduce_pool = pars.GetMutable<std::vector<AllReduce<T>>>(pool_name);
-    while (allreduce_pool->size() <= channel) allreduce_pool->push_back(AllReduce<T>());
-    auto& reduce = (*allreduce_pool)[channel];
-    // Fill with flags
+    auto& reduce = Channels().GetAll<T>(channel);
+    WaitFor(reduce);
     reduce.val = val;
     reduce.StartReduce(op);
 }
 
 // MPI reduction checks
 template<typename T>
-T Reductions::Check(MeshData<Real> *md, int channel)
+T Reductions::Check(MeshData<Real> *md, Channel channel)
 {
-    // Get the relevant reducer and result
-    const std::string pool_name = GetPoolName<T, false>();
-    auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
-    auto *reduce_pool = pars.GetMutable<std::vector<Reduce<T>>>(pool_name);
-    auto& reducer = (*reduce_pool)[channel];
-
-    while (reducer.CheckReduce() == TaskStatus::incomplete);
+    auto& reducer = Channels().Get<T>(channel);
+    WaitFor(reducer);
     return reducer.val;
 }
 template<typename T>
-T Reductions::CheckOnAll(MeshData<Real> *md, int channel)
+T Reductions::CheckOnAll(MeshData<Real> *md, Channel channel)
 {
-    // Get the relevant reducer and result
-    const std::string pool_name = GetPoolName<T, true>();
-    auto& pars = md->GetMeshPointer()->packages.Get("Reductions")->AllParams();
-    auto *reduce_pool = pars.GetMutable<std::vector<AllReduce<T>>>(pool_name);
-    auto& reducer = (*reduce_pool)[channel];
-
-    while (reducer.CheckReduce() == TaskStatus::incomplete);
+    auto& reducer = Channels().GetAll<T>(channel);
+    WaitFor(reducer);
     return reducer.val;
 }
 
+// Non-blocking checks
+template<typename T>
+TaskStatus Reductions::Poll(Channel channel)
+{
+    return Channels().Get<T>(channel).CheckReduce();
+}
+template<typename T>
+TaskStatus Reductions::PollOnAll(Channel channel)
+{
+    return Channels().GetAll<T>(channel).CheckReduce();
+}
+
 #define INSIDE (x[1] > startx1 && x[2] > startx2 && x[3] > startx3) && \
                 (trivial1 ? xin[1] < startx1 : x[1] < stopx1) && \
                 (trivial2 ? xin[2] < startx2 : x[2] < stopx2) && \
@@ -125,13 +108,14 @@ T Reductions::CheckOnAll(MeshData<Real> *md, int channel)
 
 // TODO additionally template on return type to avoid counting flags with Reals
 template<Reductions::Var var, typename T>
-T Reductions::DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const GReal startx[3], const GReal stopx[3], int channel)
+T Reductions::DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const GReal startx[3], const GReal stopx[3], Channel channel)
 {
     Flag("DomainReduction");
     auto pmesh = md->GetMeshPointer();
 
     const auto& pars = pmesh->packages.Get("GRMHD")->AllParams();
     const Real gam = pars.Get<Real>("gamma");
+    const Real game = ElectronGamma(pmesh);
     const auto& emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
 
     // Just pass in everything we might want. Probably slow?
@@ -169,20 +153,41 @@ T Reductions::DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const
     switch(op) {
     case UserHistoryOperation::sum: {
         Kokkos::Sum<T> sum_reducer(result);
-        // TODO these should be nested parallel loops to skip blocks fully outside domain
-        pmb0->par_reduce("domain_sum", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i, T &local_result) {
-                const auto& G = U.GetCoords(b);
-                GReal x[GR_DIM], xin[GR_DIM];
-                G.coord_embed(k, j, i, Loci::center, x);
-                if (trivial1 || trivial2 || trivial3)
-                    G.coord_embed(k - trivial3, j - trivial2, i - trivial1, Loci::center, xin);
-                if(INSIDE) {
-                    local_result += reduction_var<var>(REDUCE_FUNCTION_CALL) *
-                        ((trivial3) ? 1. : G.Dxc<3>(k)) * ((trivial2) ? 1. : G.Dxc<2>(j)) * ((trivial1) ? 1. : G.Dxc<1>(i));
-                }
+        ShellLayers layers;
+        if (trivial1 && !trivial2 && !trivial3 && GetShellLayers(md, {startx1}, layers)) {
+            // Shells: launch only over the layers of zones on the shell
+            const auto layer_b = layers.block;
+            const auto layer_i = layers.i;
+            if (layers.n > 0) {
+                pmb0->par_reduce("shell_sum", 0, layers.n - 1, kb.s, kb.e, jb.s, jb.e,
+                    KOKKOS_LAMBDA (const int &l, const int &k, const int &j, T &local_result) {
+                        const int b = layer_b(l);
+                        const int i = layer_i(l);
+                        const auto& G = U.GetCoords(b);
+                        GReal x[GR_DIM], xin[GR_DIM];
+                        G.coord_embed(k, j, i, Loci::center, x);
+                        G.coord_embed(k, j, i - 1, Loci::center, xin);
+                        if(INSIDE) {
+                            local_result += reduction_var<var>(REDUCE_FUNCTION_CALL) * G.Dxc<3>(k) * G.Dxc<2>(j);
+                        }
+                    }
+                , sum_reducer);
             }
-        , sum_reducer);
+        } else {
+            pmb0->par_reduce("domain_sum", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+                KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i, T &local_result) {
+                    const auto& G = U.GetCoords(b);
+                    GReal x[GR_DIM], xin[GR_DIM];
+                    G.coord_embed(k, j, i, Loci::center, x);
+                    if (trivial1 || trivial2 || trivial3)
+                        G.coord_embed(k - trivial3, j - trivial2, i - trivial1, Loci::center, xin);
+                    if(INSIDE) {
+                        local_result += reduction_var<var>(REDUCE_FUNCTION_CALL) *
+                            ((trivial3) ? 1. : G.Dxc<3>(k)) * ((trivial2) ? 1. : G.Dxc<2>(j)) * ((trivial1) ? 1. : G.Dxc<1>(i));
+                    }
+                }
+            , sum_reducer);
+        }
         mop = MPI_SUM;
         break;
     }
@@ -227,7 +232,7 @@ T Reductions::DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const
     }
 
     // Optionally start an MPI reducer w/given index, so the mesh-wide result is ready when we want it
-    if (channel >= 0) {
+    if (channel != Channel::none) {
         Start<T>(md, channel, result, mop);
     }
 
@@ -235,6 +240,151 @@ T Reductions::DomainReduction(MeshData<Real> *md, UserHistoryOperation op, const
     return result;
 }
 
+namespace Reductions {
+// Add one zone's contribution of each variable to each region it lies inside
+template<int N, Var var, Var... rest>
+KOKKOS_INLINE_FUNCTION void tally_batch(REDUCE_FUNCTION_ARGS, const int& v, const int& nregion, const bool inside[],
+                                        const Real& weight, array_type<Real, N>& local_result)
+{
+    const Real val = reduction_var<var>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i) * weight;
+    for (int s = 0; s < nregion; s++)
+        if (inside[s]) local_result.my_array[v*nregion + s] += val;
+    if constexpr (sizeof...(rest) > 0)
+        tally_batch<N, rest...>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i, v+1, nregion, inside, weight, local_result);
+}
+} // namespace Reductions
+
+template<Reductions::Var... vars>
+std::vector<Real> Reductions::BatchedReduction(MeshData<Real> *md, const BatchRegions& regions, Channel channel)
+{
+    Flag("BatchedReduction");
+    constexpr int NVAR = sizeof...(vars);
+    constexpr int N = NVAR * MAX_BATCH_REGIONS;
+    auto pmesh = md->GetMeshPointer();
+
+    const auto& pars = pmesh->packages.Get("GRMHD")->AllParams();
+    const Real gam = pars.Get<Real>("gamma");
+    const Real game = ElectronGamma(pmesh);
+    const auto& emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const auto& U = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const auto& cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+    const auto& cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    IndexRange ib = pmb0->cellbounds.GetBoundsI(IndexDomain::interior);
+    IndexRange jb = pmb0->cellbounds.GetBoundsJ(IndexDomain::interior);
+    IndexRange kb = pmb0->cellbounds.GetBoundsK(IndexDomain::interior);
+    IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+
+    // Copy to capture on device
+    const BatchRegions r = regions;
+    const int nregion = regions.n;
+    const bool trivial1 = regions.trivial[0];
+    const bool trivial2 = regions.trivial[1];
+    const bool trivial3 = regions.trivial[2];
+
+    // Shells: launch only over the layers of zones on any shell
+    ShellLayers layers;
+    bool use_layers = false;
+    if (trivial1 && !trivial2 && !trivial3) {
+        std::vector<GReal> radii;
+        for (int s = 0; s < nregion; s++) radii.push_back(regions.startx[s][0]);
+        use_layers = GetShellLayers(md, radii, layers);
+    }
+    const auto layer_b = layers.block;
+    const auto layer_i = layers.i;
+
+    // Locate the zone once, and compute each variable only if it's needed
+#define TALLY_ZONE \
+            const auto& G = U.GetCoords(b); \
+            GReal x[GR_DIM], xin[GR_DIM]; \
+            G.coord_embed(k, j, i, Loci::center, x); \
+            if (trivial1 || trivial2 || trivial3) \
+                G.coord_embed(k - trivial3, j - trivial2, i - trivial1, Loci::center, xin); \
+            bool inside[MAX_BATCH_REGIONS]; \
+            bool any = false; \
+            for (int s = 0; s < nregion; s++) { \
+                const GReal startx1 = r.startx[s][0], startx2 = r.startx[s][1], startx3 = r.startx[s][2]; \
+                const GReal stopx1 = r.stopx[s][0], stopx2 = r.stopx[s][1], stopx3 = r.stopx[s][2]; \
+                inside[s] = INSIDE; \
+                any = any || inside[s]; \
+            } \
+            if (any) { \
+                const Real weight = ((trivial3) ? 1. : G.Dxc<3>(k)) * ((trivial2) ? 1. : G.Dxc<2>(j)) * ((trivial1) ? 1. : G.Dxc<1>(i)); \
+                tally_batch<N, vars...>(REDUCE_FUNCTION_CALL, 0, nregion, inside, weight, local_result); \
+            }
+
+    array_type<Real, N> batch_result;
+    if (use_layers) {
+        if (layers.n > 0) {
+            pmb0->par_reduce("batched_shell_reduction", 0, layers.n - 1, kb.s, kb.e, jb.s, jb.e,
+                KOKKOS_LAMBDA (const int &l, const int &k, const int &j, array_type<Real, N> &local_result) {
+                    const int b = layer_b(l);
+                    const int i = layer_i(l);
+                    TALLY_ZONE
+                }
+            , ArraySum<Real, HostExecSpace, N>(batch_result));
+        }
+    } else {
+        pmb0->par_reduce("batched_reduction", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i, array_type<Real, N> &local_result) {
+                TALLY_ZONE
+            }
+        , ArraySum<Real, HostExecSpace, N>(batch_result));
+    }
+#undef TALLY_ZONE
+
+    std::vector<Real> result(batch_result.my_array, batch_result.my_array + NVAR * nregion);
+
+    // Optionally start one MPI reducer for the whole batch
+    if (channel != Channel::none) {
+        Start<std::vector<Real>>(md, channel, result, MPI_SUM);
+    }
+
+    EndFlag();
+    return result;
+}
+
+template<Reductions::Var var>
+std::vector<Real> Reductions::Histogram(MeshData<Real> *md, const HistogramBins& bins)
+{
+    Flag("Histogram");
+    auto pmesh = md->GetMeshPointer();
+
+    const auto& pars = pmesh->packages.Get("GRMHD")->AllParams();
+    const Real gam = pars.Get<Real>("gamma");
+    const Real game = ElectronGamma(pmesh);
+    const auto& emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
+
+    PackIndexMap prims_map, cons_map;
+    const auto& P = md->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const auto& U = md->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const auto& cmax = md->PackVariables(std::vector<std::string>{"Flux.cmax"});
+    const auto& cmin = md->PackVariables(std::vector<std::string>{"Flux.cmin"});
+
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    IndexRange ib = pmb0->cellbounds.GetBoundsI(IndexDomain::interior);
+    IndexRange jb = pmb0->cellbounds.GetBoundsJ(IndexDomain::interior);
+    IndexRange kb = pmb0->cellbounds.GetBoundsK(IndexDomain::interior);
+    IndexRange block = IndexRange{0, U.GetDim(5) - 1};
+
+    array_type<Real, MAX_HIST_BINS> hist_result;
+    pmb0->par_reduce("histogram", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA (const int &b, const int &k, const int &j, const int &i, array_type<Real, MAX_HIST_BINS> &local_result) {
+            const auto& G = U.GetCoords(b);
+            local_result.my_array[hist_bin(reduction_var<var>(REDUCE_FUNCTION_CALL), bins)] += 1.;
+        }
+    , ArraySum<Real, HostExecSpace, MAX_HIST_BINS>(hist_result));
+
+    EndFlag();
+    return std::vector<Real>(hist_result.my_array, hist_result.my_array + bins.nbins);
+}
+
 #undef INSIDE
 #undef REDUCE_FUNCTION_CALL
 #undef REDUCE_FUNCTION_ARGS
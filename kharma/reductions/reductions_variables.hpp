@@ -43,9 +43,10 @@
 #define REDUCE_FUNCTION_ARGS const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p, \
                         const VariableFluxPack<Real>& U, const VarMap& m_u, \
                         const VariablePack<Real>& cmax, const VariablePack<Real>& cmin,\
-                        const EMHD::EMHD_parameters& emhd_params, const Real& gam, const int& k, const int& j, const int& i
+                        const EMHD::EMHD_parameters& emhd_params, const Real& gam, const Real& game, \
+                        const int& k, const int& j, const int& i
 // Call for passing a particular block's values
-#define REDUCE_FUNCTION_CALL G, P(b), m_p, U(b), m_u, cmax(b), cmin(b), emhd_params, gam, k, j, i
+#define REDUCE_FUNCTION_CALL G, P(b), m_p, U(b), m_u, cmax(b), cmin(b), emhd_params, gam, game, k, j, i
 
 using namespace parthenon;
 
@@ -55,7 +56,7 @@ namespace Reductions {
 // Not elegant, but fast & portable.
 // HIPCC doesn't like passing function pointers as we used to do,
 // and it doesn't vectorize anyway. Look forward to more of this pattern in the code
-enum class Var{phi, bsq, gas_pressure, beta, rhou0, mix_T00, mix_T01, mix_T02, mix_T03,
+enum class Var{rho, u, phi, bsq, gas_pressure, beta, sigma, theta_e, rhou0, mix_T00, mix_T01, mix_T02, mix_T03,
                mdot, edot, ldot, mdot_flux, edot_flux, ldot_flux, eht_lum, jet_lum,
                nan_ctop, zero_ctop, neg_rho, neg_u, neg_rhout};
 
@@ -63,6 +64,18 @@ enum class Var{phi, bsq, gas_pressure, beta, rhou0, mix_T00, mix_T01, mix_T02, m
 template<Var T>
 KOKKOS_INLINE_FUNCTION Real reduction_var(REDUCE_FUNCTION_ARGS);
 
+// Primitive density and internal energy, for averages & profiles
+template <>
+KOKKOS_INLINE_FUNCTION Real reduction_var<Var::rho>(REDUCE_FUNCTION_ARGS)
+{
+    return P(m_p.RHO, k, j, i);
+}
+template <>
+KOKKOS_INLINE_FUNCTION Real reduction_var<Var::u>(REDUCE_FUNCTION_ARGS)
+{
+    return P(m_p.UU, k, j, i);
+}
+
 // Can also sum the hemispheres independently to be fancy (TODO?)
 template <>
 KOKKOS_INLINE_FUNCTION Real reduction_var<Var::phi>(REDUCE_FUNCTION_ARGS)
@@ -91,6 +104,26 @@ KOKKOS_INLINE_FUNCTION Real reduction_var<Var::beta>(REDUCE_FUNCTION_ARGS)
     GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
     return ((gam - 1) * P(m_p.UU, k, j, i))/(0.5*(dot(Dtmp.bcon, Dtmp.bcov) + SMALL));
 }
+template <>
+KOKKOS_INLINE_FUNCTION Real reduction_var<Var::sigma>(REDUCE_FUNCTION_ARGS)
+{
+    FourVectors Dtmp;
+    GRMHD::calc_4vecs(G, P, m_p, k, j, i, Loci::center, Dtmp);
+    return dot(Dtmp.bcon, Dtmp.bcov) / P(m_p.RHO, k, j, i);
+}
+// Dimensionless electron temperature, from the first electron model present (or 0 if none)
+template <>
+KOKKOS_INLINE_FUNCTION Real reduction_var<Var::theta_e>(REDUCE_FUNCTION_ARGS)
+{
+    constexpr Real MP_ME = 1836.15267343;
+    const int kel = (m_p.K_CONSTANT >= 0) ? m_p.K_CONSTANT :
+                    (m_p.K_HOWES >= 0) ? m_p.K_HOWES :
+                    (m_p.K_KAWAZURA >= 0) ? m_p.K_KAWAZURA :
+                    (m_p.K_WERNER >= 0) ? m_p.K_WERNER :
+                    (m_p.K_ROWAN >= 0) ? m_p.K_ROWAN : m_p.K_SHARMA;
+    if (kel < 0) return 0.;
+    return MP_ME * P(kel, k, j, i) * m::pow(P(m_p.RHO, k, j, i), game - 1.);
+}
 
 // Stuff that should be conserved
 template <>
@@ -279,5 +312,3 @@ KOKKOS_INLINE_FUNCTION Real reduction_var<Var::neg_rho>(REDUCE_FUNCTION_ARGS)
 }
 
 }
-
-#undef REDUCE_FUNCTION_ARGS
@@ -0,0 +1,135 @@
+/* 
+ *  File: region_timer.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "region_timer.hpp"
+
+#include "decs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+bool RegionTimer::enabled = false;
+bool RegionTimer::fence = false;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RegionStats {
+    double count = 0., total = 0., children = 0., max = 0.;
+};
+
+// Statistics by full region path, e.g. "Step/GetFlux"
+std::map<std::string, RegionStats> region_stats;
+// Currently open regions, with their paths & start times
+std::vector<std::pair<std::string, Clock::time_point>> open_regions;
+
+}
+
+void RegionTimer::Push(const std::string& label)
+{
+    if (fence) Kokkos::fence();
+    std::string path = open_regions.empty() ? label : open_regions.back().first + "/" + label;
+    open_regions.emplace_back(std::move(path), Clock::now());
+}
+
+void RegionTimer::Pop()
+{
+    if (open_regions.empty()) return;
+    if (fence) Kokkos::fence();
+    const double t = std::chrono::duration<double>(Clock::now() - open_regions.back().second).count();
+    auto& stats = region_stats[open_regions.back().first];
+    stats.count++;
+    stats.total += t;
+    stats.max = m::max(stats.max, t);
+    open_regions.pop_back();
+    if (!open_regions.empty()) region_stats[open_regions.back().first].children += t;
+}
+
+void RegionTimer::Print()
+{
+    // Rank 0's regions define the table.  Others may have called regions rank 0 didn't
+    // (or not called some), but the expensive ones are generally run everywhere
+    std::string paths;
+    for (auto& region : region_stats) paths += region.first + "\n";
+    int len = paths.size();
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Bcast(&len, 1, MPI_INT, 0, MPI_COMM_WORLD));
+    paths.resize(len);
+    PARTHENON_MPI_CHECK(MPI_Bcast(&paths[0], len, MPI_CHAR, 0, MPI_COMM_WORLD));
+#endif
+    std::vector<std::string> path_list;
+    for (size_t start = 0, end; (end = paths.find('\n', start)) != std::string::npos; start = end + 1)
+        path_list.push_back(paths.substr(start, end - start));
+    const int nregion = path_list.size();
+
+    // Sums: count, total, self.  Maxima: total, single call
+    std::vector<double> sums(3 * nregion, 0.), maxes(2 * nregion, 0.);
+    for (int n = 0; n < nregion; n++) {
+        if (!region_stats.count(path_list[n])) continue;
+        const auto& stats = region_stats.at(path_list[n]);
+        sums[3*n] = stats.count;
+        sums[3*n + 1] = stats.total;
+        sums[3*n + 2] = stats.total - stats.children;
+        maxes[2*n] = stats.total;
+        maxes[2*n + 1] = stats.max;
+    }
+    int nranks = 1;
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nranks));
+    if (MPIRank0()) {
+        PARTHENON_MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, sums.data(), sums.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+        PARTHENON_MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, maxes.data(), maxes.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD));
+    } else {
+        PARTHENON_MPI_CHECK(MPI_Reduce(sums.data(), nullptr, sums.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+        PARTHENON_MPI_CHECK(MPI_Reduce(maxes.data(), nullptr, maxes.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD));
+    }
+#endif
+
+    if (MPIRank0()) {
+        printf("Region timers over %d ranks%s:\n", nranks, fence ? "" : " (unfenced)");
+        printf("%-60s %12s %12s %12s %12s %12s\n", "region", "calls", "mean_s", "max_s", "self_s", "call_max_s");
+        for (int n = 0; n < nregion; n++) {
+            // Indent each region under its parent, and print only its own name
+            const std::string& path = path_list[n];
+            const int depth = std::count(path.begin(), path.end(), '/');
+            const size_t last = path.rfind('/');
+            const std::string name = std::string(2*depth, ' ') + ((last == std::string::npos) ? path : path.substr(last + 1));
+            printf("%-60s %12.0f %12.4g %12.4g %12.4g %12.4g\n", name.c_str(), sums[3*n] / nranks,
+                   sums[3*n + 1] / nranks, maxes[2*n], sums[3*n + 2] / nranks, maxes[2*n + 1]);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/* 
+ *  File: region_timer.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * Lightweight wall-clock timers for each region marked by Flag()/EndFlag().
+ *
+ * When enabled with <debug>region_timers, each region records its call count, total and
+ * maximum time, keyed by its full path of enclosing regions.  Time spent in a region but
+ * outside any of its sub-regions (host work, launches, waiting) is reported as its "self" time.
+ * Kernel launches are asynchronous, so unless <debug>region_timer_fence is set, device time
+ * is attributed to whichever region next waits on the device.
+ *
+ * The timers assume regions open and close on one host thread, as they do in KHARMA's drivers.
+ */
+namespace RegionTimer {
+
+// Checked on every Flag() call, so kept as a plain global
+extern bool enabled;
+// Whether to fence the device at region boundaries, for accurate attribution of kernels
+extern bool fence;
+
+/**
+ * Open and close a region.  Closing with no region open (e.g., one opened before timers
+ * were enabled) is ignored.
+ */
+void Push(const std::string& label);
+void Pop();
+
+/**
+ * Reduce region times over all ranks and print them from rank 0 as an indented table:
+ * mean calls per rank, mean & max total seconds per rank, mean self seconds, and max seconds in one call.
+ * Collective: must be called from every rank
+ */
+void Print();
+
+}
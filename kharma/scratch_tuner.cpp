@@ -0,0 +1,144 @@
+/* 
+ *  File: scratch_tuner.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "scratch_tuner.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#if defined(KOKKOS_ENABLE_CUDA)
+#include <cuda_runtime.h>
+#elif defined(KOKKOS_ENABLE_HIP)
+#include <hip/hip_runtime.h>
+#endif
+
+std::string ScratchTuner::DeviceName()
+{
+#if defined(KOKKOS_ENABLE_CUDA)
+    int dev = 0;
+    cudaDeviceProp prop;
+    cudaGetDevice(&dev);
+    cudaGetDeviceProperties(&prop, dev);
+    return std::string(prop.name);
+#elif defined(KOKKOS_ENABLE_HIP)
+    int dev = 0;
+    hipDeviceProp_t prop;
+    hipGetDevice(&dev);
+    hipGetDeviceProperties(&prop, dev);
+    return std::string(prop.name) + " " + std::string(prop.gcnArchName);
+#else
+    return std::string(Kokkos::DefaultExecutionSpace::name());
+#endif
+}
+
+ScratchTuner::Tuner ScratchTuner::Make(ParameterInput *pin, const std::string& block, const std::string& kernel)
+{
+    Tuner t;
+    t.kernel = kernel;
+    const std::string level = pin->GetOrAddString(block, "scratch_level", "1");
+    if (level == "auto") {
+        t.fixed_level = -1;
+    } else if (level == "0" || level == "1") {
+        t.fixed_level = std::stoi(level);
+    } else {
+        throw std::invalid_argument("Scratch level must be 0, 1, or auto! Got: " + level);
+    }
+    t.trials = pin->GetOrAddInteger(block, "tune_trials", 3);
+    if (t.trials < 1) throw std::invalid_argument("Must time each scratch level at least once!");
+    t.file = pin->GetOrAddString(block, "tune_file", "");
+
+    // Lines are: kernel n1 n2 n3 nvar level device name
+    if (t.fixed_level < 0 && t.file != "") {
+        const std::string device = DeviceName();
+        std::ifstream in(t.file);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            std::string k, dev;
+            Key key;
+            int lvl;
+            if (!(ls >> k >> key[0] >> key[1] >> key[2] >> key[3] >> lvl)) continue;
+            std::getline(ls >> std::ws, dev);
+            if (k == kernel && dev == device) t.chosen[key] = lvl;
+        }
+    }
+    return t;
+}
+
+bool ScratchTuner::Level(Tuner& t, const Key& key, const size_t& scratch_bytes, int& level)
+{
+    if (t.fixed_level >= 0) {
+        level = t.fixed_level;
+        return false;
+    }
+    auto it = t.chosen.find(key);
+    if (it == t.chosen.end() && scratch_bytes > Kokkos::TeamPolicy<>::scratch_size_max(0)) {
+        // Nothing to try
+        it = t.chosen.insert({key, 1}).first;
+    }
+    if (it != t.chosen.end()) {
+        level = it->second;
+        return false;
+    }
+    // Alternate levels until each has its trials
+    const auto& times = t.times[key];
+    level = (times[0].size() <= times[1].size()) ? 0 : 1;
+    return true;
+}
+
+void ScratchTuner::Record(Tuner& t, const Key& key, const int& level, const double& seconds)
+{
+    auto& times = t.times[key];
+    times[level].push_back(seconds);
+    if (times[0].size() < (size_t) t.trials || times[1].size() < (size_t) t.trials) return;
+
+    // The first call at each level may include one-time costs, so compare the fastest
+    const double t0 = *std::min_element(times[0].begin(), times[0].end());
+    const double t1 = *std::min_element(times[1].begin(), times[1].end());
+    const int best = (t0 < t1) ? 0 : 1;
+    t.chosen[key] = best;
+    t.times.erase(key);
+
+    if (MPIRank0()) {
+        std::cout << "Using scratch level " << best << " for " << t.kernel << " on "
+                  << key[0] << "x" << key[1] << "x" << key[2] << " blocks with " << key[3] << " variables"
+                  << " (" << t0 << "s vs " << t1 << "s)" << std::endl;
+        if (t.file != "") {
+            std::ofstream out(t.file, std::ios::app);
+            out << t.kernel << " " << key[0] << " " << key[1] << " " << key[2] << " " << key[3] << " "
+                << best << " " << DeviceName() << std::endl;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/* 
+ *  File: scratch_tuner.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Runtime choice of the team scratch level for a hierarchical kernel.
+ *
+ * Level 0 is on-chip shared memory: fast, but small enough that it limits how many teams can run
+ * at once.  Level 1 is in device memory.  Which is faster for a kernel depends on the device, the
+ * block size, and the number of variables, so it can be measured: with <block> scratch_level = auto,
+ * the first <block> tune_trials calls for each block size and variable count are timed with each
+ * level (where level 0 fits), and the faster is used thereafter.
+ *
+ * Choices are kept, keyed by device model, in <block> tune_file if it is set, and read back in
+ * later runs.  Team and vector sizes come from Parthenon's compile-time loop patterns, so they are
+ * not tuned.
+ */
+namespace ScratchTuner {
+
+// Block size and variable count: what determines the scratch size, and likely the best level
+using Key = std::array<int, 4>;
+
+struct Tuner {
+    std::string kernel;
+    // Level to use always, or -1 to tune
+    int fixed_level = 1;
+    int trials = 3;
+    std::string file;
+    std::map<Key, int> chosen;
+    std::map<Key, std::array<std::vector<double>, 2>> times;
+};
+
+/**
+ * Read <block> scratch_level, tune_trials & tune_file for the kernel named 'kernel', and load any
+ * choices for it on this device from the tune file
+ */
+Tuner Make(ParameterInput *pin, const std::string& block, const std::string& kernel);
+
+/**
+ * Pick the scratch level for the next call.  If this returns true, the call should be timed
+ * and reported with Record
+ */
+bool Level(Tuner& t, const Key& key, const size_t& scratch_bytes, int& level);
+
+/**
+ * Record the time of a call at 'level', choosing the best level once all trials are in
+ */
+void Record(Tuner& t, const Key& key, const int& level, const double& seconds);
+
+/**
+ * Name of the device kernels run on, e.g. "NVIDIA A100-SXM4-40GB"
+ */
+std::string DeviceName();
+
+}
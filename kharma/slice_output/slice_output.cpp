@@ -0,0 +1,312 @@
+/* 
+ *  File: slice_output.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "slice_output.hpp"
+
+#include "async_output.hpp"
+#include "domain.hpp"
+#include "hdf5_utils.h"
+#include "output_staging.hpp"
+
+using SliceOutput::Slice;
+
+namespace {
+
+// Each block's piece of a slice layer is described by 4 ints, sent ahead of the data:
+// slice, layer, and the global index of the piece's first zone along the slice's other direction & X1
+constexpr int piece_meta = 4;
+
+// Host copies of this rank's last pieces, which must persist until their sends complete
+std::vector<int> send_meta;
+OutputStaging::HostView<Real> send_data;
+#ifdef MPI_PARALLEL
+std::vector<MPI_Request> send_requests;
+#endif
+
+void WaitSends()
+{
+#ifdef MPI_PARALLEL
+    if (send_requests.size() > 0) {
+        PARTHENON_MPI_CHECK(MPI_Waitall(send_requests.size(), send_requests.data(), MPI_STATUSES_IGNORE));
+        send_requests.clear();
+    }
+#endif
+}
+
+// Direction spanned by a slice along with X1
+KOKKOS_INLINE_FUNCTION int other_dir(const int& dir) { return (dir == 2) ? 3 : 2; }
+
+}
+
+std::shared_ptr<KHARMAPackage> SliceOutput::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("SliceOutput");
+    Params &params = pkg->AllParams();
+
+    // Slices are taken at global indices, which we can only find simply without refinement
+    if (pin->GetOrAddString("parthenon/mesh", "refinement", "none") != "none")
+        throw std::invalid_argument("Slice output requires a mesh without refinement!");
+
+    // Which fields to slice.  Any cell-centered field Parthenon knows about
+    auto fields = pin->GetOrAddVector<std::string>("slice_output", "variables",
+                        std::vector<std::string>{"prims.rho", "prims.u"});
+    params.Add("fields", fields);
+
+    // Cadence in steps
+    const int dn = pin->GetOrAddInteger("slice_output", "dn", 10);
+    if (dn < 1) throw std::invalid_argument("Slice output requires slice_output/dn >= 1!");
+    params.Add("dn", dn);
+
+    // Global grid
+    const int n1 = pin->GetInteger("parthenon/mesh", "nx1");
+    const int n2 = pin->GetInteger("parthenon/mesh", "nx2");
+    const int n3 = pin->GetInteger("parthenon/mesh", "nx3");
+    params.Add("n1", n1);
+    params.Add("n2", n2);
+    params.Add("n3", n3);
+    for (std::string x : {"x1min", "x1max", "x2min", "x2max", "x3min", "x3max"})
+        params.Add(x, (GReal) pin->GetReal("parthenon/mesh", x));
+
+    // Which slices to take
+    auto slice_names = pin->GetOrAddVector<std::string>("slice_output", "slices",
+                        std::vector<std::string>{"midplane", "poloidal"});
+    std::vector<Slice> slices;
+    for (auto &name : slice_names) {
+        if (name == "midplane") {
+            if (n2 < 2) throw std::invalid_argument("Midplane slices require a mesh with nx2 > 1!");
+            slices.push_back(Slice{name, 2, {n2 / 2}});
+        } else if (name == "poloidal") {
+            slices.push_back(Slice{name, 3, (n3 > 1) ? std::vector<int>{0, n3 / 2} : std::vector<int>{0}});
+        } else {
+            throw std::invalid_argument("Unknown slice "+name+"! Use midplane or poloidal.");
+        }
+    }
+    params.Add("slices", slices);
+
+    pkg->PostStepDiagnosticsMesh = SliceOutput::ExtractAndWrite;
+    pkg->PostExecute = SliceOutput::PostExecute;
+
+    return pkg;
+}
+
+TaskStatus SliceOutput::ExtractAndWrite(const SimTime& tm, MeshData<Real> *md)
+{
+    auto pmesh = md->GetMeshPointer();
+    const auto& params = pmesh->packages.Get("SliceOutput")->AllParams();
+    // Parthenon advances tm.time & tm.ncycle only after the diagnostics, so these are after the step
+    const int ncycle = tm.ncycle + 1;
+    const int dn = params.Get<int>("dn");
+    if (ncycle % dn != 0) return TaskStatus::complete;
+    Flag("SliceOutput");
+
+    // Any last sends must be finished before we reuse their buffers
+    WaitSends();
+
+    const auto& fields = params.Get<std::vector<std::string>>("fields");
+    const auto& slices = params.Get<std::vector<Slice>>("slices");
+    const int nslice = slices.size();
+    const int n[GR_DIM] = {0, params.Get<int>("n1"), params.Get<int>("n2"), params.Get<int>("n3")};
+
+    // Zones per block & first interior index, by direction
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::interior);
+    const int nb1 = b.ie - b.is + 1, nb2 = b.je - b.js + 1, nb3 = b.ke - b.ks + 1;
+    const int nb[GR_DIM] = {0, nb1, nb2, nb3};
+    const int bs[GR_DIM] = {0, b.is, b.js, b.ks};
+
+    // Components of each field, in order
+    std::vector<std::string> comp_names;
+    std::vector<int> offsets;
+    for (auto &field : fields) {
+        const int nc = md->GetBlockData(0)->Get(field).GetDim(4);
+        offsets.push_back(comp_names.size());
+        for (int c = 0; c < nc; c++) comp_names.push_back((nc > 1) ? field + "_" + std::to_string(c) : field);
+    }
+    const int ncomp = comp_names.size();
+
+    // This rank's pieces: block, local index along the slice direction, the direction, and start in the buffer
+    send_meta.clear();
+    std::vector<int> pieces;
+    int size = 0;
+    const auto locs = PartitionLocations(md);
+    for (int s = 0; s < nslice; s++) {
+        const int d = slices[s].dir, a = other_dir(d);
+        for (int l = 0; l < slices[s].layers.size(); l++) {
+            for (int bl = 0; bl < md->NumBlocks(); bl++) {
+                const int lx[GR_DIM] = {0, (int) locs[bl].lx1(), (int) locs[bl].lx2(), (int) locs[bl].lx3()};
+                const int g = slices[s].layers[l] - lx[d] * nb[d];
+                if (g < 0 || g >= nb[d]) continue;
+                send_meta.insert(send_meta.end(), {s, l, lx[a] * nb[a], lx[1] * nb1});
+                pieces.insert(pieces.end(), {bl, bs[d] + g, d, size});
+                size += ncomp * nb[a] * nb1;
+            }
+        }
+    }
+    const int npieces = pieces.size() / 4;
+
+    // Extract on the device, then copy to the host
+    const auto data = OutputStaging::DeviceBuffer<Real>("slice_output", size);
+    if (npieces > 0) {
+        ParArray2D<int> pieces_d("slice_pieces", npieces, 4);
+        auto pieces_h = Kokkos::create_mirror_view(pieces_d);
+        for (int p = 0; p < npieces; p++)
+            for (int c = 0; c < 4; c++) pieces_h(p, c) = pieces[4*p + c];
+        Kokkos::deep_copy(pieces_d, pieces_h);
+
+        auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+        for (int f = 0; f < fields.size(); f++) {
+            const auto V = md->PackVariables(std::vector<std::string>{fields[f]});
+            const int off = offsets[f];
+            const int nc = V.GetDim(4);
+            pmb0->par_for("slice_extract", 0, npieces-1, 0, m::max(nb2, nb3)-1, 0, nb1-1,
+                KOKKOS_LAMBDA (const int &p, const int &ia, const int &ii) {
+                    const int bm = pieces_d(p, 0), loc = pieces_d(p, 1), d = pieces_d(p, 2), start = pieces_d(p, 3);
+                    const int na = (d == 2) ? nb3 : nb2;
+                    if (ia >= na) return;
+                    const int k = (d == 3) ? loc : b.ks + ia;
+                    const int j = (d == 2) ? loc : b.js + ia;
+                    for (int v = 0; v < nc; v++)
+                        data(start + ((off + v) * na + ia) * nb1 + ii) = V(bm, v, k, j, b.is + ii);
+                }
+            );
+        }
+    }
+    send_data = OutputStaging::ToHost<Real>("slice_output", size);
+
+#ifdef MPI_PARALLEL
+    // Our own communicator, so tags can't collide with anything else in flight
+    static MPI_Comm comm = MPI_COMM_NULL;
+    if (comm == MPI_COMM_NULL) PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &comm));
+    if (!MPIRank0()) {
+        // Every rank sends, even with nothing to send, so rank 0 knows when it has everything
+        send_requests.resize(2);
+        PARTHENON_MPI_CHECK(MPI_Isend(send_meta.data(), send_meta.size(), MPI_INT, 0, 0, comm, &send_requests[0]));
+        PARTHENON_MPI_CHECK(MPI_Isend(send_data.data(), size, MPI_PARTHENON_REAL, 0, 1, comm, &send_requests[1]));
+        EndFlag();
+        return TaskStatus::complete;
+    }
+#endif
+
+    // Rank 0: assemble each slice, in [component][layer][other direction][X1] order
+    std::vector<std::vector<Real>> assembled(nslice);
+    for (int s = 0; s < nslice; s++)
+        assembled[s].resize((size_t) ncomp * slices[s].layers.size() * n[other_dir(slices[s].dir)] * n[1]);
+    auto place = [&](const int *meta, const int nmeta, const Real *pdata) {
+        int start = 0;
+        for (int p = 0; p < nmeta / piece_meta; p++) {
+            const int s = meta[piece_meta*p], l = meta[piece_meta*p + 1];
+            const int ga = meta[piece_meta*p + 2], g1 = meta[piece_meta*p + 3];
+            const int a = other_dir(slices[s].dir);
+            const int nl = slices[s].layers.size();
+            for (int c = 0; c < ncomp; c++)
+                for (int ia = 0; ia < nb[a]; ia++)
+                    for (int ii = 0; ii < nb1; ii++)
+                        assembled[s][(((size_t) c * nl + l) * n[a] + ga + ia) * n[1] + g1 + ii] =
+                            pdata[start + (c * nb[a] + ia) * nb1 + ii];
+            start += ncomp * nb[a] * nb1;
+        }
+    };
+    place(send_meta.data(), send_meta.size(), send_data.data());
+#ifdef MPI_PARALLEL
+    std::vector<int> recv_meta;
+    std::vector<Real> recv_data;
+    for (int r = 1; r < MPINumRanks(); r++) {
+        MPI_Status status;
+        int count;
+        PARTHENON_MPI_CHECK(MPI_Probe(r, 0, comm, &status));
+        PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_INT, &count));
+        recv_meta.resize(count);
+        PARTHENON_MPI_CHECK(MPI_Recv(recv_meta.data(), count, MPI_INT, r, 0, comm, MPI_STATUS_IGNORE));
+        PARTHENON_MPI_CHECK(MPI_Probe(r, 1, comm, &status));
+        PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_PARTHENON_REAL, &count));
+        recv_data.resize(count);
+        PARTHENON_MPI_CHECK(MPI_Recv(recv_data.data(), count, MPI_PARTHENON_REAL, r, 1, comm, MPI_STATUS_IGNORE));
+        place(recv_meta.data(), recv_meta.size(), recv_data.data());
+    }
+#endif
+
+    // HDF5 may not be thread-safe, don't write alongside a snapshot
+    AsyncOutput::Wait();
+    const std::string problem_id = pmesh->packages.Get("Globals")->Param<std::string>("problem");
+    char nbuf[16];
+    snprintf(nbuf, 16, "%05d", ncycle / dn);
+    const std::string fname = problem_id + ".slice." + nbuf + ".h5";
+    const hsize_t real_type = (sizeof(Real) == 4) ? H5T_IEEE_F32LE : H5T_IEEE_F64LE;
+
+    hdf5_create(fname.c_str());
+    const double t = tm.time + tm.dt;
+    hdf5_write_single_val(&t, "t", H5T_IEEE_F64LE);
+    hdf5_write_single_val(&ncycle, "ncycle", H5T_STD_I32LE);
+    hsize_t fstart1[1] = {0};
+    for (int d = 1; d < GR_DIM; d++) {
+        const std::string xd = std::to_string(d);
+        hdf5_write_single_val(&n[d], ("n" + xd).c_str(), H5T_STD_I32LE);
+        // Native coordinates of zone centers
+        std::vector<double> X(n[d]);
+        const GReal xmin = params.Get<GReal>("x" + xd + "min");
+        const GReal dx = (params.Get<GReal>("x" + xd + "max") - xmin) / n[d];
+        for (int i = 0; i < n[d]; i++) X[i] = xmin + (i + 0.5) * dx;
+        hsize_t fdims1[1] = {(hsize_t) n[d]};
+        hdf5_write_array(X.data(), ("X" + xd).c_str(), 1, fdims1, fstart1, fdims1, fdims1, fstart1, H5T_IEEE_F64LE);
+    }
+
+    for (int s = 0; s < nslice; s++) {
+        const int nl = slices[s].layers.size();
+        const int na = n[other_dir(slices[s].dir)];
+        hdf5_make_directory(slices[s].name.c_str());
+        hdf5_set_directory(("/" + slices[s].name + "/").c_str());
+        hdf5_write_single_val(&slices[s].dir, "dir", H5T_STD_I32LE);
+        hsize_t fdims_l[1] = {(hsize_t) nl};
+        hdf5_write_array(slices[s].layers.data(), "index", 1, fdims_l, fstart1, fdims_l, fdims_l, fstart1, H5T_STD_I32LE);
+        hsize_t fdims[3] = {(hsize_t) nl, (hsize_t) na, (hsize_t) n[1]}, fstart[3] = {0, 0, 0};
+        for (int c = 0; c < ncomp; c++)
+            hdf5_write_array(&assembled[s][(size_t) c * nl * na * n[1]], comp_names[c].c_str(), 3,
+                             fdims, fstart, fdims, fdims, fstart, real_type);
+        hdf5_set_directory("/");
+    }
+    hdf5_close();
+
+    if (pmesh->packages.Get("Globals")->Param<int>("verbose") > 0)
+        std::cout << "Wrote slices at t=" << t << " to " << fname << std::endl;
+
+    EndFlag();
+    return TaskStatus::complete;
+}
+
+void SliceOutput::PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    WaitSends();
+    // Release the host buffer before Kokkos is finalized
+    send_data = OutputStaging::HostView<Real>();
+    OutputStaging::Release();
+}
@@ -0,0 +1,80 @@
+/* 
+ *  File: slice_output.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Streaming 2D slices of a few fields, for monitoring runs without full 3D dumps.
+ *
+ * Every <slice_output>dn steps, the zones of each slice are extracted on the device from the blocks
+ * which hold them, copied to the host and sent to rank 0 with point-to-point messages.  Rank 0 assembles
+ * each slice over the global grid and writes <problem_id>.slice.NNNNN.h5, with one group per slice.
+ * Slices are taken at fixed global zone indices:
+ * "midplane" at the zone j = nx2/2, just above the midplane of a symmetric X2 domain, over (X3,X1),
+ * "poloidal" at the zones k = 0 and k = nx3/2, i.e. both halves of the phi=0 plane, over (X2,X1).
+ *
+ * Sends are completed at the next slice, so the step loop only waits on rank 0.
+ * Requires a mesh without refinement, where blocks map directly to global indices.
+ */
+namespace SliceOutput {
+
+/**
+ * A slice through the global grid: the zones at each global index in 'layers' along direction 'dir'
+ */
+struct Slice {
+    std::string name;
+    int dir;
+    std::vector<int> layers;
+};
+
+/**
+ * Initialize the package, with which fields and slices to write and how often
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Extract, gather & write the slices, if due.
+ * Registered as PostStepDiagnostics, so that it is called once per step over the whole mesh
+ */
+TaskStatus ExtractAndWrite(const SimTime& tm, MeshData<Real> *md);
+
+/**
+ * Complete any outstanding sends & free their buffers before exiting
+ */
+void PostExecute(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+}
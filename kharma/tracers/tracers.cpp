@@ -0,0 +1,438 @@
+/* 
+ *  File: tracers.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tracers.hpp"
+
+#include "async_output.hpp"
+#include "domain.hpp"
+#include "grmhd_functions.hpp"
+#include "hdf5_utils.h"
+#include "reductions.hpp"
+
+using Reductions::Var;
+
+namespace {
+
+static const std::map<std::string, Var> tracer_var_names = {
+    {"rho", Var::rho}, {"u", Var::u}, {"Pg", Var::gas_pressure}, {"bsq", Var::bsq},
+    {"beta", Var::beta}, {"sigma", Var::sigma}, {"theta_e", Var::theta_e}
+};
+
+// Evaluate any recorded variable by its runtime index, as in Averages
+KOKKOS_INLINE_FUNCTION Real tracer_var(const Var& var, const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                       const VariableFluxPack<Real>& U, const VarMap& m_u,
+                                       const VariablePack<Real>& cmax, const VariablePack<Real>& cmin,
+                                       const EMHD::EMHD_parameters& emhd_params, const Real& gam, const Real& game,
+                                       const int& k, const int& j, const int& i)
+{
+    switch (var) {
+    case Var::rho: return Reductions::reduction_var<Var::rho>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::u: return Reductions::reduction_var<Var::u>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::gas_pressure: return Reductions::reduction_var<Var::gas_pressure>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::bsq: return Reductions::reduction_var<Var::bsq>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::beta: return Reductions::reduction_var<Var::beta>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::sigma: return Reductions::reduction_var<Var::sigma>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    case Var::theta_e: return Reductions::reduction_var<Var::theta_e>(G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+    default: return 0.;
+    }
+}
+
+/**
+ * Coordinate velocity dX^i/dt = u^i/u^t at native position X, interpolated linearly in each
+ * direction of the block from the surrounding zone centers.  Indices are clamped to the block's
+ * allocated zones, so positions slightly outside it (e.g. a midpoint) are extrapolated from the edge
+ */
+KOKKOS_INLINE_FUNCTION void tracer_velocity(const GRCoordinates& G, const VariablePack<Real>& P, const VarMap& m_p,
+                                            const int n[3], const GReal X[3], GReal vel[3])
+{
+    const GReal Xc0[3] = {G.Xc<1>(0), G.Xc<2>(0), G.Xc<3>(0)};
+    const GReal dX[3] = {G.Dxc<1>(), G.Dxc<2>(), G.Dxc<3>()};
+    int lo[3];
+    GReal f[3];
+    for (int d = 0; d < 3; d++) {
+        if (n[d] > 1) {
+            lo[d] = m::min(m::max((int) m::floor((X[d] - Xc0[d]) / dX[d]), 0), n[d] - 2);
+            f[d] = m::min(m::max((X[d] - (Xc0[d] + lo[d] * dX[d])) / dX[d], 0.), 1.);
+        } else {
+            lo[d] = 0;
+            f[d] = 0.;
+        }
+    }
+
+    for (int d = 0; d < 3; d++) vel[d] = 0.;
+    for (int c = 0; c < 8; c++) {
+        const int o[3] = {c & 1, (c >> 1) & 1, (c >> 2) & 1};
+        GReal w = 1.;
+        for (int d = 0; d < 3; d++) w *= (o[d]) ? f[d] : 1. - f[d];
+        if (w == 0.) continue;
+        const int i = lo[0] + o[0], j = lo[1] + o[1], k = lo[2] + o[2];
+        Real ucon[GR_DIM];
+        GRMHD::calc_ucon(G, P, m_p, k, j, i, Loci::center, ucon);
+        for (int d = 0; d < 3; d++) vel[d] += w * ucon[d+1] / ucon[0];
+    }
+}
+
+}
+
+std::shared_ptr<KHARMAPackage> Tracers::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
+{
+    auto pkg = std::make_shared<KHARMAPackage>("Tracers");
+    Params &params = pkg->AllParams();
+
+    // Number of tracers seeded in each block at the start of the run
+    params.Add("num_per_block", pin->GetOrAddInteger("tracers", "num_per_block", 64));
+    // Whether we've seeded (or found restored) tracers yet
+    params.Add("seeded", false, true);
+
+    // Which fluid variables each tracer records
+    std::vector<std::string> default_vars = {"rho", "u", "bsq"};
+    if (packages->AllPackages().count("Electrons")) default_vars.push_back("theta_e");
+    auto var_names = pin->GetOrAddVector<std::string>("tracers", "variables", default_vars);
+    std::vector<int> var_list;
+    for (auto& var : var_names) {
+        if (!tracer_var_names.count(var))
+            throw std::invalid_argument("Unknown variable for tracers to record: "+var);
+        if (var == "theta_e" && !packages->AllPackages().count("Electrons"))
+            throw std::invalid_argument("Recording theta_e on tracers requires electrons!");
+        if ((var == "bsq" || var == "beta" || var == "sigma") &&
+            !(packages->AllPackages().count("B_FluxCT") || packages->AllPackages().count("B_CT") ||
+              packages->AllPackages().count("B_CD")))
+            throw std::invalid_argument("Recording "+var+" on tracers requires a magnetic field!");
+        var_list.push_back(static_cast<int>(tracer_var_names.at(var)));
+    }
+    params.Add("var_names", var_names);
+    params.Add("var_list", var_list);
+
+    // Output cadence in simulation time, and the next output time & file number
+    const Real dt = pin->GetReal("tracers", "dt");
+    params.Add("dt", dt);
+    params.Add("t_next", pin->GetOrAddReal("tracers", "tstart", 0.), true);
+    params.Add("next_file", 0, true);
+
+    // Domain bounds, for removing or reflecting tracers which leave it
+    params.Add("xmin", std::vector<GReal>{pin->GetReal("parthenon/mesh", "x1min"), pin->GetReal("parthenon/mesh", "x2min"),
+                                          pin->GetReal("parthenon/mesh", "x3min")});
+    params.Add("xmax", std::vector<GReal>{pin->GetReal("parthenon/mesh", "x1max"), pin->GetReal("parthenon/mesh", "x2max"),
+                                          pin->GetReal("parthenon/mesh", "x3max")});
+
+    // The swarm itself.  Positions x, y, z (native X1, X2, X3) are added by Parthenon
+    Metadata swarm_metadata({Metadata::Provides, Metadata::None});
+    pkg->AddSwarm("tracers", swarm_metadata);
+    pkg->AddSwarmValue("id", "tracers", Metadata({Metadata::Integer}));
+    Metadata m_real({Metadata::Real});
+    for (auto& var : var_names) pkg->AddSwarmValue(var, "tracers", m_real);
+
+    pkg->PostStepWork = Tracers::Update;
+
+    return pkg;
+}
+
+void Tracers::Update(Mesh *pmesh, ParameterInput *pin, const SimTime &tm)
+{
+    Flag("UpdateTracers");
+    auto& params = pmesh->packages.Get("Tracers")->AllParams();
+
+    // Seed on the first step, unless tracers were already restored
+    bool *seeded = params.GetMutable<bool>("seeded");
+    if (!*seeded) {
+        int n_tracers = 0;
+        for (auto &pmb : pmesh->block_list)
+            n_tracers += pmb->swarm_data.Get()->Get("tracers")->GetNumActive();
+#ifdef MPI_PARALLEL
+        PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &n_tracers, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD));
+#endif
+        if (n_tracers == 0) {
+            for (auto &pmb : pmesh->block_list) Seed(pmb.get());
+        }
+        *seeded = true;
+    }
+
+    // Parthenon advances tm.time only after PostStepWork, so this step covers [tm.time, tm.time + tm.dt]
+    for (auto &pmb : pmesh->block_list) Advect(pmb.get(), tm.dt);
+
+    // Send tracers which left their block to its neighbors
+    TaskCollection tc;
+    auto& tr = tc.AddRegion(pmesh->block_list.size());
+    for (int i = 0; i < pmesh->block_list.size(); i++) {
+        auto &sc = pmesh->block_list[i]->swarm_data.Get();
+        auto& tl = tr[i];
+        TaskID t_none(0);
+        auto t_send = tl.AddTask(t_none, &SwarmContainer::Send, sc.get(), BoundaryCommSubset::all);
+        tl.AddTask(t_send, &SwarmContainer::Receive, sc.get(), BoundaryCommSubset::all);
+    }
+    while (!tr.Execute());
+
+    // Record the fluid state and write, if due
+    const Real t_end = tm.time + tm.dt;
+    Real *t_next = params.GetMutable<Real>("t_next");
+    if (t_end >= *t_next) {
+        for (auto &pmb : pmesh->block_list) Sample(pmb.get());
+        Write(pmesh, t_end);
+        const Real dt = params.Get<Real>("dt");
+        while (*t_next <= t_end) *t_next += dt;
+    }
+
+    EndFlag();
+}
+
+void Tracers::Seed(MeshBlock *pmb)
+{
+    auto& swarm = pmb->swarm_data.Get()->Get("tracers");
+    const auto& params = pmb->packages.Get("Tracers")->AllParams();
+    const int num = params.Get<int>("num_per_block");
+
+    ParArrayND<int> new_indices;
+    swarm->AddEmptyParticles(num, new_indices);
+    auto& x = swarm->Get<Real>("x").Get();
+    auto& y = swarm->Get<Real>("y").Get();
+    auto& z = swarm->Get<Real>("z").Get();
+    auto& id = swarm->Get<int>("id").Get();
+
+    // Extent of the block interior.  Directions beyond the mesh's dimension get the block center
+    const auto& G = pmb->coords;
+    const IndexRange3 b = KDomain::GetRange(pmb->meshblock_data.Get().get(), IndexDomain::interior);
+    const int ndim = pmb->pmy_mesh->ndim;
+    const GReal lo[3] = {G.Xf<1>(b.is), G.Xf<2>(b.js), G.Xf<3>(b.ks)};
+    const GReal hi[3] = {G.Xf<1>(b.ie + 1), G.Xf<2>(b.je + 1), G.Xf<3>(b.ke + 1)};
+    const int gid = pmb->gid;
+
+    // R3 low-discrepancy sequence, from the generalized golden ratio in 3D
+    const GReal phi = 1.2207440846057596;
+    const GReal alpha[3] = {1./phi, 1./(phi*phi), 1./(phi*phi*phi)};
+    pmb->par_for("seed_tracers", 0, num - 1,
+        KOKKOS_LAMBDA (const int& m) {
+            const int n = new_indices(m);
+            GReal X[3];
+            for (int d = 0; d < 3; d++) {
+                const GReal s = (d < ndim) ? 0.5 + (m + 1) * alpha[d] : 0.5;
+                X[d] = lo[d] + (s - m::floor(s)) * (hi[d] - lo[d]);
+            }
+            x(n) = X[0];
+            y(n) = X[1];
+            z(n) = X[2];
+            id(n) = gid * num + m;
+        }
+    );
+}
+
+void Tracers::Advect(MeshBlock *pmb, const Real& dt)
+{
+    auto& swarm = pmb->swarm_data.Get()->Get("tracers");
+    if (swarm->GetNumActive() == 0) return;
+    const auto& params = pmb->packages.Get("Tracers")->AllParams();
+    auto pmesh = pmb->pmy_mesh;
+
+    auto& rc = pmb->meshblock_data.Get();
+    PackIndexMap prims_map;
+    const auto& P = rc->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const VarMap m_p(prims_map, false);
+    const auto& G = pmb->coords;
+    const int n[3] = {P.GetDim(1), P.GetDim(2), P.GetDim(3)};
+
+    auto& x = swarm->Get<Real>("x").Get();
+    auto& y = swarm->Get<Real>("y").Get();
+    auto& z = swarm->Get<Real>("z").Get();
+    auto swarm_d = swarm->GetDeviceContext();
+
+    // Domain bounds and how to treat them: directions beyond the mesh's dimension are ignorable,
+    // and just wrapped into the domain
+    const auto& xmin_v = params.Get<std::vector<GReal>>("xmin");
+    const auto& xmax_v = params.Get<std::vector<GReal>>("xmax");
+    const GReal xmin[3] = {xmin_v[0], xmin_v[1], xmin_v[2]};
+    const GReal xmax[3] = {xmax_v[0], xmax_v[1], xmax_v[2]};
+    const int ndim = pmesh->ndim;
+    const bool periodic[3] = {pmesh->mesh_bcs[BoundaryFace::inner_x1] == BoundaryFlag::periodic,
+                              pmesh->mesh_bcs[BoundaryFace::inner_x2] == BoundaryFlag::periodic,
+                              pmesh->mesh_bcs[BoundaryFace::inner_x3] == BoundaryFlag::periodic};
+
+    pmb->par_for("advect_tracers", 0, swarm->GetMaxActiveIndex(),
+        KOKKOS_LAMBDA (const int& p) {
+            if (swarm_d.IsActive(p)) {
+                // Midpoint step through the current velocity field
+                GReal X[3] = {x(p), y(p), z(p)}, Xmid[3], vel[3];
+                tracer_velocity(G, P, m_p, n, X, vel);
+                for (int d = 0; d < 3; d++) Xmid[d] = X[d] + 0.5 * dt * vel[d];
+                tracer_velocity(G, P, m_p, n, Xmid, vel);
+                for (int d = 0; d < 3; d++) X[d] += dt * vel[d];
+
+                // Leave Parthenon to wrap periodic directions.  Reflect non-periodic X2 (the poles),
+                // and remove tracers leaving through other boundaries (e.g. into the event horizon)
+                bool outside = false;
+                for (int d = 0; d < 3; d++) {
+                    const GReal len = xmax[d] - xmin[d];
+                    if (d >= ndim) {
+                        X[d] -= m::floor((X[d] - xmin[d]) / len) * len;
+                    } else if (!periodic[d] && (X[d] < xmin[d] || X[d] > xmax[d])) {
+                        if (d == 1) {
+                            X[d] = (X[d] < xmin[d]) ? 2*xmin[d] - X[d] : 2*xmax[d] - X[d];
+                        } else {
+                            outside = true;
+                        }
+                    }
+                }
+                if (outside) {
+                    swarm_d.MarkParticleForRemoval(p);
+                } else {
+                    x(p) = X[0];
+                    y(p) = X[1];
+                    z(p) = X[2];
+                    bool on_current_mesh_block = true;
+                    swarm_d.GetNeighborBlockIndex(p, x(p), y(p), z(p), on_current_mesh_block);
+                }
+            }
+        }
+    );
+    swarm->RemoveMarkedParticles();
+}
+
+void Tracers::Sample(MeshBlock *pmb)
+{
+    auto& swarm = pmb->swarm_data.Get()->Get("tracers");
+    if (swarm->GetNumActive() == 0) return;
+    auto pmesh = pmb->pmy_mesh;
+    const auto& params = pmesh->packages.Get("Tracers")->AllParams();
+    const auto& var_names = params.Get<std::vector<std::string>>("var_names");
+    const auto& var_list = params.Get<std::vector<int>>("var_list");
+
+    const Real gam = pmesh->packages.Get("GRMHD")->Param<Real>("gamma");
+    const Real game = Reductions::ElectronGamma(pmesh);
+    const auto& emhd_params = EMHD::GetEMHDParameters(pmesh->packages);
+
+    auto& rc = pmb->meshblock_data.Get();
+    PackIndexMap prims_map, cons_map;
+    const auto& P = rc->PackVariables(std::vector<MetadataFlag>{Metadata::GetUserFlag("Primitive"), Metadata::Cell}, prims_map);
+    const auto& U = rc->PackVariablesAndFluxes(std::vector<MetadataFlag>{Metadata::Conserved, Metadata::Cell}, cons_map);
+    const VarMap m_u(cons_map, true), m_p(prims_map, false);
+    const auto& cmax = rc->PackVariables(std::vector<std::string>{"Flux.cmax"});
+    const auto& cmin = rc->PackVariables(std::vector<std::string>{"Flux.cmin"});
+    const auto& G = pmb->coords;
+
+    auto& x = swarm->Get<Real>("x").Get();
+    auto& y = swarm->Get<Real>("y").Get();
+    auto& z = swarm->Get<Real>("z").Get();
+    auto swarm_d = swarm->GetDeviceContext();
+
+    for (int v = 0; v < var_names.size(); v++) {
+        auto& rec = swarm->Get<Real>(var_names[v]).Get();
+        const Var var = static_cast<Var>(var_list[v]);
+        pmb->par_for("sample_tracers", 0, swarm->GetMaxActiveIndex(),
+            KOKKOS_LAMBDA (const int& p) {
+                if (swarm_d.IsActive(p)) {
+                    int i, j, k;
+                    swarm_d.Xtoijk(x(p), y(p), z(p), i, j, k);
+                    rec(p) = tracer_var(var, G, P, m_p, U, m_u, cmax, cmin, emhd_params, gam, game, k, j, i);
+                }
+            }
+        );
+    }
+}
+
+void Tracers::Write(Mesh *pmesh, const Real& t)
+{
+    Flag("WriteTracers");
+    auto& params = pmesh->packages.Get("Tracers")->AllParams();
+    const auto& var_names = params.Get<std::vector<std::string>>("var_names");
+    const int nvar = var_names.size();
+
+    // Collect this rank's tracers: positions, then recorded values
+    std::vector<int> ids;
+    std::vector<std::vector<double>> vals(3 + nvar);
+    for (auto &pmb : pmesh->block_list) {
+        auto& swarm = pmb->swarm_data.Get()->Get("tracers");
+        if (swarm->GetNumActive() == 0) continue;
+        const auto mask = swarm->GetMask().GetHostMirrorAndCopy();
+        const auto id = swarm->Get<int>("id").Get().GetHostMirrorAndCopy();
+        std::vector<decltype(swarm->Get<Real>("x").Get().GetHostMirrorAndCopy())> fields;
+        for (auto name : {"x", "y", "z"}) fields.push_back(swarm->Get<Real>(name).Get().GetHostMirrorAndCopy());
+        for (auto& name : var_names) fields.push_back(swarm->Get<Real>(name).Get().GetHostMirrorAndCopy());
+        for (int p = 0; p <= swarm->GetMaxActiveIndex(); p++) {
+            if (!mask(p)) continue;
+            ids.push_back(id(p));
+            for (int f = 0; f < 3 + nvar; f++) vals[f].push_back(fields[f](p));
+        }
+    }
+
+    // Gather everything to rank 0
+    int n_local = ids.size(), n_total = n_local;
+    std::vector<int> counts(1, n_local), displs(1, 0);
+#ifdef MPI_PARALLEL
+    const int nranks = MPINumRanks();
+    counts.resize(nranks);
+    displs.resize(nranks);
+    PARTHENON_MPI_CHECK(MPI_Gather(&n_local, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD));
+    n_total = 0;
+    for (int r = 0; r < nranks; r++) {
+        displs[r] = n_total;
+        n_total += counts[r];
+    }
+    std::vector<int> all_ids(MPIRank0() ? n_total : 0);
+    PARTHENON_MPI_CHECK(MPI_Gatherv(ids.data(), n_local, MPI_INT, all_ids.data(), counts.data(), displs.data(),
+                                    MPI_INT, 0, MPI_COMM_WORLD));
+    ids = all_ids;
+    for (auto& field : vals) {
+        std::vector<double> all(MPIRank0() ? n_total : 0);
+        PARTHENON_MPI_CHECK(MPI_Gatherv(field.data(), n_local, MPI_DOUBLE, all.data(), counts.data(), displs.data(),
+                                        MPI_DOUBLE, 0, MPI_COMM_WORLD));
+        field = all;
+    }
+#endif
+
+    if (MPIRank0()) {
+        // HDF5 may not be thread-safe, don't write alongside a snapshot
+        AsyncOutput::Wait();
+        int *next_file = params.GetMutable<int>("next_file");
+        const std::string problem_id = pmesh->packages.Get("Globals")->Param<std::string>("problem");
+        char nbuf[16];
+        snprintf(nbuf, 16, "%05d", *next_file);
+        const std::string fname = problem_id + ".tracers." + nbuf + ".h5";
+
+        hdf5_create(fname.c_str());
+        const double t_d = t;
+        hdf5_write_single_val(&t_d, "t", H5T_IEEE_F64LE);
+        hdf5_write_single_val(&n_total, "n_tracers", H5T_STD_I32LE);
+        if (n_total > 0) {
+            hsize_t fdims[1] = {(hsize_t) n_total}, fstart[1] = {0};
+            hdf5_write_array(ids.data(), "id", 1, fdims, fstart, fdims, fdims, fstart, H5T_STD_I32LE);
+            const std::vector<std::string> pos_names = {"X1", "X2", "X3"};
+            for (int f = 0; f < 3 + nvar; f++) {
+                const std::string& name = (f < 3) ? pos_names[f] : var_names[f - 3];
+                hdf5_write_array(vals[f].data(), name.c_str(), 1, fdims, fstart, fdims, fdims, fstart, H5T_IEEE_F64LE);
+            }
+        }
+        hdf5_close();
+        std::cout << "Wrote " << n_total << " tracers at t=" << t << " to " << fname << std::endl;
+    }
+    (*params.GetMutable<int>("next_file"))++;
+    EndFlag();
+}
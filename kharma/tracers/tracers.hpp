@@ -0,0 +1,87 @@
+/* 
+ *  File: tracers.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+#include "types.hpp"
+
+/**
+ * Passive Lagrangian tracer particles, advected in-situ with the fluid.
+ *
+ * Tracers are a Parthenon swarm "tracers".  <tracers>num_per_block are seeded in each block on the
+ * first step, on a deterministic quasi-random (R3) sequence, unless the swarm already holds particles.
+ * After every step, each tracer is moved by dX^i/dt = u^i/u^t, with the velocity interpolated
+ * trilinearly from zone centers, and a midpoint (RK2) step.  Tracers leaving through a non-periodic
+ * X1 or X3 boundary are removed; at non-periodic X2 boundaries (usually the poles) they are reflected.
+ *
+ * Each tracer then records <tracers>variables (any of rho, u, Pg, bsq, beta, sigma, theta_e, as
+ * in the reductions) from the zone it occupies.  Every <tracers>dt in simulation time, all tracers
+ * are gathered to rank 0 and written to <problem_id>.tracers.NNNNN.h5, with their IDs, native
+ * positions & recorded values.  This follows the heating history of fluid elements at a small
+ * fraction of the cost of full dumps.
+ */
+namespace Tracers {
+
+/**
+ * Initialize the tracers package: the swarm, its recorded values, and output cadence
+ */
+std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
+
+/**
+ * Seed tracers if needed, move them by one step, exchange them between blocks, sample the fluid
+ * and write them if due.  Registered as PostStepWork
+ */
+void Update(Mesh *pmesh, ParameterInput *pin, const SimTime &tm);
+
+/**
+ * Add <tracers>num_per_block tracers to a block, uniformly distributed over its interior
+ */
+void Seed(MeshBlock *pmb);
+
+/**
+ * Move each tracer on a block by dt, and mark any leaving the domain for removal
+ */
+void Advect(MeshBlock *pmb, const Real& dt);
+
+/**
+ * Record the chosen fluid variables at each tracer's zone
+ */
+void Sample(MeshBlock *pmb);
+
+/**
+ * Gather all tracers to rank 0 and write them
+ */
+void Write(Mesh *pmesh, const Real& t);
+
+}
@@ -38,6 +38,8 @@
 #include "boundaries/boundary_types.hpp"
 #include "kharma_package.hpp"
 #include "reductions/reductions_types.hpp"
+#include "region_timer.hpp"
+#include "wait_timer.hpp"
 
 #include <parthenon/parthenon.hpp>
 
@@ -136,6 +138,25 @@ class VarMap {
         int8_t PSI, Q, DP;
         // Total struct size ~20 bytes, < 1 vector of 4 doubles
 
+        /**
+         * Map of a fixed layout with only the basic fluid variables, and optionally a cell-centered B field.
+         * If every index is known when compiling a kernel (see FixedMHD), the compiler can drop
+         * all the branches on absent variables.  Default-constructed maps have no variables.
+         */
+        KOKKOS_FUNCTION constexpr VarMap(int8_t rho=-1, int8_t uu=-1, int8_t u1=-1, int8_t b1=-1) :
+            RHO(rho), UU(uu), U1(u1), U2((u1 >= 0) ? u1 + 1 : -1), U3((u1 >= 0) ? u1 + 2 : -1),
+            B1(b1), B2((b1 >= 0) ? b1 + 1 : -1), B3((b1 >= 0) ? b1 + 2 : -1), Bf1(-1), Bf2(-1), Bf3(-1),
+            RHO_ADDED(-1), UU_ADDED(-1), PASSIVE(-1),
+            KTOT(-1), K_CONSTANT(-1), K_HOWES(-1), K_KAWAZURA(-1), K_WERNER(-1), K_ROWAN(-1), K_SHARMA(-1),
+            PSI(-1), Q(-1), DP(-1) {}
+
+        /**
+         * The layout of ideal GRMHD with a cell-centered field (e.g. B_FluxCT): rho, u, uvec, B.
+         * Identical for primitive and conserved variables.  Only usable for packs which match it,
+         * see Flux::FixedLayout
+         */
+        KOKKOS_FUNCTION static constexpr VarMap FixedMHD() { return VarMap(0, 1, 2, 5); }
+
         VarMap(parthenon::PackIndexMap& name_map, bool is_cons)
         {
             if (is_cons) {
@@ -208,6 +229,17 @@ class VarMap {
             }
         }
 
+        // Compare the indices of all variables set from a PackIndexMap
+        bool operator==(const VarMap& o) const
+        {
+            return RHO == o.RHO && UU == o.UU && U1 == o.U1 && U2 == o.U2 && U3 == o.U3 &&
+                   B1 == o.B1 && B2 == o.B2 && B3 == o.B3 && Bf1 == o.Bf1 && Bf2 == o.Bf2 && Bf3 == o.Bf3 &&
+                   RHO_ADDED == o.RHO_ADDED && UU_ADDED == o.UU_ADDED &&
+                   KTOT == o.KTOT && K_CONSTANT == o.K_CONSTANT && K_HOWES == o.K_HOWES &&
+                   K_KAWAZURA == o.K_KAWAZURA && K_WERNER == o.K_WERNER && K_ROWAN == o.K_ROWAN &&
+                   K_SHARMA == o.K_SHARMA && PSI == o.PSI && Q == o.Q && DP == o.DP;
+        }
+
         void print() const
         {
             printf("VAR MAP:\n");
@@ -222,6 +254,92 @@ class VarMap {
 // TODO(BSP) make configurable.  Currently only used for implicit kernel temporaries
 #define MAX_VARS 20
 
+/**
+ * All variables of a pack at a single zone, copied into a local array.
+ * This gives point-wise kernels an interleaved ("array of structs") view of one zone,
+ * while packs and stencil kernels keep Parthenon's variable-major layout.
+ * Indexed like scratch-memory subviews, z(v), so the Local overloads of point-wise functions
+ * (GRMHD::calc_4vecs, Flux::p_to_u, ...) run on it unchanged.
+ * Load/Store copy the first n <= N variables from/to a pack at (k, j, i).
+ */
+template<int N>
+struct ZoneVars {
+    mutable Real vals[N];
+
+    KOKKOS_FORCEINLINE_FUNCTION Real& operator()(const int& v) const { return vals[v]; }
+
+    template<typename Global>
+    KOKKOS_FORCEINLINE_FUNCTION void Load(const Global& P, const int& n, const int& k, const int& j, const int& i)
+    {
+        for (int v = 0; v < n; ++v) vals[v] = P(v, k, j, i);
+    }
+    template<typename Global>
+    KOKKOS_FORCEINLINE_FUNCTION void Store(const Global& P, const int& n, const int& k, const int& j, const int& i) const
+    {
+        for (int v = 0; v < n; ++v) P(v, k, j, i) = vals[v];
+    }
+};
+
+/**
+ * Mutable package state which is kept separately for each MeshData partition, so that partitions
+ * run in separate task lists don't reallocate or overwrite each other's scratch arrays.
+ * The param 'name' must be added as a mutable std::map<int, T>.
+ * Partitions are keyed by the gid of their first block, which shallow copies share.
+ */
+inline int PartitionKey(MeshData<Real> *md)
+{
+    return md->GetBlockData(0)->GetBlockPointer()->gid;
+}
+/**
+ * Locations of each block in a partition.  Anything depending only on which blocks make up a partition
+ * (e.g. which faces are physical boundaries) can be cached against this, and rebuilt after a regrid.
+ */
+inline std::vector<LogicalLocation> PartitionLocations(MeshData<Real> *md)
+{
+    std::vector<LogicalLocation> locs;
+    for (int b = 0; b < md->NumBlocks(); b++)
+        locs.push_back(md->GetBlockData(b)->GetBlockPointer()->loc);
+    return locs;
+}
+template<typename T>
+inline T* GetPartitionParam(MeshData<Real> *md, const std::string& package, const std::string& name)
+{
+    auto *per_partition = md->GetMeshPointer()->packages.Get(package)->AllParams().GetMutable<std::map<int, T>>(name);
+    return &((*per_partition)[PartitionKey(md)]);
+}
+
+/**
+ * Flag lists for the packs taken in every step, built once rather than on each call.
+ * User flags are registered during package initialization, so these are only valid afterward.
+ * Packs by name should likewise pass a static const std::vector<std::string>.
+ */
+/**
+ * Add a user Metadata flag, or get it if it exists.  Flags outlive the packages defining them,
+ * and with <ramp> the packages are constructed again for each stage, see ramp.hpp
+ */
+inline MetadataFlag AddUserFlag(const std::string& name)
+{
+    return Metadata::FlagNameExists(name) ? Metadata::GetUserFlag(name) : Metadata::AddUserFlag(name);
+}
+
+namespace PackFlags {
+inline const std::vector<MetadataFlag>& Primitive()
+{
+    static const std::vector<MetadataFlag> flags{Metadata::GetUserFlag("Primitive")};
+    return flags;
+}
+inline const std::vector<MetadataFlag>& PrimitiveCell()
+{
+    static const std::vector<MetadataFlag> flags{Metadata::GetUserFlag("Primitive"), Metadata::Cell};
+    return flags;
+}
+inline const std::vector<MetadataFlag>& ConservedCell()
+{
+    static const std::vector<MetadataFlag> flags{Metadata::Conserved, Metadata::Cell};
+    return flags;
+}
+} // namespace PackFlags
+
 #if DEBUG
 /**
  * Function to generate outputs wherever, whenever.
@@ -239,6 +357,7 @@ inline void OutputNow(Mesh *pmesh, std::string name)
 /**
  * Functions for "tracing" execution by printing strings at each entry/exit.
  * Normally, they profile the code, but they can print a nested execution trace.
+ * Either way, they also feed the region & wait timers if enabled, see region_timer.hpp & wait_timer.hpp
  * 
  * Don't laugh at my dumb mutex, it works.
  */
@@ -249,6 +368,8 @@ extern int kharma_debug_trace_mutex;
 #define MAX_INDENT_SPACES 80
 inline void Flag(std::string label)
 {
+    if (RegionTimer::enabled) RegionTimer::Push(label);
+    if (WaitTimer::enabled) WaitTimer::Enter();
     if(MPIRank0()) {
         int& indent = kharma_debug_trace_indent;
         int& mutex = kharma_debug_trace_mutex;
@@ -281,14 +402,20 @@ inline void EndFlag()
         fprintf(stderr, "%sDone\n", tab);
         mutex = 0;
     }
+    if (WaitTimer::enabled) WaitTimer::Exit();
+    if (RegionTimer::enabled) RegionTimer::Pop();
 }
 #else
 inline void Flag(std::string label)
 {
     Kokkos::Profiling::pushRegion(label);
+    if (RegionTimer::enabled) RegionTimer::Push(label);
+    if (WaitTimer::enabled) WaitTimer::Enter();
 }
 inline void EndFlag()
 {
+    if (WaitTimer::enabled) WaitTimer::Exit();
+    if (RegionTimer::enabled) RegionTimer::Pop();
     Kokkos::Profiling::popRegion();
 }
 #endif
@@ -0,0 +1,147 @@
+/* 
+ *  File: wait_timer.cpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "wait_timer.hpp"
+
+bool WaitTimer::enabled = false;
+bool WaitTimer::fence = false;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Accumulated since the last Print: steps & seconds of total, compute & wait time
+double nsteps = 0., wall = 0., compute = 0., wait = 0.;
+bool in_step = false;
+Clock::time_point step_start;
+
+// Depth of Flag() regions, start of the outermost, and time waited within it
+int depth = 0;
+Clock::time_point region_start;
+double region_wait = 0.;
+Clock::time_point wait_start;
+
+// End of the last incomplete poll, if no region has opened since
+bool polling = false;
+Clock::time_point last_poll;
+
+double Seconds(const Clock::time_point& start, const Clock::time_point& end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+}
+
+void WaitTimer::Enter()
+{
+    if (depth++ > 0 || !in_step) return;
+    if (fence) Kokkos::fence();
+    region_start = Clock::now();
+    region_wait = 0.;
+    polling = false;
+}
+
+void WaitTimer::Exit()
+{
+    if (depth == 0) return;
+    if (--depth > 0 || !in_step) return;
+    if (fence) Kokkos::fence();
+    compute += Seconds(region_start, Clock::now()) - region_wait;
+}
+
+void WaitTimer::BeginWait()
+{
+    wait_start = Clock::now();
+}
+
+void WaitTimer::EndWait()
+{
+    if (!in_step) return;
+    const double t = Seconds(wait_start, Clock::now());
+    wait += t;
+    if (depth > 0) region_wait += t;
+}
+
+void WaitTimer::RecordPoll(const Clock::time_point& start, bool complete)
+{
+    if (!in_step) return;
+    const auto end = Clock::now();
+    // Spinning from the last poll to this one, with nothing else to do
+    if (polling) wait += Seconds(last_poll, start);
+    // Failed polls are waiting.  The successful one unpacks, which is host work
+    if (!complete) wait += Seconds(start, end);
+    polling = !complete;
+    last_poll = end;
+}
+
+void WaitTimer::StepStart()
+{
+    const auto now = Clock::now();
+    if (in_step) {
+        wall += Seconds(step_start, now);
+        nsteps++;
+    }
+    in_step = true;
+    step_start = now;
+    polling = false;
+}
+
+void WaitTimer::Print()
+{
+    // Per-step means on this rank: compute, wait, host
+    const double n = m::max(nsteps, 1.);
+    double local[3] = {compute / n, wait / n, (wall - compute - wait) / n};
+    double mins[3], sums[3];
+    struct { double val; int rank; } maxes[3];
+    for (int c = 0; c < 3; c++) {
+        mins[c] = sums[c] = maxes[c].val = local[c];
+        maxes[c].rank = MPIRank();
+    }
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Reduce((MPIRank0()) ? MPI_IN_PLACE : mins, mins, 3, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD));
+    PARTHENON_MPI_CHECK(MPI_Reduce((MPIRank0()) ? MPI_IN_PLACE : sums, sums, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+    PARTHENON_MPI_CHECK(MPI_Reduce((MPIRank0()) ? MPI_IN_PLACE : maxes, maxes, 3, MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD));
+#endif
+
+    if (MPIRank0()) {
+        const char *names[3] = {"compute", "mpi_wait", "host"};
+        printf("Rank time per step over %.0f steps, %d ranks%s:\n", nsteps, MPINumRanks(), fence ? "" : " (unfenced)");
+        printf("%-12s %12s %12s %12s %10s\n", "", "min_s", "mean_s", "max_s", "max_rank");
+        for (int c = 0; c < 3; c++)
+            printf("%-12s %12.4g %12.4g %12.4g %10d\n", names[c], mins[c], sums[c] / MPINumRanks(),
+                   maxes[c].val, maxes[c].rank);
+    }
+
+    nsteps = wall = compute = wait = 0.;
+}
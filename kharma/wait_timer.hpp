@@ -0,0 +1,111 @@
+/* 
+ *  File: wait_timer.hpp
+ *  
+ *  BSD 3-Clause License
+ *  
+ *  Copyright (c) 2020, AFD Group at UIUC
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "decs.hpp"
+
+#include <parthenon/parthenon.hpp>
+
+#include <chrono>
+
+/**
+ * Per-rank split of each step's wall time into compute, MPI wait and host overhead,
+ * for diagnosing load imbalance and slow networks.
+ *
+ * When enabled with <debug>wait_timers, each rank accumulates, from the start of one step to the start of the next:
+ * 1. compute: time inside KHARMA's outermost Flag() regions, i.e., its task functions, less any waits inside them
+ * 2. MPI wait: time blocked on reductions (Reductions::Start/Check), plus time polling halo & flux-correction
+ *    receives and MPI flag reductions (see PolledTask), including the idle time between polls when no KHARMA
+ *    task ran in between
+ * 3. host overhead: the remainder, i.e., Parthenon's scheduling and own tasks (packing & sending buffers,
+ *    outputs) and anything else outside KHARMA's regions
+ * Every <debug>wait_timer_interval steps and at the end of the run, rank 0 prints the minimum, mean and
+ * maximum over ranks of each per step, and which rank has the largest.  A rank with much more compute than
+ * the rest (and the rest waiting) has too much work; waits on all ranks point to the network.
+ * Kernel launches are asynchronous, so unless <debug>wait_timer_fence is set, device time is counted
+ * wherever the host next waits on the device, often in MPI wait.
+ */
+namespace WaitTimer {
+
+// Checked on every Flag() call, so kept as plain globals
+extern bool enabled;
+extern bool fence;
+
+/**
+ * Open and close a Flag() region
+ */
+void Enter();
+void Exit();
+
+/**
+ * Open and close a blocking wait on MPI
+ */
+void BeginWait();
+void EndWait();
+
+/**
+ * Record one poll of a receive: the time spent in it, and since the last one if nothing else ran
+ */
+void RecordPoll(const std::chrono::steady_clock::time_point& start, bool complete);
+
+/**
+ * Wrap a polled task function F(arg), e.g. parthenon::ReceiveBoundBufs, to record its polls as MPI wait.
+ * Add to task lists as WaitTimer::PolledTask<F>::Run in place of F
+ */
+template<auto F>
+struct PolledTask;
+template<typename Arg, TaskStatus (*F)(Arg)>
+struct PolledTask<F> {
+    static TaskStatus Run(Arg arg)
+    {
+        if (!enabled) return F(arg);
+        const auto start = std::chrono::steady_clock::now();
+        const TaskStatus status = F(arg);
+        RecordPoll(start, status == TaskStatus::complete);
+        return status;
+    }
+};
+
+/**
+ * Close the running step's accounting and start the next.  Call at the start of every step
+ */
+void StepStart();
+
+/**
+ * Reduce the accumulated times over all ranks, print them from rank 0, and reset them.
+ * Collective: must be called from every rank
+ */
+void Print();
+
+}
@@ -33,6 +33,8 @@
  */
 #include "wind.hpp"
 
+#include "domain.hpp"
+
 std::shared_ptr<KHARMAPackage> Wind::Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages)
 {
     auto pkg = std::make_shared<KHARMAPackage>("Wind");
@@ -51,31 +53,91 @@ std::shared_ptr<KHARMAPackage> Wind::Initialize(ParameterInput *pin, std::shared
     params.Add("ramp_start", ramp_start);
     Real ramp_end = pin->GetOrAddReal("wind", "ramp_end", 0.0);
     params.Add("ramp_end", ramp_end);
+    // The injection rate falls off as r^-4: optionally skip zones (and whole blocks) past r_cut
+    Real r_cut = pin->GetOrAddReal("wind", "r_cut", 0.0);
+    params.Add("r_cut", r_cut);
+    // Injection profiles, kept per-partition, see GetWindProfiles
+    params.Add("wind_profiles", std::map<int, WindProfiles>(), true);
 
     pkg->AddSource = Wind::AddSource;
+    // Usually evaluated in the geometric source kernel instead, see Flux::AddGeoSource
+    pkg->fused_source = pin->GetOrAddBoolean("flux", "fuse_sources", true);
 
     // TODO track additions?
 
     return pkg;
 }
 
+Wind::WindParameters Wind::GetWindParameters(Packages_t& packages)
+{
+    const auto& pars = packages.Get("Wind")->AllParams();
+    const Real n = pars.Get<Real>("ne");
+    const Real ramp_start = pars.Get<Real>("ramp_start");
+    const Real ramp_end = pars.Get<Real>("ramp_end");
+    const Real time = packages.Get("Globals")->Param<Real>("time");
+
+    WindParameters wind;
+    // Set the wind via linear ramp-up with time, if enabled
+    wind.n = (ramp_end > 0.0) ? m::min(m::max(time - ramp_start, 0.0) / (ramp_end - ramp_start), 1.0) * n : n;
+    wind.u1_scale = wind.n / n;
+    wind.Tp = pars.Get<Real>("Tp");
+    wind.u1 = pars.Get<Real>("u1");
+    wind.power = pars.Get<int>("power");
+    return wind;
+}
+
+const Wind::WindProfiles& Wind::GetWindProfiles(MeshData<Real> *md)
+{
+    auto pmb0 = md->GetBlockData(0)->GetBlockPointer();
+    auto *cache = GetPartitionParam<WindProfiles>(md, "Wind", "wind_profiles");
+    auto locs = PartitionLocations(md);
+    if (cache->vals.extent_int(0) >= md->NumBlocks() && cache->locs == locs) return *cache;
+
+    const auto& pars = pmb0->packages.Get("Wind")->AllParams();
+    const int power = pars.Get<int>("power");
+    const GReal r_cut = pars.Get<Real>("r_cut");
+
+    const IndexRange3 b = KDomain::GetRange(md, IndexDomain::entire);
+    if (cache->vals.extent_int(0) < md->NumBlocks()) {
+        cache->vals = ParArray3D<Real>("wind_profiles", md->NumBlocks(), b.je + 1, b.ie + 1);
+        cache->active = ParArray1D<int>("wind_active_blocks", md->NumBlocks());
+    }
+    const auto vals = cache->vals;
+    auto dUdt = md->PackVariables(std::vector<MetadataFlag>{Metadata::Conserved});
+    pmb0->par_for("wind_profiles", 0, md->NumBlocks() - 1, b.js, b.je, b.is, b.ie,
+        KOKKOS_LAMBDA (const int &bl, const int &j, const int &i) {
+            const auto& G = dUdt.GetCoords(bl);
+            // Need coordinates to evaluate particle addtn rate
+            // Note that makes the wind spherical-only, TODO ensure this
+            GReal Xembed[GR_DIM];
+            G.coord_embed(b.ks, j, i, Loci::center, Xembed);
+            const GReal r = Xembed[1], th = Xembed[2];
+            vals(bl, j, i) = (r_cut > 0. && r > r_cut) ? 0. : m::pow(m::cos(th), power) / SQR(1. + r * r);
+        }
+    );
+
+    // List blocks with any zones inside the cutoff
+    const IndexRange3 bi = KDomain::GetRange(md, IndexDomain::interior);
+    auto active_h = cache->active.GetHostMirror();
+    int nactive = 0;
+    for (int bl = 0; bl < md->NumBlocks(); bl++) {
+        auto pmb = md->GetBlockData(bl)->GetBlockPointer();
+        if (r_cut <= 0. || pmb->coords.r(bi.ks, bi.js, bi.is) <= r_cut) active_h(nactive++) = bl;
+    }
+    cache->active.DeepCopy(active_h);
+    cache->nactive = nactive;
+    cache->locs = locs;
+    return *cache;
+}
+
 TaskStatus Wind::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain)
 {
     // Pointers
     auto pmesh = mdudt->GetMeshPointer();
     auto pmb0 = mdudt->GetBlockData(0)->GetBlockPointer();
     // Options
-    const auto& gpars = pmb0->packages.Get("GRMHD")->AllParams();
-    const auto& pars = pmb0->packages.Get("Wind")->AllParams();
-    const auto& globals = pmb0->packages.Get("Globals")->AllParams();
-    const Real gam = gpars.Get<Real>("gamma");
-    const Real n = pars.Get<Real>("ne");
-    const Real Tp = pars.Get<Real>("Tp");
-    const Real u1 = pars.Get<Real>("u1");
-    const int power = pars.Get<int>("power");
-    const Real ramp_start = pars.Get<Real>("ramp_start");
-    const Real ramp_end = pars.Get<Real>("ramp_end");
-    const Real time = globals.Get<Real>("time");
+    const Real gam = pmb0->packages.Get("GRMHD")->Param<Real>("gamma");
+    const WindParameters wind = GetWindParameters(pmb0->packages);
 
     // Pack variables
     PackIndexMap cons_map;
@@ -85,38 +147,18 @@ TaskStatus Wind::AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomai
     const IndexRange ib = mdudt->GetBoundsI(IndexDomain::interior);
     const IndexRange jb = mdudt->GetBoundsJ(IndexDomain::interior);
     const IndexRange kb = mdudt->GetBoundsK(IndexDomain::interior);
-    const IndexRange block = IndexRange{0, dUdt.GetDim(5) - 1};
 
-    // Set the wind via linear ramp-up with time, if enabled
-    const Real current_n = (ramp_end > 0.0) ? m::min(m::max(time - ramp_start, 0.0) / (ramp_end - ramp_start), 1.0) * n : n;
+    // Run only over blocks reaching inside the cutoff radius
+    const auto& profiles = GetWindProfiles(mdudt);
+    if (profiles.nactive == 0) return TaskStatus::complete;
+    const auto vals = profiles.vals;
+    const auto active = profiles.active;
 
-    pmb0->par_for("add_wind", block.s, block.e, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA (const int& b, const int &k, const int &j, const int &i) {
+    pmb0->par_for("add_wind", 0, profiles.nactive - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA (const int& ab, const int &k, const int &j, const int &i) {
+            const int b = active(ab);
             const auto& G = dUdt.GetCoords(b);
-            // Need coordinates to evaluate particle addtn rate
-            // Note that makes the wind spherical-only, TODO ensure this
-            GReal Xembed[GR_DIM];
-            G.coord_embed(k, j, i, Loci::center, Xembed);
-            GReal r = Xembed[1], th = Xembed[2];
-
-            // Particle addition rate: concentrate at poles
-            Real drhopdt = current_n * m::pow(m::cos(th), power) / SQR(1. + r * r);
-
-            // Insert fluid moving in positive U1, without B field
-            // Ramp up like density, since we're not at a set proportion
-            const Real uvec[NVEC] = {current_n / n * u1, 0, 0};
-            const Real B_P[NVEC] = {0};
-
-            // Add plasma to the T^t_a component of the stress-energy tensor
-            // Notice that U already contains a factor of sqrt{-g}
-            Real rho_ut, T[GR_DIM];
-            GRMHD::p_to_u_mhd(G, drhopdt, drhopdt * Tp * 3., uvec, B_P, gam, k, j, i, rho_ut, T);
-
-            dUdt(b, m_u.RHO, k, j, i) += rho_ut;
-            dUdt(b, m_u.UU, k, j, i) += T[0];
-            dUdt(b, m_u.U1, k, j, i) += T[1];
-            dUdt(b, m_u.U2, k, j, i) += T[2];
-            dUdt(b, m_u.U3, k, j, i) += T[3];
+            add_source(G, wind, gam, vals(b, j, i), k, j, i, m_u, dUdt(b));
         }
     );
 
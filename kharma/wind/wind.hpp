@@ -39,14 +39,76 @@
 
 namespace Wind {
 
+/**
+ * Parameters of the wind source, evaluated at the current time
+ */
+struct WindParameters {
+    Real n, Tp, u1, u1_scale;
+    int power;
+};
+
+/**
+ * Per-zone injection profile cos(th)^power / (1 + r^2)^2 of the wind, indexed as (block, j, i).
+ * Zero outside <wind> r_cut.  Like Floors::GeomFloorProfiles, this assumes the embedding
+ * coordinates don't vary in X3, and is cached against the partition's blocks.
+ * Also lists the blocks with any zone inside r_cut, see AddSource.
+ */
+struct WindProfiles {
+    ParArray3D<Real> vals;
+    ParArray1D<int> active;
+    int nactive = 0;
+    std::vector<LogicalLocation> locs;
+};
+/**
+ * Get (or build) the wind profiles for md
+ */
+const WindProfiles& GetWindProfiles(MeshData<Real> *md);
+
 /**
  * Initialize the wind package with several options from the input deck
  */
 std::shared_ptr<KHARMAPackage> Initialize(ParameterInput *pin, std::shared_ptr<Packages_t>& packages);
 
+/**
+ * Get the wind parameters at the current time, including any linear ramp-up
+ */
+WindParameters GetWindParameters(Packages_t& packages);
+
 /**
  * Add the wind source term.  Applied in Flux::AddSource, just after the FluxDivergence calculation
  */
 TaskStatus AddSource(MeshData<Real> *md, MeshData<Real> *mdudt, IndexDomain domain);
 
+/**
+ * Add the wind source in a single zone, given the zone's entry in the WindProfiles.
+ * Called from AddSource, or directly from the geometric source kernel if fused (see <flux> fuse_sources)
+ */
+template<typename Local>
+KOKKOS_INLINE_FUNCTION void add_source(const GRCoordinates& G, const WindParameters& wind, const Real& gam,
+                                       const Real& profile, const int& k, const int& j, const int& i,
+                                       const VarMap& m_u, const Local& dUdt)
+{
+    // Past the cutoff radius
+    if (profile == 0.) return;
+
+    // Particle addition rate: concentrate at poles, see GetWindProfiles
+    Real drhopdt = wind.n * profile;
+
+    // Insert fluid moving in positive U1, without B field
+    // Ramp up like density, since we're not at a set proportion
+    const Real uvec[NVEC] = {wind.u1_scale * wind.u1, 0, 0};
+    const Real B_P[NVEC] = {0};
+
+    // Add plasma to the T^t_a component of the stress-energy tensor
+    // Notice that U already contains a factor of sqrt{-g}
+    Real rho_ut, T[GR_DIM];
+    GRMHD::p_to_u_mhd(G, drhopdt, drhopdt * wind.Tp * 3., uvec, B_P, gam, k, j, i, rho_ut, T);
+
+    dUdt(m_u.RHO, k, j, i) += rho_ut;
+    dUdt(m_u.UU, k, j, i) += T[0];
+    dUdt(m_u.U1, k, j, i) += T[1];
+    dUdt(m_u.U2, k, j, i) += T[2];
+    dUdt(m_u.U3, k, j, i) += T[3];
+}
+
 }
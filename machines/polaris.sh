@@ -37,4 +37,9 @@ if [[ $HOST == *".polaris.alcf.anl.gov" ]]; then
   # TODO(BSP) need to set CRAYPE_LINK_TYPE=dynamic long-term?
 
   EXTRA_FLAGS="-DPARTHENON_DISABLE_HDF5_COMPRESSION=ON $EXTRA_FLAGS"
+
+  # Devices are numbered in reverse relative to the sockets, see
+  # https://www.alcf.anl.gov/support/user-guides/polaris/hardware-overview/machine-overview/index.html
+  # KHARMA maps local ranks to devices at startup, replacing bin/select_gpu_polaris
+  export KHARMA_GPU_MAP=${KHARMA_GPU_MAP:-3,2,1,0}
 fi
@@ -22,6 +22,14 @@
 # noimplicit: Disable implicit solver, avoids pulling in Kokkos-kernels
 # nocleanup:  Disable magnetic field cleaning code for resizing, avoids
 #             pulling in some unofficial Parthenon code.
+# float_recon: Perform WENO5 reconstruction arithmetic in single precision,
+#              for GPUs with poor double-precision throughput
+# single: Store and evolve all fields in single precision (Parthenon's Real = float),
+#         halving memory & halo traffic.  Coordinates are still computed in double.
+#         Solver tolerances are loosened to match, see PrecisionTolerance in decs.hpp
+# simd_recon: Use explicitly vectorized reconstruction loops, for CPU builds
+# fixed_fmks, fixed_mks, fixed_eks, fixed_ks, fixed_cartesian:
+#             Compile for only one coordinate system, skipping runtime dispatch
 # Many machine files have additional options, check machines/machinename.sh
 
 # Make processes to use
@@ -72,6 +80,20 @@ fi
 if [[ "$ARGS" == *"nocleanup"* ]]; then
   EXTRA_FLAGS="-DKHARMA_DISABLE_CLEANUP=1 $EXTRA_FLAGS"
 fi
+if [[ "$ARGS" == *"float_recon"* ]]; then
+  EXTRA_FLAGS="-DKHARMA_FLOAT_RECONSTRUCTION=1 $EXTRA_FLAGS"
+fi
+if [[ "$ARGS" == *"single"* ]]; then
+  EXTRA_FLAGS="-DPARTHENON_SINGLE_PRECISION=ON $EXTRA_FLAGS"
+fi
+if [[ "$ARGS" == *"simd_recon"* ]]; then
+  EXTRA_FLAGS="-DKHARMA_SIMD_RECONSTRUCTION=1 $EXTRA_FLAGS"
+fi
+for fixed_coords in fmks mks eks ks cartesian; do
+  if [[ "$ARGS" == *"fixed_${fixed_coords}"* ]]; then
+    EXTRA_FLAGS="-DKHARMA_FIXED_COORDINATES=${fixed_coords} $EXTRA_FLAGS"
+  fi
+done
 if [[ "$ARGS" == *"split_implicit"* ]]; then
   EXTRA_FLAGS="-DKHARMA_SPLIT_IMPLICIT_SOLVE=1 $EXTRA_FLAGS"
 fi
@@ -0,0 +1,78 @@
+#!/bin/bash
+
+# Losslessly recompress KHARMA/Parthenon restart files in place, for keeping several full-size restarts.
+# compress_restarts.sh file1.rhdf [file2.rhdf ...]
+# Options through the environment:
+#   FILTER=zstd|blosc|deflate   Compression filter (default zstd)
+#   LEVEL=n                     Compression level (default 3 for zstd, 5 for blosc, 1 for deflate)
+#   NPARALLEL=n                 Files compressed at once (default 4)
+#   VERIFY=1                    Compare each result against the original with h5diff before replacing it
+
+# Every dataset with one zone per block is chunked by block, so that a reader needs to decompress only
+# the blocks it reads, and the floating-point bytes are shuffled before compression.  Restarts of MHD runs
+# typically shrink by 1.5-2x.  zstd and blosc are HDF5 filter plugins (e.g. from hdf5plugin or HDF5's own
+# plugin repository): they must be on HDF5_PLUGIN_PATH both here and when restarting.  Both Parthenon
+# restarts and resize_restart_kharma read the files back as usual; the latter reports any missing filter.
+# Restarting from a compressed file is slower to read, so keep the latest restart uncompressed if it
+# will be read soon.  blosc uses BLOSC_NTHREADS threads per file.
+
+FILTER=${FILTER:-zstd}
+NPARALLEL=${NPARALLEL:-4}
+VERIFY=${VERIFY:-0}
+
+case $FILTER in
+  zstd)
+    LEVEL=${LEVEL:-3}
+    # Registered HDF5 filter 32015, with the level as its only parameter
+    FILTER_ARGS="-f SHUF -f UD=32015,0,1,$LEVEL"
+    ;;
+  blosc)
+    LEVEL=${LEVEL:-5}
+    # Registered HDF5 filter 32001: four reserved values, level, byte shuffle, and zstd as the codec
+    FILTER_ARGS="-f UD=32001,0,7,0,0,0,0,$LEVEL,1,5"
+    ;;
+  deflate)
+    LEVEL=${LEVEL:-1}
+    FILTER_ARGS="-f SHUF -f GZIP=$LEVEL"
+    ;;
+  *)
+    echo "Unknown filter $FILTER! Use zstd, blosc or deflate."
+    exit 1
+    ;;
+esac
+
+if (( $# < 1 )); then
+  echo "Usage: compress_restarts.sh file1.rhdf [file2.rhdf ...]"
+  exit 1
+fi
+
+compress_file() {
+  local fname=$1
+  local tmp="$fname.compress_tmp"
+  # Chunk every dataset of rank 4 or more (block, [variable,] zones) by single blocks
+  local layout=$(h5ls -r "$fname" | awk '/Dataset \{/ {
+      dims = $0; sub(/.*\{/, "", dims); sub(/\}.*/, "", dims); gsub(/\/[^,]*/, "", dims); gsub(/ /, "", dims)
+      n = split(dims, d, ",")
+      if (n >= 4) {
+        chunk = "1"
+        for (i = 2; i <= n; i++) chunk = chunk "x" d[i]
+        printf "-l %s:CHUNK=%s ", substr($1, 2), chunk
+      }
+    }')
+  if ! h5repack $layout $FILTER_ARGS "$fname" "$tmp"; then
+    echo "Failed to compress $fname, leaving it as-is"
+    rm -f "$tmp"
+    return 1
+  fi
+  if [[ $VERIFY == 1 ]] && ! h5diff -q "$fname" "$tmp"; then
+    echo "Compressed copy of $fname differs from the original, leaving it as-is"
+    rm -f "$tmp"
+    return 1
+  fi
+  echo "$fname: $(du -h "$fname" | cut -f1) -> $(du -h "$tmp" | cut -f1)"
+  mv "$tmp" "$fname"
+}
+export -f compress_file
+export FILTER_ARGS VERIFY
+
+printf '%s\0' "$@" | xargs -0 -n 1 -P $NPARALLEL bash -c 'compress_file "$1"' _
@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# Run an ensemble of small, independent KHARMA simulations concurrently on one device.
+# ensemble.sh members.txt [options for every member]
+# Each non-empty, non-comment line of members.txt is one member: a name followed by its KHARMA
+# options, e.g.
+#   mhd_64 -i pars/tests/mhdmodes.par parthenon/mesh/nx1=64 parthenon/mesh/nx2=64
+# Paths in a member's options are relative to the directory ensemble.sh was started from.
+
+# Small problems (the test convergence sweeps, parameter scans) leave most of a GPU idle when
+# run one at a time.  Instead, up to NCONCURRENT members run at once, sharing the device: with
+# START_MPS=1 the CUDA Multi-Process Service is started first, so kernels from different
+# members execute concurrently rather than time-slicing.
+# Every member runs in its own directory OUT_DIR/<name> with its own parameters, log and
+# outputs, and its result is listed in OUT_DIR/members.txt
+
+MEMBERS=$(readlink -f "$1")
+shift
+
+KHARMA_DIR=$(dirname "$(readlink -f "$0")")/../..
+NCONCURRENT=${NCONCURRENT:-4}
+START_MPS=${START_MPS:-0}
+START_DIR=$(pwd)
+OUT_DIR=$(readlink -f ${OUT_DIR:-ensemble_$(date +%Y%m%d_%H%M%S)})
+
+if [ ! -f "$MEMBERS" ]; then
+  echo "Member list not found!"
+  exit 1
+fi
+
+mkdir -p $OUT_DIR
+
+if [[ $START_MPS == 1 ]]; then
+  export CUDA_MPS_PIPE_DIRECTORY=$OUT_DIR/.mps_pipe
+  export CUDA_MPS_LOG_DIRECTORY=$OUT_DIR/.mps_log
+  mkdir -p $CUDA_MPS_PIPE_DIRECTORY $CUDA_MPS_LOG_DIRECTORY
+  nvidia-cuda-mps-control -d && trap 'echo quit | nvidia-cuda-mps-control' EXIT
+fi
+
+# Run one member: name, then its options
+run_member() {
+  local name=$1
+  shift
+  mkdir -p $OUT_DIR/$name
+  cd $OUT_DIR/$name
+  # Resolve relative parameter file paths against the starting directory
+  local args=()
+  while (( $# > 0 )); do
+    if [[ $1 == "-i" || $1 == "-r" ]] && [[ $2 != /* ]]; then
+      args+=("$1" "$START_DIR/$2")
+      shift
+    else
+      args+=("$1")
+    fi
+    shift
+  done
+  # Every member shares device 0
+  KOKKOS_DEVICE_ID=${KOKKOS_DEVICE_ID:-0} $KHARMA_DIR/run.sh "${args[@]}" > $name.log 2>&1
+  local code=$?
+  echo "$name $code $OUT_DIR/$name" >> $OUT_DIR/members.txt
+  if [[ $code != 0 ]]; then
+    echo "Member $name failed, see $OUT_DIR/$name/$name.log"
+  else
+    echo "Member $name finished"
+  fi
+}
+
+start_time=$(date +%s)
+while read -r line
+do
+  [[ -z "${line// }" || $line == \#* ]] && continue
+  # Wait for a free slot
+  while (( $(jobs -rp | wc -l) >= $NCONCURRENT )); do
+    wait -n
+  done
+  read -ra member <<< "$line"
+  echo "Starting member ${member[0]}"
+  run_member "${member[@]}" "$@" &
+done < $MEMBERS
+wait
+
+nfail=$(awk '$2 != 0' $OUT_DIR/members.txt | wc -l)
+echo "Ensemble finished in $(( $(date +%s) - $start_time ))s, $nfail member(s) failed"
+(( $nfail == 0 ))
@@ -0,0 +1,107 @@
+#!/bin/bash
+
+# Machine-independent KHARMA scaling harness.  Run inside an allocation (or from a batch script):
+# scaling_sweep.sh [strong|weak|both] [extra KHARMA options]
+# Runs are launched through run.sh, so MPI_EXE etc. come from the machines/ config as usual.
+
+# Strong scaling: for each global mesh size in STRONG_SIZES (cubed), and each number of
+# meshblocks per rank in BLOCKS_PER_RANK, runs on 1, 2, 4, ... MAX_RANKS ranks with the mesh
+# split as evenly as possible.
+# Weak scaling: for each meshblock size in WEAK_SIZES (cubed), runs one block per rank on
+# 1, 2, 4, ... MAX_RANKS ranks, doubling the mesh in X3, X2, X1 in turn.
+
+# Every run writes its <driver>performance_json into OUT_DIR, and is listed in OUT_DIR/runs.txt.
+# Finally, scripts/scaling_table.py prints the efficiency table (and can be re-run on OUT_DIR/runs.txt)
+
+MODE=${1:-both}
+(( $# > 0 )) && shift
+
+KHARMA_DIR=$(dirname "$(readlink -f "$0")")/../..
+PARFILE=${PARFILE:-$KHARMA_DIR/pars/benchmark/scaling_torus_kharma.par}
+MAX_RANKS=${MAX_RANKS:-${SLURM_NTASKS:-1}}
+STRONG_SIZES=${STRONG_SIZES:-"128 256"}
+BLOCKS_PER_RANK=${BLOCKS_PER_RANK:-"1 8"}
+WEAK_SIZES=${WEAK_SIZES:-"64 128"}
+NLIM=${NLIM:-102}
+# Don't split meshblocks below this size, in any direction
+MIN_BLOCK=${MIN_BLOCK:-16}
+OUT_DIR=$(readlink -f ${OUT_DIR:-scaling_$(date +%Y%m%d_%H%M%S)})
+
+mkdir -p $OUT_DIR
+cd $OUT_DIR
+
+# Run one configuration: mode, series name, ranks, mesh nx1..3, block nx1..3, any extra options
+run_one() {
+  local mode=$1 series=$2 np=$3 m1=$4 m2=$5 m3=$6 b1=$7 b2=$8 b3=$9
+  shift 9
+  local id=${mode}_n${np}_m${m1}x${m2}x${m3}_b${b1}x${b2}x${b3}
+  echo "Running $mode scaling on $np ranks: mesh ${m1}x${m2}x${m3}, blocks ${b1}x${b2}x${b3}"
+  $KHARMA_DIR/run.sh -n $np -i $PARFILE parthenon/job/problem_id=$id parthenon/time/nlim=$NLIM \
+                     driver/performance_json=true \
+                     parthenon/mesh/nx1=$m1 parthenon/mesh/nx2=$m2 parthenon/mesh/nx3=$m3 \
+                     parthenon/meshblock/nx1=$b1 parthenon/meshblock/nx2=$b2 parthenon/meshblock/nx3=$b3 \
+                     "$@" > $id.log 2>&1
+  if [ -f $id.kharma_perf.json ]; then
+    echo "$mode $series $np ${m1}x${m2}x${m3} ${b1}x${b2}x${b3} $id.kharma_perf.json" >> runs.txt
+  else
+    echo "Run $id failed, see $OUT_DIR/$id.log"
+  fi
+}
+
+if [[ $MODE == "strong" || $MODE == "both" ]]; then
+  for size in $STRONG_SIZES
+  do
+    for bpr in $BLOCKS_PER_RANK
+    do
+      np=1
+      while (( $np <= $MAX_RANKS ))
+      do
+        # Halve the blocks in X3, X2, X1 in turn until there are enough
+        b=($size $size $size)
+        nblock=1
+        dir=2
+        while (( $nblock < $np * $bpr ))
+        do
+          if (( ${b[0]} <= $MIN_BLOCK && ${b[1]} <= $MIN_BLOCK && ${b[2]} <= $MIN_BLOCK )); then
+            break
+          fi
+          if (( ${b[$dir]} > $MIN_BLOCK )); then
+            b[$dir]=$(( ${b[$dir]} / 2 ))
+            nblock=$(( $nblock * 2 ))
+          fi
+          dir=$(( ($dir + 2) % 3 ))
+        done
+        if (( $nblock < $np )); then
+          echo "Cannot split a $size cubed mesh over $np ranks, skipping"
+        else
+          run_one strong mesh${size}_bpr${bpr} $np $size $size $size ${b[0]} ${b[1]} ${b[2]} "$@"
+        fi
+        np=$(( $np * 2 ))
+      done
+    done
+  done
+fi
+
+if [[ $MODE == "weak" || $MODE == "both" ]]; then
+  for size in $WEAK_SIZES
+  do
+    np=1
+    while (( $np <= $MAX_RANKS ))
+    do
+      # Double the mesh in X3, X2, X1 in turn until there is a block per rank
+      m=($size $size $size)
+      nblock=1
+      dir=2
+      while (( $nblock < $np ))
+      do
+        m[$dir]=$(( ${m[$dir]} * 2 ))
+        nblock=$(( $nblock * 2 ))
+        dir=$(( ($dir + 2) % 3 ))
+      done
+      run_one weak block${size} $np ${m[0]} ${m[1]} ${m[2]} $size $size $size "$@"
+      np=$(( $np * 2 ))
+    done
+  done
+fi
+
+python3 $KHARMA_DIR/scripts/scaling_table.py $OUT_DIR/runs.txt
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+# Compare two KHARMA <problem_id>.kharma_bench.json files (from <benchmark>on = true),
+# e.g. from the last release and the current branch, run on the same problem & hardware:
+# compare_benchmarks.py old.kharma_bench.json new.kharma_bench.json [--tolerance 0.1]
+# Exits nonzero if any kernel common to both is slower by more than the tolerance fraction
+
+import sys
+import json
+
+tolerance = 0.1
+args = sys.argv[1:]
+if "--tolerance" in args:
+    i = args.index("--tolerance")
+    tolerance = float(args[i+1])
+    del args[i:i+2]
+if len(args) != 2:
+    print("Usage: compare_benchmarks.py old.json new.json [--tolerance frac]")
+    sys.exit(2)
+
+old, new = [json.load(open(fname, "r"))['kharma-benchmark'] for fname in args]
+print("Comparing version {} ({} zones/rank) to {} ({} zones/rank)".format(
+        old['version'], old['zones-per-rank'], new['version'], new['zones-per-rank']))
+if old['zones-per-rank'] != new['zones-per-rank'] or old['ranks'] != new['ranks']:
+    print("WARNING: runs used different problem sizes or rank counts!")
+
+regressions = []
+for name in sorted(set(old['kernels']) | set(new['kernels'])):
+    if name not in old['kernels'] or name not in new['kernels']:
+        print(" * {}: only in {}".format(name, "new" if name in new['kernels'] else "old"))
+        continue
+    rate_old = old['kernels'][name]['zone-updates-per-second']
+    rate_new = new['kernels'][name]['zone-updates-per-second']
+    change = rate_new / rate_old - 1
+    flag = ""
+    if change < -tolerance:
+        regressions.append(name)
+        flag = " REGRESSION"
+    print(" * {}: {:.4g} -> {:.4g} zone-updates/s ({:+.1f}%){}".format(name, rate_old, rate_new, 100 * change, flag))
+
+if len(regressions) > 0:
+    print("{} kernels slower by more than {:.0f}%: {}".format(len(regressions), 100 * tolerance, ", ".join(regressions)))
+    sys.exit(1)
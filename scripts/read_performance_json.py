@@ -7,7 +7,36 @@ import numpy as np
 
 top_kernels = 10
 
-for fname in sys.argv[1:]:
+# Kernels counted toward each phase, by substrings of their names.
+# Checked in order, so e.g. flux-CT kernels count as EMF, not flux
+phase_kernels = {
+    "emf": ["B_CT", "flux_ct", "emf", "dB_boundary"],
+    "implicit": ["implicit_", "fix_solver_failures"],
+    "electrons": ["electron", "heat", "elec"],
+    "inversion": ["U_to_P", "UtoP"],
+    "floors": ["floor"],
+    "flux": ["calc_flux", "flux_", "replace_face", "fofc", "ndt"],
+    "boundaries": ["Bound", "Buf", "boundary", "transmit", "halo", "Prolongat", "Restrict"],
+    "reductions": ["domain_", "batched", "shell_sum", "count_", "histogram", "divB_max", "max_norm",
+                   "accumulate_averages"]
+}
+
+# Optionally pass a KHARMA <problem_id>.kharma_perf.json (from <driver>performance_json) with --kharma,
+# to get effective bandwidth for each phase, and/or write the per-phase summary with --json
+kharma_perf = None
+out_json = None
+args = sys.argv[1:]
+if "--kharma" in args:
+    i = args.index("--kharma")
+    kharma_perf = json.load(open(args[i+1], "r"))['kharma-performance']
+    del args[i:i+2]
+if "--json" in args:
+    i = args.index("--json")
+    out_json = args[i+1]
+    del args[i:i+2]
+summary = {}
+
+for fname in args:
     f = open(fname, "r")
 
     contents = ''.join(f.readlines())
@@ -26,3 +55,41 @@ for fname in sys.argv[1:]:
     top_kernel_info = sorted(kperf['kernel-perf-info'], key=lambda x: x['total-time'], reverse=True)[:10]
     for x in top_kernel_info:
         print(" * {}: {}s total".format(x['kernel-name'], x['total-time']))
+
+    # Time in each part of the implicit solver.  The parts are only separate kernels
+    # with implicit/compact_active or SPLIT_IMPLICIT_SOLVE, otherwise all is under "solve"
+    implicit_parts = {"Jacobian": "implicit_jacobian", "solve": "implicit_solve", "update": "implicit_set_step"}
+    implicit_times = {part: sum([x['total-time'] for x in kperf['kernel-perf-info'] if name in x['kernel-name']])
+                      for part, name in implicit_parts.items()}
+    implicit_total = sum(implicit_times.values())
+    if implicit_total > 0:
+        print("Implicit solver: {}s total".format(implicit_total))
+        for part, time in implicit_times.items():
+            print(" * {}: {}s ({:.1f}%)".format(part, time, 100 * time / implicit_total))
+
+    # Time in each phase of the step, and if we know how much data each phase touches, its bandwidth.
+    # Kokkos' tools write a file per rank, so compare against a single rank's share of the zone-cycles
+    phase_times = {phase: 0. for phase in phase_kernels}
+    for x in kperf['kernel-perf-info']:
+        for phase, names in phase_kernels.items():
+            if any([name in x['kernel-name'] for name in names]):
+                phase_times[phase] += x['total-time']
+                break
+    print("Phases:")
+    file_summary = {}
+    for phase, time in phase_times.items():
+        file_summary[phase] = {"seconds": time}
+        if kharma_perf is not None and time > 0:
+            nbytes = kharma_perf['values-per-zone'][phase] * kharma_perf['bytes-per-value'] * \
+                     kharma_perf['zone-cycles'] / kharma_perf['ranks']
+            file_summary[phase]["GB/s"] = nbytes / time / 1e9
+            print(" * {}: {}s, {:.2f} GB/s".format(phase, time, file_summary[phase]["GB/s"]))
+        else:
+            print(" * {}: {}s".format(phase, time))
+    if kharma_perf is not None:
+        file_summary["zone-cycles-per-second"] = kharma_perf['zone-cycles-per-second']
+        print("Zone-cycles/s: {:.4g}".format(kharma_perf['zone-cycles-per-second']))
+    summary[fname] = file_summary
+
+if out_json is not None:
+    json.dump(summary, open(out_json, "w"), indent=2)
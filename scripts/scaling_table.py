@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+
+# Efficiency table for a scaling sweep from scripts/batch/scaling_sweep.sh:
+# scaling_table.py OUT_DIR/runs.txt [--json summary.json]
+# Each line of runs.txt is: mode series ranks mesh block perf_json, with perf_json relative to runs.txt.
+# Efficiency is the per-rank zone-cycle rate relative to the smallest run of the series, so it's
+# the usual parallel efficiency for strong scaling and weak-scaling efficiency for weak scaling
+
+import os
+import sys
+import json
+
+out_json = None
+args = sys.argv[1:]
+if "--json" in args:
+    i = args.index("--json")
+    out_json = args[i+1]
+    del args[i:i+2]
+if len(args) != 1:
+    print("Usage: scaling_table.py runs.txt [--json summary.json]")
+    sys.exit(2)
+
+run_dir = os.path.dirname(os.path.abspath(args[0]))
+series = {}
+for line in open(args[0], "r"):
+    if len(line.split()) != 6:
+        continue
+    mode, name, ranks, mesh, block, fname = line.split()
+    perf = json.load(open(os.path.join(run_dir, fname), "r"))['kharma-performance']
+    series.setdefault((mode, name), []).append({"ranks": int(ranks), "mesh": mesh, "block": block,
+                                                "zone-cycles-per-second": perf['zone-cycles-per-second']})
+
+summary = {}
+for (mode, name), runs in sorted(series.items()):
+    runs = sorted(runs, key=lambda x: x['ranks'])
+    base_per_rank = runs[0]['zone-cycles-per-second'] / runs[0]['ranks']
+    print("=== {} scaling, {} ===".format(mode, name))
+    print("{:>6} {:>16} {:>12} {:>14} {:>14} {:>8}".format("ranks", "mesh", "block", "zcps", "zcps/rank", "eff"))
+    for run in runs:
+        per_rank = run['zone-cycles-per-second'] / run['ranks']
+        run['efficiency'] = per_rank / base_per_rank
+        print("{:>6} {:>16} {:>12} {:>14.4g} {:>14.4g} {:>7.1f}%".format(run['ranks'], run['mesh'], run['block'],
+                run['zone-cycles-per-second'], per_rank, 100 * run['efficiency']))
+    summary[mode + "_" + name] = runs
+
+if out_json is not None:
+    json.dump(summary, open(out_json, "w"), indent=2)
@@ -83,6 +83,7 @@ conv_2d fast mhdmodes/nmode=3 "fast mode in 2D"
 
 # Entropy mode as reconstruction demo
 conv_2d entropy_nob "mhdmodes/nmode=0 b_field/solver=none" "entropy mode in 2D, no B field"
+conv_2d entropy_nob_hllc "mhdmodes/nmode=0 b_field/solver=none flux/type=hllc" "entropy mode in 2D, no B field, HLLC fluxes"
 # The resolutions we test are too low for these two
 #conv_2d entropy_donor "mhdmodes/nmode=0 driver/reconstruction=donor_cell" "entropy mode in 2D, Donor Cell reconstruction"
 #conv_2d entropy_vl "mhdmodes/nmode=0 driver/reconstruction=linear_vl" "entropy mode in 2D, linear/VL reconstruction"
@@ -92,7 +93,14 @@ conv_2d entropy_weno_lin "mhdmodes/nmode=0 driver/reconstruction=weno5_linear" "
 conv_2d entropy_ppm "mhdmodes/nmode=0 driver/reconstruction=ppm" "entropy mode in 2D, PPM reconstruction"
 conv_2d entropy_ppmx "mhdmodes/nmode=0 driver/reconstruction=ppm" "entropy mode in 2D, PPMX reconstruction"
 conv_2d entropy_mp5 "mhdmodes/nmode=0 driver/reconstruction=mp5" "entropy mode in 2D, MP5 reconstruction"
-
+conv_2d entropy_weno_adaptive "mhdmodes/nmode=0 flux/reconstruction=weno5 flux/adaptive_order=true" "entropy mode in 2D, adaptive WENO5/linear reconstruction"
+
+# WENO5 with shared smoothness indicators.  Results should be identical to WENO5 above.
+# In builds with single-precision reconstruction (./make.sh float_recon), the WENO5 tests
+# measure the error impact of that option as well: they should still converge at these amplitudes
+conv_2d slow_weno_cached   "mhdmodes/nmode=1 flux/reconstruction=weno5 flux/weno5_cache_indicators=true" "slow mode in 2D, WENO5 w/cached indicators"
+conv_2d alfven_weno_cached "mhdmodes/nmode=2 flux/reconstruction=weno5 flux/weno5_cache_indicators=true" "Alfven mode in 2D, WENO5 w/cached indicators"
+conv_2d fast_weno_cached   "mhdmodes/nmode=3 flux/reconstruction=weno5 flux/weno5_cache_indicators=true" "fast mode in 2D, WENO5 w/cached indicators"
 # KHARMA driver
 conv_2d slow_kharma   "mhdmodes/nmode=1 driver/type=kharma" "slow mode in 2D, KHARMA driver"
 conv_2d alfven_kharma "mhdmodes/nmode=2 driver/type=kharma" "Alfven mode in 2D, KHARMA driver"